@@ -118,12 +118,10 @@ static void ProxRssi_RawPrune(ProxRssi_CtxType* Ctx, uint32_t nowMs, uint32_t wi
   uint16_t tail = ProxRssi_RingTail(Ctx->raw.head, Ctx->raw.count, (uint16_t)PROX_RSSI_RAW_CAP);
   uint16_t remaining = Ctx->raw.count;
 
-  /* Keep samples with t >= now - win */
-  const uint32_t minT = (ProxRssi_TimeDiff(nowMs, 0u) >= winMs) ? (nowMs - winMs) : 0u;
-
+  /* Keep samples not older than now - win */
   while (remaining > 0u)
   {
-    if (Ctx->raw.tMs[tail] >= minT) { break; }
+    if (ProxTime_InWindow(Ctx->raw.tMs[tail], nowMs, winMs) == TRUE) { break; }
     tail = ProxRssi_RingNext(tail, (uint16_t)PROX_RSSI_RAW_CAP);
     remaining--;
   }
@@ -137,11 +135,9 @@ static void ProxRssi_SmoothPrune(ProxRssi_CtxType* Ctx, uint32_t nowMs, uint32_t
   uint16_t tail = ProxRssi_RingTail(Ctx->smooth.head, Ctx->smooth.count, (uint16_t)PROX_RSSI_SMOOTH_CAP);
   uint16_t remaining = Ctx->smooth.count;
 
-  const uint32_t minT = (ProxRssi_TimeDiff(nowMs, 0u) >= winMs) ? (nowMs - winMs) : 0u;
-
   while (remaining > 0u)
   {
-    if (Ctx->smooth.tMs[tail] >= minT) { break; }
+    if (ProxTime_InWindow(Ctx->smooth.tMs[tail], nowMs, winMs) == TRUE) { break; }
     tail = ProxRssi_RingNext(tail, (uint16_t)PROX_RSSI_SMOOTH_CAP);
     remaining--;
   }
@@ -157,14 +153,12 @@ static Std_ReturnType ProxRssi_CopyRawWindowQ4(const ProxRssi_CtxType* Ctx,
   uint16_t n = 0u;
   if (Ctx->raw.count == 0u) { *outN = 0u; return E_NOT_OK; }
 
-  const uint32_t minT = (ProxRssi_TimeDiff(nowMs, 0u) >= winMs) ? (nowMs - winMs) : 0u;
-
   uint16_t idx = ProxRssi_RingTail(Ctx->raw.head, Ctx->raw.count, (uint16_t)PROX_RSSI_RAW_CAP);
   uint16_t i;
 
   for (i = 0u; i < Ctx->raw.count; i++)
   {
-    if (Ctx->raw.tMs[idx] >= minT)
+    if (ProxTime_InWindow(Ctx->raw.tMs[idx], nowMs, winMs) == TRUE)
     {
       if (n < cap)
       {
@@ -189,14 +183,12 @@ static Std_ReturnType ProxRssi_CopySmoothWindowQ4(const ProxRssi_CtxType* Ctx,
 
   if (Ctx->smooth.count == 0u) { *outN = 0u; *outLastQ4 = (int16_t)0; return E_NOT_OK; }
 
-  const uint32_t minT = (ProxRssi_TimeDiff(nowMs, 0u) >= winMs) ? (nowMs - winMs) : 0u;
-
   uint16_t idx = ProxRssi_RingTail(Ctx->smooth.head, Ctx->smooth.count, (uint16_t)PROX_RSSI_SMOOTH_CAP);
   uint16_t i;
 
   for (i = 0u; i < Ctx->smooth.count; i++)
   {
-    if (Ctx->smooth.tMs[idx] >= minT)
+    if (ProxTime_InWindow(Ctx->smooth.tMs[idx], nowMs, winMs) == TRUE)
     {
       if (n < cap)
       {
@@ -217,7 +209,7 @@ static Std_ReturnType ProxRssi_CopySmoothWindowQ4(const ProxRssi_CtxType* Ctx,
 static Std_ReturnType ProxRssi_HampelSpikeReject(ProxRssi_CtxType* Ctx, uint32_t nowMs, int16_t* outQ4)
 {
   uint16_t n;
-  Std_ReturnType r = ProxRssi_CopyRawWindowQ4(Ctx, nowMs, Ctx->p.wSpikeMs,
+  Std_ReturnType r = ProxRssi_CopyRawWindowQ4(Ctx, nowMs, Ctx->tk.wSpike,
                                               Ctx->tmpA, (uint16_t)PROX_RSSI_RAW_CAP, &n);
   if (r != E_OK) { return E_NOT_OK; }
 
@@ -249,9 +241,24 @@ static Std_ReturnType ProxRssi_HampelSpikeReject(ProxRssi_CtxType* Ctx, uint32_t
   return E_OK;
 }
 
-/* EMA update (fixed-point, LUT alpha) */
+/* Linear alpha law: alphaLo .. alphaHi over alphaRampLoMs .. alphaRampHiMs.
+ * Init bounds the span to PROX_RSSI_ALPHA_RAMP_MAX_MS, so 32 bits suffice. */
+static uint16_t ProxRssi_AlphaQ15Ramp(const ProxRssi_ParamsType* p, uint32_t dtMs)
+{
+  if (dtMs <= p->alphaRampLoMs) { return p->alphaLoQ15; }
+  if (dtMs >= p->alphaRampHiMs) { return p->alphaHiQ15; }
+
+  const int32_t range  = (int32_t)p->alphaHiQ15 - (int32_t)p->alphaLoQ15;
+  const int32_t dtOff  = (int32_t)(dtMs - p->alphaRampLoMs);
+  const int32_t dtSpan = (int32_t)(p->alphaRampHiMs - p->alphaRampLoMs);
+  return (uint16_t)((int32_t)p->alphaLoQ15 + ((range * dtOff) / dtSpan));
+}
+
+/* EMA update (fixed-point, LUT or ramp alpha), dt in whole ms */
 static uint16_t ProxRssi_AlphaQ15FromDt(const ProxRssi_CtxType* Ctx, uint32_t dtMs)
 {
+  if (Ctx->p.alphaRampHiMs != 0u) { return ProxRssi_AlphaQ15Ramp(&Ctx->p, dtMs); }
+
   uint32_t idx = dtMs / (uint32_t)PROX_RSSI_ALPHA_LUT_STEP_MS;
   if (idx >= (uint32_t)PROX_RSSI_ALPHA_LUT_SIZE) { idx = (uint32_t)PROX_RSSI_ALPHA_LUT_SIZE - 1u; }
   return Ctx->alphaQ15[idx];
@@ -268,18 +275,24 @@ static void ProxRssi_EmaUpdate(ProxRssi_CtxType* Ctx, uint32_t nowMs, int16_t xQ
     return;
   }
 
-  const uint32_t dtMs = ProxRssi_TimeDiff(nowMs, Ctx->emaPrevMs);
+  const uint32_t dt = ProxRssi_TimeDiff(nowMs, Ctx->emaPrevMs);
 
   /* Time anomaly => full reset (safety-first) */
-  if ((dtMs == 0u) || (dtMs > Ctx->p.maxReasonableDtMs))
+  if ((dt == 0u) || (dt > Ctx->tk.maxReasonableDt))
   {
     Ctx->emaQ4 = xQ4;
     Ctx->emaPrevMs = nowMs;
+    Ctx->emaWarmQ15 = 0u;
     *outEmaQ4 = xQ4;
     return;
   }
 
-  const uint16_t aQ15 = ProxRssi_AlphaQ15FromDt(Ctx, dtMs);
+  /* Alpha is a function of whole ms: one 32-bit division */
+  uint16_t aQ15 = ProxRssi_AlphaQ15FromDt(Ctx, dt / Ctx->tk.perMs);
+
+  /* First sample after a warm start: the older the restored EMA, the less it counts */
+  if (aQ15 < Ctx->emaWarmQ15) { aQ15 = Ctx->emaWarmQ15; }
+  Ctx->emaWarmQ15 = 0u;
 
   const int16_t eQ4 = Ctx->emaQ4;
   const int16_t deltaQ4 = (int16_t)(xQ4 - eQ4);
@@ -296,10 +309,22 @@ static Std_ReturnType ProxRssi_ComputeFeatures(ProxRssi_CtxType* Ctx, uint32_t n
   uint16_t n;
   int16_t lastQ4;
 
-  Std_ReturnType r = ProxRssi_CopySmoothWindowQ4(Ctx, nowMs, Ctx->p.wFeatMs,
+  Std_ReturnType r = ProxRssi_CopySmoothWindowQ4(Ctx, nowMs, Ctx->tk.wFeat,
                                                  Ctx->tmpS, (uint16_t)PROX_RSSI_SMOOTH_CAP,
                                                  &n, &lastQ4);
-  if (r != E_OK) { return E_NOT_OK; }
+  if (r != E_OK)
+  {
+    if ((Ctx->p.stepSparse == FALSE) || (n == 0u)) { return E_NOT_OK; }
+
+    /* Sparse window: last value only, stability gate closed */
+    outF->n = n;
+    outF->pctAboveEnterQ15 = 0u;
+    outF->stdQ4 = 0xFFFFu;
+    outF->lastQ4 = lastQ4;
+    outF->minQ4 = lastQ4;
+    outF->maxQ4 = lastQ4;
+    return E_OK;
+  }
 
   /* sum/sumsq in 64-bit for safety */
   int64_t sumQ4 = (int64_t)0;
@@ -362,12 +387,12 @@ static ProxRssi_EventType ProxRssi_StateStep(ProxRssi_CtxType* Ctx, uint32_t now
 
   if (Ctx->st == PROX_RSSI_ST_LOCKOUT)
   {
-    if (nowMs < Ctx->tLockoutUntilMs) { return PROX_RSSI_EVT_NONE; }
+    if (ProxTime_Before(nowMs, Ctx->tLockoutUntilMs) == TRUE) { return PROX_RSSI_EVT_NONE; }
 
     if (lastQ4 < exitQ4)
     {
       if (Ctx->tBelowExitStartMs == 0u) { Ctx->tBelowExitStartMs = nowMs; }
-      if (ProxRssi_TimeDiff(nowMs, Ctx->tBelowExitStartMs) >= Ctx->p.exitConfirmMs)
+      if (ProxRssi_TimeDiff(nowMs, Ctx->tBelowExitStartMs) >= Ctx->tk.exitConfirm)
       {
         Ctx->st = PROX_RSSI_ST_FAR;
         Ctx->tBelowExitStartMs = 0u;
@@ -397,7 +422,7 @@ static ProxRssi_EventType ProxRssi_StateStep(ProxRssi_CtxType* Ctx, uint32_t now
   if (lastQ4 < exitQ4)
   {
     if (Ctx->tBelowExitStartMs == 0u) { Ctx->tBelowExitStartMs = nowMs; }
-    if (ProxRssi_TimeDiff(nowMs, Ctx->tBelowExitStartMs) >= Ctx->p.exitConfirmMs)
+    if (ProxRssi_TimeDiff(nowMs, Ctx->tBelowExitStartMs) >= Ctx->tk.exitConfirm)
     {
       Ctx->st = PROX_RSSI_ST_FAR;
       Ctx->tBelowExitStartMs = 0u;
@@ -412,10 +437,10 @@ static ProxRssi_EventType ProxRssi_StateStep(ProxRssi_CtxType* Ctx, uint32_t now
 
   if (ProxRssi_IsStable(Ctx, f) == TRUE)
   {
-    if (ProxRssi_TimeDiff(nowMs, Ctx->tCandidateStartMs) >= Ctx->p.stableMs)
+    if (ProxRssi_TimeDiff(nowMs, Ctx->tCandidateStartMs) >= Ctx->tk.stable)
     {
       Ctx->st = PROX_RSSI_ST_LOCKOUT;
-      Ctx->tLockoutUntilMs = nowMs + Ctx->p.lockoutMs;
+      Ctx->tLockoutUntilMs = nowMs + Ctx->tk.lockout;
       Ctx->tBelowExitStartMs = 0u;
       return PROX_RSSI_EVT_UNLOCK_TRIGGERED;
     }
@@ -428,6 +453,34 @@ static ProxRssi_EventType ProxRssi_StateStep(ProxRssi_CtxType* Ctx, uint32_t now
   return PROX_RSSI_EVT_NONE;
 }
 
+/* ms -> ticks, E_NOT_OK if the span is not comparable across the wrap */
+static Std_ReturnType ProxRssi_MsToTicks(uint32_t ms, uint32_t perMs, uint32_t* outTicks)
+{
+  if (ms > ((uint32_t)PROX_TIME_MAX_SPAN / perMs)) { return E_NOT_OK; }
+  *outTicks = ms * perMs;
+  return E_OK;
+}
+
+/* Windows and timers in ticks, once per Init (the per-sample path only compares) */
+static Std_ReturnType ProxRssi_InitTicks(ProxRssi_CtxType* Ctx)
+{
+  const ProxRssi_ParamsType* p = &Ctx->p;
+  ProxRssi_TicksType* tk = &Ctx->tk;
+
+  tk->perMs = (uint32_t)p->ticksPerMs;
+  if ((ProxRssi_MsToTicks(p->wRawMs, tk->perMs, &tk->wRaw) != E_OK) ||
+      (ProxRssi_MsToTicks(p->wSpikeMs, tk->perMs, &tk->wSpike) != E_OK) ||
+      (ProxRssi_MsToTicks(p->wFeatMs, tk->perMs, &tk->wFeat) != E_OK) ||
+      (ProxRssi_MsToTicks(p->stableMs, tk->perMs, &tk->stable) != E_OK) ||
+      (ProxRssi_MsToTicks(p->exitConfirmMs, tk->perMs, &tk->exitConfirm) != E_OK) ||
+      (ProxRssi_MsToTicks(p->lockoutMs, tk->perMs, &tk->lockout) != E_OK) ||
+      (ProxRssi_MsToTicks(p->maxReasonableDtMs, tk->perMs, &tk->maxReasonableDt) != E_OK))
+  {
+    return E_NOT_OK;
+  }
+  return E_OK;
+}
+
 /* ============================================================
  * Public API
  * ============================================================ */
@@ -438,10 +491,13 @@ Std_ReturnType ProxRssi_Init(ProxRssi_CtxType* Ctx,
 {
   uint32_t i;
 
-  if ((Ctx == NULL_PTR) ||
-      (Params == NULL_PTR) ||
-      (AlphaQ15Lut == NULL_PTR) ||
-      (AlphaLutLen == 0u))
+  if ((Ctx == NULL_PTR) || (Params == NULL_PTR))
+  {
+    return E_NOT_OK;
+  }
+
+  /* The LUT is only optional with the linear alpha law */
+  if (((AlphaQ15Lut == NULL_PTR) || (AlphaLutLen == 0u)) && (Params->alphaRampHiMs == 0u))
   {
     return E_NOT_OK;
   }
@@ -462,15 +518,38 @@ Std_ReturnType ProxRssi_Init(ProxRssi_CtxType* Ctx,
   if (Ctx->p.minFeatSamples == 0u){ Ctx->p.minFeatSamples = 6u; }
 
   if (Ctx->p.maxReasonableDtMs == 0u) { Ctx->p.maxReasonableDtMs = 2000u; }
+  if (Ctx->p.ticksPerMs == 0u) { Ctx->p.ticksPerMs = 1u; }
+
+  if ((Ctx->p.alphaRampHiMs > Ctx->p.alphaRampLoMs) &&
+      ((Ctx->p.alphaRampHiMs - Ctx->p.alphaRampLoMs) > (uint32_t)PROX_RSSI_ALPHA_RAMP_MAX_MS))
+  {
+    return E_NOT_OK;
+  }
 
-  /* Copy alpha LUT (16 ms step) and clamp */
-  if (AlphaLutLen > (uint32_t)PROX_RSSI_ALPHA_LUT_SIZE)
+  if (ProxRssi_InitTicks(Ctx) != E_OK)
   {
-    AlphaLutLen = (uint32_t)PROX_RSSI_ALPHA_LUT_SIZE;
+    return E_NOT_OK;
+  }
+
+  if ((AlphaQ15Lut == NULL_PTR) || (AlphaLutLen == 0u))
+  {
+    /* Ramp only: keep the LUT consistent for diagnostics (flight recorder) */
+    for (i = 0u; i < (uint32_t)PROX_RSSI_ALPHA_LUT_SIZE; i++)
+    {
+      Ctx->alphaQ15[i] = ProxRssi_AlphaQ15Ramp(&Ctx->p, i * (uint32_t)PROX_RSSI_ALPHA_LUT_STEP_MS);
+    }
   }
+  else
+  {
+    /* Copy alpha LUT (16 ms step) and clamp */
+    if (AlphaLutLen > (uint32_t)PROX_RSSI_ALPHA_LUT_SIZE)
+    {
+      AlphaLutLen = (uint32_t)PROX_RSSI_ALPHA_LUT_SIZE;
+    }
 
-  for (i = 0u; i < AlphaLutLen; i++) { Ctx->alphaQ15[i] = AlphaQ15Lut[i]; }
-  for (i = AlphaLutLen; i < (uint32_t)PROX_RSSI_ALPHA_LUT_SIZE; i++) { Ctx->alphaQ15[i] = Ctx->alphaQ15[AlphaLutLen - 1u]; }
+    for (i = 0u; i < AlphaLutLen; i++) { Ctx->alphaQ15[i] = AlphaQ15Lut[i]; }
+    for (i = AlphaLutLen; i < (uint32_t)PROX_RSSI_ALPHA_LUT_SIZE; i++) { Ctx->alphaQ15[i] = Ctx->alphaQ15[AlphaLutLen - 1u]; }
+  }
 
   /* Reset state */
   Ctx->st = PROX_RSSI_ST_FAR;
@@ -481,6 +560,7 @@ Std_ReturnType ProxRssi_Init(ProxRssi_CtxType* Ctx,
   Ctx->emaValid = FALSE;
   Ctx->emaQ4 = (int16_t)0;
   Ctx->emaPrevMs = 0u;
+  Ctx->emaWarmQ15 = 0u;
 
   Ctx->raw.head = 0u;
   Ctx->raw.count = 0u;
@@ -520,8 +600,8 @@ Std_ReturnType ProxRssi_MainFunction(ProxRssi_CtxType* Ctx, uint32_t nowMs,
   }
 
   /* prune */
-  ProxRssi_RawPrune(Ctx, nowMs, Ctx->p.wRawMs);
-  ProxRssi_SmoothPrune(Ctx, nowMs, Ctx->p.wFeatMs);
+  ProxRssi_RawPrune(Ctx, nowMs, Ctx->tk.wRaw);
+  ProxRssi_SmoothPrune(Ctx, nowMs, Ctx->tk.wFeat);
 
   /* default features */
   f.n = 0u; f.pctAboveEnterQ15 = 0u; f.stdQ4 = 0u; f.lastQ4 = (int16_t)0; f.minQ4 = (int16_t)0; f.maxQ4 = (int16_t)0;
@@ -544,16 +624,20 @@ Std_ReturnType ProxRssi_MainFunction(ProxRssi_CtxType* Ctx, uint32_t nowMs,
 
   /* EMA */
   int16_t emaQ4;
+  const bool_t seeding = (Ctx->emaValid == FALSE) ? TRUE : FALSE;
   ProxRssi_EmaUpdate(Ctx, nowMs, xQ4, &emaQ4);
 
   /* Smooth push */
   ProxRssi_SmoothPush(Ctx, nowMs, emaQ4);
-  ProxRssi_SmoothPrune(Ctx, nowMs, Ctx->p.wFeatMs);
+  ProxRssi_SmoothPrune(Ctx, nowMs, Ctx->tk.wFeat);
 
   /* Features + state */
   if (ProxRssi_ComputeFeatures(Ctx, nowMs, &f) == E_OK)
   {
-    ev = ProxRssi_StateStep(Ctx, nowMs, &f);
+    if ((seeding == FALSE) || (Ctx->p.primeFirst == FALSE))
+    {
+      ev = ProxRssi_StateStep(Ctx, nowMs, &f);
+    }
   }
 
   *Event = ev;
@@ -573,6 +657,7 @@ Std_ReturnType ProxRssi_ForceFar(ProxRssi_CtxType* Ctx)
   Ctx->emaValid = FALSE;
   Ctx->emaQ4 = (int16_t)0;
   Ctx->emaPrevMs = 0u;
+  Ctx->emaWarmQ15 = 0u;
 
   Ctx->raw.head = 0u;
   Ctx->raw.count = 0u;
@@ -581,3 +666,121 @@ Std_ReturnType ProxRssi_ForceFar(ProxRssi_CtxType* Ctx)
 
   return E_OK;
 }
+
+Std_ReturnType ProxRssi_Snapshot(const ProxRssi_CtxType* Ctx, ProxRssi_SnapshotType* Snap)
+{
+  if ((Ctx == NULL_PTR) || (Snap == NULL_PTR)) { return E_NOT_OK; }
+
+  Snap->tLastMs = Ctx->emaPrevMs;
+  Snap->perMs = Ctx->tk.perMs;
+  Snap->emaValid = Ctx->emaValid;
+  Snap->emaQ4 = Ctx->emaQ4;
+  Snap->count = 0u;
+
+  /* Lockout still running at the newest sample carries over, in real time */
+  Snap->lockoutLeftMs = 0u;
+  if ((Ctx->st == PROX_RSSI_ST_LOCKOUT) && (ProxTime_Before(Ctx->emaPrevMs, Ctx->tLockoutUntilMs) == TRUE))
+  {
+    Snap->lockoutLeftMs = ProxRssi_TimeDiff(Ctx->tLockoutUntilMs, Ctx->emaPrevMs);
+  }
+
+  Snap->candidateMs = 0u;
+  if (Ctx->st == PROX_RSSI_ST_CANDIDATE)
+  {
+    Snap->candidateMs = ProxRssi_TimeDiff(Ctx->emaPrevMs, Ctx->tCandidateStartMs);
+  }
+
+  if (Ctx->emaValid == FALSE) { return E_OK; }
+
+  /* Newest PROX_RSSI_SNAP_CAP smoothed samples, oldest first */
+  uint16_t n = Ctx->smooth.count;
+  if (n > (uint16_t)PROX_RSSI_SNAP_CAP) { n = (uint16_t)PROX_RSSI_SNAP_CAP; }
+
+  uint16_t idx = ProxRssi_RingTail(Ctx->smooth.head, n, (uint16_t)PROX_RSSI_SMOOTH_CAP);
+  uint16_t i;
+  for (i = 0u; i < n; i++)
+  {
+    const uint32_t t = Ctx->smooth.tMs[idx];
+    Snap->ageMs[i] = (ProxTime_Before(t, Ctx->emaPrevMs) == TRUE) ? ProxRssi_TimeDiff(Ctx->emaPrevMs, t) : 0u;
+    Snap->rssiQ4[i] = Ctx->smooth.rssiQ4[idx];
+    idx = ProxRssi_RingNext(idx, (uint16_t)PROX_RSSI_SMOOTH_CAP);
+  }
+  Snap->count = n;
+
+  return E_OK;
+}
+
+Std_ReturnType ProxRssi_Restore(ProxRssi_CtxType* Ctx, uint32_t nowMs,
+                                const ProxRssi_SnapshotType* Snap,
+                                uint32_t warmMs)
+{
+  uint32_t warm;
+
+  if (ProxRssi_ForceFar(Ctx) != E_OK) { return E_NOT_OK; }
+
+  if ((Snap == NULL_PTR) || (Snap->emaValid == FALSE) || (Snap->perMs != Ctx->tk.perMs) ||
+      (Snap->count > (uint16_t)PROX_RSSI_SNAP_CAP))
+  {
+    return E_NOT_OK;
+  }
+
+  if ((ProxRssi_MsToTicks(warmMs, Ctx->tk.perMs, &warm) != E_OK) || (warm == 0u) ||
+      (ProxTime_Before(nowMs, Snap->tLastMs) == TRUE))
+  {
+    return E_NOT_OK;
+  }
+
+  const uint32_t age = ProxRssi_TimeDiff(nowMs, Snap->tLastMs);
+  if (age >= warm) { return E_NOT_OK; }
+
+  /* Confidence (warm - age) / warm: share of the history kept (rounded up), newest first */
+  const uint16_t keep = (uint16_t)((((uint64_t)Snap->count * (uint64_t)(warm - age)) + (uint64_t)warm - 1u) /
+                                   (uint64_t)warm);
+
+  /* The gap is cut out: the newest sample is stamped now */
+  uint16_t i;
+  for (i = (uint16_t)(Snap->count - keep); i < Snap->count; i++)
+  {
+    ProxRssi_SmoothPush(Ctx, nowMs - Snap->ageMs[i], Snap->rssiQ4[i]);
+  }
+
+  Ctx->emaValid = TRUE;
+  Ctx->emaQ4 = Snap->emaQ4;
+  Ctx->emaPrevMs = nowMs;
+  Ctx->emaWarmQ15 = (uint16_t)(((uint64_t)age * (uint64_t)PROX_RSSI_Q15_ONE) / (uint64_t)warm);
+
+  if (Snap->lockoutLeftMs > age)
+  {
+    Ctx->st = PROX_RSSI_ST_LOCKOUT;
+    Ctx->tLockoutUntilMs = nowMs + (Snap->lockoutLeftMs - age);
+  }
+  else if (Snap->candidateMs != 0u)
+  {
+    /* Same confidence for the hold, half of stableMs stays on fresh samples */
+    uint32_t creditMs = (uint32_t)(((uint64_t)Snap->candidateMs * (uint64_t)(warm - age)) / (uint64_t)warm);
+    if (creditMs > (Ctx->tk.stable / 2u)) { creditMs = Ctx->tk.stable / 2u; }
+
+    Ctx->st = PROX_RSSI_ST_CANDIDATE;
+    Ctx->tCandidateStartMs = nowMs - creditMs;
+  }
+
+  return E_OK;
+}
+
+Std_ReturnType ProxRssi_Handover(ProxRssi_CtxType* Ctx, uint32_t nowMs,
+                                 const ProxRssi_SnapshotType* Snap,
+                                 uint32_t warmMs)
+{
+  if (ProxRssi_Restore(Ctx, nowMs, Snap, warmMs) != E_OK) { return E_NOT_OK; }
+
+  /* Same approach seen from another source: the hold up to the snapshot counts in full */
+  if (Ctx->st == PROX_RSSI_ST_CANDIDATE)
+  {
+    uint32_t creditMs = Snap->candidateMs;
+    if (creditMs > Ctx->tk.stable) { creditMs = Ctx->tk.stable; }
+
+    Ctx->tCandidateStartMs = nowMs - creditMs;
+  }
+
+  return E_OK;
+}
@@ -29,6 +29,40 @@
     ProxRssi_MainFunction(&ctx, tMs, &ev, &feat);
     if (ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED) { ... start secure handshake ... }
 
+ ALPHA
+ -----
+ By default the EMA alpha is read from the LUT given to ProxRssi_Init
+ (PROX_RSSI_ALPHA_LUT_STEP_MS per entry). With alphaRampHiMs != 0 it is
+ interpolated linearly from dt instead, and the LUT may be NULL (the
+ context LUT is then sampled from the ramp).
+
+ TIME
+ ----
+ Timestamps are ticks of 1/ticksPerMs ms (plain ms when ticksPerMs is 0),
+ typically ProxTime_Now() with ticksPerMs = PROX_TIME_TICKS_PER_MS. Windows
+ and timers are configured in ms and converted once by ProxRssi_Init; every
+ comparison is wrap-safe (prox_time.h), so a window may straddle the 32-bit
+ wrap and samples less than 1 ms apart are windowed and smoothed normally.
+ Each window and timer must stay below PROX_TIME_MAX_SPAN ticks.
+
+ WARM START
+ ----------
+ ProxRssi_Snapshot copies the EMA, the newest smoothed samples and a running
+ lockout out of a context (e.g. on link loss). ProxRssi_Restore puts them back
+ into a context if its newest sample is younger than warmMs, with a confidence
+ that decays with that age: the gap is cut out of the history, which keeps
+ only the newest (warmMs - age) / warmMs share of its samples, and the first
+ fresh sample moves the EMA by at least age / warmMs of the difference. A
+ running lockout carries over in real time; a CANDIDATE hold is credited with
+ the same share, but never more than stableMs / 2, so at least half of the
+ hold is on fresh samples. The Hampel window always refills from scratch.
+
+ ProxRssi_Handover is the same restore for a snapshot of a context that
+ followed the same peer up to the handover from another RSSI source
+ (advertising reports before the link is up): the CANDIDATE hold carries over
+ in full, so an approach made before the connection unlocks on the first
+ stable sample of the link.
+
  CALIBRATION
  -----------
  - enterNearQ4: threshold at ~2 m (phone to anchor)
@@ -40,6 +74,7 @@
 */
 
 #include "EmbeddedTypes.h"
+#include "prox_time.h"
 
 #ifndef E_OK
 typedef uint8_t Std_ReturnType;
@@ -69,8 +104,16 @@ typedef uint8_t Std_ReturnType;
 #define PROX_RSSI_ALPHA_LUT_STEP_MS (16u)
 #endif
 
+/* Longest alpha ramp (alphaRampHiMs - alphaRampLoMs), keeps it in 32-bit math */
+#define PROX_RSSI_ALPHA_RAMP_MAX_MS (32767u)
+
 #define PROX_RSSI_ALPHA_LUT_SIZE ((PROX_RSSI_ALPHA_LUT_MAX_MS / PROX_RSSI_ALPHA_LUT_STEP_MS) + 1u)
 
+/* Newest smoothed samples kept by ProxRssi_Snapshot */
+#ifndef PROX_RSSI_SNAP_CAP
+#define PROX_RSSI_SNAP_CAP    (32u)
+#endif
+
 #define PROX_RSSI_Q4_SCALE          ((int16_t)16)
 #define PROX_RSSI_Q15_ONE           (32767u)
 
@@ -118,6 +161,19 @@ typedef struct
 
   /* Time anomaly handling */
   uint32_t maxReasonableDtMs; /* e.g. 2000; if dt > this => full reset */
+
+  /* Optional linear alpha law (0 => alpha from the LUT) */
+  uint16_t alphaLoQ15;     /* alpha at dt <= alphaRampLoMs, e.g. 0.10 => 3277 */
+  uint16_t alphaHiQ15;     /* alpha at dt >= alphaRampHiMs, e.g. 0.80 => 26214 */
+  uint32_t alphaRampLoMs;  /* e.g. 50 */
+  uint32_t alphaRampHiMs;  /* e.g. 500; if 0, LUT */
+
+  /* Optional decision gating (FALSE => ProxRssi default) */
+  bool_t stepSparse;       /* also step on < minFeatSamples, stability gate closed */
+  bool_t primeFirst;       /* sample that seeds the EMA does not step the state */
+
+  /* Timestamp resolution */
+  uint16_t ticksPerMs;     /* e.g. PROX_TIME_TICKS_PER_MS; if 0, timestamps in ms */
 } ProxRssi_ParamsType;
 
 typedef struct
@@ -146,9 +202,23 @@ typedef struct
   uint16_t count;
 } ProxRssi_SmoothBufType;
 
+/* Windows and timers of ProxRssi_ParamsType in timestamp ticks */
+typedef struct
+{
+  uint32_t perMs;
+  uint32_t wRaw;
+  uint32_t wSpike;
+  uint32_t wFeat;
+  uint32_t stable;
+  uint32_t exitConfirm;
+  uint32_t lockout;
+  uint32_t maxReasonableDt;
+} ProxRssi_TicksType;
+
 typedef struct
 {
   ProxRssi_ParamsType p;
+  ProxRssi_TicksType  tk;
   ProxRssi_StateType  st;
 
   uint32_t tCandidateStartMs;
@@ -158,6 +228,7 @@ typedef struct
   bool_t emaValid;
   int16_t emaQ4;
   uint32_t emaPrevMs;
+  uint16_t emaWarmQ15;     /* alpha floor of the first sample after ProxRssi_Restore */
 
   ProxRssi_RawBufType    raw;
   ProxRssi_SmoothBufType smooth;
@@ -170,6 +241,23 @@ typedef struct
   int16_t tmpS[PROX_RSSI_SMOOTH_CAP];
 } ProxRssi_CtxType;
 
+/* Filter history of a context, ProxRssi_Snapshot / ProxRssi_Restore (times in ticks) */
+typedef struct
+{
+  uint32_t tLastMs;        /* newest sample (last EMA update) */
+  uint32_t perMs;          /* ticks per ms of the source context */
+  uint32_t lockoutLeftMs;  /* lockout left at tLastMs, 0 if none */
+  uint32_t candidateMs;    /* CANDIDATE held at tLastMs, 0 if none */
+
+  bool_t emaValid;         /* FALSE => empty snapshot */
+  int16_t emaQ4;
+
+  /* Newest smoothed samples, oldest first, ages before tLastMs */
+  uint16_t count;
+  uint32_t ageMs[PROX_RSSI_SNAP_CAP];
+  int16_t rssiQ4[PROX_RSSI_SNAP_CAP];
+} ProxRssi_SnapshotType;
+
 /* Helpers */
 int16_t ProxRssi_DbmToQ4(int8_t dbm);
 int16_t ProxRssi_DbToQ4(int16_t db);
@@ -188,4 +276,17 @@ Std_ReturnType ProxRssi_MainFunction(ProxRssi_CtxType* Ctx, uint32_t nowMs,
 
 Std_ReturnType ProxRssi_ForceFar(ProxRssi_CtxType* Ctx);
 
+Std_ReturnType ProxRssi_Snapshot(const ProxRssi_CtxType* Ctx, ProxRssi_SnapshotType* Snap);
+
+/* E_NOT_OK (context left cold, as ProxRssi_ForceFar) if the snapshot is empty,
+ * from another timebase or its newest sample is not younger than warmMs */
+Std_ReturnType ProxRssi_Restore(ProxRssi_CtxType* Ctx, uint32_t nowMs,
+                                const ProxRssi_SnapshotType* Snap,
+                                uint32_t warmMs);
+
+/* ProxRssi_Restore, with the CANDIDATE hold of the snapshot credited up to stableMs */
+Std_ReturnType ProxRssi_Handover(ProxRssi_CtxType* Ctx, uint32_t nowMs,
+                                 const ProxRssi_SnapshotType* Snap,
+                                 uint32_t warmMs);
+
 #endif /* PROX_RSSI_H */
@@ -0,0 +1,212 @@
+/*! *********************************************************************************
+* \file addr_cache.c
+*
+* Cache of advertising addresses already matched against the bonds. See addr_cache.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "addr_cache.h"
+#include "FunctionLib.h"
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+#define ADDR_CACHE_FREE             (0xFFu)
+
+/* Fails to compile when ADDR_CACHE_SETS is not a power of two */
+typedef uint8_t addrCacheSetsCheck_t[((ADDR_CACHE_SETS & (ADDR_CACHE_SETS - 1u)) == 0u) ? 1 : -1];
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef struct
+{
+    uint8_t  aAddress[ADDR_CACHE_ADDR_SIZE];
+    uint8_t  addrType;              /* ADDR_CACHE_FREE when the entry is free */
+    uint8_t  nvmIndex;
+    uint32_t lastUse;
+} addrCacheEntry_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static addrCacheEntry_t gaAddrCache[ADDR_CACHE_SETS][ADDR_CACHE_WAYS];
+static uint32_t         gAddrCacheClock;
+static addrCacheStats_t gAddrCacheStats;
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static addrCacheEntry_t *AddrCache_Set(uint8_t addrType, const uint8_t *pAddress);
+static addrCacheEntry_t *AddrCache_Find(addrCacheEntry_t *pSet, uint8_t addrType, const uint8_t *pAddress);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Drop all entries and clear the counters
+********************************************************************************** */
+void AddrCache_Init(void)
+{
+    FLib_MemSet(&gAddrCacheStats, 0, sizeof(gAddrCacheStats));
+    gAddrCacheClock = 0u;
+    AddrCache_Flush();
+}
+
+/*! *********************************************************************************
+* \brief     Drop all entries, the bond table changed
+********************************************************************************** */
+void AddrCache_Flush(void)
+{
+    uint8_t s;
+    uint8_t w;
+
+    for (s = 0u; s < ADDR_CACHE_SETS; s++)
+    {
+        for (w = 0u; w < ADDR_CACHE_WAYS; w++)
+        {
+            gaAddrCache[s][w].addrType = ADDR_CACHE_FREE;
+        }
+    }
+    gAddrCacheStats.entries = 0u;
+}
+
+/*! *********************************************************************************
+* \brief     Look an address up
+********************************************************************************** */
+bool_t AddrCache_Lookup(uint8_t addrType, const uint8_t *pAddress, uint8_t *pNvmIndex)
+{
+    addrCacheEntry_t *pEntry = NULL;
+
+    if ((pAddress != NULL) && (addrType != ADDR_CACHE_FREE))
+    {
+        pEntry = AddrCache_Find(AddrCache_Set(addrType, pAddress), addrType, pAddress);
+    }
+
+    if (pEntry == NULL)
+    {
+        gAddrCacheStats.misses++;
+        return FALSE;
+    }
+
+    pEntry->lastUse = ++gAddrCacheClock;
+    gAddrCacheStats.hits++;
+    if (pNvmIndex != NULL)
+    {
+        *pNvmIndex = pEntry->nvmIndex;
+    }
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     Remember the bond an address was matched to
+********************************************************************************** */
+void AddrCache_Insert(uint8_t addrType, const uint8_t *pAddress, uint8_t nvmIndex)
+{
+    addrCacheEntry_t *pSet;
+    addrCacheEntry_t *pEntry;
+    uint8_t w;
+
+    if ((pAddress == NULL) || (addrType == ADDR_CACHE_FREE))
+    {
+        return;
+    }
+
+    pSet = AddrCache_Set(addrType, pAddress);
+    pEntry = AddrCache_Find(pSet, addrType, pAddress);
+
+    if (pEntry == NULL)
+    {
+        /* A free entry, else the least recently used one (wrap safe age) */
+        pEntry = &pSet[0];
+        for (w = 0u; w < ADDR_CACHE_WAYS; w++)
+        {
+            if (pSet[w].addrType == ADDR_CACHE_FREE)
+            {
+                pEntry = &pSet[w];
+                break;
+            }
+            if ((gAddrCacheClock - pSet[w].lastUse) > (gAddrCacheClock - pEntry->lastUse))
+            {
+                pEntry = &pSet[w];
+            }
+        }
+
+        if (pEntry->addrType == ADDR_CACHE_FREE)
+        {
+            gAddrCacheStats.entries++;
+        }
+        else
+        {
+            gAddrCacheStats.evictions++;
+        }
+
+        FLib_MemCpy(pEntry->aAddress, pAddress, ADDR_CACHE_ADDR_SIZE);
+        pEntry->addrType = addrType;
+    }
+
+    pEntry->nvmIndex = nvmIndex;
+    pEntry->lastUse = ++gAddrCacheClock;
+}
+
+/*! *********************************************************************************
+* \brief     Copy the counters
+********************************************************************************** */
+void AddrCache_GetStats(addrCacheStats_t *pStats)
+{
+    if (pStats != NULL)
+    {
+        *pStats = gAddrCacheStats;
+    }
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+/* FNV-1a of type and address, folded onto the sets */
+static addrCacheEntry_t *AddrCache_Set(uint8_t addrType, const uint8_t *pAddress)
+{
+    uint32_t hash = 2166136261u;
+    uint8_t i;
+
+    hash = (hash ^ addrType) * 16777619u;
+    for (i = 0u; i < ADDR_CACHE_ADDR_SIZE; i++)
+    {
+        hash = (hash ^ pAddress[i]) * 16777619u;
+    }
+    hash ^= hash >> 16;
+
+    return gaAddrCache[hash & (ADDR_CACHE_SETS - 1u)];
+}
+
+static addrCacheEntry_t *AddrCache_Find(addrCacheEntry_t *pSet, uint8_t addrType, const uint8_t *pAddress)
+{
+    addrCacheEntry_t *pEntry = NULL;
+    uint8_t w;
+
+    for (w = 0u; w < ADDR_CACHE_WAYS; w++)
+    {
+        if ((pSet[w].addrType == addrType) &&
+            (FLib_MemCmp(pSet[w].aAddress, pAddress, ADDR_CACHE_ADDR_SIZE) == TRUE))
+        {
+            pEntry = &pSet[w];
+            break;
+        }
+    }
+
+    return pEntry;
+}
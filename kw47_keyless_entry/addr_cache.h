@@ -0,0 +1,107 @@
+/*! *********************************************************************************
+* \file addr_cache.h
+*
+* Cache of advertising addresses already matched against the bonds.
+*
+* The Passive Entry scan runs on the Filter Accept List with controller address
+* resolution: other advertisers never reach the host, and a bonded phone is
+* reported with its identity address, whatever private address it advertises
+* with. Each report is matched against the bond table; the cache keeps the bond
+* NVM index of the identity addresses seen, so that the steady stream of reports
+* of the same phones costs one short compare.
+*
+* Only bonded identities are inserted. Unmatched addresses are not remembered
+* and private addresses are not resolved on the host: with the accept list
+* neither reaches the scan callback, and the controller follows the phones' RPA
+* rotation.
+*
+* The cache is set associative: the address hashes to one set of ADDR_CACHE_WAYS
+* entries, so a lookup compares at most ADDR_CACHE_WAYS addresses. A full set
+* gives up its least recently used entry. A change of the bond table invalidates
+* the whole cache (AddrCache_Flush): an identity may now belong to another bond.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef ADDR_CACHE_H
+#define ADDR_CACHE_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Sets, a power of two */
+#ifndef ADDR_CACHE_SETS
+#define ADDR_CACHE_SETS             (4u)
+#endif
+
+/* Entries per set, compared on each lookup */
+#ifndef ADDR_CACHE_WAYS
+#define ADDR_CACHE_WAYS             (4u)
+#endif
+
+#define ADDR_CACHE_ADDR_SIZE        (6u)
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+typedef struct
+{
+    uint32_t hits;                  /* Lookups answered */
+    uint32_t misses;                /* Lookups left to the caller */
+    uint32_t evictions;             /* Entries given up by a full set */
+    uint8_t  entries;               /* Entries in use now */
+} addrCacheStats_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Drop all entries and clear the counters
+********************************************************************************** */
+void AddrCache_Init(void);
+
+/*! *********************************************************************************
+* \brief     Drop all entries, the bond table changed
+********************************************************************************** */
+void AddrCache_Flush(void);
+
+/*! *********************************************************************************
+* \brief     Look an address up
+*
+* \param[in]  addrType      Address type of the report.
+* \param[in]  pAddress      Address of the report.
+* \param[out] pNvmIndex     Bond NVM index.
+*
+* \return     TRUE on a hit, FALSE if the caller has to match the address itself.
+********************************************************************************** */
+bool_t AddrCache_Lookup(uint8_t addrType, const uint8_t *pAddress, uint8_t *pNvmIndex);
+
+/*! *********************************************************************************
+* \brief     Remember the bond an address was matched to
+*
+* \param[in] addrType       Address type of the report.
+* \param[in] pAddress       Identity address of the bond.
+* \param[in] nvmIndex       Bond NVM index.
+********************************************************************************** */
+void AddrCache_Insert(uint8_t addrType, const uint8_t *pAddress, uint8_t nvmIndex);
+
+/*! *********************************************************************************
+* \brief     Copy the counters
+********************************************************************************** */
+void AddrCache_GetStats(addrCacheStats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADDR_CACHE_H */
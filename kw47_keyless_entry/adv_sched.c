@@ -0,0 +1,148 @@
+/*! *********************************************************************************
+* \file adv_sched.c
+*
+* Advertising interval and PHY of Passive Entry from the vehicle context. See adv_sched.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "adv_sched.h"
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef struct
+{
+    uint16_t minInterval;
+    uint16_t maxInterval;
+    uint16_t codedInterval;
+} advSchedIntervals_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static const advSchedIntervals_t gaAdvSchedIntervals[advSchedLevelCount_c] =
+{
+    {ADV_SCHED_FAST_MIN,    ADV_SCHED_FAST_MAX,    ADV_SCHED_FAST_CODED},
+    {ADV_SCHED_ACTIVE_MIN,  ADV_SCHED_ACTIVE_MAX,  ADV_SCHED_ACTIVE_CODED},
+    {ADV_SCHED_REDUCED_MIN, ADV_SCHED_REDUCED_MAX, ADV_SCHED_REDUCED_CODED},
+    {ADV_SCHED_PARKED_MIN,  ADV_SCHED_PARKED_MAX,  ADV_SCHED_PARKED_CODED},
+};
+
+static uint32_t        gAdvSchedFastUntilS;
+static uint32_t        gAdvSchedActivityS;
+static advSchedLevel_t gAdvSchedLevel = advSchedLevelCount_c;
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static void AdvSched_Fast(uint32_t nowS, uint32_t forS);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Start of Passive Entry, the owner is at the car: FAST
+********************************************************************************** */
+void AdvSched_Init(uint32_t nowS)
+{
+    gAdvSchedFastUntilS = nowS;
+    gAdvSchedLevel = advSchedLevelCount_c;
+    AdvSched_Fast(nowS, ADV_SCHED_RECONNECT_S);
+}
+
+/*! *********************************************************************************
+* \brief     A phone disconnected: FAST, then the car counts as in use
+********************************************************************************** */
+void AdvSched_Disconnected(uint32_t nowS)
+{
+    AdvSched_Fast(nowS, ADV_SCHED_RECONNECT_S);
+}
+
+/*! *********************************************************************************
+* \brief     The car was unlocked: in use from now on
+********************************************************************************** */
+void AdvSched_Unlocked(uint32_t nowS)
+{
+    gAdvSchedActivityS = nowS;
+}
+
+/*! *********************************************************************************
+* \brief     The scan saw a bonded phone near the car: FAST
+********************************************************************************** */
+void AdvSched_PeerNearby(uint32_t nowS)
+{
+    AdvSched_Fast(nowS, ADV_SCHED_NEARBY_S);
+}
+
+/*! *********************************************************************************
+* \brief     Profile to advertise with now
+********************************************************************************** */
+bool_t AdvSched_Select(uint32_t nowS, advSchedProfile_t *pProfile)
+{
+    /* Wrap safe: the clock runs for 136 years of seconds anyway */
+    const int32_t fastLeftS = (int32_t)(gAdvSchedFastUntilS - nowS);
+    const uint32_t idleS = nowS - gAdvSchedActivityS;
+    advSchedLevel_t level;
+    uint32_t holdS;
+    bool_t changed;
+
+    if (fastLeftS > 0)
+    {
+        level = advSchedFast_c;
+        holdS = (uint32_t)fastLeftS;
+    }
+    else if (idleS < ADV_SCHED_RECENT_S)
+    {
+        level = advSchedActive_c;
+        holdS = ADV_SCHED_RECENT_S - idleS;
+    }
+    else if (idleS < ADV_SCHED_PARKED_S)
+    {
+        level = advSchedReduced_c;
+        holdS = ADV_SCHED_PARKED_S - idleS;
+    }
+    else
+    {
+        level = advSchedParked_c;
+        holdS = 0u;
+    }
+
+    changed = (level != gAdvSchedLevel) ? TRUE : FALSE;
+    gAdvSchedLevel = level;
+
+    if (pProfile != NULL)
+    {
+        pProfile->level = level;
+        pProfile->minInterval = gaAdvSchedIntervals[level].minInterval;
+        pProfile->maxInterval = gaAdvSchedIntervals[level].maxInterval;
+        pProfile->codedInterval = gaAdvSchedIntervals[level].codedInterval;
+        pProfile->holdS = holdS;
+    }
+
+    return changed;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+/* FAST for at least forS from now, activity now */
+static void AdvSched_Fast(uint32_t nowS, uint32_t forS)
+{
+    if ((int32_t)((nowS + forS) - gAdvSchedFastUntilS) > 0)
+    {
+        gAdvSchedFastUntilS = nowS + forS;
+    }
+    gAdvSchedActivityS = nowS;
+}
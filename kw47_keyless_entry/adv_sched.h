@@ -0,0 +1,148 @@
+/*! *********************************************************************************
+* \file adv_sched.h
+*
+* Advertising interval and PHY of Passive Entry, chosen from the vehicle context.
+*
+* Passive Entry advertises on two sets, legacy 1M at the CCC interval and LE Coded
+* for range, both for as long as no phone is connected. That is right while the
+* owner is around and wasteful once the car has been parked for hours. The
+* scheduler picks one of four profiles from what happened last:
+*
+*   FAST     ADV_SCHED_RECONNECT_S after Passive Entry started or a phone
+*            disconnected (the owner just walked away and may turn back), and
+*            ADV_SCHED_NEARBY_S after the scan saw a bonded phone near the car
+*   ACTIVE   until ADV_SCHED_RECENT_S after the last disconnect, unlock, start
+*            or phone nearby
+*   REDUCED  until ADV_SCHED_PARKED_S after it, legacy set only
+*   PARKED   after that, legacy set only
+*
+* Times are seconds of any monotonic clock. Intervals are in 0.625 ms units as in
+* gapExtAdvertisingParameters_t; a coded interval of 0 keeps the LE Coded set off.
+* tools/adv_sched_sim.c models discovery latency against radio duty cycle per
+* profile.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef ADV_SCHED_H
+#define ADV_SCHED_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Fast advertising after a start or disconnect (gAdvTime_c of the example) */
+#ifndef ADV_SCHED_RECONNECT_S
+#define ADV_SCHED_RECONNECT_S               (30u)
+#endif
+
+/* Fast advertising after a bonded phone was seen near the car by the scan */
+#ifndef ADV_SCHED_NEARBY_S
+#define ADV_SCHED_NEARBY_S                  (10u)
+#endif
+
+/* Car in use: ACTIVE profile up to this long after the last activity */
+#ifndef ADV_SCHED_RECENT_S
+#define ADV_SCHED_RECENT_S                  (600u)
+#endif
+
+/* Car parked: REDUCED profile up to this long after the last activity, then PARKED */
+#ifndef ADV_SCHED_PARKED_S
+#define ADV_SCHED_PARKED_S                  (7200u)
+#endif
+
+/* Profiles: legacy min/max interval, LE Coded interval (0: off), 0.625 ms units */
+#ifndef ADV_SCHED_FAST_MIN
+#define ADV_SCHED_FAST_MIN                  (68u)       /* 42.5 ms, CCC */
+#define ADV_SCHED_FAST_MAX                  (68u)
+#define ADV_SCHED_FAST_CODED                (135u)      /* 84.4 ms, CCC */
+#endif
+
+#ifndef ADV_SCHED_ACTIVE_MIN
+#define ADV_SCHED_ACTIVE_MIN                (244u)      /* 152.5 ms */
+#define ADV_SCHED_ACTIVE_MAX                (244u)
+#define ADV_SCHED_ACTIVE_CODED              (488u)      /* 305 ms */
+#endif
+
+#ifndef ADV_SCHED_REDUCED_MIN
+#define ADV_SCHED_REDUCED_MIN               (1600u)     /* 1 s */
+#define ADV_SCHED_REDUCED_MAX               (4000u)     /* 2.5 s */
+#define ADV_SCHED_REDUCED_CODED             (0u)
+#endif
+
+#ifndef ADV_SCHED_PARKED_MIN
+#define ADV_SCHED_PARKED_MIN                (4000u)     /* 2.5 s */
+#define ADV_SCHED_PARKED_MAX                (8000u)     /* 5 s */
+#define ADV_SCHED_PARKED_CODED              (0u)
+#endif
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+typedef enum
+{
+    advSchedFast_c = 0,
+    advSchedActive_c,
+    advSchedReduced_c,
+    advSchedParked_c,
+    advSchedLevelCount_c
+} advSchedLevel_t;
+
+typedef struct
+{
+    advSchedLevel_t level;
+    uint16_t        minInterval;    /* Legacy 1M set */
+    uint16_t        maxInterval;
+    uint16_t        codedInterval;  /* LE Coded set, 0 when not advertised */
+    uint32_t        holdS;          /* Until the next level by time alone, 0 for PARKED */
+} advSchedProfile_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Start of Passive Entry, the owner is at the car: FAST
+*
+* \param[in] nowS       Current time, seconds.
+********************************************************************************** */
+void AdvSched_Init(uint32_t nowS);
+
+/*! *********************************************************************************
+* \brief     A phone disconnected: FAST, then the car counts as in use
+********************************************************************************** */
+void AdvSched_Disconnected(uint32_t nowS);
+
+/*! *********************************************************************************
+* \brief     The car was unlocked: in use from now on
+********************************************************************************** */
+void AdvSched_Unlocked(uint32_t nowS);
+
+/*! *********************************************************************************
+* \brief     The scan saw a bonded phone near the car: FAST
+********************************************************************************** */
+void AdvSched_PeerNearby(uint32_t nowS);
+
+/*! *********************************************************************************
+* \brief     Profile to advertise with now
+*
+* \param[in]  nowS      Current time, seconds.
+* \param[out] pProfile  Profile.
+*
+* \return     TRUE if the level differs from the one of the previous call.
+********************************************************************************** */
+bool_t AdvSched_Select(uint32_t nowS, advSchedProfile_t *pProfile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADV_SCHED_H */
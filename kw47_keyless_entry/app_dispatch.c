@@ -0,0 +1,300 @@
+/*! *********************************************************************************
+* \file app_dispatch.c
+*
+* Table driven dispatch of application events. See app_dispatch.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "app_dispatch.h"
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+#define APP_DISPATCH_BUCKET_MAX         (0xFFFFu)
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+#if (APP_DISPATCH_TRACE_EVENTS > 0u)
+typedef struct
+{
+    uint32_t total;                                     /* Sum of aBucket[] */
+    uint32_t maxUs;
+    uint16_t aBucket[APP_DISPATCH_TRACE_BUCKETS];
+} appDispatchHist_t;
+
+typedef struct
+{
+    uint32_t          count;
+    appDispatchHist_t queue;
+    appDispatchHist_t run;
+} appDispatchTrace_t;
+#endif /* (APP_DISPATCH_TRACE_EVENTS > 0u) */
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static appDispatchNowUs_t    gpfAppDispatchNowUs;
+static appDispatchPostedUs_t gpfAppDispatchPostedUs;
+
+#if (APP_DISPATCH_TRACE_EVENTS > 0u)
+static appDispatchTrace_t gaAppDispatchTrace[APP_DISPATCH_TRACE_EVENTS];
+#endif /* (APP_DISPATCH_TRACE_EVENTS > 0u) */
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+#if (APP_DISPATCH_TRACE_EVENTS > 0u)
+static void AppDispatch_Record(appDispatchHist_t *pHist, uint32_t us);
+static uint32_t AppDispatch_Percentile(const appDispatchHist_t *pHist, uint8_t percent);
+#endif /* (APP_DISPATCH_TRACE_EVENTS > 0u) */
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Build the state x event index of a table
+********************************************************************************** */
+bool_t AppDispatch_Build(appDispatchTable_t *pTable)
+{
+    const uint32_t cells = (uint32_t)pTable->stateCount * pTable->eventCount;
+    bool_t valid = (pTable->rowCount < APP_DISPATCH_NO_ROW) ? TRUE : FALSE;
+    uint32_t i;
+    uint8_t r;
+    uint8_t e;
+
+    for (i = 0u; i < cells; i++)
+    {
+        pTable->pIndex[i] = APP_DISPATCH_NO_ROW;
+    }
+
+    for (r = 0u; (r < pTable->rowCount) && (r < APP_DISPATCH_NO_ROW); r++)
+    {
+        const appDispatchRow_t *pRow = &pTable->pRows[r];
+        uint8_t *pCells = &pTable->pIndex[(uint32_t)pRow->state * pTable->eventCount];
+
+        if ((pRow->state >= pTable->stateCount) || (pRow->pfHandler == NULL) ||
+            ((pRow->event >= pTable->eventCount) && (pRow->event != APP_DISPATCH_ANY_EVENT)))
+        {
+            valid = FALSE;
+        }
+        else if (pRow->event != APP_DISPATCH_ANY_EVENT)
+        {
+            /* A specific row wins over an ANY row, whatever the order */
+            pCells[pRow->event] = r;
+        }
+        else
+        {
+            for (e = 0u; e < pTable->eventCount; e++)
+            {
+                if ((pCells[e] == APP_DISPATCH_NO_ROW) ||
+                    (pTable->pRows[pCells[e]].event == APP_DISPATCH_ANY_EVENT))
+                {
+                    pCells[e] = r;
+                }
+            }
+        }
+    }
+
+    return valid;
+}
+
+/*! *********************************************************************************
+* \brief     Run the handler of (state, event)
+********************************************************************************** */
+bool_t AppDispatch_Run(const appDispatchTable_t *pTable, uint8_t state, uint8_t peerId, uint8_t event)
+{
+    uint8_t row;
+    uint32_t startUs;
+
+    if ((state >= pTable->stateCount) || (event >= pTable->eventCount))
+    {
+        return FALSE;
+    }
+
+    row = pTable->pIndex[((uint32_t)state * pTable->eventCount) + event];
+    if (row == APP_DISPATCH_NO_ROW)
+    {
+        return FALSE;
+    }
+
+    startUs = AppDispatch_TraceBegin();
+    pTable->pRows[row].pfHandler(peerId, event);
+    AppDispatch_TraceEnd(event, startUs);
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     Set the time hooks of the trace
+********************************************************************************** */
+void AppDispatch_SetTraceHooks(appDispatchNowUs_t pfNowUs, appDispatchPostedUs_t pfPostedUs)
+{
+    gpfAppDispatchNowUs = pfNowUs;
+    gpfAppDispatchPostedUs = pfPostedUs;
+}
+
+/*! *********************************************************************************
+* \brief     Start time of a handler traced outside the table
+********************************************************************************** */
+uint32_t AppDispatch_TraceBegin(void)
+{
+    return (gpfAppDispatchNowUs != NULL) ? gpfAppDispatchNowUs() : 0u;
+}
+
+/*! *********************************************************************************
+* \brief     Record a handler traced outside the table
+********************************************************************************** */
+void AppDispatch_TraceEnd(uint8_t event, uint32_t startUs)
+{
+#if (APP_DISPATCH_TRACE_EVENTS > 0u)
+    appDispatchTrace_t *pTrace;
+    uint32_t postedUs;
+
+    if ((gpfAppDispatchNowUs == NULL) || (event >= APP_DISPATCH_TRACE_EVENTS))
+    {
+        return;
+    }
+
+    pTrace = &gaAppDispatchTrace[event];
+    AppDispatch_Record(&pTrace->run, gpfAppDispatchNowUs() - startUs);
+    if ((gpfAppDispatchPostedUs != NULL) && (gpfAppDispatchPostedUs(&postedUs) == TRUE))
+    {
+        AppDispatch_Record(&pTrace->queue, startUs - postedUs);
+    }
+    if (pTrace->count < 0xFFFFFFFFu)
+    {
+        pTrace->count++;
+    }
+#else
+    (void)event;
+    (void)startUs;
+#endif /* (APP_DISPATCH_TRACE_EVENTS > 0u) */
+}
+
+/*! *********************************************************************************
+* \brief     Clear the trace histograms
+********************************************************************************** */
+void AppDispatch_ResetTrace(void)
+{
+#if (APP_DISPATCH_TRACE_EVENTS > 0u)
+    uint8_t *pByte = (uint8_t *)gaAppDispatchTrace;
+    uint32_t i;
+
+    for (i = 0u; i < sizeof(gaAppDispatchTrace); i++)
+    {
+        pByte[i] = 0u;
+    }
+#endif /* (APP_DISPATCH_TRACE_EVENTS > 0u) */
+}
+
+/*! *********************************************************************************
+* \brief     Trace statistics of an event type
+********************************************************************************** */
+bool_t AppDispatch_GetTrace(uint8_t event, appDispatchStats_t *pStats)
+{
+#if (APP_DISPATCH_TRACE_EVENTS > 0u)
+    const appDispatchTrace_t *pTrace;
+
+    if ((pStats == NULL) || (event >= APP_DISPATCH_TRACE_EVENTS) || (gaAppDispatchTrace[event].count == 0u))
+    {
+        return FALSE;
+    }
+
+    pTrace = &gaAppDispatchTrace[event];
+    pStats->count = pTrace->count;
+    pStats->queued = pTrace->queue.total;
+    pStats->queueP50Us = AppDispatch_Percentile(&pTrace->queue, 50u);
+    pStats->queueP95Us = AppDispatch_Percentile(&pTrace->queue, 95u);
+    pStats->queueMaxUs = pTrace->queue.maxUs;
+    pStats->runP50Us = AppDispatch_Percentile(&pTrace->run, 50u);
+    pStats->runP95Us = AppDispatch_Percentile(&pTrace->run, 95u);
+    pStats->runMaxUs = pTrace->run.maxUs;
+
+    return TRUE;
+#else
+    (void)event;
+    (void)pStats;
+    return FALSE;
+#endif /* (APP_DISPATCH_TRACE_EVENTS > 0u) */
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+#if (APP_DISPATCH_TRACE_EVENTS > 0u)
+static void AppDispatch_Record(appDispatchHist_t *pHist, uint32_t us)
+{
+    uint8_t bucket = 0u;
+    uint8_t i;
+
+    /* Bucket of the leading one above 2^3 */
+    while (((us >> (bucket + 4u)) != 0u) && (bucket < (APP_DISPATCH_TRACE_BUCKETS - 1u)))
+    {
+        bucket++;
+    }
+
+    /* Saturate by halving, as cs_latency.c does */
+    if (pHist->aBucket[bucket] == APP_DISPATCH_BUCKET_MAX)
+    {
+        pHist->total = 0u;
+        for (i = 0u; i < APP_DISPATCH_TRACE_BUCKETS; i++)
+        {
+            pHist->aBucket[i] = (uint16_t)(pHist->aBucket[i] >> 1u);
+            pHist->total += pHist->aBucket[i];
+        }
+    }
+
+    pHist->aBucket[bucket]++;
+    pHist->total++;
+    if (us > pHist->maxUs)
+    {
+        pHist->maxUs = us;
+    }
+}
+
+static uint32_t AppDispatch_Percentile(const appDispatchHist_t *pHist, uint8_t percent)
+{
+    uint32_t rank;
+    uint32_t seen = 0u;
+    uint32_t value = pHist->maxUs;
+    uint8_t bucket;
+
+    if (pHist->total == 0u)
+    {
+        return 0u;
+    }
+
+    /* Upper edge of the smallest bucket holding at least percent % of the samples */
+    rank = (((pHist->total * (uint32_t)percent) + 99u) / 100u);
+    if (rank == 0u)
+    {
+        rank = 1u;
+    }
+
+    for (bucket = 0u; bucket < (APP_DISPATCH_TRACE_BUCKETS - 1u); bucket++)
+    {
+        seen += pHist->aBucket[bucket];
+        if (seen >= rank)
+        {
+            value = (1uL << (bucket + 4u)) - 1u;
+            break;
+        }
+    }
+
+    return (value > pHist->maxUs) ? pHist->maxUs : value;
+}
+#endif /* (APP_DISPATCH_TRACE_EVENTS > 0u) */
@@ -0,0 +1,156 @@
+/*! *********************************************************************************
+* \file app_dispatch.h
+*
+* Table driven dispatch of application events, with per event latency tracing.
+*
+* The application state machine is a list of rows (state, event, handler). At init
+* AppDispatch_Build turns it into a state x event index of one byte per cell, so a
+* dispatch is one table read whatever the number of states and events. A row with
+* APP_DISPATCH_ANY_EVENT takes every event of its state no other row of that state
+* claims. Events without a row are ignored.
+*
+* Tracing is optional. With time hooks set (AppDispatch_SetTraceHooks) every
+* dispatch records, per event type:
+*   - the queueing latency, from the entry of the message being handled in the
+*     application queue to the start of the handler
+*   - the handler duration
+* in histograms of one bucket per power of two (16 us to 256 ms and above),
+* halved on saturation like cs_latency.c. Handlers outside the table (switch
+* based) trace themselves with AppDispatch_TraceBegin/End. A nested dispatch is
+* included in the duration of the outer one.
+*
+* Tracing costs 4 * APP_DISPATCH_TRACE_BUCKETS + 16 bytes of RAM per event type,
+* and is left out with APP_DISPATCH_TRACE_EVENTS set to 0.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef APP_DISPATCH_H
+#define APP_DISPATCH_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Event types traced (0 .. APP_DISPATCH_TRACE_EVENTS - 1), 0 to leave tracing out.
+   Must cover the event count of the table, the application checks it at build time */
+#ifndef APP_DISPATCH_TRACE_EVENTS
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+#define APP_DISPATCH_TRACE_EVENTS       (80u)
+#else
+#define APP_DISPATCH_TRACE_EVENTS       (0u)
+#endif
+#endif
+
+/* Histogram buckets: 0 below 16 us, b in [2^(b+3), 2^(b+4)) us, the last open ended */
+#define APP_DISPATCH_TRACE_BUCKETS      (16u)
+
+/* Row event matching every event of its state not claimed by another row */
+#define APP_DISPATCH_ANY_EVENT          (0xFFu)
+
+/* Index cell without a handler */
+#define APP_DISPATCH_NO_ROW             (0xFFu)
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+typedef void (*appDispatchHandler_t)(uint8_t peerId, uint8_t event);
+
+typedef struct
+{
+    uint8_t              state;
+    uint8_t              event;         /* Or APP_DISPATCH_ANY_EVENT */
+    appDispatchHandler_t pfHandler;
+} appDispatchRow_t;
+
+typedef struct
+{
+    const appDispatchRow_t *pRows;
+    uint8_t                 rowCount;   /* At most 254 */
+    uint8_t                 stateCount;
+    uint8_t                 eventCount;
+    uint8_t                *pIndex;     /* stateCount * eventCount cells, filled by AppDispatch_Build */
+} appDispatchTable_t;
+
+/* Current time, microseconds */
+typedef uint32_t (*appDispatchNowUs_t)(void);
+
+/* Entry time of the message being handled in the application queue, FALSE if unknown */
+typedef bool_t (*appDispatchPostedUs_t)(uint32_t *pPostedUs);
+
+typedef struct
+{
+    uint32_t count;                     /* Dispatches since reset */
+    uint32_t queued;                    /* Of which with a known queueing latency */
+    uint32_t queueP50Us;
+    uint32_t queueP95Us;
+    uint32_t queueMaxUs;
+    uint32_t runP50Us;
+    uint32_t runP95Us;
+    uint32_t runMaxUs;
+} appDispatchStats_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Build the state x event index of a table
+*
+* \return    FALSE if a row is out of range; the index then holds the valid rows.
+********************************************************************************** */
+bool_t AppDispatch_Build(appDispatchTable_t *pTable);
+
+/*! *********************************************************************************
+* \brief     Run the handler of (state, event), traced if the hooks are set
+*
+* \return    TRUE if a handler ran.
+********************************************************************************** */
+bool_t AppDispatch_Run(const appDispatchTable_t *pTable, uint8_t state, uint8_t peerId, uint8_t event);
+
+/*! *********************************************************************************
+* \brief     Set the time hooks of the trace, pfNowUs NULL stops tracing
+*
+* \param[in] pfNowUs        Current time.
+* \param[in] pfPostedUs     Queue entry time of the current message, NULL if unknown.
+********************************************************************************** */
+void AppDispatch_SetTraceHooks(appDispatchNowUs_t pfNowUs, appDispatchPostedUs_t pfPostedUs);
+
+/*! *********************************************************************************
+* \brief     Start time of a handler traced outside the table
+********************************************************************************** */
+uint32_t AppDispatch_TraceBegin(void);
+
+/*! *********************************************************************************
+* \brief     Record a handler traced outside the table
+*
+* \param[in] event          Event type handled.
+* \param[in] startUs        Value of AppDispatch_TraceBegin at the start of the handler.
+********************************************************************************** */
+void AppDispatch_TraceEnd(uint8_t event, uint32_t startUs);
+
+/*! *********************************************************************************
+* \brief     Clear the trace histograms
+********************************************************************************** */
+void AppDispatch_ResetTrace(void);
+
+/*! *********************************************************************************
+* \brief     Trace statistics of an event type
+*
+* \return    FALSE if the event type was not dispatched since the last reset.
+********************************************************************************** */
+bool_t AppDispatch_GetTrace(uint8_t event, appDispatchStats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_DISPATCH_H */
@@ -0,0 +1,427 @@
+/*! *********************************************************************************
+* \file conn_param.c
+*
+* Proximity driven connection parameters of the Digital Key link. See conn_param.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "conn_param.h"
+#include "prox_time.h"
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef struct
+{
+    bool_t   connected;
+    bool_t   subrate;               /* Idle profile through subrating */
+    bool_t   holding;               /* Active profile held until holdUntil */
+    bool_t   waiting;               /* No request before waitUntil */
+    uint8_t  demand;                /* CONN_PARAM_DEMAND_x raised */
+    uint8_t  rejects;               /* In a row */
+    connParamProfile_t profile;     /* In effect */
+    connParamProfile_t pending;     /* Requested, connParamProfileUnknown_c if none */
+    connParamAction_t  pendingAction;
+    uint16_t activeInterval;        /* Established with */
+    uint16_t activeLatency;
+    uint16_t activeTimeout;
+    uint16_t interval;              /* In effect */
+    uint16_t latency;
+    uint16_t factor;
+    uint32_t holdUntil;
+    uint32_t waitUntil;
+    uint32_t pendingUntil;
+    uint32_t idleSince;
+} connParamCtx_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static connParamCtx_t   gConnParam;
+static connParamStats_t gConnParamStats;
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static connParamProfile_t ConnParam_Classify(void);
+static void ConnParam_SetProfile(connParamProfile_t profile, uint32_t now);
+static void ConnParam_Reject(uint32_t now);
+static void ConnParam_Completed(bool_t success, connParamAction_t action, uint32_t now);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Forget the connection and clear the counters
+********************************************************************************** */
+void ConnParam_Init(void)
+{
+    gConnParam.connected = FALSE;
+    gConnParam.profile = connParamProfileUnknown_c;
+    gConnParam.pending = connParamProfileUnknown_c;
+
+    gConnParamStats.requests = 0u;
+    gConnParamStats.rejects = 0u;
+    gConnParamStats.timeouts = 0u;
+    gConnParamStats.toIdle = 0u;
+    gConnParamStats.toActive = 0u;
+    gConnParamStats.idleMs = 0u;
+    gConnParamStats.profile = connParamProfileUnknown_c;
+    gConnParamStats.subrate = FALSE;
+}
+
+/*! *********************************************************************************
+* \brief     Start managing a new connection
+********************************************************************************** */
+void ConnParam_Connected(uint16_t interval, uint16_t latency, uint16_t timeout, uint32_t now)
+{
+    /* Close the idle period of a connection that was not reported down */
+    ConnParam_SetProfile(connParamProfileUnknown_c, now);
+
+    gConnParam.connected = TRUE;
+    gConnParam.subrate = (CONN_PARAM_USE_SUBRATE != 0u) ? TRUE : FALSE;
+    gConnParam.demand = 0u;
+    gConnParam.rejects = 0u;
+    gConnParam.pending = connParamProfileUnknown_c;
+    gConnParam.pendingAction = connParamActionNone_c;
+    gConnParam.activeInterval = interval;
+    gConnParam.activeLatency = latency;
+    gConnParam.activeTimeout = timeout;
+    gConnParam.interval = interval;
+    gConnParam.latency = latency;
+    gConnParam.factor = 1u;
+
+    /* Setup traffic runs at the established parameters */
+    gConnParam.holding = TRUE;
+    gConnParam.holdUntil = now + PROX_TIME_MS_TO_TICKS(CONN_PARAM_CONNECT_HOLD_MS);
+    gConnParam.waiting = FALSE;
+
+    gConnParam.profile = connParamProfileActive_c;
+    gConnParamStats.profile = connParamProfileActive_c;
+    gConnParamStats.subrate = gConnParam.subrate;
+}
+
+/*! *********************************************************************************
+* \brief     Stop managing the connection
+********************************************************************************** */
+void ConnParam_Disconnected(uint32_t now)
+{
+    ConnParam_SetProfile(connParamProfileUnknown_c, now);
+    gConnParam.connected = FALSE;
+    gConnParam.pending = connParamProfileUnknown_c;
+}
+
+/*! *********************************************************************************
+* \brief     Raise or drop a reason to hold the active profile
+********************************************************************************** */
+void ConnParam_SetDemand(uint8_t demand, bool_t active, uint32_t now)
+{
+    uint8_t previous = gConnParam.demand;
+    uint32_t until;
+
+    if (active == TRUE)
+    {
+        gConnParam.demand |= demand;
+    }
+    else
+    {
+        gConnParam.demand &= (uint8_t)~demand;
+    }
+
+    /* Last demand dropped: stay active a little longer, unless already held longer */
+    if ((previous != 0u) && (gConnParam.demand == 0u))
+    {
+        until = now + PROX_TIME_MS_TO_TICKS(CONN_PARAM_IDLE_HOLD_MS);
+        if ((gConnParam.holding == FALSE) || (ProxTime_Before(gConnParam.holdUntil, until) == TRUE))
+        {
+            gConnParam.holdUntil = until;
+        }
+        gConnParam.holding = TRUE;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Request to send now, if any
+********************************************************************************** */
+connParamAction_t ConnParam_Poll(uint32_t now, connParamRequest_t *pReq)
+{
+    connParamAction_t action = connParamActionNone_c;
+    connParamProfile_t want;
+
+    if ((pReq == NULL) || (gConnParam.connected == FALSE))
+    {
+        return connParamActionNone_c;
+    }
+
+    pReq->intervalMin = 0u;
+    pReq->intervalMax = 0u;
+    pReq->latency = 0u;
+    pReq->timeout = 0u;
+    pReq->subrateMin = 0u;
+    pReq->subrateMax = 0u;
+    pReq->continuation = 0u;
+
+    /* One request in flight */
+    if (gConnParam.pending != connParamProfileUnknown_c)
+    {
+        if (ProxTime_Before(now, gConnParam.pendingUntil) == TRUE)
+        {
+            return connParamActionNone_c;
+        }
+        gConnParamStats.timeouts++;
+        ConnParam_Reject(now);
+    }
+
+    if ((gConnParam.holding == TRUE) && (ProxTime_Before(now, gConnParam.holdUntil) == FALSE))
+    {
+        gConnParam.holding = FALSE;
+    }
+    if ((gConnParam.waiting == TRUE) && (ProxTime_Before(now, gConnParam.waitUntil) == FALSE))
+    {
+        gConnParam.waiting = FALSE;
+    }
+
+    want = ((gConnParam.demand != 0u) || (gConnParam.holding == TRUE)) ?
+           connParamProfileActive_c : connParamProfileIdle_c;
+
+    if ((want == gConnParam.profile) || (gConnParam.waiting == TRUE) ||
+        ((want == connParamProfileIdle_c) && (gConnParam.rejects >= CONN_PARAM_MAX_REJECTS)))
+    {
+        return connParamActionNone_c;
+    }
+
+    if (want == connParamProfileActive_c)
+    {
+        if (gConnParam.factor > 1u)
+        {
+            /* Back to every underlying connection event */
+            action = connParamActionSubrate_c;
+            pReq->subrateMin = 1u;
+            pReq->subrateMax = 1u;
+            pReq->timeout = gConnParam.activeTimeout;
+        }
+        else
+        {
+            action = connParamActionUpdate_c;
+            pReq->intervalMin = gConnParam.activeInterval;
+            pReq->intervalMax = gConnParam.activeInterval;
+            pReq->latency = gConnParam.activeLatency;
+            pReq->timeout = gConnParam.activeTimeout;
+        }
+    }
+    else if (gConnParam.subrate == TRUE)
+    {
+        action = connParamActionSubrate_c;
+        pReq->subrateMin = CONN_PARAM_IDLE_SUBRATE_MIN;
+        pReq->subrateMax = CONN_PARAM_IDLE_SUBRATE_MAX;
+        pReq->continuation = CONN_PARAM_SUBRATE_CONTINUATION;
+        pReq->timeout = CONN_PARAM_IDLE_TIMEOUT;
+    }
+    else
+    {
+        action = connParamActionUpdate_c;
+        pReq->intervalMin = CONN_PARAM_IDLE_INTERVAL_MIN;
+        pReq->intervalMax = CONN_PARAM_IDLE_INTERVAL_MAX;
+        pReq->latency = CONN_PARAM_IDLE_LATENCY;
+        pReq->timeout = CONN_PARAM_IDLE_TIMEOUT;
+    }
+
+    gConnParam.pending = want;
+    gConnParam.pendingAction = action;
+    gConnParam.pendingUntil = now + PROX_TIME_MS_TO_TICKS(CONN_PARAM_PENDING_MS);
+    gConnParam.waiting = TRUE;
+    gConnParam.waitUntil = now + PROX_TIME_MS_TO_TICKS(CONN_PARAM_MIN_GAP_MS);
+    gConnParamStats.requests++;
+
+    return action;
+}
+
+/*! *********************************************************************************
+* \brief     The request returned by ConnParam_Poll could not be sent
+********************************************************************************** */
+void ConnParam_SendFailed(uint32_t now)
+{
+    if (gConnParam.pending != connParamProfileUnknown_c)
+    {
+        ConnParam_Reject(now);
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Connection parameter update completed, requested or not
+********************************************************************************** */
+void ConnParam_UpdateComplete(bool_t success, uint16_t interval, uint16_t latency, uint32_t now)
+{
+    if (gConnParam.connected == FALSE)
+    {
+        return;
+    }
+
+    if (success == TRUE)
+    {
+        gConnParam.interval = interval;
+        gConnParam.latency = latency;
+    }
+    ConnParam_Completed(success, connParamActionUpdate_c, now);
+}
+
+/*! *********************************************************************************
+* \brief     Subrate change completed, requested or not
+********************************************************************************** */
+void ConnParam_SubrateComplete(bool_t success, uint16_t factor, uint32_t now)
+{
+    if (gConnParam.connected == FALSE)
+    {
+        return;
+    }
+
+    if (success == TRUE)
+    {
+        gConnParam.factor = factor;
+    }
+    ConnParam_Completed(success, connParamActionSubrate_c, now);
+}
+
+/*! *********************************************************************************
+* \brief     Copy the counters
+********************************************************************************** */
+void ConnParam_GetStats(uint32_t now, connParamStats_t *pStats)
+{
+    if (pStats != NULL)
+    {
+        *pStats = gConnParamStats;
+        if (gConnParam.profile == connParamProfileIdle_c)
+        {
+            pStats->idleMs += ProxTime_TicksToMs(ProxTime_Elapsed(now, gConnParam.idleSince));
+        }
+    }
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static connParamProfile_t ConnParam_Classify(void)
+{
+    connParamProfile_t profile = connParamProfileUnknown_c;
+
+    if (gConnParam.factor > 1u)
+    {
+        if ((gConnParam.factor >= CONN_PARAM_IDLE_SUBRATE_MIN) &&
+            (gConnParam.factor <= CONN_PARAM_IDLE_SUBRATE_MAX))
+        {
+            profile = connParamProfileIdle_c;
+        }
+    }
+    else if ((gConnParam.interval == gConnParam.activeInterval) &&
+             (gConnParam.latency == gConnParam.activeLatency))
+    {
+        profile = connParamProfileActive_c;
+    }
+    else if ((gConnParam.interval >= CONN_PARAM_IDLE_INTERVAL_MIN) &&
+             (gConnParam.interval <= CONN_PARAM_IDLE_INTERVAL_MAX) &&
+             (gConnParam.latency == CONN_PARAM_IDLE_LATENCY))
+    {
+        profile = connParamProfileIdle_c;
+    }
+    else
+    {
+        /* Chosen by the central */
+    }
+
+    return profile;
+}
+
+static void ConnParam_SetProfile(connParamProfile_t profile, uint32_t now)
+{
+    if (profile == gConnParam.profile)
+    {
+        return;
+    }
+
+    if (gConnParam.profile == connParamProfileIdle_c)
+    {
+        gConnParamStats.idleMs += ProxTime_TicksToMs(ProxTime_Elapsed(now, gConnParam.idleSince));
+    }
+
+    if (profile == connParamProfileIdle_c)
+    {
+        gConnParam.idleSince = now;
+        gConnParamStats.toIdle++;
+    }
+    else if (profile == connParamProfileActive_c)
+    {
+        gConnParamStats.toActive++;
+    }
+    else
+    {
+        /* Unknown or disconnected */
+    }
+
+    gConnParam.profile = profile;
+    gConnParamStats.profile = profile;
+}
+
+static void ConnParam_Reject(uint32_t now)
+{
+    gConnParamStats.rejects++;
+
+    if ((gConnParam.pendingAction == connParamActionSubrate_c) &&
+        (gConnParam.pending == connParamProfileIdle_c))
+    {
+        /* Central or controller without subrating: use parameter updates */
+        gConnParam.subrate = FALSE;
+        gConnParamStats.subrate = FALSE;
+        gConnParam.waitUntil = now + PROX_TIME_MS_TO_TICKS(CONN_PARAM_MIN_GAP_MS);
+    }
+    else
+    {
+        if (gConnParam.rejects < 0xFFu)
+        {
+            gConnParam.rejects++;
+        }
+        gConnParam.waitUntil = now + PROX_TIME_MS_TO_TICKS(CONN_PARAM_RETRY_MS);
+    }
+
+    gConnParam.waiting = TRUE;
+    gConnParam.pending = connParamProfileUnknown_c;
+    gConnParam.pendingAction = connParamActionNone_c;
+}
+
+static void ConnParam_Completed(bool_t success, connParamAction_t action, uint32_t now)
+{
+    connParamProfile_t requested = gConnParam.pending;
+    bool_t answer = ((requested != connParamProfileUnknown_c) &&
+                     (gConnParam.pendingAction == action)) ? TRUE : FALSE;
+
+    if (success == TRUE)
+    {
+        ConnParam_SetProfile(ConnParam_Classify(), now);
+    }
+
+    if (answer == TRUE)
+    {
+        if ((success == TRUE) && (gConnParam.profile == requested))
+        {
+            gConnParam.rejects = 0u;
+            gConnParam.pending = connParamProfileUnknown_c;
+            gConnParam.pendingAction = connParamActionNone_c;
+        }
+        else
+        {
+            /* Refused, or accepted with values outside the profile */
+            ConnParam_Reject(now);
+        }
+    }
+}
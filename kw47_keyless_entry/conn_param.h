@@ -0,0 +1,232 @@
+/*! *********************************************************************************
+* \file conn_param.h
+*
+* Proximity driven connection parameters of the Digital Key link.
+*
+* A bonded phone stays connected to the car for hours while its owner is far
+* away, at the short interval the phone picked for the Digital Key setup. While
+* ProxRssi is FAR nothing needs that rate, so the link is moved to an idle
+* profile: a long interval with peripheral latency, or a subrate factor when
+* CONN_PARAM_USE_SUBRATE is set (the underlying interval is kept, switching back
+* takes effect at the next connection event). The link returns to the active
+* profile, the parameters it was established with, as soon as something needs it:
+*
+* - CONN_PARAM_DEMAND_PROX: ProxRssi left FAR (candidate or lockout), RSSI
+*   samples must be fresh for the stability check and the unlock.
+* - CONN_PARAM_DEMAND_CS: Channel Sounding procedures are set up or running,
+*   their period was computed in connection events of the active interval.
+*
+* The idle profile is requested only after no demand was raised for
+* CONN_PARAM_IDLE_HOLD_MS, and not during the first CONN_PARAM_CONNECT_HOLD_MS of
+* a connection (pairing, discovery and CS setup).
+*
+* One request is in flight at a time. A request the central rejects, or that
+* does not complete within CONN_PARAM_PENDING_MS, backs off CONN_PARAM_RETRY_MS;
+* a rejected subrate request falls back to connection parameter updates for the
+* rest of the connection. After CONN_PARAM_MAX_REJECTS rejects in a row the idle
+* profile is no longer requested, the active one still is.
+*
+* The module only decides: ConnParam_Poll returns the request to send, the
+* caller issues it (Gap_UpdateConnectionParameters / Gap_ConnectionSubrateRequest)
+* and reports the outcome. Times are prox_time.h ticks.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef CONN_PARAM_H
+#define CONN_PARAM_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Idle profile without subrating: interval in 1.25 ms units, peripheral latency
+   in connection events, supervision timeout in 10 ms units */
+#ifndef CONN_PARAM_IDLE_INTERVAL_MIN
+#define CONN_PARAM_IDLE_INTERVAL_MIN    (80u)       /* 100 ms */
+#endif
+#ifndef CONN_PARAM_IDLE_INTERVAL_MAX
+#define CONN_PARAM_IDLE_INTERVAL_MAX    (96u)       /* 120 ms */
+#endif
+#ifndef CONN_PARAM_IDLE_LATENCY
+#define CONN_PARAM_IDLE_LATENCY         (4u)
+#endif
+#ifndef CONN_PARAM_IDLE_TIMEOUT
+#define CONN_PARAM_IDLE_TIMEOUT         (600u)      /* 6 s */
+#endif
+
+/* Idle profile with subrating: subrate factors on the active interval */
+#ifndef CONN_PARAM_USE_SUBRATE
+#define CONN_PARAM_USE_SUBRATE          (0u)
+#endif
+#ifndef CONN_PARAM_IDLE_SUBRATE_MIN
+#define CONN_PARAM_IDLE_SUBRATE_MIN     (4u)
+#endif
+#ifndef CONN_PARAM_IDLE_SUBRATE_MAX
+#define CONN_PARAM_IDLE_SUBRATE_MAX     (8u)
+#endif
+#ifndef CONN_PARAM_SUBRATE_CONTINUATION
+#define CONN_PARAM_SUBRATE_CONTINUATION (2u)
+#endif
+
+/* No demand for this long before the idle profile is requested */
+#ifndef CONN_PARAM_IDLE_HOLD_MS
+#define CONN_PARAM_IDLE_HOLD_MS         (3000u)
+#endif
+
+/* Active profile kept after connection */
+#ifndef CONN_PARAM_CONNECT_HOLD_MS
+#define CONN_PARAM_CONNECT_HOLD_MS      (10000u)
+#endif
+
+/* A request not completed within this time counts as rejected */
+#ifndef CONN_PARAM_PENDING_MS
+#define CONN_PARAM_PENDING_MS           (5000u)
+#endif
+
+/* Wait after a reject, and between two requests */
+#ifndef CONN_PARAM_RETRY_MS
+#define CONN_PARAM_RETRY_MS             (10000u)
+#endif
+#ifndef CONN_PARAM_MIN_GAP_MS
+#define CONN_PARAM_MIN_GAP_MS           (1000u)
+#endif
+
+/* Rejects in a row after which the idle profile is given up for the connection */
+#ifndef CONN_PARAM_MAX_REJECTS
+#define CONN_PARAM_MAX_REJECTS          (3u)
+#endif
+
+/* Reasons to hold the active profile, see ConnParam_SetDemand */
+#define CONN_PARAM_DEMAND_PROX          (1u << 0u)
+#define CONN_PARAM_DEMAND_CS            (1u << 1u)
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+typedef enum
+{
+    connParamProfileActive_c = 0,   /* Parameters the link was established with */
+    connParamProfileIdle_c,         /* Long interval + latency, or subrated */
+    connParamProfileUnknown_c       /* Set by the central, neither of the above */
+} connParamProfile_t;
+
+typedef enum
+{
+    connParamActionNone_c = 0,
+    connParamActionUpdate_c,        /* Gap_UpdateConnectionParameters */
+    connParamActionSubrate_c        /* Gap_ConnectionSubrateRequest */
+} connParamAction_t;
+
+/* Request to send, fields of the other action are 0 */
+typedef struct
+{
+    uint16_t intervalMin;           /* 1.25 ms */
+    uint16_t intervalMax;
+    uint16_t latency;               /* Peripheral latency */
+    uint16_t timeout;               /* Supervision timeout, 10 ms */
+    uint16_t subrateMin;
+    uint16_t subrateMax;
+    uint16_t continuation;
+} connParamRequest_t;
+
+typedef struct
+{
+    uint32_t requests;              /* Requests sent */
+    uint32_t rejects;               /* Rejected or failed to send */
+    uint32_t timeouts;              /* Not completed in CONN_PARAM_PENDING_MS */
+    uint32_t toIdle;                /* Completed switches to idle */
+    uint32_t toActive;              /* Completed switches to active */
+    uint32_t idleMs;                /* Time spent in the idle profile */
+    connParamProfile_t profile;     /* Profile in effect */
+    bool_t   subrate;               /* Idle profile uses subrating */
+} connParamStats_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Forget the connection and clear the counters
+********************************************************************************** */
+void ConnParam_Init(void);
+
+/*! *********************************************************************************
+* \brief     Start managing a new connection
+*
+* \param[in] interval   Connection interval the link was established with.
+* \param[in] latency    Its peripheral latency.
+* \param[in] timeout    Its supervision timeout.
+* \param[in] now        Current time.
+********************************************************************************** */
+void ConnParam_Connected(uint16_t interval, uint16_t latency, uint16_t timeout, uint32_t now);
+
+/*! *********************************************************************************
+* \brief     Stop managing the connection
+********************************************************************************** */
+void ConnParam_Disconnected(uint32_t now);
+
+/*! *********************************************************************************
+* \brief     Raise or drop a reason to hold the active profile
+*
+* \param[in] demand     CONN_PARAM_DEMAND_x.
+* \param[in] active     TRUE to raise it.
+* \param[in] now        Current time.
+********************************************************************************** */
+void ConnParam_SetDemand(uint8_t demand, bool_t active, uint32_t now);
+
+/*! *********************************************************************************
+* \brief     Request to send now, if any
+*
+* \param[in]  now       Current time.
+* \param[out] pReq      Parameters of the request.
+*
+* \return     Action to take, the request is then pending until reported.
+********************************************************************************** */
+connParamAction_t ConnParam_Poll(uint32_t now, connParamRequest_t *pReq);
+
+/*! *********************************************************************************
+* \brief     The request returned by ConnParam_Poll could not be sent
+********************************************************************************** */
+void ConnParam_SendFailed(uint32_t now);
+
+/*! *********************************************************************************
+* \brief     Connection parameter update completed, requested or not
+*
+* \param[in] success    Status of the update.
+* \param[in] interval   New connection interval.
+* \param[in] latency    New peripheral latency.
+* \param[in] now        Current time.
+********************************************************************************** */
+void ConnParam_UpdateComplete(bool_t success, uint16_t interval, uint16_t latency, uint32_t now);
+
+/*! *********************************************************************************
+* \brief     Subrate change completed, requested or not
+*
+* \param[in] success    Status of the change.
+* \param[in] factor     New subrate factor.
+* \param[in] now        Current time.
+********************************************************************************** */
+void ConnParam_SubrateComplete(bool_t success, uint16_t factor, uint32_t now);
+
+/*! *********************************************************************************
+* \brief     Copy the counters
+*
+* \param[in]  now       Current time, to account the idle period in progress.
+* \param[out] pStats    Counters since init.
+********************************************************************************** */
+void ConnParam_GetStats(uint32_t now, connParamStats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONN_PARAM_H */
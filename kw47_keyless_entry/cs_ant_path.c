@@ -0,0 +1,281 @@
+/*! *********************************************************************************
+* \file cs_ant_path.c
+*
+* Per-link Channel Sounding antenna-path quality tracker. See cs_ant_path.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "cs_ant_path.h"
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+#define CS_ANT_PATH_NUM_ACI             (8u)
+#define CS_ANT_PATH_BAD_CNT_MAX         (0xFFu)
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef struct
+{
+    bool_t   inUse;
+    bool_t   probing;
+    uint8_t  baseAci;                           /* ACI configured by the application */
+    uint8_t  curAci;                            /* ACI recommended for next procedure */
+    uint8_t  activeMask;                        /* Paths not pruned */
+    uint8_t  sinceProbe;                        /* Procedures since last re-probe */
+    uint8_t  aBadCnt[CS_ANT_PATH_MAX_PATHS];    /* Consecutive bad procedures */
+} csAntPathLink_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static csAntPathLink_t gaCsAntPathLinks[CS_ANT_PATH_MAX_LINKS];
+
+/* Antenna paths per ACI: 1x1, 2x1, 3x1, 4x1, 1x2, 1x3, 1x4, 2x2 */
+static const uint8_t gaCsAntPathsPerAci[CS_ANT_PATH_NUM_ACI] = {1u, 2u, 3u, 4u, 2u, 3u, 4u, 4u};
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static csAntPathLink_t *CsAntPath_GetLink(uint8_t linkId);
+static uint8_t CsAntPath_FullMask(uint8_t baseAci);
+static uint8_t CsAntPath_ReducedAci(uint8_t baseAci, uint8_t activeMask);
+static bool_t CsAntPath_IsBad(uint16_t nbValidFreq, uint16_t nbValid, int16_t dqiQ14);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Clear the tracker for all links
+********************************************************************************** */
+void CsAntPath_Init(void)
+{
+    uint8_t i;
+
+    for (i = 0u; i < CS_ANT_PATH_MAX_LINKS; i++)
+    {
+        gaCsAntPathLinks[i].inUse = FALSE;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Start tracking a link with the configured antenna configuration index
+********************************************************************************** */
+void CsAntPath_Reset(uint8_t linkId, uint8_t baseAntCfgIdx)
+{
+    csAntPathLink_t *pLink;
+    uint8_t i;
+
+    if ((linkId < CS_ANT_PATH_MAX_LINKS) && (baseAntCfgIdx < CS_ANT_PATH_NUM_ACI))
+    {
+        pLink = &gaCsAntPathLinks[linkId];
+        pLink->inUse      = TRUE;
+        pLink->probing    = FALSE;
+        pLink->baseAci    = baseAntCfgIdx;
+        pLink->curAci     = baseAntCfgIdx;
+        pLink->activeMask = CsAntPath_FullMask(baseAntCfgIdx);
+        pLink->sinceProbe = 0u;
+
+        for (i = 0u; i < CS_ANT_PATH_MAX_PATHS; i++)
+        {
+            pLink->aBadCnt[i] = 0u;
+        }
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Feed the per-path results of one CS procedure
+********************************************************************************** */
+bool_t CsAntPath_Update(uint8_t linkId,
+                        uint8_t numPaths,
+                        uint16_t nbValidFreq,
+                        const uint16_t *pNbValid,
+                        const int16_t *pDqiQ14)
+{
+    csAntPathLink_t *pLink = CsAntPath_GetLink(linkId);
+    uint8_t prevAci;
+    uint8_t prevMask;
+    uint8_t bit;
+    uint8_t i;
+
+    if ((pLink == NULL) || (pNbValid == NULL) || (nbValidFreq == 0u))
+    {
+        return FALSE;
+    }
+
+    prevAci  = pLink->curAci;
+    prevMask = pLink->activeMask;
+
+    if (numPaths > gaCsAntPathsPerAci[pLink->baseAci])
+    {
+        numPaths = gaCsAntPathsPerAci[pLink->baseAci];
+    }
+
+    /* Only the paths that were actually sounded carry information. Walk them from
+     * the last one so that, when all are bad, the trailing paths are pruned first
+     * and the ACI can still be reduced. */
+    for (i = numPaths; i > 0u; )
+    {
+        i--;
+        bit = (uint8_t)(1u << i);
+
+        if (CsAntPath_IsBad(nbValidFreq, pNbValid[i],
+                            (pDqiQ14 != NULL) ? pDqiQ14[i] : CS_ANT_PATH_MIN_DQI_Q14) == TRUE)
+        {
+            if (pLink->aBadCnt[i] < CS_ANT_PATH_BAD_CNT_MAX)
+            {
+                pLink->aBadCnt[i]++;
+            }
+
+            /* Never prune the last remaining path */
+            if (((pLink->activeMask & bit) != 0u) &&
+                (pLink->aBadCnt[i] >= CS_ANT_PATH_PRUNE_AFTER) &&
+                (pLink->activeMask != bit))
+            {
+                pLink->activeMask &= (uint8_t)~bit;
+            }
+        }
+        else
+        {
+            pLink->aBadCnt[i] = 0u;
+            pLink->activeMask |= bit;
+        }
+    }
+
+    /* Pruned paths that are no longer sounded are re-probed periodically */
+    pLink->probing = FALSE;
+    pLink->curAci  = CsAntPath_ReducedAci(pLink->baseAci, pLink->activeMask);
+
+    if ((pLink->curAci != pLink->baseAci) && (prevAci != pLink->baseAci))
+    {
+        pLink->sinceProbe++;
+
+        if (pLink->sinceProbe >= CS_ANT_PATH_REPROBE_PERIOD)
+        {
+            pLink->sinceProbe = 0u;
+            pLink->probing    = TRUE;
+            pLink->curAci     = pLink->baseAci;
+        }
+    }
+    else if (pLink->curAci == pLink->baseAci)
+    {
+        pLink->sinceProbe = 0u;
+    }
+    else
+    {
+        /* Procedure ran with the full configuration, count from the next one */
+    }
+
+    return (bool_t)((prevAci != pLink->curAci) || (prevMask != pLink->activeMask));
+}
+
+/*! *********************************************************************************
+* \brief     ACI to configure for the next procedure
+********************************************************************************** */
+uint8_t CsAntPath_GetAntCfgIndex(uint8_t linkId)
+{
+    csAntPathLink_t *pLink = CsAntPath_GetLink(linkId);
+
+    return (pLink != NULL) ? pLink->curAci : CS_ANT_PATH_INVALID_ACI;
+}
+
+/*! *********************************************************************************
+* \brief     TRUE when the next procedure is a full-configuration re-probe
+********************************************************************************** */
+bool_t CsAntPath_IsProbing(uint8_t linkId)
+{
+    csAntPathLink_t *pLink = CsAntPath_GetLink(linkId);
+
+    return (pLink != NULL) ? pLink->probing : FALSE;
+}
+
+/*! *********************************************************************************
+* \brief     Number of antenna paths sounded with the given ACI (0 if invalid)
+********************************************************************************** */
+uint8_t CsAntPath_PathsForAci(uint8_t antCfgIdx)
+{
+    return (antCfgIdx < CS_ANT_PATH_NUM_ACI) ? gaCsAntPathsPerAci[antCfgIdx] : 0u;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static csAntPathLink_t *CsAntPath_GetLink(uint8_t linkId)
+{
+    csAntPathLink_t *pLink = NULL;
+
+    if ((linkId < CS_ANT_PATH_MAX_LINKS) && (gaCsAntPathLinks[linkId].inUse == TRUE))
+    {
+        pLink = &gaCsAntPathLinks[linkId];
+    }
+
+    return pLink;
+}
+
+static uint8_t CsAntPath_FullMask(uint8_t baseAci)
+{
+    return (uint8_t)((1u << gaCsAntPathsPerAci[baseAci]) - 1u);
+}
+
+/*! *********************************************************************************
+* \brief     Smallest ACI that still sounds every active path
+*
+* Reduction is only possible when the active paths form a prefix of the path list
+* and the antenna switching stays on the same side (local for ACI 1-3, remote for
+* ACI 4-6). For 2x2 the only safe reduction is to the 1x1 path.
+********************************************************************************** */
+static uint8_t CsAntPath_ReducedAci(uint8_t baseAci, uint8_t activeMask)
+{
+    uint8_t aci = baseAci;
+    uint8_t n   = 0u;
+    uint8_t m   = activeMask;
+
+    if ((activeMask != 0u) && ((activeMask & (uint8_t)(activeMask + 1u)) == 0u))
+    {
+        while (m != 0u)
+        {
+            n++;
+            m >>= 1u;
+        }
+
+        if (n == 1u)
+        {
+            aci = 0u;
+        }
+        else if (baseAci <= 3u)
+        {
+            aci = (uint8_t)(n - 1u);
+        }
+        else if (baseAci <= 6u)
+        {
+            aci = (uint8_t)(4u + n - 2u);
+        }
+        else
+        {
+            /* 2x2: keep the full configuration */
+        }
+    }
+
+    return aci;
+}
+
+static bool_t CsAntPath_IsBad(uint16_t nbValidFreq, uint16_t nbValid, int16_t dqiQ14)
+{
+    uint32_t validQ8 = ((uint32_t)nbValid << 8u) / nbValidFreq;
+
+    return (bool_t)((validQ8 < CS_ANT_PATH_MIN_VALID_Q8) || (dqiQ14 < CS_ANT_PATH_MIN_DQI_Q14));
+}
@@ -0,0 +1,123 @@
+/*! *********************************************************************************
+* \file cs_ant_path.h
+*
+* Per-link Channel Sounding antenna-path quality tracker.
+*
+* Every CS procedure reports, per antenna path, the number of valid frequencies
+* and, when available, the CDE distance quality indicator. Paths that stay below the
+* quality floor for several consecutive procedures are pruned. The ACI is the only
+* path selection the controller and the distance algorithm take, so pruning acts
+* through it: when the pruned paths are the trailing ones, the antenna
+* configuration index is reduced so the controller does not sound them at all.
+* Pruned paths are re-probed periodically with the full configuration so a path
+* that recovers is restored.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef CS_ANT_PATH_H
+#define CS_ANT_PATH_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Number of links tracked */
+#ifndef CS_ANT_PATH_MAX_LINKS
+#if defined(gAppMaxConnections_c)
+#define CS_ANT_PATH_MAX_LINKS           (gAppMaxConnections_c)
+#else
+#define CS_ANT_PATH_MAX_LINKS           (2u)
+#endif
+#endif
+
+/* Maximum antenna paths per procedure (ACI 3, 6 and 7 use four) */
+#define CS_ANT_PATH_MAX_PATHS           (4u)
+
+/* A path is bad in a procedure if less than this fraction of the frequencies
+ * are valid on it (Q8, 128 = 50%) ... */
+#ifndef CS_ANT_PATH_MIN_VALID_Q8
+#define CS_ANT_PATH_MIN_VALID_Q8        (128u)
+#endif
+
+/* ... or if its CDE quality indicator is below this floor (Q2.14, 3277 = 0.2) */
+#ifndef CS_ANT_PATH_MIN_DQI_Q14
+#define CS_ANT_PATH_MIN_DQI_Q14         (3277)
+#endif
+
+/* Consecutive bad procedures before a path is pruned */
+#ifndef CS_ANT_PATH_PRUNE_AFTER
+#define CS_ANT_PATH_PRUNE_AFTER         (4u)
+#endif
+
+/* While paths are pruned, every Nth procedure runs with all paths to re-probe them */
+#ifndef CS_ANT_PATH_REPROBE_PERIOD
+#define CS_ANT_PATH_REPROBE_PERIOD      (16u)
+#endif
+
+/* Returned by CsAntPath_GetAntCfgIndex() for an unknown link */
+#define CS_ANT_PATH_INVALID_ACI         (0xFFu)
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Clear the tracker for all links
+********************************************************************************** */
+void CsAntPath_Init(void);
+
+/*! *********************************************************************************
+* \brief     Start tracking a link with the configured antenna configuration index
+*
+* \param[in] linkId         Link (peer device) identifier.
+* \param[in] baseAntCfgIdx  ACI configured by the application (0-7). All pruning
+*                           decisions are relative to it.
+********************************************************************************** */
+void CsAntPath_Reset(uint8_t linkId, uint8_t baseAntCfgIdx);
+
+/*! *********************************************************************************
+* \brief     Feed the per-path results of one CS procedure
+*
+* \param[in] linkId         Link identifier.
+* \param[in] numPaths       Number of antenna paths the procedure ran with.
+* \param[in] nbValidFreq    Frequencies sounded (mode 2 steps of the procedure).
+* \param[in] pNbValid       Valid frequencies per path (usable tones, cs_step_qual.h).
+* \param[in] pDqiQ14        DQI per path, Q2.14, or NULL when not available: the
+*                           share of valid frequencies alone decides then.
+*
+* \return    TRUE if the recommended ACI or the pruned paths changed.
+********************************************************************************** */
+bool_t CsAntPath_Update(uint8_t linkId,
+                        uint8_t numPaths,
+                        uint16_t nbValidFreq,
+                        const uint16_t *pNbValid,
+                        const int16_t *pDqiQ14);
+
+/*! *********************************************************************************
+* \brief     ACI to configure for the next procedure
+********************************************************************************** */
+uint8_t CsAntPath_GetAntCfgIndex(uint8_t linkId);
+
+/*! *********************************************************************************
+* \brief     TRUE when the next procedure is a full-configuration re-probe
+********************************************************************************** */
+bool_t CsAntPath_IsProbing(uint8_t linkId);
+
+/*! *********************************************************************************
+* \brief     Number of antenna paths sounded with the given ACI (0 if invalid)
+********************************************************************************** */
+uint8_t CsAntPath_PathsForAci(uint8_t antCfgIdx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CS_ANT_PATH_H */
@@ -0,0 +1,338 @@
+/*! *********************************************************************************
+* \file cs_ch_map.c
+*
+* Per-link Channel Sounding channel quality history and adaptive channel map.
+* See cs_ch_map.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "cs_ch_map.h"
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+#define CS_CH_MAP_SCORE_MAX             (255u)
+
+#define CS_CH_MAP_IS_SET(map, ch)       ((((map)[(ch) >> 3u]) & (uint8_t)(1u << ((ch) & 7u))) != 0u)
+#define CS_CH_MAP_SET(map, ch)          ((map)[(ch) >> 3u] |= (uint8_t)(1u << ((ch) & 7u)))
+#define CS_CH_MAP_CLEAR(map, ch)        ((map)[(ch) >> 3u] &= (uint8_t)~(uint8_t)(1u << ((ch) & 7u)))
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef struct
+{
+    bool_t   inUse;
+    uint8_t  procCount;                             /* Procedures seen, saturating */
+    uint8_t  aBaseMap[CS_CH_MAP_LEN];               /* Configured channel map */
+    uint8_t  aScore[CS_CH_MAP_NUM_CHANNELS];        /* Validity average, Q8 */
+} csChMapLink_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static csChMapLink_t gaCsChMapLinks[CS_CH_MAP_MAX_LINKS];
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static csChMapLink_t *CsChMap_GetLink(uint8_t linkId);
+static uint8_t CsChMap_FindBestDropped(const csChMapLink_t *pLink, const uint8_t *pMap);
+static uint8_t CsChMap_FindThinCandidate(const csChMapLink_t *pLink, const uint8_t *pMap);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Clear the history for all links
+********************************************************************************** */
+void CsChMap_Init(void)
+{
+    uint8_t i;
+
+    for (i = 0u; i < CS_CH_MAP_MAX_LINKS; i++)
+    {
+        gaCsChMapLinks[i].inUse = FALSE;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Start tracking a link
+********************************************************************************** */
+void CsChMap_Reset(uint8_t linkId, const uint8_t *pBaseMap)
+{
+    csChMapLink_t *pLink;
+    uint8_t i;
+
+    if ((linkId < CS_CH_MAP_MAX_LINKS) && (pBaseMap != NULL))
+    {
+        pLink = &gaCsChMapLinks[linkId];
+        pLink->inUse     = TRUE;
+        pLink->procCount = 0u;
+
+        for (i = 0u; i < CS_CH_MAP_LEN; i++)
+        {
+            pLink->aBaseMap[i] = pBaseMap[i];
+        }
+
+        /* Bit 79 and above are reserved */
+        pLink->aBaseMap[CS_CH_MAP_LEN - 1u] &= 0x7Fu;
+
+        /* Optimistic start: every channel is assumed good until measured */
+        for (i = 0u; i < CS_CH_MAP_NUM_CHANNELS; i++)
+        {
+            pLink->aScore[i] = (uint8_t)CS_CH_MAP_SCORE_MAX;
+        }
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Feed the per-channel validity of one CS procedure
+********************************************************************************** */
+void CsChMap_Update(uint8_t linkId, const uint8_t *pUsedMap, const uint8_t *pValidMap)
+{
+    csChMapLink_t *pLink = CsChMap_GetLink(linkId);
+    uint32_t score;
+    uint8_t ch;
+
+    if ((pLink == NULL) || (pUsedMap == NULL) || (pValidMap == NULL))
+    {
+        return;
+    }
+
+    for (ch = 0u; ch < CS_CH_MAP_NUM_CHANNELS; ch++)
+    {
+        score = pLink->aScore[ch];
+
+        if (CS_CH_MAP_IS_SET(pUsedMap, ch))
+        {
+            if (CS_CH_MAP_IS_SET(pValidMap, ch))
+            {
+                score += (CS_CH_MAP_SCORE_MAX - score) >> CS_CH_MAP_EMA_SHIFT;
+            }
+            else
+            {
+                score -= score >> CS_CH_MAP_EMA_SHIFT;
+            }
+        }
+        else
+        {
+            score += CS_CH_MAP_RECOVER_Q8;
+            if (score > CS_CH_MAP_SCORE_MAX)
+            {
+                score = CS_CH_MAP_SCORE_MAX;
+            }
+        }
+
+        pLink->aScore[ch] = (uint8_t)score;
+    }
+
+    if (pLink->procCount < 0xFFu)
+    {
+        pLink->procCount++;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Generate the channel map for the next configuration
+*
+* 1. Start from the base map without the channels scoring below the bad threshold.
+* 2. If fewer than CS_CH_MAP_MIN_CHANNELS remain, add back the best dropped ones.
+* 3. While the expected valid channel count (sum of scores) stays above the target,
+*    remove the worst channel, preferring the densest spot on ties. The lowest and
+*    highest channels are kept so the sounded bandwidth, and with it the
+*    phase-slope resolution, does not shrink.
+********************************************************************************** */
+uint8_t CsChMap_Generate(uint8_t linkId, uint8_t *pOutMap)
+{
+    csChMapLink_t *pLink = CsChMap_GetLink(linkId);
+    uint32_t expectedQ8 = 0u;
+    uint8_t count = 0u;
+    uint8_t ch;
+    uint8_t i;
+
+    if ((pLink == NULL) || (pOutMap == NULL))
+    {
+        return 0u;
+    }
+
+    for (i = 0u; i < CS_CH_MAP_LEN; i++)
+    {
+        pOutMap[i] = pLink->aBaseMap[i];
+    }
+
+    if (pLink->procCount < CS_CH_MAP_MIN_PROCEDURES)
+    {
+        return CsChMap_Count(pOutMap);
+    }
+
+    /* 1. Drop chronically bad channels */
+    for (ch = 0u; ch < CS_CH_MAP_NUM_CHANNELS; ch++)
+    {
+        if (CS_CH_MAP_IS_SET(pOutMap, ch))
+        {
+            if (pLink->aScore[ch] < CS_CH_MAP_BAD_SCORE_Q8)
+            {
+                CS_CH_MAP_CLEAR(pOutMap, ch);
+            }
+            else
+            {
+                count++;
+                expectedQ8 += pLink->aScore[ch];
+            }
+        }
+    }
+
+    /* 2. Keep the minimum channel count */
+    while (count < CS_CH_MAP_MIN_CHANNELS)
+    {
+        ch = CsChMap_FindBestDropped(pLink, pOutMap);
+        if (ch >= CS_CH_MAP_NUM_CHANNELS)
+        {
+            break;
+        }
+        CS_CH_MAP_SET(pOutMap, ch);
+        count++;
+        expectedQ8 += pLink->aScore[ch];
+    }
+
+    /* 3. Thin while the quality target is still met */
+    while (count > CS_CH_MAP_MIN_CHANNELS)
+    {
+        ch = CsChMap_FindThinCandidate(pLink, pOutMap);
+        if ((ch >= CS_CH_MAP_NUM_CHANNELS) ||
+            ((expectedQ8 - pLink->aScore[ch]) < ((uint32_t)CS_CH_MAP_TARGET_VALID * CS_CH_MAP_SCORE_MAX)))
+        {
+            break;
+        }
+        CS_CH_MAP_CLEAR(pOutMap, ch);
+        count--;
+        expectedQ8 -= pLink->aScore[ch];
+    }
+
+    return count;
+}
+
+/*! *********************************************************************************
+* \brief     Current score of a channel (Q8, 255 = always valid)
+********************************************************************************** */
+uint8_t CsChMap_GetScore(uint8_t linkId, uint8_t channel)
+{
+    csChMapLink_t *pLink = CsChMap_GetLink(linkId);
+
+    return ((pLink != NULL) && (channel < CS_CH_MAP_NUM_CHANNELS)) ? pLink->aScore[channel] : 0u;
+}
+
+/*! *********************************************************************************
+* \brief     Number of channels set in a channel map
+********************************************************************************** */
+uint8_t CsChMap_Count(const uint8_t *pMap)
+{
+    uint8_t count = 0u;
+    uint8_t ch;
+
+    for (ch = 0u; ch < CS_CH_MAP_NUM_CHANNELS; ch++)
+    {
+        if (CS_CH_MAP_IS_SET(pMap, ch))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static csChMapLink_t *CsChMap_GetLink(uint8_t linkId)
+{
+    csChMapLink_t *pLink = NULL;
+
+    if ((linkId < CS_CH_MAP_MAX_LINKS) && (gaCsChMapLinks[linkId].inUse == TRUE))
+    {
+        pLink = &gaCsChMapLinks[linkId];
+    }
+
+    return pLink;
+}
+
+/*! *********************************************************************************
+* \brief     Best scoring channel of the base map that is not set in pMap.
+*            Ties go to the lowest channel index.
+*
+* \return    Channel index, CS_CH_MAP_NUM_CHANNELS if none.
+********************************************************************************** */
+static uint8_t CsChMap_FindBestDropped(const csChMapLink_t *pLink, const uint8_t *pMap)
+{
+    uint8_t found = CS_CH_MAP_NUM_CHANNELS;
+    uint8_t ch;
+
+    for (ch = 0u; ch < CS_CH_MAP_NUM_CHANNELS; ch++)
+    {
+        if ((CS_CH_MAP_IS_SET(pLink->aBaseMap, ch)) && (!CS_CH_MAP_IS_SET(pMap, ch)))
+        {
+            if ((found == CS_CH_MAP_NUM_CHANNELS) || (pLink->aScore[ch] > pLink->aScore[found]))
+            {
+                found = ch;
+            }
+        }
+    }
+
+    return found;
+}
+
+/*! *********************************************************************************
+* \brief     Channel of pMap to remove next: lowest score, then smallest gap between
+*            its selected neighbours. The first and last selected channels are
+*            never returned.
+*
+* \return    Channel index, CS_CH_MAP_NUM_CHANNELS if none.
+********************************************************************************** */
+static uint8_t CsChMap_FindThinCandidate(const csChMapLink_t *pLink, const uint8_t *pMap)
+{
+    uint8_t found = CS_CH_MAP_NUM_CHANNELS;
+    uint8_t foundGap = 0xFFu;
+    uint8_t prev = CS_CH_MAP_NUM_CHANNELS;
+    uint8_t cur = CS_CH_MAP_NUM_CHANNELS;
+    uint8_t gap;
+    uint8_t ch;
+
+    /* Walk the selected channels keeping (prev, cur, ch) as neighbours */
+    for (ch = 0u; ch < CS_CH_MAP_NUM_CHANNELS; ch++)
+    {
+        if (CS_CH_MAP_IS_SET(pMap, ch))
+        {
+            if (prev < CS_CH_MAP_NUM_CHANNELS)
+            {
+                gap = (uint8_t)(ch - prev);
+
+                if ((found == CS_CH_MAP_NUM_CHANNELS) ||
+                    (pLink->aScore[cur] < pLink->aScore[found]) ||
+                    ((pLink->aScore[cur] == pLink->aScore[found]) && (gap < foundGap)))
+                {
+                    found    = cur;
+                    foundGap = gap;
+                }
+            }
+
+            prev = cur;
+            cur  = ch;
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,125 @@
+/*! *********************************************************************************
+* \file cs_ch_map.h
+*
+* Per-link Channel Sounding channel quality history and adaptive channel map.
+*
+* After every CS procedure the algorithm reports which channels were sounded and
+* which of them produced valid (non-saturated) IQ data. A per-channel score (Q8,
+* exponential average of validity) is kept per link. The generator derives a
+* channel map from the configured base map that drops chronically bad channels
+* and thins the remaining ones while the expected number of valid channels stays
+* above CS_CH_MAP_TARGET_VALID. Fewer channels means fewer steps per procedure,
+* shorter procedures and less data to transfer over RAS.
+*
+* Channels that are not sounded slowly regain score so they get re-tried.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef CS_CH_MAP_H
+#define CS_CH_MAP_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Number of links tracked */
+#ifndef CS_CH_MAP_MAX_LINKS
+#if defined(gAppMaxConnections_c)
+#define CS_CH_MAP_MAX_LINKS             (gAppMaxConnections_c)
+#else
+#define CS_CH_MAP_MAX_LINKS             (2u)
+#endif
+#endif
+
+/* CS channel indices 0-78, bitmap of 10 bytes (same layout as rangeCfg ch_map) */
+#define CS_CH_MAP_NUM_CHANNELS          (79u)
+#define CS_CH_MAP_LEN                   (10u)
+
+/* Minimum number of channels allowed in a CS channel map */
+#define CS_CH_MAP_MIN_CHANNELS          (15u)
+
+/* Channels whose score falls below this are dropped (Q8, 64 = valid 25% of the time) */
+#ifndef CS_CH_MAP_BAD_SCORE_Q8
+#define CS_CH_MAP_BAD_SCORE_Q8          (64u)
+#endif
+
+/* Expected valid channels per channel map pass to keep when thinning */
+#ifndef CS_CH_MAP_TARGET_VALID
+#define CS_CH_MAP_TARGET_VALID          (40u)
+#endif
+
+/* Score averaging: new = old + (sample - old) >> shift */
+#ifndef CS_CH_MAP_EMA_SHIFT
+#define CS_CH_MAP_EMA_SHIFT             (3u)
+#endif
+
+/* Score regained per procedure by channels that were not sounded */
+#ifndef CS_CH_MAP_RECOVER_Q8
+#define CS_CH_MAP_RECOVER_Q8            (2u)
+#endif
+
+/* Procedures of history required before the map is adapted */
+#ifndef CS_CH_MAP_MIN_PROCEDURES
+#define CS_CH_MAP_MIN_PROCEDURES        (8u)
+#endif
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Clear the history for all links
+********************************************************************************** */
+void CsChMap_Init(void);
+
+/*! *********************************************************************************
+* \brief     Start tracking a link
+*
+* \param[in] linkId     Link (peer device) identifier.
+* \param[in] pBaseMap   Configured channel map (CS_CH_MAP_LEN bytes). The adapted
+*                       map is always a subset of it.
+********************************************************************************** */
+void CsChMap_Reset(uint8_t linkId, const uint8_t *pBaseMap);
+
+/*! *********************************************************************************
+* \brief     Feed the per-channel validity of one CS procedure
+*
+* \param[in] linkId     Link identifier.
+* \param[in] pUsedMap   Channels sounded in the procedure (CS_CH_MAP_LEN bytes).
+* \param[in] pValidMap  Sounded channels with valid IQ data (CS_CH_MAP_LEN bytes).
+********************************************************************************** */
+void CsChMap_Update(uint8_t linkId, const uint8_t *pUsedMap, const uint8_t *pValidMap);
+
+/*! *********************************************************************************
+* \brief     Generate the channel map for the next configuration
+*
+* \param[in]  linkId    Link identifier.
+* \param[out] pOutMap   Generated map (CS_CH_MAP_LEN bytes).
+*
+* \return     Number of channels in pOutMap, 0 if the link is not tracked.
+********************************************************************************** */
+uint8_t CsChMap_Generate(uint8_t linkId, uint8_t *pOutMap);
+
+/*! *********************************************************************************
+* \brief     Current score of a channel (Q8, 255 = always valid)
+********************************************************************************** */
+uint8_t CsChMap_GetScore(uint8_t linkId, uint8_t channel);
+
+/*! *********************************************************************************
+* \brief     Number of channels set in a channel map
+********************************************************************************** */
+uint8_t CsChMap_Count(const uint8_t *pMap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CS_CH_MAP_H */
@@ -0,0 +1,315 @@
+/*! *********************************************************************************
+* \file cs_latency.c
+*
+* Per-device, per-stage Channel Sounding latency histograms. See cs_latency.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "cs_latency.h"
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+/* Bucket index = 4 * (log2 - 1) + next two bits below the leading one */
+#define CS_LATENCY_SUB_BITS             (2u)
+#define CS_LATENCY_SUB_BUCKETS          (1u << CS_LATENCY_SUB_BITS)
+
+#define CS_LATENCY_BUCKET_MAX           (0xFFFFu)
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef struct
+{
+    uint32_t count;                                 /* Samples since reset */
+    uint32_t total;                                 /* Sum of aBucket[] */
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint16_t aBucket[CS_LATENCY_NUM_BUCKETS];
+} csLatencyHist_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static csLatencyHist_t gaCsLatencyHist[CS_LATENCY_MAX_DEVICES][csLatencyStageCount_c];
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static csLatencyHist_t *CsLatency_GetHist(uint8_t deviceId, csLatencyStage_t stage);
+static void CsLatency_ClearHist(csLatencyHist_t *pHist);
+static void CsLatency_Halve(csLatencyHist_t *pHist);
+static uint32_t CsLatency_BucketLowerUs(uint8_t bucket);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Clear the histograms of all devices
+********************************************************************************** */
+void CsLatency_Init(void)
+{
+    CsLatency_Reset(CS_LATENCY_ALL_DEVICES);
+}
+
+/*! *********************************************************************************
+* \brief     Clear the histograms of one device
+********************************************************************************** */
+void CsLatency_Reset(uint8_t deviceId)
+{
+    uint8_t dev;
+    uint8_t stage;
+
+    for (dev = 0u; dev < CS_LATENCY_MAX_DEVICES; dev++)
+    {
+        if ((deviceId == CS_LATENCY_ALL_DEVICES) || (deviceId == dev))
+        {
+            for (stage = 0u; stage < (uint8_t)csLatencyStageCount_c; stage++)
+            {
+                CsLatency_ClearHist(&gaCsLatencyHist[dev][stage]);
+            }
+        }
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Record one stage duration
+********************************************************************************** */
+void CsLatency_Record(uint8_t deviceId, csLatencyStage_t stage, uint32_t durationUs)
+{
+    csLatencyHist_t *pHist = CsLatency_GetHist(deviceId, stage);
+    uint8_t bucket;
+
+    if ((pHist == NULL) || (durationUs == 0u))
+    {
+        return;
+    }
+
+    bucket = CsLatency_BucketIndex(durationUs);
+
+    if (pHist->aBucket[bucket] == CS_LATENCY_BUCKET_MAX)
+    {
+        CsLatency_Halve(pHist);
+    }
+
+    pHist->aBucket[bucket]++;
+    pHist->total++;
+
+    if (pHist->count < 0xFFFFFFFFu)
+    {
+        pHist->count++;
+    }
+    if (durationUs < pHist->minUs)
+    {
+        pHist->minUs = durationUs;
+    }
+    if (durationUs > pHist->maxUs)
+    {
+        pHist->maxUs = durationUs;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Percentile of a stage duration
+********************************************************************************** */
+uint32_t CsLatency_Percentile(uint8_t deviceId, csLatencyStage_t stage, uint8_t percent)
+{
+    csLatencyHist_t *pHist = CsLatency_GetHist(deviceId, stage);
+    uint32_t rank;
+    uint32_t seen = 0u;
+    uint32_t value = 0u;
+    uint8_t bucket;
+
+    if ((pHist == NULL) || (pHist->total == 0u))
+    {
+        return 0u;
+    }
+
+    if (percent > 100u)
+    {
+        percent = 100u;
+    }
+
+    /* Smallest bucket holding at least percent % of the samples */
+    rank = (((pHist->total * (uint32_t)percent) + 99u) / 100u);
+    if (rank == 0u)
+    {
+        rank = 1u;
+    }
+
+    for (bucket = 0u; bucket < CS_LATENCY_NUM_BUCKETS; bucket++)
+    {
+        seen += pHist->aBucket[bucket];
+        if (seen >= rank)
+        {
+            value = CsLatency_BucketUpperUs(bucket);
+            break;
+        }
+    }
+
+    if (value > pHist->maxUs)
+    {
+        value = pHist->maxUs;
+    }
+    if (value < pHist->minUs)
+    {
+        value = pHist->minUs;
+    }
+
+    return value;
+}
+
+/*! *********************************************************************************
+* \brief     Summary of a stage
+********************************************************************************** */
+bool_t CsLatency_GetStats(uint8_t deviceId, csLatencyStage_t stage, csLatencyStats_t *pStats)
+{
+    csLatencyHist_t *pHist = CsLatency_GetHist(deviceId, stage);
+    bool_t result = FALSE;
+
+    if (pStats != NULL)
+    {
+        pStats->count = 0u;
+        pStats->minUs = 0u;
+        pStats->p50Us = 0u;
+        pStats->p95Us = 0u;
+        pStats->p99Us = 0u;
+        pStats->maxUs = 0u;
+
+        if ((pHist != NULL) && (pHist->count != 0u))
+        {
+            pStats->count = pHist->count;
+            pStats->minUs = pHist->minUs;
+            pStats->p50Us = CsLatency_Percentile(deviceId, stage, 50u);
+            pStats->p95Us = CsLatency_Percentile(deviceId, stage, 95u);
+            pStats->p99Us = CsLatency_Percentile(deviceId, stage, 99u);
+            pStats->maxUs = pHist->maxUs;
+            result = TRUE;
+        }
+    }
+
+    return result;
+}
+
+/*! *********************************************************************************
+* \brief     Bucket a duration falls in
+********************************************************************************** */
+uint8_t CsLatency_BucketIndex(uint32_t durationUs)
+{
+    uint32_t bucket;
+    uint8_t msb = 0u;
+    uint32_t v = durationUs;
+
+    if (durationUs < CS_LATENCY_SUB_BUCKETS)
+    {
+        bucket = durationUs;
+    }
+    else
+    {
+        while (v > 1u)
+        {
+            msb++;
+            v >>= 1u;
+        }
+
+        bucket = ((uint32_t)(msb - 1u) * CS_LATENCY_SUB_BUCKETS) +
+                 ((durationUs >> (msb - CS_LATENCY_SUB_BITS)) & (CS_LATENCY_SUB_BUCKETS - 1u));
+
+        if (bucket >= CS_LATENCY_NUM_BUCKETS)
+        {
+            bucket = CS_LATENCY_NUM_BUCKETS - 1u;
+        }
+    }
+
+    return (uint8_t)bucket;
+}
+
+/*! *********************************************************************************
+* \brief     Largest duration falling in a bucket
+********************************************************************************** */
+uint32_t CsLatency_BucketUpperUs(uint8_t bucket)
+{
+    uint32_t upper = 0xFFFFFFFFu;
+
+    if ((uint32_t)bucket + 1u < CS_LATENCY_NUM_BUCKETS)
+    {
+        upper = CsLatency_BucketLowerUs((uint8_t)(bucket + 1u)) - 1u;
+    }
+
+    return upper;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static csLatencyHist_t *CsLatency_GetHist(uint8_t deviceId, csLatencyStage_t stage)
+{
+    csLatencyHist_t *pHist = NULL;
+
+    if ((deviceId < CS_LATENCY_MAX_DEVICES) && ((uint32_t)stage < (uint32_t)csLatencyStageCount_c))
+    {
+        pHist = &gaCsLatencyHist[deviceId][stage];
+    }
+
+    return pHist;
+}
+
+static void CsLatency_ClearHist(csLatencyHist_t *pHist)
+{
+    uint8_t i;
+
+    pHist->count = 0u;
+    pHist->total = 0u;
+    pHist->minUs = 0xFFFFFFFFu;
+    pHist->maxUs = 0u;
+
+    for (i = 0u; i < CS_LATENCY_NUM_BUCKETS; i++)
+    {
+        pHist->aBucket[i] = 0u;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Halve every bucket, rounding up so no populated bucket becomes empty
+********************************************************************************** */
+static void CsLatency_Halve(csLatencyHist_t *pHist)
+{
+    uint8_t i;
+
+    pHist->total = 0u;
+
+    for (i = 0u; i < CS_LATENCY_NUM_BUCKETS; i++)
+    {
+        pHist->aBucket[i] = (uint16_t)(((uint32_t)pHist->aBucket[i] + 1u) >> 1u);
+        pHist->total += pHist->aBucket[i];
+    }
+}
+
+static uint32_t CsLatency_BucketLowerUs(uint8_t bucket)
+{
+    uint32_t lower = bucket;
+    uint32_t msb;
+    uint32_t sub;
+
+    if (bucket >= CS_LATENCY_SUB_BUCKETS)
+    {
+        msb   = ((uint32_t)bucket / CS_LATENCY_SUB_BUCKETS) + 1u;
+        sub   = (uint32_t)bucket % CS_LATENCY_SUB_BUCKETS;
+        lower = (CS_LATENCY_SUB_BUCKETS + sub) << (msb - CS_LATENCY_SUB_BITS);
+    }
+
+    return lower;
+}
@@ -0,0 +1,132 @@
+/*! *********************************************************************************
+* \file cs_latency.h
+*
+* Per-device, per-stage Channel Sounding latency histograms.
+*
+* Every localization result carries the duration of the CS configuration, the CS
+* procedure, the RAS/L2CAP transfer and the localization algorithm. Single samples
+* say little about the tail, so each duration is accumulated in a log-bucketed
+* histogram (4 buckets per power of two, at most 25% relative error) from which
+* p50/p95/p99 are derived. Min and max are tracked exactly.
+*
+* Bucket counters saturate by halving the whole histogram, which keeps the shape
+* of the distribution on long runs.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef CS_LATENCY_H
+#define CS_LATENCY_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Number of devices tracked */
+#ifndef CS_LATENCY_MAX_DEVICES
+#if defined(gAppMaxConnections_c)
+#define CS_LATENCY_MAX_DEVICES          (gAppMaxConnections_c)
+#else
+#define CS_LATENCY_MAX_DEVICES          (2u)
+#endif
+#endif
+
+/* Buckets per histogram, the last one collects everything above ~16.7 s */
+#define CS_LATENCY_NUM_BUCKETS          (92u)
+
+/* Pass as deviceId to CsLatency_Reset to clear every device */
+#define CS_LATENCY_ALL_DEVICES          (0xFFu)
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+typedef enum
+{
+    csLatencyStageConfig_c = 0,     /* CS configuration */
+    csLatencyStageProcedure_c,      /* CS procedure */
+    csLatencyStageTransfer_c,       /* RAS / L2CAP transfer */
+    csLatencyStageAlgo_c,           /* Localization algorithm */
+    csLatencyStageCount_c
+} csLatencyStage_t;
+
+typedef struct
+{
+    uint32_t count;                 /* Samples recorded */
+    uint32_t minUs;
+    uint32_t p50Us;
+    uint32_t p95Us;
+    uint32_t p99Us;
+    uint32_t maxUs;
+} csLatencyStats_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Clear the histograms of all devices
+********************************************************************************** */
+void CsLatency_Init(void);
+
+/*! *********************************************************************************
+* \brief     Clear the histograms of one device
+*
+* \param[in] deviceId   Device identifier, CS_LATENCY_ALL_DEVICES for all.
+********************************************************************************** */
+void CsLatency_Reset(uint8_t deviceId);
+
+/*! *********************************************************************************
+* \brief     Record one stage duration
+*
+* \param[in] deviceId   Device identifier.
+* \param[in] stage      Stage the duration belongs to.
+* \param[in] durationUs Duration in microseconds. 0 means not measured and is ignored.
+********************************************************************************** */
+void CsLatency_Record(uint8_t deviceId, csLatencyStage_t stage, uint32_t durationUs);
+
+/*! *********************************************************************************
+* \brief     Percentile of a stage duration
+*
+* \param[in] deviceId   Device identifier.
+* \param[in] stage      Stage.
+* \param[in] percent    Percentile, 1-100.
+*
+* \return    Upper bound of the bucket holding the percentile (capped at the maximum
+*            seen) in microseconds, 0 if no samples.
+********************************************************************************** */
+uint32_t CsLatency_Percentile(uint8_t deviceId, csLatencyStage_t stage, uint8_t percent);
+
+/*! *********************************************************************************
+* \brief     Summary of a stage
+*
+* \param[in]  deviceId  Device identifier.
+* \param[in]  stage     Stage.
+* \param[out] pStats    Count, min, p50, p95, p99 and max.
+*
+* \return     TRUE if at least one sample was recorded.
+********************************************************************************** */
+bool_t CsLatency_GetStats(uint8_t deviceId, csLatencyStage_t stage, csLatencyStats_t *pStats);
+
+/*! *********************************************************************************
+* \brief     Bucket a duration falls in (exposed for tests and tools)
+********************************************************************************** */
+uint8_t CsLatency_BucketIndex(uint32_t durationUs);
+
+/*! *********************************************************************************
+* \brief     Largest duration falling in a bucket
+********************************************************************************** */
+uint32_t CsLatency_BucketUpperUs(uint8_t bucket);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CS_LATENCY_H */
@@ -0,0 +1,184 @@
+/*! *********************************************************************************
+* \file cs_step_qual.c
+*
+* Per-link tone quality of the local Channel Sounding subevent results.
+* See cs_step_qual.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "cs_step_qual.h"
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+/* Step header: mode, channel, data length */
+#define CS_STEP_QUAL_HDR_LEN            (3u)
+#define CS_STEP_QUAL_MODE_2             (2u)
+
+/* Mode 2 step data: antenna permutation index, then per tone a 3 byte PCT and
+   the tone quality indicator (quality in the low nibble) */
+#define CS_STEP_QUAL_TONE_OFFSET        (1u)
+#define CS_STEP_QUAL_TONE_LEN           (4u)
+#define CS_STEP_QUAL_TQI_OFFSET         (3u)
+#define CS_STEP_QUAL_TQI_MASK           (0x0Fu)
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+/* Totals of the procedure in progress */
+static csStepQual_t gaCsStepQual[CS_STEP_QUAL_MAX_LINKS];
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static void CsStepQual_AddMode2(csStepQual_t *pQual, uint8_t numPaths, uint8_t channel,
+                                const uint8_t *pStepData, uint8_t stepLen);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Clear the totals of all links
+********************************************************************************** */
+void CsStepQual_Init(void)
+{
+    uint8_t i;
+
+    for (i = 0u; i < CS_STEP_QUAL_MAX_LINKS; i++)
+    {
+        CsStepQual_Reset(i);
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Drop the totals of a link
+********************************************************************************** */
+void CsStepQual_Reset(uint8_t linkId)
+{
+    csStepQual_t *pQual;
+    uint8_t i;
+
+    if (linkId >= CS_STEP_QUAL_MAX_LINKS)
+    {
+        return;
+    }
+
+    pQual = &gaCsStepQual[linkId];
+    pQual->numAntennaPaths = 0u;
+    pQual->nbSteps = 0u;
+    for (i = 0u; i < CS_STEP_QUAL_MAX_PATHS; i++)
+    {
+        pQual->aNbValid[i] = 0u;
+    }
+    for (i = 0u; i < CS_STEP_QUAL_MAP_LEN; i++)
+    {
+        pQual->aUsedMap[i] = 0u;
+        pQual->aValidMap[i] = 0u;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Add the steps of one subevent result (or continuation)
+********************************************************************************** */
+void CsStepQual_AddSubevent(uint8_t linkId,
+                            uint8_t numAntennaPaths,
+                            uint8_t numSteps,
+                            const uint8_t *pData)
+{
+    csStepQual_t *pQual;
+    const uint8_t *pStep = pData;
+    uint8_t stepLen;
+    uint8_t i;
+
+    if ((linkId >= CS_STEP_QUAL_MAX_LINKS) || (pData == NULL) ||
+        (numAntennaPaths == 0u) || (numAntennaPaths > CS_STEP_QUAL_MAX_PATHS))
+    {
+        return;
+    }
+
+    pQual = &gaCsStepQual[linkId];
+    pQual->numAntennaPaths = numAntennaPaths;
+
+    for (i = 0u; i < numSteps; i++)
+    {
+        stepLen = pStep[2];
+
+        if (pStep[0] == CS_STEP_QUAL_MODE_2)
+        {
+            CsStepQual_AddMode2(pQual, numAntennaPaths, pStep[1], &pStep[CS_STEP_QUAL_HDR_LEN], stepLen);
+        }
+
+        pStep = &pStep[CS_STEP_QUAL_HDR_LEN + (uint32_t)stepLen];
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Totals of the procedure, and start over for the next one
+********************************************************************************** */
+bool_t CsStepQual_Take(uint8_t linkId, csStepQual_t *pQual)
+{
+    bool_t taken = FALSE;
+
+    if ((linkId < CS_STEP_QUAL_MAX_LINKS) && (pQual != NULL))
+    {
+        if (gaCsStepQual[linkId].nbSteps != 0u)
+        {
+            *pQual = gaCsStepQual[linkId];
+            taken = TRUE;
+        }
+        CsStepQual_Reset(linkId);
+    }
+
+    return taken;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static void CsStepQual_AddMode2(csStepQual_t *pQual, uint8_t numPaths, uint8_t channel,
+                                const uint8_t *pStepData, uint8_t stepLen)
+{
+    const uint8_t *pTone;
+    uint8_t usable = 0u;
+    uint8_t k;
+
+    /* Step cut short: not counted rather than read past it */
+    if (stepLen < (CS_STEP_QUAL_TONE_OFFSET + ((uint32_t)numPaths * CS_STEP_QUAL_TONE_LEN)))
+    {
+        return;
+    }
+
+    pQual->nbSteps++;
+
+    /* The tone of the extension slot follows the paths and is not counted */
+    for (k = 0u; k < numPaths; k++)
+    {
+        pTone = &pStepData[CS_STEP_QUAL_TONE_OFFSET + ((uint32_t)k * CS_STEP_QUAL_TONE_LEN)];
+        if ((pTone[CS_STEP_QUAL_TQI_OFFSET] & CS_STEP_QUAL_TQI_MASK) <= CS_STEP_QUAL_TQI_USABLE_MAX)
+        {
+            pQual->aNbValid[k]++;
+            usable++;
+        }
+    }
+
+    if (channel < CS_STEP_QUAL_NUM_CHANNELS)
+    {
+        pQual->aUsedMap[channel >> 3u] |= (uint8_t)(1u << (channel & 7u));
+        if ((2u * (uint32_t)usable) >= numPaths)
+        {
+            pQual->aValidMap[channel >> 3u] |= (uint8_t)(1u << (channel & 7u));
+        }
+    }
+}
@@ -0,0 +1,113 @@
+/*! *********************************************************************************
+* \file cs_step_qual.h
+*
+* Per-link tone quality of the local Channel Sounding subevent results.
+*
+* The controller reports every CS step of a subevent with its mode, channel and
+* data. For mode 2 steps the data holds one tone per antenna path with a tone
+* quality indicator (high, medium, low, unavailable). The subevent results of a
+* procedure are accumulated per link into the number of steps with a usable tone
+* (high or medium quality) per antenna path, and into the channels sounded and
+* the channels with a valid step. A step is valid when at least half of its
+* antenna paths have a usable tone. The application takes the totals when the
+* procedure is done and feeds them to the antenna path tracker and to the
+* channel history.
+*
+* Tones are reported in antenna path order, the antenna permutation index of the
+* step only tells the order they were sounded in. Mode 3 steps are not counted.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef CS_STEP_QUAL_H
+#define CS_STEP_QUAL_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Number of links tracked */
+#ifndef CS_STEP_QUAL_MAX_LINKS
+#if defined(gAppMaxConnections_c)
+#define CS_STEP_QUAL_MAX_LINKS          (gAppMaxConnections_c)
+#else
+#define CS_STEP_QUAL_MAX_LINKS          (2u)
+#endif
+#endif
+
+/* Maximum antenna paths per step (ACI 3, 6 and 7 use four) */
+#define CS_STEP_QUAL_MAX_PATHS          (4u)
+
+/* CS channel indices 0-78, bitmap of 10 bytes (same layout as rangeCfg ch_map) */
+#define CS_STEP_QUAL_NUM_CHANNELS       (79u)
+#define CS_STEP_QUAL_MAP_LEN            (10u)
+
+/* Highest tone quality indicator counted as usable: 0 high, 1 medium */
+#ifndef CS_STEP_QUAL_TQI_USABLE_MAX
+#define CS_STEP_QUAL_TQI_USABLE_MAX     (1u)
+#endif
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+/* Totals of one procedure */
+typedef struct
+{
+    uint8_t  numAntennaPaths;                       /* Paths the procedure ran with */
+    uint16_t nbSteps;                               /* Mode 2 steps reported */
+    uint16_t aNbValid[CS_STEP_QUAL_MAX_PATHS];      /* Steps with a usable tone per path */
+    uint8_t  aUsedMap[CS_STEP_QUAL_MAP_LEN];        /* Channels of the mode 2 steps */
+    uint8_t  aValidMap[CS_STEP_QUAL_MAP_LEN];       /* Channels with a valid step */
+} csStepQual_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Clear the totals of all links
+********************************************************************************** */
+void CsStepQual_Init(void);
+
+/*! *********************************************************************************
+* \brief     Drop the totals of a link (connection, aborted procedure)
+********************************************************************************** */
+void CsStepQual_Reset(uint8_t linkId);
+
+/*! *********************************************************************************
+* \brief     Add the steps of one subevent result (or continuation)
+*
+* \param[in] linkId           Link (peer device) identifier.
+* \param[in] numAntennaPaths  Antenna paths of the subevent (1-4).
+* \param[in] numSteps         Steps reported in pData.
+* \param[in] pData            Step data: mode, channel, length and step data
+*                             per step, as in the LE CS Subevent Result event.
+********************************************************************************** */
+void CsStepQual_AddSubevent(uint8_t linkId,
+                            uint8_t numAntennaPaths,
+                            uint8_t numSteps,
+                            const uint8_t *pData);
+
+/*! *********************************************************************************
+* \brief     Totals of the procedure, and start over for the next one
+*
+* \param[in]  linkId    Link identifier.
+* \param[out] pQual     Totals of the steps added since the last call.
+*
+* \return     FALSE if no mode 2 step was added (pQual not written).
+********************************************************************************** */
+bool_t CsStepQual_Take(uint8_t linkId, csStepQual_t *pQual);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CS_STEP_QUAL_H */
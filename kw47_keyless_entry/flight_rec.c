@@ -0,0 +1,625 @@
+/*! *********************************************************************************
+* \file flight_rec.c
+*
+* RSSI proximity flight recorder. See flight_rec.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "flight_rec.h"
+#include "log_export.h"
+
+#if (FLIGHT_REC_FLASH_SIZE > 0u)
+#include "fsl_adapter_flash.h"
+#endif
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+#define FLIGHT_REC_PHRASE_SIZE          (16u)
+#define FLIGHT_REC_PAYLOAD_MAX          (FLIGHT_REC_BLOCK_SIZE - FLIGHT_REC_HDR_LEN)
+#define FLIGHT_REC_NUM_FEAT             (7u)
+#define FLIGHT_REC_NUM_PARAMS           (16u)
+
+/* Worst case record lengths: tag + dt + fields */
+#define FLIGHT_REC_SAMPLE_MAX_LEN       (1u + 5u + 2u)
+#define FLIGHT_REC_EVENT_MAX_LEN        (1u + 5u + 2u)
+#define FLIGHT_REC_FEAT_MAX_LEN         (1u + 5u + 1u + (3u * FLIGHT_REC_NUM_FEAT))
+#define FLIGHT_REC_RESET_MAX_LEN        (1u + 5u)
+#define FLIGHT_REC_CONFIG_MAX_LEN       (1u + 5u + (5u * FLIGHT_REC_NUM_PARAMS) + 3u + \
+                                         (3u * PROX_RSSI_ALPHA_LUT_SIZE))
+#define FLIGHT_REC_STEP_MAX_LEN         (FLIGHT_REC_SAMPLE_MAX_LEN + FLIGHT_REC_EVENT_MAX_LEN + \
+                                         FLIGHT_REC_FEAT_MAX_LEN)
+
+#if ((FLIGHT_REC_BLOCK_SIZE % FLIGHT_REC_PHRASE_SIZE) != 0u)
+#error "FLIGHT_REC_BLOCK_SIZE must be a multiple of the flash phrase size"
+#endif
+
+#if ((FLIGHT_REC_CONFIG_MAX_LEN + FLIGHT_REC_RESET_MAX_LEN) > FLIGHT_REC_PAYLOAD_MAX)
+#error "FLIGHT_REC_BLOCK_SIZE too small for a CONFIG record"
+#endif
+
+#if (FLIGHT_REC_CONFIG_INTERVAL < 2u)
+#error "FLIGHT_REC_CONFIG_INTERVAL must be at least 2"
+#endif
+
+#if (FLIGHT_REC_FLASH_SIZE > 0u)
+#if ((FLIGHT_REC_FLASH_SIZE % FLIGHT_REC_FLASH_SECTOR_SIZE) != 0u) || \
+    ((FLIGHT_REC_FLASH_SECTOR_SIZE % FLIGHT_REC_BLOCK_SIZE) != 0u)
+#error "FLIGHT_REC_FLASH_SIZE must be whole sectors holding whole blocks"
+#endif
+#if !defined(FLIGHT_REC_FLASH_ADDR)
+#error "FLIGHT_REC_FLASH_ADDR must point to a flash region reserved outside the application image"
+#endif
+#define FLIGHT_REC_FLASH_SLOTS          (FLIGHT_REC_FLASH_SIZE / FLIGHT_REC_BLOCK_SIZE)
+#endif
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static uint8_t gaFlightRecRam[FLIGHT_REC_RAM_BLOCKS][FLIGHT_REC_BLOCK_SIZE];
+
+static uint32_t gFlightRecNextSeq;              /* Sequence of the next block opened */
+static uint32_t gFlightRecRamCount;             /* RAM blocks holding data, open one included */
+static uint32_t gFlightRecFlushSeq;             /* First sequence not yet copied to flash */
+static uint32_t gFlightRecLost;
+static bool_t   gFlightRecOpen;
+static bool_t   gFlightRecBoot;
+
+/* Open block and its delta context */
+static uint8_t *gpFlightRecBlock;
+static uint32_t gFlightRecUsed;                 /* Header included */
+static uint32_t gFlightRecPrevT;
+static int32_t  gFlightRecPrevRssi;
+static int32_t  gaFlightRecPrevFeat[FLIGHT_REC_NUM_FEAT];
+static uint32_t gFlightRecSinceFeat;
+static uint32_t gFlightRecConfigEnd;            /* Offset after the last CONFIG of the open block */
+
+/* Last logged configuration, repeated every FLIGHT_REC_CONFIG_INTERVAL blocks */
+static ProxRssi_ParamsType gFlightRecParams;
+static uint16_t gaFlightRecLut[PROX_RSSI_ALPHA_LUT_SIZE];
+static uint16_t gFlightRecLutLen;
+
+#if (FLIGHT_REC_FLASH_SIZE > 0u)
+static uint32_t gFlightRecFlashSlot;            /* Next slot to program */
+#endif
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static void FlightRec_Reserve(uint32_t t, uint32_t maxLen);
+static void FlightRec_OpenBlock(uint32_t t);
+static void FlightRec_CloseBlock(void);
+static void FlightRec_PutU8(uint8_t value);
+static void FlightRec_PutVarint(uint32_t value);
+static uint32_t FlightRec_ZigZag(int32_t value);
+static void FlightRec_PutSigned(int32_t value);
+static void FlightRec_PutTime(uint32_t t);
+static void FlightRec_PutConfig(uint32_t t);
+static uint32_t FlightRec_BlockLen(const uint8_t *pBlock);
+#if (FLIGHT_REC_FLASH_SIZE > 0u)
+static bool_t FlightRec_IsValid(const uint8_t *pBlock, uint32_t len);
+static bool_t FlightRec_FlashWrite(const uint8_t *pBlock);
+static uint32_t FlightRec_FlashRead(uint32_t slot, uint8_t *pBuf);
+#endif
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Empty the RAM log and locate the write position in flash
+********************************************************************************** */
+void FlightRec_Init(void)
+{
+    gFlightRecNextSeq  = 0u;
+    gFlightRecRamCount = 0u;
+    gFlightRecLost     = 0u;
+    gFlightRecOpen     = FALSE;
+    gFlightRecBoot     = TRUE;
+    gFlightRecLutLen   = 0u;
+
+#if (FLIGHT_REC_FLASH_SIZE > 0u)
+    {
+        uint8_t *pScratch = gaFlightRecRam[0];
+        uint32_t lastSlot = FLIGHT_REC_FLASH_SLOTS;
+        uint32_t slot;
+        uint32_t seq;
+
+        (void)HAL_FlashInit();
+
+        /* Continue after the newest stored block */
+        for (slot = 0u; slot < FLIGHT_REC_FLASH_SLOTS; slot++)
+        {
+            if (FlightRec_FlashRead(slot, pScratch) != 0u)
+            {
+                seq = (uint32_t)pScratch[4] | ((uint32_t)pScratch[5] << 8u) |
+                      ((uint32_t)pScratch[6] << 16u) | ((uint32_t)pScratch[7] << 24u);
+                if ((lastSlot == FLIGHT_REC_FLASH_SLOTS) || (seq >= gFlightRecNextSeq))
+                {
+                    gFlightRecNextSeq = seq + 1u;
+                    lastSlot = slot;
+                }
+            }
+        }
+
+        slot = (lastSlot == FLIGHT_REC_FLASH_SLOTS) ? 0u : ((lastSlot + 1u) % FLIGHT_REC_FLASH_SLOTS);
+
+        /* Mid-sector slots are only programmed after their sector was erased.
+         * Skip to the next sector if this one was not left erased. */
+        if (((slot * FLIGHT_REC_BLOCK_SIZE) % FLIGHT_REC_FLASH_SECTOR_SIZE) != 0u)
+        {
+            (void)HAL_FlashRead(FLIGHT_REC_FLASH_ADDR + (slot * FLIGHT_REC_BLOCK_SIZE),
+                                FLIGHT_REC_HDR_LEN, pScratch);
+            for (seq = 0u; seq < FLIGHT_REC_HDR_LEN; seq++)
+            {
+                if (pScratch[seq] != 0xFFu)
+                {
+                    slot = (((slot * FLIGHT_REC_BLOCK_SIZE) / FLIGHT_REC_FLASH_SECTOR_SIZE) + 1u) *
+                           (FLIGHT_REC_FLASH_SECTOR_SIZE / FLIGHT_REC_BLOCK_SIZE);
+                    slot %= FLIGHT_REC_FLASH_SLOTS;
+                    break;
+                }
+            }
+        }
+
+        gFlightRecFlashSlot = slot;
+    }
+#endif
+
+    gFlightRecFlushSeq = gFlightRecNextSeq;
+}
+
+/*! *********************************************************************************
+* \brief     Record a ProxRssi (re)initialisation
+********************************************************************************** */
+void FlightRec_LogReset(uint32_t t, const ProxRssi_ParamsType *pParams,
+                        const uint16_t *pAlphaQ15, uint16_t lutLen)
+{
+    uint32_t i;
+
+    if (lutLen > (uint16_t)PROX_RSSI_ALPHA_LUT_SIZE)
+    {
+        lutLen = (uint16_t)PROX_RSSI_ALPHA_LUT_SIZE;
+    }
+
+    gFlightRecParams = *pParams;
+    for (i = 0u; i < lutLen; i++)
+    {
+        gaFlightRecLut[i] = pAlphaQ15[i];
+    }
+    gFlightRecLutLen = lutLen;
+
+    /* Keep both records in one block so the RESET always has its CONFIG */
+    FlightRec_Reserve(t, FLIGHT_REC_CONFIG_MAX_LEN + FLIGHT_REC_RESET_MAX_LEN);
+    if (gFlightRecConfigEnd != gFlightRecUsed)
+    {
+        FlightRec_PutConfig(t);
+    }
+
+    FlightRec_PutU8(FLIGHT_REC_TAG_RESET);
+    FlightRec_PutTime(t);
+    gFlightRecSinceFeat = 0u;
+}
+
+/*! *********************************************************************************
+* \brief     Record one ProxRssi step
+********************************************************************************** */
+void FlightRec_LogStep(uint32_t t, int8_t rssiDbm, ProxRssi_EventType ev,
+                       const ProxRssi_FeaturesType *pFeat, int16_t emaQ4,
+                       ProxRssi_StateType state)
+{
+    int32_t aFeat[FLIGHT_REC_NUM_FEAT];
+    uint32_t delta;
+    uint32_t i;
+
+    FlightRec_Reserve(t, FLIGHT_REC_STEP_MAX_LEN);
+
+    /* Small RSSI steps ride in the tag byte */
+    delta = FlightRec_ZigZag((int32_t)rssiDbm - gFlightRecPrevRssi);
+    gFlightRecPrevRssi = (int32_t)rssiDbm;
+    if (delta < 0x80u)
+    {
+        FlightRec_PutU8((uint8_t)(FLIGHT_REC_TAG_SAMPLE_SHORT | delta));
+        FlightRec_PutTime(t);
+    }
+    else
+    {
+        FlightRec_PutU8(FLIGHT_REC_TAG_SAMPLE);
+        FlightRec_PutTime(t);
+        FlightRec_PutVarint(delta);
+    }
+
+    if (ev != PROX_RSSI_EVT_NONE)
+    {
+        FlightRec_PutU8(FLIGHT_REC_TAG_EVENT);
+        FlightRec_PutTime(t);
+        FlightRec_PutU8(FLIGHT_REC_EVT_PROX);
+        FlightRec_PutU8((uint8_t)ev);
+    }
+
+    gFlightRecSinceFeat++;
+    if ((ev != PROX_RSSI_EVT_NONE) || (gFlightRecSinceFeat >= FLIGHT_REC_FEAT_INTERVAL))
+    {
+        aFeat[0] = (int32_t)pFeat->n;
+        aFeat[1] = (int32_t)pFeat->pctAboveEnterQ15;
+        aFeat[2] = (int32_t)pFeat->stdQ4;
+        aFeat[3] = (int32_t)pFeat->lastQ4;
+        aFeat[4] = (int32_t)pFeat->minQ4;
+        aFeat[5] = (int32_t)pFeat->maxQ4;
+        aFeat[6] = (int32_t)emaQ4;
+
+        FlightRec_PutU8(FLIGHT_REC_TAG_FEAT);
+        FlightRec_PutTime(t);
+        FlightRec_PutU8((uint8_t)state);
+        for (i = 0u; i < FLIGHT_REC_NUM_FEAT; i++)
+        {
+            FlightRec_PutSigned(aFeat[i] - gaFlightRecPrevFeat[i]);
+            gaFlightRecPrevFeat[i] = aFeat[i];
+        }
+        gFlightRecSinceFeat = 0u;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Record an application event
+********************************************************************************** */
+void FlightRec_LogEvent(uint32_t t, uint8_t code, uint8_t arg)
+{
+    FlightRec_Reserve(t, FLIGHT_REC_EVENT_MAX_LEN);
+
+    FlightRec_PutU8(FLIGHT_REC_TAG_EVENT);
+    FlightRec_PutTime(t);
+    FlightRec_PutU8(code);
+    FlightRec_PutU8(arg);
+}
+
+/*! *********************************************************************************
+* \brief     Close the current block and copy pending blocks to flash
+********************************************************************************** */
+uint32_t FlightRec_Flush(void)
+{
+    uint32_t written = 0u;
+
+    if (gFlightRecOpen == TRUE)
+    {
+        FlightRec_CloseBlock();
+    }
+
+#if (FLIGHT_REC_FLASH_SIZE > 0u)
+    {
+        uint32_t seq = gFlightRecFlushSeq;
+        uint32_t oldest = gFlightRecNextSeq - gFlightRecRamCount;
+
+        if (seq < oldest)
+        {
+            seq = oldest;
+        }
+
+        while (seq < gFlightRecNextSeq)
+        {
+            if (FlightRec_FlashWrite(gaFlightRecRam[seq % FLIGHT_REC_RAM_BLOCKS]) == FALSE)
+            {
+                break;
+            }
+            written++;
+            seq++;
+        }
+
+        gFlightRecFlushSeq = seq;
+    }
+#endif
+
+    return written;
+}
+
+/*! *********************************************************************************
+* \brief     Number of block slots
+********************************************************************************** */
+uint32_t FlightRec_BlockCount(void)
+{
+#if (FLIGHT_REC_FLASH_SIZE > 0u)
+    return FLIGHT_REC_FLASH_SLOTS;
+#else
+    return gFlightRecRamCount;
+#endif
+}
+
+/*! *********************************************************************************
+* \brief     Copy one stored block
+********************************************************************************** */
+uint32_t FlightRec_ReadBlock(uint32_t index, uint8_t *pBuf)
+{
+    uint32_t len = 0u;
+
+#if (FLIGHT_REC_FLASH_SIZE > 0u)
+    if (index < FLIGHT_REC_FLASH_SLOTS)
+    {
+        len = FlightRec_FlashRead(index, pBuf);
+    }
+#else
+    uint32_t seq = gFlightRecNextSeq - gFlightRecRamCount + index;
+    const uint8_t *pBlock = gaFlightRecRam[seq % FLIGHT_REC_RAM_BLOCKS];
+    uint32_t i;
+
+    /* The open block has no length or CRC yet */
+    if ((index < gFlightRecRamCount) &&
+        !((gFlightRecOpen == TRUE) && (seq == (gFlightRecNextSeq - 1u))))
+    {
+        len = FlightRec_BlockLen(pBlock);
+        for (i = 0u; i < len; i++)
+        {
+            pBuf[i] = pBlock[i];
+        }
+    }
+#endif
+
+    return len;
+}
+
+/*! *********************************************************************************
+* \brief     Blocks overwritten in RAM before a flush
+********************************************************************************** */
+uint32_t FlightRec_GetLostBlocks(void)
+{
+    return gFlightRecLost;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+/* Make room for maxLen bytes of records, starting a new block if needed */
+static void FlightRec_Reserve(uint32_t t, uint32_t maxLen)
+{
+    if ((gFlightRecOpen == TRUE) && ((gFlightRecUsed + maxLen) > FLIGHT_REC_BLOCK_SIZE))
+    {
+        FlightRec_CloseBlock();
+    }
+
+    if (gFlightRecOpen == FALSE)
+    {
+        FlightRec_OpenBlock(t);
+
+        /* Only after a periodic CONFIG; the next block has none */
+        if ((gFlightRecUsed + maxLen) > FLIGHT_REC_BLOCK_SIZE)
+        {
+            FlightRec_CloseBlock();
+            FlightRec_OpenBlock(t);
+        }
+    }
+}
+
+static void FlightRec_OpenBlock(uint32_t t)
+{
+    uint32_t seq = gFlightRecNextSeq;
+    uint32_t i;
+
+    if (gFlightRecRamCount < FLIGHT_REC_RAM_BLOCKS)
+    {
+        gFlightRecRamCount++;
+    }
+    else
+    {
+#if (FLIGHT_REC_FLASH_SIZE > 0u)
+        /* Oldest RAM block is overwritten before it reached flash */
+        uint32_t oldest = seq - FLIGHT_REC_RAM_BLOCKS;
+
+        if (oldest >= gFlightRecFlushSeq)
+        {
+            gFlightRecLost++;
+            gFlightRecFlushSeq = oldest + 1u;
+        }
+#endif
+    }
+
+    gpFlightRecBlock = gaFlightRecRam[seq % FLIGHT_REC_RAM_BLOCKS];
+    gpFlightRecBlock[0]  = FLIGHT_REC_MAGIC_0;
+    gpFlightRecBlock[1]  = FLIGHT_REC_MAGIC_1;
+    gpFlightRecBlock[2]  = FLIGHT_REC_VERSION;
+    gpFlightRecBlock[3]  = (gFlightRecBoot == TRUE) ? FLIGHT_REC_FLAG_BOOT : 0u;
+    gpFlightRecBlock[4]  = (uint8_t)(seq);
+    gpFlightRecBlock[5]  = (uint8_t)(seq >> 8u);
+    gpFlightRecBlock[6]  = (uint8_t)(seq >> 16u);
+    gpFlightRecBlock[7]  = (uint8_t)(seq >> 24u);
+    gpFlightRecBlock[8]  = (uint8_t)(t);
+    gpFlightRecBlock[9]  = (uint8_t)(t >> 8u);
+    gpFlightRecBlock[10] = (uint8_t)(t >> 16u);
+    gpFlightRecBlock[11] = (uint8_t)(t >> 24u);
+
+    gFlightRecNextSeq++;
+    gFlightRecBoot   = FALSE;
+    gFlightRecOpen   = TRUE;
+    gFlightRecUsed   = FLIGHT_REC_HDR_LEN;
+    gFlightRecConfigEnd = 0u;
+    gFlightRecPrevT = t;
+    gFlightRecPrevRssi = 0;
+    for (i = 0u; i < FLIGHT_REC_NUM_FEAT; i++)
+    {
+        gaFlightRecPrevFeat[i] = 0;
+    }
+
+    /* Repeat the configuration so a replay can resynchronise without its RESET */
+    if ((gFlightRecLutLen != 0u) && ((seq % FLIGHT_REC_CONFIG_INTERVAL) == 0u))
+    {
+        FlightRec_PutConfig(t);
+    }
+}
+
+static void FlightRec_CloseBlock(void)
+{
+    uint32_t payload = gFlightRecUsed - FLIGHT_REC_HDR_LEN;
+    uint16_t crc;
+
+    gpFlightRecBlock[12] = (uint8_t)(payload);
+    gpFlightRecBlock[13] = (uint8_t)(payload >> 8u);
+
+    crc = LogExport_Crc16(0xFFFFu, gpFlightRecBlock, 14u);
+    crc = LogExport_Crc16(crc, &gpFlightRecBlock[FLIGHT_REC_HDR_LEN], payload);
+    gpFlightRecBlock[14] = (uint8_t)(crc);
+    gpFlightRecBlock[15] = (uint8_t)(crc >> 8u);
+
+    /* Pad to a whole phrase with the erased value */
+    while ((gFlightRecUsed % FLIGHT_REC_PHRASE_SIZE) != 0u)
+    {
+        gpFlightRecBlock[gFlightRecUsed] = 0xFFu;
+        gFlightRecUsed++;
+    }
+
+    gFlightRecOpen = FALSE;
+}
+
+static void FlightRec_PutU8(uint8_t value)
+{
+    gpFlightRecBlock[gFlightRecUsed] = value;
+    gFlightRecUsed++;
+}
+
+static void FlightRec_PutVarint(uint32_t value)
+{
+    while (value >= 0x80u)
+    {
+        FlightRec_PutU8((uint8_t)(value | 0x80u));
+        value >>= 7u;
+    }
+    FlightRec_PutU8((uint8_t)value);
+}
+
+static void FlightRec_PutConfig(uint32_t t)
+{
+    int32_t prev = 0;
+    uint32_t i;
+
+    FlightRec_PutU8(FLIGHT_REC_TAG_CONFIG);
+    FlightRec_PutTime(t);
+    FlightRec_PutVarint(gFlightRecParams.wRawMs);
+    FlightRec_PutVarint(gFlightRecParams.wSpikeMs);
+    FlightRec_PutVarint(gFlightRecParams.wFeatMs);
+    FlightRec_PutVarint(gFlightRecParams.hampelKQ4);
+    FlightRec_PutVarint(gFlightRecParams.madEpsQ4);
+    FlightRec_PutSigned(gFlightRecParams.enterNearQ4);
+    FlightRec_PutSigned(gFlightRecParams.exitNearQ4);
+    FlightRec_PutVarint(gFlightRecParams.hystQ4);
+    FlightRec_PutVarint(gFlightRecParams.pctThQ15);
+    FlightRec_PutVarint(gFlightRecParams.stdThQ4);
+    FlightRec_PutVarint(gFlightRecParams.stableMs);
+    FlightRec_PutVarint(gFlightRecParams.minFeatSamples);
+    FlightRec_PutVarint(gFlightRecParams.exitConfirmMs);
+    FlightRec_PutVarint(gFlightRecParams.lockoutMs);
+    FlightRec_PutVarint(gFlightRecParams.maxReasonableDtMs);
+    FlightRec_PutVarint(gFlightRecParams.ticksPerMs);
+    FlightRec_PutVarint(gFlightRecLutLen);
+    for (i = 0u; i < gFlightRecLutLen; i++)
+    {
+        FlightRec_PutSigned((int32_t)gaFlightRecLut[i] - prev);
+        prev = (int32_t)gaFlightRecLut[i];
+    }
+
+    gFlightRecConfigEnd = gFlightRecUsed;
+}
+
+static uint32_t FlightRec_ZigZag(int32_t value)
+{
+    /* 0, -1, 1, -2, ... -> 0, 1, 2, 3, ... */
+    return (value < 0) ? ~((uint32_t)value << 1u) : ((uint32_t)value << 1u);
+}
+
+static void FlightRec_PutSigned(int32_t value)
+{
+    FlightRec_PutVarint(FlightRec_ZigZag(value));
+}
+
+static void FlightRec_PutTime(uint32_t t)
+{
+    FlightRec_PutVarint(t - gFlightRecPrevT);
+    gFlightRecPrevT = t;
+}
+
+/* Stored length of a closed block, header included, rounded to a phrase */
+static uint32_t FlightRec_BlockLen(const uint8_t *pBlock)
+{
+    uint32_t len = FLIGHT_REC_HDR_LEN + ((uint32_t)pBlock[12] | ((uint32_t)pBlock[13] << 8u));
+
+    return (len + FLIGHT_REC_PHRASE_SIZE - 1u) & ~(FLIGHT_REC_PHRASE_SIZE - 1u);
+}
+
+#if (FLIGHT_REC_FLASH_SIZE > 0u)
+static bool_t FlightRec_IsValid(const uint8_t *pBlock, uint32_t len)
+{
+    uint32_t payload = (uint32_t)pBlock[12] | ((uint32_t)pBlock[13] << 8u);
+    uint16_t crc;
+
+    if ((pBlock[0] != FLIGHT_REC_MAGIC_0) || (pBlock[1] != FLIGHT_REC_MAGIC_1) ||
+        (pBlock[2] != FLIGHT_REC_VERSION) || ((FLIGHT_REC_HDR_LEN + payload) > len))
+    {
+        return FALSE;
+    }
+
+    crc = LogExport_Crc16(0xFFFFu, pBlock, 14u);
+    crc = LogExport_Crc16(crc, &pBlock[FLIGHT_REC_HDR_LEN], payload);
+
+    return (crc == ((uint16_t)pBlock[14] | ((uint16_t)pBlock[15] << 8u))) ? TRUE : FALSE;
+}
+
+static bool_t FlightRec_FlashWrite(const uint8_t *pBlock)
+{
+    uint32_t addr = FLIGHT_REC_FLASH_ADDR + (gFlightRecFlashSlot * FLIGHT_REC_BLOCK_SIZE);
+    bool_t ok = TRUE;
+
+    /* Entering a sector drops the oldest blocks stored in it */
+    if (((gFlightRecFlashSlot * FLIGHT_REC_BLOCK_SIZE) % FLIGHT_REC_FLASH_SECTOR_SIZE) == 0u)
+    {
+        if (HAL_FlashEraseSector(addr, FLIGHT_REC_FLASH_SECTOR_SIZE) != kStatus_HAL_Flash_Success)
+        {
+            ok = FALSE;
+        }
+    }
+
+    if ((ok == TRUE) &&
+        (HAL_FlashProgram(addr, FlightRec_BlockLen(pBlock), (uint8_t *)pBlock) != kStatus_HAL_Flash_Success))
+    {
+        ok = FALSE;
+    }
+
+    /* A failed slot is skipped rather than retried forever */
+    gFlightRecFlashSlot = (gFlightRecFlashSlot + 1u) % FLIGHT_REC_FLASH_SLOTS;
+
+    return ok;
+}
+
+static uint32_t FlightRec_FlashRead(uint32_t slot, uint8_t *pBuf)
+{
+    uint32_t addr = FLIGHT_REC_FLASH_ADDR + (slot * FLIGHT_REC_BLOCK_SIZE);
+    uint32_t len;
+
+    if (HAL_FlashRead(addr, FLIGHT_REC_HDR_LEN, pBuf) != kStatus_HAL_Flash_Success)
+    {
+        return 0u;
+    }
+
+    if ((pBuf[0] != FLIGHT_REC_MAGIC_0) || (pBuf[1] != FLIGHT_REC_MAGIC_1))
+    {
+        return 0u;
+    }
+
+    len = FlightRec_BlockLen(pBuf);
+    if ((len > FLIGHT_REC_BLOCK_SIZE) ||
+        (HAL_FlashRead(addr + FLIGHT_REC_HDR_LEN, len - FLIGHT_REC_HDR_LEN,
+                       &pBuf[FLIGHT_REC_HDR_LEN]) != kStatus_HAL_Flash_Success) ||
+        (FlightRec_IsValid(pBuf, len) == FALSE))
+    {
+        return 0u;
+    }
+
+    return len;
+}
+#endif
@@ -0,0 +1,187 @@
+/*! *********************************************************************************
+* \file flight_rec.h
+*
+* RSSI proximity flight recorder.
+*
+* Keeps the last minutes of raw RSSI samples, ProxRssi features and events in a
+* compact RAM log and copies it to a reserved internal flash region on demand
+* (disconnect, shell). Flash persistence is off by default (FLIGHT_REC_FLASH_SIZE
+* 0, RAM only). Enabling it needs FLIGHT_REC_FLASH_ADDR, the start of a region the
+* user reserves in the linker script outside the application image; the build
+* stops if the size is set without it. The host tool tools/flight_rec_replay.c
+* decodes the log and reruns ProxRssi_MainFunction on the recorded samples to
+* reproduce every decision bit for bit.
+*
+* The log is a sequence of self-contained blocks. Records inside a block are delta
+* coded against the previous record of the same block and written as LEB128
+* varints (signed values zigzag mapped). Timestamps are the ProxRssi ones, in
+* ProxTime ticks: with the default 8 us tick a 10 Hz RSSI stream costs three bytes
+* per sample plus the periodic FEAT records, about four bytes per sample.
+* Dropping the oldest block never breaks decoding of the remaining ones.
+*
+* Block layout (little-endian):
+*
+*   0   'F' 'R'             magic
+*   2   uint8  version      FLIGHT_REC_VERSION
+*   3   uint8  flags        FLIGHT_REC_FLAG_x
+*   4   uint32 sequence     incremented per block, continues across resets
+*   8   uint32 base         time (ticks) the first record is relative to
+*  12   uint16 used         record bytes following the header
+*  14   uint16 crc          CRC-16/CCITT-FALSE over bytes 0..13 and the records
+*
+* Records (tag byte, then varints):
+*
+*   SAMPLE  dt, zz(rssi - previous rssi)
+*   0x80|d  dt                                  SAMPLE with d = zz(rssi step) < 128
+*   FEAT    dt, state, zz deltas of n, pct, std, last, min, max, ema
+*   EVENT   dt, code, arg
+*   RESET   dt                                  ProxRssi state cleared
+*   CONFIG  dt, 16 ProxRssi parameters (ticksPerMs last), lutLen, zz deltas of
+*           the alpha LUT
+*
+* Every RESET is preceded by a CONFIG record, so a replay can start at any RESET.
+* The CONFIG is also repeated every FLIGHT_REC_CONFIG_INTERVAL blocks so the host
+* can resynchronise on a log whose RESET was already overwritten.
+* All functions must be called from the same task.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef FLIGHT_REC_H
+#define FLIGHT_REC_H
+
+#include "EmbeddedTypes.h"
+#include "ProxRssi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Block size in bytes, multiple of the flash phrase (16) */
+#ifndef FLIGHT_REC_BLOCK_SIZE
+#define FLIGHT_REC_BLOCK_SIZE           (512u)
+#endif
+
+/* Blocks kept in RAM */
+#ifndef FLIGHT_REC_RAM_BLOCKS
+#define FLIGHT_REC_RAM_BLOCKS           (16u)
+#endif
+
+/* Flash region size in bytes, multiple of the sector size. 0 keeps the log in RAM only.
+   A non zero size needs FLIGHT_REC_FLASH_ADDR, the sector aligned start of the region */
+#ifndef FLIGHT_REC_FLASH_SIZE
+#define FLIGHT_REC_FLASH_SIZE           (0u)
+#endif
+
+#ifndef FLIGHT_REC_FLASH_SECTOR_SIZE
+#define FLIGHT_REC_FLASH_SECTOR_SIZE    (8192u)
+#endif
+
+/* A FEAT record is written every n samples and with every ProxRssi event */
+#ifndef FLIGHT_REC_FEAT_INTERVAL
+#define FLIGHT_REC_FEAT_INTERVAL        (10u)
+#endif
+
+/* The last CONFIG is repeated at the start of every n-th block */
+#ifndef FLIGHT_REC_CONFIG_INTERVAL
+#define FLIGHT_REC_CONFIG_INTERVAL      (8u)
+#endif
+
+#define FLIGHT_REC_MAGIC_0              (0x46u)     /* 'F' */
+#define FLIGHT_REC_MAGIC_1              (0x52u)     /* 'R' */
+#define FLIGHT_REC_VERSION              (2u)
+#define FLIGHT_REC_HDR_LEN              (16u)
+
+/* Block flags */
+#define FLIGHT_REC_FLAG_BOOT            (0x01u)     /* First block after FlightRec_Init */
+
+/* Record tags */
+#define FLIGHT_REC_TAG_SAMPLE           (0x01u)
+#define FLIGHT_REC_TAG_FEAT             (0x02u)
+#define FLIGHT_REC_TAG_EVENT            (0x03u)
+#define FLIGHT_REC_TAG_RESET            (0x04u)
+#define FLIGHT_REC_TAG_CONFIG           (0x05u)
+#define FLIGHT_REC_TAG_SAMPLE_SHORT     (0x80u)     /* Low 7 bits: zigzag RSSI step */
+
+/* EVENT codes */
+#define FLIGHT_REC_EVT_PROX             (0x01u)     /* arg: ProxRssi_EventType */
+#define FLIGHT_REC_EVT_CONNECT          (0x02u)     /* arg: deviceId */
+#define FLIGHT_REC_EVT_DISCONNECT       (0x03u)     /* arg: deviceId */
+#define FLIGHT_REC_EVT_WARM_START       (0x04u)     /* arg: smoothed samples restored */
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Empty the RAM log and locate the write position in flash
+********************************************************************************** */
+void FlightRec_Init(void);
+
+/*! *********************************************************************************
+* \brief     Record a ProxRssi (re)initialisation: CONFIG followed by RESET
+*
+* \param[in] t          Timestamp, as passed to ProxRssi.
+* \param[in] pParams    Effective parameters (ProxRssi_CtxType.p).
+* \param[in] pAlphaQ15  Alpha LUT as copied into the context.
+* \param[in] lutLen     LUT length.
+********************************************************************************** */
+void FlightRec_LogReset(uint32_t t, const ProxRssi_ParamsType *pParams,
+                        const uint16_t *pAlphaQ15, uint16_t lutLen);
+
+/*! *********************************************************************************
+* \brief     Record one ProxRssi_PushRaw + ProxRssi_MainFunction step
+*
+* \param[in] t          Timestamp passed to both calls.
+* \param[in] rssiDbm    Raw sample.
+* \param[in] ev         Event returned by ProxRssi_MainFunction.
+* \param[in] pFeat      Features returned by ProxRssi_MainFunction.
+* \param[in] emaQ4      Context EMA after the step.
+* \param[in] state      Context state after the step.
+********************************************************************************** */
+void FlightRec_LogStep(uint32_t t, int8_t rssiDbm, ProxRssi_EventType ev,
+                       const ProxRssi_FeaturesType *pFeat, int16_t emaQ4,
+                       ProxRssi_StateType state);
+
+/*! *********************************************************************************
+* \brief     Record an application event (FLIGHT_REC_EVT_x)
+********************************************************************************** */
+void FlightRec_LogEvent(uint32_t t, uint8_t code, uint8_t arg);
+
+/*! *********************************************************************************
+* \brief     Close the current block and copy all blocks not yet stored to flash
+*
+* \return    Number of blocks written.
+********************************************************************************** */
+uint32_t FlightRec_Flush(void);
+
+/*! *********************************************************************************
+* \brief     Number of block slots that FlightRec_ReadBlock can return
+********************************************************************************** */
+uint32_t FlightRec_BlockCount(void);
+
+/*! *********************************************************************************
+* \brief     Copy one stored block (flash slot, or closed RAM block without flash)
+*
+* \param[in]  index     0 .. FlightRec_BlockCount() - 1, in storage order.
+* \param[out] pBuf      FLIGHT_REC_BLOCK_SIZE bytes.
+*
+* \return     Block length including the header, 0 if the slot is empty or invalid.
+********************************************************************************** */
+uint32_t FlightRec_ReadBlock(uint32_t index, uint8_t *pBuf);
+
+/*! *********************************************************************************
+* \brief     Blocks lost because they were overwritten in RAM before a flush
+********************************************************************************** */
+uint32_t FlightRec_GetLostBlocks(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLIGHT_REC_H */
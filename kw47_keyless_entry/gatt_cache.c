@@ -0,0 +1,291 @@
+/*! *********************************************************************************
+* \file gatt_cache.c
+*
+* GATT handle cache per bond. See gatt_cache.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "gatt_cache.h"
+#include "FunctionLib.h"
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef enum
+{
+    gattCacheEmpty_c = 0,
+    gattCacheRecording_c,
+    gattCacheValid_c
+} gattCacheState_t;
+
+typedef struct
+{
+    uint8_t            aHash[GATT_CACHE_HASH_SIZE];
+    uint8_t            state;                       /* gattCacheState_t */
+    uint8_t            cServices;
+    uint8_t            cChars;
+    uint8_t            cDescs;
+    gattCacheService_t aServices[GATT_CACHE_MAX_SERVICES];
+    gattCacheChar_t    aChars[GATT_CACHE_MAX_CHARS];
+    gattCacheDesc_t    aDescs[GATT_CACHE_MAX_DESCS];
+} gattCacheEntry_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static gattCacheEntry_t gaGattCache[GATT_CACHE_BONDS];
+static gattCacheStats_t gGattCacheStats;
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static gattCacheEntry_t *GattCache_Recording(uint8_t bondIdx);
+static bool_t GattCache_Drop(gattCacheEntry_t *pEntry);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Empty the cache and clear the statistics
+********************************************************************************** */
+void GattCache_Init(void)
+{
+    uint8_t i;
+
+    for (i = 0u; i < GATT_CACHE_BONDS; i++)
+    {
+        gaGattCache[i].state = (uint8_t)gattCacheEmpty_c;
+    }
+    FLib_MemSet(&gGattCacheStats, 0u, sizeof(gGattCacheStats));
+}
+
+/*! *********************************************************************************
+* \brief     Check the entry of a bond against the Database Hash of the peer
+********************************************************************************** */
+bool_t GattCache_Match(uint8_t bondIdx, const uint8_t aHash[GATT_CACHE_HASH_SIZE])
+{
+    bool_t match = FALSE;
+
+    if (bondIdx >= GATT_CACHE_BONDS)
+    {
+        return FALSE;
+    }
+
+    if ((gaGattCache[bondIdx].state == (uint8_t)gattCacheValid_c) &&
+        (FLib_MemCmp(gaGattCache[bondIdx].aHash, aHash, GATT_CACHE_HASH_SIZE) == TRUE))
+    {
+        match = TRUE;
+        gGattCacheStats.hits++;
+    }
+    else
+    {
+        gGattCacheStats.misses++;
+    }
+
+    return match;
+}
+
+/*! *********************************************************************************
+* \brief     Start recording a discovery, the previous entry of the bond is dropped
+********************************************************************************** */
+bool_t GattCache_Begin(uint8_t bondIdx, const uint8_t aHash[GATT_CACHE_HASH_SIZE])
+{
+    gattCacheEntry_t *pEntry;
+
+    if (bondIdx >= GATT_CACHE_BONDS)
+    {
+        return FALSE;
+    }
+
+    pEntry = &gaGattCache[bondIdx];
+    FLib_MemCpy(pEntry->aHash, aHash, GATT_CACHE_HASH_SIZE);
+    pEntry->state = (uint8_t)gattCacheRecording_c;
+    pEntry->cServices = 0u;
+    pEntry->cChars = 0u;
+    pEntry->cDescs = 0u;
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     Record a service
+********************************************************************************** */
+bool_t GattCache_AddService(uint8_t bondIdx, const gattCacheService_t *pService)
+{
+    gattCacheEntry_t *pEntry = GattCache_Recording(bondIdx);
+    gattCacheService_t *pSlot;
+
+    if (pEntry == NULL)
+    {
+        return FALSE;
+    }
+    if (pEntry->cServices >= GATT_CACHE_MAX_SERVICES)
+    {
+        return GattCache_Drop(pEntry);
+    }
+
+    pSlot = &pEntry->aServices[pEntry->cServices];
+    *pSlot = *pService;
+    pSlot->cChars = 0u;
+    pEntry->cServices++;
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     Record a characteristic of the last service
+********************************************************************************** */
+bool_t GattCache_AddChar(uint8_t bondIdx, const gattCacheChar_t *pChar)
+{
+    gattCacheEntry_t *pEntry = GattCache_Recording(bondIdx);
+    gattCacheChar_t *pSlot;
+
+    if (pEntry == NULL)
+    {
+        return FALSE;
+    }
+    if ((pEntry->cServices == 0u) || (pEntry->cChars >= GATT_CACHE_MAX_CHARS))
+    {
+        return GattCache_Drop(pEntry);
+    }
+
+    pSlot = &pEntry->aChars[pEntry->cChars];
+    *pSlot = *pChar;
+    pSlot->cDescs = 0u;
+    pEntry->cChars++;
+    pEntry->aServices[pEntry->cServices - 1u].cChars++;
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     Record a descriptor of the last characteristic
+********************************************************************************** */
+bool_t GattCache_AddDesc(uint8_t bondIdx, const gattCacheDesc_t *pDesc)
+{
+    gattCacheEntry_t *pEntry = GattCache_Recording(bondIdx);
+
+    if (pEntry == NULL)
+    {
+        return FALSE;
+    }
+    /* The characteristic must belong to the last service */
+    if ((pEntry->cChars == 0u) || (pEntry->aServices[pEntry->cServices - 1u].cChars == 0u) ||
+        (pEntry->cDescs >= GATT_CACHE_MAX_DESCS) || (pDesc->uuidType != GATT_CACHE_UUID_TYPE_16))
+    {
+        return GattCache_Drop(pEntry);
+    }
+
+    pEntry->aDescs[pEntry->cDescs] = *pDesc;
+    pEntry->cDescs++;
+    pEntry->aChars[pEntry->cChars - 1u].cDescs++;
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     The discovery recorded for the bond is complete
+********************************************************************************** */
+bool_t GattCache_Commit(uint8_t bondIdx)
+{
+    gattCacheEntry_t *pEntry = GattCache_Recording(bondIdx);
+
+    if (pEntry == NULL)
+    {
+        return FALSE;
+    }
+
+    pEntry->state = (uint8_t)gattCacheValid_c;
+    gGattCacheStats.stored++;
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     Drop the recording of a discovery that failed or was stopped
+********************************************************************************** */
+void GattCache_Abort(uint8_t bondIdx)
+{
+    gattCacheEntry_t *pEntry = GattCache_Recording(bondIdx);
+
+    if (pEntry != NULL)
+    {
+        pEntry->state = (uint8_t)gattCacheEmpty_c;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Service of a complete entry, for the replay
+********************************************************************************** */
+const gattCacheService_t *GattCache_GetService(uint8_t bondIdx, uint8_t index,
+                                               const gattCacheChar_t **ppChars,
+                                               const gattCacheDesc_t **ppDescs)
+{
+    const gattCacheEntry_t *pEntry;
+    uint8_t firstChar = 0u;
+    uint8_t firstDesc = 0u;
+    uint8_t s;
+    uint8_t c;
+
+    if ((bondIdx >= GATT_CACHE_BONDS) || (gaGattCache[bondIdx].state != (uint8_t)gattCacheValid_c) ||
+        (index >= gaGattCache[bondIdx].cServices))
+    {
+        return NULL;
+    }
+
+    /* Characteristics and descriptors of the services before it */
+    pEntry = &gaGattCache[bondIdx];
+    for (s = 0u; s < index; s++)
+    {
+        for (c = 0u; c < pEntry->aServices[s].cChars; c++)
+        {
+            firstDesc += pEntry->aChars[firstChar + c].cDescs;
+        }
+        firstChar += pEntry->aServices[s].cChars;
+    }
+
+    *ppChars = &pEntry->aChars[firstChar];
+    *ppDescs = &pEntry->aDescs[firstDesc];
+
+    return &pEntry->aServices[index];
+}
+
+/*! *********************************************************************************
+* \brief     Counters since GattCache_Init
+********************************************************************************** */
+void GattCache_GetStats(gattCacheStats_t *pStats)
+{
+    *pStats = gGattCacheStats;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static gattCacheEntry_t *GattCache_Recording(uint8_t bondIdx)
+{
+    if ((bondIdx >= GATT_CACHE_BONDS) || (gaGattCache[bondIdx].state != (uint8_t)gattCacheRecording_c))
+    {
+        return NULL;
+    }
+    return &gaGattCache[bondIdx];
+}
+
+/* The discovery does not fit: the bond is discovered every time */
+static bool_t GattCache_Drop(gattCacheEntry_t *pEntry)
+{
+    pEntry->state = (uint8_t)gattCacheEmpty_c;
+    gGattCacheStats.dropped++;
+    return FALSE;
+}
@@ -0,0 +1,205 @@
+/*! *********************************************************************************
+* \file gatt_cache.h
+*
+* GATT handle cache per bond for ble_service_discovery.c.
+*
+* A reconnecting bonded peer usually has the same GATT database as last time, yet
+* service discovery walks it again: primary services, then the characteristics
+* of each service, then the descriptors of each characteristic, one ATT request
+* per connection event. The cache keeps what the last complete discovery of a
+* bond found (services, characteristics and descriptors with their handles),
+* together with the Database Hash (0x2B2A) the peer exposed at the time.
+*
+* On reconnection ble_service_discovery.c reads the Database Hash first, a single
+* request, and on a match replays the cached services to the application instead
+* of discovering them. The hash covers the whole database layout, so a match is
+* enough even if the bond slot was reused by another phone. On a miss, or a peer
+* without a Database Hash, the discovery runs as before and is recorded.
+*
+* An entry holds as many services as the discovery keeps (gMaxServicesCount_d)
+* and room for the characteristics and descriptors of a phone's database over
+* them. A recording that does not fit the entry, or holds a 128-bit descriptor
+* UUID, is dropped: that bond is simply discovered every time, `dropped` in the
+* statistics shows it.
+*
+* Entries are indexed by the NVM index of the bond and kept in RAM: they survive
+* reconnections, not resets. Zero initialized storage is an empty cache.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef GATT_CACHE_H
+#define GATT_CACHE_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Bonds cached, by NVM index; later indexes are not cached */
+#ifndef GATT_CACHE_BONDS
+#if defined(gMaxBondedDevices_c)
+#define GATT_CACHE_BONDS                (gMaxBondedDevices_c)
+#else
+#define GATT_CACHE_BONDS                (8u)
+#endif
+#endif
+
+/* Capacity of one entry, all services together: services kept by the discovery */
+#ifndef GATT_CACHE_MAX_SERVICES
+#if defined(gMaxServicesCount_d)
+#define GATT_CACHE_MAX_SERVICES         (gMaxServicesCount_d)
+#else
+#define GATT_CACHE_MAX_SERVICES         (6u)
+#endif
+#endif
+
+/* Phones expose 15 to 25 characteristics and about 10 descriptors over those
+   services (GAP, GATT, Device Information, Battery, notification and media
+   services, vendor services), about 1 KB an entry */
+#ifndef GATT_CACHE_MAX_CHARS
+#define GATT_CACHE_MAX_CHARS            (32u)
+#endif
+
+#ifndef GATT_CACHE_MAX_DESCS
+#define GATT_CACHE_MAX_DESCS            (24u)
+#endif
+
+/* Database Hash and UUID sizes */
+#define GATT_CACHE_HASH_SIZE            (16u)
+#define GATT_CACHE_UUID_SIZE            (16u)
+
+/* gBleUuidType16_c, the only descriptor UUID type cached */
+#define GATT_CACHE_UUID_TYPE_16         (0x01u)
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+/* Service; cChars is counted by the cache */
+typedef struct
+{
+    uint16_t startHandle;
+    uint16_t endHandle;
+    uint8_t  uuidType;              /* bleUuidType_t */
+    uint8_t  cChars;
+    uint8_t  aUuid[GATT_CACHE_UUID_SIZE];   /* bleUuid_t */
+} gattCacheService_t;
+
+/* Characteristic of the last service added; cDescs is counted by the cache */
+typedef struct
+{
+    uint16_t valueHandle;
+    uint8_t  properties;
+    uint8_t  uuidType;              /* bleUuidType_t */
+    uint8_t  cDescs;
+    uint8_t  aUuid[GATT_CACHE_UUID_SIZE];   /* bleUuid_t */
+} gattCacheChar_t;
+
+/* Descriptor of the last characteristic added, 16-bit UUID only */
+typedef struct
+{
+    uint16_t handle;
+    uint16_t uuid16;
+    uint8_t  uuidType;              /* bleUuidType_t */
+} gattCacheDesc_t;
+
+typedef struct
+{
+    uint32_t hits;                  /* Discoveries replayed from the cache */
+    uint32_t misses;                /* Hash read, no entry or another hash */
+    uint32_t stored;                /* Discoveries recorded */
+    uint32_t dropped;               /* Recordings that did not fit */
+} gattCacheStats_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Empty the cache and clear the statistics
+********************************************************************************** */
+void GattCache_Init(void);
+
+/*! *********************************************************************************
+* \brief     Check the entry of a bond against the Database Hash of the peer
+*
+* \param[in] bondIdx    NVM index of the bond.
+* \param[in] aHash      Database Hash read from the peer.
+*
+* \return    TRUE if the entry is complete and was recorded with this hash.
+********************************************************************************** */
+bool_t GattCache_Match(uint8_t bondIdx, const uint8_t aHash[GATT_CACHE_HASH_SIZE]);
+
+/*! *********************************************************************************
+* \brief     Start recording a discovery, the previous entry of the bond is dropped
+*
+* \param[in] bondIdx    NVM index of the bond.
+* \param[in] aHash      Database Hash read before the discovery.
+*
+* \return    FALSE if the bond is not cached.
+********************************************************************************** */
+bool_t GattCache_Begin(uint8_t bondIdx, const uint8_t aHash[GATT_CACHE_HASH_SIZE]);
+
+/*! *********************************************************************************
+* \brief     Record a service, then its characteristics and their descriptors
+*
+* \param[in] bondIdx    NVM index of the bond.
+*
+* \return    FALSE if nothing is being recorded for the bond, or the recording
+*            was dropped because it does not fit.
+********************************************************************************** */
+bool_t GattCache_AddService(uint8_t bondIdx, const gattCacheService_t *pService);
+bool_t GattCache_AddChar(uint8_t bondIdx, const gattCacheChar_t *pChar);
+bool_t GattCache_AddDesc(uint8_t bondIdx, const gattCacheDesc_t *pDesc);
+
+/*! *********************************************************************************
+* \brief     The discovery recorded for the bond is complete
+*
+* \param[in] bondIdx    NVM index of the bond.
+*
+* \return    TRUE if an entry was stored.
+********************************************************************************** */
+bool_t GattCache_Commit(uint8_t bondIdx);
+
+/*! *********************************************************************************
+* \brief     Drop the recording of a discovery that failed or was stopped
+*
+* A complete entry is kept.
+*
+* \param[in] bondIdx    NVM index of the bond.
+********************************************************************************** */
+void GattCache_Abort(uint8_t bondIdx);
+
+/*! *********************************************************************************
+* \brief     Service of a complete entry, for the replay
+*
+* \param[in]  bondIdx   NVM index of the bond.
+* \param[in]  index     Service, in discovery order.
+* \param[out] ppChars   The cChars characteristics of the service.
+* \param[out] ppDescs   Their descriptors, cDescs of each in turn.
+*
+* \return     NULL past the last service or without a complete entry.
+********************************************************************************** */
+const gattCacheService_t *GattCache_GetService(uint8_t bondIdx, uint8_t index,
+                                               const gattCacheChar_t **ppChars,
+                                               const gattCacheDesc_t **ppDescs);
+
+/*! *********************************************************************************
+* \brief     Counters since GattCache_Init
+*
+* \param[out] pStats    Statistics.
+********************************************************************************** */
+void GattCache_GetStats(gattCacheStats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GATT_CACHE_H */
@@ -0,0 +1,256 @@
+/*! *********************************************************************************
+* \file log_export.c
+*
+* Framed ring buffer for exporting CS HCI and RAS data logs. See log_export.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "log_export.h"
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+#define LOG_EXPORT_RING_MASK            (LOG_EXPORT_RING_SIZE - 1u)
+
+#if ((LOG_EXPORT_RING_SIZE & LOG_EXPORT_RING_MASK) != 0u)
+#error "LOG_EXPORT_RING_SIZE must be a power of two"
+#endif
+
+#define LOG_EXPORT_OVERFLOW_LEN         (8u)
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static uint8_t gaLogExportRing[LOG_EXPORT_RING_SIZE];
+
+/* Free running indexes: head written by the producer only, tail by the consumer only */
+static volatile uint32_t gLogExportHead;
+static volatile uint32_t gLogExportTail;
+
+/* Producer state */
+static uint8_t  gLogExportSeq;
+static uint32_t gLogExportDropped;
+static uint32_t gLogExportPendingFrames;        /* Lost since the last overflow frame */
+static uint32_t gLogExportPendingBytes;
+
+/* CRC-16/CCITT nibble table */
+static const uint16_t gaLogExportCrcTable[16] =
+{
+    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+    0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu
+};
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static bool_t LogExport_WriteFrame(uint8_t type, uint32_t timestampUs,
+                                   const uint8_t *pPart1, uint16_t len1,
+                                   const uint8_t *pPart2, uint16_t len2);
+static uint32_t LogExport_Put(uint32_t pos, const uint8_t *pData, uint32_t len);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Empty the ring and clear the counters
+********************************************************************************** */
+void LogExport_Init(void)
+{
+    gLogExportHead          = 0u;
+    gLogExportTail          = 0u;
+    gLogExportSeq           = 0u;
+    gLogExportDropped       = 0u;
+    gLogExportPendingFrames = 0u;
+    gLogExportPendingBytes  = 0u;
+}
+
+/*! *********************************************************************************
+* \brief     Append one frame
+********************************************************************************** */
+bool_t LogExport_Append(uint8_t type, uint32_t timestampUs,
+                        const uint8_t *pPart1, uint16_t len1,
+                        const uint8_t *pPart2, uint16_t len2)
+{
+    uint8_t aOverflow[LOG_EXPORT_OVERFLOW_LEN];
+    bool_t queued = TRUE;
+
+    if (((uint32_t)len1 + len2) > 0xFFFFu)
+    {
+        queued = FALSE;
+    }
+
+    /* Report earlier losses first so the host sees them in order */
+    if ((queued == TRUE) && (gLogExportPendingFrames != 0u))
+    {
+        aOverflow[0] = (uint8_t)(gLogExportPendingFrames);
+        aOverflow[1] = (uint8_t)(gLogExportPendingFrames >> 8u);
+        aOverflow[2] = (uint8_t)(gLogExportPendingFrames >> 16u);
+        aOverflow[3] = (uint8_t)(gLogExportPendingFrames >> 24u);
+        aOverflow[4] = (uint8_t)(gLogExportPendingBytes);
+        aOverflow[5] = (uint8_t)(gLogExportPendingBytes >> 8u);
+        aOverflow[6] = (uint8_t)(gLogExportPendingBytes >> 16u);
+        aOverflow[7] = (uint8_t)(gLogExportPendingBytes >> 24u);
+
+        if (LogExport_WriteFrame(LOG_EXPORT_TYPE_OVERFLOW, timestampUs,
+                                 aOverflow, LOG_EXPORT_OVERFLOW_LEN, NULL, 0u) == TRUE)
+        {
+            gLogExportPendingFrames = 0u;
+            gLogExportPendingBytes  = 0u;
+        }
+        else
+        {
+            queued = FALSE;
+        }
+    }
+
+    if (queued == TRUE)
+    {
+        queued = LogExport_WriteFrame(type, timestampUs, pPart1, len1, pPart2, len2);
+    }
+
+    if (queued == FALSE)
+    {
+        gLogExportDropped++;
+        gLogExportPendingFrames++;
+        gLogExportPendingBytes += (uint32_t)len1 + len2;
+    }
+
+    return queued;
+}
+
+/*! *********************************************************************************
+* \brief     Contiguous block of queued bytes
+********************************************************************************** */
+uint32_t LogExport_Peek(uint8_t **ppData)
+{
+    uint32_t tail = gLogExportTail;
+    uint32_t used = gLogExportHead - tail;
+    uint32_t offset = tail & LOG_EXPORT_RING_MASK;
+    uint32_t toEnd = LOG_EXPORT_RING_SIZE - offset;
+
+    *ppData = &gaLogExportRing[offset];
+
+    return (used < toEnd) ? used : toEnd;
+}
+
+/*! *********************************************************************************
+* \brief     Release written bytes
+********************************************************************************** */
+void LogExport_Consume(uint32_t len)
+{
+    uint32_t used = gLogExportHead - gLogExportTail;
+
+    gLogExportTail += (len < used) ? len : used;
+}
+
+/*! *********************************************************************************
+* \brief     Bytes currently queued
+********************************************************************************** */
+uint32_t LogExport_Used(void)
+{
+    return gLogExportHead - gLogExportTail;
+}
+
+/*! *********************************************************************************
+* \brief     Frames dropped since init
+********************************************************************************** */
+uint32_t LogExport_GetDropped(void)
+{
+    return gLogExportDropped;
+}
+
+/*! *********************************************************************************
+* \brief     CRC-16/CCITT-FALSE update
+********************************************************************************** */
+uint16_t LogExport_Crc16(uint16_t crc, const uint8_t *pData, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0u; i < len; i++)
+    {
+        crc = (uint16_t)((crc << 4u) ^ gaLogExportCrcTable[((crc >> 12u) ^ (pData[i] >> 4u)) & 0x0Fu]);
+        crc = (uint16_t)((crc << 4u) ^ gaLogExportCrcTable[((crc >> 12u) ^ (pData[i] & 0x0Fu)) & 0x0Fu]);
+    }
+
+    return crc;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static bool_t LogExport_WriteFrame(uint8_t type, uint32_t timestampUs,
+                                   const uint8_t *pPart1, uint16_t len1,
+                                   const uint8_t *pPart2, uint16_t len2)
+{
+    uint8_t aHdr[LOG_EXPORT_HDR_LEN];
+    uint8_t aCrc[LOG_EXPORT_CRC_LEN];
+    uint32_t payloadLen = (uint32_t)len1 + len2;
+    uint32_t head = gLogExportHead;
+    uint32_t pos = head;
+    uint16_t crc;
+
+    if ((LOG_EXPORT_RING_SIZE - (head - gLogExportTail)) < (payloadLen + LOG_EXPORT_OVERHEAD))
+    {
+        return FALSE;
+    }
+
+    aHdr[0] = LOG_EXPORT_SYNC_0;
+    aHdr[1] = LOG_EXPORT_SYNC_1;
+    aHdr[2] = (uint8_t)(payloadLen);
+    aHdr[3] = (uint8_t)(payloadLen >> 8u);
+    aHdr[4] = (uint8_t)(timestampUs);
+    aHdr[5] = (uint8_t)(timestampUs >> 8u);
+    aHdr[6] = (uint8_t)(timestampUs >> 16u);
+    aHdr[7] = (uint8_t)(timestampUs >> 24u);
+    aHdr[8] = type;
+    aHdr[9] = gLogExportSeq;
+
+    crc = LogExport_Crc16(0xFFFFu, &aHdr[2], LOG_EXPORT_HDR_LEN - 2u);
+    pos = LogExport_Put(pos, aHdr, LOG_EXPORT_HDR_LEN);
+
+    if (len1 != 0u)
+    {
+        crc = LogExport_Crc16(crc, pPart1, len1);
+        pos = LogExport_Put(pos, pPart1, len1);
+    }
+    if (len2 != 0u)
+    {
+        crc = LogExport_Crc16(crc, pPart2, len2);
+        pos = LogExport_Put(pos, pPart2, len2);
+    }
+
+    aCrc[0] = (uint8_t)(crc);
+    aCrc[1] = (uint8_t)(crc >> 8u);
+    pos = LogExport_Put(pos, aCrc, LOG_EXPORT_CRC_LEN);
+
+    gLogExportSeq++;
+
+    /* Publish the frame only once it is complete */
+    gLogExportHead = pos;
+
+    return TRUE;
+}
+
+static uint32_t LogExport_Put(uint32_t pos, const uint8_t *pData, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0u; i < len; i++)
+    {
+        gaLogExportRing[(pos + i) & LOG_EXPORT_RING_MASK] = pData[i];
+    }
+
+    return pos + len;
+}
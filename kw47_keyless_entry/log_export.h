@@ -0,0 +1,116 @@
+/*! *********************************************************************************
+* \file log_export.h
+*
+* Framed ring buffer for exporting CS HCI and RAS data logs over a serial port.
+*
+* Packets are appended to a RAM ring as self-describing frames and the ring is
+* drained in large contiguous chunks by the serial driver (non-blocking / DMA). The
+* producer never waits for the UART: when the ring is full the packet is dropped and
+* the loss is reported with an overflow frame as soon as space is available again.
+*
+* Frame layout (little-endian):
+*
+*   0   0xA5 0x5A           sync
+*   2   uint16 length       payload length
+*   4   uint32 timestamp    us, free running
+*   8   uint8  type         LOG_EXPORT_TYPE_x
+*   9   uint8  sequence     incremented per queued frame, gaps mean loss on the link
+*  10   payload
+*  10+n uint16 crc          CRC-16/CCITT-FALSE over length..payload
+*
+* Single producer, single consumer: Append may run in a different context than
+* Peek/Consume without locking.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef LOG_EXPORT_H
+#define LOG_EXPORT_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Ring size in bytes, must be a power of two */
+#ifndef LOG_EXPORT_RING_SIZE
+#define LOG_EXPORT_RING_SIZE            (8192u)
+#endif
+
+#define LOG_EXPORT_SYNC_0               (0xA5u)
+#define LOG_EXPORT_SYNC_1               (0x5Au)
+#define LOG_EXPORT_HDR_LEN              (10u)
+#define LOG_EXPORT_CRC_LEN              (2u)
+#define LOG_EXPORT_OVERHEAD             (LOG_EXPORT_HDR_LEN + LOG_EXPORT_CRC_LEN)
+
+/* Frame types */
+#define LOG_EXPORT_TYPE_HCI             (0x01u)     /* Local CS HCI event (H4 format) */
+#define LOG_EXPORT_TYPE_RAS             (0x02u)     /* Remote ranging data received via RAS */
+#define LOG_EXPORT_TYPE_OVERFLOW        (0xFFu)     /* uint32 frames + uint32 bytes dropped */
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Empty the ring and clear the counters
+********************************************************************************** */
+void LogExport_Init(void);
+
+/*! *********************************************************************************
+* \brief     Append one frame. The payload is the concatenation of two parts so
+*            a header can be prefixed without building a contiguous copy.
+*
+* \param[in] type        Frame type.
+* \param[in] timestampUs Timestamp.
+* \param[in] pPart1      First payload part, may be NULL if len1 is 0.
+* \param[in] len1        First payload part length.
+* \param[in] pPart2      Second payload part, may be NULL if len2 is 0.
+* \param[in] len2        Second payload part length.
+*
+* \return    TRUE if queued, FALSE if dropped because the ring is full.
+********************************************************************************** */
+bool_t LogExport_Append(uint8_t type, uint32_t timestampUs,
+                        const uint8_t *pPart1, uint16_t len1,
+                        const uint8_t *pPart2, uint16_t len2);
+
+/*! *********************************************************************************
+* \brief     Contiguous block of queued bytes, ready to be written
+*
+* \param[out] ppData    Start of the block.
+*
+* \return     Block length, 0 if the ring is empty.
+********************************************************************************** */
+uint32_t LogExport_Peek(uint8_t **ppData);
+
+/*! *********************************************************************************
+* \brief     Release bytes returned by LogExport_Peek once they were written
+********************************************************************************** */
+void LogExport_Consume(uint32_t len);
+
+/*! *********************************************************************************
+* \brief     Bytes currently queued
+********************************************************************************** */
+uint32_t LogExport_Used(void);
+
+/*! *********************************************************************************
+* \brief     Frames dropped since init
+********************************************************************************** */
+uint32_t LogExport_GetDropped(void);
+
+/*! *********************************************************************************
+* \brief     CRC-16/CCITT-FALSE update (poly 0x1021, init 0xFFFF)
+********************************************************************************** */
+uint16_t LogExport_Crc16(uint16_t crc, const uint8_t *pData, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_EXPORT_H */
@@ -0,0 +1,218 @@
+/*! *********************************************************************************
+* \file msg_lane.c
+*
+* Priority lanes for the application message queues. See msg_lane.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "msg_lane.h"
+#include "cs_latency.h"
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+#define MSG_LANE_BUCKET_MAX             (0xFFFFu)
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef struct
+{
+    uint32_t count;                                 /* Messages since reset */
+    uint32_t total;                                 /* Sum of aBucket[] */
+    uint32_t maxUs;
+    uint16_t aBucket[CS_LATENCY_NUM_BUCKETS];       /* Same buckets as cs_latency.c */
+} msgLaneHist_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static msgLaneHist_t gaMsgLaneHist[msgLaneCount_c];
+
+/* Critical messages served since the last bulk one */
+static uint8_t gMsgLaneCriticalRun;
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static uint32_t MsgLane_Percentile(const msgLaneHist_t *pHist, uint8_t percent);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Reset the scheduler and clear the latency histograms
+********************************************************************************** */
+void MsgLane_Init(void)
+{
+    gMsgLaneCriticalRun = 0u;
+    MsgLane_ResetStats();
+}
+
+/*! *********************************************************************************
+* \brief     Clear the latency histograms
+********************************************************************************** */
+void MsgLane_ResetStats(void)
+{
+    uint8_t lane;
+    uint8_t bucket;
+
+    for (lane = 0u; lane < (uint8_t)msgLaneCount_c; lane++)
+    {
+        gaMsgLaneHist[lane].count = 0u;
+        gaMsgLaneHist[lane].total = 0u;
+        gaMsgLaneHist[lane].maxUs = 0u;
+        for (bucket = 0u; bucket < CS_LATENCY_NUM_BUCKETS; bucket++)
+        {
+            gaMsgLaneHist[lane].aBucket[bucket] = 0u;
+        }
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Lane to serve next
+********************************************************************************** */
+msgLane_t MsgLane_Pick(uint8_t pendingMask)
+{
+    bool_t critical = ((pendingMask & MSG_LANE_BIT(msgLaneCritical_c)) != 0u) ? TRUE : FALSE;
+    bool_t bulk = ((pendingMask & MSG_LANE_BIT(msgLaneBulk_c)) != 0u) ? TRUE : FALSE;
+    msgLane_t lane = msgLaneCount_c;
+
+    if ((critical == TRUE) && ((bulk == FALSE) || (gMsgLaneCriticalRun < MSG_LANE_CRITICAL_BURST)))
+    {
+        lane = msgLaneCritical_c;
+        if (bulk == TRUE)
+        {
+            gMsgLaneCriticalRun++;
+        }
+    }
+    else if (bulk == TRUE)
+    {
+        lane = msgLaneBulk_c;
+        gMsgLaneCriticalRun = 0u;
+    }
+    else
+    {
+        /* Nothing pending */
+    }
+
+    return lane;
+}
+
+/*! *********************************************************************************
+* \brief     Record the queueing latency of a message
+********************************************************************************** */
+void MsgLane_Record(msgLane_t lane, uint32_t latencyUs)
+{
+    msgLaneHist_t *pHist;
+    uint8_t bucket;
+    uint8_t i;
+
+    if ((uint8_t)lane >= (uint8_t)msgLaneCount_c)
+    {
+        return;
+    }
+
+    pHist = &gaMsgLaneHist[lane];
+    bucket = CsLatency_BucketIndex(latencyUs);
+
+    /* Saturate by halving, as cs_latency.c does */
+    if (pHist->aBucket[bucket] == MSG_LANE_BUCKET_MAX)
+    {
+        pHist->total = 0u;
+        for (i = 0u; i < CS_LATENCY_NUM_BUCKETS; i++)
+        {
+            pHist->aBucket[i] = (uint16_t)(pHist->aBucket[i] >> 1u);
+            pHist->total += pHist->aBucket[i];
+        }
+    }
+
+    pHist->aBucket[bucket]++;
+    pHist->total++;
+
+    if (pHist->count < 0xFFFFFFFFu)
+    {
+        pHist->count++;
+    }
+    if (latencyUs > pHist->maxUs)
+    {
+        pHist->maxUs = latencyUs;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Latency summary of a lane
+********************************************************************************** */
+bool_t MsgLane_GetStats(msgLane_t lane, msgLaneStats_t *pStats)
+{
+    const msgLaneHist_t *pHist;
+    bool_t result = FALSE;
+
+    if (pStats != NULL)
+    {
+        pStats->count = 0u;
+        pStats->p50Us = 0u;
+        pStats->p99Us = 0u;
+        pStats->maxUs = 0u;
+
+        if (((uint8_t)lane < (uint8_t)msgLaneCount_c) && (gaMsgLaneHist[lane].count != 0u))
+        {
+            pHist = &gaMsgLaneHist[lane];
+            pStats->count = pHist->count;
+            pStats->p50Us = MsgLane_Percentile(pHist, 50u);
+            pStats->p99Us = MsgLane_Percentile(pHist, 99u);
+            pStats->maxUs = pHist->maxUs;
+            result = TRUE;
+        }
+    }
+
+    return result;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static uint32_t MsgLane_Percentile(const msgLaneHist_t *pHist, uint8_t percent)
+{
+    uint32_t rank;
+    uint32_t seen = 0u;
+    uint32_t value = 0u;
+    uint8_t bucket;
+
+    if (pHist->total == 0u)
+    {
+        return 0u;
+    }
+
+    /* Smallest bucket holding at least percent % of the messages */
+    rank = (((pHist->total * (uint32_t)percent) + 99u) / 100u);
+    if (rank == 0u)
+    {
+        rank = 1u;
+    }
+
+    for (bucket = 0u; bucket < CS_LATENCY_NUM_BUCKETS; bucket++)
+    {
+        seen += pHist->aBucket[bucket];
+        if (seen >= rank)
+        {
+            value = CsLatency_BucketUpperUs(bucket);
+            break;
+        }
+    }
+
+    return (value > pHist->maxUs) ? pHist->maxUs : value;
+}
@@ -0,0 +1,113 @@
+/*! *********************************************************************************
+* \file msg_lane.h
+*
+* Priority lanes for the application message queues of app_conn.c.
+*
+* Application callbacks go to one of two lanes: a critical lane for Channel Sounding
+* and unlock handshake events, and a bulk lane for everything else (shell commands,
+* bond listing). Host stack messages (RSSI reads, CS events, Digital Key data) are
+* served in the critical lane as one FIFO, never sorted by type: a connection's
+* disconnect or L2CAP data must not overtake its earlier messages, so a long L2CAP
+* payload delays the messages queued behind it. BluetoothLEHost_HandleMessages
+* asks MsgLane_Pick which lane to serve next: the critical lane always goes first,
+* except that after MSG_LANE_CRITICAL_BURST critical messages in a row one bulk
+* message is let through so a flood of CS events cannot starve the bulk lane
+* forever.
+*
+* Handlers are not preempted, so the wait of a critical message is bounded by the
+* longest bulk handler plus the critical messages queued ahead of it.
+*
+* The queueing latency of every message (post to start of handling) is recorded
+* per lane in the same log-bucketed histogram as cs_latency.c. Host stack messages
+* are stamped when App_QueueHostMessage queues them, callbacks when posted.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef MSG_LANE_H
+#define MSG_LANE_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Critical messages served in a row before one waiting bulk message is let through */
+#ifndef MSG_LANE_CRITICAL_BURST
+#define MSG_LANE_CRITICAL_BURST         (8u)
+#endif
+
+/* Bit of a lane in the pending mask of MsgLane_Pick */
+#define MSG_LANE_BIT(lane)              (1u << (uint8_t)(lane))
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+typedef enum
+{
+    msgLaneCritical_c = 0,          /* RSSI, CS, unlock handshake */
+    msgLaneBulk_c,                  /* Everything else */
+    msgLaneCount_c
+} msgLane_t;
+
+typedef struct
+{
+    uint32_t count;                 /* Messages recorded */
+    uint32_t p50Us;
+    uint32_t p99Us;
+    uint32_t maxUs;
+} msgLaneStats_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Reset the scheduler and clear the latency histograms
+********************************************************************************** */
+void MsgLane_Init(void);
+
+/*! *********************************************************************************
+* \brief     Clear the latency histograms, the scheduler state is kept
+********************************************************************************** */
+void MsgLane_ResetStats(void);
+
+/*! *********************************************************************************
+* \brief     Lane to serve next
+*
+* \param[in] pendingMask    MSG_LANE_BIT() of every lane holding a message.
+*
+* \return    Lane to take one message from, msgLaneCount_c if the mask is empty.
+********************************************************************************** */
+msgLane_t MsgLane_Pick(uint8_t pendingMask);
+
+/*! *********************************************************************************
+* \brief     Record the queueing latency of a message about to be handled
+*
+* \param[in] lane       Lane the message was taken from.
+* \param[in] latencyUs  Time between posting and handling in microseconds.
+********************************************************************************** */
+void MsgLane_Record(msgLane_t lane, uint32_t latencyUs);
+
+/*! *********************************************************************************
+* \brief     Latency summary of a lane
+*
+* \param[in]  lane      Lane.
+* \param[out] pStats    Count, p50, p99 and max.
+*
+* \return     TRUE if at least one message was recorded.
+********************************************************************************** */
+bool_t MsgLane_GetStats(msgLane_t lane, msgLaneStats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MSG_LANE_H */
@@ -0,0 +1,176 @@
+/*! *********************************************************************************
+* \file msg_ref.c
+*
+* Reference counts of host stack messages lent to the application. See msg_ref.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "msg_ref.h"
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef struct
+{
+    const void *pMsg;               /* NULL when the slot is free */
+    uint8_t     refs;
+} msgRefSlot_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static msgRefSlot_t  gaMsgRefSlot[MSG_REF_SLOTS];
+static msgRefStats_t gMsgRefStats;
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static msgRefSlot_t *MsgRef_Find(const void *pMsg);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Forget all references and clear the counters
+********************************************************************************** */
+void MsgRef_Init(void)
+{
+    uint8_t i;
+
+    for (i = 0u; i < MSG_REF_SLOTS; i++)
+    {
+        gaMsgRefSlot[i].pMsg = NULL;
+        gaMsgRefSlot[i].refs = 0u;
+    }
+
+    gMsgRefStats.retains = 0u;
+    gMsgRefStats.full = 0u;
+    gMsgRefStats.held = 0u;
+    gMsgRefStats.heldMax = 0u;
+}
+
+/*! *********************************************************************************
+* \brief     Take a reference on a message
+********************************************************************************** */
+bool_t MsgRef_Retain(const void *pMsg)
+{
+    msgRefSlot_t *pSlot;
+
+    if (pMsg == NULL)
+    {
+        return FALSE;
+    }
+
+    pSlot = MsgRef_Find(pMsg);
+    if (pSlot == NULL)
+    {
+        /* Not held yet, claim a free slot */
+        pSlot = MsgRef_Find(NULL);
+        if (pSlot == NULL)
+        {
+            gMsgRefStats.full++;
+            return FALSE;
+        }
+
+        pSlot->pMsg = pMsg;
+        pSlot->refs = 0u;
+        gMsgRefStats.held++;
+        if (gMsgRefStats.held > gMsgRefStats.heldMax)
+        {
+            gMsgRefStats.heldMax = gMsgRefStats.held;
+        }
+    }
+    else if (pSlot->refs == 0xFFu)
+    {
+        /* Saturated */
+        return FALSE;
+    }
+    else
+    {
+        /* Already held */
+    }
+
+    pSlot->refs++;
+    gMsgRefStats.retains++;
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     Drop a reference on a message
+********************************************************************************** */
+bool_t MsgRef_Release(const void *pMsg)
+{
+    msgRefSlot_t *pSlot;
+    bool_t last = FALSE;
+
+    if (pMsg == NULL)
+    {
+        return FALSE;
+    }
+
+    pSlot = MsgRef_Find(pMsg);
+    if (pSlot != NULL)
+    {
+        pSlot->refs--;
+        if (pSlot->refs == 0u)
+        {
+            pSlot->pMsg = NULL;
+            gMsgRefStats.held--;
+            last = TRUE;
+        }
+    }
+
+    return last;
+}
+
+/*! *********************************************************************************
+* \brief     Check whether a message has a reference
+********************************************************************************** */
+bool_t MsgRef_IsHeld(const void *pMsg)
+{
+    return ((pMsg != NULL) && (MsgRef_Find(pMsg) != NULL)) ? TRUE : FALSE;
+}
+
+/*! *********************************************************************************
+* \brief     Copy the counters
+********************************************************************************** */
+void MsgRef_GetStats(msgRefStats_t *pStats)
+{
+    if (pStats != NULL)
+    {
+        *pStats = gMsgRefStats;
+    }
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static msgRefSlot_t *MsgRef_Find(const void *pMsg)
+{
+    msgRefSlot_t *pSlot = NULL;
+    uint8_t i;
+
+    for (i = 0u; i < MSG_REF_SLOTS; i++)
+    {
+        if (gaMsgRefSlot[i].pMsg == pMsg)
+        {
+            pSlot = &gaMsgRefSlot[i];
+            break;
+        }
+    }
+
+    return pSlot;
+}
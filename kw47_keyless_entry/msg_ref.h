@@ -0,0 +1,97 @@
+/*! *********************************************************************************
+* \file msg_ref.h
+*
+* Reference counts of host stack messages lent to the application.
+*
+* app_conn.c frees every host stack message once its handler returns. A handler
+* that wants to keep reading the message after that, e.g. to hand an L2CAP packet
+* to a later application event without copying it, takes a reference with
+* MsgRef_Retain. The drain then leaves the message alone and whoever drops the last
+* reference with MsgRef_Release frees it.
+*
+* Only messages with a reference are tracked, in a table of MSG_REF_SLOTS entries.
+* When the table is full MsgRef_Retain fails and the caller copies what it needs,
+* so a burst of held messages can never pin more than MSG_REF_SLOTS buffers.
+*
+* The table is not locked: retain and release run on the application task only.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef MSG_REF_H
+#define MSG_REF_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Messages that can be held at the same time */
+#ifndef MSG_REF_SLOTS
+#define MSG_REF_SLOTS                   (4u)
+#endif
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+typedef struct
+{
+    uint32_t retains;               /* References taken */
+    uint32_t full;                  /* MsgRef_Retain calls refused, table full */
+    uint8_t  held;                  /* Messages held now */
+    uint8_t  heldMax;               /* Most messages held at once */
+} msgRefStats_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Forget all references and clear the counters
+********************************************************************************** */
+void MsgRef_Init(void);
+
+/*! *********************************************************************************
+* \brief     Take a reference on a message
+*
+* \param[in] pMsg       Message buffer.
+*
+* \return    FALSE if the message is not held yet and no slot is free.
+********************************************************************************** */
+bool_t MsgRef_Retain(const void *pMsg);
+
+/*! *********************************************************************************
+* \brief     Drop a reference on a message
+*
+* \param[in] pMsg       Message buffer.
+*
+* \return    TRUE if this was the last reference, the caller frees the message.
+********************************************************************************** */
+bool_t MsgRef_Release(const void *pMsg);
+
+/*! *********************************************************************************
+* \brief     Check whether a message has a reference
+*
+* \param[in] pMsg       Message buffer.
+********************************************************************************** */
+bool_t MsgRef_IsHeld(const void *pMsg);
+
+/*! *********************************************************************************
+* \brief     Copy the counters
+*
+* \param[out] pStats    Counters since init.
+********************************************************************************** */
+void MsgRef_GetStats(msgRefStats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MSG_REF_H */
@@ -0,0 +1,249 @@
+/*! *********************************************************************************
+* \file prox_cal.c
+*
+* Online per-device proximity calibration for ProxRssi. See prox_cal.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "prox_cal.h"
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+#define PROX_CAL_MAX_OFFSET_Q4          ((int16_t)(PROX_CAL_MAX_OFFSET_DB * 16))
+#define PROX_CAL_SESSIONS_MAX           (0xFFu)
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static int16_t ProxCal_Clamp(int32_t offsetQ4);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Record of a device without calibration (offset 0)
+********************************************************************************** */
+void ProxCal_RecordInit(proxCalRecord_t *pRec)
+{
+    if (pRec == NULL)
+    {
+        return;
+    }
+
+    pRec->version  = (uint8_t)PROX_CAL_VERSION;
+    pRec->sessions = 0u;
+    pRec->offsetQ4 = 0;
+}
+
+/*! *********************************************************************************
+* \brief     Offset to apply for a record, 0 for an empty or outdated one
+********************************************************************************** */
+int16_t ProxCal_OffsetQ4(const proxCalRecord_t *pRec)
+{
+    if ((pRec == NULL) || (pRec->version != (uint8_t)PROX_CAL_VERSION) || (pRec->sessions == 0u))
+    {
+        return 0;
+    }
+
+    /* A corrupted record must not move the thresholds further than learning can */
+    return ProxCal_Clamp((int32_t)pRec->offsetQ4);
+}
+
+/*! *********************************************************************************
+* \brief     Shift the enter/exit thresholds of pBase by the record's offset
+********************************************************************************** */
+void ProxCal_Apply(const proxCalRecord_t *pRec,
+                   const ProxRssi_ParamsType *pBase,
+                   ProxRssi_ParamsType *pOut)
+{
+    int16_t offsetQ4;
+
+    if ((pBase == NULL) || (pOut == NULL))
+    {
+        return;
+    }
+
+    offsetQ4 = ProxCal_OffsetQ4(pRec);
+    *pOut = *pBase;
+    pOut->enterNearQ4 = (int16_t)(pBase->enterNearQ4 + offsetQ4);
+
+    /* 0 = derived by ProxRssi_Init from enterNearQ4 - hystQ4, already shifted */
+    if (pBase->exitNearQ4 != 0)
+    {
+        pOut->exitNearQ4 = (int16_t)(pBase->exitNearQ4 + offsetQ4);
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Clear a session histogram
+********************************************************************************** */
+void ProxCal_HistReset(proxCalHist_t *pHist)
+{
+    uint32_t i;
+
+    if (pHist == NULL)
+    {
+        return;
+    }
+
+    for (i = 0u; i < PROX_CAL_HIST_BINS; i++)
+    {
+        pHist->bins[i] = 0u;
+    }
+    pHist->n = 0u;
+}
+
+/*! *********************************************************************************
+* \brief     Add a smoothed RSSI sample (Q4 dBm)
+********************************************************************************** */
+void ProxCal_HistAddQ4(proxCalHist_t *pHist, int16_t rssiQ4)
+{
+    int32_t bin;
+
+    if ((pHist == NULL) || (pHist->n == 0xFFFFu))
+    {
+        return;
+    }
+
+    /* Floor to whole dB (arithmetic shift rounds towards -inf) */
+    bin = ((int32_t)rssiQ4 >> 4) - (int32_t)PROX_CAL_HIST_MIN_DBM;
+    if (bin < 0)
+    {
+        bin = 0;
+    }
+    else if (bin >= (int32_t)PROX_CAL_HIST_BINS)
+    {
+        bin = (int32_t)PROX_CAL_HIST_BINS - 1;
+    }
+    else
+    {
+        /* In range */
+    }
+
+    pHist->bins[bin]++;
+    pHist->n++;
+}
+
+/*! *********************************************************************************
+* \brief     Add the smoothed samples ProxRssi currently holds (its feature window)
+********************************************************************************** */
+void ProxCal_HistAddWindow(proxCalHist_t *pHist, const ProxRssi_CtxType *pCtx)
+{
+    uint16_t idx;
+    uint16_t i;
+
+    if ((pHist == NULL) || (pCtx == NULL))
+    {
+        return;
+    }
+
+    idx = pCtx->smooth.head;
+    for (i = 0u; i < pCtx->smooth.count; i++)
+    {
+        idx = (idx == 0u) ? (uint16_t)(PROX_RSSI_SMOOTH_CAP - 1u) : (uint16_t)(idx - 1u);
+        ProxCal_HistAddQ4(pHist, pCtx->smooth.rssiQ4[idx]);
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Median of a histogram, centre of its bin
+********************************************************************************** */
+bool_t ProxCal_HistMedianQ4(const proxCalHist_t *pHist, int16_t *pMedianQ4)
+{
+    uint32_t half;
+    uint32_t acc = 0u;
+    uint32_t i;
+
+    if ((pHist == NULL) || (pMedianQ4 == NULL) || (pHist->n < PROX_CAL_MIN_SAMPLES))
+    {
+        return FALSE;
+    }
+
+    /* Lower median: first bin holding sample (n + 1) / 2 */
+    half = ((uint32_t)pHist->n + 1u) / 2u;
+    for (i = 0u; i < PROX_CAL_HIST_BINS; i++)
+    {
+        acc += pHist->bins[i];
+        if (acc >= half)
+        {
+            break;
+        }
+    }
+
+    *pMedianQ4 = (int16_t)((((int32_t)PROX_CAL_HIST_MIN_DBM + (int32_t)i) * 16) + 8);
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     Learn one successful session
+*
+* offset += (median - ref - offset) / w, w = min(sessions + 2, PROX_CAL_WEIGHT_MAX):
+* the reference counts as one session, so the first one moves the offset half way,
+* and from the seventh on each weighs 1/PROX_CAL_WEIGHT_MAX.
+********************************************************************************** */
+bool_t ProxCal_Learn(proxCalRecord_t *pRec, const proxCalHist_t *pHist)
+{
+    int16_t medianQ4;
+    int32_t sampleQ4;
+    int32_t w;
+    proxCalRecord_t prev;
+
+    if ((pRec == NULL) || (ProxCal_HistMedianQ4(pHist, &medianQ4) == FALSE))
+    {
+        return FALSE;
+    }
+
+    if (pRec->version != (uint8_t)PROX_CAL_VERSION)
+    {
+        ProxCal_RecordInit(pRec);
+    }
+    prev = *pRec;
+
+    sampleQ4 = (int32_t)ProxCal_Clamp((int32_t)medianQ4 - ((int32_t)PROX_CAL_REF_DBM * 16));
+    w = (int32_t)pRec->sessions + 2;
+    if (w > (int32_t)PROX_CAL_WEIGHT_MAX)
+    {
+        w = (int32_t)PROX_CAL_WEIGHT_MAX;
+    }
+
+    pRec->offsetQ4 = ProxCal_Clamp((int32_t)pRec->offsetQ4 + ((sampleQ4 - (int32_t)pRec->offsetQ4) / w));
+    if (pRec->sessions < PROX_CAL_SESSIONS_MAX)
+    {
+        pRec->sessions++;
+    }
+
+    return ((prev.offsetQ4 != pRec->offsetQ4) || (prev.sessions != pRec->sessions)) ? TRUE : FALSE;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static int16_t ProxCal_Clamp(int32_t offsetQ4)
+{
+    if (offsetQ4 > (int32_t)PROX_CAL_MAX_OFFSET_Q4)
+    {
+        offsetQ4 = (int32_t)PROX_CAL_MAX_OFFSET_Q4;
+    }
+    else if (offsetQ4 < -(int32_t)PROX_CAL_MAX_OFFSET_Q4)
+    {
+        offsetQ4 = -(int32_t)PROX_CAL_MAX_OFFSET_Q4;
+    }
+    else
+    {
+        /* In range */
+    }
+
+    return (int16_t)offsetQ4;
+}
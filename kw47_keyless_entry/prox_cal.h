@@ -0,0 +1,146 @@
+/*! *********************************************************************************
+* \file prox_cal.h
+*
+* Online per-device proximity calibration for ProxRssi.
+*
+* Phone models differ by 10 dB and more in transmit power and antenna gain, so
+* the enter/exit thresholds of prox_rssi_params.h, tuned on one reference phone,
+* either lag or over-trigger on others. Each bonded device keeps a small record
+* with its learned offset: after every successful unlock session (link encrypted
+* with the bond keys) the smoothed RSSI seen at handshake time is collected in a
+* 1 dB histogram, and the offset moves towards the difference between its median
+* and PROX_CAL_REF_DBM, the median of the reference phone.
+*
+* The record is persisted with the bonding data (App_NvmWriteProxCalData) and
+* applied by RssiIntegration_DeviceConnected, which shifts both thresholds by the
+* offset: a phone that reads 8 dB hot needs to be 8 dB closer than the raw
+* threshold suggests. The offset is clamped to PROX_CAL_MAX_OFFSET_DB, and a new
+* session moves it by at most 1/2 of the difference, so a single odd session
+* (phone in a bag at the door) cannot swing the thresholds.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef PROX_CAL_H
+#define PROX_CAL_H
+
+#include "EmbeddedTypes.h"
+#include "ProxRssi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Increment when proxCalRecord_t changes, older records are then ignored */
+#define PROX_CAL_VERSION                (1u)
+
+/* Median smoothed RSSI at handshake time of the phone the thresholds were tuned on */
+#ifndef PROX_CAL_REF_DBM
+#define PROX_CAL_REF_DBM                (-46)
+#endif
+
+/* Largest learned offset, either direction */
+#ifndef PROX_CAL_MAX_OFFSET_DB
+#define PROX_CAL_MAX_OFFSET_DB          (12)
+#endif
+
+/* Fewer samples at handshake time do not make a session */
+#ifndef PROX_CAL_MIN_SAMPLES
+#define PROX_CAL_MIN_SAMPLES            (6u)
+#endif
+
+/* The offset averages over about this many sessions (first session: 1/2) */
+#ifndef PROX_CAL_WEIGHT_MAX
+#define PROX_CAL_WEIGHT_MAX             (8u)
+#endif
+
+/* Histogram: 1 dB bins from PROX_CAL_HIST_MIN_DBM, outliers in the end bins */
+#define PROX_CAL_HIST_MIN_DBM           (-100)
+#define PROX_CAL_HIST_BINS              (80u)
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+/* Persisted per bonded device */
+typedef struct
+{
+    uint8_t version;        /* PROX_CAL_VERSION, anything else reads as "not calibrated" */
+    uint8_t sessions;       /* learned sessions, saturates at 255 */
+    int16_t offsetQ4;       /* device RSSI - reference RSSI, Q4 dB */
+} proxCalRecord_t;
+
+/* RSSI seen at handshake time during one session */
+typedef struct
+{
+    uint16_t bins[PROX_CAL_HIST_BINS];
+    uint16_t n;
+} proxCalHist_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Record of a device without calibration (offset 0)
+********************************************************************************** */
+void ProxCal_RecordInit(proxCalRecord_t *pRec);
+
+/*! *********************************************************************************
+* \brief     Offset to apply for a record, 0 for an empty or outdated one
+********************************************************************************** */
+int16_t ProxCal_OffsetQ4(const proxCalRecord_t *pRec);
+
+/*! *********************************************************************************
+* \brief     Shift the enter/exit thresholds of pBase by the record's offset
+*
+* \param[in]  pRec   Device record, NULL for none.
+* \param[in]  pBase  Reference parameters.
+* \param[out] pOut   Calibrated parameters (may be pBase).
+********************************************************************************** */
+void ProxCal_Apply(const proxCalRecord_t *pRec,
+                   const ProxRssi_ParamsType *pBase,
+                   ProxRssi_ParamsType *pOut);
+
+/*! *********************************************************************************
+* \brief     Clear a session histogram
+********************************************************************************** */
+void ProxCal_HistReset(proxCalHist_t *pHist);
+
+/*! *********************************************************************************
+* \brief     Add a smoothed RSSI sample (Q4 dBm)
+********************************************************************************** */
+void ProxCal_HistAddQ4(proxCalHist_t *pHist, int16_t rssiQ4);
+
+/*! *********************************************************************************
+* \brief     Add the smoothed samples ProxRssi currently holds (its feature window)
+********************************************************************************** */
+void ProxCal_HistAddWindow(proxCalHist_t *pHist, const ProxRssi_CtxType *pCtx);
+
+/*! *********************************************************************************
+* \brief     Median of a histogram, centre of its bin
+*
+* \return    FALSE if the histogram holds fewer than PROX_CAL_MIN_SAMPLES samples.
+********************************************************************************** */
+bool_t ProxCal_HistMedianQ4(const proxCalHist_t *pHist, int16_t *pMedianQ4);
+
+/*! *********************************************************************************
+* \brief     Learn one successful session
+*
+* \param[in,out] pRec   Device record, reinitialised when outdated.
+* \param[in]     pHist  RSSI seen at handshake time.
+*
+* \return    TRUE if the record changed and should be saved.
+********************************************************************************** */
+bool_t ProxCal_Learn(proxCalRecord_t *pRec, const proxCalHist_t *pHist);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROX_CAL_H */
@@ -0,0 +1,49 @@
+/*! *********************************************************************************
+* \file prox_rssi_params.h
+*
+* ProxRssi parameter set used by RssiIntegration_Init.
+*
+* tools/prox_tune.c writes a file with the same macros from a search over
+* labelled RSSI traces; replace this file with its output to adopt a tuned set.
+* Thresholds are in dBm / dB, converted to Q4 at init.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef PROX_RSSI_PARAMS_H
+#define PROX_RSSI_PARAMS_H
+
+/* Windows (ms) */
+#define PROX_PARAM_W_RAW_MS                 (2000u)
+#define PROX_PARAM_W_SPIKE_MS               (800u)
+#define PROX_PARAM_W_FEAT_MS                (2000u)
+
+/* Hampel spike rejection */
+#define PROX_PARAM_HAMPEL_K_Q4              (40u)       /* K = 2.5 (tighter spike rejection) */
+#define PROX_PARAM_MAD_EPS_Q4               (8u)        /* 0.5 dB floor */
+
+/* Thresholds */
+#define PROX_PARAM_ENTER_NEAR_DBM           (-50)
+#define PROX_PARAM_EXIT_NEAR_DBM            (-60)
+#define PROX_PARAM_HYST_DB                  (10)
+
+/* Stability gate */
+#define PROX_PARAM_PCT_TH_Q15               (13107u)    /* ~40% of smoothed samples above enter */
+#define PROX_PARAM_STD_TH_Q4                (128u)      /* 8 dB, realistic for BLE RSSI noise */
+#define PROX_PARAM_STABLE_MS                (2000u)
+#define PROX_PARAM_MIN_FEAT_SAMPLES         (6u)
+
+/* State machine */
+#define PROX_PARAM_EXIT_CONFIRM_MS          (1500u)
+#define PROX_PARAM_LOCKOUT_MS               (5000u)
+#define PROX_PARAM_MAX_REASONABLE_DT_MS     (2000u)
+
+/* Reconnect of a bonded peer within this time restores its filter history, 0 = cold start */
+#define PROX_PARAM_WARM_START_MS            (10000u)
+
+/* Alpha LUT: alpha_q15 = START + i * SLOPE / 1000, i = 0 .. LUT length - 1 */
+#define PROX_PARAM_ALPHA_START_Q15          (1638u)     /* 0.05 */
+#define PROX_PARAM_ALPHA_SLOPE_Q15          (8192u)     /* +0.25 per 1000 entries */
+
+#endif /* PROX_RSSI_PARAMS_H */
@@ -0,0 +1,31 @@
+/*! *********************************************************************************
+* \file prox_time.c
+*
+* Monotonic timebase shared by the RSSI proximity pipelines. See prox_time.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "prox_time.h"
+#include "fsl_component_timer_manager.h"
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Current time in ticks
+*
+* TM_GetTimestamp() counts microseconds in 64 bits; the shift and the truncation
+* are all that is needed, the wrap is handled by the comparison helpers.
+********************************************************************************** */
+uint32_t ProxTime_Now(void)
+{
+    return (uint32_t)(TM_GetTimestamp() >> PROX_TIME_TICK_SHIFT);
+}
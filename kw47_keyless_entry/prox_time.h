@@ -0,0 +1,102 @@
+/*! *********************************************************************************
+* \file prox_time.h
+*
+* Monotonic timebase shared by the RSSI proximity pipelines (ProxRssi through
+* rssi_integration.c, rssi_filter.c).
+*
+* ProxTime_Now() reads the 64-bit microsecond clock of the timer manager and
+* returns its low 32 bits in ticks of PROX_TIME_TICK_US microseconds: a shift,
+* no division. The default 8 us tick resolves per-step Channel Sounding RSSI,
+* wraps every 9.5 hours and keeps the 100 ms delta of a 10 Hz stream within two
+* varint bytes of the flight recorder log.
+*
+* The tick counter wraps, so timestamps are only compared through the helpers
+* below. They are exact for any two timestamps less than PROX_TIME_MAX_SPAN
+* ticks apart (4.7 hours at 8 us), which bounds every window and timer.
+* Configuration stays in milliseconds and is converted once with
+* PROX_TIME_MS_TO_TICKS; ProxTime_TicksToMs is for logs and displays.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef PROX_TIME_H
+#define PROX_TIME_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* One tick = 2^PROX_TIME_TICK_SHIFT us, 0..3 so that a millisecond is whole ticks */
+#ifndef PROX_TIME_TICK_SHIFT
+#define PROX_TIME_TICK_SHIFT            (3u)
+#endif
+
+#if (PROX_TIME_TICK_SHIFT > 3u)
+#error "PROX_TIME_TICK_SHIFT must be 0..3"
+#endif
+
+#define PROX_TIME_TICK_US               (1u << PROX_TIME_TICK_SHIFT)
+#define PROX_TIME_TICKS_PER_MS          (1000u >> PROX_TIME_TICK_SHIFT)
+
+/* Largest distance between two comparable timestamps */
+#define PROX_TIME_MAX_SPAN              (0x7FFFFFFFu)
+
+#define PROX_TIME_MS_TO_TICKS(ms)       ((uint32_t)(ms) * PROX_TIME_TICKS_PER_MS)
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Current time
+*
+* \return    Timer manager time in ticks of PROX_TIME_TICK_US, modulo 2^32.
+********************************************************************************** */
+uint32_t ProxTime_Now(void);
+
+/*! *********************************************************************************
+* \brief     Ticks from then to now, correct across the 32-bit wrap
+********************************************************************************** */
+static inline uint32_t ProxTime_Elapsed(uint32_t now, uint32_t then)
+{
+    return (uint32_t)(now - then);
+}
+
+/*! *********************************************************************************
+* \brief     TRUE if a is earlier than b
+********************************************************************************** */
+static inline bool_t ProxTime_Before(uint32_t a, uint32_t b)
+{
+    return ((int32_t)(uint32_t)(a - b) < 0) ? TRUE : FALSE;
+}
+
+/*! *********************************************************************************
+* \brief     TRUE if t is not older than win ticks before now
+*
+* Timestamps after now (a clock stepped back) count as inside the window.
+********************************************************************************** */
+static inline bool_t ProxTime_InWindow(uint32_t t, uint32_t now, uint32_t win)
+{
+    return (ProxTime_Before(t, (uint32_t)(now - win)) == TRUE) ? FALSE : TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     Whole milliseconds in a tick count (constant divisor)
+********************************************************************************** */
+static inline uint32_t ProxTime_TicksToMs(uint32_t ticks)
+{
+    return ticks / PROX_TIME_TICKS_PER_MS;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROX_TIME_H */
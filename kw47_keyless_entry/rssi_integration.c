@@ -17,8 +17,34 @@
 #include "fsl_component_timer_manager.h"
 #include "rssi_integration.h"
 #include "ProxRssi.h"
+#include "prox_rssi_params.h"
+#include "prox_time.h"
 #include "gap_interface.h"
 #include "fsl_format.h"
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+#include "flight_rec.h"
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+#include "prox_cal.h"
+#include "FunctionLib.h"
+#include "app_conn.h"
+#endif /* defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U) */
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+#include "conn_param.h"
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+#include "scan_prox.h"
+#include "FunctionLib.h"
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+#if defined(gAppScanAddrCache_d) && (gAppScanAddrCache_d == 1)
+#include "addr_cache.h"
+#endif /* defined(gAppScanAddrCache_d) && (gAppScanAddrCache_d == 1) */
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+#include "adv_sched.h"
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+#include "unlock_path.h"
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
 
 /* Shell output - defined in shell file */
 #if defined(gAppUseShellInApplication_d) && (gAppUseShellInApplication_d == 1)
@@ -39,11 +65,54 @@ extern SHELL_HANDLE_DEFINE(g_shellHandle);
 #define RSSI_ALPHA_LUT_LEN            (1001u)
 #define RSSI_PRINT_INTERVAL           (5u)
 
+/* Filter snapshots of recently disconnected bonded peers */
+#define RSSI_WARM_SLOTS               (2u)
+
+/* Parameter sets written by older tools/prox_tune.c builds lack it */
+#ifndef PROX_PARAM_WARM_START_MS
+#define PROX_PARAM_WARM_START_MS      (10000u)
+#endif
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+/* ProxRssi history of a bonded peer at its last disconnection */
+typedef struct
+{
+    uint8_t               nvmIndex;     /* bond, gInvalidNvmIndex_c = free */
+    bool_t                monitoring;   /* RSSI monitoring was running */
+    uint32_t              tDiscSec;     /* Disconnection, seconds: ticks wrap every 9.5 h */
+    ProxRssi_SnapshotType snap;
+} rssiWarmSlot_t;
+
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+/* NVM image of proxCalRecord_t, fixed size */
+typedef union
+{
+    proxCalRecord_t rec;
+    uint8_t         raw[gAppProxCalDataSize_c];
+} rssiProxCalBlob_t;
+
+App_NvmBondDataSizeCheck(rssiProxCalSizeCheck_t, proxCalRecord_t, gAppProxCalDataSize_c);
+#endif /* defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U) */
+
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+/* Identity address of a bond, as reported by the scan once the controller resolved it */
+typedef struct
+{
+    uint8_t            addrType;
+    bleDeviceAddress_t aAddress;
+    uint8_t            nvmIndex;
+} rssiScanPeer_t;
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+
 /************************************************************************************
 * Private variables
 ************************************************************************************/
 
 static ProxRssi_CtxType  gProxCtx;
+static ProxRssi_ParamsType gBaseParams;     /* prox_rssi_params.h, before calibration */
 static bool_t            gRssiIntegrationInitialized = FALSE;
 static bool_t            gRssiMonitoringActive       = FALSE;
 static uint8_t           gConnectedDeviceId          = 0xFFu;
@@ -57,13 +126,45 @@ static bool_t gRssiTimerInitialized = FALSE;
 /* Alpha LUT (pre-computed at init): linear ramp 0.10..0.80 over 0..1000 ms */
 static uint16 gAlphaLutQ15[RSSI_ALPHA_LUT_LEN];
 
+/* Warm start: snapshots by bond, and the one to restore at the next sample */
+static rssiWarmSlot_t  gWarmSlots[RSSI_WARM_SLOTS];
+static rssiWarmSlot_t *gpWarmPending = NULL;
+
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+/* Calibration of the connected device and RSSI seen at its unlocks this session */
+static proxCalRecord_t gProxCalRecord;
+static proxCalHist_t   gProxCalHist;
+static uint8_t         gProxCalNvmIndex   = gInvalidNvmIndex_c;
+static bool_t          gProxCalLinkSecure = FALSE;
+#endif /* defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U) */
+
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+/* Bonds known when the scan started */
+static rssiScanPeer_t gaScanPeers[gMaxBondedDevices_c];
+static uint8_t        gScanPeerCount = 0u;
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+
 /************************************************************************************
 * Private function prototypes
 ************************************************************************************/
 
 static void RssiIntegration_TimerCallback(void *pParam);
 static void RssiIntegration_BuildAlphaLut(void);
-static uint32_t RssiIntegration_GetTimestampMs(void);
+static void RssiIntegration_WarmConnect(uint8_t deviceId);
+static void RssiIntegration_WarmDisconnect(uint8_t deviceId);
+static void RssiIntegration_WarmRestore(uint32_t now);
+static uint32_t RssiIntegration_NowSec(void);
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+static void RssiIntegration_CalConnect(uint8_t deviceId);
+static void RssiIntegration_CalDisconnect(void);
+#endif /* defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U) */
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+static void RssiIntegration_ConnParamPoll(uint32_t now);
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+static uint8_t RssiIntegration_ScanResolve(uint8_t addrType, const uint8_t *pAddress);
+static void RssiIntegration_ScanHandover(uint8_t deviceId);
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
 
 /************************************************************************************
 * Public functions
@@ -91,28 +192,58 @@ void RssiIntegration_Init(void)
         ((uint8 *)&params)[i] = 0u;
     }
 
-    params.wRawMs    = 2000u;
-    params.wSpikeMs  = 800u;
-    params.wFeatMs   = 2000u;
+    /* Values from prox_rssi_params.h (hand tuned or tools/prox_tune.c) */
+    params.wRawMs    = PROX_PARAM_W_RAW_MS;
+    params.wSpikeMs  = PROX_PARAM_W_SPIKE_MS;
+    params.wFeatMs   = PROX_PARAM_W_FEAT_MS;
+
+    params.hampelKQ4 = PROX_PARAM_HAMPEL_K_Q4;
+    params.madEpsQ4  = PROX_PARAM_MAD_EPS_Q4;
+
+    params.enterNearQ4 = ProxRssi_DbmToQ4((sint8)PROX_PARAM_ENTER_NEAR_DBM);
+    params.exitNearQ4  = ProxRssi_DbmToQ4((sint8)PROX_PARAM_EXIT_NEAR_DBM);
+    params.hystQ4      = (uint16)ProxRssi_DbToQ4((sint16)PROX_PARAM_HYST_DB);
+
+    params.pctThQ15       = PROX_PARAM_PCT_TH_Q15;
+    params.stdThQ4        = PROX_PARAM_STD_TH_Q4;
+    params.stableMs       = PROX_PARAM_STABLE_MS;
+    params.minFeatSamples = PROX_PARAM_MIN_FEAT_SAMPLES;
 
-    params.hampelKQ4 = 40u;   /* K = 2.5 (tighter spike rejection) */
-    params.madEpsQ4  = 8u;    /* 0.5 dB floor */
+    params.exitConfirmMs    = PROX_PARAM_EXIT_CONFIRM_MS;
+    params.lockoutMs        = PROX_PARAM_LOCKOUT_MS;
+    params.maxReasonableDtMs = PROX_PARAM_MAX_REASONABLE_DT_MS;
 
-    params.enterNearQ4 = ProxRssi_DbmToQ4((sint8)-50);
-    params.exitNearQ4  = ProxRssi_DbmToQ4((sint8)-60);
-    params.hystQ4      = (uint16)ProxRssi_DbToQ4((sint16)10);
+    /* Samples are stamped with ProxTime_Now() */
+    params.ticksPerMs = (uint16)PROX_TIME_TICKS_PER_MS;
 
-    params.pctThQ15       = 13107u;  /* ~40% of smoothed samples above enter */
-    params.stdThQ4        = 128u;    /* 8 dB — realistic for BLE RSSI noise */
-    params.stableMs       = 2000u;
-    params.minFeatSamples = 6u;
+    /* Reference thresholds, shifted per device on connection */
+    gBaseParams = params;
 
-    params.exitConfirmMs    = 1500u;
-    params.lockoutMs        = 5000u;
-    params.maxReasonableDtMs = 2000u;
+    for (i = 0u; i < RSSI_WARM_SLOTS; i++)
+    {
+        gWarmSlots[i].nvmIndex = gInvalidNvmIndex_c;
+    }
+    gpWarmPending = NULL;
 
     (void)ProxRssi_Init(&gProxCtx, &params, gAlphaLutQ15, RSSI_ALPHA_LUT_LEN);
 
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+    ScanProx_Init(&params, gAlphaLutQ15, RSSI_ALPHA_LUT_LEN);
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+#if defined(gAppScanAddrCache_d) && (gAppScanAddrCache_d == 1)
+    AddrCache_Init();
+#endif /* defined(gAppScanAddrCache_d) && (gAppScanAddrCache_d == 1) */
+
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+    ConnParam_Init();
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+    FlightRec_Init();
+    FlightRec_LogReset(ProxTime_Now(), &gProxCtx.p,
+                       gProxCtx.alphaQ15, PROX_RSSI_ALPHA_LUT_SIZE);
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
+
     gUnlockPending = FALSE;
     gSampleCount   = 0u;
     gRssiIntegrationInitialized = TRUE;
@@ -134,8 +265,30 @@ void RssiIntegration_DeviceConnected(uint8_t deviceId)
     gUnlockPending     = FALSE;
     gSampleCount       = 0u;
 
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+    /* Thresholds of this device; re-initialising also resets the filter */
+    RssiIntegration_CalConnect(deviceId);
+#else
     /* Reset filter state for new connection */
     (void)ProxRssi_ForceFar(&gProxCtx);
+#endif /* defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U) */
+
+    /* History of a recent link of this peer is restored at its first sample */
+    RssiIntegration_WarmConnect(deviceId);
+
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+    /* Unless the scan followed its approach until now */
+    RssiIntegration_ScanHandover(deviceId);
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+    {
+        uint32_t now = ProxTime_Now();
+
+        FlightRec_LogEvent(now, FLIGHT_REC_EVT_CONNECT, deviceId);
+        FlightRec_LogReset(now, &gProxCtx.p, gProxCtx.alphaQ15, PROX_RSSI_ALPHA_LUT_SIZE);
+    }
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
 
     RSSI_DBG("Device connected");
 }
@@ -147,6 +300,23 @@ void RssiIntegration_DeviceDisconnected(uint8_t deviceId)
 {
     (void)deviceId;
 
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+    /* Learn from this session before the filter is reset */
+    if (deviceId == gConnectedDeviceId)
+    {
+        RssiIntegration_CalDisconnect();
+    }
+#endif /* defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U) */
+
+    /* Keep the filter history for a quick reconnection */
+    if (deviceId == gConnectedDeviceId)
+    {
+        RssiIntegration_WarmDisconnect(deviceId);
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+        ConnParam_Disconnected(ProxTime_Now());
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+    }
+
     gConnectedDeviceId = 0xFFu;
     gUnlockPending     = FALSE;
     gRssiMonitoringActive = FALSE;
@@ -154,6 +324,18 @@ void RssiIntegration_DeviceDisconnected(uint8_t deviceId)
     /* Reset filter */
     (void)ProxRssi_ForceFar(&gProxCtx);
 
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+    {
+        uint32_t now = ProxTime_Now();
+
+        FlightRec_LogEvent(now, FLIGHT_REC_EVT_DISCONNECT, deviceId);
+        FlightRec_LogReset(now, &gProxCtx.p, gProxCtx.alphaQ15, PROX_RSSI_ALPHA_LUT_SIZE);
+
+        /* Only flush point besides the shell: keeps flash wear proportional to sessions */
+        (void)FlightRec_Flush();
+    }
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
+
     if (gRssiTimerInitialized == TRUE)
     {
         (void)TM_Stop((timer_handle_t)gRssiTimerHandle);
@@ -162,6 +344,214 @@ void RssiIntegration_DeviceDisconnected(uint8_t deviceId)
     RSSI_DBG("Device disconnected");
 }
 
+/*! *********************************************************************************
+* \brief     Handle link encrypted event
+*
+* Encryption with the bond keys authenticates the peer: only unlocks on such a
+* link feed the per-device calibration.
+********************************************************************************** */
+void RssiIntegration_LinkEncrypted(uint8_t deviceId)
+{
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+    bool_t isBonded = FALSE;
+    uint8_t nvmIndex = gInvalidNvmIndex_c;
+
+    if (deviceId != gConnectedDeviceId)
+    {
+        return;
+    }
+
+    gProxCalLinkSecure = TRUE;
+
+    /* Bonded by the pairing of this connection: start from the reference */
+    if (gProxCalNvmIndex == gInvalidNvmIndex_c)
+    {
+        (void)Gap_CheckIfBonded(deviceId, &isBonded, &nvmIndex);
+        if (isBonded == TRUE)
+        {
+            gProxCalNvmIndex = nvmIndex;
+            ProxCal_RecordInit(&gProxCalRecord);
+        }
+    }
+#else
+    (void)deviceId;
+#endif /* defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U) */
+}
+
+/*! *********************************************************************************
+* \brief     Handle the connection parameters of a new link
+*
+* They make the active profile of the connection parameter manager.
+********************************************************************************** */
+void RssiIntegration_ConnParamsEstablished(uint8_t deviceId, uint16_t interval, uint16_t latency, uint16_t timeout)
+{
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+    if (deviceId == gConnectedDeviceId)
+    {
+        ConnParam_Connected(interval, latency, timeout, ProxTime_Now());
+    }
+#else
+    (void)deviceId;
+    (void)interval;
+    (void)latency;
+    (void)timeout;
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+}
+
+/*! *********************************************************************************
+* \brief     Handle a connection parameter update, requested or not
+********************************************************************************** */
+void RssiIntegration_ConnParamsUpdated(uint8_t deviceId, bool_t success, uint16_t interval, uint16_t latency)
+{
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+    uint32_t now = ProxTime_Now();
+
+    if (deviceId == gConnectedDeviceId)
+    {
+        ConnParam_UpdateComplete(success, interval, latency, now);
+        RssiIntegration_ConnParamPoll(now);
+    }
+#else
+    (void)deviceId;
+    (void)success;
+    (void)interval;
+    (void)latency;
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+}
+
+/*! *********************************************************************************
+* \brief     Handle a subrate change, requested or not
+********************************************************************************** */
+void RssiIntegration_SubrateChanged(uint8_t deviceId, bool_t success, uint16_t factor)
+{
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+    uint32_t now = ProxTime_Now();
+
+    if (deviceId == gConnectedDeviceId)
+    {
+        ConnParam_SubrateComplete(success, factor, now);
+        RssiIntegration_ConnParamPoll(now);
+    }
+#else
+    (void)deviceId;
+    (void)success;
+    (void)factor;
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+}
+
+/*! *********************************************************************************
+* \brief     Handle the start and the end of Channel Sounding procedures
+*
+* CS procedures are spaced in connection events of the interval the link was
+* established with: the link is brought back to it before they start.
+********************************************************************************** */
+void RssiIntegration_CsActive(uint8_t deviceId, bool_t active)
+{
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+    uint32_t now = ProxTime_Now();
+
+    if (deviceId == gConnectedDeviceId)
+    {
+        ConnParam_SetDemand(CONN_PARAM_DEMAND_CS, active, now);
+        RssiIntegration_ConnParamPoll(now);
+    }
+#else
+    (void)deviceId;
+    (void)active;
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+}
+
+/*! *********************************************************************************
+* \brief     Handle the start of the scan for bonded peers
+*
+* Loads the identity addresses of the bonds, the scan reports them once the
+* controller resolved their private address.
+********************************************************************************** */
+void RssiIntegration_ScanStarted(void)
+{
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+    uint8_t aIrk[gcSmpIrkSize_c];
+    bleDeviceAddress_t address;
+    gapSmpKeys_t keys;
+    gapSmpKeyFlags_t keyFlags;
+    bool_t leSc;
+    bool_t auth;
+    uint8_t i;
+
+    if (gRssiIntegrationInitialized != TRUE)
+    {
+        RssiIntegration_Init();
+    }
+
+    FLib_MemSet(&keys, 0, sizeof(keys));
+    keys.aIrk = aIrk;
+    keys.aAddress = address;
+
+    gScanPeerCount = 0u;
+    for (i = 0u; i < (uint8_t)gMaxBondedDevices_c; i++)
+    {
+        if (Gap_LoadKeys(i, &keys, &keyFlags, &leSc, &auth) == gBleSuccess_c)
+        {
+            gaScanPeers[gScanPeerCount].addrType = keys.addressType;
+            FLib_MemCpy(gaScanPeers[gScanPeerCount].aAddress, address, gcBleDeviceAddressSize_c);
+            gaScanPeers[gScanPeerCount].nvmIndex = i;
+            gScanPeerCount++;
+        }
+    }
+
+#if defined(gAppScanAddrCache_d) && (gAppScanAddrCache_d == 1)
+    /* Bonds may have changed since the last scan */
+    AddrCache_Flush();
+#endif /* defined(gAppScanAddrCache_d) && (gAppScanAddrCache_d == 1) */
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+}
+
+/*! *********************************************************************************
+* \brief     Handle an advertising report seen by the scan
+*
+* Reports of bonded peers follow their approach before the connection.
+*
+* \return    TRUE if the report comes from a bonded peer near the car (not FAR).
+********************************************************************************** */
+bool_t RssiIntegration_AdvReport(uint8_t addrType, const uint8_t *pAddress, int8_t rssi)
+{
+    bool_t nearby = FALSE;
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+    ProxRssi_EventType ev;
+    uint8_t nvmIndex;
+
+    /* The link follows the connected peer */
+    if ((gRssiIntegrationInitialized != TRUE) || (gConnectedDeviceId != 0xFFu) || (pAddress == NULL))
+    {
+        return FALSE;
+    }
+
+    nvmIndex = RssiIntegration_ScanResolve(addrType, pAddress);
+    if (nvmIndex != gInvalidNvmIndex_c)
+    {
+        ev = ScanProx_Report(nvmIndex, rssi, ProxTime_Now());
+        if (ev == PROX_RSSI_EVT_CANDIDATE_STARTED)
+        {
+            RSSI_PRINT("[SCAN] Bonded peer approaching\r\n");
+        }
+        else if (ev == PROX_RSSI_EVT_EXIT_TO_FAR)
+        {
+            RSSI_PRINT("[SCAN] Bonded peer left\r\n");
+        }
+        else
+        {
+            /* No change */
+        }
+        nearby = (ScanProx_GetState(nvmIndex) != PROX_RSSI_ST_FAR) ? TRUE : FALSE;
+    }
+#else
+    (void)addrType;
+    (void)pAddress;
+    (void)rssi;
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+    return nearby;
+}
+
 /*! *********************************************************************************
 * \brief     Update RSSI value from connected device
 ********************************************************************************** */
@@ -169,7 +559,7 @@ void RssiIntegration_UpdateRssi(uint8_t deviceId, int8_t rssi)
 {
     ProxRssi_EventType ev   = PROX_RSSI_EVT_NONE;
     ProxRssi_FeaturesType feat;
-    uint32_t nowMs;
+    uint32_t now;
 
     (void)deviceId;
 
@@ -186,15 +576,84 @@ void RssiIntegration_UpdateRssi(uint8_t deviceId, int8_t rssi)
         return;
     }
 
-    nowMs = RssiIntegration_GetTimestampMs();
+    /* One read of the 64-bit clock, a shift and no division per sample */
+    now = ProxTime_Now();
+
+    if (gpWarmPending != NULL)
+    {
+        RssiIntegration_WarmRestore(now);
+    }
+
+    (void)ProxRssi_PushRaw(&gProxCtx, (uint32)now, (sint8)rssi);
+
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+    /* Reads stay at 100 ms so that FAR fills its windows, but in the idle profile
+       the controller refreshes the RSSI only at the connection events it listens
+       to (600 ms apart) and most reads repeat the last value. Those may start a
+       candidate, which brings the active profile back, but the stable hold only
+       counts from there */
+    if (gProxCtx.st == PROX_RSSI_ST_CANDIDATE)
+    {
+        connParamStats_t connStats;
+
+        ConnParam_GetStats(now, &connStats);
+        if (connStats.profile == connParamProfileIdle_c)
+        {
+            gProxCtx.tCandidateStartMs = (uint32)now;
+        }
+    }
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
 
-    (void)ProxRssi_PushRaw(&gProxCtx, (uint32)nowMs, (sint8)rssi);
-    (void)ProxRssi_MainFunction(&gProxCtx, (uint32)nowMs, &ev, &feat);
+    (void)ProxRssi_MainFunction(&gProxCtx, (uint32)now, &ev, &feat);
+
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+    /* Connect to unlock path: first sample, then the proximity events */
+    {
+        const uint32_t nowMs = (uint32_t)(TM_GetTimestamp() / 1000u);
+
+        UnlockPath_Mark(deviceId, unlockPathFirstRssi_c, nowMs);
+        if (ev == PROX_RSSI_EVT_CANDIDATE_STARTED)
+        {
+            UnlockPath_Mark(deviceId, unlockPathCandidate_c, nowMs);
+        }
+        else if (ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED)
+        {
+            UnlockPath_Mark(deviceId, unlockPathUnlock_c, nowMs);
+        }
+        else
+        {
+            /* No milestone */
+        }
+    }
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+    FlightRec_LogStep(now, rssi, ev, &feat, gProxCtx.emaQ4, gProxCtx.st);
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
+
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+    /* Fast link from candidate until the lockout is over, long intervals while FAR */
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, (gProxCtx.st != PROX_RSSI_ST_FAR) ? TRUE : FALSE, now);
+    RssiIntegration_ConnParamPoll(now);
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
 
     /* Track unlock */
     if (ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED)
     {
         gUnlockPending = TRUE;
+
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+        /* Car in use: advertising stays at the ACTIVE profile for a while */
+        AdvSched_Unlocked((uint32_t)(TM_GetTimestamp() / 1000000u));
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
+
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+        /* Handshake time: keep the smoothed window of an authenticated bonded peer */
+        if ((gProxCalLinkSecure == TRUE) && (gProxCalNvmIndex != gInvalidNvmIndex_c))
+        {
+            ProxCal_HistAddWindow(&gProxCalHist, &gProxCtx);
+        }
+#endif /* defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U) */
     }
 
     /* Periodic diagnostic output */
@@ -360,6 +819,11 @@ void RssiIntegration_StopMonitoring(void)
         (void)TM_Stop((timer_handle_t)gRssiTimerHandle);
     }
 
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+    /* No more samples to hold the active profile for */
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, FALSE, ProxTime_Now());
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+
     RSSI_PRINT("\r\n[RSSI] Monitoring STOPPED\r\n");
 }
 
@@ -377,19 +841,12 @@ static void RssiIntegration_BuildAlphaLut(void)
     for (i = 0u; i < RSSI_ALPHA_LUT_LEN; i++)
     {
         /* alpha_q15 = 1638 + i * (9830 - 1638) / 1000 */
-        uint32 alpha = 1638u + ((i * 8192u) / 1000u);
+        uint32 alpha = PROX_PARAM_ALPHA_START_Q15 + ((i * PROX_PARAM_ALPHA_SLOPE_Q15) / 1000u);
         if (alpha > 32767u) { alpha = 32767u; }
         gAlphaLutQ15[i] = (uint16)alpha;
     }
 }
 
-static uint32_t RssiIntegration_GetTimestampMs(void)
-{
-    /* TM_GetTimestamp() returns MICROSECONDS (HAL uses COUNT_TO_USEC).
-     * ProxRssi expects milliseconds for all window/timer parameters. */
-    return (uint32_t)(TM_GetTimestamp() / 1000u);
-}
-
 static void RssiIntegration_TimerCallback(void *pParam)
 {
     (void)pParam;
@@ -399,3 +856,299 @@ static void RssiIntegration_TimerCallback(void *pParam)
         (void)Gap_ReadRssi(gConnectedDeviceId);
     }
 }
+
+static void RssiIntegration_WarmConnect(uint8_t deviceId)
+{
+    bool_t isBonded = FALSE;
+    uint8_t nvmIndex = gInvalidNvmIndex_c;
+    uint32_t i;
+
+    gpWarmPending = NULL;
+
+    if (PROX_PARAM_WARM_START_MS == 0u)
+    {
+        return;
+    }
+
+    /* Device ids are reused across connections, the bond identifies the peer */
+    (void)Gap_CheckIfBonded(deviceId, &isBonded, &nvmIndex);
+    if (isBonded != TRUE)
+    {
+        return;
+    }
+
+    for (i = 0u; i < RSSI_WARM_SLOTS; i++)
+    {
+        if (gWarmSlots[i].nvmIndex != nvmIndex)
+        {
+            continue;
+        }
+
+        /* Seconds first: the tick age is only meaningful within half the wrap */
+        if (((RssiIntegration_NowSec() - gWarmSlots[i].tDiscSec) > ((PROX_PARAM_WARM_START_MS / 1000u) + 1u)) ||
+            (ProxTime_Elapsed(ProxTime_Now(), gWarmSlots[i].snap.tLastMs) >=
+             PROX_TIME_MS_TO_TICKS(PROX_PARAM_WARM_START_MS)))
+        {
+            /* Too old, cold start */
+            gWarmSlots[i].nvmIndex = gInvalidNvmIndex_c;
+        }
+        else
+        {
+            gpWarmPending = &gWarmSlots[i];
+
+            /* The link dropped while monitoring: resume it */
+            if (gWarmSlots[i].monitoring == TRUE)
+            {
+                RssiIntegration_StartMonitoring();
+            }
+        }
+        break;
+    }
+}
+
+static void RssiIntegration_WarmDisconnect(uint8_t deviceId)
+{
+    bool_t isBonded = FALSE;
+    uint8_t nvmIndex = gInvalidNvmIndex_c;
+    rssiWarmSlot_t *pSlot = NULL;
+    uint32_t i;
+
+    gpWarmPending = NULL;
+
+    if ((PROX_PARAM_WARM_START_MS == 0u) || (gProxCtx.emaValid != TRUE))
+    {
+        return;
+    }
+
+    (void)Gap_CheckIfBonded(deviceId, &isBonded, &nvmIndex);
+    if (isBonded != TRUE)
+    {
+        return;
+    }
+
+    /* Same peer, else a free slot, else the oldest snapshot */
+    for (i = 0u; i < RSSI_WARM_SLOTS; i++)
+    {
+        if (gWarmSlots[i].nvmIndex == nvmIndex)
+        {
+            pSlot = &gWarmSlots[i];
+            break;
+        }
+        if ((pSlot == NULL) || (gWarmSlots[i].nvmIndex == gInvalidNvmIndex_c) ||
+            ((pSlot->nvmIndex != gInvalidNvmIndex_c) && (gWarmSlots[i].tDiscSec < pSlot->tDiscSec)))
+        {
+            pSlot = &gWarmSlots[i];
+        }
+    }
+
+    if (ProxRssi_Snapshot(&gProxCtx, &pSlot->snap) == E_OK)
+    {
+        pSlot->nvmIndex   = nvmIndex;
+        pSlot->monitoring = gRssiMonitoringActive;
+        pSlot->tDiscSec   = RssiIntegration_NowSec();
+    }
+}
+
+/* Coarse time of the warm slots, from the 64-bit timer manager timestamp */
+static uint32_t RssiIntegration_NowSec(void)
+{
+    return (uint32_t)(TM_GetTimestamp() / 1000000u);
+}
+
+static void RssiIntegration_WarmRestore(uint32_t now)
+{
+    rssiWarmSlot_t *pSlot = gpWarmPending;
+
+    gpWarmPending = NULL;
+
+    /* Cold (already reset) when the snapshot is too old */
+    if (ProxRssi_Restore(&gProxCtx, now, &pSlot->snap, PROX_PARAM_WARM_START_MS) == E_OK)
+    {
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+        FlightRec_LogEvent(now, FLIGHT_REC_EVT_WARM_START, (uint8_t)gProxCtx.smooth.count);
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
+        RSSI_PRINT("[RSSI] Warm start\r\n");
+    }
+
+    /* Used once */
+    pSlot->nvmIndex = gInvalidNvmIndex_c;
+}
+
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+static void RssiIntegration_CalConnect(uint8_t deviceId)
+{
+    ProxRssi_ParamsType params;
+    rssiProxCalBlob_t blob;
+    bool_t isBonded = FALSE;
+
+    gProxCalNvmIndex   = gInvalidNvmIndex_c;
+    gProxCalLinkSecure = FALSE;
+    ProxCal_HistReset(&gProxCalHist);
+    ProxCal_RecordInit(&gProxCalRecord);
+
+    (void)Gap_CheckIfBonded(deviceId, &isBonded, &gProxCalNvmIndex);
+    if (isBonded != TRUE)
+    {
+        gProxCalNvmIndex = gInvalidNvmIndex_c;
+    }
+    else if (App_NvmReadProxCalData(gProxCalNvmIndex, &blob) == gBleSuccess_c)
+    {
+        /* An empty or outdated entry applies no offset and is relearned */
+        gProxCalRecord = blob.rec;
+    }
+    else
+    {
+        /* Nothing stored yet */
+    }
+
+    ProxCal_Apply(&gProxCalRecord, &gBaseParams, &params);
+    (void)ProxRssi_Init(&gProxCtx, &params, gAlphaLutQ15, RSSI_ALPHA_LUT_LEN);
+}
+
+static void RssiIntegration_CalDisconnect(void)
+{
+    rssiProxCalBlob_t blob;
+
+    if ((gProxCalNvmIndex != gInvalidNvmIndex_c) &&
+        (ProxCal_Learn(&gProxCalRecord, &gProxCalHist) == TRUE))
+    {
+        FLib_MemSet(&blob, 0, sizeof(blob));
+        blob.rec = gProxCalRecord;
+        (void)App_NvmWriteProxCalData(gProxCalNvmIndex, &blob);
+    }
+
+    gProxCalNvmIndex   = gInvalidNvmIndex_c;
+    gProxCalLinkSecure = FALSE;
+    ProxCal_HistReset(&gProxCalHist);
+}
+#endif /* defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U) */
+
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+static void RssiIntegration_ConnParamPoll(uint32_t now)
+{
+    connParamRequest_t req;
+    bleResult_t result;
+
+    switch (ConnParam_Poll(now, &req))
+    {
+        case connParamActionUpdate_c:
+        {
+            result = Gap_UpdateConnectionParameters(gConnectedDeviceId,
+                                                    req.intervalMin, req.intervalMax,
+                                                    req.latency, req.timeout,
+                                                    gGapConnEventLengthMin_d, gGapConnEventLengthMax_d);
+            if (result != gBleSuccess_c)
+            {
+                ConnParam_SendFailed(now);
+            }
+            else
+            {
+                RSSI_PRINT("[CONN] Interval max ");
+                RSSI_PRINT((const char*)FORMAT_Dec2Str((uint32_t)req.intervalMax));
+                RSSI_PRINT(" latency ");
+                RSSI_PRINT((const char*)FORMAT_Dec2Str((uint32_t)req.latency));
+                RSSI_PRINT(" requested\r\n");
+            }
+        }
+        break;
+
+        case connParamActionSubrate_c:
+        {
+            gapConnectionSubrateParameters_t subrate;
+
+            subrate.subrateMin = req.subrateMin;
+            subrate.subrateMax = req.subrateMax;
+            subrate.latencyMax = req.latency;
+            subrate.continuationNumber = req.continuation;
+            subrate.supervisionTimeout = req.timeout;
+
+            result = Gap_ConnectionSubrateRequest(gConnectedDeviceId, &subrate);
+            if (result != gBleSuccess_c)
+            {
+                ConnParam_SendFailed(now);
+            }
+            else
+            {
+                RSSI_PRINT("[CONN] Subrate max ");
+                RSSI_PRINT((const char*)FORMAT_Dec2Str((uint32_t)req.subrateMax));
+                RSSI_PRINT(" requested\r\n");
+            }
+        }
+        break;
+
+        default:
+        {
+            ; /* Nothing to change */
+        }
+        break;
+    }
+}
+
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+/* Bond NVM index of an advertising address, gInvalidNvmIndex_c if none */
+static uint8_t RssiIntegration_ScanResolve(uint8_t addrType, const uint8_t *pAddress)
+{
+    uint8_t nvmIndex = gInvalidNvmIndex_c;
+    uint8_t i;
+
+#if defined(gAppScanAddrCache_d) && (gAppScanAddrCache_d == 1)
+    if (AddrCache_Lookup(addrType, pAddress, &nvmIndex) == TRUE)
+    {
+        return nvmIndex;
+    }
+#endif /* defined(gAppScanAddrCache_d) && (gAppScanAddrCache_d == 1) */
+
+    for (i = 0u; i < gScanPeerCount; i++)
+    {
+        if ((gaScanPeers[i].addrType == addrType) &&
+            (FLib_MemCmp(gaScanPeers[i].aAddress, pAddress, gcBleDeviceAddressSize_c) == TRUE))
+        {
+            nvmIndex = gaScanPeers[i].nvmIndex;
+            break;
+        }
+    }
+
+#if defined(gAppScanAddrCache_d) && (gAppScanAddrCache_d == 1)
+    /* The accept list only lets bonds through, resolved by the controller to their identity */
+    if (nvmIndex != gInvalidNvmIndex_c)
+    {
+        AddrCache_Insert(addrType, pAddress, nvmIndex);
+    }
+#endif /* defined(gAppScanAddrCache_d) && (gAppScanAddrCache_d == 1) */
+
+    return nvmIndex;
+}
+
+static void RssiIntegration_ScanHandover(uint8_t deviceId)
+{
+    bool_t isBonded = FALSE;
+    uint8_t nvmIndex = gInvalidNvmIndex_c;
+
+    (void)Gap_CheckIfBonded(deviceId, &isBonded, &nvmIndex);
+    if (isBonded != TRUE)
+    {
+        return;
+    }
+
+    /* Into the context set up for this device (calibrated thresholds) */
+    if (ScanProx_Handover(nvmIndex, ProxTime_Now(), &gProxCtx) == TRUE)
+    {
+        /* Newer than any snapshot of a previous link */
+        if (gpWarmPending != NULL)
+        {
+            gpWarmPending->nvmIndex = gInvalidNvmIndex_c;
+            gpWarmPending = NULL;
+        }
+
+        RSSI_PRINT("[RSSI] Warm start from scan\r\n");
+
+        /* Approach in progress: sample the link for the unlock */
+        if ((gProxCtx.st != PROX_RSSI_ST_FAR) && (gRssiMonitoringActive != TRUE))
+        {
+            RssiIntegration_StartMonitoring();
+        }
+    }
+}
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
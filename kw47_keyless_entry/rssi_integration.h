@@ -54,6 +54,43 @@ void RssiIntegration_DeviceConnected(uint8_t deviceId);
 ********************************************************************************** */
 void RssiIntegration_DeviceDisconnected(uint8_t deviceId);
 
+/*! *********************************************************************************
+* \brief     Handle link encrypted event (bonded peer authenticated)
+********************************************************************************** */
+void RssiIntegration_LinkEncrypted(uint8_t deviceId);
+
+/*! *********************************************************************************
+* \brief     Handle the connection parameters a link was established with
+********************************************************************************** */
+void RssiIntegration_ConnParamsEstablished(uint8_t deviceId, uint16_t interval, uint16_t latency, uint16_t timeout);
+
+/*! *********************************************************************************
+* \brief     Handle a completed connection parameter update
+********************************************************************************** */
+void RssiIntegration_ConnParamsUpdated(uint8_t deviceId, bool_t success, uint16_t interval, uint16_t latency);
+
+/*! *********************************************************************************
+* \brief     Handle a completed connection subrate change
+********************************************************************************** */
+void RssiIntegration_SubrateChanged(uint8_t deviceId, bool_t success, uint16_t factor);
+
+/*! *********************************************************************************
+* \brief     Handle the start (TRUE) and end (FALSE) of Channel Sounding procedures
+********************************************************************************** */
+void RssiIntegration_CsActive(uint8_t deviceId, bool_t active);
+
+/*! *********************************************************************************
+* \brief     Handle the start of the scan for bonded peers (bonds may have changed)
+********************************************************************************** */
+void RssiIntegration_ScanStarted(void);
+
+/*! *********************************************************************************
+* \brief     Handle an advertising report (address as reported, resolved if bonded)
+*
+* \return    TRUE if the report comes from a bonded peer near the car.
+********************************************************************************** */
+bool_t RssiIntegration_AdvReport(uint8_t addrType, const uint8_t *pAddress, int8_t rssi);
+
 /*! *********************************************************************************
 * \brief     Update RSSI value from connected device
 ********************************************************************************** */
@@ -0,0 +1,261 @@
+/*! *********************************************************************************
+* \file scan_prox.c
+*
+* Proximity of bonded peers before the connection. See scan_prox.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "scan_prox.h"
+#include "prox_time.h"
+
+/************************************************************************************
+* Private macros
+************************************************************************************/
+
+#define SCAN_PROX_FREE              (0xFFu)
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef struct
+{
+    uint8_t          nvmIndex;      /* SCAN_PROX_FREE when the instance is free */
+    uint32_t         lastReport;
+    ProxRssi_CtxType ctx;
+} scanProxPeer_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static scanProxPeer_t        gaScanProxPeer[SCAN_PROX_PEERS];
+static ProxRssi_ParamsType   gScanProxParams;
+static const uint16_t       *gpScanProxLut;
+static uint32_t              gScanProxLutLen;
+static scanProxStats_t       gScanProxStats;
+
+/* Kept off the stack, the caller's task may be small */
+static ProxRssi_SnapshotType gScanProxSnap;
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static scanProxPeer_t *ScanProx_Find(uint8_t nvmIndex);
+static scanProxPeer_t *ScanProx_Claim(uint8_t nvmIndex);
+static void ScanProx_Count(void);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Forget all peers and clear the counters
+********************************************************************************** */
+void ScanProx_Init(const ProxRssi_ParamsType *pParams, const uint16_t *pAlphaLut, uint32_t alphaLutLen)
+{
+    uint8_t i;
+
+    for (i = 0u; i < SCAN_PROX_PEERS; i++)
+    {
+        gaScanProxPeer[i].nvmIndex = SCAN_PROX_FREE;
+    }
+
+    if (pParams != NULL)
+    {
+        gScanProxParams = *pParams;
+
+        /* No unlock without the link: the hold grows until handed over */
+        gScanProxParams.stableMs = SCAN_PROX_HOLD_MS;
+    }
+    gpScanProxLut = pAlphaLut;
+    gScanProxLutLen = alphaLutLen;
+
+    gScanProxStats.reports = 0u;
+    gScanProxStats.invalid = 0u;
+    gScanProxStats.evictions = 0u;
+    gScanProxStats.handovers = 0u;
+    gScanProxStats.misses = 0u;
+    gScanProxStats.tracked = 0u;
+}
+
+/*! *********************************************************************************
+* \brief     Feed an advertising report of a bonded peer
+********************************************************************************** */
+ProxRssi_EventType ScanProx_Report(uint8_t nvmIndex, int8_t rssi, uint32_t now)
+{
+    ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+    scanProxPeer_t *pPeer;
+    int32_t adjusted;
+
+    /* 127 is "not available", real advertising RSSI is negative */
+    if ((nvmIndex == SCAN_PROX_FREE) || (rssi == (int8_t)127) || (rssi >= (int8_t)0))
+    {
+        gScanProxStats.invalid++;
+        return ev;
+    }
+
+    pPeer = ScanProx_Find(nvmIndex);
+    if (pPeer == NULL)
+    {
+        pPeer = ScanProx_Claim(nvmIndex);
+        if (pPeer == NULL)
+        {
+            return ev;
+        }
+    }
+
+    adjusted = (int32_t)rssi + (int32_t)SCAN_PROX_ADV_OFFSET_DB;
+    if (adjusted > -1)
+    {
+        adjusted = -1;
+    }
+    else if (adjusted < -127)
+    {
+        adjusted = -127;
+    }
+    else
+    {
+        /* In range */
+    }
+
+    (void)ProxRssi_PushRaw(&pPeer->ctx, now, (int8_t)adjusted);
+    (void)ProxRssi_MainFunction(&pPeer->ctx, now, &ev, NULL);
+    pPeer->lastReport = now;
+    gScanProxStats.reports++;
+
+    return ev;
+}
+
+/*! *********************************************************************************
+* \brief     Move the history of a peer into the context of its new connection
+********************************************************************************** */
+bool_t ScanProx_Handover(uint8_t nvmIndex, uint32_t now, ProxRssi_CtxType *pCtx)
+{
+    scanProxPeer_t *pPeer = (nvmIndex != SCAN_PROX_FREE) ? ScanProx_Find(nvmIndex) : NULL;
+    bool_t warmed = FALSE;
+
+    if (pPeer == NULL)
+    {
+        gScanProxStats.misses++;
+        return FALSE;
+    }
+
+    /* A FAR instance still lags the approach, the link's own first samples do better.
+     * Snapshot first: ProxRssi_Handover resets pCtx before the checks. */
+    if ((pCtx != NULL) && (pPeer->ctx.st != PROX_RSSI_ST_FAR) &&
+        (ProxTime_Elapsed(now, pPeer->lastReport) < PROX_TIME_MS_TO_TICKS(SCAN_PROX_HANDOVER_MS)) &&
+        (ProxRssi_Snapshot(&pPeer->ctx, &gScanProxSnap) == E_OK) &&
+        (ProxRssi_Handover(pCtx, now, &gScanProxSnap, SCAN_PROX_HANDOVER_MS) == E_OK))
+    {
+        warmed = TRUE;
+        gScanProxStats.handovers++;
+    }
+    else
+    {
+        gScanProxStats.misses++;
+    }
+
+    /* The link follows the peer from now on */
+    pPeer->nvmIndex = SCAN_PROX_FREE;
+    ScanProx_Count();
+
+    return warmed;
+}
+
+/*! *********************************************************************************
+* \brief     State of a peer's instance
+********************************************************************************** */
+ProxRssi_StateType ScanProx_GetState(uint8_t nvmIndex)
+{
+    scanProxPeer_t *pPeer = (nvmIndex != SCAN_PROX_FREE) ? ScanProx_Find(nvmIndex) : NULL;
+
+    return (pPeer != NULL) ? pPeer->ctx.st : PROX_RSSI_ST_FAR;
+}
+
+/*! *********************************************************************************
+* \brief     Copy the counters
+********************************************************************************** */
+void ScanProx_GetStats(scanProxStats_t *pStats)
+{
+    if (pStats != NULL)
+    {
+        *pStats = gScanProxStats;
+    }
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static scanProxPeer_t *ScanProx_Find(uint8_t nvmIndex)
+{
+    scanProxPeer_t *pPeer = NULL;
+    uint8_t i;
+
+    for (i = 0u; i < SCAN_PROX_PEERS; i++)
+    {
+        if (gaScanProxPeer[i].nvmIndex == nvmIndex)
+        {
+            pPeer = &gaScanProxPeer[i];
+            break;
+        }
+    }
+
+    return pPeer;
+}
+
+/* A free instance, else the one of the peer not heard from for the longest time */
+static scanProxPeer_t *ScanProx_Claim(uint8_t nvmIndex)
+{
+    scanProxPeer_t *pPeer = ScanProx_Find(SCAN_PROX_FREE);
+    uint8_t i;
+
+    if (pPeer == NULL)
+    {
+        pPeer = &gaScanProxPeer[0];
+        for (i = 1u; i < SCAN_PROX_PEERS; i++)
+        {
+            if (ProxTime_Before(gaScanProxPeer[i].lastReport, pPeer->lastReport) == TRUE)
+            {
+                pPeer = &gaScanProxPeer[i];
+            }
+        }
+        gScanProxStats.evictions++;
+    }
+
+    pPeer->nvmIndex = SCAN_PROX_FREE;
+    if (ProxRssi_Init(&pPeer->ctx, &gScanProxParams, gpScanProxLut, gScanProxLutLen) == E_OK)
+    {
+        pPeer->nvmIndex = nvmIndex;
+    }
+    else
+    {
+        pPeer = NULL;
+    }
+    ScanProx_Count();
+
+    return pPeer;
+}
+
+static void ScanProx_Count(void)
+{
+    uint8_t i;
+
+    gScanProxStats.tracked = 0u;
+    for (i = 0u; i < SCAN_PROX_PEERS; i++)
+    {
+        if (gaScanProxPeer[i].nvmIndex != SCAN_PROX_FREE)
+        {
+            gScanProxStats.tracked++;
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*! *********************************************************************************
+* \file scan_prox.h
+*
+* Proximity of bonded peers before the connection, from their advertising.
+*
+* ProxRssi normally starts from FAR when the link comes up: the owner is already
+* at the door, and the unlock still waits for stableMs of connection RSSI. While
+* the car scans for its bonded phones, each advertising report of a resolved
+* peer is fed to a ProxRssi instance of that peer, so the approach is followed
+* before the phone connects. At connection ScanProx_Handover moves the history
+* into the connection context (ProxRssi_Handover): EMA, smoothed samples and the
+* CANDIDATE hold carry over, and the first stable sample of the link unlocks.
+* Only a peer the scan already saw near (CANDIDATE or LOCKOUT) is handed over:
+* the EMA of a FAR instance lags the approach and would delay the link's own.
+*
+* The scan instances use the connection parameters with stableMs replaced by
+* SCAN_PROX_HOLD_MS: no unlock is possible without the link, the hold just keeps
+* growing. A phone that stays near the car that long without connecting goes to
+* LOCKOUT, as it would have after an unlock on the link.
+*
+* Up to SCAN_PROX_PEERS peers are followed, the one not heard from for the
+* longest time gives its instance up. Peers are bond NVM indexes, resolving the
+* advertising address is left to the caller. Times are prox_time.h ticks.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef SCAN_PROX_H
+#define SCAN_PROX_H
+
+#include "EmbeddedTypes.h"
+#include "ProxRssi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Bonded peers followed at the same time (one ProxRssi context each) */
+#ifndef SCAN_PROX_PEERS
+#define SCAN_PROX_PEERS             (2u)
+#endif
+
+/* CANDIDATE hold before a scan instance goes to LOCKOUT */
+#ifndef SCAN_PROX_HOLD_MS
+#define SCAN_PROX_HOLD_MS           (30000u)
+#endif
+
+/* Newest report at most this old when the link comes up, else cold start */
+#ifndef SCAN_PROX_HANDOVER_MS
+#define SCAN_PROX_HANDOVER_MS       (2000u)
+#endif
+
+/* Added to advertising RSSI: advertising and connection TX power of the phone differ */
+#ifndef SCAN_PROX_ADV_OFFSET_DB
+#define SCAN_PROX_ADV_OFFSET_DB     (0)
+#endif
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+typedef struct
+{
+    uint32_t reports;               /* Reports fed to an instance */
+    uint32_t invalid;               /* RSSI not available */
+    uint32_t evictions;             /* Instance taken over by another peer */
+    uint32_t handovers;             /* Connections warmed from the scan */
+    uint32_t misses;                /* Connections of a bonded peer not seen near just before */
+    uint8_t  tracked;               /* Peers followed now */
+} scanProxStats_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Forget all peers and clear the counters
+*
+* \param[in] pParams        Connection parameters of ProxRssi, copied.
+* \param[in] pAlphaLut      Alpha LUT given to ProxRssi_Init, kept.
+* \param[in] alphaLutLen    Its length.
+********************************************************************************** */
+void ScanProx_Init(const ProxRssi_ParamsType *pParams, const uint16_t *pAlphaLut, uint32_t alphaLutLen);
+
+/*! *********************************************************************************
+* \brief     Feed an advertising report of a bonded peer
+*
+* \param[in] nvmIndex   Bond of the peer.
+* \param[in] rssi       RSSI of the report, 127 if not available.
+* \param[in] now        Current time.
+*
+* \return    ProxRssi event of the peer's instance.
+********************************************************************************** */
+ProxRssi_EventType ScanProx_Report(uint8_t nvmIndex, int8_t rssi, uint32_t now);
+
+/*! *********************************************************************************
+* \brief     Move the history of a peer into the context of its new connection
+*
+* The peer is forgotten by the scan either way.
+*
+* \param[in]  nvmIndex  Bond of the connected peer.
+* \param[in]  now       Current time.
+* \param[out] pCtx      Connection context, initialised with its parameters.
+*
+* \return     TRUE if the context was warmed, FALSE if left as it was.
+********************************************************************************** */
+bool_t ScanProx_Handover(uint8_t nvmIndex, uint32_t now, ProxRssi_CtxType *pCtx);
+
+/*! *********************************************************************************
+* \brief     State of a peer's instance, PROX_RSSI_ST_FAR if not followed
+********************************************************************************** */
+ProxRssi_StateType ScanProx_GetState(uint8_t nvmIndex);
+
+/*! *********************************************************************************
+* \brief     Copy the counters
+********************************************************************************** */
+void ScanProx_GetStats(scanProxStats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCAN_PROX_H */
@@ -0,0 +1,252 @@
+/*! *********************************************************************************
+* \file unlock_path.c
+*
+* Connect to unlock latency: milestones of the Passive Entry critical path.
+* See unlock_path.h.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+* Include
+************************************************************************************/
+
+#include "EmbeddedTypes.h"
+#include "unlock_path.h"
+
+/************************************************************************************
+* Private type definitions
+************************************************************************************/
+
+typedef struct
+{
+    uint32_t aTimeMs[unlockPathMilestoneCount_c];
+    uint16_t reached;                               /* Bit per milestone */
+    uint8_t  last;                                  /* Latest milestone reached */
+    bool_t   active;                                /* Connected */
+    bool_t   unlocked;
+} unlockPathTimeline_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t ended;
+    uint32_t aWindowMs[UNLOCK_PATH_WINDOW];
+    uint8_t  head;                                  /* Next slot written */
+    uint8_t  fill;
+} unlockPathPhase_t;
+
+/************************************************************************************
+* Private variables
+************************************************************************************/
+
+static unlockPathTimeline_t gaUnlockPathTimeline[UNLOCK_PATH_MAX_DEVICES];
+static unlockPathPhase_t    gaUnlockPathPhase[unlockPathMilestoneCount_c];
+
+/************************************************************************************
+* Private function prototypes
+************************************************************************************/
+
+static void UnlockPath_Record(unlockPathMilestone_t milestone, uint32_t durationMs);
+static void UnlockPath_End(unlockPathTimeline_t *pLine);
+
+/************************************************************************************
+* Public functions
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Clear the timelines and the statistics
+********************************************************************************** */
+void UnlockPath_Init(void)
+{
+    uint8_t dev;
+
+    for (dev = 0u; dev < UNLOCK_PATH_MAX_DEVICES; dev++)
+    {
+        gaUnlockPathTimeline[dev].reached = 0u;
+        gaUnlockPathTimeline[dev].active = FALSE;
+        gaUnlockPathTimeline[dev].unlocked = FALSE;
+    }
+    UnlockPath_Reset();
+}
+
+/*! *********************************************************************************
+* \brief     Clear the statistics, timelines in progress go on
+********************************************************************************** */
+void UnlockPath_Reset(void)
+{
+    uint8_t m;
+
+    for (m = 0u; m < (uint8_t)unlockPathMilestoneCount_c; m++)
+    {
+        gaUnlockPathPhase[m].count = 0u;
+        gaUnlockPathPhase[m].ended = 0u;
+        gaUnlockPathPhase[m].head = 0u;
+        gaUnlockPathPhase[m].fill = 0u;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     A connection reached a milestone
+********************************************************************************** */
+void UnlockPath_Mark(uint8_t deviceId, unlockPathMilestone_t milestone, uint32_t nowMs)
+{
+    unlockPathTimeline_t *pLine;
+    uint16_t bit;
+    uint8_t from;
+
+    if ((deviceId >= UNLOCK_PATH_MAX_DEVICES) || (milestone >= unlockPathMilestoneCount_c))
+    {
+        return;
+    }
+
+    pLine = &gaUnlockPathTimeline[deviceId];
+    bit = (uint16_t)(1u << (uint8_t)milestone);
+
+    if (milestone == unlockPathConnected_c)
+    {
+        /* A connection not seen to end */
+        UnlockPath_End(pLine);
+        pLine->aTimeMs[unlockPathConnected_c] = nowMs;
+        pLine->reached = bit;
+        pLine->last = (uint8_t)unlockPathConnected_c;
+        pLine->active = TRUE;
+        pLine->unlocked = FALSE;
+        return;
+    }
+
+    if ((pLine->active != TRUE) || (pLine->unlocked == TRUE) || ((pLine->reached & bit) != 0u))
+    {
+        return;
+    }
+
+    /* From the latest earlier milestone of the path reached, at least Connected */
+    from = (uint8_t)milestone - 1u;
+    while ((pLine->reached & (uint16_t)(1u << from)) == 0u)
+    {
+        from--;
+    }
+    UnlockPath_Record(milestone, nowMs - pLine->aTimeMs[from]);
+
+    pLine->aTimeMs[milestone] = nowMs;
+    pLine->reached |= bit;
+    pLine->last = (uint8_t)milestone;
+
+    if (milestone == unlockPathUnlock_c)
+    {
+        UnlockPath_Record(unlockPathConnected_c, nowMs - pLine->aTimeMs[unlockPathConnected_c]);
+        pLine->unlocked = TRUE;
+    }
+}
+
+/*! *********************************************************************************
+* \brief     End of the connection of a device
+********************************************************************************** */
+void UnlockPath_Disconnected(uint8_t deviceId)
+{
+    if (deviceId < UNLOCK_PATH_MAX_DEVICES)
+    {
+        UnlockPath_End(&gaUnlockPathTimeline[deviceId]);
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Statistics of the phase ending at a milestone
+********************************************************************************** */
+bool_t UnlockPath_GetStats(unlockPathMilestone_t milestone, unlockPathStats_t *pStats)
+{
+    const unlockPathPhase_t *pPhase;
+    uint32_t aSorted[UNLOCK_PATH_WINDOW];
+    uint32_t value;
+    uint8_t i;
+    uint8_t j;
+
+    if ((pStats == NULL) || (milestone >= unlockPathMilestoneCount_c))
+    {
+        return FALSE;
+    }
+
+    pPhase = &gaUnlockPathPhase[milestone];
+    pStats->count = pPhase->count;
+    pStats->ended = pPhase->ended;
+    pStats->window = pPhase->fill;
+    pStats->p50Ms = 0u;
+    pStats->p90Ms = 0u;
+    pStats->maxMs = 0u;
+
+    if (pPhase->fill != 0u)
+    {
+        /* Insertion sort of at most UNLOCK_PATH_WINDOW values, on request only */
+        for (i = 0u; i < pPhase->fill; i++)
+        {
+            value = pPhase->aWindowMs[i];
+            for (j = i; (j > 0u) && (aSorted[j - 1u] > value); j--)
+            {
+                aSorted[j] = aSorted[j - 1u];
+            }
+            aSorted[j] = value;
+        }
+
+        /* Nearest rank */
+        pStats->p50Ms = aSorted[(((uint32_t)pPhase->fill * 50u) + 99u) / 100u - 1u];
+        pStats->p90Ms = aSorted[(((uint32_t)pPhase->fill * 90u) + 99u) / 100u - 1u];
+        pStats->maxMs = aSorted[pPhase->fill - 1u];
+    }
+
+    return ((pPhase->count != 0u) || (pPhase->ended != 0u)) ? TRUE : FALSE;
+}
+
+/*! *********************************************************************************
+* \brief     Timeline of the current, or last, connection of a device
+********************************************************************************** */
+bool_t UnlockPath_GetTimeline(uint8_t deviceId, uint32_t aOffsetMs[unlockPathMilestoneCount_c])
+{
+    const unlockPathTimeline_t *pLine;
+    uint8_t m;
+
+    if ((deviceId >= UNLOCK_PATH_MAX_DEVICES) || (gaUnlockPathTimeline[deviceId].reached == 0u))
+    {
+        return FALSE;
+    }
+
+    pLine = &gaUnlockPathTimeline[deviceId];
+    for (m = 0u; m < (uint8_t)unlockPathMilestoneCount_c; m++)
+    {
+        aOffsetMs[m] = ((pLine->reached & (uint16_t)(1u << m)) != 0u) ?
+                       (pLine->aTimeMs[m] - pLine->aTimeMs[unlockPathConnected_c]) : UNLOCK_PATH_NOT_REACHED;
+    }
+
+    return TRUE;
+}
+
+/************************************************************************************
+* Private functions
+************************************************************************************/
+
+static void UnlockPath_Record(unlockPathMilestone_t milestone, uint32_t durationMs)
+{
+    unlockPathPhase_t *pPhase = &gaUnlockPathPhase[milestone];
+
+    pPhase->aWindowMs[pPhase->head] = durationMs;
+    pPhase->head = (uint8_t)((pPhase->head + 1u) % UNLOCK_PATH_WINDOW);
+    if (pPhase->fill < UNLOCK_PATH_WINDOW)
+    {
+        pPhase->fill++;
+    }
+    if (pPhase->count < 0xFFFFFFFFu)
+    {
+        pPhase->count++;
+    }
+}
+
+/* Count a connection that ends before the unlock against its last milestone */
+static void UnlockPath_End(unlockPathTimeline_t *pLine)
+{
+    if ((pLine->active == TRUE) && (pLine->unlocked != TRUE) &&
+        (gaUnlockPathPhase[pLine->last].ended < 0xFFFFFFFFu))
+    {
+        gaUnlockPathPhase[pLine->last].ended++;
+    }
+    pLine->active = FALSE;
+}
@@ -0,0 +1,142 @@
+/*! *********************************************************************************
+* \file unlock_path.h
+*
+* Connect to unlock latency: milestones of the Passive Entry critical path.
+*
+* Each connection gets a timeline of the milestones it reaches, from the link
+* establishment to the first unlock: encryption, service discovery, the end of
+* CCC phase 2 or localization setup, CS configuration and first procedure, the
+* first RSSI sample, CANDIDATE and UNLOCK_TRIGGERED. A milestone counts once per
+* connection and is timed against the latest earlier milestone of the path the
+* connection reached, so a step that did not happen (no service discovery on a
+* bonded phone) or came early (RSSI before CS) does not break the phase after it.
+* The phase of unlockPathConnected_c is the whole connect to unlock time.
+*
+* Per phase the last UNLOCK_PATH_WINDOW durations are kept for rolling
+* percentiles, and every connection that ends without an unlock is counted
+* against the last milestone it reached: where the attempts are lost.
+*
+* Times are in milliseconds, wrap safe.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef UNLOCK_PATH_H
+#define UNLOCK_PATH_H
+
+#include "EmbeddedTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************
+* Public macros
+************************************************************************************/
+
+/* Number of devices tracked */
+#ifndef UNLOCK_PATH_MAX_DEVICES
+#if defined(gAppMaxConnections_c)
+#define UNLOCK_PATH_MAX_DEVICES         (gAppMaxConnections_c)
+#else
+#define UNLOCK_PATH_MAX_DEVICES         (2u)
+#endif
+#endif
+
+/* Durations kept per phase for the rolling percentiles, at most 255 */
+#ifndef UNLOCK_PATH_WINDOW
+#define UNLOCK_PATH_WINDOW              (32u)
+#endif
+
+/* Timeline offset of a milestone not reached */
+#define UNLOCK_PATH_NOT_REACHED         (0xFFFFFFFFu)
+
+/************************************************************************************
+* Public type definitions
+************************************************************************************/
+
+/* In path order */
+typedef enum
+{
+    unlockPathConnected_c = 0,      /* Link established; phase: connect to unlock */
+    unlockPathEncrypted_c,          /* Link encrypted */
+    unlockPathServiceDisc_c,        /* Service discovery complete */
+    unlockPathReady_c,              /* CCC phase 2 or localization setup done */
+    unlockPathCsConfig_c,           /* CS configuration complete */
+    unlockPathCsStarted_c,          /* First CS procedure started */
+    unlockPathFirstRssi_c,          /* First valid RSSI sample */
+    unlockPathCandidate_c,          /* Proximity CANDIDATE */
+    unlockPathUnlock_c,             /* UNLOCK_TRIGGERED */
+    unlockPathMilestoneCount_c
+} unlockPathMilestone_t;
+
+typedef struct
+{
+    uint32_t count;                 /* Phase durations since reset */
+    uint32_t ended;                 /* Connections lost at this milestone since reset */
+    uint32_t window;                /* Durations in the rolling window */
+    uint32_t p50Ms;                 /* Over the window */
+    uint32_t p90Ms;
+    uint32_t maxMs;
+} unlockPathStats_t;
+
+/************************************************************************************
+* Public prototypes
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief     Clear the timelines and the statistics
+********************************************************************************** */
+void UnlockPath_Init(void);
+
+/*! *********************************************************************************
+* \brief     Clear the statistics, timelines in progress go on
+********************************************************************************** */
+void UnlockPath_Reset(void);
+
+/*! *********************************************************************************
+* \brief     A connection reached a milestone
+*
+* unlockPathConnected_c starts the timeline of the device. Later milestones count
+* the first time only, and not after the unlock.
+*
+* \param[in] deviceId   Device identifier.
+* \param[in] milestone  Milestone reached.
+* \param[in] nowMs      Current time.
+********************************************************************************** */
+void UnlockPath_Mark(uint8_t deviceId, unlockPathMilestone_t milestone, uint32_t nowMs);
+
+/*! *********************************************************************************
+* \brief     End of the connection of a device
+*
+* \param[in] deviceId   Device identifier.
+********************************************************************************** */
+void UnlockPath_Disconnected(uint8_t deviceId);
+
+/*! *********************************************************************************
+* \brief     Statistics of the phase ending at a milestone
+*
+* \param[in]  milestone Milestone.
+* \param[out] pStats    Counts and rolling percentiles.
+*
+* \return     TRUE if the phase or the milestone counted anything since reset.
+********************************************************************************** */
+bool_t UnlockPath_GetStats(unlockPathMilestone_t milestone, unlockPathStats_t *pStats);
+
+/*! *********************************************************************************
+* \brief     Timeline of the current, or last, connection of a device
+*
+* \param[in]  deviceId  Device identifier.
+* \param[out] aOffsetMs Time of each milestone from the connection,
+*                       UNLOCK_PATH_NOT_REACHED if not reached.
+*
+* \return     TRUE if the device has a timeline.
+********************************************************************************** */
+bool_t UnlockPath_GetTimeline(uint8_t deviceId, uint32_t aOffsetMs[unlockPathMilestoneCount_c]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UNLOCK_PATH_H */
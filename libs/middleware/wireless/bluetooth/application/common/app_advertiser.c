@@ -236,7 +236,7 @@ static void App_AdvertisingCallback (gapAdvertisingEvent_t* pAdvertisingEvent)
         pMsgIn->msgData.advMsg.eventData = pAdvertisingEvent->eventData;
 
         /* Put message in the Host Stack to App queue */
-        if (MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn) == kMSG_Success)
+        if (App_QueueHostMessage(pMsgIn) == kMSG_Success)
         {
             /* Signal application */
             (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
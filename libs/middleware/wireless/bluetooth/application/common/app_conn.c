@@ -48,6 +48,19 @@
 #endif /* gFSCI_IncludeLpmCommands_c */
 #endif /* gFsciIncluded_c */
 
+#if (gAppHostMsgDrainBudgetUs_c > 0U) || (defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1U)) || \
+    (defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U))
+#include "fsl_component_timer_manager.h"
+#endif /* gAppHostMsgDrainBudgetUs_c || gAppHostMsgStats_d || gAppMsgLanes_d */
+
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+#include "msg_lane.h"
+#endif /* gAppMsgLanes_d */
+
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+#include "msg_ref.h"
+#endif /* gAppHostMsgRetain_d */
+
 #if defined(gAppUseNvm_d) && (gAppUseNvm_d > 0)
 #include "NVM_Interface.h"
 #if defined(gFsciIncluded_c) && (gFsciIncluded_c == 1)
@@ -93,6 +106,27 @@
 /* convert 32Khz ticks into milliseconds */
 #define CONVERT_MS_2_32Kticks(time_ms)    ((time_ms * 32768) / 1000 )
 
+/* Timestamps needed by the host message drain */
+#if (gAppHostMsgDrainBudgetUs_c > 0U) || (defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1U))
+#define mAppHostMsgDrainTimed_c           (1U)
+#else
+#define mAppHostMsgDrainTimed_c           (0U)
+#endif
+
+/* Message lanes: critical and bulk (msg_lane.h), or a single one */
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+#define mAppLaneCount_c                   ((uint8_t)msgLaneCount_c)
+#else
+#define mAppLaneCount_c                   (1U)
+#endif
+
+/* Lane of App_PostCallbackMessage */
+#define mAppLaneBulk_c                    (mAppLaneCount_c - 1U)
+
+/* Lane of the host stack queue. The queue is served as a whole, in arrival order,
+   so no message of a connection overtakes an earlier one */
+#define mAppLaneHost_c                    (0U)
+
 /************************************************************************************
 *************************************************************************************
 * Private type definitions
@@ -102,6 +136,9 @@ typedef struct appMsgCallback_tag
 {
     appCallbackHandler_t   handler;
     appCallbackParam_t     param;
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+    uint32_t               postedUs;
+#endif /* gAppMsgLanes_d */
 } appMsgCallback_t;
 
 /************************************************************************************
@@ -130,6 +167,9 @@ static bool_t App_HandleHostMessageInput_Cs
 (
     appMsgFromHost_t* pMsg
 );
+static bool_t App_HandleHostQueueHead(void);
+static bool_t App_HandleCbQueueHead(uint8_t lane);
+static uint8_t App_PendingLanes(void);
 static void App_GenericHandler
 (
     gapGenericEvent_t *pGenericEvent
@@ -210,8 +250,26 @@ static appCallbackHandler_t pfCsCmdCompleteCallback                   = NULL;
 static appCallbackHandler_t pfCsCmdStatusCallback                     = NULL;
 static appCallbackHandler_t pfCsMetaEventCallback                     = NULL;
 
-/* Application input queues */
-static messaging_t mAppCbInputQueue;
+/* Application input queues, one per lane */
+static messaging_t mAppCbInputQueue[mAppLaneCount_c];
+
+/* Queue served first by the next drain pass, alternates for fairness */
+static bool_t mAppDrainHostFirst = TRUE;
+
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1U)
+static appHostMsgStats_t mAppHostMsgStats;
+#endif /* gAppHostMsgStats_d */
+
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+/* Host stack message whose handler is running, the one App_RetainHostMessage holds */
+static appMsgFromHost_t *mpAppHostMsgInHandler = NULL;
+#endif /* gAppHostMsgRetain_d */
+
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+/* Queue entry time of the message whose handler is running, see App_GetMsgPostedUs */
+static uint32_t mAppMsgPostedUs;
+static bool_t mAppMsgPostedValid = FALSE;
+#endif /* gAppMsgLanes_d */
 
 /************************************************************************************
 *************************************************************************************
@@ -291,8 +349,17 @@ void BluetoothLEHost_Init
         /* Prepare application input queue.*/
         MSG_QueueInit(&mHostAppInputQueue);
 
-        /* Prepare callback input queue.*/
-        MSG_QueueInit(&mAppCbInputQueue);
+        /* Prepare callback input queues.*/
+        for (uint8_t lane = 0U; lane < mAppLaneCount_c; lane++)
+        {
+            MSG_QueueInit(&mAppCbInputQueue[lane]);
+        }
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+        MsgLane_Init();
+#endif /* gAppMsgLanes_d */
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+        MsgRef_Init();
+#endif /* gAppHostMsgRetain_d */
 
         /* BLE common part */
         mpfInitDoneCallback = pCallback;
@@ -354,46 +421,159 @@ void BluetoothLEHost_HandleMessages(void)
                         &event);
 #endif /* defined(SDK_OS_FREE_RTOS) || defined(FSL_RTOS_THREADX) */
 
-    /* Check for existing messages in queue */
-    if (MSG_QueueGetHead(&mHostAppInputQueue) != NULL)
+    /* Handle up to gAppHostMsgDrainMax_c messages, one from each queue in turn so
+       a burst on one queue (CS meta events, RAS segments) cannot starve the other.
+       With gAppMsgLanes_d the lane is picked first, critical before bulk: the host
+       stack queue and the critical callbacks share the critical lane, the bulk
+       lane only holds callbacks */
+    uint32_t handled  = 0U;
+    bool_t   hostTurn = mAppDrainHostFirst;
+    bool_t   served;
+    bool_t   fromHost;
+    uint8_t  lane     = 0U;
+    bool_t   overBudget = FALSE;
+#if (mAppHostMsgDrainTimed_c == 1U)
+    uint64_t passStart = TM_GetTimestamp();
+    uint64_t now       = passStart;
+#endif /* mAppHostMsgDrainTimed_c */
+
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1U)
+    uint64_t msgStart = passStart;
+    uint32_t depth    = LIST_GetSize((list_handle_t)&mHostAppInputQueue);
+    uint8_t  idx;
+    if (depth > (uint32_t)mAppHostMsgStats.hostDepthMax)
     {
-        /* Pointer for storing the messages from host. */
-        appMsgFromHost_t *pMsgIn = MSG_QueueRemoveHead(&mHostAppInputQueue);
+        mAppHostMsgStats.hostDepthMax = (uint16_t)((depth > 0xFFFFU) ? 0xFFFFU : depth);
+    }
+    depth = 0U;
+    for (idx = 0U; idx < mAppLaneCount_c; idx++)
+    {
+        depth += LIST_GetSize((list_handle_t)&mAppCbInputQueue[idx]);
+    }
+    if (depth > (uint32_t)mAppHostMsgStats.cbDepthMax)
+    {
+        mAppHostMsgStats.cbDepthMax = (uint16_t)((depth > 0xFFFFU) ? 0xFFFFU : depth);
+    }
+#endif /* gAppHostMsgStats_d */
 
-        if (pMsgIn != NULL)
+    while (handled < (uint32_t)gAppHostMsgDrainMax_c)
+    {
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+        lane = (uint8_t)MsgLane_Pick(App_PendingLanes());
+        if (lane >= mAppLaneCount_c)
         {
-            /* Process it */
-            App_HandleHostMessageInput(pMsgIn);
+            break;
+        }
+#endif /* gAppMsgLanes_d */
 
-            /* Messages must always be freed. */
-            (void)MSG_Free(pMsgIn);
+        if (lane != mAppLaneHost_c)
+        {
+            /* Only callbacks are posted to the other lanes */
+            served   = App_HandleCbQueueHead(lane);
+            fromHost = FALSE;
         }
+        /* Fall back to the other queue when the one whose turn it is is empty */
+        else if (hostTurn == TRUE)
+        {
+            served   = App_HandleHostQueueHead();
+            fromHost = TRUE;
+            if (served == FALSE)
+            {
+                served   = App_HandleCbQueueHead(lane);
+                fromHost = FALSE;
+            }
+        }
+        else
+        {
+            served   = App_HandleCbQueueHead(lane);
+            fromHost = FALSE;
+            if (served == FALSE)
+            {
+                served   = App_HandleHostQueueHead();
+                fromHost = TRUE;
+            }
+        }
+
+        if (served == FALSE)
+        {
+            break;
+        }
+
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1U)
+        if (fromHost == TRUE)
+        {
+            mAppHostMsgStats.hostMsgs++;
+        }
+        else
+        {
+            mAppHostMsgStats.cbMsgs++;
+        }
+#endif /* gAppHostMsgStats_d */
+
+        handled++;
+        if (lane == mAppLaneHost_c)
+        {
+            hostTurn = (fromHost == TRUE) ? FALSE : TRUE;
+        }
+
+#if (mAppHostMsgDrainTimed_c == 1U)
+        now = TM_GetTimestamp();
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1U)
+        if ((now - msgStart) > (uint64_t)mAppHostMsgStats.msgMaxUs)
+        {
+            mAppHostMsgStats.msgMaxUs = (uint32_t)(now - msgStart);
+        }
+        msgStart = now;
+#endif /* gAppHostMsgStats_d */
+#endif /* mAppHostMsgDrainTimed_c */
+
+#if (gAppHostMsgDrainBudgetUs_c > 0U)
+        if ((now - passStart) >= (uint64_t)gAppHostMsgDrainBudgetUs_c)
+        {
+            overBudget = TRUE;
+            break;
+        }
+#endif /* gAppHostMsgDrainBudgetUs_c */
     }
 
-    /* Check for existing messages in queue */
-    if (MSG_QueueGetHead(&mAppCbInputQueue) != NULL)
-    {
-        /* Pointer for storing the callback messages. */
-        appMsgCallback_t *pMsgIn = MSG_QueueGetHead(&mAppCbInputQueue);
+    /* The next pass starts with the queue that was not served last */
+    mAppDrainHostFirst = hostTurn;
 
-        if (pMsgIn != NULL)
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1U)
+    if (handled > 0U)
+    {
+        mAppHostMsgStats.wakeups++;
+        mAppHostMsgStats.passTotalUs += (uint32_t)(now - passStart);
+        if ((now - passStart) > (uint64_t)mAppHostMsgStats.passMaxUs)
         {
-            /* Execute callback handler */
-            if (pMsgIn->handler != NULL)
+            mAppHostMsgStats.passMaxUs = (uint32_t)(now - passStart);
+        }
+        if (handled > (uint32_t)mAppHostMsgStats.batchMax)
+        {
+            mAppHostMsgStats.batchMax = (uint16_t)handled;
+        }
+        if (BluetoothLEHost_IsMessagePending() == TRUE)
+        {
+            if (overBudget == TRUE)
             {
-                pMsgIn->handler(pMsgIn->param);
+                mAppHostMsgStats.budgetExits++;
+            }
+            else if (handled >= (uint32_t)gAppHostMsgDrainMax_c)
+            {
+                mAppHostMsgStats.capExits++;
+            }
+            else
+            {
+                /* Posted during the pass, after its queues were found empty */
             }
-
-            /* Messages must always be freed. */
-            (void)MSG_Free(pMsgIn);
         }
     }
+#endif /* gAppHostMsgStats_d */
+    (void)overBudget;
 
 #if defined(SDK_OS_FREE_RTOS) || defined(FSL_RTOS_THREADX)
     /* Signal the main_thread again if there are more messages pending */
-    event = (MSG_QueueGetHead(&mHostAppInputQueue) != NULL) ? gAppEvtMsgFromHostStack_c : 0U;
-    event |= (MSG_QueueGetHead(&mAppCbInputQueue) != NULL) ? gAppEvtAppCallback_c : 0U;
-    if (event != 0U)
+    if (BluetoothLEHost_IsMessagePending() == TRUE)
     {
         (void)OSA_EventSet((osa_event_handle_t)mAppEvent, gAppEvtAppCallback_c);
     }
@@ -413,13 +593,48 @@ bool BluetoothLEHost_IsMessagePending(void)
 {
     bool ret = FALSE;
      /* Check for existing messages in queue */
-    if ( (MSG_QueueGetHead(&mHostAppInputQueue) != NULL) || (MSG_QueueGetHead(&mAppCbInputQueue) != NULL) )
+    if (App_PendingLanes() != 0U)
     {
         ret = TRUE;
     }
     return ret;
 }
 
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1U)
+/*! *********************************************************************************
+*\fn           void BluetoothLEHost_GetMsgStats(appHostMsgStats_t *pStats)
+*\brief        Copy the host message drain counters.
+*
+*\param  [out] pStats       Counters since boot or the last reset.
+*
+*\retval       void.
+********************************************************************************** */
+void BluetoothLEHost_GetMsgStats(appHostMsgStats_t *pStats)
+{
+    if (pStats != NULL)
+    {
+        OSA_InterruptDisable();
+        *pStats = mAppHostMsgStats;
+        OSA_InterruptEnable();
+    }
+}
+
+/*! *********************************************************************************
+*\fn           void BluetoothLEHost_ResetMsgStats(void)
+*\brief        Clear the host message drain counters.
+*
+*\param  [in]  none.
+*
+*\retval       void.
+********************************************************************************** */
+void BluetoothLEHost_ResetMsgStats(void)
+{
+    OSA_InterruptDisable();
+    FLib_MemSet(&mAppHostMsgStats, 0U, sizeof(mAppHostMsgStats));
+    OSA_InterruptEnable();
+}
+#endif /* gAppHostMsgStats_d */
+
 /*! *********************************************************************************
 \fn            void BluetoothLEHost_SetGenericCallback(
 *                  gapGenericCallback_t pfGenericCallback
@@ -623,8 +838,35 @@ bleResult_t App_PostCallbackMessage
     appCallbackHandler_t   handler,
     appCallbackParam_t     param
 )
+{
+    return App_PostCallbackMessageLane(handler, param, gAppMsgLaneBulk_c);
+}
+
+/*! *********************************************************************************
+\fn            bleResult_t App_PostCallbackMessageLane(
+*                  appCallbackHandler_t   handler,
+*                  appCallbackParam_t     param,
+*                  appMsgLane_t           lane
+               )
+*\brief        Store a callback message in the Cb App queue of a lane and signal
+*              application.
+*
+*\param  [in]  handler              Callback handler.
+*\param  [in]  param                Callback parameter.
+*\param  [in]  lane                 Message lane.
+*
+*\retval       gBleOutOfMemory_c    Message allocation fail.
+*\retval       gBleSuccess_c        Successful addition to the Cb App queue.
+********************************************************************************** */
+bleResult_t App_PostCallbackMessageLane
+(
+    appCallbackHandler_t   handler,
+    appCallbackParam_t     param,
+    appMsgLane_t           lane
+)
 {
     appMsgCallback_t *pMsgIn = NULL;
+    uint8_t laneIdx = ((uint8_t)lane < mAppLaneCount_c) ? (uint8_t)lane : mAppLaneBulk_c;
 
     /* Allocate a buffer with enough space to store the packet */
     pMsgIn = MSG_Alloc(sizeof (appMsgCallback_t));
@@ -636,9 +878,12 @@ bleResult_t App_PostCallbackMessage
 
     pMsgIn->handler = handler;
     pMsgIn->param = param;
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+    pMsgIn->postedUs = (uint32_t)TM_GetTimestamp();
+#endif /* gAppMsgLanes_d */
 
     /* Put message in the Cb App queue */
-    (void)MSG_QueueAddTail(&mAppCbInputQueue, pMsgIn);
+    (void)MSG_QueueAddTail(&mAppCbInputQueue[laneIdx], pMsgIn);
 
     /* Signal application */
     (void)OSA_EventSet(mAppEvent, gAppEvtAppCallback_c);
@@ -646,6 +891,86 @@ bleResult_t App_PostCallbackMessage
     return gBleSuccess_c;
 }
 
+/*! *********************************************************************************
+*\fn           messaging_status_t App_QueueHostMessage(appMsgFromHost_t *pMsgIn)
+*\brief        Puts a host stack message at the tail of the host stack queue, stamped
+*              with its post time.
+*
+*\param  [in]  pMsgIn          Message from MSG_Alloc.
+*
+*\return       Result of MSG_QueueAddTail.
+********************************************************************************** */
+messaging_status_t App_QueueHostMessage(appMsgFromHost_t *pMsgIn)
+{
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+    pMsgIn->postedUs = (uint32_t)TM_GetTimestamp();
+#endif /* gAppMsgLanes_d */
+
+    return MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+}
+
+/*! *********************************************************************************
+*\fn           bool_t App_GetMsgPostedUs(uint32_t *pPostedUs)
+*\brief        Queue entry time of the message being handled.
+*
+*\param  [out] pPostedUs       TM_GetTimestamp() value, low 32 bits.
+*
+*\return       TRUE from a message handler with gAppMsgLanes_d.
+********************************************************************************** */
+bool_t App_GetMsgPostedUs(uint32_t *pPostedUs)
+{
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+    if ((pPostedUs != NULL) && (mAppMsgPostedValid == TRUE))
+    {
+        *pPostedUs = mAppMsgPostedUs;
+        return TRUE;
+    }
+#else
+    (void)pPostedUs;
+#endif /* gAppMsgLanes_d */
+    return FALSE;
+}
+
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+/*! *********************************************************************************
+*\fn           void *App_RetainHostMessage(void)
+*\brief        Takes a reference on the host stack message being handled.
+*
+*\param  [in]  none.
+*
+*\return       Handle for App_ReleaseHostMessage, NULL outside a host stack message
+*              handler or with MSG_REF_SLOTS messages already held.
+********************************************************************************** */
+void *App_RetainHostMessage(void)
+{
+    void *pHandle = NULL;
+
+    if ((mpAppHostMsgInHandler != NULL) && (MsgRef_Retain(mpAppHostMsgInHandler) == TRUE))
+    {
+        pHandle = mpAppHostMsgInHandler;
+    }
+
+    return pHandle;
+}
+
+/*! *********************************************************************************
+*\fn           void App_ReleaseHostMessage(void *pHandle)
+*\brief        Drops a reference on a host stack message, frees it with the last one.
+*
+*\param  [in]  pHandle         Handle returned by App_RetainHostMessage.
+*
+*\retval       void.
+********************************************************************************** */
+void App_ReleaseHostMessage(void *pHandle)
+{
+    /* A message released from its own handler is freed by the drain */
+    if ((MsgRef_Release(pHandle) == TRUE) && (pHandle != (void *)mpAppHostMsgInHandler))
+    {
+        (void)MSG_Free(pHandle);
+    }
+}
+#endif /* gAppHostMsgRetain_d */
+
 /*! *********************************************************************************
 \fn            bleResult_t App_GenericCallback(gapGenericEvent_t* pGenericEvent)
 *\brief        Callback used by the Host Stack to propagate GAP generic
@@ -675,7 +1000,7 @@ void App_GenericCallback
                 sizeof(gapGenericEvent_t));
 
     /* Put message in the Host Stack to App queue */
-    (void)MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+    (void)App_QueueHostMessage(pMsgIn);
 
     /* Signal application */
     (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
@@ -711,7 +1036,7 @@ void App_IdsCallback
                 sizeof(idsEventData_t));
 
     /* Put message in the Host Stack to App queue */
-    (void)MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+    (void)App_QueueHostMessage(pMsgIn);
 
     /* Signal application */
     (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
@@ -724,6 +1049,136 @@ void App_IdsCallback
 *************************************************************************************
 ************************************************************************************/
 
+/*! *********************************************************************************
+*\private
+*\fn           bool_t App_HandleHostQueueHead(void)
+*\brief        Handles the oldest message from the host stack queue, if any.
+*
+*\param  [in]  none.
+*
+*\retval       TRUE if a message was handled.
+********************************************************************************** */
+static bool_t App_HandleHostQueueHead(void)
+{
+    bool_t handled = FALSE;
+
+    /* Check for existing messages in queue */
+    if (MSG_QueueGetHead(&mHostAppInputQueue) != NULL)
+    {
+        /* Pointer for storing the messages from host. */
+        appMsgFromHost_t *pMsgIn = MSG_QueueRemoveHead(&mHostAppInputQueue);
+
+        if (pMsgIn != NULL)
+        {
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+            MsgLane_Record((msgLane_t)mAppLaneHost_c, (uint32_t)TM_GetTimestamp() - pMsgIn->postedUs);
+            mAppMsgPostedUs = pMsgIn->postedUs;
+            mAppMsgPostedValid = TRUE;
+#endif /* gAppMsgLanes_d */
+
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+            /* Process it, the handler may keep it with App_RetainHostMessage */
+            mpAppHostMsgInHandler = pMsgIn;
+            App_HandleHostMessageInput(pMsgIn);
+            mpAppHostMsgInHandler = NULL;
+
+            /* Messages must always be freed, held ones by App_ReleaseHostMessage */
+            if (MsgRef_IsHeld(pMsgIn) == FALSE)
+            {
+                (void)MSG_Free(pMsgIn);
+            }
+#else
+            /* Process it */
+            App_HandleHostMessageInput(pMsgIn);
+
+            /* Messages must always be freed. */
+            (void)MSG_Free(pMsgIn);
+#endif /* gAppHostMsgRetain_d */
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+            mAppMsgPostedValid = FALSE;
+#endif /* gAppMsgLanes_d */
+            handled = TRUE;
+        }
+    }
+
+    return handled;
+}
+
+/*! *********************************************************************************
+*\private
+*\fn           bool_t App_HandleCbQueueHead(uint8_t lane)
+*\brief        Runs the oldest application callback of a lane, if any.
+*
+*\param  [in]  lane    Message lane, 0 without gAppMsgLanes_d.
+*
+*\retval       TRUE if a callback was handled.
+********************************************************************************** */
+static bool_t App_HandleCbQueueHead(uint8_t lane)
+{
+    bool_t handled = FALSE;
+
+    /* Check for existing messages in queue */
+    if (MSG_QueueGetHead(&mAppCbInputQueue[lane]) != NULL)
+    {
+        /* Pointer for storing the callback messages. */
+        appMsgCallback_t *pMsgIn = MSG_QueueGetHead(&mAppCbInputQueue[lane]);
+
+        if (pMsgIn != NULL)
+        {
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+            MsgLane_Record((msgLane_t)lane, (uint32_t)TM_GetTimestamp() - pMsgIn->postedUs);
+            mAppMsgPostedUs = pMsgIn->postedUs;
+            mAppMsgPostedValid = TRUE;
+#endif /* gAppMsgLanes_d */
+
+            /* Execute callback handler */
+            if (pMsgIn->handler != NULL)
+            {
+                pMsgIn->handler(pMsgIn->param);
+            }
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+            mAppMsgPostedValid = FALSE;
+#endif /* gAppMsgLanes_d */
+
+            /* Messages must always be freed. */
+            (void)MSG_Free(pMsgIn);
+            handled = TRUE;
+        }
+    }
+
+    return handled;
+}
+
+/*! *********************************************************************************
+*\private
+*\fn           uint8_t App_PendingLanes(void)
+*\brief        Lanes holding a message, the host stack queue counting for
+*              mAppLaneHost_c.
+*
+*\param  [in]  none.
+*
+*\retval       Bit (1 << lane) set for every lane with a message.
+********************************************************************************** */
+static uint8_t App_PendingLanes(void)
+{
+    uint8_t mask = 0U;
+
+    if (MSG_QueueGetHead(&mHostAppInputQueue) != NULL)
+    {
+        mask |= (uint8_t)(1U << mAppLaneHost_c);
+    }
+
+    for (uint8_t lane = 0U; lane < mAppLaneCount_c; lane++)
+    {
+        if (MSG_QueueGetHead(&mAppCbInputQueue[lane]) != NULL)
+        {
+            mask |= (uint8_t)(1U << lane);
+        }
+    }
+
+    return mask;
+}
+
 /*! *********************************************************************************
 *\private
 *\fn           void App_HandleHostMessageInput(appMsgFromHost_t* pMsg)
@@ -1059,7 +1514,7 @@ STATIC void App_GattServerCallback
     }
 
     /* Put message in the Host Stack to App queue */
-    (void)MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+    (void)App_QueueHostMessage(pMsgIn);
 
     /* Signal application */
     (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
@@ -1106,7 +1561,7 @@ STATIC void App_GattClientProcedureCallback
     pMsgIn->msgData.gattClientProcMsg.procedureResult = procedureResult;
 
     /* Put message in the Host Stack to App queue */
-    (void)MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+    (void)App_QueueHostMessage(pMsgIn);
 
     /* Signal application */
     (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
@@ -1169,7 +1624,7 @@ STATIC void App_GattClientNotificationCallback
                 valueLength);
 
     /* Put message in the Host Stack to App queue */
-    (void)MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+    (void)App_QueueHostMessage(pMsgIn);
 
     /* Signal application */
     (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
@@ -1232,7 +1687,7 @@ STATIC void App_GattClientIndicationCallback
                 valueLength);
 
     /* Put message in the Host Stack to App queue */
-    (void)MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+    (void)App_QueueHostMessage(pMsgIn);
 
     /* Signal application */
     (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
@@ -1285,7 +1740,7 @@ STATIC void App_L2caLeDataCallback
                 packetLength);
 
     /* Put message in the Host Stack to App queue */
-    (void)MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+    (void)App_QueueHostMessage(pMsgIn);
 
     /* Signal application */
     (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
@@ -1386,7 +1841,7 @@ STATIC void App_L2caLeControlCallback
                 messageLength);
 
     /* Put message in the Host Stack to App queue */
-    (void)MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+    (void)App_QueueHostMessage(pMsgIn);
 
     /* Signal application */
     (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
@@ -119,6 +119,9 @@ typedef struct secLibMsgData_tag
 typedef struct appMsgFromHost_tag
 {
     uint32_t    msgType;
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1U)
+    uint32_t    postedUs;       /* Set by App_QueueHostMessage */
+#endif /* gAppMsgLanes_d */
     union {
         gapGenericEvent_t       genericMsg;
         gapAdvertisingEvent_t   advMsg;
@@ -135,6 +138,29 @@ typedef struct appMsgFromHost_tag
     } msgData;
 } appMsgFromHost_t;
 
+/*! Application message lanes, see App_PostCallbackMessageLane */
+typedef enum
+{
+    gAppMsgLaneCritical_c = 0,  /*!< RSSI, Channel Sounding, unlock handshake */
+    gAppMsgLaneBulk_c           /*!< Everything else: shell, bonds, large transfers */
+} appMsgLane_t;
+
+/*! Host message drain counters, see BluetoothLEHost_GetMsgStats */
+typedef struct appHostMsgStats_tag
+{
+    uint32_t    wakeups;        /*!< Passes of BluetoothLEHost_HandleMessages that found work */
+    uint32_t    hostMsgs;       /*!< Messages handled from the host stack queue */
+    uint32_t    cbMsgs;         /*!< Application callbacks handled */
+    uint32_t    budgetExits;    /*!< Passes stopped by gAppHostMsgDrainBudgetUs_c with work left */
+    uint32_t    capExits;       /*!< Passes stopped by gAppHostMsgDrainMax_c with work left */
+    uint16_t    hostDepthMax;   /*!< Deepest host stack queue seen at the start of a pass */
+    uint16_t    cbDepthMax;     /*!< Deepest callback queue seen at the start of a pass */
+    uint16_t    batchMax;       /*!< Most messages handled in one pass */
+    uint32_t    passMaxUs;      /*!< Longest pass, microseconds */
+    uint32_t    passTotalUs;    /*!< Sum of all pass durations, microseconds */
+    uint32_t    msgMaxUs;       /*!< Longest single message handler, microseconds */
+} appHostMsgStats_t;
+
 /*! Callback for notifying application upon Bluetooth LE stack initialization */
 typedef void (*appBluetoothLEInitCompleteCallback_t)(void);
 
@@ -150,6 +176,47 @@ typedef void (*appBluetoothLEInitCompleteCallback_t)(void);
 #define gAppUseNvm_d                    (FALSE)
 #endif /* gAppUseNvm_d */
 
+/*! Fails to compile when a record does not fit its per bond NVM entry of the given
+    size (gAppCsBondDataSize_c, gAppProxCalDataSize_c) */
+#define App_NvmBondDataSizeCheck(name, type, size) \
+    typedef uint8_t name[(sizeof(type) <= (size)) ? 1 : -1]
+
+/*! Maximum number of messages BluetoothLEHost_HandleMessages handles per wakeup,
+    taken alternately from the host stack and the application callback queues.
+    2 matches the historical one message from each queue.
+    Do not modify directly. Redefine it in the app_preinclude.h file*/
+#ifndef gAppHostMsgDrainMax_c
+#define gAppHostMsgDrainMax_c           (2U)
+#endif /* gAppHostMsgDrainMax_c */
+
+/*! Time budget of one BluetoothLEHost_HandleMessages pass in microseconds, checked
+    after each message. 0 to only limit the number of messages.
+    Do not modify directly. Redefine it in the app_preinclude.h file*/
+#ifndef gAppHostMsgDrainBudgetUs_c
+#define gAppHostMsgDrainBudgetUs_c      (0U)
+#endif /* gAppHostMsgDrainBudgetUs_c */
+
+/*! Enable/disable the queue depth and latency counters of the host message drain
+    Do not modify directly. Redefine it in the app_preinclude.h file*/
+#ifndef gAppHostMsgStats_d
+#define gAppHostMsgStats_d              (0U)
+#endif /* gAppHostMsgStats_d */
+
+/*! Enable/disable the critical and bulk message lanes (msg_lane.c). Host stack
+    messages stay in arrival order in the critical lane. When disabled the lane
+    passed to App_PostCallbackMessageLane is ignored.
+    Do not modify directly. Redefine it in the app_preinclude.h file*/
+#ifndef gAppMsgLanes_d
+#define gAppMsgLanes_d                  (0U)
+#endif /* gAppMsgLanes_d */
+
+/*! Enable/disable App_RetainHostMessage, which lets a host message handler keep the
+    message after it returns instead of copying out of it (msg_ref.c).
+    Do not modify directly. Redefine it in the app_preinclude.h file*/
+#ifndef gAppHostMsgRetain_d
+#define gAppHostMsgRetain_d             (0U)
+#endif /* gAppHostMsgRetain_d */
+
 /* Application Events */
 #define gAppEvtMsgFromHostStack_c       (1U << 0U)
 #define gAppEvtAppCallback_c            (1U << 1U)
@@ -247,6 +314,28 @@ void BluetoothLEHost_HandleMessages(void);
 ********************************************************************************** */
 bool BluetoothLEHost_IsMessagePending(void);
 
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1U)
+/*! *********************************************************************************
+*\fn           void BluetoothLEHost_GetMsgStats(appHostMsgStats_t *pStats)
+*\brief        Copy the host message drain counters.
+*
+*\param  [out] pStats       Counters since boot or the last reset.
+*
+*\retval       void.
+********************************************************************************** */
+void BluetoothLEHost_GetMsgStats(appHostMsgStats_t *pStats);
+
+/*! *********************************************************************************
+*\fn           void BluetoothLEHost_ResetMsgStats(void)
+*\brief        Clear the host message drain counters.
+*
+*\param  [in]  none.
+*
+*\retval       void.
+********************************************************************************** */
+void BluetoothLEHost_ResetMsgStats(void);
+#endif /* gAppHostMsgStats_d */
+
 /*! *********************************************************************************
 *\fn           void BluetoothLEHost_SetGenericCallback(
 *                  gapGenericCallback_t pfGenericCallback
@@ -526,6 +615,19 @@ void App_RegisterCsCallbacks
     appCallbackHandler_t  csMetaEventCallback
 );
 
+/*! *********************************************************************************
+*\fn           messaging_status_t App_QueueHostMessage(appMsgFromHost_t *pMsgIn)
+*\brief        Puts a host stack message at the tail of mHostAppInputQueue, with
+*              its post time for the lane latency and App_GetMsgPostedUs.
+*
+*\param  [in]  pMsgIn          Message from MSG_Alloc.
+*
+*\return       messaging_status_t  Result of MSG_QueueAddTail.
+*
+*\remarks      The caller signals the application task (gAppEvtMsgFromHostStack_c).
+********************************************************************************** */
+messaging_status_t App_QueueHostMessage(appMsgFromHost_t *pMsgIn);
+
 /*! *********************************************************************************
 *\fn           bleResult_t App_PostCallbackMessage(
 *                  appCallbackHandler_t   handler
@@ -548,6 +650,79 @@ bleResult_t App_PostCallbackMessage
     appCallbackParam_t     param
 );
 
+/*! *********************************************************************************
+*\fn           bleResult_t App_PostCallbackMessageLane(
+*                  appCallbackHandler_t   handler
+*                  appCallbackParam_t     param
+*                  appMsgLane_t           lane
+*              )
+*\brief        Posts an application event to a given message lane.
+*              App_PostCallbackMessage posts to gAppMsgLaneBulk_c.
+*
+*\param  [in]  handler         Handler function, to be executed when the event is
+*                              processed.
+*\param  [in]  param           Parameter for the handler function.
+*\param  [in]  lane            gAppMsgLaneCritical_c for RSSI, Channel Sounding and
+*                              unlock handshake events, gAppMsgLaneBulk_c otherwise.
+*
+*\return       bleResult_t     Result of the operation.
+*
+*\remarks      Critical callbacks are handled with the host stack messages, before
+*              queued bulk callbacks, see msg_lane.h.
+********************************************************************************** */
+bleResult_t App_PostCallbackMessageLane
+(
+    appCallbackHandler_t   handler,
+    appCallbackParam_t     param,
+    appMsgLane_t           lane
+);
+
+/*! *********************************************************************************
+*\fn           bool_t App_GetMsgPostedUs(uint32_t *pPostedUs)
+*\brief        Time the message being handled was posted: the callback, or the host
+*              stack message queued by App_QueueHostMessage.
+*
+*\param  [out] pPostedUs       TM_GetTimestamp() value, low 32 bits.
+*
+*\return       TRUE from a message handler with gAppMsgLanes_d, FALSE otherwise.
+*
+*\remarks      Application task only.
+********************************************************************************** */
+bool_t App_GetMsgPostedUs(uint32_t *pPostedUs);
+
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+/*! *********************************************************************************
+*\fn           void *App_RetainHostMessage(void)
+*\brief        Takes a reference on the host stack message being handled, so that
+*              it is not freed when its handler returns. The data the handler
+*              received (e.g. the L2CAP packet) stays valid until the reference is
+*              dropped with App_ReleaseHostMessage.
+*
+*\param  [in]  none.
+*
+*\return       Handle to pass to App_ReleaseHostMessage, NULL if not called from
+*              a host stack message handler or if too many messages are held. The
+*              caller must then copy the data it needs.
+*
+*\remarks      Application task only.
+********************************************************************************** */
+void *App_RetainHostMessage(void);
+
+/*! *********************************************************************************
+*\fn           void App_ReleaseHostMessage(void *pHandle)
+*\brief        Drops a reference taken with App_RetainHostMessage and frees the
+*              message with the last one.
+*
+*\param  [in]  pHandle         Handle returned by App_RetainHostMessage. NULL is
+*                              ignored.
+*
+*\retval       void.
+*
+*\remarks      Application task only.
+********************************************************************************** */
+void App_ReleaseHostMessage(void *pHandle);
+#endif /* gAppHostMsgRetain_d */
+
 /*! *********************************************************************************
 *\fn           bleResult_t App_NvmErase(uint8_t mEntryIdx)
 *\brief        This function erases the data corresponding to an entry.
@@ -680,6 +855,79 @@ bleResult_t App_NvmReadLocalKeys
 );
 
 #endif /* (defined(gAppSecureMode_d) && (gAppSecureMode_d > 0U)) */
+
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+/*! *********************************************************************************
+*\fn           bleResult_t App_NvmWriteCsBondData(uint8_t  mEntryIdx,
+*                                                  void*    pCsBondData)
+*\brief        Write the application Channel Sounding data of a bonded device to NVM.
+*               The data is erased together with the bond by App_NvmErase.
+*
+*\param  [in]  mEntryIdx              NVM entry index of the bonded device.
+*\param  [in]  pCsBondData            Pointer to gAppCsBondDataSize_c bytes of data.
+* \return    bleResult_t
+*
+********************************************************************************** */
+bleResult_t App_NvmWriteCsBondData
+(
+    uint8_t  mEntryIdx,
+    void*    pCsBondData
+);
+
+/*! *********************************************************************************
+*\fn        bleResult_t App_NvmReadCsBondData(uint8_t  mEntryIdx,
+*                                             void*    pCsBondData)
+*\brief      Read the application Channel Sounding data of a bonded device from NVM.
+*
+*\param[in]  mEntryIdx              NVM entry index of the bonded device.
+*\param[in]  pCsBondData            Pointer to gAppCsBondDataSize_c bytes where the
+*                                   data will be read.
+*
+* \return  bleResult_t
+********************************************************************************** */
+bleResult_t App_NvmReadCsBondData
+(
+    uint8_t  mEntryIdx,
+    void*    pCsBondData
+);
+#endif /* gAppCsBondDataSize_c */
+
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+/*! *********************************************************************************
+*\fn           bleResult_t App_NvmWriteProxCalData(uint8_t  mEntryIdx,
+*                                                   void*    pProxCalData)
+*\brief        Write the RSSI proximity calibration of a bonded device to NVM.
+*               The data is erased together with the bond by App_NvmErase.
+*
+*\param  [in]  mEntryIdx              NVM entry index of the bonded device.
+*\param  [in]  pProxCalData           Pointer to gAppProxCalDataSize_c bytes of data.
+* \return    bleResult_t
+*
+********************************************************************************** */
+bleResult_t App_NvmWriteProxCalData
+(
+    uint8_t  mEntryIdx,
+    void*    pProxCalData
+);
+
+/*! *********************************************************************************
+*\fn        bleResult_t App_NvmReadProxCalData(uint8_t  mEntryIdx,
+*                                              void*    pProxCalData)
+*\brief      Read the RSSI proximity calibration of a bonded device from NVM.
+*
+*\param[in]  mEntryIdx              NVM entry index of the bonded device.
+*\param[in]  pProxCalData           Pointer to gAppProxCalDataSize_c bytes where the
+*                                   data will be read.
+*
+* \return  bleResult_t
+********************************************************************************** */
+bleResult_t App_NvmReadProxCalData
+(
+    uint8_t  mEntryIdx,
+    void*    pProxCalData
+);
+#endif /* gAppProxCalDataSize_c */
+
 /*! *********************************************************************************
 *\private
 *\fn           void BluetoothLEHost_ProcessIdleTask(void)
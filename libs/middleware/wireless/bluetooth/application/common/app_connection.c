@@ -137,8 +137,8 @@ void App_ConnectionCallback
     {
         gapSmpKeys_t    *pKeys = pConnectionEvent->eventData.keysReceivedEvent.pKeys;
 
-        /* add room for pMsgIn->msgType */
-        msgLen = sizeof(uint32_t);
+        /* add room for pMsgIn->msgType (and postedUs with gAppMsgLanes_d) */
+        msgLen = GetRelAddr(appMsgFromHost_t,msgData);
         /* add room for pMsgIn->msgData.connMsg.deviceId */
         msgLen += sizeof(uint32_t);
         /* add room for pMsgIn->msgData.connMsg.connEvent.eventType */
@@ -275,7 +275,7 @@ void App_ConnectionCallback
         }
 
         /* Put message in the Host Stack to App queue and check status */
-        queueStatus = MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+        queueStatus = App_QueueHostMessage(pMsgIn);
         
         if (queueStatus == kMSG_Success)
         {
@@ -57,8 +57,26 @@
 #define nvmId_BondingDataDeviceInfoId_c  0x4015
 #define nvmId_BondingDataDescriptorId_c  0x4016
 #define nvmId_BleLocalKeysId_c           0x4017
+#define nvmId_AppCsBondDataId_c          0x4018
+#define nvmId_AppProxCalDataId_c         0x4019
 #endif /* gAppUseNvm_d */
 
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+/* Opaque per bond application data (Channel Sounding capabilities and configuration) */
+typedef struct appCsBondDataBlob_tag
+{
+    uint8_t raw[gAppCsBondDataSize_c];
+} appCsBondDataBlob_t;
+#endif /* gAppCsBondDataSize_c */
+
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+/* Opaque per bond application data (RSSI proximity calibration) */
+typedef struct appProxCalDataBlob_tag
+{
+    uint8_t raw[gAppProxCalDataSize_c];
+} appProxCalDataBlob_t;
+#endif /* gAppProxCalDataSize_c */
+
 /************************************************************************************
 *************************************************************************************
 * Private memory declarations
@@ -76,6 +94,12 @@ static bleBondDataDescriptorBlob_t*  aBondingDataDescriptor[gMaxBondedDevices_c
 #if (defined(gAppSecureMode_d) && (gAppSecureMode_d > 0U))
 static bleLocalKeysBlob_t*           aBleLocalKeys[gcSecureModeSavedLocalKeysNo_c];
 #endif
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+static appCsBondDataBlob_t*          aAppCsBondData[gMaxBondedDevices_c];
+#endif /* gAppCsBondDataSize_c */
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+static appProxCalDataBlob_t*         aAppProxCalData[gMaxBondedDevices_c];
+#endif /* gAppProxCalDataSize_c */
 NVM_RegisterDataSet(aBondingHeader,
                     gMaxBondedDevices_c,
                     (gBleBondIdentityHeaderSize_c - gIdentityHeaderOverhead_c),
@@ -113,6 +137,20 @@ NVM_RegisterDataSet(aBleLocalKeys,
                     nvmId_BleLocalKeysId_c,
                     (uint16_t)gNVM_NotMirroredInRamAutoRestore_c);
 #endif /* defined(gAppSecureMode_d) && (gAppSecureMode_d > 0U) */
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+NVM_RegisterDataSet(aAppCsBondData,
+                    gMaxBondedDevices_c,
+                    (uint16_t)sizeof(appCsBondDataBlob_t),
+                    nvmId_AppCsBondDataId_c,
+                    (uint16_t)gNVM_NotMirroredInRamAutoRestore_c);
+#endif /* gAppCsBondDataSize_c */
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+NVM_RegisterDataSet(aAppProxCalData,
+                    gMaxBondedDevices_c,
+                    (uint16_t)sizeof(appProxCalDataBlob_t),
+                    nvmId_AppProxCalDataId_c,
+                    (uint16_t)gNVM_NotMirroredInRamAutoRestore_c);
+#endif /* gAppProxCalDataSize_c */
 #else /* gUnmirroredFeatureSet_d */
 static bleBondIdentityHeaderBlob_t  aBondingHeader[gMaxBondedDevices_c];
 static bleBondDataDynamicBlob_t     aBondingDataDynamic[gMaxBondedDevices_c];
@@ -124,6 +162,12 @@ static bleBondDataDescriptorBlob_t  aBondingDataDescriptor[gMaxBondedDevices_c *
 #if (defined(gAppSecureMode_d) && (gAppSecureMode_d > 0U))
 static bleLocalKeysBlob_t           aBleLocalKeys[gcSecureModeSavedLocalKeysNo_c];
 #endif
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+static appCsBondDataBlob_t          aAppCsBondData[gMaxBondedDevices_c];
+#endif /* gAppCsBondDataSize_c */
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+static appProxCalDataBlob_t         aAppProxCalData[gMaxBondedDevices_c];
+#endif /* gAppProxCalDataSize_c */
 /* register datasets */
 NVM_RegisterDataSet(aBondingHeader,
                     gMaxBondedDevices_c,
@@ -162,14 +206,45 @@ NVM_RegisterDataSet(aBleLocalKeys,
                     nvmId_BleLocalKeysId_c,
                     (uint16_t)gNVM_MirroredInRam_c);
 #endif /* defined(gAppSecureMode_d) && (gAppSecureMode_d > 0U) */
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+NVM_RegisterDataSet(aAppCsBondData,
+                    gMaxBondedDevices_c,
+                    (uint16_t)sizeof(appCsBondDataBlob_t),
+                    nvmId_AppCsBondDataId_c,
+                    (uint16_t)gNVM_MirroredInRam_c);
+#endif /* gAppCsBondDataSize_c */
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+NVM_RegisterDataSet(aAppProxCalData,
+                    gMaxBondedDevices_c,
+                    (uint16_t)sizeof(appProxCalDataBlob_t),
+                    nvmId_AppProxCalDataId_c,
+                    (uint16_t)gNVM_MirroredInRam_c);
+#endif /* gAppProxCalDataSize_c */
 #endif /* gUnmirroredFeatureSet_d */
 #else /* gAppUseNvm_d */
 static bleBondDataBlob_t          maBondDataBlobs[gMaxBondedDevices_c] = {{{{0}}}};
 #if (defined(gAppSecureMode_d) && (gAppSecureMode_d > 0U))
 static bleLocalKeysBlob_t         aBleLocalKeys[gcSecureModeSavedLocalKeysNo_c];
 #endif
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+static appCsBondDataBlob_t        aAppCsBondData[gMaxBondedDevices_c];
+#endif /* gAppCsBondDataSize_c */
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+static appProxCalDataBlob_t       aAppProxCalData[gMaxBondedDevices_c];
+#endif /* gAppProxCalDataSize_c */
 #endif /* gAppUseNvm_d */
 
+/************************************************************************************
+*************************************************************************************
+* Private functions prototypes
+*************************************************************************************
+************************************************************************************/
+#if (defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)) || \
+    (defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U))
+static bleResult_t App_NvmWriteBondBlob(void* pNvmEntry, void* pData, uint32_t size);
+static bleResult_t App_NvmReadBondBlob(void* pNvmEntry, void* pData, uint32_t size);
+#endif /* gAppCsBondDataSize_c || gAppProxCalDataSize_c */
+
 /************************************************************************************
 *************************************************************************************
 * Public functions
@@ -235,6 +310,18 @@ bleResult_t App_NvmErase
                 break;
             }
         }
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+        if (nvmStatus == gNVM_OK_c)
+        {
+            nvmStatus = NvErase((void**)&aAppCsBondData[mEntryIdx]);
+        }
+#endif /* gAppCsBondDataSize_c */
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+        if (nvmStatus == gNVM_OK_c)
+        {
+            nvmStatus = NvErase((void**)&aAppProxCalData[mEntryIdx]);
+        }
+#endif /* gAppProxCalDataSize_c */
 #else // mirrored
         FLib_MemSet(&aBondingHeader[mEntryIdx], 0, gBleBondIdentityHeaderSize_c);
         nvmStatus = NvSaveOnIdle((void*)&aBondingHeader[mEntryIdx], FALSE);
@@ -274,6 +361,20 @@ bleResult_t App_NvmErase
                 break;
             }
         }
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+        if (nvmStatus == gNVM_OK_c)
+        {
+            FLib_MemSet(&aAppCsBondData[mEntryIdx], 0, sizeof(appCsBondDataBlob_t));
+            nvmStatus = NvSaveOnIdle((void*)&aAppCsBondData[mEntryIdx], FALSE);
+        }
+#endif /* gAppCsBondDataSize_c */
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+        if (nvmStatus == gNVM_OK_c)
+        {
+            FLib_MemSet(&aAppProxCalData[mEntryIdx], 0, sizeof(appProxCalDataBlob_t));
+            nvmStatus = NvSaveOnIdle((void*)&aAppProxCalData[mEntryIdx], FALSE);
+        }
+#endif /* gAppProxCalDataSize_c */
 #endif
         if (nvmStatus != gNVM_OK_c)
         {
@@ -281,6 +382,12 @@ bleResult_t App_NvmErase
         }
 #else /* gAppUseNvm_d */
         FLib_MemSet(&maBondDataBlobs[mEntryIdx], 0, sizeof(bleBondDataBlob_t));
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+        FLib_MemSet(&aAppCsBondData[mEntryIdx], 0, sizeof(appCsBondDataBlob_t));
+#endif /* gAppCsBondDataSize_c */
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+        FLib_MemSet(&aAppProxCalData[mEntryIdx], 0, sizeof(appProxCalDataBlob_t));
+#endif /* gAppProxCalDataSize_c */
 #endif
     }
 
@@ -1003,3 +1110,217 @@ void*    pLocalKey
     return status;
 }
 #endif /* (defined(gAppSecureMode_d) && (gAppSecureMode_d > 0U)) */
+
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+/*! *********************************************************************************
+*\fn           bleResult_t App_NvmWriteCsBondData(uint8_t  mEntryIdx,
+*                void*    pCsBondData)
+*\brief        Write the application Channel Sounding data of a bonded device to NVM.
+*
+*\param  [in]  mEntryIdx              NVM entry index of the bonded device.
+*\param  [in]  pCsBondData            Pointer to gAppCsBondDataSize_c bytes of data.
+* \return    bleResult_t
+*
+********************************************************************************** */
+bleResult_t App_NvmWriteCsBondData
+(
+uint8_t  mEntryIdx,
+void*    pCsBondData
+)
+{
+    bleResult_t status = gBleInvalidParameter_c;
+
+    if(mEntryIdx < (uint8_t)gMaxBondedDevices_c)
+    {
+        status = App_NvmWriteBondBlob((void*)&aAppCsBondData[mEntryIdx], pCsBondData, (uint32_t)sizeof(appCsBondDataBlob_t));
+    }
+    return status;
+}
+
+/*! *********************************************************************************
+*\fn        bleResult_t App_NvmReadCsBondData(uint8_t  mEntryIdx,
+*              void*    pCsBondData)
+*\brief      Read the application Channel Sounding data of a bonded device from NVM.
+*
+*\param[in]  mEntryIdx              NVM entry index of the bonded device.
+*\param[in]  pCsBondData            Pointer to gAppCsBondDataSize_c bytes where the
+*                                   data will be read.
+*
+* \return  bleResult_t            gBleUnavailable_c if nothing was stored.
+********************************************************************************** */
+bleResult_t App_NvmReadCsBondData
+(
+uint8_t  mEntryIdx,
+void*    pCsBondData
+)
+{
+    bleResult_t status = gBleInvalidParameter_c;
+
+    if(mEntryIdx < (uint8_t)gMaxBondedDevices_c)
+    {
+        status = App_NvmReadBondBlob((void*)&aAppCsBondData[mEntryIdx], pCsBondData, (uint32_t)sizeof(appCsBondDataBlob_t));
+    }
+    return status;
+}
+#endif /* gAppCsBondDataSize_c */
+
+#if defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U)
+/*! *********************************************************************************
+*\fn           bleResult_t App_NvmWriteProxCalData(uint8_t  mEntryIdx,
+*               void*    pProxCalData)
+*\brief        Write the RSSI proximity calibration of a bonded device to NVM.
+*
+*\param  [in]  mEntryIdx              NVM entry index of the bonded device.
+*\param  [in]  pProxCalData           Pointer to gAppProxCalDataSize_c bytes of data.
+* \return    bleResult_t
+*
+********************************************************************************** */
+bleResult_t App_NvmWriteProxCalData
+(
+uint8_t  mEntryIdx,
+void*    pProxCalData
+)
+{
+    bleResult_t status = gBleInvalidParameter_c;
+
+    if(mEntryIdx < (uint8_t)gMaxBondedDevices_c)
+    {
+        status = App_NvmWriteBondBlob((void*)&aAppProxCalData[mEntryIdx], pProxCalData, (uint32_t)sizeof(appProxCalDataBlob_t));
+    }
+    return status;
+}
+
+/*! *********************************************************************************
+*\fn        bleResult_t App_NvmReadProxCalData(uint8_t  mEntryIdx,
+*             void*    pProxCalData)
+*\brief      Read the RSSI proximity calibration of a bonded device from NVM.
+*
+*\param[in]  mEntryIdx              NVM entry index of the bonded device.
+*\param[in]  pProxCalData           Pointer to gAppProxCalDataSize_c bytes where the
+*                                   data will be read.
+*
+* \return  bleResult_t            gBleUnavailable_c if nothing was stored.
+********************************************************************************** */
+bleResult_t App_NvmReadProxCalData
+(
+uint8_t  mEntryIdx,
+void*    pProxCalData
+)
+{
+    bleResult_t status = gBleInvalidParameter_c;
+
+    if(mEntryIdx < (uint8_t)gMaxBondedDevices_c)
+    {
+        status = App_NvmReadBondBlob((void*)&aAppProxCalData[mEntryIdx], pProxCalData, (uint32_t)sizeof(appProxCalDataBlob_t));
+    }
+    return status;
+}
+#endif /* gAppProxCalDataSize_c */
+
+
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+#if (defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)) || \
+    (defined(gAppProxCalDataSize_c) && (gAppProxCalDataSize_c > 0U))
+/*! *********************************************************************************
+*\fn           static bleResult_t App_NvmWriteBondBlob(void* pNvmEntry,
+*                                                      void* pData, uint32_t size)
+*\brief        Write an application data set entry of a bonded device to NVM.
+*
+*\param  [in]  pNvmEntry              Entry of the data set array of the bond.
+*\param  [in]  pData                  Pointer to size bytes of data.
+*\param  [in]  size                   Size of one entry of the data set.
+* \return    bleResult_t
+*
+********************************************************************************** */
+static bleResult_t App_NvmWriteBondBlob
+(
+void*    pNvmEntry,
+void*    pData,
+uint32_t size
+)
+{
+    bleResult_t status = gBleSuccess_c;
+#if gAppUseNvm_d
+    NVM_Status_t nvmStatus = gNVM_OK_c;
+
+#if gUnmirroredFeatureSet_d == TRUE
+    void**   ppNvmData = (void**)pNvmEntry;
+    nvmStatus = NvMoveToRam(ppNvmData);
+    if (gNVM_OK_c == nvmStatus)
+    {
+        FLib_MemCpy(*ppNvmData, pData, size);
+#if (!defined (gAppNvSyncSave_d) || (gAppNvSyncSave_d == 0))
+        nvmStatus = NvSaveOnIdle(ppNvmData, FALSE);
+#else
+        /* Opt for immediate write to NVM */
+        nvmStatus = NvSyncSave(ppNvmData, FALSE);
+#endif
+    }
+#else /* gUnmirroredFeatureSet_d */
+    FLib_MemCpy(pNvmEntry, pData, size);
+    nvmStatus = NvSaveOnIdle(pNvmEntry, FALSE);
+#endif /* gUnmirroredFeatureSet_d */
+
+    if (nvmStatus != gNVM_OK_c)
+    {
+        /* An error occurred, gNVM_NoMemory_c, gNVM_InvalidTableEntry_c return error status. */
+        status = gBleNVMError_c;
+    }
+#else /* gAppUseNvm_d */
+    FLib_MemCpy(pNvmEntry, pData, size);
+#endif /* gAppUseNvm_d */
+    return status;
+}
+
+/*! *********************************************************************************
+*\fn        static bleResult_t App_NvmReadBondBlob(void* pNvmEntry,
+*                                                  void* pData, uint32_t size)
+*\brief      Read an application data set entry of a bonded device from NVM.
+*
+*\param[in]  pNvmEntry              Entry of the data set array of the bond.
+*\param[in]  pData                  Pointer to size bytes where the data will be read.
+*\param[in]  size                   Size of one entry of the data set.
+*
+* \return  bleResult_t            gBleUnavailable_c if nothing was stored.
+********************************************************************************** */
+static bleResult_t App_NvmReadBondBlob
+(
+void*    pNvmEntry,
+void*    pData,
+uint32_t size
+)
+{
+    bleResult_t status = gBleSuccess_c;
+#if gAppUseNvm_d
+
+#if gUnmirroredFeatureSet_d == TRUE
+    void**   ppNvmData = (void**)pNvmEntry;
+    if(NULL != *ppNvmData)
+    {
+        FLib_MemCpy(pData, *ppNvmData, size);
+    }
+    else
+    {
+        status = gBleUnavailable_c;
+    }
+#else /* gUnmirroredFeatureSet_d */
+    if(gNVM_OK_c == NvRestoreDataSet(pNvmEntry, FALSE))
+    {
+        FLib_MemCpy(pData, pNvmEntry, size);
+    }
+    else
+    {
+        status = gBleNVMError_c;
+    }
+#endif /* gUnmirroredFeatureSet_d */
+
+#else /* gAppUseNvm_d */
+    FLib_MemCpy(pData, pNvmEntry, size);
+#endif /* gAppUseNvm_d */
+    return status;
+}
+#endif /* gAppCsBondDataSize_c || gAppProxCalDataSize_c */
@@ -377,7 +377,7 @@ STATIC void App_ScanningCallback
         if (pMsgIn != NULL)
         {
             /* Put message in the Host Stack to App queue */
-            (void)MSG_QueueAddTail(&mHostAppInputQueue, pMsgIn);
+            (void)App_QueueHostMessage(pMsgIn);
             
             /* Signal application */
             (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
@@ -26,6 +26,20 @@
 #include "gatt_server_interface.h"
 #include "ble_service_discovery.h"
 #include "ble_config.h"
+#if defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1)
+#include "gatt_cache.h"
+#endif /* defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1) */
+
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+#if defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1)
+/* Read by UUID of the Database Hash: pair length, then the handle and the hash */
+#define mServDiscHashPairLength_c       (2U + GATT_CACHE_HASH_SIZE)
+#define mServDiscHashReadSize_c         (1U + mServDiscHashPairLength_c)
+#endif /* defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1) */
 
 /************************************************************************************
 *************************************************************************************
@@ -50,6 +64,16 @@ typedef struct servDiscInfo_tag
     uint8_t mcPrimaryServices;
     bool_t  mServDiscInProgress;
 
+#if defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1)
+    /* Database Hash read before the discovery of a bonded peer */
+    uint8_t  maHashRead[mServDiscHashReadSize_c];
+    uint16_t mHashReadLength;
+    bool_t   mHashReadInProgress;
+
+    /* NVM index of the bond, valid when mCached */
+    uint8_t  mBondIdx;
+    bool_t   mCached;
+#endif /* defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1) */
 } servDiscInfo_t;
 
 /************************************************************************************
@@ -65,6 +89,13 @@ typedef struct servDiscInfo_tag
 ************************************************************************************/
 static void BleServDisc_Reset(deviceId_t peerDeviceId);
 STATIC void BleServDisc_NewService(deviceId_t peerDeviceId, gattService_t *pService);
+static void BleServDisc_CheckCharacteristic(deviceId_t peerDeviceId, gattCharacteristic_t *pChar);
+#if defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1)
+static bleResult_t BleServDisc_ReadDatabaseHash(deviceId_t peerDeviceId);
+static void BleServDisc_DatabaseHashRead(deviceId_t peerDeviceId, gattProcedureResult_t procedureResult);
+static void BleServDisc_CacheService(deviceId_t peerDeviceId, const gattService_t *pService);
+static void BleServDisc_ReplayCache(deviceId_t peerDeviceId);
+#endif /* defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1) */
 
 /************************************************************************************
 *************************************************************************************
@@ -132,12 +163,19 @@ bleResult_t BleServDisc_Start(deviceId_t peerDeviceId)
         {
             maServDiscInfo[peerDeviceId].mServDiscInProgress = TRUE;
 
-            /* Start Service Discovery*/
-            result = GattClient_DiscoverAllPrimaryServices(
-                        peerDeviceId,
-                        maServDiscInfo[peerDeviceId].mpServiceDiscoveryBuffer,
-                        gMaxServicesCount_d,
-                        &maServDiscInfo[peerDeviceId].mcPrimaryServices);
+#if defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1)
+            /* A bonded peer: discovery, or replay of the cache, once the hash is read */
+            result = BleServDisc_ReadDatabaseHash(peerDeviceId);
+            if (result != gBleSuccess_c)
+#endif /* defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1) */
+            {
+                /* Start Service Discovery*/
+                result = GattClient_DiscoverAllPrimaryServices(
+                            peerDeviceId,
+                            maServDiscInfo[peerDeviceId].mpServiceDiscoveryBuffer,
+                            gMaxServicesCount_d,
+                            &maServDiscInfo[peerDeviceId].mcPrimaryServices);
+            }
         }
         else
         {
@@ -229,6 +267,15 @@ void BleServDisc_Stop(deviceId_t peerDeviceId)
     if (maServDiscInfo[peerDeviceId].mServDiscInProgress)
     {
         maServDiscInfo[peerDeviceId].mServDiscInProgress = FALSE;
+#if defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1)
+        /* A recording not committed by BleServDisc_Finished is incomplete */
+        if (maServDiscInfo[peerDeviceId].mCached)
+        {
+            GattCache_Abort(maServDiscInfo[peerDeviceId].mBondIdx);
+        }
+        maServDiscInfo[peerDeviceId].mCached = FALSE;
+        maServDiscInfo[peerDeviceId].mHashReadInProgress = FALSE;
+#endif /* defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1) */
         BleServDisc_Reset(peerDeviceId);
     }
 }
@@ -262,6 +309,13 @@ void BleServDisc_SignalGattClientEvent
     
     if (pInfo->mServDiscInProgress)
     {
+#if defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1)
+        if (pInfo->mHashReadInProgress && (procedureType == gGattProcReadUsingCharacteristicUuid_c))
+        {
+            BleServDisc_DatabaseHashRead(peerDeviceId, procedureResult);
+        }
+        else
+#endif /* defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1) */
         if (procedureResult == gGattProcError_c)
         {
             BleServDisc_Finished(peerDeviceId, FALSE);
@@ -339,31 +393,8 @@ void BleServDisc_SignalGattClientEvent
                         /* Find next characteristic with descriptors*/
                         while (pInfo->mCurrentCharInDiscoveryIndex < pCurrentService->cNumCharacteristics)
                         {
-#if defined(gBLE51_d) && (gBLE51_d == 1U) && defined(gGattCaching_d) && (gGattCaching_d == 1U)
-                             /* save the handle for the client supported features characteristic */
-                             if (gBleSig_GattClientSupportedFeatures_d == pCurrentChar->value.uuid.uuid16)
-                             {
-                                 gGattActiveClientSupportedFeaturesHandles[peerDeviceId] = pCurrentChar->value.handle - 1U;
-                             }
-
-                             /* save the handle for the service changed characteristic */
-                             if (gBleSig_GattServiceChanged_d == pCurrentChar->value.uuid.uuid16)
-                             {
-                                 mActiveServiceChangedCharHandle[peerDeviceId] = pCurrentChar->value.handle - 1U;
-                                 mActiveServiceChangedCCCDHandle[peerDeviceId] = pCurrentChar->value.handle + 1U;
-                             }
-#endif /* gBLE51_d && gGattCaching_d */
+                            BleServDisc_CheckCharacteristic(peerDeviceId, pCurrentChar);
 
-#if defined(gBLE54_d) && (gBLE54_d == 1U) && defined(gGattSecurityLevelChar_d) && (gGattSecurityLevelChar_d == 1U)
-                            if (pCurrentChar->value.uuid.uuid16 == gBleSig_GattSecurityLevels_d)
-                            {
-                                /* Found GATT Security Levels characteristic - inform application */
-                                servDiscEvent_t event;
-                                event.eventType = gGattSecurityLevelsChar_c;
-                                event.eventData.pCharacteristic = pCurrentChar;
-                                pfServDiscCallback(peerDeviceId, &event);
-                            }
-#endif /* gBLE54_d && gGattSecurityLevelChar_d */
                             /* Check if we have handles available between adjacent characteristics */
                             if (pCurrentChar->value.handle + 2U < (pCurrentChar + 1)->value.handle)
                             {
@@ -415,6 +446,10 @@ void BleServDisc_SignalGattClientEvent
 
                     if (earlyReturn == FALSE)
                     {
+#if defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1)
+                        BleServDisc_CacheService(peerDeviceId, pCurrentService);
+#endif /* defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1) */
+
                         /* Signal Discovery of Service */
                         BleServDisc_NewService(peerDeviceId, pCurrentService);
 
@@ -483,6 +518,13 @@ void BleServDisc_Finished(deviceId_t peerDeviceId, bool_t result)
 {
     servDiscEvent_t event;
 
+#if defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1)
+    if ((result == TRUE) && maServDiscInfo[peerDeviceId].mCached)
+    {
+        (void)GattCache_Commit(maServDiscInfo[peerDeviceId].mBondIdx);
+    }
+#endif /* defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1) */
+
     BleServDisc_Stop(peerDeviceId);
     event.eventType = gDiscoveryFinished_c;
     event.eventData.success = result;
@@ -545,6 +587,283 @@ STATIC void BleServDisc_NewService(deviceId_t peerDeviceId, gattService_t *pServ
     pfServDiscCallback(peerDeviceId, &event);
 }
 
+/*! *********************************************************************************
+*\private
+*\fn           void BleServDisc_CheckCharacteristic(deviceId_t           peerDeviceId,
+*                                                   gattCharacteristic_t *pChar)
+*\brief        Notes the GATT characteristics the host stack or the application
+*              follow, whether discovered or replayed from the cache.
+*
+*\param  [in]  peerDeviceId      The GAP peer Id.
+*\param  [in]  pChar             The characteristic.
+*
+*\retval       void.
+********************************************************************************** */
+static void BleServDisc_CheckCharacteristic(deviceId_t peerDeviceId, gattCharacteristic_t *pChar)
+{
+#if defined(gBLE51_d) && (gBLE51_d == 1U) && defined(gGattCaching_d) && (gGattCaching_d == 1U)
+    /* save the handle for the client supported features characteristic */
+    if (gBleSig_GattClientSupportedFeatures_d == pChar->value.uuid.uuid16)
+    {
+        gGattActiveClientSupportedFeaturesHandles[peerDeviceId] = pChar->value.handle - 1U;
+    }
+
+    /* save the handle for the service changed characteristic */
+    if (gBleSig_GattServiceChanged_d == pChar->value.uuid.uuid16)
+    {
+        mActiveServiceChangedCharHandle[peerDeviceId] = pChar->value.handle - 1U;
+        mActiveServiceChangedCCCDHandle[peerDeviceId] = pChar->value.handle + 1U;
+    }
+#endif /* gBLE51_d && gGattCaching_d */
+
+#if defined(gBLE54_d) && (gBLE54_d == 1U) && defined(gGattSecurityLevelChar_d) && (gGattSecurityLevelChar_d == 1U)
+    if (pChar->value.uuid.uuid16 == gBleSig_GattSecurityLevels_d)
+    {
+        /* Found GATT Security Levels characteristic - inform application */
+        servDiscEvent_t event;
+        event.eventType = gGattSecurityLevelsChar_c;
+        event.eventData.pCharacteristic = pChar;
+        pfServDiscCallback(peerDeviceId, &event);
+    }
+#endif /* gBLE54_d && gGattSecurityLevelChar_d */
+
+    (void)peerDeviceId;
+    (void)pChar;
+}
+
+#if defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1)
+/*! *********************************************************************************
+*\private
+*\fn           bleResult_t BleServDisc_ReadDatabaseHash(deviceId_t peerDeviceId)
+*\brief        Reads the Database Hash of a bonded peer before the discovery.
+*
+*\param  [in]  peerDeviceId      The GAP peer Id.
+*
+*\return       bleResult_t       gBleSuccess_c if the read was started; otherwise
+*                                the peer is discovered without the cache.
+********************************************************************************** */
+static bleResult_t BleServDisc_ReadDatabaseHash(deviceId_t peerDeviceId)
+{
+    servDiscInfo_t *pInfo = &maServDiscInfo[peerDeviceId];
+    bleUuid_t       uuid;
+    bool_t          isBonded = FALSE;
+    uint8_t         nvmIndex = gInvalidNvmIndex_c;
+    bleResult_t     result;
+
+    result = Gap_CheckIfBonded(peerDeviceId, &isBonded, &nvmIndex);
+
+    if ((result != gBleSuccess_c) || (isBonded != TRUE) || (nvmIndex >= GATT_CACHE_BONDS))
+    {
+        result = gBleInvalidState_c;
+    }
+    else
+    {
+        uuid.uuid16 = gBleSig_GattDatabaseHash_d;
+        pInfo->mBondIdx = nvmIndex;
+        pInfo->mHashReadLength = 0U;
+        pInfo->mHashReadInProgress = TRUE;
+
+        result = GattClient_ReadUsingCharacteristicUuid(peerDeviceId,
+                                                        gBleUuidType16_c,
+                                                        &uuid,
+                                                        NULL,
+                                                        pInfo->maHashRead,
+                                                        (uint16_t)mServDiscHashReadSize_c,
+                                                        &pInfo->mHashReadLength);
+        if (result != gBleSuccess_c)
+        {
+            pInfo->mHashReadInProgress = FALSE;
+        }
+    }
+
+    return result;
+}
+
+/*! *********************************************************************************
+*\private
+*\fn           void BleServDisc_DatabaseHashRead(deviceId_t            peerDeviceId,
+*                                                gattProcedureResult_t procedureResult)
+*\brief        Replays the cache on a Database Hash match, otherwise starts the
+*              discovery, recorded if the peer has a Database Hash.
+*
+*\param  [in]  peerDeviceId      The GAP peer Id.
+*\param  [in]  procedureResult   Result of the read by UUID.
+*
+*\retval       void.
+********************************************************************************** */
+static void BleServDisc_DatabaseHashRead(deviceId_t peerDeviceId, gattProcedureResult_t procedureResult)
+{
+    servDiscInfo_t *pInfo = &maServDiscInfo[peerDeviceId];
+    const uint8_t  *pHash = NULL;
+
+    pInfo->mHashReadInProgress = FALSE;
+
+    /* An error here is a peer without a Database Hash, not a failed discovery */
+    if ((procedureResult == gGattProcSuccess_c) &&
+        (pInfo->mHashReadLength >= mServDiscHashReadSize_c) &&
+        (pInfo->maHashRead[0] == mServDiscHashPairLength_c))
+    {
+        pHash = &pInfo->maHashRead[3];
+    }
+
+    if ((pHash != NULL) && GattCache_Match(pInfo->mBondIdx, pHash))
+    {
+        BleServDisc_ReplayCache(peerDeviceId);
+    }
+    else
+    {
+        pInfo->mCached = (pHash != NULL) ? GattCache_Begin(pInfo->mBondIdx, pHash) : FALSE;
+
+        /* Start Service Discovery*/
+        if (GattClient_DiscoverAllPrimaryServices(peerDeviceId,
+                                                  pInfo->mpServiceDiscoveryBuffer,
+                                                  gMaxServicesCount_d,
+                                                  &pInfo->mcPrimaryServices) != gBleSuccess_c)
+        {
+            BleServDisc_Finished(peerDeviceId, FALSE);
+        }
+    }
+}
+
+/*! *********************************************************************************
+*\private
+*\fn           void BleServDisc_CacheService(deviceId_t          peerDeviceId,
+*                                            const gattService_t *pService)
+*\brief        Records a discovered service with its characteristics and
+*              descriptors in the cache entry of the bond.
+*
+*\param  [in]  peerDeviceId      The GAP peer Id.
+*\param  [in]  pService          The service that was discovered.
+*
+*\retval       void.
+********************************************************************************** */
+static void BleServDisc_CacheService(deviceId_t peerDeviceId, const gattService_t *pService)
+{
+    servDiscInfo_t     *pInfo = &maServDiscInfo[peerDeviceId];
+    gattCacheService_t  service;
+    gattCacheChar_t     characteristic;
+    gattCacheDesc_t     descriptor;
+    bool_t              fits;
+    uint8_t             c;
+    uint8_t             d;
+
+    if (!pInfo->mCached)
+    {
+        return;
+    }
+
+    service.startHandle = pService->startHandle;
+    service.endHandle = pService->endHandle;
+    service.uuidType = pService->uuidType;
+    FLib_MemCpy(service.aUuid, &pService->uuid, sizeof(bleUuid_t));
+    fits = GattCache_AddService(pInfo->mBondIdx, &service);
+
+    for (c = 0U; fits && (c < pService->cNumCharacteristics); c++)
+    {
+        const gattCharacteristic_t *pChar = &pService->aCharacteristics[c];
+
+        characteristic.valueHandle = pChar->value.handle;
+        characteristic.properties = pChar->properties;
+        characteristic.uuidType = pChar->value.uuidType;
+        FLib_MemCpy(characteristic.aUuid, &pChar->value.uuid, sizeof(bleUuid_t));
+        fits = GattCache_AddChar(pInfo->mBondIdx, &characteristic);
+
+        for (d = 0U; fits && (d < pChar->cNumDescriptors); d++)
+        {
+            descriptor.handle = pChar->aDescriptors[d].handle;
+            descriptor.uuid16 = pChar->aDescriptors[d].uuid.uuid16;
+            descriptor.uuidType = pChar->aDescriptors[d].uuidType;
+            fits = GattCache_AddDesc(pInfo->mBondIdx, &descriptor);
+        }
+    }
+
+    /* Not cached: the bond is discovered every time */
+    pInfo->mCached = fits;
+}
+
+/*! *********************************************************************************
+*\private
+*\fn           void BleServDisc_ReplayCache(deviceId_t peerDeviceId)
+*\brief        Signals the cached services of the bond as if discovered, then the
+*              end of the discovery.
+*
+*\param  [in]  peerDeviceId      The GAP peer Id.
+*
+*\retval       void.
+********************************************************************************** */
+static void BleServDisc_ReplayCache(deviceId_t peerDeviceId)
+{
+    servDiscInfo_t           *pInfo = &maServDiscInfo[peerDeviceId];
+    const gattCacheService_t *pCached;
+    const gattCacheChar_t    *pChars;
+    const gattCacheDesc_t    *pDescs;
+    gattService_t            *pService;
+    gattCharacteristic_t     *pChar;
+    gattAttribute_t          *pDesc;
+    uint8_t                   s;
+    uint8_t                   c;
+    uint8_t                   d;
+    uint8_t                   descIndex;
+
+    for (s = 0U; s < (uint8_t)gMaxServicesCount_d; s++)
+    {
+        pCached = GattCache_GetService(pInfo->mBondIdx, s, &pChars, &pDescs);
+        if (pCached == NULL)
+        {
+            break;
+        }
+
+        FLib_MemSet(pInfo->mpCharDescriptorBuffer,
+                    0,
+                    sizeof(gattAttribute_t) * (uint32_t)gMaxCharDescriptorsCount_d);
+        FLib_MemSet(pInfo->mpCharDiscoveryBuffer,
+                    0,
+                    sizeof(gattCharacteristic_t) * (uint32_t)gMaxServiceCharCount_d);
+
+        pService = pInfo->mpServiceDiscoveryBuffer + s;
+        FLib_MemSet(pService, 0, sizeof(gattService_t));
+        pService->startHandle = pCached->startHandle;
+        pService->endHandle = pCached->endHandle;
+        pService->uuidType = pCached->uuidType;
+        FLib_MemCpy(&pService->uuid, pCached->aUuid, sizeof(bleUuid_t));
+        pService->aCharacteristics = pInfo->mpCharDiscoveryBuffer;
+
+        /* The recording came from a discovery bounded by the same buffers */
+        descIndex = 0U;
+        for (c = 0U; (c < pCached->cChars) && (c < (uint8_t)gMaxServiceCharCount_d); c++)
+        {
+            pChar = pInfo->mpCharDiscoveryBuffer + c;
+            pChar->properties = pChars[c].properties;
+            pChar->value.handle = pChars[c].valueHandle;
+            pChar->value.uuidType = pChars[c].uuidType;
+            FLib_MemCpy(&pChar->value.uuid, pChars[c].aUuid, sizeof(bleUuid_t));
+            pChar->aDescriptors = pInfo->mpCharDescriptorBuffer + descIndex;
+
+            for (d = 0U; d < pChars[c].cDescs; d++)
+            {
+                if (descIndex < (uint8_t)gMaxCharDescriptorsCount_d)
+                {
+                    pDesc = pInfo->mpCharDescriptorBuffer + descIndex;
+                    pDesc->handle = pDescs->handle;
+                    pDesc->uuidType = gBleUuidType16_c;
+                    pDesc->uuid.uuid16 = pDescs->uuid16;
+                    pChar->cNumDescriptors++;
+                    descIndex++;
+                }
+                pDescs++;
+            }
+
+            BleServDisc_CheckCharacteristic(peerDeviceId, pChar);
+            pService->cNumCharacteristics++;
+        }
+
+        BleServDisc_NewService(peerDeviceId, pService);
+    }
+
+    BleServDisc_Finished(peerDeviceId, TRUE);
+}
+#endif /* defined(gAppServDiscCache_d) && (gAppServDiscCache_d == 1) */
+
 /*! *********************************************************************************
 * @}
 ********************************************************************************** */
@@ -140,6 +140,8 @@
   *  0 = disabled
   *  1 = export local HCI data only
   *  2 = export local HCI data and remote data received via RAS
+  * Data is exported as framed packets (see log_export.h), decode with
+  * tools/log_export_decode.
   */
 #define gAppHciDataLogExport_d          0
 
@@ -224,6 +226,101 @@
    Information available in algorithm result structure */
 #define gAppParseRssiInfo_d                     0
 
+/* Enable/Disable per-link antenna path pruning based on per path quality,
+   counted from the tone quality indicators of the local CS subevent results */
+#define gAppCsAntPathTracking_d                 1
+
+/* Enable/Disable the per-link channel map adaptation based on channel validity history,
+   taken from the tone quality indicators of the local CS subevent results */
+#define gAppCsChannelAdapt_d                    1
+
+/* Persist CS remote capabilities and configuration with the bonding data.
+   Size in bytes of the per bond NVM entry, 0 to disable */
+#define gAppCsBondDataSize_c                    160U
+
+/* Learn a per-device RSSI proximity offset from successful unlock sessions and
+   persist it with the bonding data (prox_cal.c). Size in bytes of the per bond
+   NVM entry, 0 to disable */
+#define gAppProxCalDataSize_c                   8U
+
+/* ProxRssi ring capacities of every engine instance (link, scan, rssi_filter.c),
+   sized from RSSI_RAW_CAP / RSSI_SMOOTH_CAP of rssi_filter.h: about 870 bytes per
+   instance instead of 1860 with the ProxRssi.h defaults. Enough for reads 100 ms
+   apart or more */
+#define PROX_RSSI_RAW_CAP                       (32u)
+#define PROX_RSSI_SMOOTH_CAP                    (40u)
+
+/* Enable/Disable per-stage CS latency histograms ("latency" shell command and
+   A2A opgroup). Requires gAppCsTimeInfo_d */
+#define gAppCsLatencyStats_d                    gAppCsTimeInfo_d
+
+/* Enable/Disable the RSSI flight recorder: raw samples, ProxRssi features and
+   events logged to RAM ("flightrec" shell command, tools/flight_rec_replay.c).
+   The log is kept in RAM only: the linker script of this example reserves no
+   flash for it. To copy it to flash on disconnect, reserve a sector aligned
+   region in the linker script and define FLIGHT_REC_FLASH_ADDR and
+   FLIGHT_REC_FLASH_SIZE here */
+#define gAppFlightRecorder_d                    1
+
+/* Host message drain of BluetoothLEHost_HandleMessages: messages handled per
+   wakeup, alternating between the host stack and the callback queues, and time
+   budget of one pass in microseconds (0 = no time limit). Sized so a CS
+   procedure's meta events and RAS segments clear in one or two passes */
+#define gAppHostMsgDrainMax_c                   (16U)
+#define gAppHostMsgDrainBudgetUs_c              (2000U)
+
+/* Enable/Disable the host queue depth and drain latency counters ("hostq" shell
+   command) */
+#define gAppHostMsgStats_d                      1
+
+/* Enable/Disable the critical and bulk message lanes (msg_lane.c): host stack
+   messages, in arrival order, and the CS procedure callbacks are handled before
+   shell and bonding callbacks. Queueing latency per lane is shown by "hostq" */
+#define gAppMsgLanes_d                          1
+
+/* Enable/Disable zero-copy L2CAP PSM data: the application event points into the
+   host stack message, held with App_RetainHostMessage (msg_ref.c), instead of a
+   copy. Up to MSG_REF_SLOTS messages are held, later ones are copied */
+#define gAppHostMsgRetain_d                     1
+
+/* Enable/Disable proximity driven connection parameters (conn_param.c): long
+   interval + peripheral latency while ProxRssi is FAR, the parameters the link
+   was established with from CANDIDATE and during CS procedures. Define
+   CONN_PARAM_USE_SUBRATE to 1 to use connection subrating for the idle profile */
+#define gAppConnParamMgr_d                      1
+
+/* Enable/Disable proximity tracking before the connection (scan_prox.c): in
+   Passive Entry the bonded peers' advertising is scanned and filtered, and the
+   history is handed over to the link at connection */
+#define gAppScanProx_d                          1
+
+/* Enable/Disable the cache of scanned addresses (addr_cache.c): bond lookup of
+   the identity addresses reported by the accept list scan, once per phone
+   instead of once per report. Needs gAppScanProx_d */
+#define gAppScanAddrCache_d                     1
+
+/* Enable/Disable the Passive Entry advertising scheduler (adv_sched.c): interval
+   and LE Coded set from the time since the last disconnect or unlock and from
+   bonded phones seen nearby by the scan */
+#define gAppAdvSched_d                          1
+
+/* Enable/Disable the application event trace (app_dispatch.c): queueing latency
+   and handler duration per event type, shown by the "dispatch" shell command.
+   The queueing latency needs gAppMsgLanes_d */
+#define gAppDispatchTrace_d                     1
+
+/* Enable/Disable the connect to unlock milestones (unlock_path.c): per phase
+   rolling percentiles and connections lost before the unlock, shown by the
+   "unlockpath" shell command and over the A2A serial interface */
+#define gAppUnlockPath_d                        1
+
+/* Enable/Disable the GATT handle cache per bond (gatt_cache.c): service discovery
+   of a bonded peer reads its Database Hash and, on a match, replays the services
+   found the last time instead of discovering them again. Off: the car anchor
+   acts as a GATT server and does not run service discovery in its current
+   flow. About 1 KB of RAM per bond when enabled, entries are lost at reset */
+#define gAppServDiscCache_d                     0
+
 /* Configure high speed CPU clock (96 MHz) */
 #define gAppHighSystemClockFrequency_d          1
 
@@ -128,6 +128,28 @@ gapScanResponseData_t gAppScanRspData =
     NULL
 };
 
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+/* Passive scan of the bonded peers (Filter Accept List), resolved by the controller */
+static gapScanningParameters_t gProxScanParams =
+{
+    /* type */              gScanTypePassive_c,
+    /* interval */          160U /* 100 ms */,
+    /* window */            48U /* 30 ms */,
+    /* ownAddressType */    gBleAddrTypeRandom_c,
+    /* filterPolicy */      gScanWithFilterAcceptList_c,
+    /* scanning PHY */      gLePhy1MFlag_c
+};
+
+/* Every report is an RSSI sample: no duplicate filtering */
+appScanningParams_t gAppProxScanParams =
+{
+    &gProxScanParams,
+    gGapDuplicateFilteringDisable_c,
+    gGapScanContinuously_d,
+    gGapScanPeriodicDisabled_d
+};
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+
 /* SMP Data */
 /* CCC Pairing Parameters
    For non-CCC Key Fobs application should update fields accordingly
@@ -55,6 +55,28 @@
 #include "app_localization_algo.h"
 #endif /* defined(gAppRunAlgo_d) && (gAppRunAlgo_d == 1U) */
 #include "pde_rade.h"
+#if defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)
+#include "cs_ant_path.h"
+#endif /* defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1) */
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+#include "cs_ch_map.h"
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
+#if (defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)) || \
+    (defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1))
+#include "cs_step_qual.h"
+#endif /* gAppCsAntPathTracking_d || gAppCsChannelAdapt_d */
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+#include "cs_latency.h"
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+#if defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0)
+#include "log_export.h"
+#endif /* defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0) */
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+#include "rssi_integration.h"
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+#include "app_dispatch.h"
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
 
 #include "controller_api.h"
 
@@ -144,6 +166,8 @@ static uint8_t mVerbosityLevel = 2U; /* default: all prints enabled */
 
 #if defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0)
 static SERIAL_MANAGER_WRITE_HANDLE_DEFINE(gDataExportSerialWriteHandle);
+/* A serial write of the log ring is in progress */
+static volatile bool_t mDataLogTxBusy = FALSE;
 #endif /* defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0) */
 
 /************************************************************************************
@@ -185,6 +209,12 @@ button_status_t BleApp_HandleKeys1(void *buttonHandle, button_callback_message_t
 
 #if defined(gA2ASerialInterface_d) && (gA2ASerialInterface_d == 1)
 static void A2A_ProcessCommand(void *pMsg);
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+static void A2A_ProcessCsLatencyCommand(uint8_t opCode, uint16_t len, uint8_t *pPayload);
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+static void A2A_ProcessUnlockPathCommand(uint8_t opCode, uint16_t len, uint8_t *pPayload);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
 #endif /* defined(gA2ASerialInterface_d) && (gA2ASerialInterface_d == 1) */
 
 #if defined(gA2BEnabled_d) && (gA2BEnabled_d > 0U)
@@ -198,7 +228,20 @@ static void BleApp_HandoverEventHandler(appHandoverEvent_t eventType, void *pDat
 static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventType_t eventType);
 #if defined(gAppRunAlgo_d) && (gAppRunAlgo_d == 1U)
 static void BleApp_PrintMeasurementResults(deviceId_t deviceId, localizationAlgoResult_t *pResult);
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+static void BleApp_RecordLatency(deviceId_t deviceId, const localizationAlgoResult_t *pResult);
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
 #endif /* defined(gAppRunAlgo_d) && (gAppRunAlgo_d == 1U) */
+#if (defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)) || \
+    (defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1))
+static void BleApp_CsStepQuality(deviceId_t deviceId, const csMetaEventData_t *pMetaEvent);
+#endif /* gAppCsAntPathTracking_d || gAppCsChannelAdapt_d */
+#if defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)
+static void BleApp_UpdateAntennaPaths(deviceId_t deviceId, const csStepQual_t *pQual);
+#endif /* defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1) */
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+static void BleApp_UpdateChannelMap(deviceId_t deviceId, const csStepQual_t *pQual);
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
 
 #if defined(gAppUseShellInApplication_d) && (gAppUseShellInApplication_d == 1)
 static void BleApp_SetCsConfigParams(appEventData_t* pEventData);
@@ -216,13 +259,14 @@ static void BleApp_HandoverCommHandler(uint8_t opGroup, uint8_t cmdId, uint16_t
 #endif
 
 #if defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0)
-static void App_ExportHciDataLog(void *pData);
+static void App_DataLogKick(void);
+#if (defined(SERIAL_MANAGER_NON_BLOCKING_MODE) && (SERIAL_MANAGER_NON_BLOCKING_MODE > 0U))
+static void App_DataLogTxCallback(void *pParam, serial_manager_callback_message_t *pMsg, serial_manager_status_t status);
+#else
+static void App_DataLogDrain(void *pParam);
+#endif /* SERIAL_MANAGER_NON_BLOCKING_MODE */
 #endif /* defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0) */
 
-#if defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 1)
-static void App_ExportRemoteDataLog(void *pData);
-#endif /* defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 1) */
-
 /************************************************************************************
 *************************************************************************************
 * Public functions
@@ -304,10 +348,30 @@ void BluetoothLEHost_AppInit(void)
 #else /* defined(gAppRunAlgo_d) && (gAppRunAlgo_d == 1U) */
     (void)AppLocalization_Init(gCsDefaultRole_c, BleApp_CsEventHandler, NULL);
 #endif /* defined(gAppRunAlgo_d) && (gAppRunAlgo_d == 1U) */
+#if defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)
+    CsAntPath_Init();
+#endif /* defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1) */
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+    CsChMap_Init();
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
+#if (defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)) || \
+    (defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1))
+    CsStepQual_Init();
+#endif /* gAppCsAntPathTracking_d || gAppCsChannelAdapt_d */
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+    CsLatency_Init();
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+    UnlockPath_Init();
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
 
 #if defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0)
     /* Open write handle */
     (void)SerialManager_OpenWriteHandle(gSerMgrIf2, (serial_write_handle_t)gDataExportSerialWriteHandle);
+    LogExport_Init();
+#if (defined(SERIAL_MANAGER_NON_BLOCKING_MODE) && (SERIAL_MANAGER_NON_BLOCKING_MODE > 0U))
+    (void)SerialManager_InstallTxCallback((serial_write_handle_t)gDataExportSerialWriteHandle, App_DataLogTxCallback, NULL);
+#endif /* SERIAL_MANAGER_NON_BLOCKING_MODE */
 #endif /* defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0) */
 }
 
@@ -789,6 +853,10 @@ void APP_UserInterfaceEventHandler(void *pData)
 void APP_BleEventHandler(void *pData)
 {
     appEventData_t *pEventData = (appEventData_t *)pData;
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+    /* Stateless events are not in the state machine table, trace them here */
+    const uint32_t traceStartUs = AppDispatch_TraceBegin();
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
 
     switch(pEventData->appEvent)
     {
@@ -814,6 +882,10 @@ void APP_BleEventHandler(void *pData)
         case mAppEvt_L2capPsmDataCallback_c:
         {
             App_HandleL2capPsmDataCallback(pEventData);
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+            /* The packet is a view on the host message, drop it with the event */
+            App_ReleaseHostMessage(((appEventL2capPsmData_t *)pEventData->eventData.pData)->pHostMsg);
+#endif /* gAppHostMsgRetain_d */
         }
         break;
 
@@ -844,6 +916,9 @@ void APP_BleEventHandler(void *pData)
         break;
     }
 
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+    AppDispatch_TraceEnd((uint8_t)pEventData->appEvent, traceStartUs);
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
     (void)MEM_BufferFree(pData);
     pData = NULL;
 }
@@ -857,6 +932,10 @@ void APP_BleEventHandler(void *pData)
 void App_HandleShellCmds(void *pData)
 {
     appEventData_t *pEventData = (appEventData_t *)pData;
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+    /* Stateless events are not in the state machine table, trace them here */
+    const uint32_t traceStartUs = AppDispatch_TraceBegin();
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
 
     switch(pEventData->appEvent)
     {
@@ -1087,6 +1166,9 @@ void App_HandleShellCmds(void *pData)
         break;
     }
 
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+    AppDispatch_TraceEnd((uint8_t)pEventData->appEvent, traceStartUs);
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
     (void)MEM_BufferFree(pData);
     pData = NULL;
 }
@@ -1195,6 +1277,10 @@ static void BleApp_SetCsConfigParams(appEventData_t* pEventData)
     csConfigParams.channelSelectionType = pAppCsConfigParams->channelSelectionType;
 
     (void)AppLocalization_WriteConfig(deviceId, &csConfigParams);
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+    /* New reference channel map, restart the channel history */
+    CsChMap_Reset(deviceId, csConfigParams.ch_map);
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
 };
 
 /*! *********************************************************************************
@@ -1220,6 +1306,10 @@ static void BleApp_SetCsProcParams(appEventData_t* pEventData)
     csConfigParams.ant_cfg_index = pAppCsProcParams->antCfgIndex;
 
     (void)AppLocalization_WriteConfig(deviceId, &csConfigParams);
+#if defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)
+    /* New reference configuration for antenna path pruning */
+    CsAntPath_Reset(deviceId, csConfigParams.ant_cfg_index);
+#endif /* defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1) */
 }
 
 /*! *********************************************************************************
@@ -1233,7 +1323,26 @@ static void BleApp_TriggerCsDistanceMeasurement(deviceId_t deviceId)
     /* Reset data before starting a new procedure */
     AppLocalization_ResetPeer(deviceId, FALSE, gInvalidNvmIndex_c);
 
-    result = AppLocalization_SetProcedureParameters(deviceId);
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+    /* Back to the established interval while the parameters are set */
+    RssiIntegration_CsActive(deviceId, TRUE);
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+    if (maPeerInformation[deviceId].csConfigUpdate == TRUE)
+    {
+        appLocalization_rangeCfg_t csConfigParams;
+
+        /* The adapted channel map is applied by creating the configuration again
+           on the link; the procedure parameters follow on gConfigComplete_c */
+        (void)AppLocalization_ReadConfig(deviceId, &csConfigParams);
+        result = AppLocalization_CreateConfig(deviceId, csConfigParams.configId, TRUE);
+    }
+    else
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
+    {
+        result = AppLocalization_SetProcedureParameters(deviceId);
+    }
 
     if (result != gBleSuccess_c)
     {
@@ -1919,6 +2028,26 @@ static void A2A_ProcessCommand(void *pMsg)
         }
         break;
 
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+        case gCsLatencyCommandsOpGroup_c:
+        {
+            A2A_ProcessCsLatencyCommand(pPacket->header.opCode,
+                                        pPacket->header.len,
+                                        pPacket->payload);
+        }
+        break;
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+        case gUnlockPathCommandsOpGroup_c:
+        {
+            A2A_ProcessUnlockPathCommand(pPacket->header.opCode,
+                                         pPacket->header.len,
+                                         pPacket->payload);
+        }
+        break;
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+
         default:
         {
             ; /* No action required */
@@ -1929,6 +2058,133 @@ static void A2A_ProcessCommand(void *pMsg)
     (void)MEM_BufferFree(pMsg);
     return;
 }
+
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+/*! *********************************************************************************
+* \brief        Processes received CS latency statistics commands.
+*
+********************************************************************************** */
+static void A2A_ProcessCsLatencyCommand(uint8_t opCode, uint16_t len, uint8_t *pPayload)
+{
+    uint8_t aRsp[1U + ((uint32_t)csLatencyStageCount_c * 6U * sizeof(uint32_t))];
+    uint8_t *pRsp = &aRsp[1];
+    csLatencyStats_t stats;
+    uint8_t stage;
+
+    if (len >= 1U)
+    {
+        switch (opCode)
+        {
+            case gCsLatencyGetStatsOpCode_c:
+            {
+                aRsp[0] = pPayload[0];
+
+                for (stage = 0U; stage < (uint8_t)csLatencyStageCount_c; stage++)
+                {
+                    (void)CsLatency_GetStats(pPayload[0], (csLatencyStage_t)stage, &stats);
+                    Utils_PackFourByteValue(stats.count, pRsp);
+                    Utils_PackFourByteValue(stats.minUs, &pRsp[4]);
+                    Utils_PackFourByteValue(stats.p50Us, &pRsp[8]);
+                    Utils_PackFourByteValue(stats.p95Us, &pRsp[12]);
+                    Utils_PackFourByteValue(stats.p99Us, &pRsp[16]);
+                    Utils_PackFourByteValue(stats.maxUs, &pRsp[20]);
+                    pRsp = &pRsp[24];
+                }
+
+                A2A_SendCommand(gCsLatencyCommandsOpGroup_c, gCsLatencyGetStatsOpCode_c, aRsp, (uint16_t)sizeof(aRsp));
+            }
+            break;
+
+            case gCsLatencyResetOpCode_c:
+            {
+                CsLatency_Reset(pPayload[0]);
+            }
+            break;
+
+            default:
+            {
+                ; /* No action required */
+            }
+            break;
+        }
+    }
+}
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+/*! *********************************************************************************
+* \brief        Processes received connect to unlock latency commands.
+*
+********************************************************************************** */
+static void A2A_ProcessUnlockPathCommand(uint8_t opCode, uint16_t len, uint8_t *pPayload)
+{
+    uint8_t aRsp[1U + ((uint32_t)unlockPathMilestoneCount_c * 5U * sizeof(uint32_t))];
+    uint8_t *pRsp = &aRsp[1];
+    uint32_t aOffsetMs[unlockPathMilestoneCount_c];
+    unlockPathStats_t stats;
+    uint8_t m;
+
+    switch (opCode)
+    {
+        case gUnlockPathGetStatsOpCode_c:
+        {
+            aRsp[0] = (uint8_t)unlockPathMilestoneCount_c;
+
+            for (m = 0U; m < (uint8_t)unlockPathMilestoneCount_c; m++)
+            {
+                (void)UnlockPath_GetStats((unlockPathMilestone_t)m, &stats);
+                Utils_PackFourByteValue(stats.count, pRsp);
+                Utils_PackFourByteValue(stats.ended, &pRsp[4]);
+                Utils_PackFourByteValue(stats.p50Ms, &pRsp[8]);
+                Utils_PackFourByteValue(stats.p90Ms, &pRsp[12]);
+                Utils_PackFourByteValue(stats.maxMs, &pRsp[16]);
+                pRsp = &pRsp[20];
+            }
+
+            A2A_SendCommand(gUnlockPathCommandsOpGroup_c, gUnlockPathGetStatsOpCode_c, aRsp, (uint16_t)sizeof(aRsp));
+        }
+        break;
+
+        case gUnlockPathGetTimelineOpCode_c:
+        {
+            if (len >= 1U)
+            {
+                aRsp[0] = pPayload[0];
+
+                if (UnlockPath_GetTimeline(pPayload[0], aOffsetMs) == FALSE)
+                {
+                    for (m = 0U; m < (uint8_t)unlockPathMilestoneCount_c; m++)
+                    {
+                        aOffsetMs[m] = UNLOCK_PATH_NOT_REACHED;
+                    }
+                }
+
+                for (m = 0U; m < (uint8_t)unlockPathMilestoneCount_c; m++)
+                {
+                    Utils_PackFourByteValue(aOffsetMs[m], pRsp);
+                    pRsp = &pRsp[4];
+                }
+
+                A2A_SendCommand(gUnlockPathCommandsOpGroup_c, gUnlockPathGetTimelineOpCode_c, aRsp,
+                                (uint16_t)(1U + ((uint32_t)unlockPathMilestoneCount_c * sizeof(uint32_t))));
+            }
+        }
+        break;
+
+        case gUnlockPathResetOpCode_c:
+        {
+            UnlockPath_Reset();
+        }
+        break;
+
+        default:
+        {
+            ; /* No action required */
+        }
+        break;
+    }
+}
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
 #endif /* defined(gA2ASerialInterface_d) && (gA2ASerialInterface_d == 1) */
 
 #if defined(gA2BEnabled_d) && (gA2BEnabled_d > 0U)
@@ -2018,6 +2274,9 @@ static void BleApp_HandoverEventHandler(appHandoverEvent_t eventType, void *pDat
             maPeerInformation[peerDeviceId].deviceId = gInvalidDeviceId_c;
             maPeerInformation[peerDeviceId].csCapabWritten = FALSE;
             maPeerInformation[peerDeviceId].csSecurityEnabled = FALSE;
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+            maPeerInformation[peerDeviceId].csConfigUpdate = FALSE;
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
             mLastConnectFromHandover = FALSE;
             /* UI */
 
@@ -2149,6 +2408,10 @@ static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventTy
     {
         case gCsMetaEvent_c:
         {
+#if (defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)) || \
+    (defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1))
+            BleApp_CsStepQuality(deviceId, (const csMetaEventData_t *)pData);
+#endif /* gAppCsAntPathTracking_d || gAppCsChannelAdapt_d */
         }
         break;
 
@@ -2197,6 +2460,34 @@ static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventTy
         {
             bleResult_t result = gBleSuccess_c;
             maPeerInformation[deviceId].csCapabWritten = TRUE;
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+            BleApp_UnlockPathMark(deviceId, unlockPathCsConfig_c);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+            /* Procedures follow: back to the established interval */
+            RssiIntegration_CsActive(deviceId, TRUE);
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+            if (maPeerInformation[deviceId].csConfigUpdate == TRUE)
+            {
+                /* Channel map applied on a secured link: measure right away */
+                maPeerInformation[deviceId].csConfigUpdate = FALSE;
+                result = AppLocalization_SetProcedureParameters(deviceId);
+
+                if (result != gBleSuccess_c)
+                {
+                    shell_write("\r\nSet Procedure parameters failed.\r\n");
+                }
+                break;
+            }
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
+
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+            /* Remote capabilities are known now, keep them with the bond */
+            BleApp_SaveCsBondData(deviceId);
+#endif /* defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U) */
 
             if (mVerbosityLevel == 2U)
             {
@@ -2229,6 +2520,9 @@ static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventTy
         case gLocalConfigWritten_c:
         {
             maPeerInformation[deviceId].csCapabWritten = TRUE;
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+            BleApp_UnlockPathMark(deviceId, unlockPathCsConfig_c);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
             if (mVerbosityLevel == 2U)
             {
                 shell_write("\r\nLocalization config complete.\r\n");
@@ -2265,6 +2559,9 @@ static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventTy
             if ((maPeerInformation[deviceId].csCapabWritten == TRUE) &&
                 (maPeerInformation[deviceId].csSecurityEnabled == TRUE))
             {
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+                RssiIntegration_CsActive(deviceId, TRUE);
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
                 result = AppLocalization_StartMeasurement(deviceId);
 
                 if (result != gBleSuccess_c)
@@ -2274,12 +2571,21 @@ static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventTy
                         shell_write("\r\nDistance measurement start failed.\r\n");
                     }
                 }
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+                else
+                {
+                    BleApp_UnlockPathMark(deviceId, unlockPathCsStarted_c);
+                }
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
             }
         }
         break;
 
         case gDistanceMeastStarted_c:
         {
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+            BleApp_UnlockPathMark(deviceId, unlockPathCsStarted_c);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
             if (mGlobalRangeSettings.role == gCsRoleReflector_c)
             {
                 if (mVerbosityLevel == 2U)
@@ -2294,6 +2600,14 @@ static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventTy
         {
             uint16_t procCount = AppLocalization_GetProcedureCount(deviceId);
 
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+            /* Last procedure: the link may slow down once its results are transferred */
+            if (procCount == (mRangeSettings[deviceId].maxNumProcedures - 1U))
+            {
+                RssiIntegration_CsActive(deviceId, FALSE);
+            }
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+
             if ((mVerbosityLevel != 0U) || (procCount == (mRangeSettings[deviceId].maxNumProcedures - 1U)))
             {
                 shell_write("\r\n[");
@@ -2579,6 +2893,10 @@ static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventTy
             temp.u32 = ~0x0FU;
             abortReason &= temp.u8;
 
+#if defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1)
+            RssiIntegration_CsActive(deviceId, FALSE);
+#endif /* defined(gAppConnParamMgr_d) && (gAppConnParamMgr_d == 1) */
+
             shell_write("All subsequent CS procedures aborted for deviceId ");
             shell_writeDec((uint8_t)deviceId);
             shell_write("! Abort Reason: ");
@@ -2629,26 +2947,17 @@ static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventTy
                 void *v_ptr;
             }temp = {};
 
-            /* Construct full CS HCI data packet */
-            uint8_t * pCsHciPacket = MEM_BufferAlloc((uint32_t)pHciDataLog->packetSize + gCsHciDataHdrLength_c);
-
-            if (pCsHciPacket != NULL)
+            /* Header, length and subevent opcode of the full CS HCI data packet */
+            uint8_t aCsHciHdr[gCsHciDataHdrLength_c + 1U] =
             {
-                /* Add header, length and subevent opcode */
-                pCsHciPacket[0] = gHciPacketIndicator_c;
-                pCsHciPacket[1] = gHciEventCode_c;
-                pCsHciPacket[2] = pHciDataLog->packetSize;
-                pCsHciPacket[3] = pHciDataLog->opCode;
-
-                /* Add CS data */
-                FLib_MemCpy(&(pCsHciPacket[4]), pHciDataLog->pPacket, (uint32_t)pHciDataLog->packetSize - 1U);
+                gHciPacketIndicator_c, gHciEventCode_c, pHciDataLog->packetSize, pHciDataLog->opCode
+            };
 
-                /* Post callback for serial operation to prevent the addition of delays during the procedure */
-                if (gBleSuccess_c != App_PostCallbackMessage(App_ExportHciDataLog, (void *)pCsHciPacket))
-                {
-                    (void)MEM_BufferFree(pCsHciPacket);
-                }
-            }
+            /* Queue in the log ring, the serial write happens in the background */
+            (void)LogExport_Append(LOG_EXPORT_TYPE_HCI, (uint32_t)TM_GetTimestamp(),
+                                   aCsHciHdr, (uint16_t)sizeof(aCsHciHdr),
+                                   pHciDataLog->pPacket, (uint16_t)(pHciDataLog->packetSize - 1U));
+            App_DataLogKick();
 
             temp.p_u8 = pHciDataLog->pPacket;
 
@@ -2662,22 +2971,10 @@ static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventTy
         {
             uint16_t dataLen = BtcsClient_GetPeerRangingDataSize(deviceId);
 
-            /* Construct full CS HCI data packet */
-            uint8_t * pCsRemoteDataPacket = MEM_BufferAlloc(dataLen + sizeof(uint16_t));
-
-            if (pCsRemoteDataPacket != NULL)
-            {
-                /* Pack data length */
-                Utils_PackTwoByteValue(dataLen, &pCsRemoteDataPacket[0]);
-                /* Pack data */
-                FLib_MemCpy(&pCsRemoteDataPacket[2], pData, dataLen);
-
-                /* Post callback for serial operation to prevent the addition of delays during the procedure */
-                if (gBleSuccess_c != App_PostCallbackMessage(App_ExportRemoteDataLog, (void *)pCsRemoteDataPacket))
-                {
-                    (void)MEM_BufferFree(pCsRemoteDataPacket);
-                }
-            }
+            /* Queue in the log ring, the serial write happens in the background */
+            (void)LogExport_Append(LOG_EXPORT_TYPE_RAS, (uint32_t)TM_GetTimestamp(),
+                                   (const uint8_t *)pData, dataLen, NULL, 0U);
+            App_DataLogKick();
         }
         break;
 #endif /* defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0) */
@@ -2696,6 +2993,10 @@ static void BleApp_CsEventHandler(deviceId_t deviceId, void *pData, appCsEventTy
 ********************************************************************************** */
 static void BleApp_PrintMeasurementResults(deviceId_t deviceId, localizationAlgoResult_t *pResult)
 {
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+    BleApp_RecordLatency(deviceId, pResult);
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+
 #if defined(gAppUseShellInApplication_d) && (gAppUseShellInApplication_d == 1)
     uint16_t procCount = AppLocalization_GetProcedureCount(deviceId);
     uint16_t qInt =0U;
@@ -2900,8 +3201,175 @@ static void BleApp_PrintMeasurementResults(deviceId_t deviceId, localizationAlgo
 #endif /* defined(gHandoverIncluded_d) && (gHandoverIncluded_d == 1) */
 #endif /* defined(gAppUseShellInApplication_d) && (gAppUseShellInApplication_d == 1) */
 }
+
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+/*! *********************************************************************************
+* \brief  Add the stage durations of the last procedure to the latency histograms.
+*         Durations are reported in microseconds, 0 when not measured.
+********************************************************************************** */
+static void BleApp_RecordLatency(deviceId_t deviceId, const localizationAlgoResult_t *pResult)
+{
+    CsLatency_Record(deviceId, csLatencyStageConfig_c, (uint32_t)pResult->csConfigDuration);
+    CsLatency_Record(deviceId, csLatencyStageProcedure_c, (uint32_t)pResult->csProcedureDuration);
+    CsLatency_Record(deviceId, csLatencyStageTransfer_c, (uint32_t)pResult->transferDuration);
+    CsLatency_Record(deviceId, csLatencyStageAlgo_c, (uint32_t)pResult->algoDuration);
+}
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
 #endif /* defined(gAppRunAlgo_d) && (gAppRunAlgo_d == 1U) */
 
+#if (defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)) || \
+    (defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1))
+/*! *********************************************************************************
+* \brief  Count the tone quality of the local subevent results. When the procedure
+*         is done, feed the totals to the antenna path tracker and to the channel
+*         history.
+********************************************************************************** */
+static void BleApp_CsStepQuality(deviceId_t deviceId, const csMetaEventData_t *pMetaEvent)
+{
+    const csSubeventResultEvent_t *pResult;
+    const csSubeventResultContinueEvent_t *pContinue;
+    csStepQual_t qual;
+    uint8_t procedureDone;
+
+    if (pMetaEvent->eventType == gCsMetaEvtSubeventResult_c)
+    {
+        pResult = (const csSubeventResultEvent_t *)pMetaEvent->pEventData;
+        CsStepQual_AddSubevent(deviceId, pResult->numAntennaPaths,
+                               pResult->numStepsReported, pResult->pData);
+        procedureDone = pResult->procedureDoneStatus;
+    }
+    else if (pMetaEvent->eventType == gCsMetaEvtSubeventResultContinue_c)
+    {
+        pContinue = (const csSubeventResultContinueEvent_t *)pMetaEvent->pEventData;
+        CsStepQual_AddSubevent(deviceId, pContinue->numAntennaPaths,
+                               pContinue->numStepsReported, pContinue->pData);
+        procedureDone = pContinue->procedureDoneStatus;
+    }
+    else
+    {
+        return;
+    }
+
+    if (procedureDone == (uint8_t)gCsCompleteResults_c)
+    {
+        if (CsStepQual_Take(deviceId, &qual) == TRUE)
+        {
+#if defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)
+            BleApp_UpdateAntennaPaths(deviceId, &qual);
+#endif /* defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1) */
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+            BleApp_UpdateChannelMap(deviceId, &qual);
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
+        }
+    }
+    else if (procedureDone != (uint8_t)gCsPartialResults_c)
+    {
+        /* Aborted, nothing to learn from the steps so far */
+        CsStepQual_Reset(deviceId);
+    }
+    else
+    {
+        ; /* More subevents to follow */
+    }
+}
+#endif /* gAppCsAntPathTracking_d || gAppCsChannelAdapt_d */
+
+#if defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)
+/*! *********************************************************************************
+* \brief  Feed the per antenna path quality of the last procedure to the tracker and
+*         store the recommended antenna configuration index in the peer
+*         configuration. BleApp_TriggerCsDistanceMeasurement sets the procedure
+*         parameters again from it before the next measurement on the link.
+********************************************************************************** */
+static void BleApp_UpdateAntennaPaths(deviceId_t deviceId, const csStepQual_t *pQual)
+{
+    appLocalization_rangeCfg_t csConfigParams;
+    uint8_t antCfgIdx;
+
+    /* No CDE quality per path in the subevent results: the usable tones decide */
+    if (CsAntPath_Update(deviceId, pQual->numAntennaPaths, pQual->nbSteps,
+                         pQual->aNbValid, NULL) == TRUE)
+    {
+        antCfgIdx = CsAntPath_GetAntCfgIndex(deviceId);
+
+        (void)AppLocalization_ReadConfig(deviceId, &csConfigParams);
+
+        if ((antCfgIdx != CS_ANT_PATH_INVALID_ACI) && (antCfgIdx != csConfigParams.ant_cfg_index))
+        {
+            csConfigParams.ant_cfg_index = antCfgIdx;
+            (void)AppLocalization_WriteConfig(deviceId, &csConfigParams);
+        }
+
+#if defined(gAppUseShellInApplication_d) && (gAppUseShellInApplication_d == 1)
+        if (mVerbosityLevel == 2U)
+        {
+            shell_write("\r\n[");
+            shell_writeDec((uint8_t)deviceId);
+            shell_write("] Antenna paths ACI: ");
+            shell_writeDec(antCfgIdx);
+            if (CsAntPath_IsProbing(deviceId) == TRUE)
+            {
+                shell_write(" (probe)");
+            }
+            shell_write("\r\n");
+        }
+#endif /* defined(gAppUseShellInApplication_d) && (gAppUseShellInApplication_d == 1) */
+    }
+}
+#endif /* defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1) */
+
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+/*! *********************************************************************************
+* \brief  Feed the per channel validity of the last procedure to the channel history
+*         and store the adapted channel map in the peer configuration. The
+*         configuration is created again on the link before the next measurement.
+********************************************************************************** */
+static void BleApp_UpdateChannelMap(deviceId_t deviceId, const csStepQual_t *pQual)
+{
+    appLocalization_rangeCfg_t csConfigParams;
+    uint8_t aChMap[APP_LOCALIZATION_CH_MAP_LEN];
+    uint8_t chCount;
+    uint32_t maxSteps;
+
+    CsChMap_Update(deviceId, pQual->aUsedMap, pQual->aValidMap);
+    chCount = CsChMap_Generate(deviceId, aChMap);
+
+    (void)AppLocalization_ReadConfig(deviceId, &csConfigParams);
+
+    if ((chCount != 0U) && (FLib_MemCmp(aChMap, csConfigParams.ch_map, APP_LOCALIZATION_CH_MAP_LEN) == FALSE))
+    {
+        FLib_MemCpy(csConfigParams.ch_map, aChMap, APP_LOCALIZATION_CH_MAP_LEN);
+
+        /* No need for more main mode steps than one pass over the map; recomputed
+           from the default so that the steps come back as channels recover */
+        maxSteps = (uint32_t)chCount * ((csConfigParams.ch_map_repeat != 0U) ? csConfigParams.ch_map_repeat : 1U);
+        csConfigParams.main_mode_max = mDefaultRangeSettings.main_mode_max;
+        if (maxSteps < csConfigParams.main_mode_max)
+        {
+            csConfigParams.main_mode_max = (uint8_t)maxSteps;
+        }
+        if (csConfigParams.main_mode_max < csConfigParams.main_mode_min)
+        {
+            csConfigParams.main_mode_max = csConfigParams.main_mode_min;
+        }
+
+        (void)AppLocalization_WriteConfig(deviceId, &csConfigParams);
+        maPeerInformation[deviceId].csConfigUpdate = TRUE;
+
+#if defined(gAppUseShellInApplication_d) && (gAppUseShellInApplication_d == 1)
+        if (mVerbosityLevel == 2U)
+        {
+            shell_write("\r\n[");
+            shell_writeDec((uint8_t)deviceId);
+            shell_write("] Channel map adapted: ");
+            shell_writeDec(chCount);
+            shell_write(" channels\r\n");
+        }
+#endif /* defined(gAppUseShellInApplication_d) && (gAppUseShellInApplication_d == 1) */
+    }
+}
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
+
 #if (defined(gAppButtonCnt_c) && (gAppButtonCnt_c > 0))
 /*! *********************************************************************************
 * \brief        Calls BleApp_OP_Start on application task
@@ -2938,39 +3406,93 @@ static void BleApp_HandoverCommHandler(uint8_t opGroup, uint8_t cmdId, uint16_t
 #endif
 
 #if defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0)
+#if (defined(SERIAL_MANAGER_NON_BLOCKING_MODE) && (SERIAL_MANAGER_NON_BLOCKING_MODE > 0U))
+/*! *********************************************************************************
+* \brief        Starts a non-blocking serial write of the next contiguous block of
+*               the data log ring, unless one is already in progress.
+*
+********************************************************************************** */
+static void App_DataLogKick(void)
+{
+    uint8_t *pData = NULL;
+    uint32_t len = 0U;
+
+    OSA_InterruptDisable();
+    if (mDataLogTxBusy == FALSE)
+    {
+        len = LogExport_Peek(&pData);
+        mDataLogTxBusy = (len != 0U) ? TRUE : FALSE;
+    }
+    OSA_InterruptEnable();
+
+    if (len != 0U)
+    {
+        if (kStatus_SerialManager_Success != SerialManager_WriteNonBlocking((serial_write_handle_t)gDataExportSerialWriteHandle, pData, len))
+        {
+            mDataLogTxBusy = FALSE;
+        }
+    }
+}
+
 /*! *********************************************************************************
-* \brief        Handler function for exporting HCI data via serial
+* \brief        Serial write completion: release the written bytes and continue
+*               with the rest of the ring.
 *
 ********************************************************************************** */
-static void App_ExportHciDataLog(void *pData)
+static void App_DataLogTxCallback(void *pParam, serial_manager_callback_message_t *pMsg, serial_manager_status_t status)
 {
-    uint8_t *pCsHciPacket = (uint8_t*)pData;
+    (void)pParam;
+    (void)status;
 
-    /* Serial write full packet */
-    (void)SerialManager_WriteBlocking(gDataExportSerialWriteHandle, pCsHciPacket, (uint32_t)pCsHciPacket[2] + gCsHciDataHdrLength_c);
+    /* On error the bytes are dropped as well, the host sees a sequence gap */
+    LogExport_Consume(pMsg->length);
+    mDataLogTxBusy = FALSE;
 
-    (void)MEM_BufferFree(pCsHciPacket);
+    App_DataLogKick();
+}
+#else
+/*! *********************************************************************************
+* \brief        Schedules the drain of the data log ring on the application task.
+*
+********************************************************************************** */
+static void App_DataLogKick(void)
+{
+    if (mDataLogTxBusy == FALSE)
+    {
+        mDataLogTxBusy = TRUE;
+
+        if (gBleSuccess_c != App_PostCallbackMessage(App_DataLogDrain, NULL))
+        {
+            mDataLogTxBusy = FALSE;
+        }
+    }
 }
-#endif /* defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0) */
 
-#if defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 1)
 /*! *********************************************************************************
-* \brief        Handler function for exporting remote transfer data via serial
+* \brief        Writes the data log ring in contiguous blocks. Without non-blocking
+*               serial support the writes block, but packets are batched and the
+*               CS event path only copies into the ring.
 *
 ********************************************************************************** */
-static void App_ExportRemoteDataLog(void *pData)
+static void App_DataLogDrain(void *pParam)
 {
-    uint8_t *pCsRemotePacket = (uint8_t*)pData;
+    uint8_t *pData = NULL;
+    uint32_t len;
 
-    /* Get data length for the peer */
-    uint16_t dataLen = Utils_ExtractTwoByteValue(pCsRemotePacket);
+    (void)pParam;
 
-    /* Serial write full packet */
-    (void)SerialManager_WriteBlocking(gDataExportSerialWriteHandle, &pCsRemotePacket[2], dataLen);
+    mDataLogTxBusy = FALSE;
 
-    (void)MEM_BufferFree(pCsRemotePacket);
+    len = LogExport_Peek(&pData);
+    while (len != 0U)
+    {
+        (void)SerialManager_WriteBlocking((serial_write_handle_t)gDataExportSerialWriteHandle, pData, len);
+        LogExport_Consume(len);
+        len = LogExport_Peek(&pData);
+    }
 }
-#endif /* defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 1) */
+#endif /* SERIAL_MANAGER_NON_BLOCKING_MODE */
+#endif /* defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0) */
 /*! *********************************************************************************
 * @}
 ********************************************************************************** */
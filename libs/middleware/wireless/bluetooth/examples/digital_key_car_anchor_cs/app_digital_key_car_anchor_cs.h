@@ -34,6 +34,30 @@
 #define gHciEventCode_c         0x3E
 #endif /* defined(gAppHciDataLogExport_d) && (gAppHciDataLogExport_d > 0) */
 
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+/* CS latency statistics over the A2A serial interface */
+#define gCsLatencyCommandsOpGroup_c     0xCE
+/* Request: deviceId. Response: deviceId followed, for each stage (config, procedure,
+   transfer, algorithm), by count, min, p50, p95, p99 and max in us (uint32, LE) */
+#define gCsLatencyGetStatsOpCode_c      0x00
+/* Request: deviceId, 0xFF for all devices. No response */
+#define gCsLatencyResetOpCode_c         0x01
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+/* Connect to unlock latency over the A2A serial interface */
+#define gUnlockPathCommandsOpGroup_c    0xCF
+/* Request: none. Response: milestone count followed, for each milestone (connected,
+   encrypted, service discovery, ready, CS config, CS started, first RSSI, candidate,
+   unlock), by count, ended, p50, p90 and max in ms (uint32, LE) */
+#define gUnlockPathGetStatsOpCode_c     0x00
+/* Request: deviceId. Response: deviceId followed by the time of each milestone from
+   the connection in ms (uint32, LE), 0xFFFFFFFF if not reached */
+#define gUnlockPathGetTimelineOpCode_c  0x01
+/* Request: none. No response */
+#define gUnlockPathResetOpCode_c        0x02
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+
 /************************************************************************************
 *************************************************************************************
 * Public type definitions
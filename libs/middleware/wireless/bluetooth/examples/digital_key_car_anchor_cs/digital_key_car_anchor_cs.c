@@ -59,6 +59,20 @@
 
 #include "channel_sounding.h"
 #include "rssi_integration.h"
+#include "app_dispatch.h"
+#if defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)
+#include "cs_ant_path.h"
+#endif /* defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1) */
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+#include "cs_ch_map.h"
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
+#if (defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)) || \
+    (defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1))
+#include "cs_step_qual.h"
+#endif /* gAppCsAntPathTracking_d || gAppCsChannelAdapt_d */
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+#include "adv_sched.h"
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
 
 /************************************************************************************
 *************************************************************************************
@@ -96,6 +110,26 @@ bool_t   gFilterTestSend = FALSE;
 typedef struct advState_tag{
     bool_t      advOn;
 }advState_t;
+
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+/* Channel Sounding data saved with the bond of a peer */
+typedef struct appCsBondData_tag{
+    uint8_t                                             version;
+    csReadRemoteSupportedCapabilitiesCompleteEvent_t    remoteCaps;
+    appLocalization_rangeCfg_t                          rangeCfg;
+}appCsBondData_t;
+
+/* NVM image of appCsBondData_t, fixed size */
+typedef union appCsBondDataImage_tag{
+    appCsBondData_t     data;
+    uint8_t             raw[gAppCsBondDataSize_c];
+}appCsBondDataImage_t;
+
+App_NvmBondDataSizeCheck(appCsBondDataSizeCheck_t, appCsBondData_t, gAppCsBondDataSize_c);
+
+/* Increment when appCsBondData_t changes, older entries are then ignored */
+#define mAppCsBondDataVersion_c     (0x01U)
+#endif /* defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U) */
 /************************************************************************************
 *************************************************************************************
 * Private memory declarations
@@ -129,6 +163,19 @@ static gattAttribute_t      *mpCharProcBuffer = NULL;
 static bool_t gStopExtAdvSetAfterConnect = FALSE;
 #endif /* defined(gAppLeCodedAdvEnable_d) && (gAppLeCodedAdvEnable_d == 1) */
 static bleDeviceAddress_t mRandomStaticAddr = APP_BD_ADDR;
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+/* Scan for approaching bonded peers running */
+static bool_t mProxScanOn = FALSE;
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+/* Passive Entry advertising profile, chosen from the vehicle context */
+static TIMER_MANAGER_HANDLE_DEFINE(mAdvSchedTimerId);
+static bool_t mAdvSchedTimerValid = FALSE;
+static bool_t mAdvSchedOn = FALSE;
+/* Advertising stopped to restart with a new profile */
+static bool_t mAdvSchedRestart = FALSE;
+static advSchedProfile_t mAdvProfile;
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
 /************************************************************************************
 *************************************************************************************
 * Private functions prototypes
@@ -151,14 +198,42 @@ static void BleApp_L2capPsmControlCallback (l2capControlMessage_t* pMessage);
 
 static void BleApp_AdvertisingCallback (gapAdvertisingEvent_t* pAdvertisingEvent);
 static void BleApp_Advertise(void);
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+static void BleApp_ScanningCallback (gapScanningEvent_t* pScanningEvent);
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+static void BleApp_AdvSchedApply(bool_t restart);
+static void BleApp_AdvSchedTimeout(appCallbackParam_t param);
+static void AdvSchedTimerCallback(void *param);
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
 
 static uint8_t BleApp_GetNoOfActiveConnections(void);
 
-static void BleApp_StateMachineHandler_AppPair(deviceId_t peerDeviceId, appEvent_t event);
-static void BleApp_StateMachineHandler_AppIdle(deviceId_t peerDeviceId, appEvent_t event);
-static void BleApp_StateMachineHandler_AppCCCWaitingForOwnerPairingRequest(deviceId_t peerDeviceId, appEvent_t event);
-static void BleApp_StateMachineHandler_AppCCCPhase2WaitingForResponse(deviceId_t peerDeviceId, appEvent_t event);
-static void BleApp_StateMachineHandler_LocalizationSetup(deviceId_t peerDeviceId, appEvent_t event);
+/* State machine handlers, one per (state, event) row of maAppSmRows */
+static void BleApp_Sm_IdleConnected(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_SendSpakeRequest(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_OwnerPairingEncrypted(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_SendSpakeVerify(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_Phase2Encrypted(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_PairingReady(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_PairPeerOobDataRcv(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_PairLocalOobData(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_PairPeerOobDataReq(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_PairComplete(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_ServiceDiscComplete(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_ServiceDiscFailed(deviceId_t peerDeviceId, uint8_t event);
+#if defined(gAppBtcsClient_d) && (gAppBtcsClient_d == 1U)
+static void BleApp_Sm_LocSetupMtuExchanged(deviceId_t peerDeviceId, uint8_t event);
+#elif defined(gAppBtcsServer_d) && (gAppBtcsServer_d == 1U)
+static void BleApp_Sm_LocSetupPsmCreated(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_LocSetupProcResCfg(deviceId_t peerDeviceId, uint8_t event);
+#endif
+static void BleApp_Sm_FreeCharProcBuffer(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_Sm_LocalizationDisconnected(deviceId_t peerDeviceId, uint8_t event);
+static void BleApp_ProceedToLocalization(deviceId_t peerDeviceId);
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+static uint32_t BleApp_TraceNowUs(void);
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
 
 static void BleApp_GenericCallback_ControllerNotificationEvent(gapGenericEvent_t* pGenericEvent);
 static void BleApp_GenericCallback_HandlePrivacyEvents(gapGenericEvent_t* pGenericEvent);
@@ -172,6 +247,55 @@ static void A2A_SendApplicationData(deviceId_t deviceId);
 #if (defined(gA2BEnabled_d) && (gA2BEnabled_d > 0U))
 static void BleApp_A2BCommHandler(uint8_t opGroup, uint8_t cmdId, uint16_t len, uint8_t *pData);
 #endif /* (defined(gA2BEnabled_d) && (gA2BEnabled_d > 0U)) */
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+static void BleApp_RestoreCsBondData(deviceId_t peerDeviceId, uint8_t nvmIndex);
+#endif /* defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U) */
+
+/* State machine of BleApp_StateMachineHandler: events without a row are ignored */
+static const appDispatchRow_t maAppSmRows[] =
+{
+    {(uint8_t)mAppIdle_c,                             (uint8_t)mAppEvt_PeerConnected_c,                         BleApp_Sm_IdleConnected},
+    {(uint8_t)mAppCCCWaitingForOwnerPairingRequest_c, (uint8_t)mAppEvt_OwnerPairingRequestReceived_c,           BleApp_Sm_SendSpakeRequest},
+    {(uint8_t)mAppCCCWaitingForOwnerPairingRequest_c, (uint8_t)mAppEvt_EncryptionChanged_c,                     BleApp_Sm_OwnerPairingEncrypted},
+    {(uint8_t)mAppCCCPhase2WaitingForResponse_c,      (uint8_t)mAppEvt_ReceivedSPAKEResponse_c,                 BleApp_Sm_SendSpakeVerify},
+    {(uint8_t)mAppCCCPhase2WaitingForResponse_c,      (uint8_t)mAppEvt_EncryptionChanged_c,                     BleApp_Sm_Phase2Encrypted},
+    {(uint8_t)mAppCCCPhase2WaitingForVerify_c,        (uint8_t)mAppEvt_BlePairingReady_c,                       BleApp_Sm_PairingReady},
+    {(uint8_t)mAppCCCReadyForPairing_c,               (uint8_t)mAppEvt_PairingPeerOobDataRcv_c,                 BleApp_Sm_PairPeerOobDataRcv},
+    {(uint8_t)mAppPair_c,                             (uint8_t)mAppEvt_PairingLocalOobData_c,                   BleApp_Sm_PairLocalOobData},
+    {(uint8_t)mAppPair_c,                             (uint8_t)mAppEvt_PairingPeerOobDataRcv_c,                 BleApp_Sm_PairPeerOobDataRcv},
+    {(uint8_t)mAppPair_c,                             (uint8_t)mAppEvt_PairingPeerOobDataReq_c,                 BleApp_Sm_PairPeerOobDataReq},
+    {(uint8_t)mAppPair_c,                             (uint8_t)mAppEvt_PairingComplete_c,                       BleApp_Sm_PairComplete},
+    {(uint8_t)mAppServiceDisc_c,                      (uint8_t)mAppEvt_ServiceDiscoveryComplete_c,              BleApp_Sm_ServiceDiscComplete},
+    {(uint8_t)mAppServiceDisc_c,                      (uint8_t)mAppEvt_ServiceDiscoveryFailed_c,                BleApp_Sm_ServiceDiscFailed},
+#if defined(gAppBtcsClient_d) && (gAppBtcsClient_d == 1U)
+    {(uint8_t)mAppLocalizationSetup_c,                (uint8_t)mAppEvt_ExchangeMtuComplete_c,                   BleApp_Sm_LocSetupMtuExchanged},
+#elif defined(gAppBtcsServer_d) && (gAppBtcsServer_d == 1U)
+    {(uint8_t)mAppLocalizationSetup_c,                (uint8_t)mAppEvt_PsmChannelCreated_c,                     BleApp_Sm_LocSetupPsmCreated},
+    {(uint8_t)mAppLocalizationSetup_c,                (uint8_t)mAppEvt_BtcsRangingProcResCfg_c,                 BleApp_Sm_LocSetupProcResCfg},
+#endif
+    {(uint8_t)mAppRunning_c,                          (uint8_t)mAppEvt_WriteCharacteristicDescriptorComplete_c, BleApp_Sm_FreeCharProcBuffer},
+    {(uint8_t)mAppRunning_c,                          (uint8_t)mAppEvt_PeerDisconnected_c,                      BleApp_Sm_LocalizationDisconnected},
+    {(uint8_t)mAppLocalization_c,                     (uint8_t)mAppEvt_WriteCharacteristicDescriptorComplete_c, BleApp_Sm_FreeCharProcBuffer},
+    {(uint8_t)mAppLocalization_c,                     (uint8_t)mAppEvt_PeerDisconnected_c,                      BleApp_Sm_LocalizationDisconnected},
+};
+
+/* (state, event) -> row, filled in BluetoothLEHost_Initialized */
+static uint8_t maAppSmIndex[(uint32_t)mAppStateCount_c * (uint32_t)mAppEvt_Count_c];
+
+static appDispatchTable_t mAppSmTable =
+{
+    maAppSmRows,
+    (uint8_t)NumberOfElements(maAppSmRows),
+    (uint8_t)mAppStateCount_c,
+    (uint8_t)mAppEvt_Count_c,
+    maAppSmIndex
+};
+
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+/* Events beyond the trace would be dispatched but never traced */
+_Static_assert((uint32_t)mAppEvt_Count_c <= APP_DISPATCH_TRACE_EVENTS,
+               "APP_DISPATCH_TRACE_EVENTS below the application event count");
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
 
 /************************************************************************************
 *************************************************************************************
@@ -492,6 +616,10 @@ void BleApp_ConnectionCallback (deviceId_t peerDeviceId, gapConnectionEvent_t* p
 #if defined(gAppLeCodedAdvEnable_d) && (gAppLeCodedAdvEnable_d == 1)
             bleResult_t result = gBleSuccess_c;
 #endif /* defined(gAppLeCodedAdvEnable_d) && (gAppLeCodedAdvEnable_d == 1) */
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+            /* Start of the connect to unlock path */
+            BleApp_UnlockPathMark(peerDeviceId, unlockPathConnected_c);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
             maPeerInformation[peerDeviceId].isBonded = FALSE;
             maPeerInformation[peerDeviceId].nvmIndex = gInvalidNvmIndex_c;
 
@@ -506,6 +634,14 @@ void BleApp_ConnectionCallback (deviceId_t peerDeviceId, gapConnectionEvent_t* p
 
             (void)Gap_CheckIfBonded(peerDeviceId, &maPeerInformation[peerDeviceId].isBonded, &maPeerInformation[peerDeviceId].nvmIndex);
 
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+            /* Restore the CS capabilities and configuration saved with the bond */
+            if (maPeerInformation[peerDeviceId].isBonded == TRUE)
+            {
+                BleApp_RestoreCsBondData(peerDeviceId, maPeerInformation[peerDeviceId].nvmIndex);
+            }
+#endif /* defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U) */
+
             /* Save address used during discovery if controller privacy was used. */
             if (pConnectionEvent->eventData.connectedEvent.localRpaUsed)
             {
@@ -530,10 +666,21 @@ void BleApp_ConnectionCallback (deviceId_t peerDeviceId, gapConnectionEvent_t* p
 #if defined(gHandoverIncluded_d) && (gHandoverIncluded_d == 1)
             mLastConnectFromHandover = FALSE;
 #endif
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+            /* The link follows the peer from now on */
+            if (mProxScanOn == TRUE)
+            {
+                (void)Gap_StopScanning();
+            }
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
 
             /* RSSI Integration: Initialize and notify device connected */
             RssiIntegration_Init();
             RssiIntegration_DeviceConnected(peerDeviceId);
+            RssiIntegration_ConnParamsEstablished(peerDeviceId,
+                                                  pConnectionEvent->eventData.connectedEvent.connParameters.connInterval,
+                                                  pConnectionEvent->eventData.connectedEvent.connParameters.connLatency,
+                                                  pConnectionEvent->eventData.connectedEvent.connParameters.supervisionTimeout);
 
             BleApp_StateMachineHandler(maPeerInformation[peerDeviceId].deviceId, mAppEvt_PeerConnected_c);
             /* UI */
@@ -566,6 +713,19 @@ void BleApp_ConnectionCallback (deviceId_t peerDeviceId, gapConnectionEvent_t* p
             locConfig.maxPeriodBetweenProcedures = (uint16_t)procInterval;
 
             (void)AppLocalization_WriteConfig(peerDeviceId, &locConfig); 
+#if defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)
+            /* Antenna path pruning starts from the configured ACI on every connection */
+            CsAntPath_Reset(peerDeviceId, locConfig.ant_cfg_index);
+#endif /* defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1) */
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+            /* Channel history starts from the configured map on every connection */
+            CsChMap_Reset(peerDeviceId, locConfig.ch_map);
+            maPeerInformation[peerDeviceId].csConfigUpdate = FALSE;
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
+#if (defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)) || \
+    (defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1))
+            CsStepQual_Reset(peerDeviceId);
+#endif /* gAppCsAntPathTracking_d || gAppCsChannelAdapt_d */
             AppLocalization_SetConnectionInterval(peerDeviceId, pConnectionEvent->eventData.connectedEvent.connParameters.connInterval);
             /* Read the PHY on which the connection was establihed */
             (void)Gap_LeReadPhy(peerDeviceId);
@@ -579,11 +739,32 @@ void BleApp_ConnectionCallback (deviceId_t peerDeviceId, gapConnectionEvent_t* p
         case gConnEvtDisconnected_c:
         {
             maPeerInformation[peerDeviceId].disconReason = pConnectionEvent->eventData.disconnectedEvent.reason;
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+            /* The adapted channel map belongs to this connection */
+            maPeerInformation[peerDeviceId].csConfigUpdate = FALSE;
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
 
             /* RSSI Integration: Notify device disconnected */
             RssiIntegration_DeviceDisconnected(peerDeviceId);
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+            UnlockPath_Disconnected(peerDeviceId);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+            /* Save the last CS configuration before the localization data is reset */
+            BleApp_SaveCsBondData(peerDeviceId);
+#endif /* defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U) */
 
             BleApp_StateMachineHandler(peerDeviceId, mAppEvt_PeerDisconnected_c);
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+            /* The owner may turn back: advertise again, fast for a while */
+            AdvSched_Disconnected((uint32_t)(TM_GetTimestamp() / 1000000U));
+            if ((mAdvSchedOn == TRUE) && (0U == BleApp_GetNoOfActiveConnections()))
+            {
+                BleApp_AdvSchedApply(FALSE);
+                BleApp_Start();
+            }
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
 #if defined(gHandoverIncluded_d) && (gHandoverIncluded_d == 1)
             mLastConnectFromHandover = FALSE;
             gFilterShellVal = (uint16_t)gNoFilter_c;
@@ -630,6 +811,14 @@ void BleApp_ConnectionCallback (deviceId_t peerDeviceId, gapConnectionEvent_t* p
 #if defined(gAppUseBonding_d) && (gAppUseBonding_d == 1U)
         case gConnEvtEncryptionChanged_c:
         {
+            /* RSSI Integration: unlocks on an authenticated link calibrate the device */
+            if (pConnectionEvent->eventData.encryptionChangedEvent.newEncryptionState == TRUE)
+            {
+                RssiIntegration_LinkEncrypted(peerDeviceId);
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+                BleApp_UnlockPathMark(peerDeviceId, unlockPathEncrypted_c);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+            }
             BleApp_StateMachineHandler(peerDeviceId, mAppEvt_EncryptionChanged_c);
         }
         break;
@@ -640,6 +829,20 @@ void BleApp_ConnectionCallback (deviceId_t peerDeviceId, gapConnectionEvent_t* p
         {
             /* Update connection interval when a Parameter Update procedure completes */
             AppLocalization_SetConnectionInterval(peerDeviceId, pConnectionEvent->eventData.connectionUpdateComplete.connInterval);
+
+            /* RSSI Integration: outcome of a proximity driven parameter request, or the central's own */
+            RssiIntegration_ConnParamsUpdated(peerDeviceId,
+                                              (pConnectionEvent->eventData.connectionUpdateComplete.status == gBleSuccess_c) ? TRUE : FALSE,
+                                              pConnectionEvent->eventData.connectionUpdateComplete.connInterval,
+                                              pConnectionEvent->eventData.connectionUpdateComplete.connLatency);
+        }
+        break;
+
+        case gConnEvtLeSubrateChange_c:
+        {
+            RssiIntegration_SubrateChanged(peerDeviceId,
+                                           (pConnectionEvent->eventData.gapSubrateChangeEvent.status == gBleSuccess_c) ? TRUE : FALSE,
+                                           pConnectionEvent->eventData.gapSubrateChangeEvent.subrateFactor);
         }
         break;
 
@@ -700,7 +903,21 @@ void BleApp_PE_Start(void)
     mOwnerPairingMode = FALSE;
 #endif /* defined(gAppLeCodedAdvEnable_d) && (gAppLeCodedAdvEnable_d == 1) */
     gAppAdvParams.pGapAdvData = &gAppAdvertisingDataEmpty;
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+    mAdvSchedOn = TRUE;
+    AdvSched_Init((uint32_t)(TM_GetTimestamp() / 1000000U));
+    BleApp_AdvSchedApply(FALSE);
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
     BleApp_Start();
+
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+    /* Follow bonded phones approaching before they connect */
+    RssiIntegration_ScanStarted();
+    if (mProxScanOn == FALSE)
+    {
+        (void)BluetoothLEHost_StartScanning(&gAppProxScanParams, BleApp_ScanningCallback);
+    }
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
 }
 
 /*! *********************************************************************************
@@ -713,6 +930,14 @@ void BleApp_OP_Start(void)
 #if defined(gAppLeCodedAdvEnable_d) && (gAppLeCodedAdvEnable_d == 1)
     mOwnerPairingMode = TRUE;
 #endif /* defined(gAppLeCodedAdvEnable_d) && (gAppLeCodedAdvEnable_d == 1) */
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+    /* Owner pairing advertises at the CCC interval */
+    mAdvSchedOn = FALSE;
+    mAdvSchedRestart = FALSE;
+    (void)TM_Stop((timer_handle_t)mAdvSchedTimerId);
+    gLegacyAdvParams.minInterval = gcAdvertisingIntervalCCC_1M_c;
+    gLegacyAdvParams.maxInterval = gcAdvertisingIntervalCCC_1M_c;
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
     gAppAdvParams.pGapAdvData = &gAppAdvertisingData;
     BleApp_Start();
 }
@@ -724,7 +949,18 @@ void BleApp_OP_Start(void)
 void BleApp_StopDiscovery(void)
 {
     gCurrentAdvHandle = gNoAdvSetHandle_c;
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+    mAdvSchedOn = FALSE;
+    mAdvSchedRestart = FALSE;
+    (void)TM_Stop((timer_handle_t)mAdvSchedTimerId);
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
     (void)Gap_StopExtAdvertising(0xFF);
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+    if (mProxScanOn == TRUE)
+    {
+        (void)Gap_StopScanning();
+    }
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
 }
 
 /*! *********************************************************************************
@@ -752,113 +988,8 @@ void BleApp_Disconnect(void)
 ********************************************************************************** */
 void BleApp_StateMachineHandler(deviceId_t peerDeviceId, appEvent_t event)
 {
-    switch (maPeerInformation[peerDeviceId].appState)
-    {
-        case mAppIdle_c:
-        {
-            BleApp_StateMachineHandler_AppIdle(peerDeviceId, event);
-        }
-        break;
-
-        case mAppCCCWaitingForOwnerPairingRequest_c:
-        {
-            BleApp_StateMachineHandler_AppCCCWaitingForOwnerPairingRequest(peerDeviceId, event);
-        }
-        break;
-
-        case mAppCCCPhase2WaitingForResponse_c:
-        {
-            BleApp_StateMachineHandler_AppCCCPhase2WaitingForResponse(peerDeviceId, event);
-        }
-        break;
-
-        case mAppCCCPhase2WaitingForVerify_c:
-        {
-            if (event == mAppEvt_BlePairingReady_c)
-            {
-                maPeerInformation[peerDeviceId].appState = mAppCCCReadyForPairing_c;
-            }
-        }
-        break;
-
-        case mAppCCCReadyForPairing_c:
-        {
-            if ( event == mAppEvt_PairingPeerOobDataRcv_c )
-            {
-                mCurrentPeerId = peerDeviceId;
-                (void)Gap_LeScGetLocalOobData();
-                maPeerInformation[peerDeviceId].appState = mAppPair_c;
-            }
-        }
-        break;
-
-        case mAppPair_c:
-        {
-            BleApp_StateMachineHandler_AppPair(peerDeviceId,event);
-        }
-        break;
-
-        case mAppServiceDisc_c:
-        {
-            if (event == mAppEvt_ServiceDiscoveryComplete_c)
-            {
-                /* Moving to Running State*/
-                maPeerInformation[peerDeviceId].appState = mAppRunning_c;
-#if gAppUseBonding_d
-                /* Write data in NVM */
-                (void)Gap_SaveCustomPeerInformation(maPeerInformation[peerDeviceId].deviceId,
-                                                    (void *)&maPeerInformation[peerDeviceId].customInfo, 0,
-                                                    (uint16_t)sizeof(appCustomInfo_t));
-#endif
-            }
-            else if (event == mAppEvt_ServiceDiscoveryFailed_c)
-            {
-                (void)Gap_Disconnect(peerDeviceId);
-            }
-            else
-            {
-                /* ignore other event types */
-            }
-        }
-        break;
-
-        case mAppLocalizationSetup_c:
-        {
-            BleApp_StateMachineHandler_LocalizationSetup(peerDeviceId, event);
-        }
-        break;
-
-        case mAppRunning_c:
-        case mAppLocalization_c:
-        {
-            if (event == mAppEvt_WriteCharacteristicDescriptorComplete_c)
-            {
-                (void)MEM_BufferFree(mpCharProcBuffer);
-                mpCharProcBuffer = NULL;
-            }
-            else if (event == mAppEvt_PeerDisconnected_c)
-            {
-                AppLocalization_ResetPeer(peerDeviceId, TRUE, maPeerInformation[peerDeviceId].nvmIndex);
-#if defined (gAppRunAlgo_d) && (gAppRunAlgo_d == 1U)
-                AppLocalizationAlgo_ResetPeer(peerDeviceId);
-#endif /* defined (gAppRunAlgo_d) && (gAppRunAlgo_d == 1U) */
-#if defined(gHandoverIncluded_d) && (gHandoverIncluded_d == 1)
-                gHandoverDeviceId = gInvalidDeviceId_c;
-#endif
-            }
-            else
-            {
-                /* ignore other event types */
-            }
-        }
-        break;
-
-        default:
-        {
-            ; /* No action required */
-        }
-        break;
-    }
+    /* Handler of (state, event), see maAppSmRows */
+    (void)AppDispatch_Run(&mAppSmTable, (uint8_t)maPeerInformation[peerDeviceId].appState, peerDeviceId, (uint8_t)event);
 
     /* Handle disconnect event in all application states. */
     if (event == mAppEvt_PeerDisconnected_c)
@@ -1029,6 +1160,65 @@ bleResult_t SendBTCSRangingProcResCfg
 }
 #endif /* defined(gAppBtcsClient_d) && (gAppBtcsClient_d == 1U) */
 
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+/*! *********************************************************************************
+ * \brief        Saves the cached remote CS capabilities and the current CS
+ *               configuration of a bonded peer in NVM. The NVM entry is only
+ *               written when its content changed.
+ *
+ * \param[in]    peerDeviceId        Peer device ID.
+ ********************************************************************************** */
+void BleApp_SaveCsBondData(deviceId_t peerDeviceId)
+{
+    uint8_t nvmIndex = maPeerInformation[peerDeviceId].nvmIndex;
+    csReadRemoteSupportedCapabilitiesCompleteEvent_t *pRemoteCaps = NULL;
+    appCsBondDataImage_t *pBlob = NULL;
+
+    if ((maPeerInformation[peerDeviceId].isBonded == TRUE) && (nvmIndex != gInvalidNvmIndex_c))
+    {
+        pRemoteCaps = AppLocalization_GetRemoteCachedSupportedCapabilities(nvmIndex);
+    }
+
+    if (pRemoteCaps != NULL)
+    {
+        /* New image followed by the stored one */
+        pBlob = MEM_BufferAlloc(2U * sizeof(appCsBondDataImage_t));
+    }
+
+    if (pBlob != NULL)
+    {
+        FLib_MemSet(pBlob, 0U, sizeof(appCsBondDataImage_t));
+        pBlob[0].data.version = mAppCsBondDataVersion_c;
+        FLib_MemCpy(&pBlob[0].data.remoteCaps, pRemoteCaps, sizeof(csReadRemoteSupportedCapabilitiesCompleteEvent_t));
+        (void)AppLocalization_ReadConfig(peerDeviceId, &pBlob[0].data.rangeCfg);
+        /* The algorithm buffer is allocated at runtime */
+        pBlob[0].data.rangeCfg.csAlgoBuf = NULL;
+
+        /* Spare the flash when nothing changed since the last save */
+        if ((App_NvmReadCsBondData(nvmIndex, &pBlob[1]) != gBleSuccess_c) ||
+            (FLib_MemCmp(&pBlob[0], &pBlob[1], sizeof(appCsBondDataImage_t)) == FALSE))
+        {
+            (void)App_NvmWriteCsBondData(nvmIndex, &pBlob[0]);
+        }
+
+        (void)MEM_BufferFree(pBlob);
+    }
+}
+#endif /* defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U) */
+
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+/*! *********************************************************************************
+ * \brief        Time stamps a milestone of the connect to unlock path of a peer.
+ *
+ * \param[in]    peerDeviceId        Peer device ID.
+ * \param[in]    milestone           Milestone reached.
+ ********************************************************************************** */
+void BleApp_UnlockPathMark(deviceId_t peerDeviceId, unlockPathMilestone_t milestone)
+{
+    UnlockPath_Mark(peerDeviceId, milestone, (uint32_t)(TM_GetTimestamp() / 1000U));
+}
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+
 /*! *********************************************************************************
  * \brief        Configures BLE Stack after initialization
  *
@@ -1069,6 +1259,18 @@ void BluetoothLEHost_Initialized(void)
         mL2caTimerValid = TRUE;
     }
 
+    /* Index the state machine before the first connection */
+    (void)AppDispatch_Build(&mAppSmTable);
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+    AppDispatch_SetTraceHooks(BleApp_TraceNowUs, App_GetMsgPostedUs);
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+    if (TM_Open(mAdvSchedTimerId) == kStatus_TimerSuccess)
+    {
+        mAdvSchedTimerValid = TRUE;
+    }
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
+
     /* Inform the user interface handler that Bluetooth application configuration done */
     if(mpfBleUserInterfaceEventHandler != NULL)
     {
@@ -1169,192 +1371,212 @@ static void BleApp_GenericCallback_ControllerNotificationEvent(gapGenericEvent_t
 }
 
 /*! *********************************************************************************
-* \brief        Handler of the mAppCCCPhase2WaitingForResponse_c state for
-*               BleApp_StateMachineHandler.
+* \brief        State machine handlers, one per row of maAppSmRows.
 *
 * \param[in]    peerDeviceId        Peer device ID.
 * \param[in]    event               Event type.
 ************************************************************************************/
-static void BleApp_StateMachineHandler_AppCCCPhase2WaitingForResponse(deviceId_t peerDeviceId, appEvent_t event)
+static void BleApp_Sm_IdleConnected(deviceId_t peerDeviceId, uint8_t event)
 {
-    if (event == mAppEvt_ReceivedSPAKEResponse_c)
-    {
-        /* SPAKE2+ Flow: Send Verify Command */
-        /* Dummy data - replace with calls to get actual data */
-        uint16_t payloadLen = gDummyPayloadLength_c;
-        uint8_t payload[gDummyPayloadLength_c] = gDummyPayload_c;
-        bleResult_t status = CCCPhase2_SendSPAKEVerify(peerDeviceId, payload, payloadLen);
-        if (status == gBleSuccess_c)
-        {
-            maPeerInformation[peerDeviceId].appState = mAppCCCPhase2WaitingForVerify_c;
-        }
-    }
-    else if (event == mAppEvt_EncryptionChanged_c)
-    {
-        maPeerInformation[peerDeviceId].isLinkEncrypted = TRUE;
-        maPeerInformation[peerDeviceId].appState = mAppRunning_c;
-    }
-    else
-    {
-        /* For MISRA compliance */
-    }
+    (void)event;
+    maPeerInformation[peerDeviceId].appState = mAppCCCWaitingForOwnerPairingRequest_c;
 }
 
-/*! *********************************************************************************
-* \brief        Handler of the mAppCCCWaitingForOwnerPairingRequest_c state for
-*               BleApp_StateMachineHandler.
-*
-* \param[in]    peerDeviceId        Peer device ID.
-* \param[in]    event               Event type.
-************************************************************************************/
-static void BleApp_StateMachineHandler_AppPair(deviceId_t peerDeviceId, appEvent_t event)
+static void BleApp_Sm_SendSpakeRequest(deviceId_t peerDeviceId, uint8_t event)
 {
-    if ( event == mAppEvt_PairingLocalOobData_c )
-    {
-        (void)CCC_FirstApproachRsp(peerDeviceId, gaAppOwnDiscAddress, &maPeerInformation[peerDeviceId].oobData);
-    }
-    else if ( event == mAppEvt_PairingPeerOobDataRcv_c )
-    {
-        mCurrentPeerId = peerDeviceId;
-        (void)Gap_LeScGetLocalOobData();
-    }
-    else if (event == mAppEvt_PairingReqRcv_c)
-    {
-        /* No action required */
-    }
-    else if ( event == mAppEvt_PairingPeerOobDataReq_c )
-    {
-        (void)Gap_LeScSetPeerOobData(peerDeviceId, &maPeerInformation[peerDeviceId].peerOobData);
-    }
-    else if ( event == mAppEvt_PairingComplete_c )
-    {
-        FLib_MemSet(&maPeerInformation[peerDeviceId].oobData, 0x00, sizeof(gapLeScOobData_t));
-        FLib_MemSet(&maPeerInformation[peerDeviceId].peerOobData, 0x00, sizeof(gapLeScOobData_t));
-        maPeerInformation[peerDeviceId].appState = mAppRunning_c;
-    }
-    else
+    bleResult_t status;
+
+    /* Move to CCC Phase 2 */
+    /* Dummy data - replace with calls to get actual data */
+    uint16_t payloadLen = gDummyPayloadLength_c;
+    uint8_t payload[gDummyPayloadLength_c] = gDummyPayload_c;
+
+    (void)event;
+    status = CCCPhase2_SendSPAKERequest(peerDeviceId, payload, payloadLen);
+
+    if (status == gBleSuccess_c)
     {
-        /* For MISRA compliance */
+        maPeerInformation[peerDeviceId].appState = mAppCCCPhase2WaitingForResponse_c;
     }
 }
 
-/*! *********************************************************************************
-* \brief        Handler of the mAppIdle_c state for BleApp_StateMachineHandler.
-*
-* \param[in]    peerDeviceId        Peer device ID.
-* \param[in]    event               Event type.
-************************************************************************************/
-static void BleApp_StateMachineHandler_AppIdle(deviceId_t peerDeviceId, appEvent_t event)
+static void BleApp_Sm_OwnerPairingEncrypted(deviceId_t peerDeviceId, uint8_t event)
 {
-    if (event == mAppEvt_PeerConnected_c)
+    (void)event;
+    maPeerInformation[peerDeviceId].isLinkEncrypted = TRUE;
+    maPeerInformation[peerDeviceId].appState = mAppLocalizationSetup_c;
+}
+
+static void BleApp_Sm_SendSpakeVerify(deviceId_t peerDeviceId, uint8_t event)
+{
+    /* SPAKE2+ Flow: Send Verify Command */
+    /* Dummy data - replace with calls to get actual data */
+    uint16_t payloadLen = gDummyPayloadLength_c;
+    uint8_t payload[gDummyPayloadLength_c] = gDummyPayload_c;
+    bleResult_t status;
+
+    (void)event;
+    status = CCCPhase2_SendSPAKEVerify(peerDeviceId, payload, payloadLen);
+    if (status == gBleSuccess_c)
     {
-        maPeerInformation[peerDeviceId].appState = mAppCCCWaitingForOwnerPairingRequest_c;
+        maPeerInformation[peerDeviceId].appState = mAppCCCPhase2WaitingForVerify_c;
     }
 }
 
-/*! *********************************************************************************
-* \brief        Handler of the mAppIdle_c state for BleApp_StateMachineHandler.
-*
-* \param[in]    peerDeviceId        Peer device ID.
-* \param[in]    event               Event type.
-************************************************************************************/
-static void BleApp_StateMachineHandler_AppCCCWaitingForOwnerPairingRequest
-(
-    deviceId_t peerDeviceId,
-    appEvent_t event
-)
+static void BleApp_Sm_Phase2Encrypted(deviceId_t peerDeviceId, uint8_t event)
 {
-    if (event == mAppEvt_OwnerPairingRequestReceived_c)
-    {
-        bleResult_t status;
+    (void)event;
+    maPeerInformation[peerDeviceId].isLinkEncrypted = TRUE;
+    maPeerInformation[peerDeviceId].appState = mAppRunning_c;
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+    BleApp_UnlockPathMark(peerDeviceId, unlockPathReady_c);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+}
 
-        /* Move to CCC Phase 2 */
-        /* Dummy data - replace with calls to get actual data */
-        uint16_t payloadLen = gDummyPayloadLength_c;
-        uint8_t payload[gDummyPayloadLength_c] = gDummyPayload_c;
-        status = CCCPhase2_SendSPAKERequest(peerDeviceId, payload, payloadLen);
+static void BleApp_Sm_PairingReady(deviceId_t peerDeviceId, uint8_t event)
+{
+    (void)event;
+    maPeerInformation[peerDeviceId].appState = mAppCCCReadyForPairing_c;
+}
 
-        if (status == gBleSuccess_c)
-        {
-            maPeerInformation[peerDeviceId].appState = mAppCCCPhase2WaitingForResponse_c;
-        }
-    }
-    else if (event == mAppEvt_EncryptionChanged_c)
-    {
-        maPeerInformation[peerDeviceId].isLinkEncrypted = TRUE;
-        maPeerInformation[peerDeviceId].appState = mAppLocalizationSetup_c;
-    }
-    else
-    {
-        /* For MISRA compliance */
-    }
+/* First_Approach_RQ, in mAppCCCReadyForPairing_c and again in mAppPair_c */
+static void BleApp_Sm_PairPeerOobDataRcv(deviceId_t peerDeviceId, uint8_t event)
+{
+    (void)event;
+    mCurrentPeerId = peerDeviceId;
+    (void)Gap_LeScGetLocalOobData();
+    maPeerInformation[peerDeviceId].appState = mAppPair_c;
 }
 
-/*! *********************************************************************************
-* \brief        Handler of the mAppLocalizationSetup_c state for BleApp_StateMachineHandler.
-*
-* \param[in]    peerDeviceId        Peer device ID.
-* \param[in]    event               Event type.
-************************************************************************************/
-static void BleApp_StateMachineHandler_LocalizationSetup
-(
-    deviceId_t peerDeviceId,
-    appEvent_t event
-)
+static void BleApp_Sm_PairLocalOobData(deviceId_t peerDeviceId, uint8_t event)
 {
-    bleResult_t result = gBleSuccess_c;
-    bool_t bProceedToLocalization = FALSE;
+    (void)event;
+    (void)CCC_FirstApproachRsp(peerDeviceId, gaAppOwnDiscAddress, &maPeerInformation[peerDeviceId].oobData);
+}
+
+static void BleApp_Sm_PairPeerOobDataReq(deviceId_t peerDeviceId, uint8_t event)
+{
+    (void)event;
+    (void)Gap_LeScSetPeerOobData(peerDeviceId, &maPeerInformation[peerDeviceId].peerOobData);
+}
+
+static void BleApp_Sm_PairComplete(deviceId_t peerDeviceId, uint8_t event)
+{
+    (void)event;
+    FLib_MemSet(&maPeerInformation[peerDeviceId].oobData, 0x00, sizeof(gapLeScOobData_t));
+    FLib_MemSet(&maPeerInformation[peerDeviceId].peerOobData, 0x00, sizeof(gapLeScOobData_t));
+    maPeerInformation[peerDeviceId].appState = mAppRunning_c;
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+    BleApp_UnlockPathMark(peerDeviceId, unlockPathReady_c);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+}
+
+static void BleApp_Sm_ServiceDiscComplete(deviceId_t peerDeviceId, uint8_t event)
+{
+    (void)event;
+    /* Moving to Running State*/
+    maPeerInformation[peerDeviceId].appState = mAppRunning_c;
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+    BleApp_UnlockPathMark(peerDeviceId, unlockPathServiceDisc_c);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+#if gAppUseBonding_d
+    /* Write data in NVM */
+    (void)Gap_SaveCustomPeerInformation(maPeerInformation[peerDeviceId].deviceId,
+                                        (void *)&maPeerInformation[peerDeviceId].customInfo, 0,
+                                        (uint16_t)sizeof(appCustomInfo_t));
+#endif
+}
+
+static void BleApp_Sm_ServiceDiscFailed(deviceId_t peerDeviceId, uint8_t event)
+{
+    (void)event;
+    (void)Gap_Disconnect(peerDeviceId);
+}
 
 #if defined(gAppBtcsClient_d) && (gAppBtcsClient_d == 1U)
-    if (event == mAppEvt_ExchangeMtuComplete_c)
-    {
-        /* Send BTCS Ranging Procedure Results Config message */
-        bool_t bEnableProcResTransfer = TRUE;
+static void BleApp_Sm_LocSetupMtuExchanged(deviceId_t peerDeviceId, uint8_t event)
+{
+    /* Send BTCS Ranging Procedure Results Config message */
+    bool_t bEnableProcResTransfer = TRUE;
 
-        /* Receiver should send procedure results */
-        result = SendBTCSRangingProcResCfg(peerDeviceId, bEnableProcResTransfer);
+    (void)event;
 
-        if (result != gBleSuccess_c)
-        {
-            shell_write("BTCS Ranging Procedure Results Config failed!\r\n");
-        }
-        else
-        {
-            bProceedToLocalization = TRUE;
-        }
-    }
-#elif defined(gAppBtcsServer_d) && (gAppBtcsServer_d == 1U)
-    if (event == mAppEvt_PsmChannelCreated_c)
+    /* Receiver should send procedure results */
+    if (SendBTCSRangingProcResCfg(peerDeviceId, bEnableProcResTransfer) != gBleSuccess_c)
     {
-        AppLocalization_SetPsmChannelId(peerDeviceId,
-                                        maPeerInformation[peerDeviceId].customInfo.psmChannelId);
-    }
-    else if (event == mAppEvt_BtcsRangingProcResCfg_c)
-    {
-        bProceedToLocalization = TRUE;
+        shell_write("BTCS Ranging Procedure Results Config failed!\r\n");
     }
     else
     {
-        /* For MISRA compliance */
+        BleApp_ProceedToLocalization(peerDeviceId);
     }
+}
+#elif defined(gAppBtcsServer_d) && (gAppBtcsServer_d == 1U)
+static void BleApp_Sm_LocSetupPsmCreated(deviceId_t peerDeviceId, uint8_t event)
+{
+    (void)event;
+    AppLocalization_SetPsmChannelId(peerDeviceId,
+                                    maPeerInformation[peerDeviceId].customInfo.psmChannelId);
+}
+
+static void BleApp_Sm_LocSetupProcResCfg(deviceId_t peerDeviceId, uint8_t event)
+{
+    (void)event;
+    BleApp_ProceedToLocalization(peerDeviceId);
+}
 #endif
 
-    if (bProceedToLocalization)
-    {
-        maPeerInformation[peerDeviceId].appState = mAppLocalization_c;
+static void BleApp_Sm_FreeCharProcBuffer(deviceId_t peerDeviceId, uint8_t event)
+{
+    (void)peerDeviceId;
+    (void)event;
+    (void)MEM_BufferFree(mpCharProcBuffer);
+    mpCharProcBuffer = NULL;
+}
 
-        if (mGlobalRangeSettings.role == gCsRoleInitiator_c)
-        {
-            result = AppLocalization_Config(peerDeviceId);
+static void BleApp_Sm_LocalizationDisconnected(deviceId_t peerDeviceId, uint8_t event)
+{
+    (void)event;
+    AppLocalization_ResetPeer(peerDeviceId, TRUE, maPeerInformation[peerDeviceId].nvmIndex);
+#if defined (gAppRunAlgo_d) && (gAppRunAlgo_d == 1U)
+    AppLocalizationAlgo_ResetPeer(peerDeviceId);
+#endif /* defined (gAppRunAlgo_d) && (gAppRunAlgo_d == 1U) */
+#if defined(gHandoverIncluded_d) && (gHandoverIncluded_d == 1)
+    gHandoverDeviceId = gInvalidDeviceId_c;
+#endif
+}
 
-            if (result != gBleSuccess_c)
-            {
-                shell_write("Localization configuration failed !\r\n");
-            }
+/*! *********************************************************************************
+* \brief        End of mAppLocalizationSetup_c: configures localization as initiator.
+*
+* \param[in]    peerDeviceId        Peer device ID.
+************************************************************************************/
+static void BleApp_ProceedToLocalization(deviceId_t peerDeviceId)
+{
+    maPeerInformation[peerDeviceId].appState = mAppLocalization_c;
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+    BleApp_UnlockPathMark(peerDeviceId, unlockPathReady_c);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+
+    if (mGlobalRangeSettings.role == gCsRoleInitiator_c)
+    {
+        if (AppLocalization_Config(peerDeviceId) != gBleSuccess_c)
+        {
+            shell_write("Localization configuration failed !\r\n");
         }
     }
 }
 
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+/*! *********************************************************************************
+* \brief        Time base of the event trace, microseconds.
+************************************************************************************/
+static uint32_t BleApp_TraceNowUs(void)
+{
+    return (uint32_t)TM_GetTimestamp();
+}
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
+
 /*! *********************************************************************************
 * \brief        Handles BLE Advertising callback from host stack.
 *
@@ -1372,7 +1594,15 @@ static void BleApp_AdvertisingCallback (gapAdvertisingEvent_t* pAdvertisingEvent
                 /* Inform the user interface handler that legacy advertising started */
                 appEvent = mAppEvt_AdvertisingStartedLegacy_c;
 #if defined(gAppLeCodedAdvEnable_d) && (gAppLeCodedAdvEnable_d == 1)
-                if (FALSE == mOwnerPairingMode)
+                bool_t codedAdv = (FALSE == mOwnerPairingMode) ? TRUE : FALSE;
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+                /* The sparse profiles leave the LE Coded set off */
+                if ((mAdvSchedOn == TRUE) && (mAdvProfile.codedInterval == 0U))
+                {
+                    codedAdv = FALSE;
+                }
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
+                if (TRUE == codedAdv)
                 {
                     gCurrentAdvHandle = gExtendedAdvSetHandle_c;
                     gStopExtAdvSetAfterConnect = FALSE;
@@ -1434,6 +1664,18 @@ static void BleApp_AdvertisingCallback (gapAdvertisingEvent_t* pAdvertisingEvent
             }
 #endif /* defined(gAppLeCodedAdvEnable_d) && (gAppLeCodedAdvEnable_d == 1) */
 
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+            if ((appEvent == mAppEvt_AdvertisingStopped_c) && (mAdvSchedRestart == TRUE))
+            {
+                /* Stopped for a new profile, unless a phone connected meanwhile */
+                mAdvSchedRestart = FALSE;
+                if ((mAdvSchedOn == TRUE) && (0U == BleApp_GetNoOfActiveConnections()))
+                {
+                    BleApp_Start();
+                }
+            }
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
+
             if(mpfBleUserInterfaceEventHandler != NULL)
             {
                 appEventData_t *pEventData = MEM_BufferAlloc(sizeof(appEventData_t));
@@ -1475,6 +1717,77 @@ static void BleApp_AdvertisingCallback (gapAdvertisingEvent_t* pAdvertisingEvent
 
 
 
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+/*! *********************************************************************************
+* \brief        Handles BLE Scanning callback from host stack.
+*
+* \param[in]    pScanningEvent    Pointer to gapScanningEvent_t.
+********************************************************************************** */
+static void BleApp_ScanningCallback (gapScanningEvent_t* pScanningEvent)
+{
+    bool_t nearby = FALSE;
+
+    switch (pScanningEvent->eventType)
+    {
+        case gExtDeviceScanned_c:
+        {
+            /* RSSI Integration: bonded peers are reported by identity address */
+            nearby = RssiIntegration_AdvReport(pScanningEvent->eventData.extScannedDevice.addressType,
+                                               pScanningEvent->eventData.extScannedDevice.aAddress,
+                                               pScanningEvent->eventData.extScannedDevice.rssi);
+        }
+        break;
+
+        case gDeviceScanned_c:
+        {
+            nearby = RssiIntegration_AdvReport(pScanningEvent->eventData.scannedDevice.addressType,
+                                               pScanningEvent->eventData.scannedDevice.aAddress,
+                                               pScanningEvent->eventData.scannedDevice.rssi);
+        }
+        break;
+
+        case gScanStateChanged_c:
+        {
+            mProxScanOn = (mProxScanOn == TRUE) ? FALSE : TRUE;
+
+            if(mpfBleUserInterfaceEventHandler != NULL)
+            {
+                appEventData_t *pEventData = MEM_BufferAlloc(sizeof(appEventData_t));
+                if(pEventData != NULL)
+                {
+                    pEventData->appEvent = (mProxScanOn == TRUE) ? mAppEvt_BleScanning_c : mAppEvt_BleScanStopped_c;
+                    if (gBleSuccess_c != App_PostCallbackMessage(mpfBleUserInterfaceEventHandler, pEventData))
+                    {
+                        (void)MEM_BufferFree(pEventData);
+                    }
+                }
+            }
+        }
+        break;
+
+        default:
+        {
+            ; /* No action required */
+        }
+        break;
+    }
+
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+    if ((nearby == TRUE) && (mAdvSchedOn == TRUE))
+    {
+        /* A bonded phone is coming: FAST; the timer picks a longer FAST up */
+        AdvSched_PeerNearby((uint32_t)(TM_GetTimestamp() / 1000000U));
+        if (mAdvProfile.level != advSchedFast_c)
+        {
+            BleApp_AdvSchedApply(TRUE);
+        }
+    }
+#else
+    (void)nearby;
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
+}
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
+
 /*! *********************************************************************************
 * \brief        Configures GAP Advertise parameters. Advertise will start after
 *               the parameters are set.
@@ -1502,6 +1815,58 @@ static void BleApp_Advertise(void)
 
     (void)BluetoothLEHost_StartExtAdvertising(&gAppAdvParams, BleApp_AdvertisingCallback, BleApp_ConnectionCallback);
 }
+
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+/*! *********************************************************************************
+* \brief        Takes the advertising profile of the vehicle context (adv_sched.c)
+*               and arms the timer for the next change by time alone.
+*
+* \param[in]    restart    Restart running advertising on a new profile.
+********************************************************************************** */
+static void BleApp_AdvSchedApply(bool_t restart)
+{
+    if (TRUE == AdvSched_Select((uint32_t)(TM_GetTimestamp() / 1000000U), &mAdvProfile))
+    {
+        gLegacyAdvParams.minInterval = mAdvProfile.minInterval;
+        gLegacyAdvParams.maxInterval = mAdvProfile.maxInterval;
+#if defined(gAppLeCodedAdvEnable_d) && (gAppLeCodedAdvEnable_d == 1)
+        if (mAdvProfile.codedInterval != 0U)
+        {
+            gExtAdvParams.minInterval = mAdvProfile.codedInterval;
+            gExtAdvParams.maxInterval = mAdvProfile.codedInterval;
+        }
+#endif /* defined(gAppLeCodedAdvEnable_d) && (gAppLeCodedAdvEnable_d == 1) */
+
+        /* The sets take new parameters on a restart; the stopped event starts them again */
+        if ((restart == TRUE) && (gCurrentAdvHandle != gNoAdvSetHandle_c) && (mAdvSchedRestart == FALSE))
+        {
+            mAdvSchedRestart = TRUE;
+            gCurrentAdvHandle = gNoAdvSetHandle_c;
+            (void)Gap_StopExtAdvertising(0xFF);
+        }
+    }
+
+    if ((mAdvSchedTimerValid == TRUE) && (mAdvProfile.holdS != 0U))
+    {
+        (void)TM_Stop((timer_handle_t)mAdvSchedTimerId);
+        (void)TM_InstallCallback((timer_handle_t)mAdvSchedTimerId, AdvSchedTimerCallback, NULL);
+        (void)TM_Start((timer_handle_t)mAdvSchedTimerId, (uint8_t)kTimerModeLowPowerTimer | (uint8_t)kTimerModeSetSecondTimer, mAdvProfile.holdS);
+    }
+}
+
+/*! *********************************************************************************
+* \brief        Re-evaluates the advertising profile in the application task.
+********************************************************************************** */
+static void BleApp_AdvSchedTimeout(appCallbackParam_t param)
+{
+    (void)param;
+
+    if (mAdvSchedOn == TRUE)
+    {
+        BleApp_AdvSchedApply(TRUE);
+    }
+}
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
 /*! *********************************************************************************
 * \brief        Handles GATT server callback from host stack.
 *
@@ -1602,7 +1967,15 @@ static void BleApp_L2capPsmDataCallback (deviceId_t     deviceId,
     /* Inform the application events handler that L2capPsmData package received */
     if(mpfBleEventHandler != NULL)
     {
-        appEventData_t *pEventData = MEM_BufferAlloc(sizeof(appEventData_t) + sizeof(appEventL2capPsmData_t) + (uint32_t)packetLength);
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+        /* Keep the host message and point the event at its packet instead of copying it,
+           the application handler releases it. Copy only if no reference is available. */
+        void *pHostMsg = App_RetainHostMessage();
+        uint32_t copyLength = (pHostMsg != NULL) ? 0U : (uint32_t)packetLength;
+#else
+        uint32_t copyLength = (uint32_t)packetLength;
+#endif /* gAppHostMsgRetain_d */
+        appEventData_t *pEventData = MEM_BufferAlloc(sizeof(appEventData_t) + sizeof(appEventL2capPsmData_t) + copyLength);
         if(pEventData != NULL)
         {
             pEventData->appEvent = mAppEvt_L2capPsmDataCallback_c;
@@ -1611,14 +1984,36 @@ static void BleApp_L2capPsmDataCallback (deviceId_t     deviceId,
             pL2capPsmDataEvent->deviceId = deviceId;
             pL2capPsmDataEvent->lePsm = lePsm;
             pL2capPsmDataEvent->packetLength = packetLength;
-            pL2capPsmDataEvent->pPacket = (uint8_t*)(&pL2capPsmDataEvent[1]);
-            FLib_MemCpy(pL2capPsmDataEvent->pPacket, pPacket, packetLength);
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+            pL2capPsmDataEvent->pHostMsg = pHostMsg;
+            if (pHostMsg != NULL)
+            {
+                pL2capPsmDataEvent->pPacket = pPacket;
+            }
+            else
+#endif /* gAppHostMsgRetain_d */
+            {
+                pL2capPsmDataEvent->pPacket = (uint8_t*)(&pL2capPsmDataEvent[1]);
+                FLib_MemCpy(pL2capPsmDataEvent->pPacket, pPacket, packetLength);
+            }
             pL2capPsmDataEvent = NULL;
-            if (gBleSuccess_c != App_PostCallbackMessage(mpfBleEventHandler, pEventData))
+            /* Digital Key messages carry the unlock handshake, larger payloads are bulk transfers */
+            if (gBleSuccess_c != App_PostCallbackMessageLane(mpfBleEventHandler, pEventData,
+                                                             (packetLength <= gDKMessageMaxLength_c) ?
+                                                             gAppMsgLaneCritical_c : gAppMsgLaneBulk_c))
             {
                 (void)MEM_BufferFree(pEventData);
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+                App_ReleaseHostMessage(pHostMsg);
+#endif /* gAppHostMsgRetain_d */
             }
         }
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+        else
+        {
+            App_ReleaseHostMessage(pHostMsg);
+        }
+#endif /* gAppHostMsgRetain_d */
     }
 }
 
@@ -1832,6 +2227,17 @@ static void L2caTimerCallback(void *param)
     }
 }
 
+#if defined(gAppAdvSched_d) && (gAppAdvSched_d == 1)
+/*! *********************************************************************************
+ * \brief        Advertising profile timer Callback
+ ********************************************************************************** */
+static void AdvSchedTimerCallback(void *param)
+{
+    (void)param;
+    (void)App_PostCallbackMessage(BleApp_AdvSchedTimeout, NULL);
+}
+#endif /* defined(gAppAdvSched_d) && (gAppAdvSched_d == 1) */
+
 /*! *********************************************************************************
  * \brief        Returns UWB clock.
  ********************************************************************************** */
@@ -1924,3 +2330,46 @@ static void BleApp_A2BCommHandler(uint8_t opGroup, uint8_t cmdId, uint16_t len,
     A2A_SendCommand(opGroup, cmdId, pData, len);
 }
 #endif /* defined(gA2BEnabled_d) && (gA2BEnabled_d > 0U) */
+
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+/*! *********************************************************************************
+ * \brief        Restores the remote CS capabilities and the last CS configuration
+ *               saved with the bond, so the localization setup of a reconnection
+ *               uses the cached capabilities instead of reading them again.
+ *
+ * \param[in]    peerDeviceId        Peer device ID.
+ * \param[in]    nvmIndex            NVM index of the bonded peer.
+ ********************************************************************************** */
+static void BleApp_RestoreCsBondData(deviceId_t peerDeviceId, uint8_t nvmIndex)
+{
+    appCsBondDataImage_t *pBlob = MEM_BufferAlloc(sizeof(appCsBondDataImage_t));
+    appLocalization_rangeCfg_t locConfig;
+
+    if (pBlob != NULL)
+    {
+        if ((App_NvmReadCsBondData(nvmIndex, pBlob) == gBleSuccess_c) &&
+            (pBlob->data.version == mAppCsBondDataVersion_c))
+        {
+            /* Update device id */
+            pBlob->data.remoteCaps.deviceId = peerDeviceId;
+            AppLocalization_SetRemoteCachedSupportedCapabilities(nvmIndex, &pBlob->data.remoteCaps);
+
+            /* Keep the csAlgoBuf pointer of the current configuration */
+            (void)AppLocalization_ReadConfig(peerDeviceId, &locConfig);
+            pBlob->data.rangeCfg.csAlgoBuf = locConfig.csAlgoBuf;
+#if defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1)
+            /* Adapted per connection, start again from the default ACI */
+            pBlob->data.rangeCfg.ant_cfg_index = mDefaultRangeSettings.ant_cfg_index;
+#endif /* defined(gAppCsAntPathTracking_d) && (gAppCsAntPathTracking_d == 1) */
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+            /* Adapted per connection, start again from the default channel map */
+            FLib_MemCpy(pBlob->data.rangeCfg.ch_map, mDefaultRangeSettings.ch_map, APP_LOCALIZATION_CH_MAP_LEN);
+            pBlob->data.rangeCfg.main_mode_max = mDefaultRangeSettings.main_mode_max;
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
+            (void)AppLocalization_WriteConfig(peerDeviceId, &pBlob->data.rangeCfg);
+        }
+
+        (void)MEM_BufferFree(pBlob);
+    }
+}
+#endif /* defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U) */
@@ -25,6 +25,9 @@
 #include "app_advertiser.h"
 #include "app_localization.h"
 #include "channel_sounding.h"
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+#include "unlock_path.h"
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
 /*************************************************************************************
 **************************************************************************************
 * Public macros
@@ -122,6 +125,7 @@ typedef enum appEvent_tag{
     mAppEvt_Shell_A2BError_c,
     mAppEvt_L2capPsmChannelStatusNotification_c,
     mAppEvt_BtcsRangingProcResCfg_c,
+    mAppEvt_Count_c                     /* Keep last: size of the state machine table */
 }appEvent_t;
 
 typedef struct appEventL2capPsmData_tag
@@ -130,6 +134,9 @@ typedef struct appEventL2capPsmData_tag
     uint16_t       lePsm;
     uint16_t       packetLength;
     uint8_t*       pPacket;
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1U)
+    void*          pHostMsg;        /* Host message pPacket points into, NULL if copied */
+#endif /* gAppHostMsgRetain_d */
 }appEventL2capPsmData_t;
 
 typedef struct appEventLeDataLengthChanged_tag
@@ -187,7 +194,8 @@ typedef enum appState_tag{
     mAppPair_c,
     mAppLocalizationSetup_c,
     mAppLocalization_c,
-    mAppRunning_c
+    mAppRunning_c,
+    mAppStateCount_c                    /* Keep last: size of the state machine table */
 }appState_t;
 
 typedef struct appPeerInfo_tag
@@ -200,6 +208,9 @@ typedef struct appPeerInfo_tag
     bool_t                      isLinkEncrypted;
     bool_t                      csSecurityEnabled;
     bool_t                      csCapabWritten;
+#if defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1)
+    bool_t                      csConfigUpdate;     /* Adapted channel map to apply to the link */
+#endif /* defined(gAppCsChannelAdapt_d) && (gAppCsChannelAdapt_d == 1) */
     appState_t                  appState;
     gapLeScOobData_t            oobData;
     gapLeScOobData_t            peerOobData;
@@ -219,6 +230,9 @@ extern gapScanResponseData_t            gAppScanRspData;
 extern gapExtAdvertisingParameters_t  gExtAdvParams;
 extern gapExtAdvertisingParameters_t  gLegacyAdvParams;
 extern appExtAdvertisingParams_t        gAppAdvParams;
+#if defined(gAppScanProx_d) && (gAppScanProx_d == 1)
+extern appScanningParams_t              gAppProxScanParams;
+#endif /* defined(gAppScanProx_d) && (gAppScanProx_d == 1) */
 /* This global will be TRUE if the user adds or removes a bond */
 extern bool_t                           gPrivacyStateChangedByUser;
 
@@ -278,6 +292,16 @@ bleResult_t SendBTCSRangingProcResCfg
 );
 #endif /* defined(gAppBtcsClient_d) && (gAppBtcsClient_d == 1U) */
 
+#if defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U)
+/* Saves the CS capabilities and configuration of a bonded peer in NVM */
+void BleApp_SaveCsBondData(deviceId_t peerDeviceId);
+#endif /* defined(gAppCsBondDataSize_c) && (gAppCsBondDataSize_c > 0U) */
+
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+/* Time stamps a milestone of the connect to unlock path of a peer */
+void BleApp_UnlockPathMark(deviceId_t peerDeviceId, unlockPathMilestone_t milestone);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,6 +6,14 @@
 *         Pipeline: Hampel -> Adaptive EMA -> Feature Extraction -> State Machine
 *         Fixed-point Q4 throughout (1/16 dB resolution). No float. No dynamic memory.
 *
+*         Thin adapter over the ProxRssi engine (kw47_keyless_entry/ProxRssi.c):
+*         the RSSI_* macros below configure one engine instance per filter, so
+*         a link carries a single set of rings and scratch arrays whichever API
+*         it uses. With the same ring sizes decisions match the former
+*         standalone pipeline; readings of 0 dBm and above (127 = "not
+*         available") are now dropped like in ProxRssi instead of being
+*         clamped to +20 dBm.
+*
 * Copyright 2025
 * SPDX-License-Identifier: BSD-3-Clause
 ********************************************************************************** */
@@ -15,6 +23,7 @@
 
 #include "EmbeddedTypes.h"
 #include "fsl_component_timer_manager.h"
+#include "ProxRssi.h"
 #include <stdint.h>
 
 /************************************************************************************
@@ -32,6 +41,10 @@
 *************************************************************************************
 ************************************************************************************/
 
+/* Samples kept for the Hampel and feature windows, as in the standalone filter.
+ * At 100 ms reads they cover 3.2 s and 4 s; reads closer than ~50 ms overflow.
+ * The engine rings are sized from them in app_preinclude.h (PROX_RSSI_RAW_CAP,
+ * PROX_RSSI_SMOOTH_CAP), which keeps the standalone footprint per link. */
 #define RSSI_RAW_CAP            (32U)
 #define RSSI_SMOOTH_CAP         (40U)
 
@@ -128,53 +141,16 @@ typedef struct
     int16_t  maxQ4;           /* Max in window (Q4)                         */
 } rssiFeatures_t;
 
-/* Raw RSSI ring buffer */
-typedef struct
-{
-    uint32_t tMs[RSSI_RAW_CAP];
-    int8_t   rssiDbm[RSSI_RAW_CAP];
-    uint16_t head;
-    uint16_t count;
-} rssiRawRing_t;
-
-/* Smoothed RSSI ring buffer (Q4) */
-typedef struct
-{
-    uint32_t tMs[RSSI_SMOOTH_CAP];
-    int16_t  rssiQ4[RSSI_SMOOTH_CAP];
-    uint16_t head;
-    uint16_t count;
-} rssiSmoothRing_t;
-
 /* Main filter context - deterministic memory, no malloc */
 typedef struct
 {
-    /* Ring buffers */
-    rssiRawRing_t    raw;
-    rssiSmoothRing_t smooth;
-
-    /* EMA state */
-    uint8_t  emaValid;        /* 0U = not initialized, 1U = valid */
-    int16_t  emaQ4;           /* Current EMA value (Q4)           */
-    uint32_t emaPrevMs;       /* Timestamp of last EMA update     */
-
-    /* State machine */
-    rssiState_t  currentState;
-    rssiState_t  previousState;
-    uint32_t     tCandidateStartMs;   /* CANDIDATE entry time       */
-    uint32_t     tBelowExitStartMs;   /* Exit-confirm timer start   */
-    uint32_t     tLockoutUntilMs;     /* Lockout expiry timestamp   */
-    uint8_t      stateChanged;        /* 1U if state changed        */
-    rssiEvent_t  lastEvent;           /* Last event emitted         */
-
-    /* Cached features */
-    rssiFeatures_t features;
-    uint32_t lastUpdateTime;
-
-    /* Scratch arrays (pre-allocated, no heap) */
-    int16_t tmpA[RSSI_RAW_CAP];
-    int16_t tmpB[RSSI_RAW_CAP];
-    int16_t tmpS[RSSI_SMOOTH_CAP];
+    /* Engine: rings, scratch arrays, EMA and FAR/CANDIDATE/LOCKOUT state */
+    ProxRssi_CtxType engine;
+
+    /* Adapter state */
+    rssiFeatures_t features;          /* Features of the last pipeline run */
+    rssiEvent_t    lastEvent;         /* Last event emitted               */
+    uint8_t        stateChanged;      /* 1U if state changed              */
 } rssiFilter_t;
 
 /************************************************************************************
@@ -119,6 +119,15 @@ void RssiIntegration_DeviceDisconnected(uint8_t deviceId)
                                        NULL);
 }
 
+/*! *********************************************************************************
+* \brief     Handle link encrypted event
+*            No per-device calibration in this pipeline (see kw47_keyless_entry).
+********************************************************************************** */
+void RssiIntegration_LinkEncrypted(uint8_t deviceId)
+{
+    (void)deviceId;
+}
+
 /*! *********************************************************************************
 * \brief     Update RSSI value from connected device
 ********************************************************************************** */
@@ -32,6 +32,11 @@ void RssiIntegration_DeviceConnected(uint8_t deviceId);
 ********************************************************************************** */
 void RssiIntegration_DeviceDisconnected(uint8_t deviceId);
 
+/*! *********************************************************************************
+* \brief     Handle link encrypted event (bonded peer authenticated)
+********************************************************************************** */
+void RssiIntegration_LinkEncrypted(uint8_t deviceId);
+
 /*! *********************************************************************************
 * \brief     Update RSSI value from connected device
 ********************************************************************************** */
@@ -30,6 +30,24 @@
 #include "digital_key_car_anchor_cs.h"
 #include "shell_digital_key_car_anchor_cs.h"
 #include "rssi_integration.h"
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+#include "cs_latency.h"
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1)
+#include "msg_lane.h"
+#endif /* defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1) */
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1)
+#include "msg_ref.h"
+#endif /* defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1) */
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+#include "flight_rec.h"
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+#include "app_dispatch.h"
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+#include "unlock_path.h"
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
 
 /************************************************************************************
 *************************************************************************************
@@ -74,6 +92,22 @@ static shell_status_t ShellSetCsRole_Command(shell_handle_t shellHandle, int32_t
 static shell_status_t ShellSetNumProcs_Command(shell_handle_t shellHandle, int32_t argc, char * argv[]);
 static shell_status_t ShellRssiStart_Command(shell_handle_t shellHandle, int32_t argc, char * argv[]);
 static shell_status_t ShellRssiStop_Command(shell_handle_t shellHandle, int32_t argc, char * argv[]);
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+static shell_status_t ShellCsLatency_Command(shell_handle_t shellHandle, int32_t argc, char * argv[]);
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1)
+static shell_status_t ShellHostQueue_Command(shell_handle_t shellHandle, int32_t argc, char * argv[]);
+#endif /* defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1) */
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+static shell_status_t ShellDispatch_Command(shell_handle_t shellHandle, int32_t argc, char * argv[]);
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+static shell_status_t ShellUnlockPath_Command(shell_handle_t shellHandle, int32_t argc, char * argv[]);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+static shell_status_t ShellFlightRec_Command(shell_handle_t shellHandle, int32_t argc, char * argv[]);
+static void ShellFlightRec_Run(appCallbackParam_t param);
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
 
 static uint8_t BleApp_ParseHexValue(char* pInput);
 static uint32_t BleApp_AsciiToHex(char *pString, uint32_t strLen);
@@ -187,6 +221,63 @@ static shell_command_t mRssiStopCmd =
     .pcHelpString = "\r\n\"rssistop\": Stop RSSI monitoring.\r\n",
 };
 
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+static shell_command_t mCsLatencyCmd =
+{
+    .pcCommand = "latency",
+    .cExpectedNumberOfParameters = SHELL_IGNORE_PARAMETER_COUNT,
+    .pFuncCallBack = ShellCsLatency_Command,
+    .pcHelpString = "\r\n\"latency\": Show CS stage latency percentiles per device.\r\n"
+                    "  latency        - Show statistics\r\n"
+                    "  latency reset  - Clear statistics\r\n",
+};
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1)
+static shell_command_t mHostQueueCmd =
+{
+    .pcCommand = "hostq",
+    .cExpectedNumberOfParameters = SHELL_IGNORE_PARAMETER_COUNT,
+    .pFuncCallBack = ShellHostQueue_Command,
+    .pcHelpString = "\r\n\"hostq\": Show host message queue depth and drain latency.\r\n"
+                    "  hostq          - Show statistics (and per lane queueing latency)\r\n"
+                    "  hostq reset    - Clear statistics\r\n",
+};
+#endif /* defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1) */
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+static shell_command_t mDispatchCmd =
+{
+    .pcCommand = "dispatch",
+    .cExpectedNumberOfParameters = SHELL_IGNORE_PARAMETER_COUNT,
+    .pFuncCallBack = ShellDispatch_Command,
+    .pcHelpString = "\r\n\"dispatch\": Show application event latency per event type.\r\n"
+                    "  dispatch       - Show queueing and handler percentiles\r\n"
+                    "  dispatch reset - Clear statistics\r\n",
+};
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+static shell_command_t mUnlockPathCmd =
+{
+    .pcCommand = "unlockpath",
+    .cExpectedNumberOfParameters = SHELL_IGNORE_PARAMETER_COUNT,
+    .pFuncCallBack = ShellUnlockPath_Command,
+    .pcHelpString = "\r\n\"unlockpath\": Show connect to unlock latency per phase.\r\n"
+                    "  unlockpath       - Show phase percentiles and the timeline of each device\r\n"
+                    "  unlockpath reset - Clear statistics\r\n",
+};
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+static shell_command_t mFlightRecCmd =
+{
+    .pcCommand = "flightrec",
+    .cExpectedNumberOfParameters = SHELL_IGNORE_PARAMETER_COUNT,
+    .pFuncCallBack = ShellFlightRec_Command,
+    .pcHelpString = "\r\n\"flightrec\": RSSI flight recorder.\r\n"
+                    "  flightrec        - Show log status\r\n"
+                    "  flightrec flush  - Copy the RAM log to flash\r\n"
+                    "  flightrec dump   - Print the stored blocks as FR: hex lines\r\n",
+};
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
+
 static shell_command_t mSetCsConfigParamsCmd =
 {
     .pcCommand = "setcsconfig",
@@ -351,6 +442,26 @@ void AppShellInit(char* prompt)
     assert(kStatus_SHELL_Success == status);
     status = SHELL_RegisterCommand((shell_handle_t)g_shellHandle, &mRssiStopCmd);
     assert(kStatus_SHELL_Success == status);
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+    status = SHELL_RegisterCommand((shell_handle_t)g_shellHandle, &mCsLatencyCmd);
+    assert(kStatus_SHELL_Success == status);
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1)
+    status = SHELL_RegisterCommand((shell_handle_t)g_shellHandle, &mHostQueueCmd);
+    assert(kStatus_SHELL_Success == status);
+#endif /* defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1) */
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+    status = SHELL_RegisterCommand((shell_handle_t)g_shellHandle, &mDispatchCmd);
+    assert(kStatus_SHELL_Success == status);
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+    status = SHELL_RegisterCommand((shell_handle_t)g_shellHandle, &mUnlockPathCmd);
+    assert(kStatus_SHELL_Success == status);
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+    status = SHELL_RegisterCommand((shell_handle_t)g_shellHandle, &mFlightRecCmd);
+    assert(kStatus_SHELL_Success == status);
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
 #endif /* defined(gAppUseShellInApplication_d) && (gAppUseShellInApplication_d == 1) */
 }
 
@@ -1754,4 +1865,398 @@ static shell_status_t ShellRssiStop_Command
     
     return kStatus_SHELL_Success;
 }
+
+#if defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1)
+/*! *********************************************************************************
+* \brief        CS latency statistics shell command handler
+********************************************************************************** */
+static shell_status_t ShellCsLatency_Command
+(
+    shell_handle_t shellHandle,
+    int32_t argc,
+    char * argv[]
+)
+{
+    static const char *const aStageNames[csLatencyStageCount_c] =
+    {
+        "CS Config      ",
+        "CS Procedure   ",
+        "L2CAP transfer ",
+        "Algorithm      ",
+    };
+    const char* resetCmd = "reset";
+    csLatencyStats_t stats;
+    uint8_t deviceId;
+    uint8_t stage;
+
+    (void)shellHandle;
+
+    if ((argc == 2) && (TRUE == FLib_MemCmp(argv[1], resetCmd, 5)))
+    {
+        CsLatency_Reset(CS_LATENCY_ALL_DEVICES);
+        shell_write("\r\nLatency statistics cleared.\r\n");
+    }
+    else
+    {
+        shell_write("\r\nStage latency (us): count / min / p50 / p95 / p99 / max\r\n");
+
+        for (deviceId = 0U; deviceId < (uint8_t)gAppMaxConnections_c; deviceId++)
+        {
+            for (stage = 0U; stage < (uint8_t)csLatencyStageCount_c; stage++)
+            {
+                if (CsLatency_GetStats(deviceId, (csLatencyStage_t)stage, &stats) == TRUE)
+                {
+                    shell_write("[");
+                    shell_writeDec(deviceId);
+                    shell_write("] ");
+                    shell_write(aStageNames[stage]);
+                    shell_writeDec(stats.count);
+                    shell_write(" / ");
+                    shell_writeDec(stats.minUs);
+                    shell_write(" / ");
+                    shell_writeDec(stats.p50Us);
+                    shell_write(" / ");
+                    shell_writeDec(stats.p95Us);
+                    shell_write(" / ");
+                    shell_writeDec(stats.p99Us);
+                    shell_write(" / ");
+                    shell_writeDec(stats.maxUs);
+                    shell_write("\r\n");
+                }
+            }
+        }
+    }
+
+    return kStatus_SHELL_Success;
+}
+#endif /* defined(gAppCsLatencyStats_d) && (gAppCsLatencyStats_d == 1) */
+
+#if defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1)
+/*! *********************************************************************************
+* \brief        Host message drain statistics shell command handler
+********************************************************************************** */
+static shell_status_t ShellHostQueue_Command
+(
+    shell_handle_t shellHandle,
+    int32_t argc,
+    char * argv[]
+)
+{
+    const char* resetCmd = "reset";
+    appHostMsgStats_t stats;
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1)
+    static const char *const aLaneNames[msgLaneCount_c] =
+    {
+        "Critical ",
+        "Bulk     ",
+    };
+    msgLaneStats_t laneStats;
+    uint8_t lane;
+#endif /* defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1) */
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1)
+    msgRefStats_t refStats;
+#endif /* defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1) */
+
+    (void)shellHandle;
+
+    if ((argc == 2) && (TRUE == FLib_MemCmp(argv[1], resetCmd, 5)))
+    {
+        BluetoothLEHost_ResetMsgStats();
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1)
+        MsgLane_ResetStats();
+#endif /* defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1) */
+        shell_write("\r\nHost queue statistics cleared.\r\n");
+    }
+    else
+    {
+        BluetoothLEHost_GetMsgStats(&stats);
+
+        shell_write("\r\nPasses: ");
+        shell_writeDec(stats.wakeups);
+        shell_write(", host msgs: ");
+        shell_writeDec(stats.hostMsgs);
+        shell_write(", callbacks: ");
+        shell_writeDec(stats.cbMsgs);
+        shell_write("\r\nMax depth host / callback: ");
+        shell_writeDec(stats.hostDepthMax);
+        shell_write(" / ");
+        shell_writeDec(stats.cbDepthMax);
+        shell_write("\r\nMax batch: ");
+        shell_writeDec(stats.batchMax);
+        shell_write(", budget / cap exits: ");
+        shell_writeDec(stats.budgetExits);
+        shell_write(" / ");
+        shell_writeDec(stats.capExits);
+        shell_write("\r\nPass (us) mean / max: ");
+        shell_writeDec((stats.wakeups != 0U) ? (stats.passTotalUs / stats.wakeups) : 0U);
+        shell_write(" / ");
+        shell_writeDec(stats.passMaxUs);
+        shell_write(", max message (us): ");
+        shell_writeDec(stats.msgMaxUs);
+        shell_write("\r\n");
+#if defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1)
+        shell_write("Lane queueing (us): count / p50 / p99 / max\r\n");
+        for (lane = 0U; lane < (uint8_t)msgLaneCount_c; lane++)
+        {
+            (void)MsgLane_GetStats((msgLane_t)lane, &laneStats);
+            shell_write(aLaneNames[lane]);
+            shell_writeDec(laneStats.count);
+            shell_write(" / ");
+            shell_writeDec(laneStats.p50Us);
+            shell_write(" / ");
+            shell_writeDec(laneStats.p99Us);
+            shell_write(" / ");
+            shell_writeDec(laneStats.maxUs);
+            shell_write("\r\n");
+        }
+#endif /* defined(gAppMsgLanes_d) && (gAppMsgLanes_d == 1) */
+#if defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1)
+        /* Since boot, the references may outlive a reset */
+        MsgRef_GetStats(&refStats);
+        shell_write("Held host msgs now / max: ");
+        shell_writeDec(refStats.held);
+        shell_write(" / ");
+        shell_writeDec(refStats.heldMax);
+        shell_write(", views: ");
+        shell_writeDec(refStats.retains);
+        shell_write(", copied (no slot): ");
+        shell_writeDec(refStats.full);
+        shell_write("\r\n");
+#endif /* defined(gAppHostMsgRetain_d) && (gAppHostMsgRetain_d == 1) */
+    }
+
+    return kStatus_SHELL_Success;
+}
+#endif /* defined(gAppHostMsgStats_d) && (gAppHostMsgStats_d == 1) */
+
+#if defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1)
+/*! *********************************************************************************
+* \brief        Application event latency shell command handler
+********************************************************************************** */
+static shell_status_t ShellDispatch_Command
+(
+    shell_handle_t shellHandle,
+    int32_t argc,
+    char * argv[]
+)
+{
+    const char* resetCmd = "reset";
+    appDispatchStats_t stats;
+    uint8_t event;
+
+    (void)shellHandle;
+
+    if ((argc == 2) && (TRUE == FLib_MemCmp(argv[1], resetCmd, 5)))
+    {
+        AppDispatch_ResetTrace();
+        shell_write("\r\nDispatch statistics cleared.\r\n");
+    }
+    else
+    {
+        /* Event numbers are the values of appEvent_t */
+        shell_write("\r\nEvt  count  queueing (us) p50/p95/max (samples)  handler (us) p50/p95/max\r\n");
+        for (event = 0U; event < (uint8_t)mAppEvt_Count_c; event++)
+        {
+            if (AppDispatch_GetTrace(event, &stats) == FALSE)
+            {
+                continue;
+            }
+            shell_writeDec(event);
+            shell_write("  ");
+            shell_writeDec(stats.count);
+            shell_write("  ");
+            shell_writeDec(stats.queueP50Us);
+            shell_write("/");
+            shell_writeDec(stats.queueP95Us);
+            shell_write("/");
+            shell_writeDec(stats.queueMaxUs);
+            shell_write(" (");
+            shell_writeDec(stats.queued);
+            shell_write(")  ");
+            shell_writeDec(stats.runP50Us);
+            shell_write("/");
+            shell_writeDec(stats.runP95Us);
+            shell_write("/");
+            shell_writeDec(stats.runMaxUs);
+            shell_write("\r\n");
+        }
+    }
+
+    return kStatus_SHELL_Success;
+}
+#endif /* defined(gAppDispatchTrace_d) && (gAppDispatchTrace_d == 1) */
+
+#if defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1)
+/*! *********************************************************************************
+* \brief        Connect to unlock latency shell command handler
+********************************************************************************** */
+static shell_status_t ShellUnlockPath_Command
+(
+    shell_handle_t shellHandle,
+    int32_t argc,
+    char * argv[]
+)
+{
+    static const char *const aMilestoneNames[unlockPathMilestoneCount_c] =
+    {
+        "Unlock     ",      /* Phase of unlockPathConnected_c: connect to unlock */
+        "Encrypted  ",
+        "ServiceDisc",
+        "Ready      ",
+        "CsConfig   ",
+        "CsStarted  ",
+        "FirstRssi  ",
+        "Candidate  ",
+        "Triggered  ",
+    };
+    const char* resetCmd = "reset";
+    uint32_t aOffsetMs[unlockPathMilestoneCount_c];
+    unlockPathStats_t stats;
+    uint8_t m;
+    uint8_t i;
+
+    (void)shellHandle;
+
+    if ((argc == 2) && (TRUE == FLib_MemCmp(argv[1], resetCmd, 5)))
+    {
+        UnlockPath_Reset();
+        shell_write("\r\nUnlock path statistics cleared.\r\n");
+    }
+    else
+    {
+        /* First row: the whole path, then each phase up to its milestone */
+        shell_write("\r\nPhase (ms)   count  lost  p50 / p90 / max\r\n");
+        for (m = 0U; m < (uint8_t)unlockPathMilestoneCount_c; m++)
+        {
+            (void)UnlockPath_GetStats((unlockPathMilestone_t)m, &stats);
+            shell_write(aMilestoneNames[m]);
+            shell_write("  ");
+            shell_writeDec(stats.count);
+            shell_write("  ");
+            shell_writeDec(stats.ended);
+            shell_write("  ");
+            shell_writeDec(stats.p50Ms);
+            shell_write(" / ");
+            shell_writeDec(stats.p90Ms);
+            shell_write(" / ");
+            shell_writeDec(stats.maxMs);
+            shell_write("\r\n");
+        }
+
+        for (i = 0U; i < (uint8_t)gAppMaxConnections_c; i++)
+        {
+            if (UnlockPath_GetTimeline(i, aOffsetMs) == FALSE)
+            {
+                continue;
+            }
+            shell_write("Device ");
+            shell_writeDec(i);
+            shell_write(" ms from connect to enc/sd/ready/cscfg/csstart/rssi/cand/unlock:");
+            for (m = 1U; m < (uint8_t)unlockPathMilestoneCount_c; m++)
+            {
+                shell_write(" ");
+                if (aOffsetMs[m] == UNLOCK_PATH_NOT_REACHED)
+                {
+                    shell_write("-");
+                }
+                else
+                {
+                    shell_writeDec(aOffsetMs[m]);
+                }
+            }
+            shell_write("\r\n");
+        }
+    }
+
+    return kStatus_SHELL_Success;
+}
+#endif /* defined(gAppUnlockPath_d) && (gAppUnlockPath_d == 1) */
+
+#if defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1)
+/*! *********************************************************************************
+* \brief        RSSI flight recorder shell command handler. The recorder is owned by
+*               the application task, so the work is posted there.
+********************************************************************************** */
+static shell_status_t ShellFlightRec_Command
+(
+    shell_handle_t shellHandle,
+    int32_t argc,
+    char * argv[]
+)
+{
+    const char* flushCmd = "flush";
+    const char* dumpCmd = "dump";
+    uint32_t op = 0U;
+
+    (void)shellHandle;
+
+    if (argc == 2)
+    {
+        if (TRUE == FLib_MemCmp(argv[1], flushCmd, 5))
+        {
+            op = 1U;
+        }
+        else if (TRUE == FLib_MemCmp(argv[1], dumpCmd, 4))
+        {
+            op = 2U;
+        }
+        else
+        {
+            shell_write("\r\nUsage: flightrec [flush|dump]\r\n");
+            return kStatus_SHELL_Error;
+        }
+    }
+
+    if (gBleSuccess_c != App_PostCallbackMessage(ShellFlightRec_Run, (appCallbackParam_t)op))
+    {
+        shell_write("\r\nBusy, try again.\r\n");
+    }
+
+    return kStatus_SHELL_Success;
+}
+
+/*! *********************************************************************************
+* \brief        Application task part of the flightrec command: 0 status, 1 flush,
+*               2 dump
+********************************************************************************** */
+static void ShellFlightRec_Run(appCallbackParam_t param)
+{
+    static uint8_t aBlock[FLIGHT_REC_BLOCK_SIZE];
+    uint32_t op = (uint32_t)param;
+    uint32_t count = FlightRec_BlockCount();
+    uint32_t index;
+    uint32_t len;
+    uint32_t pos;
+
+    if (op == 2U)
+    {
+        /* Close the open block first so the dump ends with the latest samples */
+        (void)FlightRec_Flush();
+
+        for (index = 0U; index < count; index++)
+        {
+            len = FlightRec_ReadBlock(index, aBlock);
+            for (pos = 0U; pos < len; pos += 32U)
+            {
+                shell_write("\r\nFR:");
+                shell_writeHex(&aBlock[pos], (uint8_t)(((len - pos) < 32U) ? (len - pos) : 32U));
+            }
+        }
+        shell_write("\r\nFR dump done.\r\n");
+    }
+    else
+    {
+        if (op == 1U)
+        {
+            shell_write("\r\nBlocks written: ");
+            shell_writeDec(FlightRec_Flush());
+        }
+        shell_write("\r\nFlight recorder slots: ");
+        shell_writeDec(count);
+        shell_write(", lost blocks: ");
+        shell_writeDec(FlightRec_GetLostBlocks());
+        shell_write("\r\n");
+    }
+}
+#endif /* defined(gAppFlightRecorder_d) && (gAppFlightRecorder_d == 1) */
 #endif /* defined(gAppUseShellInApplication_d) && (gAppUseShellInApplication_d == 1) */
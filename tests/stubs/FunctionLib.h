@@ -0,0 +1,32 @@
+/*! *********************************************************************************
+* \file FunctionLib.h
+*
+* \brief  Host stand-in for the connectivity framework FunctionLib, used by the
+*         unit tests and host tools that compile example sources directly.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef FUNCTION_LIB_STUB_H
+#define FUNCTION_LIB_STUB_H
+
+#include <string.h>
+#include "EmbeddedTypes.h"
+
+static inline void FLib_MemSet(void *pData, uint8_t value, uint32_t cBytes)
+{
+    (void)memset(pData, value, cBytes);
+}
+
+static inline void FLib_MemCpy(void *pDst, const void *pSrc, uint32_t cBytes)
+{
+    (void)memcpy(pDst, pSrc, cBytes);
+}
+
+static inline bool_t FLib_MemCmp(const void *pData1, const void *pData2, uint32_t cBytes)
+{
+    return (memcmp(pData1, pData2, cBytes) == 0) ? TRUE : FALSE;
+}
+
+#endif /* FUNCTION_LIB_STUB_H */
@@ -0,0 +1,15 @@
+/*! *********************************************************************************
+* \file app.h
+*
+* \brief  Host stand-in for the example app.h, which pulls in the serial
+*         manager.
+*         Nothing from it is used by the code tests/test_app_conn.c builds.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef APP_STUB_H
+#define APP_STUB_H
+
+#endif /* APP_STUB_H */
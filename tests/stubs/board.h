@@ -0,0 +1,15 @@
+/*! *********************************************************************************
+* \file board.h
+*
+* \brief  Host stand-in for the board header, which pulls in the clock and pin
+*         configuration.
+*         Nothing from it is used by the code tests/test_app_conn.c builds.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef BOARD_STUB_H
+#define BOARD_STUB_H
+
+#endif /* BOARD_STUB_H */
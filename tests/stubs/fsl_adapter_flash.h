@@ -0,0 +1,104 @@
+/*! *********************************************************************************
+* \file fsl_adapter_flash.h
+*
+* \brief  Host stand-in for the internal flash adapter, used by the unit tests.
+*         Emulates a sector-erasable flash in RAM: programming is only accepted
+*         on erased, phrase aligned locations, like on the KW47 program flash.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef FSL_ADAPTER_FLASH_STUB_H
+#define FSL_ADAPTER_FLASH_STUB_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef STUB_FLASH_BASE
+#define STUB_FLASH_BASE         (0x00100000u)
+#endif
+
+#ifndef STUB_FLASH_SIZE
+#define STUB_FLASH_SIZE         (0x10000u)
+#endif
+
+#define STUB_FLASH_SECTOR_SIZE  (8192u)
+#define STUB_FLASH_PHRASE_SIZE  (16u)
+
+typedef enum
+{
+    kStatus_HAL_Flash_Success         = 0,
+    kStatus_HAL_Flash_Fail            = 1,
+    kStatus_HAL_Flash_InvalidArgument = 2,
+    kStatus_HAL_Flash_AlignmentError  = 3,
+} hal_flash_status_t;
+
+/* Zero filled like a region reserved in the application image */
+static uint8_t  gaStubFlash[STUB_FLASH_SIZE];
+static uint32_t gStubFlashErases;
+static uint32_t gStubFlashPrograms;
+static int      gStubFlashFailProgram;
+
+static inline int Stub_FlashInRange(uint32_t addr, uint32_t size)
+{
+    return (addr >= STUB_FLASH_BASE) && (size <= STUB_FLASH_SIZE) &&
+           ((addr - STUB_FLASH_BASE) <= (STUB_FLASH_SIZE - size));
+}
+
+static inline hal_flash_status_t HAL_FlashInit(void)
+{
+    return kStatus_HAL_Flash_Success;
+}
+
+static inline hal_flash_status_t HAL_FlashEraseSector(uint32_t dest, uint32_t size)
+{
+    if (!Stub_FlashInRange(dest, size))
+    {
+        return kStatus_HAL_Flash_InvalidArgument;
+    }
+    if ((((dest - STUB_FLASH_BASE) % STUB_FLASH_SECTOR_SIZE) != 0u) || ((size % STUB_FLASH_SECTOR_SIZE) != 0u))
+    {
+        return kStatus_HAL_Flash_AlignmentError;
+    }
+    memset(&gaStubFlash[dest - STUB_FLASH_BASE], 0xFF, size);
+    gStubFlashErases++;
+    return kStatus_HAL_Flash_Success;
+}
+
+static inline hal_flash_status_t HAL_FlashProgram(uint32_t dest, uint32_t size, uint8_t *pData)
+{
+    uint8_t *pDst;
+
+    if (!Stub_FlashInRange(dest, size) || (gStubFlashFailProgram != 0))
+    {
+        return kStatus_HAL_Flash_Fail;
+    }
+    pDst = &gaStubFlash[dest - STUB_FLASH_BASE];
+    if ((((dest - STUB_FLASH_BASE) % STUB_FLASH_PHRASE_SIZE) != 0u) || ((size % STUB_FLASH_PHRASE_SIZE) != 0u))
+    {
+        return kStatus_HAL_Flash_AlignmentError;
+    }
+    for (uint32_t i = 0u; i < size; i++)
+    {
+        if (pDst[i] != 0xFFu)
+        {
+            return kStatus_HAL_Flash_Fail;      /* ECC flash: no overwrite without erase */
+        }
+    }
+    memcpy(pDst, pData, size);
+    gStubFlashPrograms++;
+    return kStatus_HAL_Flash_Success;
+}
+
+static inline hal_flash_status_t HAL_FlashRead(uint32_t src, uint32_t size, uint8_t *pData)
+{
+    if (!Stub_FlashInRange(src, size))
+    {
+        return kStatus_HAL_Flash_InvalidArgument;
+    }
+    memcpy(pData, &gaStubFlash[src - STUB_FLASH_BASE], size);
+    return kStatus_HAL_Flash_Success;
+}
+
+#endif /* FSL_ADAPTER_FLASH_STUB_H */
@@ -0,0 +1,40 @@
+/*! *********************************************************************************
+* \file fsl_common.h
+*
+* \brief  Host stand-in for the MCUXpresso SDK fsl_common.h, enough for the
+*         component headers (OSA, lists, messaging, mem manager, panic) that
+*         tests/test_app_conn.c compiles against.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef FSL_COMMON_STUB_H
+#define FSL_COMMON_STUB_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef int32_t status_t;
+
+#define MAKE_STATUS(group, code)        ((((group) * 100) + (code)))
+
+enum
+{
+    kStatusGroup_Generic     = 0,
+    kStatusGroup_OSA         = 143,
+    kStatusGroup_LIST        = 144,
+    kStatusGroup_MEM_MANAGER = 148,
+    kStatusGroup_MSG         = 149,
+};
+
+enum
+{
+    kStatus_Success = MAKE_STATUS(kStatusGroup_Generic, 0),
+    kStatus_Fail    = MAKE_STATUS(kStatusGroup_Generic, 1),
+};
+
+#endif /* FSL_COMMON_STUB_H */
@@ -0,0 +1,24 @@
+/*! *********************************************************************************
+* \file fsl_component_timer_manager.h
+*
+* \brief  Host stand-in for the timer manager, used by the unit tests and host
+*         tools. TM_GetTimestamp returns gStubTimestamp, which the caller sets
+*         before each call into the code under test.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef FSL_COMPONENT_TIMER_MANAGER_STUB_H
+#define FSL_COMPONENT_TIMER_MANAGER_STUB_H
+
+#include <stdint.h>
+
+static uint64_t gStubTimestamp;
+
+static inline uint64_t TM_GetTimestamp(void)
+{
+    return gStubTimestamp;
+}
+
+#endif /* FSL_COMPONENT_TIMER_MANAGER_STUB_H */
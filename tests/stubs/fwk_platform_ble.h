@@ -0,0 +1,15 @@
+/*! *********************************************************************************
+* \file fwk_platform_ble.h
+*
+* \brief  Host stand-in for the BLE platform header, which needs the device
+*         fwk_config.h.
+*         Nothing from it is used by the code tests/test_app_conn.c builds.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef FWK_PLATFORM_BLE_STUB_H
+#define FWK_PLATFORM_BLE_STUB_H
+
+#endif /* FWK_PLATFORM_BLE_STUB_H */
@@ -0,0 +1,243 @@
+/*! *********************************************************************************
+* \file test_addr_cache.c
+*
+* \brief  Unit tests for AddrCache — scanned identity address to bond cache.
+*         Runs on host machine (macOS/Linux). Tests the real addr_cache.c via
+*         #include: hits, set eviction order, flush, and bond table compares
+*         saved on the accept list scan.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "addr_cache"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "addr_cache.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+#define TYPE_PUBLIC     (0u)
+#define TYPE_RANDOM     (1u)
+#define BONDS           (8u)
+
+static uint32_t gLcg;
+
+static uint32_t Rand(void)
+{
+    gLcg = (gLcg * 1103515245u) + 12345u;
+    return gLcg >> 8;
+}
+
+/* Random static identity address (0b11 in the top bits) from a seed */
+static void Identity(uint32_t seed, uint8_t *pAddr)
+{
+    for (uint8_t i = 0u; i < ADDR_CACHE_ADDR_SIZE; i++)
+    {
+        seed = (seed * 2654435761u) + 0x9E3779B9u;
+        pAddr[i] = (uint8_t)(seed >> 24);
+    }
+    pAddr[5] |= 0xC0u;
+}
+
+/* n different addresses of the same set as pFirst */
+static void SameSet(const uint8_t *pFirst, uint8_t (*pOut)[ADDR_CACHE_ADDR_SIZE], uint32_t n)
+{
+    const addrCacheEntry_t *pSet = AddrCache_Set(TYPE_RANDOM, pFirst);
+    uint32_t seed = 1000u;
+
+    for (uint32_t k = 0u; k < n; seed++)
+    {
+        Identity(seed, pOut[k]);
+        if ((AddrCache_Set(TYPE_RANDOM, pOut[k]) == pSet) &&
+            (memcmp(pOut[k], pFirst, ADDR_CACHE_ADDR_SIZE) != 0))
+        {
+            k++;
+        }
+    }
+}
+
+/* Bond identities loaded at scan start */
+static uint8_t gaBonds[BONDS][ADDR_CACHE_ADDR_SIZE];
+
+/* Scan report path as in rssi_integration.c; returns the bond table compares it cost */
+static uint32_t Report(uint8_t bond, bool_t cached)
+{
+    uint8_t nvmIndex;
+
+    if ((cached == TRUE) && (AddrCache_Lookup(TYPE_RANDOM, gaBonds[bond], &nvmIndex) == TRUE))
+    {
+        return 0u;
+    }
+    if (cached == TRUE)
+    {
+        AddrCache_Insert(TYPE_RANDOM, gaBonds[bond], bond);
+    }
+    /* Linear match over the bond table */
+    return (uint32_t)bond + 1u;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_hits(void)
+{
+    static const uint8_t aIdentity[ADDR_CACHE_ADDR_SIZE] = {0x11u, 0x22u, 0x33u, 0x44u, 0x55u, 0x66u};
+    uint8_t aOther[ADDR_CACHE_ADDR_SIZE];
+    addrCacheStats_t stats;
+    uint8_t nvmIndex = 0u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Bond entries, type is part of the key\n");
+
+    AddrCache_Init();
+    Identity(1u, aOther);
+
+    TEST_ASSERT(AddrCache_Lookup(TYPE_PUBLIC, aIdentity, &nvmIndex) == FALSE, "Empty cache misses");
+    AddrCache_Insert(TYPE_PUBLIC, aIdentity, 3u);
+    AddrCache_Insert(TYPE_RANDOM, aOther, 1u);
+
+    TEST_ASSERT((AddrCache_Lookup(TYPE_PUBLIC, aIdentity, &nvmIndex) == TRUE) && (nvmIndex == 3u), "Bond hit");
+    TEST_ASSERT((AddrCache_Lookup(TYPE_RANDOM, aOther, &nvmIndex) == TRUE) && (nvmIndex == 1u), "Other bond hit");
+    TEST_ASSERT(AddrCache_Lookup(TYPE_RANDOM, aIdentity, &nvmIndex) == FALSE, "Same bytes, other type");
+
+    /* Re-insert updates in place */
+    AddrCache_Insert(TYPE_RANDOM, aOther, 2u);
+    TEST_ASSERT((AddrCache_Lookup(TYPE_RANDOM, aOther, &nvmIndex) == TRUE) && (nvmIndex == 2u), "Updated");
+
+    TEST_ASSERT(AddrCache_Lookup(TYPE_RANDOM, NULL, &nvmIndex) == FALSE, "NULL-safe lookup");
+    AddrCache_Insert(TYPE_RANDOM, NULL, 1u);
+
+    AddrCache_GetStats(&stats);
+    TEST_ASSERT((stats.hits == 3u) && (stats.misses == 3u), "Counters");
+    TEST_ASSERT((stats.entries == 2u) && (stats.evictions == 0u), "Two entries");
+
+    TEST_PASS("Bond entries, type is part of the key");
+}
+
+static void test_eviction(void)
+{
+    uint8_t aAddr[ADDR_CACHE_WAYS + 1u][ADDR_CACHE_ADDR_SIZE];
+    addrCacheStats_t stats;
+    uint8_t nvmIndex;
+    uint32_t k;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Full set: least recently used entry evicted\n");
+
+    AddrCache_Init();
+    Identity(7u, aAddr[0]);
+    SameSet(aAddr[0], &aAddr[1], ADDR_CACHE_WAYS);
+
+    for (k = 0u; k < ADDR_CACHE_WAYS; k++)
+    {
+        AddrCache_Insert(TYPE_RANDOM, aAddr[k], (uint8_t)k);
+    }
+    /* Oldest entry used again: the next one is the LRU */
+    (void)AddrCache_Lookup(TYPE_RANDOM, aAddr[0], &nvmIndex);
+
+    AddrCache_Insert(TYPE_RANDOM, aAddr[ADDR_CACHE_WAYS], (uint8_t)ADDR_CACHE_WAYS);
+    TEST_ASSERT((AddrCache_Lookup(TYPE_RANDOM, aAddr[0], &nvmIndex) == TRUE) && (nvmIndex == 0u),
+                "Used entry kept");
+    TEST_ASSERT(AddrCache_Lookup(TYPE_RANDOM, aAddr[1], &nvmIndex) == FALSE, "LRU entry evicted");
+    TEST_ASSERT((AddrCache_Lookup(TYPE_RANDOM, aAddr[ADDR_CACHE_WAYS], &nvmIndex) == TRUE) &&
+                (nvmIndex == ADDR_CACHE_WAYS), "New entry in its place");
+
+    AddrCache_GetStats(&stats);
+    TEST_ASSERT((stats.evictions == 1u) && (stats.entries == ADDR_CACHE_WAYS), "Counters");
+
+    TEST_PASS("Full set: least recently used entry evicted");
+}
+
+static void test_flush(void)
+{
+    uint8_t aAddr[ADDR_CACHE_ADDR_SIZE];
+    addrCacheStats_t stats;
+    uint8_t nvmIndex;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Flush on a bond change, counters kept\n");
+
+    AddrCache_Init();
+    Identity(31u, aAddr);
+
+    /* Phone bonded again in another slot: the old index must not survive */
+    AddrCache_Insert(TYPE_RANDOM, aAddr, 4u);
+    (void)AddrCache_Lookup(TYPE_RANDOM, aAddr, &nvmIndex);
+    AddrCache_Flush();
+    TEST_ASSERT(AddrCache_Lookup(TYPE_RANDOM, aAddr, &nvmIndex) == FALSE, "Old entry gone");
+    AddrCache_Insert(TYPE_RANDOM, aAddr, 0u);
+    TEST_ASSERT((AddrCache_Lookup(TYPE_RANDOM, aAddr, &nvmIndex) == TRUE) && (nvmIndex == 0u), "New bond");
+
+    AddrCache_GetStats(&stats);
+    TEST_ASSERT((stats.hits == 2u) && (stats.misses == 1u) && (stats.entries == 1u), "Counters kept");
+
+    TEST_PASS("Flush on a bond change, counters kept");
+}
+
+static void test_scan_reports(void)
+{
+    addrCacheStats_t stats;
+    uint32_t cmpCached = 0u;
+    uint32_t cmpPlain = 0u;
+    uint32_t k;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Accept list scan: bond table compares with and without the cache\n");
+
+    gLcg = 5u;
+    AddrCache_Init();
+    for (k = 0u; k < BONDS; k++)
+    {
+        Identity(5000u + k, gaBonds[k]);
+    }
+
+    /* Full bond table, two phones around the car (bonds 5 and 7) */
+    for (k = 0u; k < 20000u; k++)
+    {
+        uint8_t bond = ((Rand() & 1u) == 0u) ? 5u : 7u;
+
+        cmpCached += Report(bond, TRUE);
+        cmpPlain += Report(bond, FALSE);
+    }
+
+    AddrCache_GetStats(&stats);
+    tprintf("  %u bond table compares with the cache, %u without\n",
+            (unsigned)cmpCached, (unsigned)cmpPlain);
+    TEST_ASSERT(stats.misses == 2u, "One miss per phone");
+    TEST_ASSERT(stats.hits == 20000u - 2u, "Then hits only");
+    TEST_ASSERT(stats.entries == 2u, "Only the phones seen are cached");
+
+    /* The whole bond table fits, these identities spread over the sets */
+    for (k = 0u; k < BONDS; k++)
+    {
+        (void)Report((uint8_t)k, TRUE);
+    }
+    AddrCache_GetStats(&stats);
+    TEST_ASSERT((stats.entries == BONDS) && (stats.evictions == 0u), "Bond table cached without eviction");
+
+    TEST_PASS("Accept list scan: bond table compares with and without the cache");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "AddrCache Unit Tests (Hits + Eviction + Flush)", &xmlPath);
+
+    RUN_TEST(test_hits);
+    RUN_TEST(test_eviction);
+    RUN_TEST(test_flush);
+    RUN_TEST(test_scan_reports);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,172 @@
+/*! *********************************************************************************
+* \file test_adv_sched.c
+*
+* \brief  Unit tests for AdvSched — Passive Entry advertising profile from the
+*         vehicle context. Runs on host machine (macOS/Linux). Tests the real
+*         adv_sched.c through the simulator in tools/adv_sched_sim.c: level by
+*         idle time, FAST extension on disconnect and nearby phones, clock wrap,
+*         and discovery latency against duty cycle per profile.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "adv_sched"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation (through the simulator)
+ ******************************************************************************/
+#define ADV_SIM_NO_MAIN
+#include "adv_sched_sim.c"
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_levels(void)
+{
+    advSchedProfile_t p;
+    const uint32_t t0 = 1000u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Level by time since start, hold until the next one\n");
+
+    AdvSched_Init(t0);
+    TEST_ASSERT(AdvSched_Select(t0, &p) == TRUE, "First selection is a change");
+    TEST_ASSERT(p.level == advSchedFast_c, "FAST at start");
+    TEST_ASSERT(p.holdS == ADV_SCHED_RECONNECT_S, "Held for the reconnect time");
+    TEST_ASSERT((p.minInterval == gcAdvSimCccLegacy) && (p.codedInterval == gcAdvSimCccCoded), "CCC intervals");
+    TEST_ASSERT(AdvSched_Select(t0 + 1u, &p) == FALSE, "Same level, no change");
+
+    TEST_ASSERT(AdvSched_Select(t0 + ADV_SCHED_RECONNECT_S, &p) == TRUE, "Change at the end of FAST");
+    TEST_ASSERT(p.level == advSchedActive_c, "ACTIVE after FAST");
+    TEST_ASSERT(p.holdS == (ADV_SCHED_RECENT_S - ADV_SCHED_RECONNECT_S), "Held until RECENT");
+
+    (void)AdvSched_Select(t0 + ADV_SCHED_RECENT_S, &p);
+    TEST_ASSERT((p.level == advSchedReduced_c) && (p.codedInterval == 0u), "REDUCED, legacy only");
+    TEST_ASSERT(p.holdS == (ADV_SCHED_PARKED_S - ADV_SCHED_RECENT_S), "Held until PARKED");
+
+    (void)AdvSched_Select(t0 + ADV_SCHED_PARKED_S, &p);
+    TEST_ASSERT((p.level == advSchedParked_c) && (p.holdS == 0u), "PARKED for good");
+    TEST_ASSERT(AdvSched_Select(t0 + 86400u, NULL) == FALSE, "Still PARKED a day later");
+
+    TEST_PASS("Level by time since start, hold until the next one");
+}
+
+static void test_events(void)
+{
+    advSchedProfile_t p;
+    const uint32_t t0 = 50u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Disconnect, unlock and nearby phone\n");
+
+    AdvSched_Init(t0);
+    (void)AdvSched_Select(t0 + 20000u, &p);
+    TEST_ASSERT(p.level == advSchedParked_c, "Parked");
+
+    AdvSched_PeerNearby(t0 + 20000u);
+    TEST_ASSERT((AdvSched_Select(t0 + 20000u, &p) == TRUE) && (p.level == advSchedFast_c), "Nearby: FAST");
+    TEST_ASSERT(p.holdS == ADV_SCHED_NEARBY_S, "For the nearby time");
+
+    /* A disconnect during a short FAST extends it, a nearby report does not shorten it */
+    AdvSched_Disconnected(t0 + 20005u);
+    AdvSched_PeerNearby(t0 + 20006u);
+    (void)AdvSched_Select(t0 + 20006u, &p);
+    TEST_ASSERT(p.holdS == (ADV_SCHED_RECONNECT_S - 1u), "Longest FAST wins");
+
+    (void)AdvSched_Select(t0 + 20005u + ADV_SCHED_RECONNECT_S, &p);
+    TEST_ASSERT(p.level == advSchedActive_c, "ACTIVE after it");
+
+    /* An unlock keeps the car in use without FAST */
+    AdvSched_Unlocked(t0 + 20500u);
+    (void)AdvSched_Select(t0 + 20500u + ADV_SCHED_RECENT_S - 1u, &p);
+    TEST_ASSERT((p.level == advSchedActive_c) && (p.holdS == 1u), "ACTIVE from the unlock");
+
+    TEST_PASS("Disconnect, unlock and nearby phone");
+}
+
+static void test_wrap(void)
+{
+    advSchedProfile_t p;
+    const uint32_t t0 = 0xFFFFFFF0u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Clock wrap\n");
+
+    AdvSched_Init(t0);
+    (void)AdvSched_Select(t0 + 20u, &p);
+    TEST_ASSERT((p.level == advSchedFast_c) && (p.holdS == (ADV_SCHED_RECONNECT_S - 20u)), "FAST across the wrap");
+    (void)AdvSched_Select(t0 + ADV_SCHED_RECONNECT_S + 1u, &p);
+    TEST_ASSERT(p.level == advSchedActive_c, "ACTIVE across the wrap");
+    (void)AdvSched_Select(t0 + ADV_SCHED_PARKED_S, &p);
+    TEST_ASSERT(p.level == advSchedParked_c, "PARKED across the wrap");
+
+    TEST_PASS("Clock wrap");
+}
+
+static void test_latency_duty(void)
+{
+    advSimLatency_t aLat[ADV_SIM_PROFILES];
+    double aDuty[ADV_SIM_PROFILES];
+    bool_t ordered = TRUE;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Discovery latency against duty cycle per profile\n");
+
+    for (uint32_t p = 0u; p < ADV_SIM_PROFILES; p++)
+    {
+        AdvSim_Latency(p, advSimFg_c, 4000u, 10u, 7u, &aLat[p]);
+        aDuty[p] = AdvSim_Duty(p);
+        tprintf("    %-8s mean %6.0f ms  p95 %6u ms  duty %.3f %%\n", gaAdvSimProfileNames[p], aLat[p].meanMs,
+                aLat[p].p95Ms, 100.0 * aDuty[p]);
+    }
+    for (uint32_t p = 1u; p < (uint32_t)advSchedLevelCount_c; p++)
+    {
+        ordered = ((aLat[p].meanMs > aLat[p - 1u].meanMs) && (aDuty[p] < aDuty[p - 1u])) ? ordered : FALSE;
+    }
+    TEST_ASSERT(ordered == TRUE, "Each sparser profile: longer discovery, lower duty");
+    TEST_ASSERT(aLat[advSchedFast_c].p95Ms < 150u, "FAST found within a few events by a foreground scan");
+    TEST_ASSERT(aDuty[advSchedParked_c] < (aDuty[ADV_SIM_STATIC] / 100.0), "PARKED below 1 % of the static duty");
+    TEST_ASSERT(aLat[advSchedParked_c].missed == 0u, "PARKED still found by a foreground scan");
+
+    TEST_PASS("Discovery latency against duty cycle per profile");
+}
+
+static void test_day(void)
+{
+    advSimDay_t day;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Day replay: radio time and quick returns\n");
+
+    AdvSim_Day(advSimFg_c, 10u, 3u, &day);
+    tprintf("    radio %.1f s static, %.1f s scheduled\n", day.radioS[0], day.radioS[1]);
+
+    TEST_ASSERT(day.approaches == 4u, "All approaches replayed");
+    TEST_ASSERT(day.radioS[1] < (day.radioS[0] / 10.0), "Less than a tenth of the static radio time");
+    TEST_ASSERT(day.aLevel[0] != advSchedParked_c, "Forgotten bag: car still in use");
+    TEST_ASSERT(day.aLevel[3] == advSchedActive_c, "Turned back after a minute: ACTIVE");
+    TEST_ASSERT(day.aLevel[1] == advSchedParked_c, "Next morning: PARKED");
+
+    TEST_PASS("Day replay: radio time and quick returns");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "AdvSched Unit Tests (Levels + Events + Latency/Duty)", &xmlPath);
+
+    RUN_TEST(test_levels);
+    RUN_TEST(test_events);
+    RUN_TEST(test_wrap);
+    RUN_TEST(test_latency_duty);
+    RUN_TEST(test_day);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,677 @@
+/*! *********************************************************************************
+* \file test_app_conn.c
+*
+* \brief  Unit tests for the application message drain of app_conn.c —
+*         host stack message order, critical and bulk lanes, drain budget and
+*         cap, critical latency under a synthetic load and post time stamps.
+*         Runs on host machine (macOS/Linux). Builds the real app_conn.c via
+*         #include with the car anchor app_preinclude.h, on the real BLE host
+*         and component headers; the framework calls it makes are emulated below.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/* As the example builds it */
+#include "app_preinclude.h"
+
+#define TEST_SUITE_NAME "app_conn"
+#include "test_framework.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "app_conn.c"
+#include "cs_latency.c"
+#include "msg_lane.c"
+#include "msg_ref.c"
+
+/*******************************************************************************
+ * Framework emulation: messaging, lists, OSA and the host stack registrations
+ ******************************************************************************/
+
+typedef struct
+{
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t events;            /* OSA_EventSet calls */
+} hostCounters_t;
+
+static hostCounters_t gHost;
+
+void LIST_Init(list_handle_t list, uint32_t max)
+{
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0u;
+    list->max  = max;
+}
+
+uint32_t LIST_GetSize(list_handle_t list)
+{
+    return list->size;
+}
+
+/* Messages carry their list element in front of the buffer, as with MSG_Alloc,
+   and MSG_Free takes a message still queued off its queue first */
+static void Sim_ListRemove(list_element_t *pElem)
+{
+    list_handle_t list = pElem->list;
+    list_element_t *pPrev = NULL;
+    list_element_t *pCur = list->head;
+
+    while ((pCur != NULL) && (pCur != pElem))
+    {
+        pPrev = pCur;
+        pCur = pCur->next;
+    }
+    if (pCur != NULL)
+    {
+        if (pPrev == NULL)
+        {
+            list->head = pElem->next;
+        }
+        else
+        {
+            pPrev->next = pElem->next;
+        }
+        if (list->tail == pElem)
+        {
+            list->tail = pPrev;
+        }
+        list->size--;
+    }
+    pElem->next = NULL;
+    pElem->list = NULL;
+}
+
+void *MSG_Alloc(uint32_t length)
+{
+    list_element_t *pElem = calloc(1u, sizeof(list_element_t) + length);
+
+    if (pElem == NULL)
+    {
+        return NULL;
+    }
+    gHost.allocs++;
+    return (void *)(pElem + 1);
+}
+
+void MSG_Free(void *buffer)
+{
+    list_element_t *pElem = (list_element_t *)buffer - 1;
+
+    if (buffer != NULL)
+    {
+        if (pElem->list != NULL)
+        {
+            Sim_ListRemove(pElem);
+        }
+        gHost.frees++;
+        free(pElem);
+    }
+}
+
+messaging_status_t MSG_QueueAddTail(messaging_t *msgQueue, void *msg)
+{
+    list_element_t *pElem = (list_element_t *)msg - 1;
+
+    pElem->next = NULL;
+    pElem->list = msgQueue;
+    if (msgQueue->tail == NULL)
+    {
+        msgQueue->head = pElem;
+    }
+    else
+    {
+        msgQueue->tail->next = pElem;
+    }
+    msgQueue->tail = pElem;
+    msgQueue->size++;
+    return kMSG_Success;
+}
+
+void *MSG_QueueGetHead(messaging_t *msgQueue)
+{
+    return (msgQueue->head == NULL) ? NULL : (void *)(msgQueue->head + 1);
+}
+
+void *MSG_QueueRemoveHead(messaging_t *msgQueue)
+{
+    list_element_t *pElem = msgQueue->head;
+
+    if (pElem == NULL)
+    {
+        return NULL;
+    }
+    Sim_ListRemove(pElem);
+    return (void *)(pElem + 1);
+}
+
+osa_status_t OSA_EventCreate(osa_event_handle_t eventHandle, uint8_t autoClear)
+{
+    (void)eventHandle;
+    (void)autoClear;
+    return KOSA_StatusSuccess;
+}
+
+osa_status_t OSA_EventSet(osa_event_handle_t eventHandle, osa_event_flags_t flagsToSet)
+{
+    (void)eventHandle;
+    (void)flagsToSet;
+    gHost.events++;
+    return KOSA_StatusSuccess;
+}
+
+void OSA_InterruptDisable(void) {}
+void OSA_InterruptEnable(void) {}
+mem_status_t MEM_Init(void) { return kStatus_MemSuccess; }
+void panic(panic_id_t id, uint32_t location, uint32_t extra1, uint32_t extra2)
+{
+    (void)id; (void)location; (void)extra1; (void)extra2;
+    abort();
+}
+void SecLib_Init(void) {}
+int RNG_Init(void) { return 0; }
+osa_status_t Controller_SetRandomSeed(void) { return KOSA_StatusSuccess; }
+osa_status_t Controller_SetTxPowerLevelDbm(int8_t level_dbm, txChannelType_t channel)
+{
+    (void)level_dbm; (void)channel;
+    return KOSA_StatusSuccess;
+}
+osa_status_t Controller_ConfigureInvalidPduHandling(uint32_t pdu_handling_type)
+{
+    (void)pdu_handling_type;
+    return KOSA_StatusSuccess;
+}
+bleResult_t Ble_Initialize(gapGenericCallback_t gapGenericCallback)
+{
+    (void)gapGenericCallback;
+    return gBleSuccess_c;
+}
+bleResult_t Ble_DeInitialize(void) { return gBleSuccess_c; }
+NVM_Status_t NvModuleInit(void) { return gNVM_OK_c; }
+int NvIdle(void) { return 0; }
+bool_t NvIsPendingOperation(void) { return FALSE; }
+int PLATFORM_GetRadioIdleDuration32K(void) { return 0; }
+bleResult_t GattServer_RegisterCallback(gattServerCallback_t callback)
+{
+    (void)callback;
+    return gBleSuccess_c;
+}
+bleResult_t GattClient_RegisterProcedureCallback(gattClientProcedureCallback_t callback)
+{
+    (void)callback;
+    return gBleSuccess_c;
+}
+bleResult_t GattClient_RegisterNotificationCallback(gattClientNotificationCallback_t callback)
+{
+    (void)callback;
+    return gBleSuccess_c;
+}
+bleResult_t GattClient_RegisterIndicationCallback(gattClientIndicationCallback_t callback)
+{
+    (void)callback;
+    return gBleSuccess_c;
+}
+bleResult_t L2ca_RegisterLeCbCallbacks(l2caLeCbDataCallback_t pCallback,
+                                       l2caLeCbControlCallback_t pCtrlCallback)
+{
+    (void)pCallback;
+    (void)pCtrlCallback;
+    return gBleSuccess_c;
+}
+
+/*******************************************************************************
+ * Application side: every handled message is logged with its sequence number
+ ******************************************************************************/
+
+#define SIM_MAX_MSGS            (4096u)
+#define SIM_DK_CHANNEL          (0x0041u)
+
+typedef enum
+{
+    simKindHost = 0,            /* Host stack message */
+    simKindCritical,            /* App_PostCallbackMessageLane critical */
+    simKindBulk,                /* App_PostCallbackMessage */
+} simKind_t;
+
+typedef struct
+{
+    uint32_t postedUs;
+    uint32_t costUs;
+    uint8_t  kind;
+} simMsg_t;
+
+static simMsg_t gaSimMsgs[SIM_MAX_MSGS];
+static uint16_t gSimPosted;
+static uint16_t gaSimLog[SIM_MAX_MSGS];
+static uint16_t gSimHandled;
+static uint32_t gaSimMaxWaitUs[3];
+static uint16_t gSimBadStamps;      /* App_GetMsgPostedUs not the post time */
+
+static void Sim_Handle(uint16_t seq)
+{
+    uint32_t waitUs = (uint32_t)gStubTimestamp - gaSimMsgs[seq].postedUs;
+    uint32_t postedUs = 0u;
+
+    if ((App_GetMsgPostedUs(&postedUs) == FALSE) || (postedUs != gaSimMsgs[seq].postedUs))
+    {
+        gSimBadStamps++;
+    }
+
+    if (waitUs > gaSimMaxWaitUs[gaSimMsgs[seq].kind])
+    {
+        gaSimMaxWaitUs[gaSimMsgs[seq].kind] = waitUs;
+    }
+    gaSimLog[gSimHandled++] = seq;
+    gStubTimestamp += gaSimMsgs[seq].costUs;
+}
+
+static uint16_t Sim_NewMsg(simKind_t kind, uint32_t costUs)
+{
+    uint16_t seq = gSimPosted++;
+
+    gaSimMsgs[seq].postedUs = (uint32_t)gStubTimestamp;
+    gaSimMsgs[seq].costUs = costUs;
+    gaSimMsgs[seq].kind = (uint8_t)kind;
+    return seq;
+}
+
+/* Host stack callbacks, as registered by the application */
+static void Sim_ConnectionCallback(deviceId_t peerDeviceId, gapConnectionEvent_t *pConnectionEvent)
+{
+    (void)peerDeviceId;
+    Sim_Handle((uint16_t)pConnectionEvent->eventData.rssi_dBm);
+}
+
+static void Sim_NotificationCallback(deviceId_t deviceId, uint16_t handle, uint8_t *aValue, uint16_t length)
+{
+    (void)deviceId;
+    (void)aValue;
+    (void)length;
+    Sim_Handle(handle);
+}
+
+static void Sim_L2caDataCallback(deviceId_t deviceId, uint16_t channelId, uint8_t *pPacket, uint16_t length)
+{
+    (void)deviceId;
+    (void)channelId;
+    (void)length;
+    Sim_Handle((uint16_t)(pPacket[0] | ((uint16_t)pPacket[1] << 8)));
+}
+
+static void Sim_L2caControlCallback(l2capControlMessage_t *pMessage)
+{
+    (void)pMessage;
+}
+
+static void Sim_AppCallback(appCallbackParam_t param)
+{
+    Sim_Handle((uint16_t)(uintptr_t)param);
+}
+
+/* Connection event, queued the way app_connection.c does. The sequence number
+   (below 128) rides in the event data, the handler ignores the event type */
+static void Sim_PostConnEvent(gapConnectionEventType_t type, uint32_t costUs)
+{
+    uint16_t seq = Sim_NewMsg(simKindHost, costUs);
+    appMsgFromHost_t *pMsgIn = MSG_Alloc(GetRelAddr(appMsgFromHost_t, msgData) + sizeof(connectionMsg_t));
+
+    pMsgIn->msgType = (uint32_t)gAppGapConnectionMsg_c;
+    pMsgIn->msgData.connMsg.deviceId = 0u;
+    pMsgIn->msgData.connMsg.connEvent.eventType = type;
+    pMsgIn->msgData.connMsg.connEvent.eventData.rssi_dBm = (int8_t)seq;
+    (void)App_QueueHostMessage(pMsgIn);
+    (void)OSA_EventSet(mAppEvent, gAppEvtMsgFromHostStack_c);
+}
+
+/* GATT notification, e.g. a RAS segment */
+static void Sim_PostNotification(uint32_t costUs)
+{
+    uint16_t seq = Sim_NewMsg(simKindHost, costUs);
+    uint8_t aValue[20] = {0u};
+
+    App_GattClientNotificationCallback(0u, seq, aValue, (uint16_t)sizeof(aValue));
+}
+
+/* L2CAP LE data, e.g. a Digital Key message */
+static void Sim_PostL2caData(uint16_t length, uint32_t costUs)
+{
+    uint16_t seq = Sim_NewMsg(simKindHost, costUs);
+    uint8_t aPacket[300] = {0u};
+
+    aPacket[0] = (uint8_t)seq;
+    aPacket[1] = (uint8_t)(seq >> 8);
+    App_L2caLeDataCallback(0u, SIM_DK_CHANNEL, aPacket, length);
+}
+
+static void Sim_PostCallback(simKind_t kind, uint32_t costUs)
+{
+    uint16_t seq = Sim_NewMsg(kind, costUs);
+
+    (void)App_PostCallbackMessageLane(Sim_AppCallback, (appCallbackParam_t)(uintptr_t)seq,
+                                      (kind == simKindCritical) ? gAppMsgLaneCritical_c : gAppMsgLaneBulk_c);
+}
+
+static void Sim_Reset(void)
+{
+    BluetoothLEHost_Init(NULL);
+    pfConnCallback = Sim_ConnectionCallback;
+    (void)App_RegisterGattClientNotificationCallback(Sim_NotificationCallback);
+    (void)App_RegisterLeCbCallbacks(Sim_L2caDataCallback, Sim_L2caControlCallback);
+    BluetoothLEHost_ResetMsgStats();
+    memset(&gHost, 0, sizeof(gHost));
+    memset(gaSimMaxWaitUs, 0, sizeof(gaSimMaxWaitUs));
+    gSimPosted = 0u;
+    gSimHandled = 0u;
+    gSimBadStamps = 0u;
+    gStubTimestamp = 1000000u;
+}
+
+static void Sim_DrainAll(void)
+{
+    uint32_t passes = 0u;
+
+    while ((BluetoothLEHost_IsMessagePending() == TRUE) && (passes < 100000u))
+    {
+        BluetoothLEHost_HandleMessages();
+        passes++;
+    }
+}
+
+/* Position of a message in the handling log, gSimHandled if not handled */
+static uint16_t Sim_LogPos(uint16_t seq)
+{
+    uint16_t i;
+
+    for (i = 0u; i < gSimHandled; i++)
+    {
+        if (gaSimLog[i] == seq)
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_host_order_kept(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Host stack messages of a connection keep their order\n");
+
+    uint16_t i;
+    uint16_t lastHost = 0u;
+    bool_t inOrder = TRUE;
+
+    Sim_Reset();
+
+    /* A mix the old per type sorting reordered: short L2CAP data and connection
+       events used to overtake GATT notifications and long L2CAP data */
+    Sim_PostNotification(50u);                      /* 0 */
+    Sim_PostCallback(simKindBulk, 50u);             /* 1 */
+    Sim_PostL2caData(250u, 50u);                    /* 2 */
+    Sim_PostL2caData(16u, 50u);                     /* 3 */
+    Sim_PostCallback(simKindCritical, 50u);         /* 4 */
+    Sim_PostConnEvent(gConnEvtRssiRead_c, 50u);     /* 5 */
+    Sim_PostNotification(50u);                      /* 6 */
+    Sim_PostL2caData(250u, 50u);                    /* 7 */
+    Sim_PostConnEvent(gConnEvtDisconnected_c, 50u); /* 8 */
+
+    Sim_DrainAll();
+
+    TEST_ASSERT(gSimHandled == gSimPosted, "Everything handled");
+    for (i = 0u; i < gSimHandled; i++)
+    {
+        if (gaSimMsgs[gaSimLog[i]].kind == (uint8_t)simKindHost)
+        {
+            if (gaSimLog[i] < lastHost)
+            {
+                inOrder = FALSE;
+            }
+            lastHost = gaSimLog[i];
+        }
+    }
+    TEST_ASSERT(inOrder == TRUE, "Host stack messages handled in the order they were queued");
+    TEST_ASSERT(gHost.allocs == gHost.frees, "Every message freed");
+
+    TEST_PASS("Host stack messages of a connection keep their order");
+}
+
+static void test_critical_ahead_of_bulk(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Host stack messages and critical callbacks go ahead of bulk callbacks\n");
+
+    uint16_t i;
+    uint16_t rssi;
+    uint16_t cs;
+
+    Sim_Reset();
+
+    /* Shell bond listing queued first, then an RSSI read and a CS callback */
+    for (i = 0u; i < 10u; i++)
+    {
+        Sim_PostCallback(simKindBulk, 100u);
+    }
+    rssi = gSimPosted;
+    Sim_PostConnEvent(gConnEvtRssiRead_c, 100u);
+    cs = gSimPosted;
+    Sim_PostCallback(simKindCritical, 100u);
+
+    BluetoothLEHost_HandleMessages();
+
+    TEST_ASSERT((Sim_LogPos(rssi) < 2u) && (Sim_LogPos(cs) < 2u), "Critical lane handled first");
+    Sim_DrainAll();
+    TEST_ASSERT(gSimHandled == gSimPosted, "Bulk callbacks handled after");
+    for (i = 0u; i < 10u; i++)
+    {
+        TEST_ASSERT(Sim_LogPos(i) == (uint16_t)(i + 2u), "Bulk callbacks in their order");
+    }
+    TEST_ASSERT(gHost.allocs == gHost.frees, "Every message freed");
+
+    TEST_PASS("Host stack messages and critical callbacks go ahead of bulk callbacks");
+}
+
+static void test_bulk_not_starved(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] A flood of host stack messages lets bulk callbacks through\n");
+
+    uint16_t i;
+
+    Sim_Reset();
+
+    Sim_PostCallback(simKindBulk, 10u);
+    for (i = 0u; i < (uint16_t)(3u * MSG_LANE_CRITICAL_BURST); i++)
+    {
+        Sim_PostNotification(10u);
+    }
+    Sim_PostCallback(simKindBulk, 10u);
+
+    Sim_DrainAll();
+
+    TEST_ASSERT(gSimHandled == gSimPosted, "Everything handled");
+    TEST_ASSERT(Sim_LogPos(0u) == MSG_LANE_CRITICAL_BURST, "First bulk callback after one critical burst");
+    TEST_ASSERT(Sim_LogPos((uint16_t)(gSimPosted - 1u)) == (uint16_t)(2u * MSG_LANE_CRITICAL_BURST + 1u),
+                "Second bulk callback after the next burst");
+
+    TEST_PASS("A flood of host stack messages lets bulk callbacks through");
+}
+
+static void test_drain_budget_and_cap(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Drain passes stop at the time budget or the message cap\n");
+
+    appHostMsgStats_t stats;
+    uint16_t i;
+    uint32_t perPass = (gAppHostMsgDrainBudgetUs_c + 699u) / 700u;
+
+    /* Slow handlers: the budget ends the pass */
+    Sim_Reset();
+    for (i = 0u; i < 10u; i++)
+    {
+        Sim_PostNotification(700u);
+    }
+    BluetoothLEHost_HandleMessages();
+    BluetoothLEHost_GetMsgStats(&stats);
+    TEST_ASSERT(gSimHandled == perPass, "Pass stopped once over budget");
+    TEST_ASSERT((stats.budgetExits == 1u) && (stats.capExits == 0u), "Counted as a budget exit");
+
+    /* Fast handlers: the cap ends the pass */
+    Sim_Reset();
+    for (i = 0u; i < (uint16_t)(2u * gAppHostMsgDrainMax_c); i++)
+    {
+        Sim_PostNotification(0u);
+    }
+    BluetoothLEHost_HandleMessages();
+    BluetoothLEHost_GetMsgStats(&stats);
+    TEST_ASSERT(gSimHandled == gAppHostMsgDrainMax_c, "Pass stopped at the cap");
+    TEST_ASSERT((stats.budgetExits == 0u) && (stats.capExits == 1u), "Counted as a cap exit");
+
+    /* Everything fits: neither */
+    BluetoothLEHost_HandleMessages();
+    BluetoothLEHost_GetMsgStats(&stats);
+    TEST_ASSERT(BluetoothLEHost_IsMessagePending() == FALSE, "Queue drained");
+    TEST_ASSERT((stats.budgetExits == 0u) && (stats.capExits == 1u), "Complete pass not counted");
+    TEST_ASSERT((stats.hostMsgs == 2u * gAppHostMsgDrainMax_c) && (stats.wakeups == 2u), "Messages and passes");
+
+    TEST_PASS("Drain passes stop at the time budget or the message cap");
+}
+
+static void test_critical_latency_under_load(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Critical latency stays bounded under a bulk load\n");
+
+    const uint32_t startUs = 1000000u;
+    const uint32_t maxBulkUs = 4000u;
+    const uint32_t critBurstUs = (12u * 300u) + 150u + 200u;
+    uint32_t t;
+    uint32_t i;
+
+    Sim_Reset();
+
+    /* 2 s in 1 ms steps: CS callbacks, RAS segments and DK messages against
+       shell bond listings and long shell commands */
+    for (t = 0u; t < 2000000u; t += 1000u)
+    {
+        if (gStubTimestamp < (uint64_t)(startUs + t))
+        {
+            gStubTimestamp = startUs + t;
+        }
+        if ((t % 100000u) == 0u)
+        {
+            Sim_PostCallback(simKindCritical, 150u);
+        }
+        if ((t % 200000u) == 41000u)
+        {
+            for (i = 0u; i < 12u; i++)
+            {
+                Sim_PostNotification(300u);
+            }
+        }
+        if (((t % 500000u) >= 77000u) && ((t % 500000u) < 167000u) && (((t % 500000u) - 77000u) % 9000u == 0u))
+        {
+            Sim_PostL2caData(64u, 200u);
+        }
+        if ((t % 250000u) == 40000u)
+        {
+            for (i = 0u; i < 20u; i++)
+            {
+                Sim_PostCallback(simKindBulk, 2000u);
+            }
+        }
+        if ((t % 300000u) == 75000u)
+        {
+            for (i = 0u; i < 5u; i++)
+            {
+                Sim_PostCallback(simKindBulk, maxBulkUs);
+            }
+        }
+
+        while ((BluetoothLEHost_IsMessagePending() == TRUE) && (gStubTimestamp < (uint64_t)(startUs + t + 1000u)))
+        {
+            BluetoothLEHost_HandleMessages();
+        }
+    }
+    Sim_DrainAll();
+
+    tprintf("  max wait (us): host %u, critical callbacks %u, bulk %u\n",
+            (unsigned)gaSimMaxWaitUs[simKindHost], (unsigned)gaSimMaxWaitUs[simKindCritical],
+            (unsigned)gaSimMaxWaitUs[simKindBulk]);
+
+    TEST_ASSERT(gSimHandled == gSimPosted, "Everything handled");
+    /* Not preempted: the bulk handler running, one let through per critical burst,
+       and the critical work queued ahead */
+    TEST_ASSERT(gaSimMaxWaitUs[simKindHost] <= (2u * maxBulkUs) + critBurstUs, "Host stack messages bounded");
+    TEST_ASSERT(gaSimMaxWaitUs[simKindCritical] <= (2u * maxBulkUs) + critBurstUs, "Critical callbacks bounded");
+    TEST_ASSERT(gaSimMaxWaitUs[simKindBulk] > (2u * maxBulkUs) + critBurstUs, "Bulk waits longer");
+    TEST_ASSERT(gSimBadStamps == 0u, "Handlers see the post time of their message");
+    TEST_ASSERT(gHost.allocs == gHost.frees, "Every message freed");
+
+    TEST_PASS("Critical latency stays bounded under a bulk load");
+}
+
+static void test_post_time_stamps(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Queueing latency counts from the post of the message\n");
+
+    msgLaneStats_t stats;
+    uint32_t postedUs = 0u;
+    uint32_t firstUs;
+    uint16_t i;
+
+    Sim_Reset();
+
+    /* Queued while the application task is busy elsewhere for 4 ms */
+    firstUs = (uint32_t)gStubTimestamp;
+    for (i = 0u; i < 4u; i++)
+    {
+        Sim_PostNotification(100u);
+        Sim_PostL2caData(16u, 100u);
+        gStubTimestamp += 1000u;
+    }
+    Sim_PostCallback(simKindCritical, 100u);
+
+    Sim_DrainAll();
+
+    TEST_ASSERT(gSimHandled == gSimPosted, "Everything handled");
+    TEST_ASSERT(gSimBadStamps == 0u, "Handlers see the post time of their message");
+    TEST_ASSERT(App_GetMsgPostedUs(&postedUs) == FALSE, "No post time outside a handler");
+    TEST_ASSERT((MsgLane_GetStats(msgLaneCritical_c, &stats) == TRUE) && (stats.count == gSimPosted),
+                "Host stack messages timed in the critical lane");
+    TEST_ASSERT(gaSimMaxWaitUs[simKindHost] >= 4000u, "Wait counted from the post");
+    TEST_ASSERT(stats.maxUs >= 4000u, "Lane latency counted from the post");
+    TEST_ASSERT(gaSimMsgs[0].postedUs == firstUs, "First message posted at the start");
+
+    TEST_PASS("Queueing latency counts from the post of the message");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "App Conn Unit Tests (Order + Lanes + Drain + Load + Stamps)", &xmlPath);
+
+    RUN_TEST(test_host_order_kept);
+    RUN_TEST(test_critical_ahead_of_bulk);
+    RUN_TEST(test_bulk_not_starved);
+    RUN_TEST(test_drain_budget_and_cap);
+    RUN_TEST(test_critical_latency_under_load);
+    RUN_TEST(test_post_time_stamps);
+
+    return Test_End(xmlPath);
+}
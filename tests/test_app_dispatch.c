@@ -0,0 +1,261 @@
+/*! *********************************************************************************
+* \file test_app_dispatch.c
+*
+* \brief  Unit tests for AppDispatch — table driven dispatch of application events
+*         with per event latency tracing. Runs on host machine (macOS/Linux). Tests
+*         the real app_dispatch.c: index build, ANY rows, unmatched events, and
+*         queueing / handler histograms on a fake clock.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "app_dispatch"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#define APP_DISPATCH_TRACE_EVENTS       (8u)
+#include "app_dispatch.c"
+
+/*******************************************************************************
+ * Fixture: 3 states x 6 events, handlers log and advance a fake clock
+ ******************************************************************************/
+enum { stIdle, stPair, stRun, stCount };
+enum { evConn, evPair, evDone, evData, evDisc, evSpare, evCount };
+
+static uint32_t gNowUs;
+static uint32_t gPostedUs;
+static bool_t   gPostedValid;
+static uint32_t gRunUs;
+static uint8_t  gLastHandler;
+static uint8_t  gLastPeer;
+static uint8_t  gLastEvent;
+static uint8_t  gHandlerCalls;
+
+static uint32_t FakeNowUs(void)
+{
+    return gNowUs;
+}
+
+static bool_t FakePostedUs(uint32_t *pPostedUs)
+{
+    *pPostedUs = gPostedUs;
+    return gPostedValid;
+}
+
+static void Log(uint8_t handler, uint8_t peerId, uint8_t event)
+{
+    gLastHandler = handler;
+    gLastPeer = peerId;
+    gLastEvent = event;
+    gHandlerCalls++;
+    gNowUs += gRunUs;
+}
+
+static void H_Connect(uint8_t peerId, uint8_t event)  { Log(1u, peerId, event); }
+static void H_Pair(uint8_t peerId, uint8_t event)     { Log(2u, peerId, event); }
+static void H_RunAny(uint8_t peerId, uint8_t event)   { Log(3u, peerId, event); }
+static void H_RunDisc(uint8_t peerId, uint8_t event)  { Log(4u, peerId, event); }
+
+/* The specific row comes after the ANY row of its state and still wins */
+static const appDispatchRow_t gaRows[] =
+{
+    {stIdle, evConn,                 H_Connect},
+    {stPair, evPair,                 H_Pair},
+    {stRun,  APP_DISPATCH_ANY_EVENT, H_RunAny},
+    {stRun,  evDisc,                 H_RunDisc},
+};
+
+static uint8_t gaIndex[stCount * evCount];
+
+static appDispatchTable_t gTable =
+{
+    gaRows, (uint8_t)(sizeof(gaRows) / sizeof(gaRows[0])), stCount, evCount, gaIndex
+};
+
+static void Reset(void)
+{
+    gNowUs = 1000u;
+    gPostedUs = 0u;
+    gPostedValid = FALSE;
+    gRunUs = 0u;
+    gHandlerCalls = 0u;
+    gLastHandler = 0u;
+    AppDispatch_SetTraceHooks(NULL, NULL);
+    AppDispatch_ResetTrace();
+    (void)AppDispatch_Build(&gTable);
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_build(void)
+{
+    static const appDispatchRow_t aBad[] =
+    {
+        {stIdle,  evConn,  H_Connect},
+        {stCount, evConn,  H_Connect},          /* State out of range */
+        {stPair,  evCount, H_Pair},             /* Event out of range */
+        {stPair,  evPair,  NULL},               /* No handler */
+        {stRun,   evData,  H_RunAny},
+    };
+    uint8_t aIndex[stCount * evCount];
+    appDispatchTable_t bad = {aBad, 5u, stCount, evCount, aIndex};
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Index build, specific rows over ANY rows\n");
+
+    Reset();
+    TEST_ASSERT(AppDispatch_Build(&gTable) == TRUE, "Valid table");
+    TEST_ASSERT(gaIndex[(stIdle * evCount) + evConn] == 0u, "Idle/Conn is row 0");
+    TEST_ASSERT(gaIndex[(stIdle * evCount) + evPair] == APP_DISPATCH_NO_ROW, "Idle/Pair has no row");
+    TEST_ASSERT(gaIndex[(stRun * evCount) + evData] == 2u, "Run/Data falls to the ANY row");
+    TEST_ASSERT(gaIndex[(stRun * evCount) + evDisc] == 3u, "Run/Disc keeps its specific row");
+
+    TEST_ASSERT(AppDispatch_Build(&bad) == FALSE, "Out of range rows reported");
+    TEST_ASSERT(aIndex[(stIdle * evCount) + evConn] == 0u, "Valid rows still indexed");
+    TEST_ASSERT(aIndex[(stRun * evCount) + evData] == 4u, "Valid rows after a bad one indexed");
+    TEST_ASSERT(aIndex[(stPair * evCount) + evPair] == APP_DISPATCH_NO_ROW, "Row without handler left out");
+
+    TEST_PASS("Index build, specific rows over ANY rows");
+}
+
+static void test_run(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Dispatch and unmatched events\n");
+
+    Reset();
+    TEST_ASSERT(AppDispatch_Run(&gTable, stIdle, 2u, evConn) == TRUE, "Idle/Conn handled");
+    TEST_ASSERT((gLastHandler == 1u) && (gLastPeer == 2u) && (gLastEvent == evConn), "Handler gets peer and event");
+
+    TEST_ASSERT(AppDispatch_Run(&gTable, stRun, 0u, evDisc) == TRUE, "Run/Disc handled");
+    TEST_ASSERT(gLastHandler == 4u, "Specific handler");
+    TEST_ASSERT(AppDispatch_Run(&gTable, stRun, 0u, evSpare) == TRUE, "Run/Spare handled");
+    TEST_ASSERT((gLastHandler == 3u) && (gLastEvent == evSpare), "ANY handler gets the event");
+
+    gHandlerCalls = 0u;
+    TEST_ASSERT(AppDispatch_Run(&gTable, stPair, 0u, evConn) == FALSE, "Pair/Conn ignored");
+    TEST_ASSERT(AppDispatch_Run(&gTable, stCount, 0u, evConn) == FALSE, "State out of range ignored");
+    TEST_ASSERT(AppDispatch_Run(&gTable, stRun, 0u, evCount) == FALSE, "Event out of range ignored");
+    TEST_ASSERT(gHandlerCalls == 0u, "No handler ran");
+
+    TEST_PASS("Dispatch and unmatched events");
+}
+
+static void test_trace(void)
+{
+    appDispatchStats_t st;
+    uint32_t i;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Queueing and handler histograms\n");
+
+    Reset();
+
+    /* No hooks: nothing recorded */
+    (void)AppDispatch_Run(&gTable, stIdle, 0u, evConn);
+    TEST_ASSERT(AppDispatch_GetTrace(evConn, &st) == FALSE, "Not traced without hooks");
+
+    AppDispatch_SetTraceHooks(FakeNowUs, FakePostedUs);
+
+    /* 95 fast handlers (40 us, 100 us in the queue), 5 slow ones (5 ms, 20 ms in the queue) */
+    for (i = 0u; i < 100u; i++)
+    {
+        const bool_t slow = (i >= 95u) ? TRUE : FALSE;
+        gPostedValid = TRUE;
+        gPostedUs = gNowUs - ((slow == TRUE) ? 20000u : 100u);
+        gRunUs = (slow == TRUE) ? 5000u : 40u;
+        (void)AppDispatch_Run(&gTable, stRun, 0u, evData);
+    }
+    TEST_ASSERT(AppDispatch_GetTrace(evData, &st) == TRUE, "Traced");
+    tprintf("    queue p50 %u p95 %u max %u, run p50 %u p95 %u max %u\n", st.queueP50Us, st.queueP95Us,
+            st.queueMaxUs, st.runP50Us, st.runP95Us, st.runMaxUs);
+    TEST_ASSERT((st.count == 100u) && (st.queued == 100u), "100 dispatches, all with a queue time");
+    TEST_ASSERT(st.runP50Us == 63u, "Handler p50: upper edge of [32, 64)");
+    TEST_ASSERT(st.runP95Us == 63u, "Handler p95 still fast");
+    TEST_ASSERT(st.runMaxUs == 5000u, "Handler max is the slow one");
+    TEST_ASSERT(st.queueP50Us == 127u, "Queue p50: upper edge of [64, 128)");
+    TEST_ASSERT(st.queueMaxUs == 20000u, "Queue max");
+
+    /* One more slow one moves p95 to the slow bucket, clamped to max */
+    gPostedUs = gNowUs - 20000u;
+    gRunUs = 5000u;
+    (void)AppDispatch_Run(&gTable, stRun, 0u, evData);
+    (void)AppDispatch_GetTrace(evData, &st);
+    TEST_ASSERT(st.runP95Us == 5000u, "Handler p95 in the slow bucket, clamped to max");
+    TEST_ASSERT(st.queueP95Us == 20000u, "Queue p95 in the slow bucket, clamped to max");
+
+    /* Unknown queue entry time: duration only */
+    gPostedValid = FALSE;
+    gRunUs = 10u;
+    (void)AppDispatch_Run(&gTable, stRun, 0u, evDisc);
+    (void)AppDispatch_GetTrace(evDisc, &st);
+    TEST_ASSERT((st.count == 1u) && (st.queued == 0u) && (st.queueP50Us == 0u), "No queue sample");
+    TEST_ASSERT(st.runP50Us == 10u, "Duration clamped to max in the first bucket");
+
+    /* Traced outside the table */
+    gRunUs = 300u;
+    i = AppDispatch_TraceBegin();
+    gNowUs += gRunUs;
+    AppDispatch_TraceEnd(evSpare, i);
+    (void)AppDispatch_GetTrace(evSpare, &st);
+    TEST_ASSERT((st.count == 1u) && (st.runMaxUs == 300u), "Stateless handler traced");
+    AppDispatch_TraceEnd(APP_DISPATCH_TRACE_EVENTS, i);
+    TEST_ASSERT(AppDispatch_GetTrace(APP_DISPATCH_TRACE_EVENTS, &st) == FALSE, "Event beyond the trace ignored");
+
+    AppDispatch_ResetTrace();
+    TEST_ASSERT(AppDispatch_GetTrace(evData, &st) == FALSE, "Reset clears");
+
+    TEST_PASS("Queueing and handler histograms");
+}
+
+static void test_saturation(void)
+{
+    appDispatchStats_t st;
+    uint32_t i;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Bucket saturation halves the histogram\n");
+
+    Reset();
+    AppDispatch_SetTraceHooks(FakeNowUs, NULL);
+
+    gRunUs = 1000u;
+    for (i = 0u; i < 1000u; i++)
+    {
+        (void)AppDispatch_Run(&gTable, stRun, 0u, evData);
+    }
+    gRunUs = 20u;
+    for (i = 0u; i < 70000u; i++)
+    {
+        (void)AppDispatch_Run(&gTable, stRun, 0u, evData);
+    }
+    (void)AppDispatch_GetTrace(evData, &st);
+    TEST_ASSERT(st.count == 71000u, "Count keeps counting");
+    TEST_ASSERT(st.runP50Us == 31u, "Recent fast handlers dominate");
+    TEST_ASSERT(st.runP95Us == 31u, "Halved slow samples stay below 5 %");
+    TEST_ASSERT(st.runMaxUs == 1000u, "Max kept");
+
+    TEST_PASS("Bucket saturation halves the histogram");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "AppDispatch Unit Tests (Index + Dispatch + Trace)", &xmlPath);
+
+    RUN_TEST(test_build);
+    RUN_TEST(test_run);
+    RUN_TEST(test_trace);
+    RUN_TEST(test_saturation);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,422 @@
+/*! *********************************************************************************
+* \file test_conn_param.c
+*
+* \brief  Unit tests for ConnParam — proximity driven connection parameters and
+*         subrating of the Digital Key link.
+*         Runs on host machine (macOS/Linux). Tests the real conn_param.c via
+*         #include, with a simulated central answering the requests.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "conn_param"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "conn_param.h"
+#include "conn_param.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+#define MS(ms)                  PROX_TIME_MS_TO_TICKS(ms)
+
+/* Phone defaults: 30 ms, no latency, 2 s timeout */
+#define ACT_INTERVAL            (24u)
+#define ACT_LATENCY             (0u)
+#define ACT_TIMEOUT             (200u)
+
+typedef struct
+{
+    bool_t   acceptUpdate;
+    bool_t   acceptSubrate;
+    bool_t   answer;            /* FALSE: requests are never answered */
+    uint32_t updates;
+    uint32_t subrates;
+    uint16_t interval;          /* In effect */
+    uint16_t latency;
+    uint16_t factor;
+} simCentral_t;
+
+static simCentral_t gCentral;
+
+static void Central_Reset(bool_t acceptUpdate, bool_t acceptSubrate)
+{
+    gCentral.acceptUpdate = acceptUpdate;
+    gCentral.acceptSubrate = acceptSubrate;
+    gCentral.answer = TRUE;
+    gCentral.updates = 0u;
+    gCentral.subrates = 0u;
+    gCentral.interval = ACT_INTERVAL;
+    gCentral.latency = ACT_LATENCY;
+    gCentral.factor = 1u;
+}
+
+/* Poll once and let the central answer at once, returns the action taken */
+static connParamAction_t Step(uint32_t now)
+{
+    connParamRequest_t req;
+    connParamAction_t action = ConnParam_Poll(now, &req);
+
+    if ((action == connParamActionUpdate_c) && (gCentral.answer == TRUE))
+    {
+        gCentral.updates++;
+        if (gCentral.acceptUpdate == TRUE)
+        {
+            /* Picks the upper end of the range */
+            gCentral.interval = req.intervalMax;
+            gCentral.latency = req.latency;
+        }
+        ConnParam_UpdateComplete(gCentral.acceptUpdate, gCentral.interval, gCentral.latency, now);
+    }
+    else if ((action == connParamActionSubrate_c) && (gCentral.answer == TRUE))
+    {
+        gCentral.subrates++;
+        if (gCentral.acceptSubrate == TRUE)
+        {
+            gCentral.factor = req.subrateMax;
+        }
+        ConnParam_SubrateComplete(gCentral.acceptSubrate, gCentral.factor, now);
+    }
+    else
+    {
+        /* Nothing sent, or left pending */
+    }
+
+    return action;
+}
+
+/* Poll every 100 ms (RSSI monitoring rate) from t0 for ms */
+static uint32_t Run(uint32_t t0, uint32_t ms)
+{
+    uint32_t t;
+
+    for (t = 0u; t < ms; t += 100u)
+    {
+        (void)Step(t0 + MS(t));
+    }
+    return t0 + MS(ms);
+}
+
+static connParamProfile_t Profile(uint32_t now)
+{
+    connParamStats_t stats;
+
+    ConnParam_GetStats(now, &stats);
+    return stats.profile;
+}
+
+static void Connect(uint32_t now)
+{
+    ConnParam_Init();
+    ConnParam_Connected(ACT_INTERVAL, ACT_LATENCY, ACT_TIMEOUT, now);
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_connect_hold_then_idle(void)
+{
+    connParamRequest_t req;
+    connParamStats_t stats;
+    uint32_t now = 1000u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Setup hold, then idle profile while FAR\n");
+
+    Central_Reset(TRUE, FALSE);
+    Connect(now);
+
+    now = Run(now, CONN_PARAM_CONNECT_HOLD_MS - 100u);
+    TEST_ASSERT(gCentral.updates == 0u, "Nothing requested during setup");
+    TEST_ASSERT(Profile(now) == connParamProfileActive_c, "Established parameters");
+
+    now = Run(now, 200u);
+    TEST_ASSERT(gCentral.updates == 1u, "One idle request after the hold");
+    TEST_ASSERT(gCentral.interval == CONN_PARAM_IDLE_INTERVAL_MAX, "Long interval");
+    TEST_ASSERT(gCentral.latency == CONN_PARAM_IDLE_LATENCY, "Peripheral latency");
+    TEST_ASSERT(Profile(now) == connParamProfileIdle_c, "Idle in effect");
+
+    now = Run(now, 60000u);
+    TEST_ASSERT(gCentral.updates == 1u, "No further request while FAR");
+    ConnParam_GetStats(now, &stats);
+    TEST_ASSERT((stats.toIdle == 1u) && (stats.requests == 1u), "Counters");
+    TEST_ASSERT((stats.idleMs >= 59900u) && (stats.idleMs <= 60100u), "Idle time accounted");
+
+    /* Idle timeout of the request is well within the spec limit */
+    (void)ConnParam_Poll(now, &req);
+    TEST_ASSERT((uint32_t)CONN_PARAM_IDLE_TIMEOUT * 10u >
+                2u * (1u + CONN_PARAM_IDLE_LATENCY) * CONN_PARAM_IDLE_INTERVAL_MAX * 125u / 100u,
+                "Supervision timeout above (1 + latency) x interval x 2");
+
+    TEST_PASS("Setup hold, then idle profile while FAR");
+}
+
+static void test_candidate_and_lockout(void)
+{
+    uint32_t now = 5000u;
+    uint32_t t;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Candidate switches to active, idle again after lockout\n");
+
+    Central_Reset(TRUE, FALSE);
+    Connect(now);
+    now = Run(now, CONN_PARAM_CONNECT_HOLD_MS + 2000u);
+    TEST_ASSERT(Profile(now) == connParamProfileIdle_c, "Idle before approach");
+
+    /* PROX_RSSI_EVT_CANDIDATE_STARTED */
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, TRUE, now);
+    TEST_ASSERT(Step(now) == connParamActionUpdate_c, "Active requested at the first sample");
+    TEST_ASSERT((gCentral.interval == ACT_INTERVAL) && (gCentral.latency == ACT_LATENCY), "Established parameters back");
+    TEST_ASSERT(Profile(now) == connParamProfileActive_c, "Active in effect");
+
+    /* Candidate + 5 s lockout */
+    now = Run(now, 7000u);
+    TEST_ASSERT(gCentral.updates == 2u, "Nothing while the demand holds");
+
+    /* Back to FAR */
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, FALSE, now);
+    for (t = 0u; t < CONN_PARAM_IDLE_HOLD_MS; t += 100u)
+    {
+        TEST_ASSERT(Step(now + MS(t)) == connParamActionNone_c, "Held after the lockout");
+    }
+    now += MS(CONN_PARAM_IDLE_HOLD_MS);
+    TEST_ASSERT(Step(now) == connParamActionUpdate_c, "Idle after the hold");
+    TEST_ASSERT(Profile(now) == connParamProfileIdle_c, "Idle in effect");
+
+    /* Flapping demand within the hold sends nothing */
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, TRUE, now + MS(1500u));
+    TEST_ASSERT(Step(now + MS(1500u)) == connParamActionUpdate_c, "Active again");
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, FALSE, now + MS(1600u));
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, TRUE, now + MS(1700u));
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, FALSE, now + MS(1800u));
+    TEST_ASSERT(Step(now + MS(1900u)) == connParamActionNone_c, "No request for a short FAR blip");
+
+    TEST_PASS("Candidate switches to active, idle again after lockout");
+}
+
+static void test_cs_demand(void)
+{
+    uint32_t now = 0u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] CS procedures hold the active profile\n");
+
+    Central_Reset(TRUE, FALSE);
+    Connect(now);
+    now = Run(now, CONN_PARAM_CONNECT_HOLD_MS + 1000u);
+    TEST_ASSERT(Profile(now) == connParamProfileIdle_c, "Idle");
+
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_CS, TRUE, now);
+    TEST_ASSERT(Step(now) == connParamActionUpdate_c, "Active before the procedures");
+
+    /* Proximity goes back and forth while CS runs */
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, TRUE, now + MS(100u));
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, FALSE, now + MS(200u));
+    now = Run(now + MS(300u), 20000u);
+    TEST_ASSERT(Profile(now) == connParamProfileActive_c, "Held by CS alone");
+
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_CS, FALSE, now);
+    now = Run(now, CONN_PARAM_IDLE_HOLD_MS + 200u);
+    TEST_ASSERT(Profile(now) == connParamProfileIdle_c, "Idle once the procedures end");
+
+    TEST_PASS("CS procedures hold the active profile");
+}
+
+static void test_reject_backoff(void)
+{
+    connParamStats_t stats;
+    uint32_t now = 0u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Rejects back off, idle given up, active still requested\n");
+
+    Central_Reset(FALSE, FALSE);
+    Connect(now);
+    now = Run(now, CONN_PARAM_CONNECT_HOLD_MS + 100u);
+    TEST_ASSERT(gCentral.updates == 1u, "First idle request rejected");
+
+    now = Run(now, CONN_PARAM_RETRY_MS - 200u);
+    TEST_ASSERT(gCentral.updates == 1u, "Nothing during the back-off");
+    now = Run(now, 400u);
+    TEST_ASSERT(gCentral.updates == 2u, "Retried after the back-off");
+
+    now = Run(now, 10u * CONN_PARAM_RETRY_MS);
+    TEST_ASSERT(gCentral.updates == CONN_PARAM_MAX_REJECTS, "Idle given up");
+    ConnParam_GetStats(now, &stats);
+    TEST_ASSERT(stats.rejects == CONN_PARAM_MAX_REJECTS, "Rejects counted");
+    TEST_ASSERT(Profile(now) == connParamProfileActive_c, "Still at the established parameters");
+
+    /* Central moved the link itself, then proximity needs it fast */
+    ConnParam_UpdateComplete(TRUE, 40u, 0u, now);
+    TEST_ASSERT(Profile(now) == connParamProfileUnknown_c, "Central's parameters");
+    gCentral.acceptUpdate = TRUE;
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, TRUE, now);
+    now = Run(now, CONN_PARAM_RETRY_MS + 100u);
+    TEST_ASSERT(Profile(now) == connParamProfileActive_c, "Active requested despite the rejects");
+
+    TEST_PASS("Rejects back off, idle given up, active still requested");
+}
+
+static void test_pending_timeout(void)
+{
+    connParamStats_t stats;
+    uint32_t now = 0u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Unanswered request times out\n");
+
+    Central_Reset(TRUE, FALSE);
+    gCentral.answer = FALSE;
+    Connect(now);
+    now += MS(CONN_PARAM_CONNECT_HOLD_MS);
+    TEST_ASSERT(Step(now) == connParamActionUpdate_c, "Sent");
+    TEST_ASSERT(Step(now + MS(CONN_PARAM_PENDING_MS - 100u)) == connParamActionNone_c, "Pending");
+    TEST_ASSERT(Step(now + MS(CONN_PARAM_PENDING_MS)) == connParamActionNone_c, "Timed out, backing off");
+    ConnParam_GetStats(now, &stats);
+    TEST_ASSERT((stats.timeouts == 1u) && (stats.rejects == 1u), "Counted as a reject");
+
+    /* Send failure */
+    now += MS(CONN_PARAM_PENDING_MS + CONN_PARAM_RETRY_MS);
+    TEST_ASSERT(Step(now) == connParamActionUpdate_c, "Retried");
+    ConnParam_SendFailed(now);
+    TEST_ASSERT(Step(now + MS(100u)) == connParamActionNone_c, "Failure backs off too");
+
+    TEST_PASS("Unanswered request times out");
+}
+
+static void test_subrate(void)
+{
+    uint32_t now = 0u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Subrating, and fallback to parameter updates\n");
+
+    /* Peer with subrating */
+    Central_Reset(TRUE, TRUE);
+    Connect(now);
+    gConnParam.subrate = TRUE;
+    now = Run(now, CONN_PARAM_CONNECT_HOLD_MS + 100u);
+    TEST_ASSERT((gCentral.subrates == 1u) && (gCentral.updates == 0u), "Idle through subrating");
+    TEST_ASSERT(gCentral.factor == CONN_PARAM_IDLE_SUBRATE_MAX, "Subrate factor");
+    TEST_ASSERT(gCentral.interval == ACT_INTERVAL, "Underlying interval kept");
+    TEST_ASSERT(Profile(now) == connParamProfileIdle_c, "Idle in effect");
+
+    now += MS(CONN_PARAM_MIN_GAP_MS);
+    ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, TRUE, now);
+    TEST_ASSERT(Step(now) == connParamActionSubrate_c, "Back to full rate by subrating");
+    TEST_ASSERT(gCentral.factor == 1u, "Factor 1");
+    TEST_ASSERT(Profile(now) == connParamProfileActive_c, "Active in effect");
+
+    /* Peer without subrating */
+    now = 0u;
+    Central_Reset(TRUE, FALSE);
+    Connect(now);
+    gConnParam.subrate = TRUE;
+    now = Run(now, CONN_PARAM_CONNECT_HOLD_MS + 100u);
+    TEST_ASSERT(gCentral.subrates == 1u, "Subrating tried");
+    now = Run(now, CONN_PARAM_MIN_GAP_MS + 100u);
+    TEST_ASSERT(gCentral.updates == 1u, "Parameter update right after");
+    TEST_ASSERT(Profile(now) == connParamProfileIdle_c, "Idle in effect");
+    now = Run(now, 3u * CONN_PARAM_RETRY_MS);
+    TEST_ASSERT(gCentral.subrates == 1u, "Subrating not tried again");
+
+    TEST_PASS("Subrating, and fallback to parameter updates");
+}
+
+static void test_wrap_and_disconnect(void)
+{
+    connParamRequest_t req;
+    uint32_t now = 0xFFFFFFFFu - MS(2000u);
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Timer wrap and disconnection\n");
+
+    Central_Reset(TRUE, FALSE);
+    Connect(now);
+    now = Run(now, CONN_PARAM_CONNECT_HOLD_MS - 100u);
+    TEST_ASSERT(gCentral.updates == 0u, "Hold across the wrap");
+    now = Run(now, 200u);
+    TEST_ASSERT(gCentral.updates == 1u, "Idle after the wrap");
+
+    ConnParam_Disconnected(now);
+    TEST_ASSERT(ConnParam_Poll(now + MS(100000u), &req) == connParamActionNone_c, "Nothing without a link");
+    ConnParam_UpdateComplete(TRUE, 6u, 0u, now);
+    TEST_ASSERT(Profile(now) == connParamProfileUnknown_c, "Events without a link ignored");
+
+    TEST_PASS("Timer wrap and disconnection");
+}
+
+static void test_radio_budget(void)
+{
+    connParamStats_t stats;
+    uint32_t now = 0u;
+    uint32_t activeMs;
+    uint32_t eventsAlways;
+    uint32_t eventsManaged;
+    uint8_t visit;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Listen events over a parked hour with 4 approaches\n");
+
+    Central_Reset(TRUE, FALSE);
+    Connect(now);
+
+    for (visit = 0u; visit < 4u; visit++)
+    {
+        now = Run(now, 15u * 60000u - 20000u);
+        /* Approach, candidate, unlock, 5 s lockout, then a CS session */
+        ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, TRUE, now);
+        now = Run(now, 8000u);
+        ConnParam_SetDemand(CONN_PARAM_DEMAND_CS, TRUE, now);
+        ConnParam_SetDemand(CONN_PARAM_DEMAND_PROX, FALSE, now);
+        now = Run(now, 4000u);
+        ConnParam_SetDemand(CONN_PARAM_DEMAND_CS, FALSE, now);
+        now = Run(now, 8000u);
+    }
+
+    ConnParam_GetStats(now, &stats);
+    activeMs = 3600000u - stats.idleMs;
+
+    /* Connection events the car listens to */
+    eventsAlways = 3600000u * 100u / (ACT_INTERVAL * 125u);
+    eventsManaged = (activeMs * 100u / (ACT_INTERVAL * 125u)) +
+                    (stats.idleMs * 100u / (CONN_PARAM_IDLE_INTERVAL_MAX * 125u * (1u + CONN_PARAM_IDLE_LATENCY)));
+
+    tprintf("  idle %u s of 3600, %u requests, listen events %u -> %u\n",
+            (unsigned)(stats.idleMs / 1000u), (unsigned)stats.requests,
+            (unsigned)eventsAlways, (unsigned)eventsManaged);
+
+    TEST_ASSERT(stats.idleMs > 3400000u, "Idle most of the hour");
+    TEST_ASSERT(stats.requests == 1u + (2u * 4u), "Idle after setup, then two requests per visit");
+    TEST_ASSERT(eventsManaged * 10u < eventsAlways, "Under a tenth of the listen events");
+
+    TEST_PASS("Listen events over a parked hour with 4 approaches");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "ConnParam Unit Tests (Profiles + Demands + Rejects + Subrate)", &xmlPath);
+
+    RUN_TEST(test_connect_hold_then_idle);
+    RUN_TEST(test_candidate_and_lockout);
+    RUN_TEST(test_cs_demand);
+    RUN_TEST(test_reject_backoff);
+    RUN_TEST(test_pending_timeout);
+    RUN_TEST(test_subrate);
+    RUN_TEST(test_wrap_and_disconnect);
+    RUN_TEST(test_radio_budget);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,228 @@
+/*! *********************************************************************************
+* \file test_cs_ant_path.c
+*
+* \brief  Unit tests for CsAntPath — per-link Channel Sounding antenna path
+*         pruning, ACI reduction and periodic re-probing.
+*         Runs on host machine (macOS/Linux). Tests the real cs_ant_path.c via
+*         #include.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "cs_ant_path"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "cs_ant_path.h"
+#include "cs_ant_path.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+#define GOOD_DQI    (16384)     /* 1.0 in Q2.14 */
+#define BAD_DQI     (1000)
+#define NB_FREQ     (72u)
+
+/* Paths not pruned, internal state of the tracker */
+static uint8_t ActiveMask(uint8_t linkId)
+{
+    csAntPathLink_t *pLink = CsAntPath_GetLink(linkId);
+
+    return (pLink != NULL) ? pLink->activeMask : 0u;
+}
+
+/* Feed one procedure; paths set in badMask report poor quality */
+static bool_t FeedProcedure(uint8_t linkId, uint8_t numPaths, uint8_t badMask)
+{
+    uint16_t aNbValid[CS_ANT_PATH_MAX_PATHS];
+    int16_t  aDqi[CS_ANT_PATH_MAX_PATHS];
+
+    for (uint8_t i = 0u; i < CS_ANT_PATH_MAX_PATHS; i++)
+    {
+        aNbValid[i] = NB_FREQ;
+        aDqi[i]     = ((badMask >> i) & 1u) ? BAD_DQI : GOOD_DQI;
+    }
+    return CsAntPath_Update(linkId, numPaths, NB_FREQ, aNbValid, aDqi);
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_reset_defaults(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Reset defaults\n");
+
+    CsAntPath_Init();
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(0u) == CS_ANT_PATH_INVALID_ACI, "Unknown link -> invalid ACI");
+    TEST_ASSERT(FeedProcedure(0u, 4u, 0u) == FALSE, "Update on unknown link ignored");
+
+    CsAntPath_Reset(0u, 3u);
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(0u) == 3u, "ACI = base");
+    TEST_ASSERT(ActiveMask(0u) == 0x0Fu, "All 4 paths active");
+    TEST_ASSERT(CsAntPath_IsProbing(0u) == FALSE, "Not probing");
+    TEST_ASSERT(CsAntPath_PathsForAci(7u) == 4u, "2x2 -> 4 paths");
+    TEST_ASSERT(CsAntPath_PathsForAci(8u) == 0u, "Invalid ACI -> 0 paths");
+
+    TEST_PASS("Reset defaults");
+}
+
+static void test_good_paths_never_pruned(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Good paths never pruned\n");
+
+    CsAntPath_Init();
+    CsAntPath_Reset(0u, 3u);
+    for (uint32_t i = 0u; i < 50u; i++)
+    {
+        TEST_ASSERT(FeedProcedure(0u, 4u, 0u) == FALSE, "No change with good paths");
+    }
+    TEST_ASSERT(ActiveMask(0u) == 0x0Fu, "Mask unchanged");
+
+    TEST_PASS("Good paths never pruned");
+}
+
+static void test_trailing_paths_reduce_aci(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Trailing bad paths reduce ACI\n");
+
+    CsAntPath_Init();
+    CsAntPath_Reset(0u, 3u);
+
+    for (uint32_t i = 0u; i + 1u < CS_ANT_PATH_PRUNE_AFTER; i++)
+    {
+        (void)FeedProcedure(0u, 4u, 0x0Cu);
+        TEST_ASSERT(ActiveMask(0u) == 0x0Fu, "Not pruned before threshold");
+    }
+    TEST_ASSERT(FeedProcedure(0u, 4u, 0x0Cu) == TRUE, "Change reported at threshold");
+    TEST_ASSERT(ActiveMask(0u) == 0x03u, "Paths 2,3 pruned");
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(0u) == 1u, "4x1 reduced to 2x1");
+
+    /* Remote side switching */
+    CsAntPath_Reset(1u, 6u);
+    for (uint32_t i = 0u; i < CS_ANT_PATH_PRUNE_AFTER; i++)
+    {
+        (void)FeedProcedure(1u, 4u, 0x08u);
+    }
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(1u) == 5u, "1x4 reduced to 1x3");
+
+    TEST_PASS("Trailing bad paths reduce ACI");
+}
+
+static void test_inner_path_masked_only(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Inner bad path only masked\n");
+
+    CsAntPath_Init();
+    CsAntPath_Reset(0u, 3u);
+    for (uint32_t i = 0u; i < CS_ANT_PATH_PRUNE_AFTER; i++)
+    {
+        (void)FeedProcedure(0u, 4u, 0x02u);
+    }
+    TEST_ASSERT(ActiveMask(0u) == 0x0Du, "Path 1 masked");
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(0u) == 3u, "ACI kept, path still sounded");
+
+    /* Still sounded, so a single good procedure restores it */
+    TEST_ASSERT(FeedProcedure(0u, 4u, 0u) == TRUE, "Restore reported");
+    TEST_ASSERT(ActiveMask(0u) == 0x0Fu, "Path 1 restored");
+
+    TEST_PASS("Inner bad path only masked");
+}
+
+static void test_last_path_kept(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Last path always kept\n");
+
+    CsAntPath_Init();
+    CsAntPath_Reset(0u, 1u);
+    for (uint32_t i = 0u; i < 3u * CS_ANT_PATH_PRUNE_AFTER; i++)
+    {
+        (void)FeedProcedure(0u, 2u, 0x03u);
+    }
+    TEST_ASSERT(ActiveMask(0u) != 0u, "At least one path active");
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(0u) == 0u, "Reduced to 1x1");
+
+    TEST_PASS("Last path always kept");
+}
+
+static void test_reprobe_restores(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Re-probe restores recovered path\n");
+
+    CsAntPath_Init();
+    CsAntPath_Reset(0u, 3u);
+    for (uint32_t i = 0u; i < CS_ANT_PATH_PRUNE_AFTER; i++)
+    {
+        (void)FeedProcedure(0u, 4u, 0x08u);
+    }
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(0u) == 2u, "Reduced to 3x1");
+
+    /* Reduced procedures only sound 3 paths */
+    for (uint32_t i = 0u; i + 1u < CS_ANT_PATH_REPROBE_PERIOD; i++)
+    {
+        (void)FeedProcedure(0u, 3u, 0u);
+        TEST_ASSERT(CsAntPath_IsProbing(0u) == FALSE, "No probe before period");
+    }
+    TEST_ASSERT(FeedProcedure(0u, 3u, 0u) == TRUE, "Probe scheduled");
+    TEST_ASSERT(CsAntPath_IsProbing(0u) == TRUE, "Probing");
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(0u) == 3u, "Probe uses base ACI");
+    TEST_ASSERT(ActiveMask(0u) == 0x07u, "Probe does not unmask path");
+
+    /* Path 3 recovered */
+    TEST_ASSERT(FeedProcedure(0u, 4u, 0u) == TRUE, "Restore reported");
+    TEST_ASSERT(CsAntPath_IsProbing(0u) == FALSE, "Probe finished");
+    TEST_ASSERT(ActiveMask(0u) == 0x0Fu, "Path 3 restored");
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(0u) == 3u, "Back to base ACI");
+
+    TEST_PASS("Re-probe restores recovered path");
+}
+
+static void test_low_valid_ratio_is_bad(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Low valid-frequency ratio is bad\n");
+
+    uint16_t aNbValid[2] = {NB_FREQ, NB_FREQ / 4u};
+    int16_t  aDqi[2]     = {GOOD_DQI, GOOD_DQI};
+
+    CsAntPath_Init();
+    CsAntPath_Reset(0u, 4u);
+    for (uint32_t i = 0u; i < CS_ANT_PATH_PRUNE_AFTER; i++)
+    {
+        (void)CsAntPath_Update(0u, 2u, NB_FREQ, aNbValid, aDqi);
+    }
+    TEST_ASSERT(ActiveMask(0u) == 0x01u, "Saturated path pruned");
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(0u) == 0u, "1x2 reduced to 1x1");
+    TEST_ASSERT(CsAntPath_Update(0u, 2u, 0u, aNbValid, aDqi) == FALSE, "No valid frequencies ignored");
+
+    TEST_PASS("Low valid-frequency ratio is bad");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "CsAntPath Unit Tests (Pruning + ACI + Re-probe)", &xmlPath);
+
+    RUN_TEST(test_reset_defaults);
+    RUN_TEST(test_good_paths_never_pruned);
+    RUN_TEST(test_trailing_paths_reduce_aci);
+    RUN_TEST(test_inner_path_masked_only);
+    RUN_TEST(test_last_path_kept);
+    RUN_TEST(test_reprobe_restores);
+    RUN_TEST(test_low_valid_ratio_is_bad);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,205 @@
+/*! *********************************************************************************
+* \file test_cs_ch_map.c
+*
+* \brief  Unit tests for CsChMap — per-link CS channel validity history and
+*         adaptive channel map generation.
+*         Runs on host machine (macOS/Linux). Tests the real cs_ch_map.c via
+*         #include.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "cs_ch_map"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "cs_ch_map.h"
+#include "cs_ch_map.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+/* Default CS map: channels 2-22 and 26-76 (72 channels) */
+static void DefaultMap(uint8_t *pMap)
+{
+    memset(pMap, 0, CS_CH_MAP_LEN);
+    for (uint8_t ch = 2u; ch <= 76u; ch++)
+    {
+        if ((ch < 23u) || (ch > 25u))
+        {
+            CS_CH_MAP_SET(pMap, ch);
+        }
+    }
+}
+
+/* Run N procedures over the given map, channels in badMap invalid */
+static void FeedProcedures(uint8_t linkId, const uint8_t *pUsed, const uint8_t *pBad, uint32_t count)
+{
+    uint8_t aValid[CS_CH_MAP_LEN];
+
+    for (uint8_t i = 0u; i < CS_CH_MAP_LEN; i++)
+    {
+        aValid[i] = (uint8_t)(pUsed[i] & (uint8_t)~pBad[i]);
+    }
+    for (uint32_t n = 0u; n < count; n++)
+    {
+        CsChMap_Update(linkId, pUsed, aValid);
+    }
+}
+
+static uint32_t ExpectedValid(uint8_t linkId, const uint8_t *pMap)
+{
+    uint32_t sum = 0u;
+    for (uint8_t ch = 0u; ch < CS_CH_MAP_NUM_CHANNELS; ch++)
+    {
+        if (CS_CH_MAP_IS_SET(pMap, ch)) { sum += CsChMap_GetScore(linkId, ch); }
+    }
+    return sum / CS_CH_MAP_SCORE_MAX;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_base_map_before_history(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Base map until enough history\n");
+
+    uint8_t base[CS_CH_MAP_LEN], out[CS_CH_MAP_LEN], none[CS_CH_MAP_LEN] = {0};
+    DefaultMap(base);
+
+    CsChMap_Init();
+    TEST_ASSERT(CsChMap_Generate(0u, out) == 0u, "Unknown link -> 0 channels");
+
+    CsChMap_Reset(0u, base);
+    FeedProcedures(0u, base, none, CS_CH_MAP_MIN_PROCEDURES - 1u);
+    TEST_ASSERT(CsChMap_Generate(0u, out) == 72u, "72 channels");
+    TEST_ASSERT(memcmp(out, base, CS_CH_MAP_LEN) == 0, "Map = base map");
+
+    TEST_PASS("Base map until enough history");
+}
+
+static void test_bad_channels_dropped(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Chronically bad channels dropped\n");
+
+    uint8_t base[CS_CH_MAP_LEN], out[CS_CH_MAP_LEN], bad[CS_CH_MAP_LEN] = {0};
+    DefaultMap(base);
+    CS_CH_MAP_SET(bad, 10u);
+    CS_CH_MAP_SET(bad, 40u);
+    CS_CH_MAP_SET(bad, 41u);
+
+    CsChMap_Init();
+    CsChMap_Reset(0u, base);
+    FeedProcedures(0u, base, bad, 32u);
+    TEST_ASSERT(CsChMap_GetScore(0u, 10u) < CS_CH_MAP_BAD_SCORE_Q8, "Bad channel score low");
+
+    (void)CsChMap_Generate(0u, out);
+    TEST_ASSERT(!CS_CH_MAP_IS_SET(out, 10u), "Channel 10 dropped");
+    TEST_ASSERT(!CS_CH_MAP_IS_SET(out, 40u), "Channel 40 dropped");
+    TEST_ASSERT(!CS_CH_MAP_IS_SET(out, 41u), "Channel 41 dropped");
+    for (uint8_t i = 0u; i < CS_CH_MAP_LEN; i++)
+    {
+        TEST_ASSERT((out[i] & (uint8_t)~base[i]) == 0u, "Subset of base map");
+    }
+
+    TEST_PASS("Chronically bad channels dropped");
+}
+
+static void test_thinning_keeps_target_and_span(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Thinning keeps quality target and span\n");
+
+    uint8_t base[CS_CH_MAP_LEN], out[CS_CH_MAP_LEN], none[CS_CH_MAP_LEN] = {0};
+    DefaultMap(base);
+
+    CsChMap_Init();
+    CsChMap_Reset(0u, base);
+    FeedProcedures(0u, base, none, 16u);
+
+    uint8_t n = CsChMap_Generate(0u, out);
+    TEST_ASSERT(n < 72u, "Fewer channels than base");
+    TEST_ASSERT(n >= CS_CH_MAP_MIN_CHANNELS, "At least the minimum");
+    TEST_ASSERT(n == CsChMap_Count(out), "Return value = count");
+    TEST_ASSERT(ExpectedValid(0u, out) >= CS_CH_MAP_TARGET_VALID, "Quality target kept");
+    TEST_ASSERT(CS_CH_MAP_IS_SET(out, 2u) && CS_CH_MAP_IS_SET(out, 76u), "Band edges kept");
+
+    /* No large holes: thinning spreads removals */
+    uint8_t prev = 2u, maxGap = 0u;
+    for (uint8_t ch = 3u; ch <= 76u; ch++)
+    {
+        if (CS_CH_MAP_IS_SET(out, ch))
+        {
+            if ((uint8_t)(ch - prev) > maxGap) { maxGap = (uint8_t)(ch - prev); }
+            prev = ch;
+        }
+    }
+    TEST_ASSERT(maxGap <= 4u, "No large gaps");
+
+    TEST_PASS("Thinning keeps quality target and span");
+}
+
+static void test_minimum_channels(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Minimum channel count kept\n");
+
+    uint8_t base[CS_CH_MAP_LEN], out[CS_CH_MAP_LEN];
+    DefaultMap(base);
+
+    CsChMap_Init();
+    CsChMap_Reset(0u, base);
+    FeedProcedures(0u, base, base, 40u);    /* Everything invalid */
+
+    TEST_ASSERT(CsChMap_Generate(0u, out) == CS_CH_MAP_MIN_CHANNELS, "Minimum count");
+
+    TEST_PASS("Minimum channel count kept");
+}
+
+static void test_dropped_channel_recovers(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Dropped channel recovers\n");
+
+    uint8_t base[CS_CH_MAP_LEN], out[CS_CH_MAP_LEN], bad[CS_CH_MAP_LEN] = {0}, none[CS_CH_MAP_LEN] = {0};
+    DefaultMap(base);
+    CS_CH_MAP_SET(bad, 30u);
+
+    CsChMap_Init();
+    CsChMap_Reset(0u, base);
+    FeedProcedures(0u, base, bad, 32u);
+    (void)CsChMap_Generate(0u, out);
+    TEST_ASSERT(!CS_CH_MAP_IS_SET(out, 30u), "Channel 30 dropped");
+
+    /* Channel 30 no longer sounded: its score slowly recovers */
+    CS_CH_MAP_CLEAR(base, 30u);
+    FeedProcedures(0u, base, none, 64u);
+    TEST_ASSERT(CsChMap_GetScore(0u, 30u) >= CS_CH_MAP_BAD_SCORE_Q8, "Score recovered");
+
+    TEST_PASS("Dropped channel recovers");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "CsChMap Unit Tests (History + Drop + Thinning)", &xmlPath);
+
+    RUN_TEST(test_base_map_before_history);
+    RUN_TEST(test_bad_channels_dropped);
+    RUN_TEST(test_thinning_keeps_target_and_span);
+    RUN_TEST(test_minimum_channels);
+    RUN_TEST(test_dropped_channel_recovers);
+
+    return Test_End(xmlPath);
+}
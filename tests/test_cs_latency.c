@@ -0,0 +1,162 @@
+/*! *********************************************************************************
+* \file test_cs_latency.c
+*
+* \brief  Unit tests for CsLatency — per-device, per-stage CS latency histograms
+*         and percentiles.
+*         Runs on host machine (macOS/Linux). Tests the real cs_latency.c via
+*         #include.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "cs_latency"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "cs_latency.h"
+#include "cs_latency.c"
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_bucket_bounds(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Bucket bounds are contiguous\n");
+
+    uint32_t prevUpper = 0u;
+    for (uint8_t b = 1u; b + 1u < CS_LATENCY_NUM_BUCKETS; b++)
+    {
+        uint32_t upper = CsLatency_BucketUpperUs(b);
+        TEST_ASSERT(upper > prevUpper, "Bounds increase");
+        TEST_ASSERT(CsLatency_BucketIndex(upper) == b, "Upper bound maps to bucket");
+        TEST_ASSERT(CsLatency_BucketIndex(upper + 1u) == b + 1u, "Next value maps to next bucket");
+        prevUpper = upper;
+    }
+    TEST_ASSERT(CsLatency_BucketIndex(0xFFFFFFFFu) == CS_LATENCY_NUM_BUCKETS - 1u, "Huge value clamped");
+
+    /* Relative error of a bucket stays within 25% */
+    for (uint8_t b = 8u; b + 1u < CS_LATENCY_NUM_BUCKETS; b++)
+    {
+        uint32_t lower = CsLatency_BucketUpperUs((uint8_t)(b - 1u)) + 1u;
+        uint32_t upper = CsLatency_BucketUpperUs(b);
+        TEST_ASSERT((upper - lower) * 4u <= lower, "Bucket width <= 25%");
+    }
+
+    TEST_PASS("Bucket bounds are contiguous");
+}
+
+static void test_empty_and_invalid(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Empty and invalid inputs\n");
+
+    csLatencyStats_t stats;
+
+    CsLatency_Init();
+    TEST_ASSERT(CsLatency_GetStats(0u, csLatencyStageAlgo_c, &stats) == FALSE, "No samples");
+    TEST_ASSERT(stats.count == 0u && stats.maxUs == 0u, "Stats zeroed");
+    TEST_ASSERT(CsLatency_Percentile(0u, csLatencyStageAlgo_c, 50u) == 0u, "Empty percentile 0");
+
+    CsLatency_Record(0u, csLatencyStageAlgo_c, 0u);
+    TEST_ASSERT(CsLatency_GetStats(0u, csLatencyStageAlgo_c, &stats) == FALSE, "Zero duration ignored");
+
+    CsLatency_Record(CS_LATENCY_MAX_DEVICES, csLatencyStageAlgo_c, 1000u);
+    CsLatency_Record(0u, csLatencyStageCount_c, 1000u);
+    TEST_ASSERT(CsLatency_GetStats(CS_LATENCY_MAX_DEVICES, csLatencyStageAlgo_c, &stats) == FALSE, "Bad device ignored");
+
+    TEST_PASS("Empty and invalid inputs");
+}
+
+static void test_percentiles(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Percentiles of a long-tail distribution\n");
+
+    csLatencyStats_t stats;
+
+    CsLatency_Init();
+    /* 90 x 40 ms, 8 x 60 ms, 2 x 200 ms */
+    for (uint32_t i = 0u; i < 90u; i++) { CsLatency_Record(0u, csLatencyStageAlgo_c, 40000u); }
+    for (uint32_t i = 0u; i < 8u; i++)  { CsLatency_Record(0u, csLatencyStageAlgo_c, 60000u); }
+    for (uint32_t i = 0u; i < 2u; i++)  { CsLatency_Record(0u, csLatencyStageAlgo_c, 200000u); }
+
+    TEST_ASSERT(CsLatency_GetStats(0u, csLatencyStageAlgo_c, &stats) == TRUE, "Stats available");
+    TEST_ASSERT(stats.count == 100u, "100 samples");
+    TEST_ASSERT(stats.minUs == 40000u && stats.maxUs == 200000u, "Exact min/max");
+    TEST_ASSERT(stats.p50Us >= 40000u && stats.p50Us <= 50000u, "p50 ~40 ms");
+    TEST_ASSERT(stats.p95Us >= 60000u && stats.p95Us <= 75000u, "p95 ~60 ms");
+    TEST_ASSERT(stats.p99Us >= 200000u && stats.p99Us <= 200000u, "p99 capped at max");
+    TEST_ASSERT(CsLatency_Percentile(0u, csLatencyStageAlgo_c, 100u) == 200000u, "p100 = max");
+
+    /* Other stages and devices untouched */
+    TEST_ASSERT(CsLatency_GetStats(0u, csLatencyStageProcedure_c, &stats) == FALSE, "Other stage empty");
+    TEST_ASSERT(CsLatency_GetStats(1u, csLatencyStageAlgo_c, &stats) == FALSE, "Other device empty");
+
+    TEST_PASS("Percentiles of a long-tail distribution");
+}
+
+static void test_reset(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Reset per device and all devices\n");
+
+    csLatencyStats_t stats;
+
+    CsLatency_Init();
+    CsLatency_Record(0u, csLatencyStageConfig_c, 5000u);
+    CsLatency_Record(1u, csLatencyStageConfig_c, 5000u);
+
+    CsLatency_Reset(0u);
+    TEST_ASSERT(CsLatency_GetStats(0u, csLatencyStageConfig_c, &stats) == FALSE, "Device 0 cleared");
+    TEST_ASSERT(CsLatency_GetStats(1u, csLatencyStageConfig_c, &stats) == TRUE, "Device 1 kept");
+
+    CsLatency_Reset(CS_LATENCY_ALL_DEVICES);
+    TEST_ASSERT(CsLatency_GetStats(1u, csLatencyStageConfig_c, &stats) == FALSE, "All cleared");
+
+    TEST_PASS("Reset per device and all devices");
+}
+
+static void test_saturation_keeps_shape(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Bucket saturation keeps distribution shape\n");
+
+    csLatencyStats_t stats;
+
+    CsLatency_Init();
+    /* 3:1 mix, enough samples to saturate the dominant bucket several times */
+    for (uint32_t i = 0u; i < 300000u; i++)
+    {
+        CsLatency_Record(0u, csLatencyStageTransfer_c, ((i & 3u) == 3u) ? 90000u : 10000u);
+    }
+
+    TEST_ASSERT(CsLatency_GetStats(0u, csLatencyStageTransfer_c, &stats) == TRUE, "Stats available");
+    TEST_ASSERT(stats.count == 300000u, "Sample count exact");
+    TEST_ASSERT(stats.p50Us <= 12000u, "p50 in the fast bucket");
+    TEST_ASSERT(stats.p95Us >= 90000u, "p95 in the slow bucket");
+
+    TEST_PASS("Bucket saturation keeps distribution shape");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "CsLatency Unit Tests (Buckets + Percentiles + Reset)", &xmlPath);
+
+    RUN_TEST(test_bucket_bounds);
+    RUN_TEST(test_empty_and_invalid);
+    RUN_TEST(test_percentiles);
+    RUN_TEST(test_reset);
+    RUN_TEST(test_saturation_keeps_shape);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,218 @@
+/*! *********************************************************************************
+* \file test_cs_step_qual.c
+*
+* \brief  Unit tests for CsStepQual — tone quality and channel validity of the
+*         local CS subevent results, and antenna path pruning fed from it.
+*         Runs on host machine (macOS/Linux). Tests the real cs_step_qual.c and
+*         cs_ant_path.c via #include.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "cs_step_qual"
+#include "test_framework.h"
+
+#include <string.h>
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "cs_step_qual.h"
+#include "cs_step_qual.c"
+#include "cs_ant_path.h"
+#include "cs_ant_path.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+#define TQI_HIGH        (0x00u)
+#define TQI_MEDIUM      (0x01u)
+#define TQI_LOW         (0x02u)
+#define TQI_NA          (0x03u)
+
+static uint8_t gaData[1024];
+
+/* Append a mode 2 step: permutation index, then numPaths + 1 tones */
+static uint32_t AddMode2(uint32_t idx, uint8_t channel, uint8_t numPaths, const uint8_t *pTqi)
+{
+    uint8_t k;
+
+    gaData[idx++] = 2u;
+    gaData[idx++] = channel;
+    gaData[idx++] = (uint8_t)(1u + ((numPaths + 1u) * 4u));
+    gaData[idx++] = 0u;
+    for (k = 0u; k <= numPaths; k++)
+    {
+        gaData[idx++] = 0x12u;
+        gaData[idx++] = 0x34u;
+        gaData[idx++] = 0x56u;
+        /* Extension slot tone: not expected, unavailable */
+        gaData[idx++] = (k < numPaths) ? (uint8_t)(pTqi[k] | 0x10u) : TQI_NA;
+    }
+    return idx;
+}
+
+/* Append a mode 1 step with 6 bytes of data */
+static uint32_t AddMode1(uint32_t idx, uint8_t channel)
+{
+    gaData[idx++] = 1u;
+    gaData[idx++] = channel;
+    gaData[idx++] = 6u;
+    memset(&gaData[idx], 0, 6u);
+    return idx + 6u;
+}
+
+/* One subevent of nbSteps mode 2 steps, a mode 1 step in front */
+static void FeedSubevent(uint8_t linkId, uint8_t numPaths, uint8_t nbSteps, const uint8_t *pTqi)
+{
+    uint32_t idx = AddMode1(0u, 2u);
+    uint8_t i;
+
+    for (i = 0u; i < nbSteps; i++)
+    {
+        idx = AddMode2(idx, (uint8_t)(2u + i), numPaths, pTqi);
+    }
+    CsStepQual_AddSubevent(linkId, numPaths, (uint8_t)(nbSteps + 1u), gaData);
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_counts_usable_tones(void)
+{
+    static const uint8_t aTqi[4] = {TQI_HIGH, TQI_MEDIUM, TQI_LOW, TQI_NA};
+    csStepQual_t qual;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Usable tones counted per path\n");
+
+    CsStepQual_Init();
+    TEST_ASSERT(CsStepQual_Take(0u, &qual) == FALSE, "Nothing before a subevent");
+
+    FeedSubevent(0u, 4u, 10u, aTqi);
+    FeedSubevent(0u, 4u, 5u, aTqi);
+    TEST_ASSERT(CsStepQual_Take(0u, &qual) == TRUE, "Totals of the procedure");
+    TEST_ASSERT(qual.numAntennaPaths == 4u, "Four paths");
+    TEST_ASSERT(qual.nbSteps == 15u, "Mode 2 steps of both subevents, mode 1 skipped");
+    TEST_ASSERT((qual.aNbValid[0] == 15u) && (qual.aNbValid[1] == 15u), "High and medium usable");
+    TEST_ASSERT((qual.aNbValid[2] == 0u) && (qual.aNbValid[3] == 0u), "Low and unavailable not");
+    TEST_ASSERT(CsStepQual_Take(0u, &qual) == FALSE, "Started over");
+
+    TEST_PASS("Usable tones counted per path");
+}
+
+static void test_links_and_bounds(void)
+{
+    static const uint8_t aTqi[4] = {TQI_HIGH, TQI_HIGH, TQI_HIGH, TQI_HIGH};
+    csStepQual_t qual;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Links kept apart, bad input ignored\n");
+
+    CsStepQual_Init();
+    FeedSubevent(1u, 2u, 3u, aTqi);
+    TEST_ASSERT(CsStepQual_Take(0u, &qual) == FALSE, "Other link untouched");
+    TEST_ASSERT(CsStepQual_Take(1u, &qual) == TRUE, "Link 1 totals");
+    TEST_ASSERT((qual.nbSteps == 3u) && (qual.aNbValid[1] == 3u), "Two paths, three steps");
+
+    /* Step shorter than the tones of the paths it claims */
+    FeedSubevent(0u, 2u, 3u, aTqi);
+    CsStepQual_AddSubevent(0u, 4u, 4u, gaData);
+    TEST_ASSERT(CsStepQual_Take(0u, &qual) == TRUE, "Earlier subevent kept");
+    TEST_ASSERT(qual.nbSteps == 3u, "Short steps not counted");
+
+    CsStepQual_AddSubevent(CS_STEP_QUAL_MAX_LINKS, 1u, 1u, gaData);
+    CsStepQual_AddSubevent(0u, 5u, 1u, gaData);
+    CsStepQual_AddSubevent(0u, 1u, 1u, NULL);
+    TEST_ASSERT(CsStepQual_Take(0u, &qual) == FALSE, "Invalid link, paths or data ignored");
+
+    FeedSubevent(0u, 2u, 3u, aTqi);
+    CsStepQual_Reset(0u);
+    TEST_ASSERT(CsStepQual_Take(0u, &qual) == FALSE, "Reset drops the procedure");
+
+    TEST_PASS("Links kept apart, bad input ignored");
+}
+
+static void test_channel_maps(void)
+{
+    static const uint8_t aGood[4] = {TQI_HIGH, TQI_MEDIUM, TQI_LOW, TQI_NA};
+    static const uint8_t aBad[4]  = {TQI_HIGH, TQI_LOW, TQI_LOW, TQI_NA};
+    csStepQual_t qual;
+    uint32_t idx;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Channels sounded and channels with a valid step\n");
+
+    CsStepQual_Init();
+
+    /* Half the paths usable: valid. One of four: not. Channel 80 out of range */
+    idx = AddMode1(0u, 9u);
+    idx = AddMode2(idx, 10u, 4u, aGood);
+    idx = AddMode2(idx, 20u, 4u, aBad);
+    idx = AddMode2(idx, 78u, 4u, aGood);
+    (void)AddMode2(idx, 80u, 4u, aGood);
+    CsStepQual_AddSubevent(0u, 4u, 5u, gaData);
+
+    /* Channel 20 again in the next subevent, valid this time */
+    (void)AddMode2(0u, 20u, 4u, aGood);
+    CsStepQual_AddSubevent(0u, 4u, 1u, gaData);
+
+    TEST_ASSERT(CsStepQual_Take(0u, &qual) == TRUE, "Totals of the procedure");
+    TEST_ASSERT(qual.nbSteps == 5u, "Five mode 2 steps");
+    TEST_ASSERT(qual.aUsedMap[1] == 0x04u, "Channel 10 sounded, mode 1 channel 9 not");
+    TEST_ASSERT((qual.aUsedMap[2] == 0x10u) && (qual.aValidMap[2] == 0x10u), "Channel 20 valid once");
+    TEST_ASSERT((qual.aUsedMap[9] == 0x40u) && (qual.aValidMap[9] == 0x40u), "Channel 78 valid, 80 ignored");
+    TEST_ASSERT(qual.aValidMap[1] == 0x04u, "Channel 10 valid");
+
+    (void)AddMode2(0u, 30u, 4u, aBad);
+    CsStepQual_AddSubevent(0u, 4u, 1u, gaData);
+    TEST_ASSERT(CsStepQual_Take(0u, &qual) == TRUE, "Next procedure");
+    TEST_ASSERT((qual.aUsedMap[3] == 0x40u) && (qual.aValidMap[3] == 0x00u), "Channel 30 sounded, not valid");
+    TEST_ASSERT(qual.aUsedMap[1] == 0x00u, "Maps started over");
+
+    TEST_PASS("Channels sounded and channels with a valid step");
+}
+
+static void test_prunes_from_tone_quality(void)
+{
+    static const uint8_t aTqi[4] = {TQI_HIGH, TQI_HIGH, TQI_LOW, TQI_NA};
+    csStepQual_t qual;
+    uint32_t i;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Antenna paths pruned from the tone quality\n");
+
+    CsStepQual_Init();
+    CsAntPath_Init();
+    CsAntPath_Reset(0u, 3u);
+
+    for (i = 0u; i < CS_ANT_PATH_PRUNE_AFTER; i++)
+    {
+        FeedSubevent(0u, 4u, 20u, aTqi);
+        TEST_ASSERT(CsStepQual_Take(0u, &qual) == TRUE, "Procedure totals");
+        (void)CsAntPath_Update(0u, qual.numAntennaPaths, qual.nbSteps, qual.aNbValid, NULL);
+    }
+    TEST_ASSERT(gaCsAntPathLinks[0].activeMask == 0x03u, "Paths 2 and 3 pruned without DQI");
+    TEST_ASSERT(CsAntPath_GetAntCfgIndex(0u) == 1u, "4x1 reduced to 2x1");
+
+    TEST_PASS("Antenna paths pruned from the tone quality");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "CsStepQual Unit Tests (Tone quality + path pruning)", &xmlPath);
+
+    RUN_TEST(test_counts_usable_tones);
+    RUN_TEST(test_links_and_bounds);
+    RUN_TEST(test_channel_maps);
+    RUN_TEST(test_prunes_from_tone_quality);
+
+    return Test_End(xmlPath);
+}
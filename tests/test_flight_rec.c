@@ -0,0 +1,398 @@
+/*! *********************************************************************************
+* \file test_flight_rec.c
+*
+* \brief  Unit tests for FlightRec — RSSI proximity flight recorder — and the
+*         host replayer in tools/flight_rec_replay.c.
+*         Runs on host machine (macOS/Linux). Tests the real flight_rec.c via
+*         #include, with the flash adapter emulated by tests/stubs.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "flight_rec"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation and the replayer
+ ******************************************************************************/
+#define FLIGHT_REC_FLASH_SIZE   (2u * 8192u)
+#define STUB_FLASH_SIZE         FLIGHT_REC_FLASH_SIZE
+#define FLIGHT_REC_FLASH_ADDR   STUB_FLASH_BASE
+#include "fsl_adapter_flash.h"
+#include "flight_rec.c"
+#define FLIGHT_REPLAY_NO_MAIN
+#include "flight_rec_replay.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+static ProxRssi_CtxType gDevCtx;
+static uint16_t gaDevLut[1001];
+static uint8_t gaDump[FLIGHT_REC_FLASH_SIZE];
+static uint32_t gLcg = 12345u;
+
+/* Same parameters and LUT as rssi_integration.c */
+static void Dev_Params(ProxRssi_ParamsType *pParams)
+{
+    memset(pParams, 0, sizeof(*pParams));
+    pParams->wRawMs = 2000u;  pParams->wSpikeMs = 800u;  pParams->wFeatMs = 2000u;
+    pParams->hampelKQ4 = 40u; pParams->madEpsQ4 = 8u;
+    pParams->enterNearQ4 = ProxRssi_DbmToQ4(-50);
+    pParams->exitNearQ4  = ProxRssi_DbmToQ4(-60);
+    pParams->hystQ4      = (uint16_t)ProxRssi_DbToQ4(10);
+    pParams->pctThQ15 = 13107u; pParams->stdThQ4 = 128u; pParams->stableMs = 2000u; pParams->minFeatSamples = 6u;
+    pParams->exitConfirmMs = 1500u; pParams->lockoutMs = 5000u; pParams->maxReasonableDtMs = 2000u;
+
+    for (uint32_t i = 0u; i < 1001u; i++)
+    {
+        gaDevLut[i] = (uint16_t)(1638u + ((i * 8192u) / 1000u));
+    }
+}
+
+/* Initialise the device side the way RssiIntegration_Init does, logging the
+ * (optionally different) parameters given in pLogged */
+static void Dev_Init(uint32_t tMs, const ProxRssi_ParamsType *pLogged)
+{
+    ProxRssi_ParamsType params;
+
+    Dev_Params(&params);
+    (void)ProxRssi_Init(&gDevCtx, &params, gaDevLut, 1001u);
+
+    if (pLogged != NULL)
+    {
+        ProxRssi_CtxType tmp;
+        (void)ProxRssi_Init(&tmp, pLogged, gaDevLut, 1001u);
+        FlightRec_LogReset(tMs, &tmp.p, tmp.alphaQ15, (uint16_t)PROX_RSSI_ALPHA_LUT_SIZE);
+    }
+    else
+    {
+        FlightRec_LogReset(tMs, &gDevCtx.p, gDevCtx.alphaQ15, (uint16_t)PROX_RSSI_ALPHA_LUT_SIZE);
+    }
+}
+
+static ProxRssi_EventType Dev_Step(uint32_t tMs, int8_t rssi)
+{
+    ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+    ProxRssi_FeaturesType feat;
+
+    (void)ProxRssi_PushRaw(&gDevCtx, tMs, rssi);
+    (void)ProxRssi_MainFunction(&gDevCtx, tMs, &ev, &feat);
+    FlightRec_LogStep(tMs, rssi, ev, &feat, gDevCtx.emaQ4, gDevCtx.st);
+
+    return ev;
+}
+
+static int8_t Noise(int8_t mean, uint32_t spread)
+{
+    gLcg = (gLcg * 1103515245u) + 12345u;
+    return (int8_t)(mean + (int32_t)((gLcg >> 16) % (2u * spread + 1u)) - (int32_t)spread);
+}
+
+/* Walk up to the car, wait, walk away: 10 Hz, returns unlocks seen on the device */
+static uint32_t Dev_Approach(uint32_t *pTMs)
+{
+    uint32_t unlocks = 0u;
+    uint32_t i;
+
+    for (i = 0u; i < 50u; i++)  { *pTMs += 100u; (void)Dev_Step(*pTMs, Noise(-78, 4u)); }
+    for (i = 0u; i < 100u; i++) { *pTMs += 100u; unlocks += (Dev_Step(*pTMs, Noise(-44, 3u)) == PROX_RSSI_EVT_UNLOCK_TRIGGERED) ? 1u : 0u; }
+    for (i = 0u; i < 80u; i++)  { *pTMs += 100u; (void)Dev_Step(*pTMs, Noise(-82, 4u)); }
+
+    return unlocks;
+}
+
+/* Flush and concatenate every stored block, like "flightrec dump" */
+static size_t CollectLog(void)
+{
+    size_t len = 0u;
+
+    (void)FlightRec_Flush();
+    for (uint32_t i = 0u; i < FlightRec_BlockCount(); i++)
+    {
+        len += FlightRec_ReadBlock(i, &gaDump[len]);
+    }
+    return len;
+}
+
+static frReplay_t *Replay(size_t len)
+{
+    static frBlock_t aBlocks[FLIGHT_REC_FLASH_SIZE / FLIGHT_REC_HDR_LEN];
+    frReplay_t *pR = calloc(1u, sizeof(frReplay_t));
+    uint32_t n = FlightReplay_ScanBlocks(gaDump, len, aBlocks, (uint32_t)(sizeof(aBlocks) / sizeof(aBlocks[0])));
+
+    FlightReplay_Run(pR, aBlocks, n);
+    return pR;
+}
+
+static void Replay_Free(frReplay_t *pR)
+{
+    free(pR->pSamples);
+    free(pR->pConfigs);
+    free(pR);
+}
+
+static void Fresh(void)
+{
+    memset(gaStubFlash, 0, sizeof(gaStubFlash));
+    gStubFlashErases = 0u;
+    gStubFlashFailProgram = 0;
+    FlightRec_Init();
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_sample_roundtrip(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Delta/varint samples decode exactly\n");
+
+    const uint32_t aT[]  = { 1000u, 1100u, 1100u, 1227u, 90000u, 0xFFFFFFF0u, 5u };
+    const int8_t aRssi[] = { -60, -127, -1, -64, -64, -90, -30 };
+    ProxRssi_FeaturesType feat;
+
+    memset(&feat, 0, sizeof(feat));
+    Fresh();
+    Dev_Params(&gDevCtx.p);
+    FlightRec_LogReset(900u, &gDevCtx.p, gaDevLut, 63u);
+    for (uint32_t i = 0u; i < 7u; i++)
+    {
+        FlightRec_LogStep(aT[i], aRssi[i], PROX_RSSI_EVT_NONE, &feat, 0, PROX_RSSI_ST_FAR);
+    }
+
+    frReplay_t *pR = Replay(CollectLog());
+    TEST_ASSERT(pR->samples == 7u && pR->numSamples == 7u, "All samples decoded and replayed");
+    for (uint32_t i = 0u; i < 7u; i++)
+    {
+        TEST_ASSERT(pR->pSamples[i].t == aT[i], "Timestamp");
+        TEST_ASSERT(pR->pSamples[i].rssi == aRssi[i], "RSSI");
+    }
+    TEST_ASSERT(pR->pSamples[0].configIdx == 0, "Replay starts at the RESET");
+    TEST_ASSERT(pR->badRecords == 0u, "No bad blocks");
+    Replay_Free(pR);
+
+    TEST_PASS("Delta/varint samples decode exactly");
+}
+
+static void test_replay_bit_exact(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Replay reproduces every ProxRssi decision\n");
+
+    uint32_t tMs = 5000u;
+    uint32_t unlocks;
+
+    Fresh();
+    Dev_Init(tMs, NULL);
+    FlightRec_LogEvent(tMs, FLIGHT_REC_EVT_CONNECT, 0u);
+    unlocks = Dev_Approach(&tMs);
+    FlightRec_LogEvent(tMs, FLIGHT_REC_EVT_DISCONNECT, 0u);
+    TEST_ASSERT(unlocks == 1u, "Scenario unlocks once");
+
+    frReplay_t *pR = Replay(CollectLog());
+    tprintf("  %lu samples, %lu bytes, %.2f bytes/sample, %lu events checked\n",
+            pR->samples, pR->logBytes, (double)pR->logBytes / (double)pR->samples, pR->evChecks);
+    TEST_ASSERT(pR->replayed == 230u, "Every sample replayed");
+    TEST_ASSERT(pR->evChecks >= 3u, "Candidate, unlock and exit checked");
+    TEST_ASSERT(pR->evMismatch == 0u, "Events match");
+    TEST_ASSERT(pR->featChecks >= 23u && pR->featMismatch == 0u, "Features, EMA and state match");
+    Replay_Free(pR);
+
+    TEST_PASS("Replay reproduces every ProxRssi decision");
+}
+
+static void test_replay_detects_divergence(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Replay flags a log that does not match the device\n");
+
+    ProxRssi_ParamsType wrong;
+    uint32_t tMs = 0u;
+
+    Fresh();
+    Dev_Params(&wrong);
+    wrong.enterNearQ4 = ProxRssi_DbmToQ4(-40);
+    Dev_Init(tMs, &wrong);
+    (void)Dev_Approach(&tMs);
+
+    frReplay_t *pR = Replay(CollectLog());
+    TEST_ASSERT(pR->evMismatch != 0u, "Event mismatch reported");
+    Replay_Free(pR);
+
+    TEST_PASS("Replay flags a log that does not match the device");
+}
+
+static void test_flash_wrap_and_reboot(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Flash wraps sector by sector and survives a reboot\n");
+
+    uint32_t tMs = 0u;
+    uint32_t seqBeforeReboot;
+
+    Fresh();
+    Dev_Init(tMs, NULL);
+    /* ~10 min of 10 Hz samples, flushed every minute like on disconnects */
+    for (uint32_t m = 0u; m < 10u; m++)
+    {
+        for (uint32_t i = 0u; i < 600u; i++)
+        {
+            tMs += 100u;
+            (void)Dev_Step(tMs, Noise(-70, 6u));
+        }
+        (void)FlightRec_Flush();
+    }
+    TEST_ASSERT(FlightRec_GetLostBlocks() == 0u, "Nothing lost between flushes");
+    TEST_ASSERT(gStubFlashErases > (FLIGHT_REC_FLASH_SIZE / STUB_FLASH_SECTOR_SIZE), "Flash wrapped");
+    seqBeforeReboot = gFlightRecNextSeq;
+
+    /* Reboot: the RAM is lost, flash is kept */
+    FlightRec_Init();
+    TEST_ASSERT(gFlightRecNextSeq == seqBeforeReboot, "Sequence continues after reboot");
+    tMs = 100u;
+    Dev_Init(tMs, NULL);
+    for (uint32_t i = 0u; i < 200u; i++)
+    {
+        tMs += 100u;
+        (void)Dev_Step(tMs, Noise(-70, 6u));
+    }
+
+    size_t len = CollectLog();
+    static frBlock_t aBlocks[FLIGHT_REC_FLASH_SIZE / FLIGHT_REC_HDR_LEN];
+    uint32_t n = FlightReplay_ScanBlocks(gaDump, len, aBlocks, (uint32_t)(sizeof(aBlocks) / sizeof(aBlocks[0])));
+    TEST_ASSERT(n > (FLIGHT_REC_FLASH_SIZE / FLIGHT_REC_BLOCK_SIZE) / 2u, "At least one sector of history kept");
+    TEST_ASSERT(aBlocks[n - 1u].seq == gFlightRecNextSeq - 1u, "Newest block stored");
+    for (uint32_t i = 1u; i < n; i++)
+    {
+        TEST_ASSERT(aBlocks[i].seq == aBlocks[i - 1u].seq + 1u, "Contiguous sequence");
+    }
+
+    frReplay_t *pR = Replay(len);
+    tprintf("  %lu samples in %lu bytes, %.2f bytes/sample\n",
+            pR->samples, pR->logBytes, (double)pR->logBytes / (double)pR->samples);
+    TEST_ASSERT(((double)pR->logBytes / (double)pR->samples) < 3.5, "Under 3.5 bytes per sample");
+    TEST_ASSERT(pR->boots >= 1u, "Reboot visible");
+    TEST_ASSERT(pR->evMismatch == 0u && pR->featMismatch == 0u, "Replay still exact");
+    Replay_Free(pR);
+
+    TEST_PASS("Flash wraps sector by sector and survives a reboot");
+}
+
+static void test_ram_overrun_counted(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] RAM overrun without flush is counted, replay resynchronises\n");
+
+    uint32_t tMs = 0u;
+
+    Fresh();
+    Dev_Init(tMs, NULL);
+    for (uint32_t i = 0u; i < 4000u; i++)
+    {
+        tMs += 100u;
+        (void)Dev_Step(tMs, Noise(-70, 6u));
+    }
+    TEST_ASSERT(FlightRec_GetLostBlocks() != 0u, "Lost blocks reported");
+    TEST_ASSERT(FlightRec_Flush() == FLIGHT_REC_RAM_BLOCKS, "Whole RAM ring flushed");
+
+    frReplay_t *pR = Replay(CollectLog());
+    TEST_ASSERT(pR->blocks == FLIGHT_REC_RAM_BLOCKS, "Only the retained blocks");
+    TEST_ASSERT(pR->resets == 0u, "RESET overwritten");
+    TEST_ASSERT(pR->replayed > 1000u && pR->resyncs == 1u, "Replay resynchronised on a repeated CONFIG");
+    TEST_ASSERT(pR->featChecks != 0u && pR->featMismatch == 0u && pR->evMismatch == 0u, "Resynchronised replay exact");
+    TEST_ASSERT(pR->samples > 1500u, "Minutes of samples kept");
+    Replay_Free(pR);
+
+    TEST_PASS("RAM overrun without flush is counted, replay resynchronises");
+}
+
+static void test_flash_failure_skips_slot(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Program failure does not stall the recorder\n");
+
+    uint32_t tMs = 0u;
+
+    Fresh();
+    Dev_Init(tMs, NULL);
+    (void)Dev_Step(100u, -60);
+    gStubFlashFailProgram = 1;
+    TEST_ASSERT(FlightRec_Flush() == 0u, "Failed block not counted");
+    gStubFlashFailProgram = 0;
+    (void)Dev_Step(200u, -61);
+    TEST_ASSERT(FlightRec_Flush() == 2u, "Failed block retried with the next one");
+
+    frReplay_t *pR = Replay(CollectLog());
+    TEST_ASSERT(pR->blocks == 2u && pR->replayed == 2u, "Both blocks readable");
+    TEST_ASSERT(pR->evMismatch == 0u && pR->featMismatch == 0u, "Replay exact");
+    Replay_Free(pR);
+
+    TEST_PASS("Program failure does not stall the recorder");
+}
+
+static void test_shell_dump_parse(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Shell dump lines decode like a flash image\n");
+
+    static char text[4u * FLIGHT_REC_FLASH_SIZE];
+    static const char hex[] = "0123456789ABCDEF";
+    uint32_t tMs = 0u;
+    size_t len, pos = 0u;
+
+    Fresh();
+    Dev_Init(tMs, NULL);
+    (void)Dev_Approach(&tMs);
+    len = CollectLog();
+
+    /* "FR:" + 32 bytes per line, with shell noise in between */
+    pos += (size_t)sprintf(&text[pos], "flightrec dump\r\n");
+    for (size_t i = 0u; i < len; i += 32u)
+    {
+        pos += (size_t)sprintf(&text[pos], "FR:");
+        for (size_t k = i; (k < len) && (k < i + 32u); k++)
+        {
+            text[pos++] = hex[gaDump[k] >> 4];
+            text[pos++] = hex[gaDump[k] & 0x0Fu];
+        }
+        pos += (size_t)sprintf(&text[pos], "\r\n");
+    }
+    pos += (size_t)sprintf(&text[pos], "Done.\r\n");
+
+    memset(gaDump, 0, sizeof(gaDump));
+    TEST_ASSERT(FlightReplay_ParseShellDump((uint8_t *)text, pos) == len, "Byte count");
+    memcpy(gaDump, text, len);
+
+    frReplay_t *pR = Replay(len);
+    TEST_ASSERT(pR->replayed == 230u && pR->evMismatch == 0u && pR->featMismatch == 0u, "Replay exact");
+
+    ProxRssi_CtxType *pCtx = malloc(sizeof(ProxRssi_CtxType));
+    TEST_ASSERT(FlightReplay_Bench(pR, pCtx) == 1u, "Bench replay sees the unlock");
+    free(pCtx);
+    Replay_Free(pR);
+
+    TEST_PASS("Shell dump lines decode like a flash image");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "FlightRec Unit Tests (Encoding + Flash + Replay)", &xmlPath);
+
+    RUN_TEST(test_sample_roundtrip);
+    RUN_TEST(test_replay_bit_exact);
+    RUN_TEST(test_replay_detects_divergence);
+    RUN_TEST(test_flash_wrap_and_reboot);
+    RUN_TEST(test_ram_overrun_counted);
+    RUN_TEST(test_flash_failure_skips_slot);
+    RUN_TEST(test_shell_dump_parse);
+
+    return Test_End(xmlPath);
+}
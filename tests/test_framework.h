@@ -0,0 +1,173 @@
+/*! *********************************************************************************
+* \file test_framework.h
+*
+* \brief  Minimal self-contained host test framework with JUnit XML and log file
+*         support, shared by the host-side unit tests. Same macros and command
+*         line (--xml <file>, --log <file>) as test_prox_rssi.c.
+*
+*         Define TEST_SUITE_NAME before including this header.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef TEST_FRAMEWORK_H
+#define TEST_FRAMEWORK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef TEST_SUITE_NAME
+#error "Define TEST_SUITE_NAME before including test_framework.h"
+#endif
+
+static int gTestsPassed = 0;
+static int gTestsFailed = 0;
+static int gTestsTotal  = 0;
+
+static FILE *gLogFile = NULL;
+
+#define tprintf(...) do {               \
+    printf(__VA_ARGS__);                \
+    if (gLogFile != NULL) {             \
+        fprintf(gLogFile, __VA_ARGS__); \
+    }                                   \
+} while(0)
+
+#define MAX_TESTS 64
+#define MAX_MSG   256
+
+typedef struct {
+    char name[MAX_MSG];
+    char failMsg[MAX_MSG];
+    char file[MAX_MSG];
+    int  line;
+    int  passed;
+} TestResult_t;
+
+static TestResult_t gResults[MAX_TESTS];
+static int          gResultCount = 0;
+static const char  *gCurrentTestName = "";
+
+static void JUnit_WriteXml(const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        printf("  WARNING: Could not open %s for writing\n", path);
+        return;
+    }
+    fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(fp, "<testsuites>\n");
+    fprintf(fp, "  <testsuite name=\"%s\" tests=\"%d\" "
+                "failures=\"%d\">\n",
+            TEST_SUITE_NAME, gTestsPassed + gTestsFailed, gTestsFailed);
+
+    for (int i = 0; i < gResultCount; i++)
+    {
+        const TestResult_t *r = &gResults[i];
+        fprintf(fp, "    <testcase name=\"%s\">\n", r->name);
+        if (!r->passed)
+        {
+            fprintf(fp, "      <failure message=\"%s\">"
+                        "%s at %s:%d</failure>\n",
+                    r->failMsg, r->failMsg, r->file, r->line);
+        }
+        fprintf(fp, "    </testcase>\n");
+    }
+
+    fprintf(fp, "  </testsuite>\n");
+    fprintf(fp, "</testsuites>\n");
+    fclose(fp);
+    printf("  JUnit XML written to: %s\n", path);
+}
+
+static void RecordResult(const char *name, int passed,
+                         const char *failMsg, const char *file, int line)
+{
+    if (gResultCount < MAX_TESTS)
+    {
+        TestResult_t *r = &gResults[gResultCount++];
+        snprintf(r->name, MAX_MSG, "%s", name);
+        snprintf(r->failMsg, MAX_MSG, "%s", failMsg ? failMsg : "");
+        snprintf(r->file, MAX_MSG, "%s", file ? file : "");
+        r->line   = line;
+        r->passed = passed;
+    }
+}
+
+#define TEST_ASSERT(cond, msg) do {              \
+    if (!(cond)) {                               \
+        tprintf("  FAIL: %s\n", (msg));          \
+        tprintf("        at %s:%d\n",            \
+               __FILE__, __LINE__);              \
+        RecordResult(gCurrentTestName, 0,        \
+                     (msg), __FILE__, __LINE__); \
+        gTestsFailed++;                          \
+        return;                                  \
+    }                                            \
+} while(0)
+
+#define TEST_PASS(msg) do {                      \
+    tprintf("  PASS: %s\n", (msg));              \
+    RecordResult(gCurrentTestName, 1,            \
+                 NULL, NULL, 0);                 \
+    gTestsPassed++;                              \
+} while(0)
+
+#define RUN_TEST(fn) do {                        \
+    gCurrentTestName = #fn;                      \
+    fn();                                        \
+} while(0)
+
+/* Parse --xml / --log and open the log file */
+static void Test_Begin(int argc, char *argv[], const char *title, const char **pXmlPath)
+{
+    const char *logPath = NULL;
+
+    *pXmlPath = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--xml") == 0 && (i + 1) < argc)
+        {
+            *pXmlPath = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--log") == 0 && (i + 1) < argc)
+        {
+            logPath = argv[i + 1];
+            i++;
+        }
+    }
+
+    if (logPath != NULL)
+    {
+        gLogFile = fopen(logPath, "w");
+        if (gLogFile == NULL)
+        {
+            printf("  WARNING: Could not open log file %s\n", logPath);
+        }
+    }
+
+    tprintf("\n");
+    tprintf("================================================================\n");
+    tprintf("  %s\n", title);
+    tprintf("================================================================\n");
+}
+
+/* Print the summary, write the XML report and return the process exit code */
+static int Test_End(const char *xmlPath)
+{
+    tprintf("\n================================================================\n");
+    tprintf("  Results: %d passed, %d failed, %d total\n",
+            gTestsPassed, gTestsFailed, gTestsPassed + gTestsFailed);
+    tprintf("================================================================\n\n");
+
+    if (xmlPath != NULL) { JUnit_WriteXml(xmlPath); }
+
+    if (gLogFile != NULL) { fclose(gLogFile); gLogFile = NULL; }
+
+    return (gTestsFailed > 0) ? 1 : 0;
+}
+
+#endif /* TEST_FRAMEWORK_H */
@@ -0,0 +1,281 @@
+/*! *********************************************************************************
+* \file test_gatt_cache.c
+*
+* \brief  Unit tests for GattCache — GATT handle cache per bond for the service
+*         discovery. Runs on host machine (macOS/Linux). Tests the real
+*         gatt_cache.c: record and replay of a database, Database Hash match,
+*         recordings that do not fit or are stopped, bonds out of range, and
+*         phone databases at the default capacity.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "gatt_cache"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#define GATT_CACHE_BONDS                (2u)
+#include "gatt_cache.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+static const uint8_t gaHashA[GATT_CACHE_HASH_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+static const uint8_t gaHashB[GATT_CACHE_HASH_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 17};
+
+static bool_t AddService(uint8_t bond, uint16_t start, uint16_t end, uint16_t uuid16)
+{
+    gattCacheService_t svc;
+
+    FLib_MemSet(&svc, 0u, sizeof(svc));
+    svc.startHandle = start;
+    svc.endHandle = end;
+    svc.uuidType = GATT_CACHE_UUID_TYPE_16;
+    svc.cChars = 0xFFu;                         /* Counted by the cache */
+    svc.aUuid[0] = (uint8_t)uuid16;
+    svc.aUuid[1] = (uint8_t)(uuid16 >> 8u);
+    return GattCache_AddService(bond, &svc);
+}
+
+static bool_t AddChar(uint8_t bond, uint16_t valueHandle, uint8_t properties)
+{
+    gattCacheChar_t chr;
+
+    FLib_MemSet(&chr, 0u, sizeof(chr));
+    chr.valueHandle = valueHandle;
+    chr.properties = properties;
+    chr.uuidType = 0x02u;                       /* 128-bit characteristics are cached */
+    chr.aUuid[15] = (uint8_t)valueHandle;
+    return GattCache_AddChar(bond, &chr);
+}
+
+static bool_t AddDesc(uint8_t bond, uint16_t handle, uint8_t uuidType)
+{
+    gattCacheDesc_t desc = {handle, 0x2902u, uuidType};
+    return GattCache_AddDesc(bond, &desc);
+}
+
+/* GAP + DK service: 2 services, 3 characteristics, 2 CCCDs */
+static void RecordPhone(uint8_t bond, const uint8_t *pHash)
+{
+    (void)GattCache_Begin(bond, pHash);
+    (void)AddService(bond, 0x0001u, 0x0007u, 0x1800u);
+    (void)AddChar(bond, 0x0003u, 0x02u);
+    (void)AddService(bond, 0x0010u, 0x0018u, 0xFFF5u);
+    (void)AddChar(bond, 0x0012u, 0x10u);
+    (void)AddDesc(bond, 0x0013u, GATT_CACHE_UUID_TYPE_16);
+    (void)AddChar(bond, 0x0015u, 0x28u);
+    (void)AddDesc(bond, 0x0016u, GATT_CACHE_UUID_TYPE_16);
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_replay(void)
+{
+    const gattCacheService_t *pSvc;
+    const gattCacheChar_t *pChars;
+    const gattCacheDesc_t *pDescs;
+    gattCacheStats_t st;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Record, match and replay\n");
+
+    GattCache_Init();
+    TEST_ASSERT(GattCache_Match(0u, gaHashA) == FALSE, "Empty cache misses");
+
+    RecordPhone(0u, gaHashA);
+    TEST_ASSERT(GattCache_Match(0u, gaHashA) == FALSE, "Not before the commit");
+    TEST_ASSERT(GattCache_GetService(0u, 0u, &pChars, &pDescs) == NULL, "No replay of a recording");
+    TEST_ASSERT(GattCache_Commit(0u) == TRUE, "Committed");
+    TEST_ASSERT(GattCache_Commit(0u) == FALSE, "Once");
+
+    TEST_ASSERT(GattCache_Match(0u, gaHashA) == TRUE, "Same hash hits");
+    TEST_ASSERT(GattCache_Match(1u, gaHashA) == FALSE, "Per bond");
+
+    pSvc = GattCache_GetService(0u, 0u, &pChars, &pDescs);
+    TEST_ASSERT((pSvc != NULL) && (pSvc->startHandle == 0x0001u) && (pSvc->cChars == 1u), "GAP service");
+    TEST_ASSERT((pChars[0].valueHandle == 0x0003u) && (pChars[0].cDescs == 0u), "Its characteristic");
+
+    pSvc = GattCache_GetService(0u, 1u, &pChars, &pDescs);
+    TEST_ASSERT((pSvc != NULL) && (pSvc->endHandle == 0x0018u) && (pSvc->aUuid[0] == 0xF5u) &&
+                (pSvc->uuidType == GATT_CACHE_UUID_TYPE_16), "DK service");
+    TEST_ASSERT((pSvc->cChars == 2u) && (pChars[1].valueHandle == 0x0015u) && (pChars[1].aUuid[15] == 0x15u) &&
+                (pChars[1].properties == 0x28u), "Second characteristic of the second service");
+    TEST_ASSERT((pChars[0].cDescs == 1u) && (pDescs[0].handle == 0x0013u) &&
+                (pChars[1].cDescs == 1u) && (pDescs[1].handle == 0x0016u) && (pDescs[1].uuid16 == 0x2902u),
+                "Descriptors in turn");
+    TEST_ASSERT(GattCache_GetService(0u, 2u, &pChars, &pDescs) == NULL, "Past the last service");
+
+    GattCache_GetStats(&st);
+    TEST_ASSERT((st.hits == 1u) && (st.misses == 3u) && (st.stored == 1u) && (st.dropped == 0u), "Counters");
+
+    TEST_PASS("Record, match and replay");
+}
+
+static void test_hash_change(void)
+{
+    const gattCacheChar_t *pChars;
+    const gattCacheDesc_t *pDescs;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Database Hash change, stopped discovery\n");
+
+    GattCache_Init();
+    RecordPhone(0u, gaHashA);
+    (void)GattCache_Commit(0u);
+
+    /* Phone update: another hash, discovery recorded again */
+    TEST_ASSERT(GattCache_Match(0u, gaHashB) == FALSE, "Another hash misses");
+    TEST_ASSERT(GattCache_Begin(0u, gaHashB) == TRUE, "Recording again");
+    TEST_ASSERT(GattCache_Match(0u, gaHashA) == FALSE, "Old entry dropped");
+
+    /* Link lost in the middle */
+    (void)AddService(0u, 0x0001u, 0x0009u, 0x1800u);
+    GattCache_Abort(0u);
+    TEST_ASSERT(GattCache_Commit(0u) == FALSE, "Nothing to commit after abort");
+    TEST_ASSERT(AddChar(0u, 0x0003u, 0x02u) == FALSE, "Nothing recorded after abort");
+    TEST_ASSERT(GattCache_Match(0u, gaHashB) == FALSE, "Still a miss");
+
+    /* Complete the next time */
+    RecordPhone(0u, gaHashB);
+    (void)GattCache_Commit(0u);
+    GattCache_Abort(0u);
+    TEST_ASSERT(GattCache_Match(0u, gaHashB) == TRUE, "Abort keeps a complete entry");
+    TEST_ASSERT(GattCache_GetService(0u, 1u, &pChars, &pDescs) != NULL, "Replayable");
+
+    TEST_PASS("Database Hash change, stopped discovery");
+}
+
+static void test_dropped(void)
+{
+    gattCacheStats_t st;
+    uint8_t i;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Recordings that do not fit\n");
+
+    GattCache_Init();
+
+    /* One characteristic too many */
+    (void)GattCache_Begin(0u, gaHashA);
+    (void)AddService(0u, 0x0001u, 0x00FFu, 0x1800u);
+    for (i = 0u; i < GATT_CACHE_MAX_CHARS; i++)
+    {
+        TEST_ASSERT(AddChar(0u, (uint16_t)(0x0003u + (2u * i)), 0x02u) == TRUE, "Fits");
+    }
+    TEST_ASSERT(AddChar(0u, 0x00F0u, 0x02u) == FALSE, "Too many characteristics");
+    TEST_ASSERT(GattCache_Commit(0u) == FALSE, "Dropped, not committed");
+
+    /* 128-bit descriptor */
+    (void)GattCache_Begin(1u, gaHashA);
+    (void)AddService(1u, 0x0001u, 0x0010u, 0xFFF5u);
+    (void)AddChar(1u, 0x0003u, 0x10u);
+    TEST_ASSERT(AddDesc(1u, 0x0004u, 0x02u) == FALSE, "128-bit descriptor");
+    TEST_ASSERT(GattCache_Commit(1u) == FALSE, "Dropped");
+
+    /* Descriptor before any characteristic of its service */
+    (void)GattCache_Begin(1u, gaHashA);
+    (void)AddService(1u, 0x0001u, 0x0005u, 0x1800u);
+    (void)AddChar(1u, 0x0003u, 0x02u);
+    (void)AddService(1u, 0x0006u, 0x0010u, 0xFFF5u);
+    TEST_ASSERT(AddDesc(1u, 0x0007u, GATT_CACHE_UUID_TYPE_16) == FALSE, "Orphan descriptor");
+
+    /* Too many services */
+    (void)GattCache_Begin(1u, gaHashA);
+    for (i = 0u; i < GATT_CACHE_MAX_SERVICES; i++)
+    {
+        (void)AddService(1u, (uint16_t)(0x0010u * (i + 1u)), (uint16_t)((0x0010u * (i + 1u)) + 5u), 0x1800u);
+    }
+    TEST_ASSERT(AddService(1u, 0x0100u, 0x0105u, 0x1801u) == FALSE, "Too many services");
+
+    GattCache_GetStats(&st);
+    TEST_ASSERT((st.dropped == 4u) && (st.stored == 0u), "Four dropped");
+
+    /* An empty database is a valid entry */
+    (void)GattCache_Begin(0u, gaHashB);
+    TEST_ASSERT(GattCache_Commit(0u) == TRUE, "No service");
+    TEST_ASSERT(GattCache_Match(0u, gaHashB) == TRUE, "Matches");
+
+    /* Bonds out of range are not cached */
+    TEST_ASSERT(GattCache_Begin(GATT_CACHE_BONDS, gaHashA) == FALSE, "Not cached");
+    TEST_ASSERT(AddService(GATT_CACHE_BONDS, 0x0001u, 0x0005u, 0x1800u) == FALSE, "Ignored");
+    TEST_ASSERT(GattCache_Match(GATT_CACHE_BONDS, gaHashA) == FALSE, "Never matches");
+
+    TEST_PASS("Recordings that do not fit");
+}
+
+static void test_phone_databases(void)
+{
+    /* Services kept by the discovery: characteristics and CCCDs of each */
+    static const uint8_t aIosChars[6]     = {3u, 3u, 3u, 3u, 2u, 5u};   /* GAP, GATT, ANCS, AMS, Continuity, DIS */
+    static const uint8_t aIosDescs[6]     = {0u, 1u, 2u, 2u, 1u, 0u};
+    static const uint8_t aAndroidChars[6] = {3u, 4u, 1u, 6u, 2u, 3u};   /* GAP, GATT, Battery, vendor... */
+    static const uint8_t aAndroidDescs[6] = {0u, 2u, 1u, 4u, 2u, 1u};
+    const uint8_t *apChars[2] = {aIosChars, aAndroidChars};
+    const uint8_t *apDescs[2] = {aIosDescs, aAndroidDescs};
+    const gattCacheChar_t *pChars;
+    const gattCacheDesc_t *pDescs;
+    uint16_t handle;
+    uint8_t bond;
+    uint8_t s;
+    uint8_t c;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Phone databases fit the default capacity\n");
+
+    GattCache_Init();
+    TEST_ASSERT(GATT_CACHE_MAX_SERVICES >= 6u, "Services kept by the discovery");
+
+    for (bond = 0u; bond < 2u; bond++)
+    {
+        handle = 0x0001u;
+        (void)GattCache_Begin(bond, gaHashA);
+        for (s = 0u; s < 6u; s++)
+        {
+            TEST_ASSERT(AddService(bond, handle, (uint16_t)(handle + 0x20u), (uint16_t)(0x1800u + s)) == TRUE,
+                        "Service fits");
+            for (c = 0u; c < apChars[bond][s]; c++)
+            {
+                TEST_ASSERT(AddChar(bond, (uint16_t)(handle + 2u + (3u * c)), 0x12u) == TRUE, "Characteristic fits");
+                if (c < apDescs[bond][s])
+                {
+                    TEST_ASSERT(AddDesc(bond, (uint16_t)(handle + 3u + (3u * c)), GATT_CACHE_UUID_TYPE_16) == TRUE,
+                                "Descriptor fits");
+                }
+            }
+            handle = (uint16_t)(handle + 0x21u);
+        }
+        TEST_ASSERT(GattCache_Commit(bond) == TRUE, "Stored");
+        TEST_ASSERT(GattCache_Match(bond, gaHashA) == TRUE, "Replayed next time");
+        TEST_ASSERT((GattCache_GetService(bond, 5u, &pChars, &pDescs) != NULL) &&
+                    (pChars[0].valueHandle == (uint16_t)(0x0001u + (5u * 0x21u) + 2u)), "Last service");
+    }
+
+    tprintf("  entry %u bytes, %u bonds\n", (unsigned)sizeof(gattCacheEntry_t), (unsigned)GATT_CACHE_BONDS);
+    TEST_ASSERT(sizeof(gattCacheEntry_t) <= 1024u, "About 1 KB per bond");
+
+    TEST_PASS("Phone databases fit the default capacity");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "GattCache Unit Tests (Replay + Hash + Capacity)", &xmlPath);
+
+    RUN_TEST(test_replay);
+    RUN_TEST(test_hash_change);
+    RUN_TEST(test_dropped);
+    RUN_TEST(test_phone_databases);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,192 @@
+/*! *********************************************************************************
+* \file test_log_export.c
+*
+* \brief  Unit tests for LogExport — framed ring buffer for the CS data log
+*         exporter — and the host decoder in tools/log_export_decode.c.
+*         Runs on host machine (macOS/Linux). Tests the real log_export.c via
+*         #include.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "log_export"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation and the decoder
+ ******************************************************************************/
+#define LOG_EXPORT_RING_SIZE    (256u)
+#define LOG_DECODE_NO_MAIN
+#include "log_export_decode.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+/* Drain the ring like the serial driver would, in chunks of at most maxChunk */
+static size_t Drain(uint8_t *pOut, size_t maxChunk)
+{
+    size_t total = 0u;
+    uint8_t *pData;
+    uint32_t len;
+
+    while ((len = LogExport_Peek(&pData)) != 0u)
+    {
+        if (len > maxChunk) { len = (uint32_t)maxChunk; }
+        memcpy(&pOut[total], pData, len);
+        total += len;
+        LogExport_Consume(len);
+    }
+    return total;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_crc_reference(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] CRC-16/CCITT-FALSE reference value\n");
+
+    const uint8_t check[] = "123456789";
+    TEST_ASSERT(LogExport_Crc16(0xFFFFu, check, 9u) == 0x29B1u, "Check value 0x29B1");
+
+    TEST_PASS("CRC-16/CCITT-FALSE reference value");
+}
+
+static void test_frame_roundtrip(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Frames decode after ring wrap\n");
+
+    uint8_t out[4096];
+    size_t outLen = 0u;
+    const uint8_t hdr[4] = {0x04u, 0x3Eu, 0x05u, 0x31u};
+    uint8_t body[40];
+
+    for (uint8_t i = 0u; i < sizeof(body); i++) { body[i] = i; }
+
+    LogExport_Init();
+    /* Repeated fill/drain forces frames across the ring end */
+    for (uint32_t n = 0u; n < 20u; n++)
+    {
+        TEST_ASSERT(LogExport_Append(LOG_EXPORT_TYPE_HCI, 1000u * n, hdr, 4u, body, (uint16_t)(n + 1u)) == TRUE, "Queued");
+        outLen += Drain(&out[outLen], 17u);
+    }
+    TEST_ASSERT(LogExport_Used() == 0u, "Ring empty after drain");
+
+    size_t pos = 0u;
+    uint32_t n = 0u;
+    logDecodeFrame_t frame;
+    size_t used, skip;
+    while (LogDecode_Next(&out[pos], outLen - pos, &frame, &used, &skip) == logDecodeFrame_c)
+    {
+        pos += used;
+        TEST_ASSERT(skip == 0u, "No garbage");
+        TEST_ASSERT(frame.type == LOG_EXPORT_TYPE_HCI, "Type");
+        TEST_ASSERT(frame.seq == (uint8_t)n, "Sequence");
+        TEST_ASSERT(frame.timestampUs == 1000u * n, "Timestamp");
+        TEST_ASSERT(frame.len == 4u + n + 1u, "Length");
+        TEST_ASSERT(memcmp(frame.pPayload, hdr, 4u) == 0 && memcmp(&frame.pPayload[4], body, n + 1u) == 0, "Payload");
+        n++;
+    }
+    TEST_ASSERT(n == 20u, "All frames decoded");
+    TEST_ASSERT(pos == outLen, "Whole stream consumed");
+
+    TEST_PASS("Frames decode after ring wrap");
+}
+
+static void test_overflow_reported(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Overflow drops and reports instead of blocking\n");
+
+    uint8_t out[1024];
+    uint8_t body[100] = {0};
+
+    LogExport_Init();
+    TEST_ASSERT(LogExport_Append(LOG_EXPORT_TYPE_RAS, 1u, body, 100u, NULL, 0u) == TRUE, "1st fits");
+    TEST_ASSERT(LogExport_Append(LOG_EXPORT_TYPE_RAS, 2u, body, 100u, NULL, 0u) == TRUE, "2nd fits");
+    TEST_ASSERT(LogExport_Append(LOG_EXPORT_TYPE_RAS, 3u, body, 100u, NULL, 0u) == FALSE, "3rd dropped");
+    TEST_ASSERT(LogExport_Append(LOG_EXPORT_TYPE_RAS, 4u, body, 50u, NULL, 0u) == FALSE, "4th dropped");
+    TEST_ASSERT(LogExport_GetDropped() == 2u, "2 dropped");
+
+    size_t outLen = Drain(out, 64u);
+    TEST_ASSERT(LogExport_Append(LOG_EXPORT_TYPE_RAS, 5u, body, 10u, NULL, 0u) == TRUE, "Queued after drain");
+    outLen += Drain(&out[outLen], 64u);
+
+    logDecodeFrame_t frame;
+    size_t used, skip, pos = 0u;
+    uint32_t ovfFrames = 0u, ovfBytes = 0u;
+    uint8_t prevType = 0u, lastType = 0u;
+    while (LogDecode_Next(&out[pos], outLen - pos, &frame, &used, &skip) == logDecodeFrame_c)
+    {
+        pos += used;
+        prevType = lastType;
+        lastType = frame.type;
+        if (frame.type == LOG_EXPORT_TYPE_OVERFLOW)
+        {
+            ovfFrames += LogDecode_Get32(frame.pPayload);
+            ovfBytes  += LogDecode_Get32(&frame.pPayload[4]);
+        }
+    }
+    TEST_ASSERT(pos == outLen, "Whole stream decoded");
+    TEST_ASSERT(ovfFrames == 2u && ovfBytes == 150u, "All losses reported");
+    TEST_ASSERT(prevType == LOG_EXPORT_TYPE_OVERFLOW && lastType == LOG_EXPORT_TYPE_RAS, "Overflow before next frame");
+
+    TEST_PASS("Overflow drops and reports instead of blocking");
+}
+
+static void test_decoder_resync(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Decoder resynchronises after corruption\n");
+
+    uint8_t out[512];
+    uint8_t body[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    size_t outLen;
+
+    LogExport_Init();
+    (void)LogExport_Append(LOG_EXPORT_TYPE_HCI, 10u, body, 8u, NULL, 0u);
+    (void)LogExport_Append(LOG_EXPORT_TYPE_HCI, 20u, body, 8u, NULL, 0u);
+
+    /* Garbage in front, first frame corrupted */
+    out[0] = 0xA5u; out[1] = 0x00u; out[2] = 0x5Au;
+    outLen = 3u + Drain(&out[3], 512u);
+    out[3u + LOG_EXPORT_HDR_LEN + 2u] ^= 0xFFu;
+
+    logDecodeFrame_t frame;
+    size_t used, skip, pos = 0u;
+    uint32_t crcErrors = 0u;
+    logDecodeResult_t res;
+    while ((res = LogDecode_Next(&out[pos], outLen - pos, &frame, &used, &skip)) == logDecodeCrcError_c)
+    {
+        pos += used;
+        crcErrors++;
+    }
+    pos += used;
+    TEST_ASSERT(crcErrors == 1u, "One CRC error");
+    TEST_ASSERT(res == logDecodeFrame_c && frame.timestampUs == 20u, "Second frame recovered");
+    TEST_ASSERT(LogDecode_Next(&out[pos], outLen - pos, &frame, &used, &skip) == logDecodeNeedMore_c, "End of stream");
+
+    TEST_PASS("Decoder resynchronises after corruption");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "LogExport Unit Tests (Framing + Ring + Overflow + Decoder)", &xmlPath);
+
+    RUN_TEST(test_crc_reference);
+    RUN_TEST(test_frame_roundtrip);
+    RUN_TEST(test_overflow_reported);
+    RUN_TEST(test_decoder_resync);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,330 @@
+/*! *********************************************************************************
+* \file test_msg_lane.c
+*
+* \brief  Unit tests for MsgLane — critical/bulk lane scheduling of the application
+*         message queues and per lane latency statistics.
+*         Runs on host machine (macOS/Linux). Tests the real msg_lane.c via
+*         #include, and drives it with a synthetic message load.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "msg_lane"
+#include "test_framework.h"
+
+#include <stdlib.h>
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "cs_latency.h"
+#include "cs_latency.c"
+#include "msg_lane.h"
+#include "msg_lane.c"
+
+/*******************************************************************************
+ * Synthetic load
+ ******************************************************************************/
+
+#define SIM_DURATION_US         (2000000u)
+#define SIM_MAX_MSGS            (2048u)
+
+typedef struct
+{
+    uint32_t arriveUs;
+    uint32_t costUs;
+    uint8_t  lane;
+} simMsg_t;
+
+typedef struct
+{
+    uint32_t maxUs[msgLaneCount_c];
+    uint32_t served[msgLaneCount_c];
+} simResult_t;
+
+static simMsg_t gSimMsgs[SIM_MAX_MSGS];
+static uint32_t gSimCount;
+static uint32_t gSimMaxBulkCostUs;
+static uint32_t gSimMaxCriticalBurstUs;
+
+static void Sim_Add(uint32_t arriveUs, uint32_t costUs, msgLane_t lane)
+{
+    if ((gSimCount < SIM_MAX_MSGS) && (arriveUs < SIM_DURATION_US))
+    {
+        gSimMsgs[gSimCount].arriveUs = arriveUs;
+        gSimMsgs[gSimCount].costUs = costUs;
+        gSimMsgs[gSimCount].lane = (uint8_t)lane;
+        gSimCount++;
+    }
+}
+
+static int Sim_CompareArrival(const void *a, const void *b)
+{
+    const simMsg_t *pA = (const simMsg_t *)a;
+    const simMsg_t *pB = (const simMsg_t *)b;
+
+    return (pA->arriveUs > pB->arriveUs) - (pA->arriveUs < pB->arriveUs);
+}
+
+/* RSSI reads, CS procedures and Digital Key messages against shell bond listings
+   and long shell commands, arriving at unrelated periods */
+static void Sim_BuildLoad(void)
+{
+    uint32_t t;
+    uint32_t i;
+
+    gSimCount = 0u;
+
+    for (t = 0u; t < SIM_DURATION_US; t += 100000u)
+    {
+        Sim_Add(t + 3000u, 150u, msgLaneCritical_c);                /* RSSI read */
+    }
+    for (t = 0u; t < SIM_DURATION_US; t += 200000u)
+    {
+        for (i = 0u; i < 12u; i++)
+        {
+            Sim_Add(t + 41000u + (i * 500u), 300u, msgLaneCritical_c);  /* CS meta events */
+        }
+    }
+    for (t = 0u; t < SIM_DURATION_US; t += 500000u)
+    {
+        for (i = 0u; i < 10u; i++)
+        {
+            Sim_Add(t + 77000u + (i * 9000u), 200u, msgLaneCritical_c); /* DK messages */
+        }
+    }
+    for (t = 0u; t < SIM_DURATION_US; t += 250000u)
+    {
+        for (i = 0u; i < 20u; i++)
+        {
+            Sim_Add(t + 40000u, 2000u, msgLaneBulk_c);              /* Bond listing */
+        }
+    }
+    for (t = 0u; t < SIM_DURATION_US; t += 300000u)
+    {
+        for (i = 0u; i < 5u; i++)
+        {
+            Sim_Add(t + 75000u, 4000u, msgLaneBulk_c);              /* Long shell command */
+        }
+    }
+
+    qsort(gSimMsgs, gSimCount, sizeof(gSimMsgs[0]), Sim_CompareArrival);
+
+    gSimMaxBulkCostUs = 4000u;
+    gSimMaxCriticalBurstUs = 12u * 300u;
+}
+
+/* Non-preemptive single server. With lanes the next message comes from the lane
+   MsgLane_Pick returns, otherwise from one FIFO in arrival order. */
+static void Sim_Run(bool_t useLanes, simResult_t *pResult)
+{
+    uint32_t laneIdx[msgLaneCount_c][SIM_MAX_MSGS];
+    uint32_t laneHead[msgLaneCount_c] = {0u};
+    uint32_t laneTail[msgLaneCount_c] = {0u};
+    uint32_t fifoHead = 0u;
+    uint32_t next = 0u;
+    uint32_t now = 0u;
+    uint8_t mask;
+    uint8_t lane;
+    uint32_t idx;
+    uint32_t waitUs;
+
+    memset(pResult, 0, sizeof(*pResult));
+    MsgLane_Init();
+
+    while ((next < gSimCount) || (fifoHead < next))
+    {
+        /* Everything that arrived while the last handler ran is queued */
+        if ((fifoHead == next) && (gSimMsgs[next].arriveUs > now))
+        {
+            now = gSimMsgs[next].arriveUs;
+        }
+        while ((next < gSimCount) && (gSimMsgs[next].arriveUs <= now))
+        {
+            lane = gSimMsgs[next].lane;
+            laneIdx[lane][laneTail[lane]++] = next;
+            next++;
+        }
+
+        if (useLanes == TRUE)
+        {
+            mask = 0u;
+            for (lane = 0u; lane < (uint8_t)msgLaneCount_c; lane++)
+            {
+                if (laneHead[lane] != laneTail[lane])
+                {
+                    mask |= (uint8_t)MSG_LANE_BIT(lane);
+                }
+            }
+            lane = (uint8_t)MsgLane_Pick(mask);
+            if (lane >= (uint8_t)msgLaneCount_c)
+            {
+                continue;
+            }
+            idx = laneIdx[lane][laneHead[lane]++];
+        }
+        else
+        {
+            idx = fifoHead;
+            lane = gSimMsgs[idx].lane;
+        }
+        fifoHead++;
+
+        waitUs = now - gSimMsgs[idx].arriveUs;
+        MsgLane_Record((msgLane_t)lane, waitUs);
+        if (waitUs > pResult->maxUs[lane])
+        {
+            pResult->maxUs[lane] = waitUs;
+        }
+        pResult->served[lane]++;
+        now += gSimMsgs[idx].costUs;
+    }
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_pick_priority(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Critical lane goes first\n");
+
+    MsgLane_Init();
+    TEST_ASSERT(MsgLane_Pick(0u) == msgLaneCount_c, "Nothing pending");
+    TEST_ASSERT(MsgLane_Pick(MSG_LANE_BIT(msgLaneBulk_c)) == msgLaneBulk_c, "Bulk alone");
+    TEST_ASSERT(MsgLane_Pick(MSG_LANE_BIT(msgLaneCritical_c)) == msgLaneCritical_c, "Critical alone");
+    TEST_ASSERT(MsgLane_Pick(MSG_LANE_BIT(msgLaneCritical_c) | MSG_LANE_BIT(msgLaneBulk_c)) ==
+                msgLaneCritical_c, "Critical before bulk");
+
+    /* Critical alone does not count towards the burst */
+    MsgLane_Init();
+    for (uint32_t i = 0u; i < 100u; i++)
+    {
+        (void)MsgLane_Pick(MSG_LANE_BIT(msgLaneCritical_c));
+    }
+    TEST_ASSERT(MsgLane_Pick(MSG_LANE_BIT(msgLaneCritical_c) | MSG_LANE_BIT(msgLaneBulk_c)) ==
+                msgLaneCritical_c, "No bulk turn without bulk waiting");
+
+    TEST_PASS("Critical lane goes first");
+}
+
+static void test_pick_no_starvation(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Bulk lane is not starved by a critical flood\n");
+
+    uint8_t both = (uint8_t)(MSG_LANE_BIT(msgLaneCritical_c) | MSG_LANE_BIT(msgLaneBulk_c));
+    uint32_t run = 0u;
+    uint32_t bulkTurns = 0u;
+
+    MsgLane_Init();
+    for (uint32_t i = 0u; i < 90u; i++)
+    {
+        if (MsgLane_Pick(both) == msgLaneCritical_c)
+        {
+            run++;
+            TEST_ASSERT(run <= MSG_LANE_CRITICAL_BURST, "Critical run bounded");
+        }
+        else
+        {
+            TEST_ASSERT(run == MSG_LANE_CRITICAL_BURST, "Bulk turn after a full burst");
+            run = 0u;
+            bulkTurns++;
+        }
+    }
+    TEST_ASSERT(bulkTurns == 90u / (MSG_LANE_CRITICAL_BURST + 1u), "One bulk turn per burst");
+
+    TEST_PASS("Bulk lane is not starved by a critical flood");
+}
+
+static void test_stats(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Per lane latency statistics\n");
+
+    msgLaneStats_t stats;
+
+    MsgLane_Init();
+    TEST_ASSERT(MsgLane_GetStats(msgLaneCritical_c, &stats) == FALSE, "No samples");
+    TEST_ASSERT(MsgLane_GetStats(msgLaneCount_c, &stats) == FALSE, "Invalid lane");
+    TEST_ASSERT(MsgLane_GetStats(msgLaneBulk_c, NULL) == FALSE, "NULL output");
+    MsgLane_Record(msgLaneCount_c, 5u);
+
+    for (uint32_t i = 0u; i < 1000u; i++)
+    {
+        MsgLane_Record(msgLaneCritical_c, (i < 990u) ? 100u : 5000u);
+        MsgLane_Record(msgLaneBulk_c, 20000u);
+    }
+    MsgLane_Record(msgLaneCritical_c, 0u);
+
+    TEST_ASSERT(MsgLane_GetStats(msgLaneCritical_c, &stats) == TRUE, "Critical stats");
+    TEST_ASSERT(stats.count == 1001u, "Zero latency counted");
+    TEST_ASSERT((stats.p50Us >= 100u) && (stats.p50Us <= 125u), "p50 near 100 us");
+    TEST_ASSERT(stats.p99Us <= 125u, "p99 excludes the 1% tail");
+    TEST_ASSERT(stats.maxUs == 5000u, "Max exact");
+    TEST_ASSERT((MsgLane_GetStats(msgLaneBulk_c, &stats) == TRUE) && (stats.maxUs == 20000u), "Lanes separate");
+
+    MsgLane_ResetStats();
+    TEST_ASSERT(MsgLane_GetStats(msgLaneBulk_c, &stats) == FALSE, "Reset clears");
+
+    TEST_PASS("Per lane latency statistics");
+}
+
+static void test_synthetic_load_bounded(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Critical latency bounded under synthetic bulk load\n");
+
+    simResult_t fifo;
+    simResult_t lanes;
+    msgLaneStats_t critical;
+    msgLaneStats_t bulk;
+    uint32_t bound;
+
+    Sim_BuildLoad();
+    TEST_ASSERT(gSimCount < SIM_MAX_MSGS, "Load fits");
+
+    Sim_Run(FALSE, &fifo);
+    Sim_Run(TRUE, &lanes);
+    (void)MsgLane_GetStats(msgLaneCritical_c, &critical);
+    (void)MsgLane_GetStats(msgLaneBulk_c, &bulk);
+
+    tprintf("  FIFO  critical max %u us, bulk max %u us\n",
+            (unsigned)fifo.maxUs[msgLaneCritical_c], (unsigned)fifo.maxUs[msgLaneBulk_c]);
+    tprintf("  Lanes critical p50 %u / p99 %u / max %u us, bulk p99 %u / max %u us\n",
+            (unsigned)critical.p50Us, (unsigned)critical.p99Us, (unsigned)critical.maxUs,
+            (unsigned)bulk.p99Us, (unsigned)bulk.maxUs);
+
+    /* One bulk handler already running, one let through by the burst limit, and the
+       critical messages of one CS burst ahead */
+    bound = (2u * gSimMaxBulkCostUs) + gSimMaxCriticalBurstUs;
+
+    TEST_ASSERT(lanes.served[msgLaneCritical_c] == fifo.served[msgLaneCritical_c], "Same critical load");
+    TEST_ASSERT(lanes.served[msgLaneBulk_c] == fifo.served[msgLaneBulk_c], "Every bulk message served");
+    TEST_ASSERT(fifo.maxUs[msgLaneCritical_c] > bound, "Single FIFO exceeds the bound");
+    TEST_ASSERT(lanes.maxUs[msgLaneCritical_c] <= bound, "Critical wait bounded with lanes");
+    TEST_ASSERT(critical.maxUs == lanes.maxUs[msgLaneCritical_c], "Recorded max matches");
+    TEST_ASSERT(critical.p99Us * 4u < fifo.maxUs[msgLaneCritical_c], "Critical tail far below FIFO");
+    TEST_ASSERT(lanes.maxUs[msgLaneBulk_c] < 200000u, "Bulk still drains");
+
+    TEST_PASS("Critical latency bounded under synthetic bulk load");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "MsgLane Unit Tests (Scheduling + Stats + Load)", &xmlPath);
+
+    RUN_TEST(test_pick_priority);
+    RUN_TEST(test_pick_no_starvation);
+    RUN_TEST(test_stats);
+    RUN_TEST(test_synthetic_load_bounded);
+
+    return Test_End(xmlPath);
+}
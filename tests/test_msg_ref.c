@@ -0,0 +1,322 @@
+/*! *********************************************************************************
+* \file test_msg_ref.c
+*
+* \brief  Unit tests for MsgRef — reference counts of host stack messages lent to
+*         the application (zero-copy L2CAP PSM data).
+*         Runs on host machine (macOS/Linux). Tests the real msg_ref.c via
+*         #include, and replays the drain / application event sequence of
+*         app_conn.c and the car anchor with counted allocations.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "msg_ref"
+#include "test_framework.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "msg_ref.h"
+#include "msg_ref.c"
+
+/*******************************************************************************
+ * Drain emulation: host message -> L2CAP callback -> queued app event -> handler
+ ******************************************************************************/
+
+#define SIM_PACKET_LEN          (64u)
+#define SIM_EVENT_QUEUE         (16u)
+
+typedef struct
+{
+    uint16_t packetLength;
+    uint8_t  aPacket[SIM_PACKET_LEN];
+} simHostMsg_t;
+
+typedef struct
+{
+    uint16_t packetLength;
+    uint8_t *pPacket;
+    void    *pHostMsg;          /* NULL if the packet was copied */
+} simEvent_t;
+
+typedef struct
+{
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t copiedBytes;
+    uint32_t badPackets;
+} simCounters_t;
+
+static simCounters_t gSim;
+static simHostMsg_t *gpSimInHandler;
+static simEvent_t   *gaSimEvents[SIM_EVENT_QUEUE];
+static uint8_t       gSimEventCount;
+
+static void *Sim_Alloc(size_t size)
+{
+    gSim.allocs++;
+    return malloc(size);
+}
+
+static void Sim_Free(void *p)
+{
+    gSim.frees++;
+    free(p);
+}
+
+/* App_RetainHostMessage */
+static void *Sim_Retain(void)
+{
+    return ((gpSimInHandler != NULL) && (MsgRef_Retain(gpSimInHandler) == TRUE)) ? gpSimInHandler : NULL;
+}
+
+/* App_ReleaseHostMessage */
+static void Sim_Release(void *pHandle)
+{
+    if ((MsgRef_Release(pHandle) == TRUE) && (pHandle != (void *)gpSimInHandler))
+    {
+        Sim_Free(pHandle);
+    }
+}
+
+/* BleApp_L2capPsmDataCallback */
+static void Sim_L2capDataCallback(uint8_t *pPacket, uint16_t packetLength, bool_t zeroCopy)
+{
+    void *pHostMsg = (zeroCopy == TRUE) ? Sim_Retain() : NULL;
+    uint32_t copyLength = (pHostMsg != NULL) ? 0u : packetLength;
+    simEvent_t *pEvent = Sim_Alloc(sizeof(simEvent_t) + copyLength);
+
+    pEvent->packetLength = packetLength;
+    pEvent->pHostMsg = pHostMsg;
+    if (pHostMsg != NULL)
+    {
+        pEvent->pPacket = pPacket;
+    }
+    else
+    {
+        pEvent->pPacket = (uint8_t *)&pEvent[1];
+        memcpy(pEvent->pPacket, pPacket, packetLength);
+        gSim.copiedBytes += packetLength;
+    }
+
+    gaSimEvents[gSimEventCount++] = pEvent;
+}
+
+/* App_HandleHostQueueHead */
+static void Sim_HandleHostMsg(uint8_t seq, bool_t zeroCopy)
+{
+    simHostMsg_t *pMsg = Sim_Alloc(sizeof(simHostMsg_t));
+
+    pMsg->packetLength = SIM_PACKET_LEN;
+    memset(pMsg->aPacket, seq, SIM_PACKET_LEN);
+
+    gpSimInHandler = pMsg;
+    Sim_L2capDataCallback(pMsg->aPacket, pMsg->packetLength, zeroCopy);
+    gpSimInHandler = NULL;
+
+    if (MsgRef_IsHeld(pMsg) == FALSE)
+    {
+        Sim_Free(pMsg);
+    }
+}
+
+/* APP_BleEventHandler, oldest event first */
+static void Sim_HandleEvents(uint8_t firstSeq)
+{
+    uint8_t i;
+    uint16_t b;
+
+    for (i = 0u; i < gSimEventCount; i++)
+    {
+        simEvent_t *pEvent = gaSimEvents[i];
+
+        for (b = 0u; b < pEvent->packetLength; b++)
+        {
+            if (pEvent->pPacket[b] != (uint8_t)(firstSeq + i))
+            {
+                gSim.badPackets++;
+                break;
+            }
+        }
+        Sim_Release(pEvent->pHostMsg);
+        Sim_Free(pEvent);
+    }
+    gSimEventCount = 0u;
+}
+
+/* Bursts of host messages, each followed by the application events they posted */
+static void Sim_Run(uint8_t bursts, uint8_t burstLen, bool_t zeroCopy)
+{
+    uint8_t burst;
+    uint8_t i;
+    uint8_t seq = 1u;
+
+    memset(&gSim, 0, sizeof(gSim));
+    MsgRef_Init();
+
+    for (burst = 0u; burst < bursts; burst++)
+    {
+        for (i = 0u; i < burstLen; i++)
+        {
+            Sim_HandleHostMsg((uint8_t)(seq + i), zeroCopy);
+        }
+        Sim_HandleEvents(seq);
+        seq = (uint8_t)(seq + burstLen);
+    }
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_retain_release(void)
+{
+    int a;
+    int b;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Retain / release counts\n");
+
+    MsgRef_Init();
+    TEST_ASSERT(MsgRef_IsHeld(&a) == FALSE, "Not held before retain");
+    TEST_ASSERT(MsgRef_Retain(&a) == TRUE, "First retain");
+    TEST_ASSERT(MsgRef_Retain(&a) == TRUE, "Second retain, same slot");
+    TEST_ASSERT(MsgRef_Retain(&b) == TRUE, "Other message");
+    TEST_ASSERT(MsgRef_IsHeld(&a) == TRUE, "Held");
+    TEST_ASSERT(MsgRef_Release(&a) == FALSE, "Not the last reference");
+    TEST_ASSERT(MsgRef_IsHeld(&a) == TRUE, "Still held");
+    TEST_ASSERT(MsgRef_Release(&a) == TRUE, "Last reference");
+    TEST_ASSERT(MsgRef_IsHeld(&a) == FALSE, "Released");
+    TEST_ASSERT(MsgRef_Release(&a) == FALSE, "Release of an unheld message ignored");
+    TEST_ASSERT(MsgRef_IsHeld(&b) == TRUE, "Other message untouched");
+    TEST_ASSERT(MsgRef_Release(&b) == TRUE, "Other released");
+    TEST_ASSERT(MsgRef_Retain(NULL) == FALSE, "NULL refused");
+    TEST_ASSERT(MsgRef_Release(NULL) == FALSE, "NULL release ignored");
+    TEST_ASSERT(MsgRef_IsHeld(NULL) == FALSE, "NULL never held");
+
+    TEST_PASS("Retain / release counts");
+}
+
+static void test_table_full(void)
+{
+    int aMsg[MSG_REF_SLOTS + 1u];
+    msgRefStats_t stats;
+    uint8_t i;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Table full, slot reuse and counters\n");
+
+    MsgRef_Init();
+    for (i = 0u; i < MSG_REF_SLOTS; i++)
+    {
+        TEST_ASSERT(MsgRef_Retain(&aMsg[i]) == TRUE, "Slot taken");
+    }
+    TEST_ASSERT(MsgRef_Retain(&aMsg[MSG_REF_SLOTS]) == FALSE, "Refused when full");
+    TEST_ASSERT(MsgRef_IsHeld(&aMsg[MSG_REF_SLOTS]) == FALSE, "Refused message not held");
+    TEST_ASSERT(MsgRef_Retain(&aMsg[0]) == TRUE, "Held message still retainable when full");
+
+    TEST_ASSERT(MsgRef_Release(&aMsg[1]) == TRUE, "Slot freed");
+    TEST_ASSERT(MsgRef_Retain(&aMsg[MSG_REF_SLOTS]) == TRUE, "Freed slot reused");
+
+    MsgRef_GetStats(&stats);
+    TEST_ASSERT(stats.retains == (MSG_REF_SLOTS + 2u), "Retains counted");
+    TEST_ASSERT(stats.full == 1u, "Refusal counted");
+    TEST_ASSERT(stats.held == MSG_REF_SLOTS, "Held now");
+    TEST_ASSERT(stats.heldMax == MSG_REF_SLOTS, "Held max");
+
+    MsgRef_Init();
+    MsgRef_GetStats(&stats);
+    TEST_ASSERT((stats.held == 0u) && (stats.retains == 0u), "Init clears");
+    TEST_ASSERT(MsgRef_IsHeld(&aMsg[0]) == FALSE, "Init forgets references");
+
+    TEST_PASS("Table full, slot reuse and counters");
+}
+
+static void test_release_in_handler(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Release from the handler leaves the free to the drain\n");
+
+    memset(&gSim, 0, sizeof(gSim));
+    MsgRef_Init();
+
+    gpSimInHandler = Sim_Alloc(sizeof(simHostMsg_t));
+    {
+        void *pHandle = Sim_Retain();
+
+        TEST_ASSERT(pHandle == gpSimInHandler, "Handle is the message");
+        Sim_Release(pHandle);
+        TEST_ASSERT(gSim.frees == 0u, "Not freed under the handler");
+    }
+    if (MsgRef_IsHeld(gpSimInHandler) == FALSE)
+    {
+        Sim_Free(gpSimInHandler);
+    }
+    gpSimInHandler = NULL;
+
+    TEST_ASSERT(gSim.frees == 1u, "Freed once by the drain");
+    TEST_ASSERT(Sim_Retain() == NULL, "No retain outside a handler");
+
+    TEST_PASS("Release from the handler leaves the free to the drain");
+}
+
+static void test_zero_copy_drain(void)
+{
+    simCounters_t copy;
+    simCounters_t view;
+    simCounters_t burst;
+    msgRefStats_t stats;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Zero-copy drain: allocations, copies and leaks\n");
+
+    Sim_Run(50u, 1u, FALSE);
+    copy = gSim;
+    Sim_Run(50u, 1u, TRUE);
+    view = gSim;
+
+    tprintf("  copy: %u allocs, %u bytes copied; view: %u allocs, %u bytes copied\n",
+            (unsigned)copy.allocs, (unsigned)copy.copiedBytes,
+            (unsigned)view.allocs, (unsigned)view.copiedBytes);
+
+    TEST_ASSERT(copy.allocs == copy.frees, "Copy path frees everything");
+    TEST_ASSERT(view.allocs == view.frees, "View path frees everything");
+    TEST_ASSERT((copy.badPackets == 0u) && (view.badPackets == 0u), "Handlers see the right packet");
+    TEST_ASSERT(copy.copiedBytes == 50u * SIM_PACKET_LEN, "One copy per message");
+    TEST_ASSERT(view.copiedBytes == 0u, "No copy with views");
+    TEST_ASSERT(view.allocs == copy.allocs, "Same number of allocations, only smaller events");
+
+    /* Bursts longer than the table: the overflow falls back to copies */
+    Sim_Run(10u, (uint8_t)(MSG_REF_SLOTS + 3u), TRUE);
+    burst = gSim;
+    MsgRef_GetStats(&stats);
+
+    TEST_ASSERT(burst.allocs == burst.frees, "Burst path frees everything");
+    TEST_ASSERT(burst.badPackets == 0u, "Burst handlers see the right packet");
+    TEST_ASSERT(burst.copiedBytes == 10u * 3u * SIM_PACKET_LEN, "Only the overflow is copied");
+    TEST_ASSERT(stats.full == 10u * 3u, "Overflow counted");
+    TEST_ASSERT((stats.held == 0u) && (stats.heldMax == MSG_REF_SLOTS), "All released, table was full");
+
+    TEST_PASS("Zero-copy drain: allocations, copies and leaks");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "MsgRef Unit Tests (Refcounts + Table + Zero-copy drain)", &xmlPath);
+
+    RUN_TEST(test_retain_release);
+    RUN_TEST(test_table_full);
+    RUN_TEST(test_release_in_handler);
+    RUN_TEST(test_zero_copy_drain);
+
+    return Test_End(xmlPath);
+}
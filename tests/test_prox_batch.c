@@ -0,0 +1,290 @@
+/*! *********************************************************************************
+* \file test_prox_batch.c
+*
+* \brief  Unit tests for the batch replay engine in tools/prox_batch.c.
+*         Runs on host machine (macOS/Linux). Tests the real tool via #include:
+*         every kernel against the scalar ProxRssi.c sample by sample, window
+*         edge cases, threads, sorting networks and trace loading.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define _DEFAULT_SOURCE
+#define TEST_SUITE_NAME "prox_batch"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real tool
+ ******************************************************************************/
+#define PROX_BATCH_NO_MAIN
+#include "prox_batch.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+/* Every sample of every trace through pKernel equals the scalar ProxRssi.c */
+static bool_t MatchesScalar(const proxBatchFleet_t *pFleet, const proxBatchKernel_t *pKernel, uint32_t numThreads)
+{
+    ProxRssi_ParamsType params;
+    proxBatchResult_t *pRes = calloc(pFleet->numTraces, sizeof(proxBatchResult_t));
+    proxBatchResult_t *pRef = calloc(pFleet->numTraces, sizeof(proxBatchResult_t));
+    bool_t same = (pRes != NULL) && (pRef != NULL);
+
+    ProxBatch_DefaultParams(&params);
+    for (uint32_t i = 0u; same && (i < pFleet->numTraces); i++)
+    {
+        uint32_t n = (pFleet->pTraces[i].n != 0u) ? pFleet->pTraces[i].n : 1u;
+
+        pRes[i].pSteps = calloc(n, sizeof(proxBatchStep_t));
+        pRef[i].pSteps = calloc(n, sizeof(proxBatchStep_t));
+        same = (pRes[i].pSteps != NULL) && (pRef[i].pSteps != NULL);
+    }
+    same = same && (ProxBatch_Run(pFleet->pTraces, pRes, pFleet->numTraces, &params, pKernel, numThreads) == 0);
+    same = same && (ProxBatch_Run(pFleet->pTraces, pRef, pFleet->numTraces, &params, NULL, 1u) == 0);
+    same = same && (ProxBatch_Compare(pRes, pRef, pFleet->numTraces, NULL) == 0u);
+    for (uint32_t i = 0u; same && (i < pFleet->numTraces); i++)
+    {
+        for (uint32_t s = 0u; same && (s < pFleet->pTraces[i].n); s++)
+        {
+            const proxBatchStep_t *pA = &pRes[i].pSteps[s];
+            const proxBatchStep_t *pB = &pRef[i].pSteps[s];
+
+            same = (pA->ev == pB->ev) && (memcmp(&pA->feat, &pB->feat, sizeof(pA->feat)) == 0);
+            if (!same)
+            {
+                tprintf("  %s: trace %u sample %u differs\n", (pKernel != NULL) ? pKernel->pName : "scalar", i, s);
+            }
+        }
+    }
+    for (uint32_t i = 0u; (pRes != NULL) && (pRef != NULL) && (i < pFleet->numTraces); i++)
+    {
+        free(pRes[i].pSteps);
+        free(pRef[i].pSteps);
+    }
+    free(pRes);
+    free(pRef);
+    return same;
+}
+
+/* n samples from t0, step dtMs, constant RSSI */
+static proxBatchTrace_t *AddConst(proxBatchFleet_t *pFleet, uint32_t n, uint32_t t0, uint32_t dtMs, int8_t rssi)
+{
+    proxBatchTrace_t *pT = ProxBatch_AddTrace(pFleet, n);
+
+    for (uint32_t s = 0u; (pT != NULL) && (s < n); s++)
+    {
+        pT->pTMs[s]  = t0 + (s * dtMs);
+        pT->pRssi[s] = rssi;
+        pT->n++;
+    }
+    return pT;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_kernels_match_scalar(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Every kernel matches ProxRssi.c sample by sample\n");
+
+    proxBatchFleet_t fleet = { 0 };
+    uint32_t kernels = 0u;
+
+    TEST_ASSERT(ProxBatch_Synthesize(&fleet, 40u, 1500u, 7u) == 0, "Fleet synthesized");
+    for (uint32_t k = 0u; k < PROX_BATCH_NUM_KERNELS; k++)
+    {
+        if (gaProxBatchKernels[k].pfnSupported() == TRUE)
+        {
+            TEST_ASSERT(MatchesScalar(&fleet, &gaProxBatchKernels[k], 1u), gaProxBatchKernels[k].pName);
+            kernels++;
+        }
+    }
+    tprintf("  %u kernels checked\n", kernels);
+    ProxBatch_FreeFleet(&fleet);
+
+    TEST_PASS("Every kernel matches ProxRssi.c sample by sample");
+}
+
+static void test_window_edges(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Window edge cases match ProxRssi.c\n");
+
+    proxBatchFleet_t fleet = { 0 };
+    proxBatchTrace_t *pT;
+
+    (void)ProxBatch_AddTrace(&fleet, 0u);                        /* empty */
+    (void)AddConst(&fleet, 1u, 1000u, 100u, -50);                /* one sample */
+    (void)AddConst(&fleet, 300u, 1000u, 100u, 127);              /* never valid */
+    (void)AddConst(&fleet, 600u, 1000u, 10u, -45);               /* overfills the raw ring */
+    (void)AddConst(&fleet, 400u, 0xFFFFFFFFu - 20000u, 100u, -48);   /* 32-bit wrap */
+    (void)AddConst(&fleet, 200u, 5000u, 0u, -52);                /* dt = 0 */
+    pT = AddConst(&fleet, 400u, 1000u, 100u, -46);               /* gaps and steps back */
+    for (uint32_t s = 100u; (pT != NULL) && (s < pT->n); s++)
+    {
+        pT->pTMs[s] += (s < 200u) ? 9000u : ((s < 300u) ? 0u : 30000u);
+        pT->pRssi[s] = (int8_t)(((s % 17u) == 0u) ? -128 : ((s % 5u) == 0u) ? -80 : -46);
+    }
+    /* Unequal lengths, so the last group is partial and lanes finish early */
+    for (uint32_t i = 0u; i < 10u; i++)
+    {
+        (void)AddConst(&fleet, 50u + (i * 37u), 1000u + i, 100u + i, (int8_t)(-40 - (int8_t)i));
+    }
+    TEST_ASSERT(fleet.numTraces == 17u, "17 traces");
+
+    for (uint32_t k = 0u; k < PROX_BATCH_NUM_KERNELS; k++)
+    {
+        if (gaProxBatchKernels[k].pfnSupported() == TRUE)
+        {
+            TEST_ASSERT(MatchesScalar(&fleet, &gaProxBatchKernels[k], 1u), gaProxBatchKernels[k].pName);
+        }
+    }
+    ProxBatch_FreeFleet(&fleet);
+
+    TEST_PASS("Window edge cases match ProxRssi.c");
+}
+
+static void test_threads_match_serial(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Threads give the same results as one worker\n");
+
+    proxBatchFleet_t fleet = { 0 };
+    ProxRssi_ParamsType params;
+    proxBatchResult_t aSerial[70];
+    proxBatchResult_t aThreads[70];
+    uint64_t unlocks = 0u;
+
+    memset(aSerial, 0, sizeof(aSerial));
+    memset(aThreads, 0, sizeof(aThreads));
+    ProxBatch_DefaultParams(&params);
+    TEST_ASSERT(ProxBatch_Synthesize(&fleet, 70u, 800u, 3u) == 0, "Fleet synthesized");
+    TEST_ASSERT(ProxBatch_Run(fleet.pTraces, aSerial, fleet.numTraces, &params, ProxBatch_Kernel(NULL), 1u) == 0,
+                "Serial run");
+    TEST_ASSERT(ProxBatch_Run(fleet.pTraces, aThreads, fleet.numTraces, &params, ProxBatch_Kernel(NULL), 4u) == 0,
+                "Threaded run");
+    TEST_ASSERT(ProxBatch_Compare(aSerial, aThreads, fleet.numTraces, NULL) == 0u, "Same results");
+    for (uint32_t i = 0u; i < fleet.numTraces; i++)
+    {
+        unlocks += aSerial[i].unlocks;
+    }
+    TEST_ASSERT(unlocks > 0u, "The fleet unlocks");
+    ProxBatch_FreeFleet(&fleet);
+
+    TEST_PASS("Threads give the same results as one worker");
+}
+
+static void test_kernel_lookup(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Kernels are found by name\n");
+
+    const proxBatchKernel_t *pBest = ProxBatch_Kernel(NULL);
+
+    TEST_ASSERT(pBest != NULL, "A default kernel");
+    TEST_ASSERT(pBest->pfnSupported() == TRUE, "Default is supported");
+    TEST_ASSERT((ProxBatch_Kernel("c") != NULL) && (strcmp(ProxBatch_Kernel("c")->pName, "c") == 0),
+                "Portable kernel always there");
+    TEST_ASSERT(ProxBatch_Kernel("neon64") == NULL, "Unknown name");
+
+    TEST_PASS("Kernels are found by name");
+}
+
+static void test_sorting_networks(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Sorting networks sort every window depth\n");
+
+    uint32_t len;
+    uint64_t rng = 11u;
+
+    ProxBatch_BuildNetworks();
+    (void)ProxBatch_Network(PROX_RSSI_RAW_CAP, &len);
+    TEST_ASSERT(len == PROX_BATCH_NET_MAX_CE, "543 comparators for 64 inputs");
+    (void)ProxBatch_Network(3u, &len);
+    TEST_ASSERT(len == 5u, "5 comparators for 4 inputs");
+
+    for (uint32_t depth = 1u; depth <= PROX_RSSI_RAW_CAP; depth++)
+    {
+        const proxBatchCe_t *pNet = ProxBatch_Network(depth, &len);
+        int16_t aV[PROX_RSSI_RAW_CAP];
+        bool_t sorted = TRUE;
+
+        for (uint32_t i = 0u; i < depth; i++)
+        {
+            aV[i] = (int16_t)((int32_t)(ProxBatch_SplitMix(&rng) % 4001u) - 2000);
+        }
+        for (uint32_t c = 0u; c < len; c++)
+        {
+            if ((pNet[c].b < depth) && (aV[pNet[c].a] > aV[pNet[c].b]))
+            {
+                int16_t x = aV[pNet[c].a];
+
+                aV[pNet[c].a] = aV[pNet[c].b];
+                aV[pNet[c].b] = x;
+            }
+        }
+        for (uint32_t i = 1u; i < depth; i++)
+        {
+            sorted = (aV[i - 1u] <= aV[i]) ? sorted : FALSE;
+        }
+        TEST_ASSERT(sorted == TRUE, "Sorted");
+    }
+
+    TEST_PASS("Sorting networks sort every window depth");
+}
+
+static void test_trace_loading(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Trace CSVs load directly and from a list\n");
+
+    const char *pCsv = "test_prox_batch_trace.csv";
+    const char *pList = "test_prox_batch_list.txt";
+    proxBatchFleet_t fleet = { 0 };
+    FILE *pFile = fopen(pCsv, "w");
+
+    TEST_ASSERT(pFile != NULL, "CSV written");
+    fprintf(pFile, "tMs,rssi\n100,-50\n200,-51\n# comment\n300,127\n");
+    fclose(pFile);
+    pFile = fopen(pList, "w");
+    TEST_ASSERT(pFile != NULL, "List written");
+    fprintf(pFile, "# fleet\n%s\n%s\n", pCsv, pCsv);
+    fclose(pFile);
+
+    TEST_ASSERT(ProxBatch_LoadCsv(&fleet, pCsv) == 0, "CSV loaded");
+    TEST_ASSERT(ProxBatch_LoadList(&fleet, pList) == 0, "List loaded");
+    TEST_ASSERT(fleet.numTraces == 3u, "One trace per file");
+    TEST_ASSERT(fleet.pTraces[2].n == 3u, "Header and comment skipped");
+    TEST_ASSERT((fleet.pTraces[2].pTMs[1] == 200u) && (fleet.pTraces[2].pRssi[2] == 127), "Rows kept");
+    TEST_ASSERT(ProxBatch_LoadCsv(&fleet, "no_such_trace.csv") != 0, "Missing file fails");
+
+    ProxBatch_FreeFleet(&fleet);
+    (void)remove(pCsv);
+    (void)remove(pList);
+
+    TEST_PASS("Trace CSVs load directly and from a list");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "ProxBatch Unit Tests (Kernels + Windows + Threads)", &xmlPath);
+
+    RUN_TEST(test_kernels_match_scalar);
+    RUN_TEST(test_window_edges);
+    RUN_TEST(test_threads_match_serial);
+    RUN_TEST(test_kernel_lookup);
+    RUN_TEST(test_sorting_networks);
+    RUN_TEST(test_trace_loading);
+
+    return Test_End(xmlPath);
+}
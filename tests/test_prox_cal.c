@@ -0,0 +1,297 @@
+/*! *********************************************************************************
+* \file test_prox_cal.c
+*
+* \brief  Unit tests for ProxCal — per-device online proximity calibration.
+*         Runs on host machine (macOS/Linux). Tests the real prox_cal.c and
+*         ProxRssi.c via #include: handshake histograms, offset learning,
+*         outdated records and threshold shifting, and unlock sessions of a
+*         hot phone before and after calibration.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "prox_cal"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "ProxRssi.c"
+#include "prox_cal.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+static ProxRssi_CtxType gCtx;
+static uint16_t gaLut[1001];
+static uint32_t gLcg;
+
+/* Same parameters and LUT as rssi_integration.c (prox_rssi_params.h), ms clock */
+static void Params(ProxRssi_ParamsType *pParams)
+{
+    memset(pParams, 0, sizeof(*pParams));
+    pParams->wRawMs = 2000u;  pParams->wSpikeMs = 800u;  pParams->wFeatMs = 2000u;
+    pParams->hampelKQ4 = 40u; pParams->madEpsQ4 = 8u;
+    pParams->enterNearQ4 = ProxRssi_DbmToQ4(-50);
+    pParams->exitNearQ4  = ProxRssi_DbmToQ4(-60);
+    pParams->hystQ4      = (uint16_t)ProxRssi_DbToQ4(10);
+    pParams->pctThQ15 = 13107u; pParams->stdThQ4 = 128u; pParams->stableMs = 2000u; pParams->minFeatSamples = 6u;
+    pParams->exitConfirmMs = 1500u; pParams->lockoutMs = 5000u; pParams->maxReasonableDtMs = 2000u;
+
+    for (uint32_t i = 0u; i < 1001u; i++)
+    {
+        gaLut[i] = (uint16_t)(1638u + ((i * 8192u) / 1000u));
+    }
+}
+
+static int8_t Noise(int32_t mean, uint32_t spread)
+{
+    gLcg = (gLcg * 1103515245u) + 12345u;
+    return (int8_t)(mean + (int32_t)((gLcg >> 16) % (2u * spread + 1u)) - (int32_t)spread);
+}
+
+/* One connection at 10 Hz; the phone reads biasDb hotter than the reference.
+ * walkUp: -80 .. -40 dBm over 8 s then 5 s at the door, else 13 s at a steady
+ * -54 dBm (parked next to the car). Unlock windows go to pHist when given. */
+static uint32_t Session(const proxCalRecord_t *pRec, int32_t biasDb, bool_t walkUp, proxCalHist_t *pHist)
+{
+    ProxRssi_ParamsType base;
+    ProxRssi_ParamsType params;
+    ProxRssi_FeaturesType feat;
+    uint32_t unlocks = 0u;
+    uint32_t t = 1000u;
+
+    Params(&base);
+    ProxCal_Apply(pRec, &base, &params);
+    (void)ProxRssi_Init(&gCtx, &params, gaLut, 1001u);
+
+    for (uint32_t i = 0u; i < 130u; i++)
+    {
+        ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+        int32_t mean = (walkUp == TRUE) ? ((i < 80u) ? (-80 + (int32_t)(i / 2u)) : -40) : -54;
+
+        t += 100u;
+        (void)ProxRssi_PushRaw(&gCtx, t, Noise(mean + biasDb, 3u));
+        (void)ProxRssi_MainFunction(&gCtx, t, &ev, &feat);
+        if (ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED)
+        {
+            unlocks++;
+            if (pHist != NULL)
+            {
+                ProxCal_HistAddWindow(pHist, &gCtx);
+            }
+        }
+    }
+    return unlocks;
+}
+
+/* Learn nSessions walk-ups of a phone biasDb hot */
+static void Train(proxCalRecord_t *pRec, int32_t biasDb, uint32_t nSessions)
+{
+    proxCalHist_t hist;
+
+    for (uint32_t s = 0u; s < nSessions; s++)
+    {
+        ProxCal_HistReset(&hist);
+        (void)Session(pRec, biasDb, TRUE, &hist);
+        (void)ProxCal_Learn(pRec, &hist);
+    }
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_hist_median(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Histogram bins whole dB and returns the median bin centre\n");
+
+    proxCalHist_t hist;
+    int16_t medQ4 = 0;
+    uint32_t i;
+
+    ProxCal_HistReset(&hist);
+    for (i = 0u; i < 5u; i++)
+    {
+        ProxCal_HistAddQ4(&hist, ProxRssi_DbmToQ4(-45));
+    }
+    TEST_ASSERT(ProxCal_HistMedianQ4(&hist, &medQ4) == FALSE, "Too few samples for a session");
+
+    /* -46.5 dB floors to -47, -45.9 dB to -46 */
+    ProxCal_HistAddQ4(&hist, (int16_t)(-46 * 16 - 8));
+    ProxCal_HistAddQ4(&hist, (int16_t)(-46 * 16 + 1));
+    ProxCal_HistAddQ4(&hist, ProxRssi_DbmToQ4(-120));
+    ProxCal_HistAddQ4(&hist, ProxRssi_DbmToQ4(-5));
+    TEST_ASSERT(hist.n == 9u, "All samples counted");
+    TEST_ASSERT(hist.bins[-47 - PROX_CAL_HIST_MIN_DBM] == 1u && hist.bins[-46 - PROX_CAL_HIST_MIN_DBM] == 1u,
+                "Floor to whole dB");
+    TEST_ASSERT(hist.bins[0] == 1u && hist.bins[PROX_CAL_HIST_BINS - 1u] == 1u, "Outliers in the end bins");
+    TEST_ASSERT(ProxCal_HistMedianQ4(&hist, &medQ4) == TRUE, "Median available");
+    TEST_ASSERT(medQ4 == (int16_t)(-45 * 16 + 8), "Median is the centre of the -45 dB bin");
+
+    TEST_PASS("Histogram bins whole dB and returns the median bin centre");
+}
+
+static void test_learn_weights(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Offset moves half way first, then averages and clamps\n");
+
+    proxCalRecord_t rec;
+    proxCalHist_t hist;
+    uint32_t i;
+
+    /* Sessions 8 dB hot of the reference median */
+    ProxCal_HistReset(&hist);
+    for (i = 0u; i < 10u; i++)
+    {
+        ProxCal_HistAddQ4(&hist, (int16_t)(((PROX_CAL_REF_DBM + 8) * 16) - 8));
+    }
+
+    ProxCal_RecordInit(&rec);
+    TEST_ASSERT(ProxCal_OffsetQ4(&rec) == 0, "No sessions, no offset");
+    TEST_ASSERT(ProxCal_Learn(&rec, &hist) == TRUE, "First session changes the record");
+    TEST_ASSERT(rec.sessions == 1u && rec.offsetQ4 == 60, "Half of 7.5 dB after one session");
+    for (i = 0u; i < 40u; i++)
+    {
+        (void)ProxCal_Learn(&rec, &hist);
+    }
+    TEST_ASSERT(rec.offsetQ4 >= 112 && rec.offsetQ4 <= 120, "Converges to 7.5 dB");
+
+    /* A single session 30 dB off moves it by 1/8 of the clamped difference */
+    ProxCal_HistReset(&hist);
+    for (i = 0u; i < 10u; i++)
+    {
+        ProxCal_HistAddQ4(&hist, ProxRssi_DbmToQ4((int8_t)(PROX_CAL_REF_DBM + 30)));
+    }
+    {
+        int16_t before = rec.offsetQ4;
+        (void)ProxCal_Learn(&rec, &hist);
+        TEST_ASSERT(rec.offsetQ4 - before <= ((PROX_CAL_MAX_OFFSET_DB * 16) - before) / 8 + 1, "Outlier session weighs 1/8");
+    }
+    for (i = 0u; i < 100u; i++)
+    {
+        (void)ProxCal_Learn(&rec, &hist);
+    }
+    TEST_ASSERT((rec.offsetQ4 <= PROX_CAL_MAX_OFFSET_DB * 16) && (rec.offsetQ4 > (PROX_CAL_MAX_OFFSET_DB * 16) - 8),
+                "Clamped to PROX_CAL_MAX_OFFSET_DB");
+    TEST_ASSERT(rec.sessions == 142u, "Sessions counted");
+
+    ProxCal_HistReset(&hist);
+    TEST_ASSERT(ProxCal_Learn(&rec, &hist) == FALSE && rec.sessions == 142u, "Session without unlock ignored");
+
+    TEST_PASS("Offset moves half way first, then averages and clamps");
+}
+
+static void test_outdated_record(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Empty, outdated and corrupted records apply no or bounded offset\n");
+
+    proxCalRecord_t rec;
+    proxCalHist_t hist;
+
+    memset(&rec, 0, sizeof(rec));
+    TEST_ASSERT(ProxCal_OffsetQ4(&rec) == 0, "Erased NVM entry");
+    TEST_ASSERT(ProxCal_OffsetQ4(NULL) == 0, "No record");
+
+    rec.version = (uint8_t)(PROX_CAL_VERSION + 1u); rec.sessions = 9u; rec.offsetQ4 = 100;
+    TEST_ASSERT(ProxCal_OffsetQ4(&rec) == 0, "Other version ignored");
+
+    ProxCal_HistReset(&hist);
+    for (uint32_t i = 0u; i < 10u; i++)
+    {
+        ProxCal_HistAddQ4(&hist, (int16_t)((PROX_CAL_REF_DBM * 16) + 8));
+    }
+    (void)ProxCal_Learn(&rec, &hist);
+    TEST_ASSERT(rec.version == PROX_CAL_VERSION && rec.sessions == 1u && rec.offsetQ4 == 4,
+                "Other version relearned from the reference");
+
+    rec.offsetQ4 = 3000;
+    TEST_ASSERT(ProxCal_OffsetQ4(&rec) == PROX_CAL_MAX_OFFSET_DB * 16, "Corrupted offset clamped");
+
+    TEST_PASS("Empty, outdated and corrupted records apply no or bounded offset");
+}
+
+static void test_apply_thresholds(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Apply shifts enter and exit thresholds only\n");
+
+    ProxRssi_ParamsType base;
+    ProxRssi_ParamsType out;
+    proxCalRecord_t rec;
+
+    Params(&base);
+    ProxCal_RecordInit(&rec);
+    rec.sessions = 3u;
+    rec.offsetQ4 = -72;
+
+    ProxCal_Apply(&rec, &base, &out);
+    TEST_ASSERT(out.enterNearQ4 == base.enterNearQ4 - 72 && out.exitNearQ4 == base.exitNearQ4 - 72, "Both shifted");
+    TEST_ASSERT(out.stableMs == base.stableMs && out.hystQ4 == base.hystQ4 && out.pctThQ15 == base.pctThQ15,
+                "Other parameters kept");
+
+    base.exitNearQ4 = 0;
+    ProxCal_Apply(&rec, &base, &out);
+    TEST_ASSERT(out.exitNearQ4 == 0, "Derived exit stays derived");
+    TEST_ASSERT(ProxRssi_Init(&gCtx, &out, gaLut, 1001u) == E_OK, "Calibrated set accepted");
+    TEST_ASSERT(gCtx.p.exitNearQ4 == (int16_t)(out.enterNearQ4 - (int16_t)out.hystQ4), "Exit derived from shifted enter");
+
+    ProxCal_Apply(NULL, &base, &out);
+    TEST_ASSERT(out.enterNearQ4 == base.enterNearQ4, "No record, reference thresholds");
+
+    TEST_PASS("Apply shifts enter and exit thresholds only");
+}
+
+static void test_hot_phone_sessions(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Hot phone learns its offset and stops unlocking from afar\n");
+
+    proxCalRecord_t refRec;
+    proxCalRecord_t hotRec;
+    uint32_t unlocks;
+
+    gLcg = 12345u;
+    ProxCal_RecordInit(&refRec);
+    ProxCal_RecordInit(&hotRec);
+
+    /* Parked 4 dB below the threshold: the reference phone stays locked */
+    TEST_ASSERT(Session(&refRec, 0, FALSE, NULL) == 0u, "Reference phone does not unlock when parked");
+    TEST_ASSERT(Session(&hotRec, 10, FALSE, NULL) == 1u, "Uncalibrated hot phone unlocks when parked");
+
+    Train(&refRec, 0, 12u);
+    Train(&hotRec, 10, 12u);
+    tprintf("  reference offset %d/16 dB, hot phone %d/16 dB\n", refRec.offsetQ4, hotRec.offsetQ4);
+    TEST_ASSERT((refRec.offsetQ4 >= -48) && (refRec.offsetQ4 <= 48), "Reference phone stays within 3 dB");
+    TEST_ASSERT((hotRec.offsetQ4 - refRec.offsetQ4) >= 96, "Hot phone learns 6 dB or more on top");
+
+    unlocks = Session(&hotRec, 10, FALSE, NULL);
+    TEST_ASSERT(unlocks == 0u, "Calibrated hot phone does not unlock when parked");
+    TEST_ASSERT(Session(&hotRec, 10, TRUE, NULL) == 1u, "Calibrated hot phone still unlocks at the door");
+    TEST_ASSERT(Session(&refRec, 0, TRUE, NULL) == 1u, "Reference phone still unlocks at the door");
+
+    TEST_PASS("Hot phone learns its offset and stops unlocking from afar");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "ProxCal Unit Tests (Per-device Proximity Calibration)", &xmlPath);
+
+    RUN_TEST(test_hist_median);
+    RUN_TEST(test_learn_weights);
+    RUN_TEST(test_outdated_record);
+    RUN_TEST(test_apply_thresholds);
+    RUN_TEST(test_hot_phone_sessions);
+
+    return Test_End(xmlPath);
+}
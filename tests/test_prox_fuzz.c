@@ -0,0 +1,325 @@
+/*! *********************************************************************************
+* \file test_prox_fuzz.c
+*
+* \brief  Unit tests for the worst-case execution path fuzzer in
+*         tools/prox_fuzz.c.
+*         Runs on host machine (macOS/Linux). Tests the real tool via #include:
+*         input decoding, loop trip counts against a hand counted reverse
+*         ordered window, the analytic ops bound, the fuzzer loop, fixtures
+*         and the libFuzzer entry. Built without the coverage hook, so the
+*         fuzzer runs on ops.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define _DEFAULT_SOURCE
+#define TEST_SUITE_NAME "prox_fuzz"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real tool
+ ******************************************************************************/
+#define PROX_FUZZ_NO_MAIN
+#include "prox_fuzz.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+static uint32_t Inversions(const int16_t *a, uint16_t n)
+{
+    uint32_t inv = 0u;
+
+    for (uint16_t i = 0u; i < n; i++)
+    {
+        for (uint16_t j = (uint16_t)(i + 1u); j < n; j++)
+        {
+            inv += (a[i] > a[j]) ? 1u : 0u;
+        }
+    }
+    return inv;
+}
+
+/* 64 samples 10 ms apart falling from -1 to -64 dBm, spike window = raw window */
+static void ReverseWindowCase(proxFuzzCase_t *pCase)
+{
+    ProxFuzz_DefaultParams(&pCase->params);
+    pCase->params.wSpikeMs = pCase->params.wRawMs;
+    pCase->n = 0u;
+    for (uint32_t i = 0u; i < PROX_RSSI_RAW_CAP; i++)
+    {
+        pCase->tMs[i]  = 1000u + (i * 10u);
+        pCase->rssi[i] = (int8_t)(-1 - (int32_t)i);
+        pCase->n++;
+    }
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_decode_layout(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Input bytes decode to parameters and (tMs, rssi) calls\n");
+
+    static proxFuzzCase_t c;
+    ProxRssi_ParamsType def;
+    uint8_t in[PROX_FUZZ_HDR_LEN + (3u * PROX_FUZZ_REC_LEN) + 2u] = { 0 };
+    uint8_t *pRec = &in[PROX_FUZZ_HDR_LEN];
+
+    in[0]  = 0xB8u;                     /* wRawMs 3000 */
+    in[1]  = 0x0Bu;
+    in[8]  = (uint8_t)(int8_t)-50;      /* enter -50 dBm */
+    in[9]  = 6u;                        /* hyst 6 dB */
+    in[15] = 9u;                        /* minFeatSamples */
+    in[22] = 0xF0u;                     /* t0 = 0xFFFFFFF0 */
+    in[23] = 0xFFu;
+    in[24] = 0xFFu;
+    in[25] = 0xFFu;
+    ProxFuzz_PutDt(&pRec[0], 10);
+    pRec[2] = (uint8_t)(int8_t)-60;
+    ProxFuzz_PutDt(&pRec[3], -5);
+    pRec[5] = (uint8_t)(int8_t)-61;
+    ProxFuzz_PutDt(&pRec[6], 20);
+    pRec[8] = 5u;
+
+    ProxFuzz_Decode(in, sizeof(in), FALSE, PROX_FUZZ_MAX_SAMPLES, &c);
+    TEST_ASSERT(c.params.wRawMs == 3000u, "wRawMs little endian");
+    TEST_ASSERT(c.params.enterNearQ4 == -800, "enter in dBm, Q4");
+    TEST_ASSERT(c.params.hystQ4 == 96u, "hyst in dB, Q4");
+    TEST_ASSERT(c.params.minFeatSamples == 9u, "minFeatSamples");
+    TEST_ASSERT((c.params.wSpikeMs == 0u) && (c.params.exitNearQ4 == 0), "Zeros left for Init to default");
+    TEST_ASSERT(c.n == 3u, "Partial trailing record ignored");
+    TEST_ASSERT((c.tMs[0] == 0xFFFFFFFAu) && (c.tMs[1] == 0xFFFFFFF5u) && (c.tMs[2] == 9u),
+                "Signed dt, steps back and the 32-bit wrap");
+    TEST_ASSERT((c.rssi[0] == -60) && (c.rssi[2] == 5), "RSSI bytes as is, invalid values included");
+
+    ProxFuzz_Decode(in, sizeof(in), TRUE, 2u, &c);
+    ProxFuzz_DefaultParams(&def);
+    TEST_ASSERT(memcmp(&c.params, &def, sizeof(def)) == 0, "-d keeps the default parameter set");
+    TEST_ASSERT(c.n == 2u, "Sample limit");
+
+    ProxFuzz_Decode(in, 5u, FALSE, PROX_FUZZ_MAX_SAMPLES, &c);
+    TEST_ASSERT((c.n == 0u) && (c.params.wSpikeMs == 0u) && (c.params.wRawMs == 3000u),
+                "Short header reads as zeros");
+
+    TEST_PASS("Decoding");
+}
+
+static void test_work_reverse_window(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Trip counts of a reverse ordered window, counted by hand\n");
+
+    static proxFuzzCase_t c;
+    proxFuzzResult_t res;
+    proxFuzzWork_t w;
+    uint64_t rng = 7u;
+    int16_t a[PROX_RSSI_RAW_CAP];
+    int16_t b[PROX_RSSI_RAW_CAP];
+    uint32_t shiftsOk = 0u;
+
+    /* Sort shifts are the inversions of the input */
+    for (uint32_t r = 0u; r < 100u; r++)
+    {
+        const uint16_t n = (uint16_t)(ProxFuzz_SplitMix(&rng) % (PROX_RSSI_RAW_CAP + 1u));
+
+        for (uint16_t i = 0u; i < n; i++)
+        {
+            a[i] = (int16_t)((int32_t)(ProxFuzz_SplitMix(&rng) % 64u) * -16);
+            b[i] = a[i];
+        }
+        shiftsOk += (ProxFuzz_SortShifts(a, n) == Inversions(b, n)) ? 1u : 0u;
+    }
+    TEST_ASSERT(shiftsOk == 100u, "Shifts == inversions");
+
+    ReverseWindowCase(&c);
+    ProxFuzz_Run(&c, PROX_FUZZ_OPS, &res);
+    TEST_ASSERT(res.worstIdx == 63u, "Last call is the most expensive");
+    TEST_ASSERT((res.work.rawIter == 64u) && (res.work.spikeN == 64u), "Full Hampel window");
+    TEST_ASSERT(res.work.shiftsA == 2016u, "Reverse order: 64 * 63 / 2 shifts");
+    /* |x - median| of -64..-1 dB, sorted: 32 dB down to 0 and back to 31 dB */
+    TEST_ASSERT(res.work.shiftsB == 1024u, "496 + 32 + 496 shifts of the MAD sort");
+    TEST_ASSERT((res.work.smoothIter == 62u) && (res.work.featN == 62u), "Smooth window from call 2 on");
+    TEST_ASSERT(res.ops == (64u + (3u * 64u) + 2016u + 1024u + 62u + 62u), "ops sum");
+
+    /* Same call on its own */
+    TEST_ASSERT(ProxFuzz_WorkAt(&c, 63u, &w) == res.ops, "WorkAt agrees");
+
+    /* Steady input: no shifts */
+    for (uint32_t i = 0u; i < c.n; i++)
+    {
+        c.rssi[i] = -55;
+    }
+    ProxFuzz_Run(&c, PROX_FUZZ_OPS, &res);
+    TEST_ASSERT((res.work.shiftsA == 0u) && (res.work.shiftsB == 0u), "Constant window sorts for free");
+
+    /* Gap over the windows: everything pruned */
+    c.n = 65u;
+    c.tMs[64] = c.tMs[63] + 60000u;
+    c.rssi[64] = -55;
+    TEST_ASSERT(ProxFuzz_WorkAt(&c, 64u, &w) > 0u, "Gap call");
+    TEST_ASSERT((w.rawDrop == 63u) && (w.rawIter == 1u) && (w.spikeN == 0u), "Gap drops the raw window");
+
+    TEST_PASS("Trip counts");
+}
+
+static void test_ops_bound(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Analytic ops bound holds on random inputs\n");
+
+    static proxFuzzCase_t c;
+    static uint8_t in[PROX_FUZZ_MAX_LEN];
+    proxFuzzResult_t res;
+    uint64_t rng = 11u;
+    uint32_t within = 0u;
+    uint32_t maxOps = 0u;
+
+    TEST_ASSERT(ProxFuzz_OpsBound() == 4545u, "64 + 192 + 4032 + 129 + 128 for 64/128");
+    for (uint32_t r = 0u; r < 60u; r++)
+    {
+        const uint32_t len = (uint32_t)(ProxFuzz_SplitMix(&rng) % (PROX_FUZZ_HDR_LEN + (200u * PROX_FUZZ_REC_LEN)));
+
+        for (uint32_t i = 0u; i < len; i++)
+        {
+            in[i] = (uint8_t)ProxFuzz_SplitMix(&rng);
+        }
+        /* Dense enough to fill the windows */
+        for (uint32_t off = PROX_FUZZ_HDR_LEN; (off + PROX_FUZZ_REC_LEN) <= len; off += PROX_FUZZ_REC_LEN)
+        {
+            in[off + 1u] = ((r % 2u) == 0u) ? 0u : in[off + 1u];
+            in[off + 2u] |= 0x80u;
+        }
+        ProxFuzz_Decode(in, len, FALSE, PROX_FUZZ_MAX_SAMPLES, &c);
+        ProxFuzz_Run(&c, PROX_FUZZ_OPS, &res);
+        within += (res.ops <= ProxFuzz_OpsBound()) ? 1u : 0u;
+        maxOps = (res.ops > maxOps) ? res.ops : maxOps;
+    }
+    TEST_ASSERT(within == 60u, "Every call within the bound");
+    TEST_ASSERT(maxOps > 0u, "Inputs do work");
+
+    TEST_PASS("Ops bound");
+}
+
+static void test_fuzzer_climbs(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Fuzzer makes the worst call worse, deterministically\n");
+
+    proxFuzzEngine_t *pA = ProxFuzz_Create(PROX_FUZZ_OPS, 128u, FALSE, 5u);
+    proxFuzzEngine_t *pB = ProxFuzz_Create(PROX_FUZZ_OPS, 128u, FALSE, 5u);
+    uint64_t seeded;
+
+    TEST_ASSERT((pA != NULL) && (pB != NULL), "Engines");
+    TEST_ASSERT(pA->count == 3u, "Three seeds");
+    seeded = pA->worst.worst;
+    TEST_ASSERT(ProxFuzz_Fuzz(pA, 400u, FALSE) == 0, "Fuzz A");
+    TEST_ASSERT(ProxFuzz_Fuzz(pB, 400u, FALSE) == 0, "Fuzz B");
+    TEST_ASSERT(pA->execs == 403u, "Seeds + mutations executed");
+    TEST_ASSERT(pA->worst.worst > seeded, "Worst call got worse");
+    TEST_ASSERT(pA->worst.ops <= ProxFuzz_OpsBound(), "Within the bound");
+    TEST_ASSERT((pA->worst.worst == pB->worst.worst) && (pA->count == pB->count), "Same seed, same search");
+    TEST_ASSERT(pA->aCorpus[pA->best].cost == pA->worst.worst, "Best entry is the worst input");
+
+    ProxFuzz_Destroy(pA);
+    ProxFuzz_Destroy(pB);
+
+    TEST_PASS("Fuzzer");
+}
+
+static void test_fixture_roundtrip(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Fixture CSV keeps parameters and ends at the worst call\n");
+
+    const char *pPath = "test_prox_fuzz_fixture.csv";
+    static proxFuzzCase_t c;
+    static proxFuzzCase_t back;
+    proxFuzzResult_t res;
+    proxFuzzResult_t again;
+    FILE *pFile;
+
+    ReverseWindowCase(&c);
+    c.params.hampelKQ4 = 77u;
+    c.params.enterNearQ4 = -1234;
+    c.params.lockoutMs = 123456u;
+    c.tMs[64] = c.tMs[63] + 10u;        /* Cheaper call after the worst */
+    c.rssi[64] = -50;
+    c.n = 65u;
+    ProxFuzz_Run(&c, PROX_FUZZ_OPS, &res);
+    TEST_ASSERT(ProxFuzz_SaveFixture(pPath, &c, &res) == 0, "Written");
+    TEST_ASSERT(ProxFuzz_LoadFixture(pPath, &back) == 0, "Read back");
+    TEST_ASSERT(memcmp(&back.params, &c.params, sizeof(c.params)) == 0, "Parameter set");
+    TEST_ASSERT(back.n == (res.worstIdx + 1u), "Ends with the worst call");
+    TEST_ASSERT(memcmp(back.tMs, c.tMs, back.n * sizeof(uint32_t)) == 0, "Times");
+    ProxFuzz_Run(&back, PROX_FUZZ_OPS, &again);
+    TEST_ASSERT((again.ops == res.ops) && (again.worstIdx == res.worstIdx), "Replay costs the same");
+
+    /* A plain trace replays with the defaults */
+    pFile = fopen(pPath, "w");
+    TEST_ASSERT(pFile != NULL, "Plain trace written");
+    fprintf(pFile, "t_ms,rssi\n100,-60\n200,-61\n");
+    fclose(pFile);
+    TEST_ASSERT(ProxFuzz_LoadFixture(pPath, &back) == 0, "Plain trace read");
+    TEST_ASSERT((back.n == 2u) && (back.params.wRawMs == PROX_PARAM_W_RAW_MS), "Defaults without a params line");
+    (void)remove(pPath);
+    TEST_ASSERT(ProxFuzz_LoadFixture(pPath, &back) != 0, "Missing file reported");
+
+    TEST_PASS("Fixtures");
+}
+
+static void test_libfuzzer_entry(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] LLVMFuzzerTestOneInput takes any input\n");
+
+    const char *pPath = "test_prox_fuzz_lf.csv";
+    static uint8_t in[PROX_FUZZ_MAX_LEN + 64u];
+    static const uint32_t aLens[] = { 0u, 1u, 25u, 26u, 28u, 29u, 300u, PROX_FUZZ_MAX_LEN + 64u };
+    uint64_t rng = 3u;
+    uint32_t ok = 0u;
+    FILE *pFile;
+
+    (void)remove(pPath);
+    TEST_ASSERT(setenv("PROX_FUZZ_OUT", pPath, 1) == 0, "Output set");
+    for (uint32_t i = 0u; i < sizeof(in); i++)
+    {
+        in[i] = (uint8_t)ProxFuzz_SplitMix(&rng);
+    }
+    for (uint32_t i = 0u; i < (sizeof(aLens) / sizeof(aLens[0])); i++)
+    {
+        ok += (LLVMFuzzerTestOneInput(in, aLens[i]) == 0) ? 1u : 0u;
+    }
+    TEST_ASSERT(ok == (sizeof(aLens) / sizeof(aLens[0])), "Returns 0 for every length");
+    (void)unsetenv("PROX_FUZZ_OUT");
+
+    pFile = fopen(pPath, "r");
+    TEST_ASSERT(pFile != NULL, "Worst input written");
+    fclose(pFile);
+    (void)remove(pPath);
+
+    TEST_PASS("libFuzzer entry");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "ProxFuzz Unit Tests (Worst-Case Execution Path Fuzzer)", &xmlPath);
+
+    RUN_TEST(test_decode_layout);
+    RUN_TEST(test_work_reverse_window);
+    RUN_TEST(test_ops_bound);
+    RUN_TEST(test_fuzzer_climbs);
+    RUN_TEST(test_fixture_roundtrip);
+    RUN_TEST(test_libfuzzer_entry);
+
+    return Test_End(xmlPath);
+}
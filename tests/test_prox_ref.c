@@ -0,0 +1,323 @@
+/*! *********************************************************************************
+* \file test_prox_ref.c
+*
+* \brief  Unit tests for the double precision reference model and the
+*         differential harness in tools/prox_ref.c.
+*         Runs on host machine (macOS/Linux). Tests the real tool via #include:
+*         firmware emulation, exact behaviour, Q4 EMA bias, alpha variants,
+*         event matching and statistics.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define _DEFAULT_SOURCE
+#define TEST_SUITE_NAME "prox_ref"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real tool
+ ******************************************************************************/
+#define PROX_REF_NO_MAIN
+#include "prox_ref.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+/* rssiA for the first firstMs, then rssiB, at 10 Hz */
+static proxRefTrace_t *AddStepTrace(proxRefSet_t *pSet, int8_t rssiA, int8_t rssiB, uint32_t firstMs,
+                                    uint32_t durationMs)
+{
+    proxRefTrace_t *pT = ProxRef_AddTrace(pSet, durationMs / 100u);
+
+    for (uint32_t t = 100u; (pT != NULL) && (t <= durationMs); t += 100u)
+    {
+        pT->pTMs[pT->n]  = t;
+        pT->pRssi[pT->n] = (t <= firstMs) ? rssiA : rssiB;
+        pT->n++;
+    }
+    return pT;
+}
+
+static uint32_t FirstEvent(const proxRefTrace_t *pT, const proxRefStep_t *pSteps, ProxRssi_EventType ev)
+{
+    for (uint32_t s = 0u; s < pT->n; s++)
+    {
+        if (pSteps[s].ev == ev)
+        {
+            return pT->pTMs[s];
+        }
+    }
+    return 0u;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_fixed_mode_is_firmware(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] q4+alpha+isqrt reproduces ProxRssi.c\n");
+
+    proxRefSet_t set = { 0 };
+    ProxRssi_ParamsType params;
+    proxRefStep_t *pFw = malloc(1500u * sizeof(proxRefStep_t));
+    proxRefStep_t *pFixed = malloc(1500u * sizeof(proxRefStep_t));
+    uint32_t same = 0u;
+    uint32_t unlocks = 0u;
+
+    ProxRef_BuildLut();
+    ProxRef_DefaultParams(&params);
+    TEST_ASSERT((pFw != NULL) && (pFixed != NULL), "Buffers");
+    TEST_ASSERT(ProxRef_Synthesize(&set, 32u, 1500u, 5u) == 0, "Traces synthesized");
+    for (uint32_t i = 0u; i < set.numTraces; i++)
+    {
+        ProxRef_Run(&set.pTraces[i], &params, PROX_REF_FIRMWARE, pFw);
+        ProxRef_Run(&set.pTraces[i], &params, PROX_REF_FIXED, pFixed);
+        same += (ProxRef_SameSteps(pFw, pFixed, set.pTraces[i].n) == TRUE) ? 1u : 0u;
+        for (uint32_t s = 0u; s < set.pTraces[i].n; s++)
+        {
+            unlocks += (pFw[s].ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED) ? 1u : 0u;
+        }
+    }
+    TEST_ASSERT(same == set.numTraces, "Every output of every trace identical");
+    TEST_ASSERT(unlocks > 0u, "The traces unlock");
+
+    free(pFw);
+    free(pFixed);
+    ProxRef_FreeSet(&set);
+
+    TEST_PASS("q4+alpha+isqrt reproduces ProxRssi.c");
+}
+
+static void test_exact_constant_input(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Constant input: no quantization error, same unlock\n");
+
+    proxRefSet_t set = { 0 };
+    ProxRssi_ParamsType params;
+    proxRefTrace_t *pT;
+    proxRefStep_t aRef[100];
+    proxRefStep_t aFw[100];
+
+    ProxRef_BuildLut();
+    ProxRef_DefaultParams(&params);
+    pT = AddStepTrace(&set, -45, -45, 0u, 10000u);
+    TEST_ASSERT(pT != NULL, "Trace");
+
+    ProxRef_Run(pT, &params, PROX_REF_EXACT, aRef);
+    ProxRef_Run(pT, &params, PROX_REF_FIRMWARE, aFw);
+    TEST_ASSERT(aRef[99].n > 0u, "Features at the end");
+    TEST_ASSERT(aRef[99].lastQ4 == -720.0, "EMA at the input");
+    TEST_ASSERT(aRef[99].stdQ4 == 0.0, "No spread");
+    TEST_ASSERT(aRef[99].pct == 1.0, "All above enter");
+    TEST_ASSERT(FirstEvent(pT, aRef, PROX_RSSI_EVT_UNLOCK_TRIGGERED) != 0u, "Reference unlocks");
+    TEST_ASSERT(FirstEvent(pT, aRef, PROX_RSSI_EVT_UNLOCK_TRIGGERED) ==
+                FirstEvent(pT, aFw, PROX_RSSI_EVT_UNLOCK_TRIGGERED), "At the firmware time");
+    ProxRef_FreeSet(&set);
+
+    TEST_PASS("Constant input: no quantization error, same unlock");
+}
+
+static void test_q4_ema_stalls_below_rise(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Truncating Q4 EMA stalls below a rising input\n");
+
+    proxRefSet_t set = { 0 };
+    ProxRssi_ParamsType params;
+    proxRefTrace_t *pT;
+    proxRefStep_t aRef[300];
+    proxRefStep_t aQ4[300];
+    proxRefStep_t aFw[300];
+
+    ProxRef_BuildLut();
+    ProxRef_DefaultParams(&params);
+    pT = AddStepTrace(&set, -80, -45, 5000u, 30000u);
+    TEST_ASSERT(pT != NULL, "Trace");
+
+    ProxRef_Run(pT, &params, PROX_REF_EXACT, aRef);
+    ProxRef_Run(pT, &params, PROX_REF_Q4, aQ4);
+    ProxRef_Run(pT, &params, PROX_REF_FIRMWARE, aFw);
+
+    /* alpha(100 ms) = 1687 / 32768: the step truncates to 0 once the gap is below 20 Q4 */
+    TEST_ASSERT(fabs(aRef[299].lastQ4 + 720.0) < 0.1, "Reference reaches -45 dBm");
+    TEST_ASSERT(aFw[299].lastQ4 == -739.0, "Firmware stalls 19 Q4 below");
+    TEST_ASSERT(aQ4[299].lastQ4 < -735.0, "q4 alone shows the stall");
+
+    /* Falling input: floor() rounds the negative step away from zero and converges */
+    ProxRef_FreeSet(&set);
+    pT = AddStepTrace(&set, -45, -80, 5000u, 30000u);
+    TEST_ASSERT(pT != NULL, "Trace");
+    ProxRef_Run(pT, &params, PROX_REF_FIRMWARE, aFw);
+    TEST_ASSERT(aFw[299].lastQ4 == -1280.0, "Firmware reaches -80 dBm");
+    ProxRef_FreeSet(&set);
+
+    TEST_PASS("Truncating Q4 EMA stalls below a rising input");
+}
+
+static void test_alpha_variants(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Alpha: ramp, LUT and shift-only\n");
+
+    proxRefCtx_t *pCtx = malloc(sizeof(proxRefCtx_t));
+    ProxRssi_ParamsType params;
+
+    ProxRef_BuildLut();
+    ProxRef_DefaultParams(&params);
+    TEST_ASSERT(pCtx != NULL, "Context");
+
+    ProxRef_Init(pCtx, &params, PROX_REF_EXACT);
+    TEST_ASSERT(fabs(ProxRef_AlphaQ15(pCtx, 100u) - 1689.2) < 1e-9, "Ramp at the exact dt");
+    TEST_ASSERT(fabs(ProxRef_AlphaQ15(pCtx, 5000u) - (1638.0 + (62.0 * 8.192))) < 1e-9, "Ramp clamps at the LUT end");
+
+    ProxRef_Init(pCtx, &params, PROX_REF_ALPHA);
+    TEST_ASSERT(ProxRef_AlphaQ15(pCtx, 100u) == 1687.0, "LUT entry 6");
+    TEST_ASSERT(ProxRef_AlphaQ15(pCtx, 111u) == 1687.0, "16 ms steps");
+
+    ProxRef_Init(pCtx, &params, PROX_REF_FIXED | PROX_REF_SHIFT);
+    TEST_ASSERT(ProxRef_AlphaQ15(pCtx, 100u) == 1024.0, "Power of two below");
+    free(pCtx);
+
+    TEST_PASS("Alpha: ramp, LUT and shift-only");
+}
+
+static void test_event_matching(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Events pair within the match window\n");
+
+    proxRefTrace_t trace;
+    uint32_t aT[400];
+    proxRefStep_t aRef[400];
+    proxRefStep_t aModel[400];
+    proxRefVec_t dt = { 0 };
+    uint32_t missing = 0u;
+    uint32_t extra = 0u;
+
+    memset(aRef, 0, sizeof(aRef));
+    memset(aModel, 0, sizeof(aModel));
+    for (uint32_t s = 0u; s < 400u; s++)
+    {
+        aT[s] = 0xFFFFFF00u + (s * 100u);       /* across the wrap */
+    }
+    trace.pTMs  = aT;
+    trace.pRssi = NULL;
+    trace.n     = 400u;
+
+    aRef[10].ev    = PROX_RSSI_EVT_UNLOCK_TRIGGERED;
+    aModel[12].ev  = PROX_RSSI_EVT_UNLOCK_TRIGGERED;   /* 200 ms late */
+    aRef[130].ev   = PROX_RSSI_EVT_UNLOCK_TRIGGERED;   /* missed */
+    aModel[250].ev = PROX_RSSI_EVT_UNLOCK_TRIGGERED;   /* 12 s after it: extra */
+    aRef[390].ev   = PROX_RSSI_EVT_UNLOCK_TRIGGERED;
+    aModel[385].ev = PROX_RSSI_EVT_UNLOCK_TRIGGERED;   /* 500 ms early */
+
+    ProxRef_MatchEvents(&trace, aRef, aModel, PROX_RSSI_EVT_UNLOCK_TRIGGERED, &dt, &missing, &extra);
+    TEST_ASSERT(dt.n == 2u, "Two pairs");
+    TEST_ASSERT((dt.p[0] == 200.0) && (dt.p[1] == -500.0), "Signed shifts");
+    TEST_ASSERT((missing == 1u) && (extra == 1u), "One missing, one extra");
+    ProxRef_VecFree(&dt);
+
+    TEST_PASS("Events pair within the match window");
+}
+
+static void test_stats_and_flags(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Error statistics and mode flags\n");
+
+    proxRefVec_t v = { 0 };
+    proxRefStats_t st;
+
+    (void)ProxRef_VecPush(&v, -1.0);
+    (void)ProxRef_VecPush(&v, 2.0);
+    (void)ProxRef_VecPush(&v, -3.0);
+    (void)ProxRef_VecPush(&v, 4.0);
+    ProxRef_Stats(&v, &st);
+    TEST_ASSERT(st.mean == 0.5, "Signed bias");
+    TEST_ASSERT(fabs(st.rms - sqrt(7.5)) < 1e-12, "RMS");
+    TEST_ASSERT((st.p50 == 2.0) && (st.max == 4.0), "Percentiles of |x|");
+    ProxRef_VecFree(&v);
+
+    TEST_ASSERT(ProxRef_ParseFlags("q4,alpha") == (int64_t)(PROX_REF_Q4 | PROX_REF_ALPHA), "Flag list");
+    TEST_ASSERT(ProxRef_ParseFlags("fixed,sqrt4") == (int64_t)(PROX_REF_FIXED | PROX_REF_SQRT4), "Fixed plus");
+    TEST_ASSERT(ProxRef_ParseFlags("exact") == (int64_t)PROX_REF_EXACT, "Exact");
+    TEST_ASSERT(ProxRef_ParseFlags("q4,cordic") < 0, "Unknown name");
+
+    TEST_PASS("Error statistics and mode flags");
+}
+
+static void test_harness_on_loaded_traces(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Harness over traces loaded from a list\n");
+
+    const char *pCsv = "test_prox_ref_trace.csv";
+    const char *pList = "test_prox_ref_list.txt";
+    proxRefSet_t set = { 0 };
+    ProxRssi_ParamsType params;
+    proxRefAcc_t acc;
+    proxRefStats_t ema;
+    proxRefStep_t aRef[300];
+    proxRefStep_t aFw[300];
+    FILE *pFile = fopen(pCsv, "w");
+
+    TEST_ASSERT(pFile != NULL, "CSV written");
+    fprintf(pFile, "tMs,rssi\n");
+    for (uint32_t t = 100u; t <= 30000u; t += 100u)
+    {
+        fprintf(pFile, "%u,%d\n", t, (t <= 5000u) ? -80 : -49);
+    }
+    fclose(pFile);
+    pFile = fopen(pList, "w");
+    TEST_ASSERT(pFile != NULL, "List written");
+    fprintf(pFile, "# traces\n%s\n", pCsv);
+    fclose(pFile);
+
+    TEST_ASSERT(ProxRef_LoadList(&set, pList) == 0, "List loaded");
+    TEST_ASSERT((set.numTraces == 1u) && (set.pTraces[0].n == 300u), "One trace, header skipped");
+
+    ProxRef_BuildLut();
+    ProxRef_DefaultParams(&params);
+    memset(&acc, 0, sizeof(acc));
+    ProxRef_Run(&set.pTraces[0], &params, PROX_REF_EXACT, aRef);
+    ProxRef_Run(&set.pTraces[0], &params, PROX_REF_FIRMWARE, aFw);
+    ProxRef_Accumulate(&acc, &set.pTraces[0], aRef, aFw);
+    ProxRef_Stats(&acc.emaErr, &ema);
+
+    /* -49 dBm sits 1 dB above enter: the stalled firmware EMA never gets there */
+    TEST_ASSERT(ema.mean < 0.0, "Firmware EMA biased low");
+    TEST_ASSERT((acc.refUnlocks == 1u) && (acc.unlocks == 0u), "Reference unlocks, firmware does not");
+    TEST_ASSERT((acc.missing == 1u) && (acc.extra == 0u) && (acc.diverged == 1u), "Counted as a missed unlock");
+
+    ProxRef_AccFree(&acc);
+    ProxRef_FreeSet(&set);
+    (void)remove(pCsv);
+    (void)remove(pList);
+
+    TEST_PASS("Harness over traces loaded from a list");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "ProxRef Unit Tests (Reference Model + Differential Harness)", &xmlPath);
+
+    RUN_TEST(test_fixed_mode_is_firmware);
+    RUN_TEST(test_exact_constant_input);
+    RUN_TEST(test_q4_ema_stalls_below_rise);
+    RUN_TEST(test_alpha_variants);
+    RUN_TEST(test_event_matching);
+    RUN_TEST(test_stats_and_flags);
+    RUN_TEST(test_harness_on_loaded_traces);
+
+    return Test_End(xmlPath);
+}
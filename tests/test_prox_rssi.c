@@ -778,6 +778,75 @@ static void test_q4_conversions(void)
     TEST_PASS("Q4 conversion helpers");
 }
 
+/*******************************************************************************
+ * 16. Idle connection profile: 100 ms reads of 600 / 1000 ms connection events
+ ******************************************************************************/
+
+/* Read every 100 ms, the value only changes at each connection event. While
+   idle, the candidate hold restarts on every read (as rssi_integration.c does) */
+static ProxRssi_EventType FeedIdleReads(ProxRssi_CtxType *ctx, sint8 rssiDbm, uint32 durationMs,
+                                         uint32 eventSpacingMs, bool_t idle, uint32 *tMs)
+{
+    ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+    ProxRssi_EventType lastSignificant = PROX_RSSI_EVT_NONE;
+    const uint32 tEnd = *tMs + durationMs;
+    sint8 value = rssiDbm;
+
+    while (*tMs < tEnd)
+    {
+        *tMs += 100u;
+        if ((*tMs % eventSpacingMs) < 100u)
+        {
+            /* New connection event: 1 dB of jitter */
+            value = (value == rssiDbm) ? (sint8)(rssiDbm - 1) : rssiDbm;
+        }
+        ProxRssi_PushRaw(ctx, *tMs, value);
+        if ((idle == TRUE) && (ctx->st == PROX_RSSI_ST_CANDIDATE))
+        {
+            ctx->tCandidateStartMs = *tMs;
+        }
+        ProxRssi_MainFunction(ctx, *tMs, &ev, NULL);
+        if (ev != PROX_RSSI_EVT_NONE) { lastSignificant = ev; }
+    }
+    return lastSignificant;
+}
+
+static void test_idle_spacing_leaves_far(void)
+{
+    static const uint32 aSpacingMs[2] = {600u, 1000u};
+    ProxRssi_CtxType ctx;
+    ProxRssi_EventType ev;
+    uint32 s;
+    uint32 t;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Idle connection profile still leaves FAR\n");
+
+    for (s = 0u; s < 2u; s++)
+    {
+        /* Steady near signal from the first read, as with a phone already close */
+        InitFresh(&ctx);
+        t = 1000u;
+        ev = FeedIdleReads(&ctx, (sint8)-40, 2000u, aSpacingMs[s], TRUE, &t);
+        tprintf("    %u ms events: %s, last event %s\n",
+                (unsigned)aSpacingMs[s], StateStr(ctx.st), EventStr(ev));
+        TEST_ASSERT(ctx.st == PROX_RSSI_ST_CANDIDATE, "CANDIDATE within 2 s");
+        TEST_ASSERT(ev == PROX_RSSI_EVT_CANDIDATE_STARTED, "CANDIDATE_STARTED raised");
+
+        /* Repeated values never unlock while the idle profile is in effect */
+        ev = FeedIdleReads(&ctx, (sint8)-40, 20000u, aSpacingMs[s], TRUE, &t);
+        TEST_ASSERT(ctx.st == PROX_RSSI_ST_CANDIDATE, "No unlock while idle");
+        TEST_ASSERT(ev == PROX_RSSI_EVT_NONE, "No event while idle");
+
+        /* Active profile back: the stable hold counts from here */
+        ev = FeedSamplesGetEvent(&ctx, (sint8)-40, 30u, 100u, &t);
+        TEST_ASSERT((ctx.st == PROX_RSSI_ST_LOCKOUT) && (ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED),
+                    "Unlock once active");
+    }
+
+    TEST_PASS("Idle connection profile still leaves FAR");
+}
+
 /*******************************************************************************
  * Main
  ******************************************************************************/
@@ -835,6 +904,7 @@ int main(int argc, char *argv[])
     RUN_TEST(test_force_far);
     RUN_TEST(test_full_lifecycle);
     RUN_TEST(test_q4_conversions);
+    RUN_TEST(test_idle_spacing_leaves_far);
 
     tprintf("\n================================================================\n");
     tprintf("  Results: %d passed, %d failed, %d total\n",
@@ -0,0 +1,327 @@
+/*! *********************************************************************************
+* \file test_prox_time.c
+*
+* \brief  Unit tests for ProxTime — shared proximity timebase — and the
+*         wrap-safe windows of ProxRssi running on it.
+*         Runs on host machine (macOS/Linux). Tests the real prox_time.c and
+*         ProxRssi.c via #include, with the timer manager emulated by
+*         tests/stubs (gStubTimestamp in microseconds).
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "prox_time"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "fsl_component_timer_manager.h"
+#include "prox_time.c"
+#include "ProxRssi.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+#define TRACE_LEN       (230u)
+#define TRACE_STEP_MS   (100u)
+
+typedef struct
+{
+    ProxRssi_EventType ev;
+    ProxRssi_StateType st;
+    int16_t emaQ4;
+    uint16_t n;
+} stepResult_t;
+
+static uint16_t gaLut[1001];
+static int8_t gaTrace[TRACE_LEN];
+static stepResult_t gaRef[TRACE_LEN];
+static stepResult_t gaRun[TRACE_LEN];
+static uint32_t gLcg;
+
+/* rssi_integration.c parameters on the default 8 us tick */
+static void Params(ProxRssi_ParamsType *pParams)
+{
+    memset(pParams, 0, sizeof(*pParams));
+    pParams->wRawMs = 2000u;  pParams->wSpikeMs = 800u;  pParams->wFeatMs = 2000u;
+    pParams->hampelKQ4 = 40u; pParams->madEpsQ4 = 8u;
+    pParams->enterNearQ4 = ProxRssi_DbmToQ4(-50);
+    pParams->exitNearQ4  = ProxRssi_DbmToQ4(-60);
+    pParams->hystQ4      = (uint16_t)ProxRssi_DbToQ4(10);
+    pParams->pctThQ15 = 13107u; pParams->stdThQ4 = 128u; pParams->stableMs = 2000u; pParams->minFeatSamples = 6u;
+    pParams->exitConfirmMs = 1500u; pParams->lockoutMs = 5000u; pParams->maxReasonableDtMs = 2000u;
+    pParams->ticksPerMs = (uint16_t)PROX_TIME_TICKS_PER_MS;
+
+    for (uint32_t i = 0u; i < 1001u; i++)
+    {
+        gaLut[i] = (uint16_t)(1638u + ((i * 8192u) / 1000u));
+    }
+}
+
+static int8_t Noise(int8_t mean, uint32_t spread)
+{
+    gLcg = (gLcg * 1103515245u) + 12345u;
+    return (int8_t)(mean + (int32_t)((gLcg >> 16) % (2u * spread + 1u)) - (int32_t)spread);
+}
+
+/* Walk up to the car, wait, walk away: 10 Hz */
+static void Trace_Make(void)
+{
+    uint32_t i;
+
+    gLcg = 12345u;
+    for (i = 0u; i < 50u; i++)        { gaTrace[i] = Noise(-78, 4u); }
+    for (; i < 150u; i++)             { gaTrace[i] = Noise(-44, 3u); }
+    for (; i < TRACE_LEN; i++)        { gaTrace[i] = Noise(-82, 4u); }
+}
+
+/* Run the trace with the clock starting at base ticks */
+static void Trace_Run(uint32_t base, stepResult_t *pOut)
+{
+    static ProxRssi_CtxType ctx;
+    ProxRssi_ParamsType params;
+    ProxRssi_FeaturesType feat;
+
+    Params(&params);
+    (void)ProxRssi_Init(&ctx, &params, gaLut, 1001u);
+
+    for (uint32_t i = 0u; i < TRACE_LEN; i++)
+    {
+        uint32_t t = base + PROX_TIME_MS_TO_TICKS((i + 1u) * TRACE_STEP_MS);
+        ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+
+        (void)ProxRssi_PushRaw(&ctx, t, gaTrace[i]);
+        (void)ProxRssi_MainFunction(&ctx, t, &ev, &feat);
+        pOut[i].ev    = ev;
+        pOut[i].st    = ctx.st;
+        pOut[i].emaQ4 = ctx.emaQ4;
+        pOut[i].n     = feat.n;
+    }
+}
+
+static uint32_t Trace_Find(const stepResult_t *pRes, ProxRssi_EventType ev)
+{
+    for (uint32_t i = 0u; i < TRACE_LEN; i++)
+    {
+        if (pRes[i].ev == ev)
+        {
+            return i;
+        }
+    }
+    return TRACE_LEN;
+}
+
+/* Ten samples at 10 Hz, then one more usBurst later; stamps from the stub
+ * microsecond clock, in ticks or in ms as configured. Returns the EMA before
+ * the burst sample. */
+static int16_t Burst_Run(ProxRssi_CtxType *pCtx, uint64_t usStart, uint32_t usBurst)
+{
+    ProxRssi_FeaturesType feat;
+    ProxRssi_EventType ev;
+    int16_t prevQ4 = 0;
+    uint32_t t;
+
+    gStubTimestamp = usStart;
+    for (uint32_t i = 0u; i < 11u; i++)
+    {
+        if (i == 10u)
+        {
+            prevQ4 = pCtx->emaQ4;
+            gStubTimestamp += usBurst;
+        }
+        else if (i > 0u)
+        {
+            gStubTimestamp += (uint64_t)TRACE_STEP_MS * 1000u;
+        }
+        t = (pCtx->tk.perMs == 1u) ? (uint32_t)(gStubTimestamp / 1000u) : ProxTime_Now();
+        (void)ProxRssi_PushRaw(pCtx, t, (i == 10u) ? (int8_t)-56 : (((i & 1u) != 0u) ? (int8_t)-58 : (int8_t)-62));
+        (void)ProxRssi_MainFunction(pCtx, t, &ev, &feat);
+    }
+    return prevQ4;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_now_ticks(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] ProxTime_Now shifts and truncates the microsecond clock\n");
+
+    TEST_ASSERT(PROX_TIME_TICK_US == 8u && PROX_TIME_TICKS_PER_MS == 125u, "Default 8 us tick");
+
+    gStubTimestamp = 0u;
+    TEST_ASSERT(ProxTime_Now() == 0u, "Zero");
+    gStubTimestamp = 7u;
+    TEST_ASSERT(ProxTime_Now() == 0u, "Below one tick");
+    gStubTimestamp = 1000u;
+    TEST_ASSERT(ProxTime_Now() == PROX_TIME_MS_TO_TICKS(1u), "One millisecond");
+    gStubTimestamp = ((uint64_t)1u << 35) + 8u;
+    TEST_ASSERT(ProxTime_Now() == 1u, "Wraps after 2^32 ticks");
+    gStubTimestamp = ((uint64_t)1u << 35) - 8u;
+    TEST_ASSERT(ProxTime_Now() == 0xFFFFFFFFu, "Last tick before the wrap");
+    TEST_ASSERT(ProxTime_TicksToMs(PROX_TIME_MS_TO_TICKS(2000u) + 124u) == 2000u, "Ticks to whole ms");
+
+    TEST_PASS("ProxTime_Now shifts and truncates the microsecond clock");
+}
+
+static void test_compare_across_wrap(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Elapsed, Before and InWindow hold across the wrap\n");
+
+    const uint32_t now = 100u;
+    const uint32_t win = PROX_TIME_MS_TO_TICKS(2000u);
+
+    TEST_ASSERT(ProxTime_Elapsed(now, 0xFFFFFF00u) == 356u, "Elapsed across the wrap");
+    TEST_ASSERT(ProxTime_Before(0xFFFFFF00u, now) == TRUE, "Before the wrap is earlier");
+    TEST_ASSERT(ProxTime_Before(now, 0xFFFFFF00u) == FALSE, "After the wrap is later");
+    TEST_ASSERT(ProxTime_Before(now, now) == FALSE, "Not earlier than itself");
+    TEST_ASSERT(ProxTime_Before(0u, PROX_TIME_MAX_SPAN) == TRUE, "Exact up to MAX_SPAN");
+
+    TEST_ASSERT(ProxTime_InWindow(now - win, now, win) == TRUE, "Window edge is inside");
+    TEST_ASSERT(ProxTime_InWindow(now - win - 1u, now, win) == FALSE, "One tick older is outside");
+    TEST_ASSERT(ProxTime_InWindow(0xFFFFFFF0u, now, win) == TRUE, "Straddles the wrap");
+    TEST_ASSERT(ProxTime_InWindow(now + 5u, now, win) == TRUE, "Future samples are kept");
+
+    TEST_PASS("Elapsed, Before and InWindow hold across the wrap");
+}
+
+static void test_decisions_across_wrap(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] ProxRssi decisions do not depend on where the clock wraps\n");
+
+    uint32_t diff = 0u;
+
+    Trace_Make();
+    Trace_Run(0x10000000u, gaRef);
+    TEST_ASSERT(Trace_Find(gaRef, PROX_RSSI_EVT_UNLOCK_TRIGGERED) < TRACE_LEN, "Reference unlocks");
+    TEST_ASSERT(Trace_Find(gaRef, PROX_RSSI_EVT_EXIT_TO_FAR) < TRACE_LEN, "Reference exits");
+
+    /* Wrap once every 500 ms of the trace */
+    for (uint32_t k = 0u; k <= (TRACE_LEN * TRACE_STEP_MS); k += 500u)
+    {
+        Trace_Run(0u - PROX_TIME_MS_TO_TICKS(k), gaRun);
+        diff += (memcmp(gaRef, gaRun, sizeof(gaRef)) != 0) ? 1u : 0u;
+    }
+    TEST_ASSERT(diff == 0u, "Every wrap position gives the reference decisions");
+
+    TEST_PASS("ProxRssi decisions do not depend on where the clock wraps");
+}
+
+static void test_lockout_across_wrap(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Lockout runs its full time when it straddles the wrap\n");
+
+    uint32_t unlock;
+    uint32_t i;
+
+    Trace_Make();
+    Trace_Run(0x10000000u, gaRef);
+    unlock = Trace_Find(gaRef, PROX_RSSI_EVT_UNLOCK_TRIGGERED);
+    TEST_ASSERT(unlock + 50u < TRACE_LEN, "Trace holds the whole lockout");
+
+    /* Wrap 1 s into the lockout */
+    Trace_Run(0u - PROX_TIME_MS_TO_TICKS((unlock + 1u) * TRACE_STEP_MS + 1000u), gaRun);
+    TEST_ASSERT(gaRun[unlock].ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED, "Unlock before the wrap");
+    for (i = unlock; i < unlock + 50u; i++)
+    {
+        if (gaRun[i].st != PROX_RSSI_ST_LOCKOUT)
+        {
+            break;
+        }
+    }
+    TEST_ASSERT(i == unlock + 50u, "Locked out for lockoutMs");
+    TEST_ASSERT(gaRun[unlock + 50u].st == gaRef[unlock + 50u].st, "Leaves lockout like the reference");
+
+    TEST_PASS("Lockout runs its full time when it straddles the wrap");
+}
+
+static void test_sub_ms_samples(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Samples less than 1 ms apart are smoothed, not reset\n");
+
+    static ProxRssi_CtxType ctx;
+    ProxRssi_ParamsType params;
+    int16_t prevQ4;
+
+    /* 200 us after the last 10 Hz sample: 25 ticks */
+    Params(&params);
+    (void)ProxRssi_Init(&ctx, &params, gaLut, 1001u);
+    prevQ4 = Burst_Run(&ctx, 5000000u, 200u);
+    TEST_ASSERT(ctx.raw.count == 11u, "Burst sample kept");
+    TEST_ASSERT((ctx.emaQ4 > prevQ4) && (ctx.emaQ4 < ProxRssi_DbmToQ4(-56)),
+                "EMA steps with the shortest alpha");
+
+    /* The same burst on a millisecond clock looks like a time anomaly */
+    params.ticksPerMs = 0u;
+    (void)ProxRssi_Init(&ctx, &params, gaLut, 1001u);
+    (void)Burst_Run(&ctx, 5000000u, 200u);
+    TEST_ASSERT(ctx.emaQ4 == ProxRssi_DbmToQ4(-56), "Millisecond clock resets the EMA");
+
+    TEST_PASS("Samples less than 1 ms apart are smoothed, not reset");
+}
+
+static void test_init_limits(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Init rejects windows and ramps the tick math cannot hold\n");
+
+    static ProxRssi_CtxType ctx;
+    ProxRssi_ParamsType params;
+
+    Params(&params);
+    TEST_ASSERT(ProxRssi_Init(&ctx, &params, gaLut, 1001u) == E_OK, "Defaults accepted");
+    TEST_ASSERT(ctx.tk.perMs == 125u && ctx.tk.wRaw == 250000u && ctx.tk.lockout == 625000u,
+                "Windows converted once");
+
+    params.lockoutMs = PROX_TIME_MAX_SPAN / PROX_TIME_TICKS_PER_MS;
+    TEST_ASSERT(ProxRssi_Init(&ctx, &params, gaLut, 1001u) == E_OK, "Longest timer accepted");
+    params.lockoutMs += 1u;
+    TEST_ASSERT(ProxRssi_Init(&ctx, &params, gaLut, 1001u) == E_NOT_OK, "Timer beyond MAX_SPAN rejected");
+
+    Params(&params);
+    params.wFeatMs = 0xFFFFFFFFu;
+    TEST_ASSERT(ProxRssi_Init(&ctx, &params, gaLut, 1001u) == E_NOT_OK, "Window beyond MAX_SPAN rejected");
+
+    Params(&params);
+    params.ticksPerMs = 0u;
+    params.wFeatMs = 3600000u;
+    TEST_ASSERT(ProxRssi_Init(&ctx, &params, gaLut, 1001u) == E_OK, "Hour window fine on a ms clock");
+    TEST_ASSERT(ctx.tk.perMs == 1u, "ticksPerMs 0 means ms");
+
+    Params(&params);
+    params.alphaLoQ15 = 3277u;  params.alphaHiQ15 = 26214u;
+    params.alphaRampLoMs = 50u; params.alphaRampHiMs = 50u + PROX_RSSI_ALPHA_RAMP_MAX_MS;
+    TEST_ASSERT(ProxRssi_Init(&ctx, &params, NULL, 0u) == E_OK, "Longest ramp accepted");
+    params.alphaRampHiMs += 1u;
+    TEST_ASSERT(ProxRssi_Init(&ctx, &params, NULL, 0u) == E_NOT_OK, "Longer ramp rejected");
+
+    TEST_PASS("Init rejects windows and ramps the tick math cannot hold");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "ProxTime Unit Tests (Timebase + Wrap-safe Windows)", &xmlPath);
+
+    RUN_TEST(test_now_ticks);
+    RUN_TEST(test_compare_across_wrap);
+    RUN_TEST(test_decisions_across_wrap);
+    RUN_TEST(test_lockout_across_wrap);
+    RUN_TEST(test_sub_ms_samples);
+    RUN_TEST(test_init_limits);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,311 @@
+/*! *********************************************************************************
+* \file test_prox_tune.c
+*
+* \brief  Unit tests for the ProxRssi auto-tuner in tools/prox_tune.c.
+*         Runs on host machine (macOS/Linux). Tests the real tool via #include:
+*         trace scoring, parallel evaluation, Pareto fronts and the emitted
+*         parameter header.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define _DEFAULT_SOURCE
+#define TEST_SUITE_NAME "prox_tune"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real tool
+ ******************************************************************************/
+#define PROX_TUNE_NO_MAIN
+#include "prox_tune.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+/* Constant RSSI at 10 Hz for durationMs */
+static void AddConstTrace(proxTuneCorpus_t *pCorpus, proxTuneLabel_t label, int8_t rssi, uint32_t durationMs)
+{
+    proxTuneTrace_t *pT = ProxTune_AddTrace(pCorpus, label, 0u, durationMs / 100u);
+
+    for (uint32_t t = 100u; (pT != NULL) && (t <= durationMs); t += 100u)
+    {
+        pT->pTMs[pT->n]  = t;
+        pT->pRssi[pT->n] = rssi;
+        pT->n++;
+    }
+}
+
+static proxTuneResult_t MakeResult(uint32_t falseUnlocks, uint32_t missed, uint32_t latMs)
+{
+    proxTuneResult_t r;
+
+    memset(&r, 0, sizeof(r));
+    r.positives    = 10u;
+    r.negatives    = 10u;
+    r.falseUnlocks = falseUnlocks;
+    r.missed       = missed;
+    r.latP50Ms     = latMs;
+    r.latP95Ms     = latMs;
+    return r;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_scoring_by_label(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Traces are scored by label\n");
+
+    proxTuneCorpus_t corpus = { 0 };
+    proxTuneCand_t cand;
+    proxTuneResult_t res;
+    ProxRssi_CtxType *pCtx = malloc(sizeof(ProxRssi_CtxType));
+    uint32_t aLat[4];
+
+    ProxTune_BuildLut();
+    AddConstTrace(&corpus, proxTuneApproach_c, -40, 10000u);    /* unlocks */
+    AddConstTrace(&corpus, proxTunePocket_c, -80, 10000u);      /* missed */
+    AddConstTrace(&corpus, proxTunePassBy_c, -80, 10000u);      /* correct */
+    AddConstTrace(&corpus, proxTuneWalkAway_c, -40, 10000u);    /* false unlock */
+
+    ProxTune_DefaultCand(&cand);
+    ProxTune_Evaluate(&corpus, &cand, pCtx, aLat, &res);
+    TEST_ASSERT(res.positives == 2u && res.negatives == 2u, "Two traces of each kind");
+    TEST_ASSERT(res.missed == 1u && res.falseUnlocks == 1u, "One miss, one false unlock");
+    TEST_ASSERT(res.latP50Ms >= PROX_PARAM_STABLE_MS && res.latP50Ms < PROX_PARAM_STABLE_MS + 2000u,
+                "Unlock after the stability time");
+
+    cand.v[proxTuneStable_c] = 500;
+    proxTuneResult_t fast;
+    ProxTune_Evaluate(&corpus, &cand, pCtx, aLat, &fast);
+    TEST_ASSERT(fast.latP50Ms < res.latP50Ms, "Shorter stableMs unlocks sooner");
+
+    cand.v[proxTuneEnter_c] = -90;
+    ProxTune_Evaluate(&corpus, &cand, pCtx, aLat, &res);
+    TEST_ASSERT(res.missed == 0u && res.falseUnlocks == 2u, "Low threshold unlocks everything");
+
+    free(pCtx);
+    ProxTune_FreeCorpus(&corpus);
+    TEST_PASS("Traces are scored by label");
+}
+
+static void test_manifest_loading(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Manifest and CSV traces load\n");
+
+    const char *pCsv = "test_prox_tune_trace.csv";
+    const char *pManifest = "test_prox_tune_manifest.txt";
+    proxTuneCorpus_t corpus = { 0 };
+    FILE *pFile;
+
+    pFile = fopen(pCsv, "w");
+    TEST_ASSERT(pFile != NULL, "CSV created");
+    fprintf(pFile, "t_ms,rssi\n100,-70\n200,-68\n300,-65\n");
+    fclose(pFile);
+    pFile = fopen(pManifest, "w");
+    TEST_ASSERT(pFile != NULL, "Manifest created");
+    fprintf(pFile, "# label file refMs\npocket %s 250\n\npassby %s\n", pCsv, pCsv);
+    fclose(pFile);
+
+    TEST_ASSERT(ProxTune_LoadManifest(&corpus, pManifest) == 0, "Loaded");
+    TEST_ASSERT(corpus.n == 2u, "Two traces");
+    TEST_ASSERT(corpus.pTraces[0].label == proxTunePocket_c && corpus.pTraces[0].refMs == 250u, "Label and reference");
+    TEST_ASSERT(corpus.pTraces[1].label == proxTunePassBy_c && corpus.pTraces[1].refMs == 0u, "Reference optional");
+    TEST_ASSERT(corpus.pTraces[0].n == 3u && corpus.pTraces[0].pTMs[2] == 300u && corpus.pTraces[0].pRssi[2] == -65,
+                "Header skipped, rows parsed");
+    ProxTune_FreeCorpus(&corpus);
+
+    pFile = fopen(pManifest, "w");
+    fprintf(pFile, "sideways %s\n", pCsv);
+    fclose(pFile);
+    TEST_ASSERT(ProxTune_LoadManifest(&corpus, pManifest) != 0, "Unknown label rejected");
+    ProxTune_FreeCorpus(&corpus);
+
+    (void)remove(pCsv);
+    (void)remove(pManifest);
+    TEST_PASS("Manifest and CSV traces load");
+}
+
+static void test_synthetic_corpus(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Synthetic corpus is reproducible\n");
+
+    proxTuneCorpus_t a = { 0 };
+    proxTuneCorpus_t b = { 0 };
+    uint32_t perLabel[proxTuneLabelCount_c] = { 0u };
+
+    TEST_ASSERT(ProxTune_Synthesize(&a, 3u, 7u) == 0 && ProxTune_Synthesize(&b, 3u, 7u) == 0, "Generated");
+    TEST_ASSERT(a.n == 12u && b.n == 12u, "Three traces per label");
+    for (uint32_t i = 0u; i < a.n; i++)
+    {
+        perLabel[a.pTraces[i].label]++;
+        TEST_ASSERT(a.pTraces[i].n == b.pTraces[i].n &&
+                    memcmp(a.pTraces[i].pRssi, b.pTraces[i].pRssi, a.pTraces[i].n) == 0, "Same seed, same trace");
+        TEST_ASSERT(a.pTraces[i].n > 100u, "Several seconds per trace");
+        for (uint32_t s = 1u; s < a.pTraces[i].n; s++)
+        {
+            TEST_ASSERT(a.pTraces[i].pTMs[s] > a.pTraces[i].pTMs[s - 1u], "Time increases");
+        }
+    }
+    for (uint32_t l = 0u; l < (uint32_t)proxTuneLabelCount_c; l++)
+    {
+        TEST_ASSERT(perLabel[l] == 3u, "Every label present");
+    }
+
+    ProxTune_FreeCorpus(&a);
+    ProxTune_FreeCorpus(&b);
+    TEST_PASS("Synthetic corpus is reproducible");
+}
+
+static void test_threads_match_serial(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Parallel evaluation matches a single thread\n");
+
+    proxTuneCorpus_t corpus = { 0 };
+    const uint32_t n = 64u;
+    proxTuneCand_t *pCands = malloc(n * sizeof(proxTuneCand_t));
+    proxTuneResult_t *pSerial = calloc(n, sizeof(proxTuneResult_t));
+    proxTuneResult_t *pParallel = calloc(n, sizeof(proxTuneResult_t));
+
+    ProxTune_BuildLut();
+    TEST_ASSERT(ProxTune_Synthesize(&corpus, 2u, 3u) == 0, "Corpus");
+    ProxTune_MakeCandidates(pCands, n, FALSE, 11u);
+    TEST_ASSERT(ProxTune_RunAll(&corpus, pCands, pSerial, n, 1u) == 0, "Serial run");
+    TEST_ASSERT(ProxTune_RunAll(&corpus, pCands, pParallel, n, 4u) == 0, "Parallel run");
+    TEST_ASSERT(memcmp(pSerial, pParallel, n * sizeof(proxTuneResult_t)) == 0, "Identical results");
+
+    free(pCands);
+    free(pSerial);
+    free(pParallel);
+    ProxTune_FreeCorpus(&corpus);
+    TEST_PASS("Parallel evaluation matches a single thread");
+}
+
+static void test_grid_ranges(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Search ranges and grid enumeration\n");
+
+    proxTuneRange_t aSaved[PROX_TUNE_DIMS];
+    proxTuneCand_t aCands[8];
+
+    memcpy(aSaved, gaProxTuneRanges, sizeof(aSaved));
+    TEST_ASSERT(ProxTune_SetRange("std=48:96:24") == 0, "Range accepted");
+    TEST_ASSERT(ProxTune_SetRange("bogus=1:2:1") != 0, "Unknown name rejected");
+    TEST_ASSERT(ProxTune_SetRange("pct=10:5:1") != 0, "Empty range rejected");
+    TEST_ASSERT(ProxTune_SetRange("stable=500:500:0") != 0, "Zero step rejected");
+    for (uint32_t d = 0u; d < PROX_TUNE_DIMS; d++)
+    {
+        if (d != (uint32_t)proxTuneStd_c)
+        {
+            gaProxTuneRanges[d].hi = gaProxTuneRanges[d].lo;
+        }
+    }
+    TEST_ASSERT(ProxTune_GridSize() == 3u, "Only std varies");
+
+    ProxTune_MakeCandidates(aCands, 3u, TRUE, 0u);
+    TEST_ASSERT(aCands[0].v[proxTuneStd_c] == 48 && aCands[1].v[proxTuneStd_c] == 72 &&
+                aCands[2].v[proxTuneStd_c] == 96, "Grid walks the range");
+    ProxTune_MakeCandidates(aCands, 8u, FALSE, 5u);
+    for (uint32_t i = 0u; i < 8u; i++)
+    {
+        TEST_ASSERT(aCands[i].v[proxTuneStd_c] >= 48 && aCands[i].v[proxTuneStd_c] <= 96 &&
+                    (aCands[i].v[proxTuneStd_c] % 24) == 0, "Random points on the grid");
+    }
+
+    memcpy(gaProxTuneRanges, aSaved, sizeof(aSaved));
+    TEST_PASS("Search ranges and grid enumeration");
+}
+
+static void test_pareto_fronts(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Pareto fronts and the chosen set\n");
+
+    proxTuneResult_t aRes[6];
+    uint32_t aOrder[6];
+
+    aRes[0] = MakeResult(0u, 5u, 4000u);    /* front: safest */
+    aRes[1] = MakeResult(1u, 1u, 2000u);    /* front: fewest errors */
+    aRes[2] = MakeResult(1u, 2u, 2500u);    /* dominated by 1 */
+    aRes[3] = MakeResult(4u, 0u, 500u);     /* front: fastest */
+    aRes[4] = MakeResult(1u, 1u, 2000u);    /* duplicate of 1 */
+    aRes[5] = MakeResult(0u, 6u, 4000u);    /* dominated by 0 */
+
+    uint32_t frontSize = ProxTune_MarkFronts(aRes, 6u, aOrder);
+    TEST_ASSERT(frontSize == 3u, "Three trade-offs");
+    TEST_ASSERT(aOrder[0] == 0u && aOrder[1] == 1u && aOrder[2] == 3u, "Front first, safest first");
+    TEST_ASSERT(aRes[2].onFront == FALSE && aRes[4].onFront == FALSE && aRes[5].onFront == FALSE, "Dominated points");
+    TEST_ASSERT(aRes[0].onFalseFront == TRUE && aRes[3].onFalseFront == TRUE && aRes[5].onFalseFront == FALSE,
+                "Latency/false front");
+    TEST_ASSERT(aRes[3].onMissFront == TRUE && aRes[0].onMissFront == FALSE, "Latency/missed front");
+
+    TEST_ASSERT(ProxTune_Choose(aRes, aOrder, frontSize, PROX_TUNE_NO_LIMIT, PROX_TUNE_NO_LIMIT) == 1u,
+                "Fewest errors by default");
+    TEST_ASSERT(ProxTune_Choose(aRes, aOrder, frontSize, 0u, PROX_TUNE_NO_LIMIT) == 0u, "No false unlocks allowed");
+    TEST_ASSERT(ProxTune_Choose(aRes, aOrder, frontSize, 500u, 500u) == 3u, "Fastest within limits");
+
+    TEST_PASS("Pareto fronts and the chosen set");
+}
+
+static void test_header_output(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Emitted header uses the firmware macros\n");
+
+    const char *pPath = "test_prox_tune_params.h";
+    proxTuneCorpus_t corpus = { 0 };
+    proxTuneCand_t cand;
+    proxTuneResult_t res = MakeResult(1u, 2u, 1500u);
+    char text[4096];
+    size_t len;
+    FILE *pFile;
+
+    ProxTune_DefaultCand(&cand);
+    cand.v[proxTuneStd_c]     = 96;
+    cand.v[proxTuneEnter_c]   = -53;
+    cand.v[proxTuneExitGap_c] = 8;
+    TEST_ASSERT(ProxTune_WriteHeader(pPath, &cand, &res, &corpus) == 0, "Written");
+
+    pFile = fopen(pPath, "r");
+    TEST_ASSERT(pFile != NULL, "Readable");
+    len = fread(text, 1u, sizeof(text) - 1u, pFile);
+    fclose(pFile);
+    (void)remove(pPath);
+    text[len] = '\0';
+
+    TEST_ASSERT(strstr(text, "#define PROX_PARAM_STD_TH_Q4                (96u)") != NULL, "Tuned value");
+    TEST_ASSERT(strstr(text, "#define PROX_PARAM_ENTER_NEAR_DBM           (-53)") != NULL, "Enter threshold");
+    TEST_ASSERT(strstr(text, "#define PROX_PARAM_EXIT_NEAR_DBM            (-61)") != NULL, "Exit from the gap");
+    TEST_ASSERT(strstr(text, "#define PROX_PARAM_LOCKOUT_MS               (5000u)") != NULL, "Untuned value kept");
+    TEST_ASSERT(strstr(text, "#endif /* PROX_RSSI_PARAMS_H */") != NULL, "Complete");
+
+    TEST_PASS("Emitted header uses the firmware macros");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "ProxTune Unit Tests (Scoring + Search + Fronts)", &xmlPath);
+
+    RUN_TEST(test_scoring_by_label);
+    RUN_TEST(test_manifest_loading);
+    RUN_TEST(test_synthetic_corpus);
+    RUN_TEST(test_threads_match_serial);
+    RUN_TEST(test_grid_ranges);
+    RUN_TEST(test_pareto_fronts);
+    RUN_TEST(test_header_output);
+
+    return Test_End(xmlPath);
+}
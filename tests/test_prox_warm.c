@@ -0,0 +1,282 @@
+/*! *********************************************************************************
+* \file test_prox_warm.c
+*
+* \brief  Unit tests for the ProxRssi warm start — ProxRssi_Snapshot and
+*         ProxRssi_Restore across a link drop.
+*         Runs on host machine (macOS/Linux). Tests the real ProxRssi.c via
+*         #include: history round trip, age-based confidence decay, carried
+*         lockout and candidate hold, and reconnect-to-unlock latency against
+*         the ForceFar cold start.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "prox_warm"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "ProxRssi.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+#define WARM_MS         (10000u)
+#define STEP_MS         (100u)
+
+static ProxRssi_CtxType gCtx;
+static ProxRssi_SnapshotType gSnap;
+static uint16_t gaLut[1001];
+static uint32_t gLcg;
+
+/* Same parameters and LUT as rssi_integration.c (prox_rssi_params.h), ms clock */
+static void Init(void)
+{
+    ProxRssi_ParamsType params;
+
+    memset(&params, 0, sizeof(params));
+    params.wRawMs = 2000u;  params.wSpikeMs = 800u;  params.wFeatMs = 2000u;
+    params.hampelKQ4 = 40u; params.madEpsQ4 = 8u;
+    params.enterNearQ4 = ProxRssi_DbmToQ4(-50);
+    params.exitNearQ4  = ProxRssi_DbmToQ4(-60);
+    params.hystQ4      = (uint16_t)ProxRssi_DbToQ4(10);
+    params.pctThQ15 = 13107u; params.stdThQ4 = 128u; params.stableMs = 2000u; params.minFeatSamples = 6u;
+    params.exitConfirmMs = 1500u; params.lockoutMs = 5000u; params.maxReasonableDtMs = 2000u;
+
+    for (uint32_t i = 0u; i < 1001u; i++)
+    {
+        gaLut[i] = (uint16_t)(1638u + ((i * 8192u) / 1000u));
+    }
+    (void)ProxRssi_Init(&gCtx, &params, gaLut, 1001u);
+}
+
+static int8_t Noise(int32_t mean, uint32_t spread)
+{
+    gLcg = (gLcg * 1103515245u) + 12345u;
+    return (int8_t)(mean + (int32_t)((gLcg >> 16) % (2u * spread + 1u)) - (int32_t)spread);
+}
+
+/* n samples at 10 Hz from *pT; returns the sample index of the first unlock, n if none */
+static uint32_t Feed(uint32_t *pT, uint32_t n, int32_t mean, uint32_t spread)
+{
+    ProxRssi_EventType ev;
+    uint32_t unlockAt = n;
+
+    for (uint32_t i = 0u; i < n; i++)
+    {
+        *pT += STEP_MS;
+        (void)ProxRssi_PushRaw(&gCtx, *pT, Noise(mean, spread));
+        (void)ProxRssi_MainFunction(&gCtx, *pT, &ev, NULL);
+        if ((ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED) && (unlockAt == n))
+        {
+            unlockAt = i;
+        }
+    }
+    return unlockAt;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_snapshot_roundtrip(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Snapshot + immediate restore keeps EMA and history\n");
+
+    uint32_t t = 1000u;
+    int16_t emaQ4;
+    uint16_t count;
+
+    gLcg = 1u;
+    Init();
+    (void)Feed(&t, 40u, -70, 2u);
+    emaQ4 = gCtx.emaQ4;
+    count = gCtx.smooth.count;
+
+    TEST_ASSERT(ProxRssi_Snapshot(&gCtx, &gSnap) == E_OK, "Snapshot taken");
+    TEST_ASSERT(gSnap.tLastMs == t && gSnap.emaQ4 == emaQ4, "Newest sample and EMA");
+    TEST_ASSERT(gSnap.count == count && count <= PROX_RSSI_SNAP_CAP, "Feature window kept");
+    TEST_ASSERT(gSnap.ageMs[gSnap.count - 1u] == 0u && gSnap.ageMs[0] == (uint32_t)(count - 1u) * STEP_MS,
+                "Ages before the newest sample, oldest first");
+
+    /* Restored at the next sample time: nothing lost */
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, t + 1u, &gSnap, WARM_MS) == E_OK, "Restored");
+    TEST_ASSERT(gCtx.emaValid == TRUE && gCtx.emaQ4 == emaQ4 && gCtx.smooth.count == count, "EMA and history back");
+    TEST_ASSERT(gCtx.raw.count == 0u && gCtx.st == PROX_RSSI_ST_FAR, "Hampel window and FAR state fresh");
+
+    TEST_ASSERT(ProxRssi_Snapshot(NULL, &gSnap) == E_NOT_OK && ProxRssi_Snapshot(&gCtx, NULL) == E_NOT_OK,
+                "NULL-safe snapshot");
+    TEST_ASSERT(ProxRssi_Restore(NULL, t, &gSnap, WARM_MS) == E_NOT_OK, "NULL-safe restore");
+
+    TEST_PASS("Snapshot + immediate restore keeps EMA and history");
+}
+
+static void test_confidence_decay(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Restored history and EMA weight decay with age\n");
+
+    uint32_t t = 1000u;
+    uint32_t tLast;
+    ProxRssi_EventType ev;
+
+    gLcg = 2u;
+    Init();
+    (void)Feed(&t, 40u, -70, 0u);
+    (void)ProxRssi_Snapshot(&gCtx, &gSnap);
+    tLast = t;
+
+    /* Half the warm window: half the history */
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, tLast + (WARM_MS / 2u), &gSnap, WARM_MS) == E_OK, "Restored at half age");
+    TEST_ASSERT(gCtx.smooth.count == (gSnap.count + 1u) / 2u, "Half the samples kept");
+    TEST_ASSERT(gCtx.emaWarmQ15 >= 16383u && gCtx.emaWarmQ15 <= 16384u, "First sample weighs at least 1/2");
+
+    /* Phone moved 20 dB during the drop: the first smoothed sample lands half way */
+    t = tLast + (WARM_MS / 2u);
+    for (uint32_t i = 0u; i < 3u; i++)
+    {
+        t += STEP_MS;
+        (void)ProxRssi_PushRaw(&gCtx, t, (int8_t)-50);
+        (void)ProxRssi_MainFunction(&gCtx, t, &ev, NULL);
+    }
+    TEST_ASSERT(gCtx.emaQ4 >= ProxRssi_DbmToQ4(-61) && gCtx.emaQ4 <= ProxRssi_DbmToQ4(-59), "EMA half way");
+    TEST_ASSERT(gCtx.emaWarmQ15 == 0u, "Floor used once");
+
+    /* Too old, other timebase, empty: cold */
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, tLast + WARM_MS, &gSnap, WARM_MS) == E_NOT_OK, "Too old");
+    TEST_ASSERT(gCtx.emaValid == FALSE && gCtx.smooth.count == 0u, "Left cold");
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, tLast - 1u, &gSnap, WARM_MS) == E_NOT_OK, "From the future");
+    gSnap.perMs = PROX_TIME_TICKS_PER_MS;
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, tLast + 1u, &gSnap, WARM_MS) == E_NOT_OK, "Other timebase");
+    gSnap.perMs = 1u;
+    gSnap.emaValid = FALSE;
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, tLast + 1u, &gSnap, WARM_MS) == E_NOT_OK, "Empty snapshot");
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, tLast + 1u, NULL, WARM_MS) == E_NOT_OK, "No snapshot");
+
+    TEST_PASS("Restored history and EMA weight decay with age");
+}
+
+static void test_candidate_credit(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Candidate hold credited up to stableMs / 2\n");
+
+    uint32_t t = 1000u;
+    uint32_t tLast;
+
+    gLcg = 3u;
+    Init();
+    (void)Feed(&t, 24u, -42, 1u);
+    TEST_ASSERT(gCtx.st == PROX_RSSI_ST_CANDIDATE, "Candidate before the drop");
+    (void)ProxRssi_Snapshot(&gCtx, &gSnap);
+    tLast = t;
+    TEST_ASSERT(gSnap.candidateMs >= 1500u, "Held 1.5 s or more");
+
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, tLast + 1u, &gSnap, WARM_MS) == E_OK, "Restored at once");
+    TEST_ASSERT(gCtx.st == PROX_RSSI_ST_CANDIDATE && (tLast + 1u) - gCtx.tCandidateStartMs == 1000u,
+                "Credit capped at half of stableMs");
+
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, tLast + 8000u, &gSnap, WARM_MS) == E_OK, "Restored late");
+    TEST_ASSERT((tLast + 8000u) - gCtx.tCandidateStartMs == (gSnap.candidateMs * 2u) / 10u, "Credit decays with age");
+
+    TEST_PASS("Candidate hold credited up to stableMs / 2");
+}
+
+static void test_lockout_carries_over(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Running lockout survives the drop, an expired one does not\n");
+
+    uint32_t t = 1000u;
+    uint32_t tLast;
+
+    gLcg = 4u;
+    Init();
+    TEST_ASSERT(Feed(&t, 40u, -42, 1u) < 40u, "Unlocked before the drop");
+    TEST_ASSERT(gCtx.st == PROX_RSSI_ST_LOCKOUT, "In lockout");
+    (void)ProxRssi_Snapshot(&gCtx, &gSnap);
+    tLast = t;
+    TEST_ASSERT(gSnap.lockoutLeftMs > 2000u, "Lockout running");
+
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, tLast + 1000u, &gSnap, WARM_MS) == E_OK, "Reconnect within the lockout");
+    TEST_ASSERT(gCtx.st == PROX_RSSI_ST_LOCKOUT && gCtx.tLockoutUntilMs == tLast + gSnap.lockoutLeftMs,
+                "Lockout ends on the wall clock");
+    t = tLast + 1000u;
+    TEST_ASSERT(Feed(&t, 60u, -42, 1u) == 60u, "No second unlock at the door");
+
+    TEST_ASSERT(ProxRssi_Restore(&gCtx, tLast + gSnap.lockoutLeftMs + 500u, &gSnap, WARM_MS) == E_OK,
+                "Reconnect after the lockout");
+    TEST_ASSERT(gCtx.st == PROX_RSSI_ST_FAR, "Expired lockout restarts in FAR");
+
+    TEST_PASS("Running lockout survives the drop, an expired one does not");
+}
+
+static void test_reconnect_latency(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Warm start unlocks sooner than ForceFar after a drop at the door\n");
+
+    uint32_t warmSum = 0u;
+    uint32_t coldSum = 0u;
+    uint32_t warmMax = 0u;
+    uint32_t trial;
+
+    for (trial = 0u; trial < 20u; trial++)
+    {
+        uint32_t t = 1000u;
+        uint32_t gapMs = 1000u + (trial * 400u);
+        uint32_t warm;
+        uint32_t cold;
+
+        /* Standing at the door; the link drops about 1 s into the hold */
+        gLcg = 100u + trial;
+        Init();
+        (void)Feed(&t, 20u, -42, 3u);
+        (void)ProxRssi_Snapshot(&gCtx, &gSnap);
+
+        t += gapMs;
+        (void)ProxRssi_Restore(&gCtx, t, &gSnap, WARM_MS);
+        warm = Feed(&t, 60u, -42, 3u);
+
+        gLcg = 100u + trial;
+        Init();
+        (void)Feed(&t, 20u, -42, 3u);
+        (void)ProxRssi_ForceFar(&gCtx);
+        t += gapMs;
+        cold = Feed(&t, 60u, -42, 3u);
+
+        TEST_ASSERT((warm < 60u) && (cold < 60u), "Both unlock");
+        TEST_ASSERT((warm + 1u) * STEP_MS >= 1000u, "Half of stableMs held on fresh samples");
+        warmSum += warm;
+        coldSum += cold;
+        warmMax = (warm > warmMax) ? warm : warmMax;
+    }
+
+    tprintf("  reconnect to unlock: warm %u ms (max %u ms), cold %u ms\n",
+            (unsigned)((warmSum * STEP_MS) / 20u), (unsigned)(warmMax * STEP_MS), (unsigned)((coldSum * STEP_MS) / 20u));
+    TEST_ASSERT((warmSum * 10u) <= (coldSum * 7u), "30% or more faster on average");
+
+    TEST_PASS("Warm start unlocks sooner than ForceFar after a drop at the door");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "ProxRssi Warm Start Unit Tests (Snapshot / Restore)", &xmlPath);
+
+    RUN_TEST(test_snapshot_roundtrip);
+    RUN_TEST(test_confidence_decay);
+    RUN_TEST(test_candidate_credit);
+    RUN_TEST(test_lockout_carries_over);
+    RUN_TEST(test_reconnect_latency);
+
+    return Test_End(xmlPath);
+}
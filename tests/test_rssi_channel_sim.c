@@ -0,0 +1,277 @@
+/*! *********************************************************************************
+* \file test_rssi_channel_sim.c
+*
+* \brief  Unit tests for the BLE RSSI channel simulator in tools/rssi_channel_sim.c.
+*         Runs on host machine (macOS/Linux). Tests the real tool via #include:
+*         trajectories, channel statistics, seeding and the engine drivers.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define _DEFAULT_SOURCE
+#define TEST_SUITE_NAME "rssi_channel_sim"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real tool
+ ******************************************************************************/
+#define CHAN_SIM_NO_MAIN
+#include "rssi_channel_sim.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+static chanSimSample_t gaSamples[CHAN_SIM_MAX_SAMPLES];
+
+static void InitJob(chanSimJob_t *pJob, uint32_t runs, uint32_t scenarioMask)
+{
+    memset(pJob, 0, sizeof(*pJob));
+    pJob->seed            = 42u;
+    pJob->runsPerScenario = runs;
+    pJob->scenarioMask    = scenarioMask;
+    pJob->carry           = chanSimMix_c;
+    pJob->engineMask      = (1u << chanSimEngineCount_c) - 1u;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_trajectories(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Scripted walks end where the scenario says\n");
+
+    uint64_t rng = 7u;
+    chanSimTrajectory_t traj;
+    double x, y, hx, hy, speed;
+
+    ChanSim_Script(chanSimApproach_c, chanSimPocket_c, &rng, &traj);
+    TEST_ASSERT(traj.carry == chanSimPocket_c, "Carry mode kept");
+    TEST_ASSERT(traj.arriveS > 5.0 && traj.arriveS < traj.durationS, "Arrival before the end of the dwell");
+    ChanSim_Where(&traj, 0.0, &x, &y, &hx, &hy, &speed);
+    TEST_ASSERT(hypot(x, y) >= 10.0 && speed >= 1.0, "Starts walking from 10 m or more");
+    TEST_ASSERT(((hx * -x) + (hy * -y)) > 0.99 * hypot(x, y), "Heading towards the car");
+    ChanSim_Where(&traj, traj.arriveS + 1.0, &x, &y, &hx, &hy, &speed);
+    TEST_ASSERT(hypot(x, y) <= 1.0 && speed == 0.0, "Standing at the door after arrival");
+
+    ChanSim_Script(chanSimPassBy_c, chanSimMix_c, &rng, &traj);
+    TEST_ASSERT(traj.carry < chanSimCarryCount_c, "Mixed carry picks a real mode");
+    double closest = 100.0;
+    for (double t = 0.0; t < traj.durationS; t += 0.1)
+    {
+        ChanSim_Where(&traj, t, &x, &y, &hx, &hy, &speed);
+        closest = (hypot(x, y) < closest) ? hypot(x, y) : closest;
+    }
+    TEST_ASSERT(closest >= 2.4 && closest <= 5.1, "Pass-by stays 2.5..5 m from the car");
+
+    ChanSim_Script(chanSimWalkAway_c, chanSimHand_c, &rng, &traj);
+    ChanSim_Where(&traj, traj.durationS - 0.01, &x, &y, &hx, &hy, &speed);
+    TEST_ASSERT(hypot(x, y) > 19.0, "Walk-away ends 20 m out");
+
+    TEST_PASS("Scripted walks end where the scenario says");
+}
+
+static void test_channel_statistics(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] RSSI falls with distance, losses and timing as configured\n");
+
+    uint64_t rng = 99u;
+    uint64_t lost = 0u, total = 0u, late = 0u;
+    double aSum[2] = { 0.0, 0.0 };
+    uint32_t aCount[2] = { 0u, 0u };
+    chanSimTrajectory_t traj;
+
+    for (uint32_t r = 0u; r < 200u; r++)
+    {
+        ChanSim_Script(chanSimApproach_c, chanSimHand_c, &rng, &traj);
+        uint32_t n = ChanSim_Generate(&traj, &rng, gaSamples, CHAN_SIM_MAX_SAMPLES);
+
+        for (uint32_t i = 0u; i < n; i++)
+        {
+            total++;
+            if (i > 0u)
+            {
+                TEST_ASSERT(gaSamples[i].tMs > gaSamples[i - 1u].tMs, "Timestamps increase");
+                late += ((gaSamples[i].tMs - gaSamples[i - 1u].tMs) > 150u) ? 1u : 0u;
+            }
+            if (gaSamples[i].rssi == (int8_t)CHAN_SIM_RSSI_INVALID)
+            {
+                lost++;
+                continue;
+            }
+            TEST_ASSERT(gaSamples[i].rssi < 0 && gaSamples[i].rssi >= -100, "Readings within the receiver range");
+            if (gaSamples[i].distM < 1.5f)
+            {
+                aSum[0] += gaSamples[i].rssi;
+                aCount[0]++;
+            }
+            else if (gaSamples[i].distM > 10.0f)
+            {
+                aSum[1] += gaSamples[i].rssi;
+                aCount[1]++;
+            }
+        }
+    }
+
+    double nearDbm = aSum[0] / aCount[0];
+    double farDbm = aSum[1] / aCount[1];
+    tprintf("  near %.1f dBm, far %.1f dBm, lost %.2f%%, late %.2f%%\n", nearDbm, farDbm,
+            (100.0 * lost) / total, (100.0 * late) / total);
+    TEST_ASSERT(aCount[0] > 1000u && aCount[1] > 1000u, "Samples near and far");
+    TEST_ASSERT(nearDbm > -55.0 && nearDbm < -40.0, "About -47 dBm at the door");
+    TEST_ASSERT(farDbm < nearDbm - 15.0, "At least 15 dB weaker beyond 10 m");
+    TEST_ASSERT(lost > total / 50u && lost < total / 10u, "About 3% of reads lost");
+    TEST_ASSERT(late > total / 50u && late < total / 5u, "Some reports arrive late");
+
+    TEST_PASS("RSSI falls with distance, losses and timing as configured");
+}
+
+static void test_body_shadowing(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Walking away through the body costs signal\n");
+
+    uint64_t rng = 5u;
+    double aSum[2] = { 0.0, 0.0 };
+    uint32_t aCount[2] = { 0u, 0u };
+    chanSimTrajectory_t traj;
+
+    /* Same 5..8 m band, facing the car versus walking away with it behind the pocket */
+    for (uint32_t r = 0u; r < 300u; r++)
+    {
+        uint32_t k = r & 1u;
+
+        ChanSim_Script((k == 0u) ? chanSimApproach_c : chanSimWalkAway_c, chanSimPocket_c, &rng, &traj);
+        uint32_t n = ChanSim_Generate(&traj, &rng, gaSamples, CHAN_SIM_MAX_SAMPLES);
+
+        for (uint32_t i = 0u; i < n; i++)
+        {
+            if ((gaSamples[i].rssi != (int8_t)CHAN_SIM_RSSI_INVALID) &&
+                (gaSamples[i].distM > 5.0f) && (gaSamples[i].distM < 8.0f))
+            {
+                aSum[k] += gaSamples[i].rssi;
+                aCount[k]++;
+            }
+        }
+    }
+    tprintf("  facing %.1f dBm, away %.1f dBm\n", aSum[0] / aCount[0], aSum[1] / aCount[1]);
+    TEST_ASSERT((aSum[0] / aCount[0]) - (aSum[1] / aCount[1]) > 8.0, "Body shadowing over 8 dB in a pocket");
+
+    TEST_PASS("Walking away through the body costs signal");
+}
+
+static void test_seeded_runs(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Runs are reproducible from the seed\n");
+
+    chanSimTrajectory_t trajA, trajB;
+    static chanSimSample_t aOther[CHAN_SIM_MAX_SAMPLES];
+    uint32_t nA = ChanSim_Run(3u, 17u, chanSimLoiter_c, chanSimMix_c, &trajA, gaSamples);
+    uint32_t nB = ChanSim_Run(3u, 17u, chanSimLoiter_c, chanSimMix_c, &trajB, aOther);
+
+    TEST_ASSERT(nA == nB && nA > 0u, "Same sample count");
+    TEST_ASSERT(memcmp(gaSamples, aOther, nA * sizeof(chanSimSample_t)) == 0, "Same samples");
+
+    nB = ChanSim_Run(3u, 18u, chanSimLoiter_c, chanSimMix_c, &trajB, aOther);
+    TEST_ASSERT(nA != nB || memcmp(gaSamples, aOther, nA * sizeof(chanSimSample_t)) != 0,
+                "Next run index differs");
+
+    TEST_PASS("Runs are reproducible from the seed");
+}
+
+static void test_threads_match_serial(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Parallel totals equal the serial ones\n");
+
+    static chanSimJob_t serial, parallel;
+
+    InitJob(&serial, 150u, (1u << chanSimScenarioCount_c) - 1u);
+    InitJob(&parallel, 150u, (1u << chanSimScenarioCount_c) - 1u);
+    ChanSim_RunJob(&serial, 1u);
+    ChanSim_RunJob(&parallel, 4u);
+
+    TEST_ASSERT(serial.totals.samples > 0u, "Samples generated");
+    TEST_ASSERT(memcmp(&serial.totals, &parallel.totals, sizeof(serial.totals)) == 0, "Identical totals");
+    TEST_ASSERT(serial.totals.aStats[chanSimPassBy_c][chanSimFilter_c].runs == 150u, "Runs per scenario");
+
+    TEST_PASS("Parallel totals equal the serial ones");
+}
+
+static void test_engine_outcomes(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Both engines unlock on approach and rarely otherwise\n");
+
+    static chanSimJob_t job;
+
+    InitJob(&job, 400u, (1u << chanSimScenarioCount_c) - 1u);
+    ChanSim_RunJob(&job, 4u);
+
+    for (uint32_t e = 0u; e < (uint32_t)chanSimEngineCount_c; e++)
+    {
+        const chanSimStats_t *pApp = &job.totals.aStats[chanSimApproach_c][e];
+        uint64_t falseUnlocks = 0u;
+        uint64_t negatives = 0u;
+
+        for (uint32_t s = chanSimPassBy_c; s < (uint32_t)chanSimScenarioCount_c; s++)
+        {
+            falseUnlocks += job.totals.aStats[s][e].unlockRuns;
+            negatives    += job.totals.aStats[s][e].runs;
+        }
+        tprintf("  %s: approach %.1f%%, p95 %u ms, false %.2f%%\n", gaChanSimEngineNames[e],
+                (100.0 * pApp->unlockRuns) / pApp->runs, ChanSim_Percentile(pApp, 95u),
+                (100.0 * falseUnlocks) / negatives);
+        TEST_ASSERT(pApp->unlockRuns * 10u >= pApp->runs * 7u, "Most approaches unlock");
+        TEST_ASSERT(ChanSim_Percentile(pApp, 50u) > 0u && ChanSim_Percentile(pApp, 95u) < 15000u,
+                    "Unlock within seconds of arrival");
+        TEST_ASSERT(falseUnlocks * 20u < negatives, "Under 5% false unlocks");
+        TEST_ASSERT(job.totals.aStats[chanSimPassBy_c][e].unlockRuns == 0u, "No unlock passing by");
+    }
+
+    TEST_PASS("Both engines unlock on approach and rarely otherwise");
+}
+
+static void test_percentiles(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Latency percentiles from the histogram\n");
+
+    static chanSimStats_t st;
+
+    memset(&st, 0, sizeof(st));
+    TEST_ASSERT(ChanSim_Percentile(&st, 50u) == 0u, "Empty histogram");
+    st.aLatHist[10] = 50u;      /* 200..220 ms */
+    st.aLatHist[100] = 45u;     /* 2000..2020 ms */
+    st.aLatHist[CHAN_SIM_LAT_BINS - 1u] = 5u;
+    TEST_ASSERT(ChanSim_Percentile(&st, 50u) == 220u, "p50");
+    TEST_ASSERT(ChanSim_Percentile(&st, 95u) == 2020u, "p95");
+    TEST_ASSERT(ChanSim_Percentile(&st, 99u) == CHAN_SIM_LAT_BINS * CHAN_SIM_LAT_BIN_MS, "p99 in the overflow bin");
+
+    TEST_PASS("Latency percentiles from the histogram");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "RSSI Channel Simulator Unit Tests (Channel + Seeding + Engines)", &xmlPath);
+
+    RUN_TEST(test_trajectories);
+    RUN_TEST(test_channel_statistics);
+    RUN_TEST(test_body_shadowing);
+    RUN_TEST(test_seeded_runs);
+    RUN_TEST(test_threads_match_serial);
+    RUN_TEST(test_engine_outcomes);
+    RUN_TEST(test_percentiles);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,574 @@
+/*! *********************************************************************************
+* \file test_rssi_filter.c
+*
+* \brief  Unit tests for the example's rssi_filter.c adapter over ProxRssi.
+*         Runs on host machine (macOS/Linux). Builds the real adapter and
+*         engine via #include: engine configuration from the RSSI_* macros,
+*         Idle start-up, the linear alpha law, sparse window stepping, dropped
+*         "not available" readings and decision equivalence with the former
+*         standalone rssi_filter.c pipeline.
+*
+*         The equivalence table below was recorded from the standalone
+*         rssi_filter.c (32 / 40 sample rings, millisecond clock) over the
+*         seeded traces of Trace_Make. The engine rings are sized as shipped
+*         in app_preinclude.h, from RSSI_RAW_CAP / RSSI_SMOOTH_CAP. The adapter
+*         now runs on ProxTime_Now() ticks; the stub clock is set in
+*         microseconds as on the target.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define _DEFAULT_SOURCE
+#define TEST_SUITE_NAME "rssi_filter"
+#include "test_framework.h"
+
+/* As in app_preinclude.h */
+#define PROX_RSSI_RAW_CAP     (32u)
+#define PROX_RSSI_SMOOTH_CAP  (40u)
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Pull in the real adapter and engine
+ ******************************************************************************/
+#include "fsl_component_timer_manager.h"
+#include "ProxRssi.c"
+#include "prox_time.c"
+#include "rssi_filter.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+#define TRACE_COUNT     (96u)
+#define TRACE_MAX_LEN   (600u)
+
+typedef struct
+{
+    uint32_t tMs[TRACE_MAX_LEN];
+    int8_t   rssi[TRACE_MAX_LEN];
+    uint32_t n;
+} trace_t;
+
+typedef struct
+{
+    uint32_t steps;
+    uint32_t candidates;
+    uint32_t unlocks;
+    uint32_t exits;
+    uint32_t hash;
+} traceResult_t;
+
+static trace_t gTrace;
+
+/* The timer manager counts microseconds */
+static void Clock_SetMs(uint32_t ms)
+{
+    gStubTimestamp = (uint64_t)ms * 1000u;
+}
+
+static uint64_t SplitMix(uint64_t *pState)
+{
+    uint64_t z = (*pState += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static int32_t Uniform(uint64_t *pRng, int32_t lo, int32_t hi)
+{
+    return lo + (int32_t)(SplitMix(pRng) % (uint64_t)(hi - lo + 1));
+}
+
+/* Seeded walk: drifting level with noise and spikes, one sample interval per
+ * trace from 10 to 600 ms with jitter, duplicated timestamps, link gaps past
+ * the EMA anomaly limit, and a few traces across the 32-bit millisecond wrap */
+static void Trace_Make(uint32_t idx, trace_t *pT)
+{
+    static const uint32_t aIntervalMs[] = { 10u, 20u, 35u, 50u, 100u, 150u, 250u, 400u, 600u };
+    uint64_t rng = 0x5EEDull + (uint64_t)idx;
+    const uint32_t baseMs = aIntervalMs[idx % (uint32_t)(sizeof(aIntervalMs) / sizeof(aIntervalMs[0]))];
+    uint32_t t = ((idx % 8u) == 7u) ? (0xFFFFFFFFu - (uint32_t)Uniform(&rng, 0, 20000))
+                                     : (uint32_t)Uniform(&rng, 0, 3000);
+    int32_t levelDb = Uniform(&rng, -85, -40);
+    int32_t targetDb = levelDb;
+    const int32_t noiseDb = Uniform(&rng, 0, 6);
+
+    pT->n = (uint32_t)Uniform(&rng, 150, (int32_t)TRACE_MAX_LEN);
+    for (uint32_t i = 0u; i < pT->n; i++)
+    {
+        const uint32_t roll = (uint32_t)Uniform(&rng, 0, 999);
+        int32_t x;
+
+        if ((SplitMix(&rng) % 40u) == 0u)
+        {
+            targetDb = Uniform(&rng, -90, -35);
+        }
+        levelDb += (targetDb > levelDb) ? 1 : ((targetDb < levelDb) ? -1 : 0);
+
+        if (roll < 10u)
+        {
+            t += (uint32_t)Uniform(&rng, 1000, 4000);
+        }
+        else if (roll >= 990u)
+        {
+            /* same timestamp as the previous read */
+        }
+        else
+        {
+            t += (uint32_t)Uniform(&rng, (int32_t)((baseMs * 7u) / 10u), (int32_t)((baseMs * 13u) / 10u));
+        }
+
+        x = levelDb + Uniform(&rng, -noiseDb, noiseDb) + Uniform(&rng, -noiseDb, noiseDb);
+        if ((SplitMix(&rng) % 33u) == 0u)
+        {
+            x += Uniform(&rng, -30, 25);
+        }
+        if ((SplitMix(&rng) % 200u) == 0u)
+        {
+            x = -128;
+        }
+        pT->tMs[i]  = t;
+        pT->rssi[i] = (int8_t)((x > -1) ? -1 : ((x < -128) ? -128 : x));
+    }
+}
+
+static uint32_t Fnv1a(uint32_t h, int32_t v)
+{
+    for (uint32_t b = 0u; b < 4u; b++)
+    {
+        h ^= (uint32_t)(((uint32_t)v >> (8u * b)) & 0xFFu);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* Feed a trace through the public API and digest everything it exposes */
+static void Trace_Run(const trace_t *pT, rssiFilter_t *pFilter, traceResult_t *pR)
+{
+    memset(pR, 0, sizeof(*pR));
+    pR->hash = 2166136261u;
+    RssiFilter_Init(pFilter);
+
+    for (uint32_t i = 0u; i < pT->n; i++)
+    {
+        const rssiState_t before = RssiFilter_GetState(pFilter);
+        rssiState_t after;
+        uint16_t stdQ4 = 0u;
+        uint8_t pct = 0u;
+        int8_t mean = 0;
+
+        Clock_SetMs(pT->tMs[i]);
+        RssiFilter_AddMeasurement(pFilter, pT->rssi[i]);
+        after = RssiFilter_GetState(pFilter);
+        RssiFilter_GetFeatures(pFilter, &stdQ4, &pct, &mean);
+
+        pR->hash = Fnv1a(pR->hash, (int32_t)after);
+        pR->hash = Fnv1a(pR->hash, (int32_t)RssiFilter_GetLastEvent(pFilter));
+        pR->hash = Fnv1a(pR->hash, (int32_t)RssiFilter_HasStateChanged(pFilter));
+        pR->hash = Fnv1a(pR->hash, (int32_t)RssiFilter_GetFilteredRssi(pFilter));
+        pR->hash = Fnv1a(pR->hash, (int32_t)stdQ4);
+        pR->hash = Fnv1a(pR->hash, (int32_t)pct);
+        pR->hash = Fnv1a(pR->hash, (int32_t)mean);
+
+        if (after != before)
+        {
+            pR->candidates += (after == RssiState_Approach_c) ? 1u : 0u;
+            pR->unlocks    += (after == RssiState_Unlocked_c) ? 1u : 0u;
+            pR->exits      += ((after == RssiState_Locked_c) && (before != RssiState_Idle_c)) ? 1u : 0u;
+        }
+        pR->steps++;
+    }
+}
+
+/* Recorded from the standalone rssi_filter.c: steps, candidates, unlocks, exits, digest.
+ * Its windows broke across the 32-bit wrap, so the wrapping traces (idx % 8 == 7)
+ * were recorded shifted back by 2^31 ms, where its arithmetic still held. */
+static const traceResult_t gaGolden[TRACE_COUNT] =
+{
+    { 305u,  1u,  0u,  1u, 0x0D916776u },
+    { 360u,  1u,  0u,  1u, 0xB009ED11u },
+    { 417u,  1u,  0u,  1u, 0x87FCE404u },
+    { 285u,  2u,  1u,  1u, 0xC64BA5ACu },
+    { 190u,  1u,  1u,  0u, 0xCAEFEC94u },
+    { 186u,  1u,  1u,  1u, 0x2396C233u },
+    { 583u,  4u,  3u,  3u, 0x78700063u },
+    { 590u,  4u,  0u,  3u, 0x607399B0u },
+    { 196u,  0u,  0u,  0u, 0x2559F725u },
+    { 497u,  1u,  0u,  1u, 0xF59B8187u },
+    { 559u,  2u,  1u,  1u, 0x2822374Bu },
+    { 287u,  1u,  0u,  1u, 0x32F1BA33u },
+    { 338u,  0u,  0u,  0u, 0x0AF7991Cu },
+    { 384u,  0u,  0u,  0u, 0x12D12E00u },
+    { 226u,  1u,  1u,  0u, 0x23EF8AA3u },
+    { 547u,  1u,  1u,  1u, 0xE19C476Au },
+    { 420u,  1u,  0u,  0u, 0xE7DCB19Cu },
+    { 309u,  1u,  0u,  0u, 0xE21F6944u },
+    { 374u,  1u,  0u,  0u, 0x1DF80F7Du },
+    { 574u,  3u,  0u,  2u, 0xDBCCE665u },
+    { 528u,  1u,  0u,  1u, 0x061920A0u },
+    { 438u,  2u,  2u,  1u, 0x67241AEFu },
+    { 551u,  4u,  0u,  4u, 0xF0E302EDu },
+    { 354u,  2u,  1u,  1u, 0xB3B97371u },
+    { 268u,  1u,  1u,  1u, 0x58626450u },
+    { 205u,  1u,  0u,  1u, 0x7947A5A3u },
+    { 271u,  0u,  0u,  0u, 0xDAE08747u },
+    { 250u,  1u,  0u,  0u, 0x53AF37AAu },
+    { 569u,  2u,  0u,  2u, 0x09003085u },
+    { 591u,  1u,  0u,  0u, 0x2EDE7D52u },
+    { 350u,  1u,  0u,  1u, 0xDD6190E2u },
+    { 182u,  1u,  0u,  1u, 0x0966E69Fu },
+    { 501u,  3u,  2u,  2u, 0xED9C24D2u },
+    { 304u,  1u,  0u,  1u, 0xDEA8F884u },
+    { 217u,  2u,  0u,  1u, 0xD802E4DFu },
+    { 540u,  0u,  0u,  0u, 0x44019D20u },
+    { 152u,  0u,  0u,  0u, 0x171E0EE7u },
+    { 252u,  1u,  0u,  0u, 0x9211E37Eu },
+    { 337u,  0u,  0u,  0u, 0x2EDA2C11u },
+    { 167u,  0u,  0u,  0u, 0xE6DD8F6Bu },
+    { 450u,  1u,  1u,  1u, 0x42D4E62Bu },
+    { 260u,  1u,  1u,  0u, 0xF769CE0Bu },
+    { 155u,  0u,  0u,  0u, 0xB2C56146u },
+    { 282u,  1u,  0u,  0u, 0x32F31178u },
+    { 469u,  0u,  0u,  0u, 0x54B02AE3u },
+    { 150u,  1u,  0u,  0u, 0xBA520E07u },
+    { 338u,  1u,  0u,  1u, 0x62BDCA0Bu },
+    { 565u,  2u,  0u,  1u, 0xE119E0EBu },
+    { 186u,  1u,  1u,  1u, 0xE88A2B19u },
+    { 190u,  1u,  1u,  1u, 0x5300FA8Au },
+    { 486u,  1u,  1u,  1u, 0xD89A3E31u },
+    { 192u,  1u,  1u,  1u, 0x4BFC2BE6u },
+    { 159u,  1u,  0u,  1u, 0x18C4AFEAu },
+    { 471u,  0u,  0u,  0u, 0x6058388Fu },
+    { 532u,  1u,  0u,  1u, 0x092687F1u },
+    { 389u,  2u,  0u,  1u, 0x8EA316C4u },
+    { 380u,  0u,  0u,  0u, 0x5A7B7A8Cu },
+    { 181u,  0u,  0u,  0u, 0x91BB3AAEu },
+    { 511u,  1u,  1u,  0u, 0xFEED5DDEu },
+    { 311u,  2u,  1u,  2u, 0xE95F49F6u },
+    { 566u,  1u,  1u,  1u, 0xCBAE7AC8u },
+    { 566u,  2u,  0u,  2u, 0x3B6FBD03u },
+    { 342u,  0u,  0u,  0u, 0x3CD36C4Fu },
+    { 241u,  1u,  0u,  0u, 0x36459040u },
+    { 491u,  1u,  1u,  1u, 0x1039E14Du },
+    { 437u,  1u,  0u,  1u, 0x5B621F0Bu },
+    { 499u,  2u,  0u,  2u, 0x59D9AE7Du },
+    { 478u,  0u,  0u,  0u, 0xA97A2429u },
+    { 388u,  1u,  1u,  1u, 0x4FA2E39Du },
+    { 462u,  1u,  1u,  1u, 0xB38316CCu },
+    { 518u,  4u,  0u,  3u, 0x95EF5D21u },
+    { 214u,  0u,  0u,  0u, 0xCFD07253u },
+    { 377u,  1u,  0u,  1u, 0x85005D17u },
+    { 590u,  2u,  0u,  2u, 0xF461C83Cu },
+    { 573u,  1u,  1u,  1u, 0xA96BD7D9u },
+    { 343u,  2u,  2u,  1u, 0xEE20A221u },
+    { 502u,  2u,  2u,  1u, 0x67A2B741u },
+    { 585u,  2u,  2u,  1u, 0x63F90484u },
+    { 251u,  1u,  1u,  0u, 0x3E5315C0u },
+    { 189u,  1u,  0u,  1u, 0x07F918CEu },
+    { 348u,  1u,  0u,  0u, 0x01077A23u },
+    { 203u,  1u,  0u,  1u, 0x77540A67u },
+    { 585u,  1u,  0u,  1u, 0x24CDB214u },
+    { 267u,  0u,  0u,  0u, 0x1FF42CEDu },
+    { 351u,  0u,  0u,  0u, 0x40EFDC7Fu },
+    { 290u,  1u,  0u,  1u, 0x08C759CAu },
+    { 592u,  2u,  2u,  2u, 0x9B5BB112u },
+    { 459u,  2u,  2u,  1u, 0x6850F214u },
+    { 592u,  3u,  0u,  3u, 0x261D7576u },
+    { 452u,  1u,  0u,  1u, 0xC14185C7u },
+    { 501u,  1u,  0u,  0u, 0xD01DADACu },
+    { 291u,  1u,  0u,  0u, 0x5BC0686Au },
+    { 312u,  0u,  0u,  0u, 0x73ACF665u },
+    { 158u,  1u,  0u,  0u, 0xCD02C0DFu },
+    { 248u,  1u,  0u,  0u, 0x835F2720u },
+    { 585u,  1u,  1u,  0u, 0x12A2803Cu },
+};
+
+/* Three reads 10 ms apart once per second: one smoothed sample per burst */
+static void Burst(rssiFilter_t *pFilter, uint32_t *pT, int8_t rssi)
+{
+    for (uint32_t k = 0u; k < 3u; k++)
+    {
+        Clock_SetMs(*pT + (k * 10u));
+        RssiFilter_AddMeasurement(pFilter, rssi);
+    }
+    *pT += 1000u;
+}
+
+static void Burst_Engine(ProxRssi_CtxType *pCtx, uint32_t *pT, int8_t rssi, ProxRssi_EventType *pLastEv)
+{
+    ProxRssi_EventType ev;
+
+    for (uint32_t k = 0u; k < 3u; k++)
+    {
+        const uint32_t now = PROX_TIME_MS_TO_TICKS(*pT + (k * 10u));
+
+        (void)ProxRssi_PushRaw(pCtx, now, rssi);
+        (void)ProxRssi_MainFunction(pCtx, now, &ev, NULL);
+        *pLastEv = (ev != PROX_RSSI_EVT_NONE) ? ev : *pLastEv;
+    }
+    *pT += 1000u;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_engine_config(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Engine configured from the RSSI_* macros\n");
+
+    static rssiFilter_t filter;
+    const ProxRssi_ParamsType *pP = &filter.engine.p;
+    int8_t mean = 0;
+
+    RssiFilter_Init(&filter);
+
+    TEST_ASSERT((pP->wRawMs == 1600u) && (pP->wSpikeMs == 800u) && (pP->wFeatMs == 2000u), "Windows");
+    TEST_ASSERT((pP->hampelKQ4 == 48u) && (pP->madEpsQ4 == 8u), "Hampel");
+    TEST_ASSERT((pP->enterNearQ4 == -800) && (pP->exitNearQ4 == -960) && (pP->hystQ4 == 160u), "Thresholds");
+    TEST_ASSERT((pP->pctThQ15 == 16384u) && (pP->stdThQ4 == 40u) && (pP->stableMs == 2000u) &&
+                (pP->minFeatSamples == 6u), "Stability gate");
+    TEST_ASSERT((pP->exitConfirmMs == 1500u) && (pP->lockoutMs == 5000u) && (pP->maxReasonableDtMs == 2000u),
+                "Timers");
+    TEST_ASSERT((pP->stepSparse == TRUE) && (pP->primeFirst == TRUE), "Decision options");
+    TEST_ASSERT((pP->ticksPerMs == PROX_TIME_TICKS_PER_MS) &&
+                (filter.engine.tk.wRaw == PROX_TIME_MS_TO_TICKS(1600u)), "Windows in timebase ticks");
+
+    /* LUT sampled from the ramp for the flight recorder */
+    TEST_ASSERT(filter.engine.alphaQ15[0] == 3277u, "LUT start");
+    TEST_ASSERT(filter.engine.alphaQ15[16] == (uint16_t)(3277u + ((22937u * (256u - 50u)) / 450u)), "LUT 256 ms");
+    TEST_ASSERT(filter.engine.alphaQ15[PROX_RSSI_ALPHA_LUT_SIZE - 1u] == 26214u, "LUT end");
+
+    /* One engine per filter, a few bytes of adapter state on top */
+    TEST_ASSERT(sizeof(rssiFilter_t) <= (sizeof(ProxRssi_CtxType) + 24u), "Single engine footprint");
+
+    RssiFilter_GetFeatures(&filter, NULL, NULL, &mean);
+    TEST_ASSERT(RssiFilter_GetState(&filter) == RssiState_Idle_c, "Idle after init");
+    TEST_ASSERT((RssiFilter_GetFilteredRssi(&filter) == -100) && (mean == -100), "No value before data");
+
+    TEST_PASS("RSSI_* macros map onto the engine parameters");
+}
+
+static void test_idle_primes_first(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] First seeded sample moves Idle -> Locked only\n");
+
+    static rssiFilter_t filter;
+    static ProxRssi_CtxType plain;
+    ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+
+    RssiFilter_Init(&filter);
+    plain = filter.engine;
+    plain.p.primeFirst = FALSE;
+
+    for (uint32_t i = 0u; i < 3u; i++)
+    {
+        Clock_SetMs(1000u + (i * 100u));
+        TEST_ASSERT(RssiFilter_GetState(&filter) == RssiState_Idle_c, "Idle until Hampel has 3 reads");
+        TEST_ASSERT(RssiFilter_HasStateChanged(&filter) == FALSE, "No change while Idle");
+        RssiFilter_AddMeasurement(&filter, -45);
+        (void)ProxRssi_PushRaw(&plain, ProxTime_Now(), -45);
+        (void)ProxRssi_MainFunction(&plain, ProxTime_Now(), &ev, NULL);
+    }
+    TEST_ASSERT(RssiFilter_GetState(&filter) == RssiState_Locked_c, "Locked on the seeding sample");
+    TEST_ASSERT(RssiFilter_HasStateChanged(&filter) == TRUE, "Change flagged");
+    TEST_ASSERT(RssiFilter_HasStateChanged(&filter) == FALSE, "Flag cleared on read");
+    TEST_ASSERT(RssiFilter_GetLastEvent(&filter) == RssiEvent_None_c, "Start-up is not an event");
+    TEST_ASSERT(RssiFilter_GetFilteredRssi(&filter) == -45, "EMA seeded");
+
+    /* Without priming the engine already steps on the seeding sample */
+    TEST_ASSERT((plain.st == PROX_RSSI_ST_CANDIDATE) && (ev == PROX_RSSI_EVT_CANDIDATE_STARTED),
+                "Plain engine starts the candidate one read earlier");
+
+    Clock_SetMs(1300u);
+    RssiFilter_AddMeasurement(&filter, -45);
+    TEST_ASSERT(RssiFilter_GetState(&filter) == RssiState_Approach_c, "Candidate on the next read");
+    TEST_ASSERT(RssiFilter_GetLastEvent(&filter) == RssiEvent_CandidateStarted_c, "CandidateStarted");
+
+    TEST_PASS("Idle -> Locked -> Approach as before");
+}
+
+static void test_alpha_ramp(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Linear alpha law and LUT fallback\n");
+
+    static const uint32_t aDtMs[] = { 1u, 50u, 51u, 100u, 275u, 333u, 499u, 500u, 1999u };
+    static uint16_t aLut[PROX_RSSI_ALPHA_LUT_SIZE];
+    static ProxRssi_CtxType ctx;
+    static rssiFilter_t filter;
+    ProxRssi_ParamsType p;
+    uint32_t exact = 0u;
+
+    RssiFilter_Init(&filter);
+    for (uint32_t i = 0u; i < (uint32_t)(sizeof(aDtMs) / sizeof(aDtMs[0])); i++)
+    {
+        const uint32_t dt = aDtMs[i];
+        const uint32_t want = (dt <= 50u) ? 3277u
+                            : ((dt >= 500u) ? 26214u : (3277u + ((22937u * (dt - 50u)) / 450u)));
+
+        exact += (ProxRssi_AlphaQ15FromDt(&filter.engine, dt) == (uint16_t)want) ? 1u : 0u;
+    }
+    TEST_ASSERT(exact == (uint32_t)(sizeof(aDtMs) / sizeof(aDtMs[0])), "Ramp matches the legacy interpolation");
+
+    /* Default params keep the LUT, which stays mandatory without a ramp */
+    p = filter.engine.p;
+    p.alphaRampHiMs = 0u;
+    for (uint32_t i = 0u; i < PROX_RSSI_ALPHA_LUT_SIZE; i++)
+    {
+        aLut[i] = (uint16_t)(1000u + i);
+    }
+    TEST_ASSERT(ProxRssi_Init(&ctx, &p, NULL, 0u) == E_NOT_OK, "LUT required without ramp");
+    TEST_ASSERT(ProxRssi_Init(&ctx, &p, aLut, PROX_RSSI_ALPHA_LUT_SIZE) == E_OK, "Init with LUT");
+    TEST_ASSERT(ProxRssi_AlphaQ15FromDt(&ctx, 275u) == (uint16_t)(1000u + (275u / PROX_RSSI_ALPHA_LUT_STEP_MS)),
+                "LUT lookup unchanged");
+
+    TEST_PASS("Ramp exact, LUT path unchanged");
+}
+
+static void test_sparse_steps(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Sparse windows still step with the gate closed\n");
+
+    static rssiFilter_t filter;
+    static ProxRssi_CtxType plain;
+    ProxRssi_EventType plainEv = PROX_RSSI_EVT_NONE;
+    uint32_t t = 1000u;
+    uint32_t tNear = t;
+    uint16_t stdQ4 = 0u;
+    uint8_t pct = 100u;
+    bool_t unlocked = FALSE;
+
+    RssiFilter_Init(&filter);
+    plain = filter.engine;
+    plain.p.stepSparse = FALSE;
+    plain.p.primeFirst = FALSE;
+
+    for (uint32_t i = 0u; i < 10u; i++)
+    {
+        Burst(&filter, &tNear, -45);
+        Burst_Engine(&plain, &t, -45, &plainEv);
+        unlocked = (RssiFilter_GetState(&filter) == RssiState_Unlocked_c) ? TRUE : unlocked;
+    }
+    RssiFilter_GetFeatures(&filter, &stdQ4, &pct, NULL);
+    TEST_ASSERT(filter.features.n < RSSI_MIN_FEAT_SAMPLES, "Window below the feature minimum");
+    TEST_ASSERT((stdQ4 == 0xFFFFu) && (pct == 0u), "Gate-closed features");
+    TEST_ASSERT(RssiFilter_GetState(&filter) == RssiState_Approach_c, "Candidate on the last value");
+    TEST_ASSERT(unlocked == FALSE, "Never unlocks on a sparse window");
+
+    for (uint32_t i = 0u; i < 4u; i++)
+    {
+        Burst(&filter, &tNear, -80);
+        Burst_Engine(&plain, &t, -80, &plainEv);
+    }
+    TEST_ASSERT(RssiFilter_GetState(&filter) == RssiState_Locked_c, "Exit confirmed on a sparse window");
+    TEST_ASSERT(RssiFilter_GetLastEvent(&filter) == RssiEvent_ExitToFar_c, "ExitToFar");
+
+    /* ProxRssi default: no decisions below minFeatSamples */
+    TEST_ASSERT((plain.st == PROX_RSSI_ST_FAR) && (plainEv == PROX_RSSI_EVT_NONE), "Plain engine holds FAR");
+
+    TEST_PASS("Legacy sparse stepping, engine default untouched");
+}
+
+static void test_equivalence(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Decisions equal the standalone filter on %u seeded traces\n", TRACE_COUNT);
+
+    static rssiFilter_t filter;
+    traceResult_t r;
+    traceResult_t sum;
+    uint32_t same = 0u;
+
+    TEST_ASSERT((PROX_RSSI_RAW_CAP == RSSI_RAW_CAP) && (PROX_RSSI_SMOOTH_CAP == RSSI_SMOOTH_CAP),
+                "Engine rings at the shipped RSSI_* capacities");
+
+    memset(&sum, 0, sizeof(sum));
+    for (uint32_t i = 0u; i < TRACE_COUNT; i++)
+    {
+        Trace_Make(i, &gTrace);
+        Trace_Run(&gTrace, &filter, &r);
+        if (memcmp(&r, &gaGolden[i], sizeof(r)) == 0)
+        {
+            same++;
+        }
+        else
+        {
+            tprintf("  trace %u: steps %u cand %u unl %u exit %u hash 0x%08X\n",
+                    i, r.steps, r.candidates, r.unlocks, r.exits, r.hash);
+        }
+        sum.steps      += r.steps;
+        sum.candidates += r.candidates;
+        sum.unlocks    += r.unlocks;
+        sum.exits      += r.exits;
+    }
+    tprintf("  %u steps, %u candidates, %u unlocks, %u exits\n", sum.steps, sum.candidates, sum.unlocks, sum.exits);
+
+    TEST_ASSERT((sum.unlocks > 0u) && (sum.exits > 0u), "Traces exercise every transition");
+    TEST_ASSERT(same == TRACE_COUNT, "Every trace matches the recorded digest");
+
+    TEST_PASS("State, events, EMA and features unchanged");
+}
+
+static void test_not_available_dropped(void)
+{
+    gTestsTotal++;
+    tprintf("\n[TEST] Not available and non-negative reads are dropped\n");
+
+    static const int8_t aBad[] = { 127, 0, 5, 20 };
+    static rssiFilter_t filter;
+    static rssiFilter_t before;
+    uint16_t rawCount;
+
+    RssiFilter_Init(&filter);
+    for (uint32_t i = 0u; i < 8u; i++)
+    {
+        Clock_SetMs(1000u + (i * 100u));
+        RssiFilter_AddMeasurement(&filter, -70);
+    }
+    (void)RssiFilter_HasStateChanged(&filter);
+    before   = filter;
+    rawCount = filter.engine.raw.count;
+
+    for (uint32_t i = 0u; i < (uint32_t)sizeof(aBad); i++)
+    {
+        Clock_SetMs(1800u + (i * 100u));
+        RssiFilter_AddMeasurement(&filter, aBad[i]);
+    }
+    TEST_ASSERT(memcmp(&filter, &before, sizeof(filter)) == 0, "Filter untouched");
+    TEST_ASSERT(RssiFilter_HasStateChanged(&filter) == FALSE, "No state change");
+
+    Clock_SetMs(2300u);
+    RssiFilter_AddMeasurement(&filter, -128);
+    TEST_ASSERT(filter.engine.raw.count == (uint16_t)(rawCount + 1u), "-128 accepted");
+    TEST_ASSERT(filter.engine.raw.rssiDbm[(filter.engine.raw.head + RSSI_RAW_CAP - 1u) % RSSI_RAW_CAP] == -127,
+                "-128 clamped to -127");
+
+    TEST_PASS("Invalid reads do not reach the pipeline");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "RssiFilter Unit Tests (Adapter over ProxRssi)", &xmlPath);
+
+    RUN_TEST(test_engine_config);
+    RUN_TEST(test_idle_primes_first);
+    RUN_TEST(test_alpha_ramp);
+    RUN_TEST(test_sparse_steps);
+    RUN_TEST(test_equivalence);
+    RUN_TEST(test_not_available_dropped);
+
+    return Test_End(xmlPath);
+}
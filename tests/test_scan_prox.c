@@ -0,0 +1,291 @@
+/*! *********************************************************************************
+* \file test_scan_prox.c
+*
+* \brief  Unit tests for ScanProx — proximity of bonded peers from their
+*         advertising before the connection, and ProxRssi_Handover.
+*         Runs on host machine (macOS/Linux). Tests the real scan_prox.c and
+*         ProxRssi.c via #include: instance table, held-back unlock, handover
+*         freshness, and connect-to-unlock latency against the cold start.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "scan_prox"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#include "ProxRssi.c"
+#include "scan_prox.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+#define MS(ms)          PROX_TIME_MS_TO_TICKS(ms)
+#define ADV_MS          (150u)      /* Phone advertising interval */
+#define LINK_MS         (100u)      /* Gap_ReadRssi period */
+#define STABLE_MS       (2000u)
+
+static ProxRssi_ParamsType gParams;
+static ProxRssi_CtxType gLink;
+static uint16_t gaLut[1001];
+static uint32_t gLcg;
+
+/* Same parameters and LUT as rssi_integration.c (prox_rssi_params.h), tick clock */
+static void Init(void)
+{
+    memset(&gParams, 0, sizeof(gParams));
+    gParams.wRawMs = 2000u;  gParams.wSpikeMs = 800u;  gParams.wFeatMs = 2000u;
+    gParams.hampelKQ4 = 40u; gParams.madEpsQ4 = 8u;
+    gParams.enterNearQ4 = ProxRssi_DbmToQ4(-50);
+    gParams.exitNearQ4  = ProxRssi_DbmToQ4(-60);
+    gParams.hystQ4      = (uint16_t)ProxRssi_DbToQ4(10);
+    gParams.pctThQ15 = 13107u; gParams.stdThQ4 = 128u; gParams.stableMs = STABLE_MS; gParams.minFeatSamples = 6u;
+    gParams.exitConfirmMs = 1500u; gParams.lockoutMs = 5000u; gParams.maxReasonableDtMs = 2000u;
+    gParams.ticksPerMs = (uint16_t)PROX_TIME_TICKS_PER_MS;
+
+    for (uint32_t i = 0u; i < 1001u; i++)
+    {
+        gaLut[i] = (uint16_t)(1638u + ((i * 8192u) / 1000u));
+    }
+    ScanProx_Init(&gParams, gaLut, 1001u);
+    (void)ProxRssi_Init(&gLink, &gParams, gaLut, 1001u);
+}
+
+static int8_t Noise(int32_t mean, uint32_t spread)
+{
+    gLcg = (gLcg * 1103515245u) + 12345u;
+    return (int8_t)(mean + (int32_t)((gLcg >> 16) % (2u * spread + 1u)) - (int32_t)spread);
+}
+
+/* n advertising reports of a peer from *pT; returns the events seen, as a bit mask */
+static uint32_t Scan(uint8_t nvmIndex, uint32_t *pT, uint32_t n, int32_t mean, uint32_t spread)
+{
+    uint32_t events = 0u;
+
+    for (uint32_t i = 0u; i < n; i++)
+    {
+        *pT += MS(ADV_MS);
+        events |= 1u << (uint32_t)ScanProx_Report(nvmIndex, Noise(mean, spread), *pT);
+    }
+    return events;
+}
+
+/* n link samples from *pT; returns the sample index of the first unlock, n if none */
+static uint32_t Link(uint32_t *pT, uint32_t n, int32_t mean, uint32_t spread)
+{
+    ProxRssi_EventType ev;
+    uint32_t unlockAt = n;
+
+    for (uint32_t i = 0u; i < n; i++)
+    {
+        *pT += MS(LINK_MS);
+        (void)ProxRssi_PushRaw(&gLink, *pT, Noise(mean, spread));
+        (void)ProxRssi_MainFunction(&gLink, *pT, &ev, NULL);
+        if ((ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED) && (unlockAt == n))
+        {
+            unlockAt = i;
+        }
+    }
+    return unlockAt;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_instances(void)
+{
+    scanProxStats_t stats;
+    uint32_t t = 1000u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Instances per bond, invalid reports, eviction\n");
+
+    gLcg = 1u;
+    Init();
+
+    TEST_ASSERT(ScanProx_Report(0u, 127, t) == PROX_RSSI_EVT_NONE, "RSSI not available ignored");
+    TEST_ASSERT(ScanProx_Report(0u, 3, t) == PROX_RSSI_EVT_NONE, "Positive RSSI ignored");
+    ScanProx_GetStats(&stats);
+    TEST_ASSERT((stats.invalid == 2u) && (stats.tracked == 0u), "Nothing followed");
+
+    (void)Scan(3u, &t, 20u, -75, 2u);
+    (void)Scan(5u, &t, 20u, -45, 1u);
+    ScanProx_GetStats(&stats);
+    TEST_ASSERT((stats.tracked == 2u) && (stats.reports == 40u), "Two peers followed");
+    TEST_ASSERT(ScanProx_GetState(3u) == PROX_RSSI_ST_FAR, "Far peer");
+    TEST_ASSERT(ScanProx_GetState(5u) == PROX_RSSI_ST_CANDIDATE, "Near peer");
+    TEST_ASSERT(ScanProx_GetState(7u) == PROX_RSSI_ST_FAR, "Unknown peer reads FAR");
+
+    /* Third bond: the peer not heard from for the longest time gives way */
+    (void)Scan(5u, &t, 1u, -45, 1u);
+    (void)Scan(7u, &t, 1u, -80, 1u);
+    ScanProx_GetStats(&stats);
+    TEST_ASSERT((stats.tracked == SCAN_PROX_PEERS) && (stats.evictions == 1u), "Evicted");
+    TEST_ASSERT(ScanProx_GetState(5u) == PROX_RSSI_ST_CANDIDATE, "Recent peer kept");
+    TEST_ASSERT(ScanProx_Handover(3u, t, &gLink) == FALSE, "Evicted peer forgotten");
+
+    TEST_PASS("Instances per bond, invalid reports, eviction");
+}
+
+static void test_no_unlock_without_link(void)
+{
+    uint32_t t = 1000u;
+    uint32_t events;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Scan holds CANDIDATE, lockout only after SCAN_PROX_HOLD_MS\n");
+
+    gLcg = 2u;
+    Init();
+
+    events = Scan(1u, &t, (SCAN_PROX_HOLD_MS / ADV_MS) - 20u, -45, 1u);
+    TEST_ASSERT((events & (1u << PROX_RSSI_EVT_CANDIDATE_STARTED)) != 0u, "Approach seen");
+    TEST_ASSERT((events & (1u << PROX_RSSI_EVT_UNLOCK_TRIGGERED)) == 0u, "No unlock on advertising");
+    TEST_ASSERT(ScanProx_GetState(1u) == PROX_RSSI_ST_CANDIDATE, "Still holding");
+
+    events = Scan(1u, &t, 40u, -45, 1u);
+    TEST_ASSERT(ScanProx_GetState(1u) == PROX_RSSI_ST_LOCKOUT, "Parked at the car: lockout");
+
+    /* Handed over in lockout: no unlock at connection */
+    t += MS(ADV_MS);
+    TEST_ASSERT(ScanProx_Handover(1u, t, &gLink) == TRUE, "Handed over");
+    TEST_ASSERT(gLink.st == PROX_RSSI_ST_LOCKOUT, "Lockout carried over");
+    TEST_ASSERT(Link(&t, 30u, -45, 1u) == 30u, "No unlock");
+
+    TEST_PASS("Scan holds CANDIDATE, lockout only after SCAN_PROX_HOLD_MS");
+}
+
+static void test_handover_freshness(void)
+{
+    scanProxStats_t stats;
+    uint32_t t = 1000u;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Only a fresh history is handed over, once\n");
+
+    gLcg = 3u;
+    Init();
+
+    (void)Scan(2u, &t, 30u, -45, 1u);
+    TEST_ASSERT(ScanProx_Handover(2u, t + MS(SCAN_PROX_HANDOVER_MS), &gLink) == FALSE, "Too old");
+    TEST_ASSERT((gLink.emaValid == FALSE) && (gLink.st == PROX_RSSI_ST_FAR), "Link context left cold");
+    TEST_ASSERT(ScanProx_GetState(2u) == PROX_RSSI_ST_FAR, "Peer forgotten by the scan");
+
+    (void)Scan(2u, &t, 30u, -45, 1u);
+    TEST_ASSERT(ScanProx_Handover(2u, t + MS(ADV_MS), &gLink) == TRUE, "Fresh");
+    TEST_ASSERT((gLink.emaValid == TRUE) && (gLink.smooth.count > 0u), "EMA and samples carried");
+    TEST_ASSERT(ScanProx_Handover(2u, t + MS(ADV_MS), &gLink) == FALSE, "Used once");
+    TEST_ASSERT(ScanProx_Handover(9u, t, &gLink) == FALSE, "Peer never seen");
+
+    ScanProx_GetStats(&stats);
+    TEST_ASSERT((stats.handovers == 1u) && (stats.misses == 3u) && (stats.tracked == 0u), "Counters");
+
+    TEST_PASS("Only a fresh history is handed over, once");
+}
+
+static void test_handover_credit(void)
+{
+    ProxRssi_SnapshotType snap;
+    uint32_t t = 1000u;
+    uint32_t held;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] ProxRssi_Handover credits the hold in full, up to stableMs\n");
+
+    gLcg = 4u;
+    Init();
+
+    (void)Scan(4u, &t, 18u, -45, 1u);
+    TEST_ASSERT(ScanProx_GetState(4u) == PROX_RSSI_ST_CANDIDATE, "Candidate");
+    (void)ProxRssi_Snapshot(&gaScanProxPeer[0].ctx, &snap);
+    held = snap.candidateMs;
+    TEST_ASSERT((held > MS(STABLE_MS / 2u)) && (held < MS(STABLE_MS)), "Held between stableMs / 2 and stableMs");
+
+    TEST_ASSERT(ProxRssi_Restore(&gLink, t + 1u, &snap, SCAN_PROX_HANDOVER_MS) == E_OK, "Restore");
+    TEST_ASSERT((t + 1u) - gLink.tCandidateStartMs == MS(STABLE_MS / 2u), "Restore caps at stableMs / 2");
+
+    TEST_ASSERT(ProxRssi_Handover(&gLink, t + 1u, &snap, SCAN_PROX_HANDOVER_MS) == E_OK, "Handover");
+    TEST_ASSERT((t + 1u) - gLink.tCandidateStartMs == held, "Handover keeps the whole hold");
+
+    (void)Scan(4u, &t, 30u, -45, 1u);
+    (void)ProxRssi_Snapshot(&gaScanProxPeer[0].ctx, &snap);
+    TEST_ASSERT(snap.candidateMs > MS(STABLE_MS), "Held past stableMs");
+    TEST_ASSERT(ProxRssi_Handover(&gLink, t + 1u, &snap, SCAN_PROX_HANDOVER_MS) == E_OK, "Handover");
+    TEST_ASSERT((t + 1u) - gLink.tCandidateStartMs == MS(STABLE_MS), "Capped at stableMs");
+
+    TEST_ASSERT(ProxRssi_Handover(NULL, t, &snap, SCAN_PROX_HANDOVER_MS) == E_NOT_OK, "NULL-safe");
+
+    TEST_PASS("ProxRssi_Handover credits the hold in full, up to stableMs");
+}
+
+static void test_connect_latency(void)
+{
+    uint32_t warmSum = 0u;
+    uint32_t coldSum = 0u;
+    uint32_t warmMax = 0u;
+    uint32_t trial;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Walk-up: connect-to-unlock with the scan handover vs cold start\n");
+
+    for (trial = 0u; trial < 20u; trial++)
+    {
+        uint32_t t = 1000u;
+        uint32_t connectAt;
+        uint32_t warm;
+        uint32_t cold;
+
+        /* Walking up, then at the door for 7 to 9.9 s before the phone connects */
+        gLcg = 100u + trial;
+        Init();
+        (void)Scan(6u, &t, 20u, -72, 3u);
+        (void)Scan(6u, &t, 47u + trial, -44, 3u);
+        TEST_ASSERT(ScanProx_GetState(6u) == PROX_RSSI_ST_CANDIDATE, "Seen near by the scan");
+        connectAt = t + MS(40u);
+
+        t = connectAt;
+        (void)ScanProx_Handover(6u, t, &gLink);
+        warm = Link(&t, 60u, -44, 3u);
+
+        gLcg = 100u + trial;
+        Init();
+        t = connectAt;
+        cold = Link(&t, 60u, -44, 3u);
+
+        TEST_ASSERT((warm < 60u) && (cold < 60u), "Both unlock");
+        warmSum += warm;
+        coldSum += cold;
+        warmMax = (warm > warmMax) ? warm : warmMax;
+    }
+
+    tprintf("  connect to unlock: handover %u ms (max %u ms), cold %u ms\n",
+            (unsigned)((warmSum * LINK_MS) / 20u), (unsigned)(warmMax * LINK_MS),
+            (unsigned)((coldSum * LINK_MS) / 20u));
+    TEST_ASSERT(warmMax * LINK_MS <= 500u, "Unlock within 500 ms of the link");
+    TEST_ASSERT((warmSum * 5u) <= coldSum, "5x faster on average");
+
+    TEST_PASS("Walk-up: connect-to-unlock with the scan handover vs cold start");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "ScanProx Unit Tests (Instances + Hold + Handover)", &xmlPath);
+
+    RUN_TEST(test_instances);
+    RUN_TEST(test_no_unlock_without_link);
+    RUN_TEST(test_handover_freshness);
+    RUN_TEST(test_handover_credit);
+    RUN_TEST(test_connect_latency);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,213 @@
+/*! *********************************************************************************
+* \file test_unlock_path.c
+*
+* \brief  Unit tests for UnlockPath — connect to unlock milestones of Passive
+*         Entry. Runs on host machine (macOS/Linux). Tests the real unlock_path.c:
+*         phase durations with skipped and early milestones, connections lost
+*         before the unlock, rolling window percentiles, clock wrap and two
+*         devices at once.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#define TEST_SUITE_NAME "unlock_path"
+#include "test_framework.h"
+
+/*******************************************************************************
+ * Pull in the real implementation
+ ******************************************************************************/
+#define UNLOCK_PATH_MAX_DEVICES         (2u)
+#define UNLOCK_PATH_WINDOW              (10u)
+#include "unlock_path.c"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+/* Bonded phone: no service discovery, first RSSI before CS starts */
+static void PassiveEntry(uint8_t dev, uint32_t t0, uint32_t candidateMs)
+{
+    UnlockPath_Mark(dev, unlockPathConnected_c, t0);
+    UnlockPath_Mark(dev, unlockPathEncrypted_c, t0 + 60u);
+    UnlockPath_Mark(dev, unlockPathReady_c, t0 + 61u);
+    UnlockPath_Mark(dev, unlockPathFirstRssi_c, t0 + 100u);
+    UnlockPath_Mark(dev, unlockPathCsConfig_c, t0 + 140u);
+    UnlockPath_Mark(dev, unlockPathCsStarted_c, t0 + 180u);
+    UnlockPath_Mark(dev, unlockPathCandidate_c, t0 + candidateMs);
+    UnlockPath_Mark(dev, unlockPathUnlock_c, t0 + candidateMs + 300u);
+}
+
+static uint32_t PhaseP50(unlockPathMilestone_t m)
+{
+    unlockPathStats_t st;
+    (void)UnlockPath_GetStats(m, &st);
+    return st.p50Ms;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static void test_phases(void)
+{
+    uint32_t aOffset[unlockPathMilestoneCount_c];
+    unlockPathStats_t st;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Phase durations, skipped and early milestones\n");
+
+    UnlockPath_Init();
+    PassiveEntry(0u, 5000u, 900u);
+
+    TEST_ASSERT(PhaseP50(unlockPathEncrypted_c) == 60u, "Encryption from connect");
+    TEST_ASSERT(UnlockPath_GetStats(unlockPathServiceDisc_c, &st) == FALSE, "No service discovery phase");
+    TEST_ASSERT(PhaseP50(unlockPathReady_c) == 1u, "Ready from encryption, skipping service discovery");
+    TEST_ASSERT(PhaseP50(unlockPathCsConfig_c) == 79u, "CS config from Ready");
+    TEST_ASSERT(PhaseP50(unlockPathCsStarted_c) == 40u, "CS start from CS config");
+    TEST_ASSERT(PhaseP50(unlockPathFirstRssi_c) == 39u, "Early RSSI from Ready");
+    TEST_ASSERT(PhaseP50(unlockPathCandidate_c) == 800u, "Candidate from the first RSSI, not from the later CS start");
+    TEST_ASSERT(PhaseP50(unlockPathUnlock_c) == 300u, "Unlock from candidate");
+    TEST_ASSERT(PhaseP50(unlockPathConnected_c) == 1200u, "Connect to unlock");
+
+    TEST_ASSERT(UnlockPath_GetTimeline(0u, aOffset) == TRUE, "Timeline");
+    TEST_ASSERT((aOffset[unlockPathConnected_c] == 0u) && (aOffset[unlockPathUnlock_c] == 1200u), "Offsets from connect");
+    TEST_ASSERT(aOffset[unlockPathServiceDisc_c] == UNLOCK_PATH_NOT_REACHED, "Skipped milestone not reached");
+
+    /* Repeats and milestones after the unlock are not counted */
+    UnlockPath_Mark(0u, unlockPathCandidate_c, 7000u);
+    UnlockPath_Mark(0u, unlockPathUnlock_c, 7500u);
+    UnlockPath_Mark(0u, unlockPathServiceDisc_c, 7600u);
+    (void)UnlockPath_GetStats(unlockPathUnlock_c, &st);
+    TEST_ASSERT(st.count == 1u, "One unlock per connection");
+    TEST_ASSERT(UnlockPath_GetStats(unlockPathServiceDisc_c, &st) == FALSE, "Nothing after the unlock");
+
+    /* Before a connection, or out of range: ignored */
+    UnlockPath_Mark(1u, unlockPathEncrypted_c, 100u);
+    UnlockPath_Mark(UNLOCK_PATH_MAX_DEVICES, unlockPathConnected_c, 100u);
+    TEST_ASSERT(UnlockPath_GetTimeline(1u, aOffset) == FALSE, "No timeline without a connection");
+    (void)UnlockPath_GetStats(unlockPathEncrypted_c, &st);
+    TEST_ASSERT(st.count == 1u, "Not counted");
+
+    TEST_PASS("Phase durations, skipped and early milestones");
+}
+
+static void test_lost(void)
+{
+    unlockPathStats_t st;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Connections lost before the unlock\n");
+
+    UnlockPath_Init();
+
+    /* Lost before encryption three times; once when walking away after the candidate */
+    UnlockPath_Mark(0u, unlockPathConnected_c, 0u);
+    UnlockPath_Disconnected(0u);
+    UnlockPath_Mark(0u, unlockPathConnected_c, 1000u);
+    UnlockPath_Mark(0u, unlockPathConnected_c, 2000u);       /* Disconnect not seen */
+    PassiveEntry(0u, 3000u, 800u);
+    UnlockPath_Disconnected(0u);
+    UnlockPath_Mark(0u, unlockPathConnected_c, 9000u);
+    UnlockPath_Mark(0u, unlockPathEncrypted_c, 9050u);
+    UnlockPath_Mark(0u, unlockPathCandidate_c, 9500u);
+    UnlockPath_Disconnected(0u);
+    UnlockPath_Disconnected(0u);
+
+    (void)UnlockPath_GetStats(unlockPathConnected_c, &st);
+    TEST_ASSERT(st.ended == 3u, "Three lost before encryption");
+    TEST_ASSERT(st.count == 1u, "One connect to unlock");
+    (void)UnlockPath_GetStats(unlockPathCandidate_c, &st);
+    TEST_ASSERT((st.ended == 1u) && (st.count == 2u), "One lost at candidate");
+    TEST_ASSERT(PhaseP50(unlockPathCandidate_c) == 450u, "Candidate from encryption when nothing between");
+    (void)UnlockPath_GetStats(unlockPathUnlock_c, &st);
+    TEST_ASSERT(st.ended == 0u, "An unlocked connection is not lost");
+
+    UnlockPath_Reset();
+    TEST_ASSERT(UnlockPath_GetStats(unlockPathConnected_c, &st) == FALSE, "Reset clears");
+
+    TEST_PASS("Connections lost before the unlock");
+}
+
+static void test_window(void)
+{
+    unlockPathStats_t st;
+    uint32_t i;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Rolling window percentiles\n");
+
+    UnlockPath_Init();
+
+    /* 10 slow candidates, then 10 fast ones push them out */
+    for (i = 0u; i < 10u; i++)
+    {
+        PassiveEntry(0u, i * 10000u, 5000u + (i * 100u));
+    }
+    (void)UnlockPath_GetStats(unlockPathConnected_c, &st);
+    tprintf("    slow: p50 %u p90 %u max %u ms\n", st.p50Ms, st.p90Ms, st.maxMs);
+    TEST_ASSERT((st.window == 10u) && (st.p50Ms == 5700u) && (st.p90Ms == 6100u) && (st.maxMs == 6200u),
+                "Nearest rank on the window");
+
+    for (i = 0u; i < 9u; i++)
+    {
+        PassiveEntry(0u, 200000u + (i * 10000u), 1000u + i);
+    }
+    (void)UnlockPath_GetStats(unlockPathConnected_c, &st);
+    tprintf("    mixed: p50 %u p90 %u max %u ms\n", st.p50Ms, st.p90Ms, st.maxMs);
+    TEST_ASSERT((st.p50Ms == 1304u) && (st.p90Ms == 1308u) && (st.maxMs == 6200u), "One slow left");
+
+    PassiveEntry(0u, 400000u, 1000u);
+    (void)UnlockPath_GetStats(unlockPathConnected_c, &st);
+    TEST_ASSERT((st.count == 20u) && (st.window == 10u) && (st.maxMs == 1308u), "Slow ones rolled out");
+
+    TEST_PASS("Rolling window percentiles");
+}
+
+static void test_wrap_devices(void)
+{
+    uint32_t aOffset[unlockPathMilestoneCount_c];
+    unlockPathStats_t st;
+
+    gTestsTotal++;
+    tprintf("\n[TEST] Clock wrap, two devices at once\n");
+
+    UnlockPath_Init();
+
+    UnlockPath_Mark(0u, unlockPathConnected_c, 0xFFFFFF00u);
+    UnlockPath_Mark(1u, unlockPathConnected_c, 0xFFFFFF80u);
+    UnlockPath_Mark(0u, unlockPathEncrypted_c, 0x00000010u);
+    UnlockPath_Mark(1u, unlockPathEncrypted_c, 0x00000020u);
+    UnlockPath_Mark(1u, unlockPathUnlock_c, 0x00000400u);
+
+    (void)UnlockPath_GetStats(unlockPathEncrypted_c, &st);
+    TEST_ASSERT((st.count == 2u) && (st.p50Ms == 0xA0u) && (st.maxMs == 0x110u), "Across the wrap, per device");
+    TEST_ASSERT(PhaseP50(unlockPathConnected_c) == 0x480u, "Device 1 connect to unlock");
+    (void)UnlockPath_GetTimeline(0u, aOffset);
+    TEST_ASSERT((aOffset[unlockPathEncrypted_c] == 0x110u) && (aOffset[unlockPathUnlock_c] == UNLOCK_PATH_NOT_REACHED),
+                "Device 0 still on its way");
+
+    /* Timeline kept after the disconnect */
+    UnlockPath_Disconnected(1u);
+    TEST_ASSERT((UnlockPath_GetTimeline(1u, aOffset) == TRUE) && (aOffset[unlockPathUnlock_c] == 0x480u),
+                "Last timeline kept");
+
+    TEST_PASS("Clock wrap, two devices at once");
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *xmlPath;
+
+    Test_Begin(argc, argv, "UnlockPath Unit Tests (Phases + Lost + Window)", &xmlPath);
+
+    RUN_TEST(test_phases);
+    RUN_TEST(test_lost);
+    RUN_TEST(test_window);
+    RUN_TEST(test_wrap_devices);
+
+    return Test_End(xmlPath);
+}
@@ -0,0 +1,413 @@
+/*! *********************************************************************************
+* \file adv_sched_sim.c
+*
+* \brief  Discovery latency against advertising duty cycle for the profiles of
+*         adv_sched.c, and a day of Passive Entry with the scheduler driving them.
+*
+*         Discovery model, per run:
+*           - the car advertises every interval plus a 0..10 ms advDelay, one
+*             legacy packet on 37, 38 and 39 per event (ADV_SIM_LEGACY_US of
+*             air each, ADV_SIM_CH_GAP_US apart)
+*           - the phone scans one channel per window, 37, 38, 39 in turn,
+*             with the window and interval of its scan mode and a random phase
+*           - a packet is received when it lies inside a window on its channel
+*             and is not lost (-l, default 10 %)
+*           - the LE Coded set only costs air time here: the scan modes model
+*             phones scanning 1M
+*
+*         Radio duty is the air time of the advertising events per second,
+*         the LE Coded event is ADV_EXT_IND on three channels plus AUX_ADV_IND,
+*         S2. Average current is the duty times ADV_SIM_TX_MA.
+*
+*         The day replays a scripted day (disconnects, unlocks, approaches) on
+*         the real adv_sched.c, one second at a time, against the static CCC
+*         intervals on both sets: radio time per day and discovery latency at
+*         each approach.
+*
+*         Build:  cc -std=c11 -O2 -I kw47_keyless_entry -I libs/middleware/wireless/framework/Common \
+*                    -o tools/adv_sched_sim tools/adv_sched_sim.c -lm
+*
+*         Usage:  adv_sched_sim [-n runs] [-S seed] [-l loss%] [-m mode] [-d]
+*
+*           -n runs     runs per profile and scan mode (default 20000)
+*           -S seed     base seed (default 1)
+*           -l pct      packet loss in percent (default 10)
+*           -m mode     fg, balanced, lowpower, ios or all (default)
+*           -d          only the day
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE             /* getopt */
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "adv_sched.h"
+#include "adv_sched.c"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define ADV_SIM_LEGACY_US           (376u)      /* 31 byte ADV_IND at 1M */
+#define ADV_SIM_CH_GAP_US           (560u)      /* Packet plus SCAN_REQ/CONNECT_IND listen */
+#define ADV_SIM_CODED_EVENT_US      (2900u)     /* 3 x ADV_EXT_IND + AUX_ADV_IND, S2 */
+#define ADV_SIM_DELAY_MAX_US        (10000u)    /* advDelay */
+#define ADV_SIM_HORIZON_US          (120000000u)
+#define ADV_SIM_TX_MA               (5.0)
+#define ADV_SIM_UNITS_US(u)         ((uint32_t)(u) * 625u)
+#define ADV_SIM_STATIC              (advSchedLevelCount_c)  /* CCC intervals, both sets, always */
+#define ADV_SIM_PROFILES            (advSchedLevelCount_c + 1u)
+#define ADV_SIM_MAX_RUNS            (1000000u)
+
+/* CCC intervals of the example, app_preinclude.h */
+static const uint16_t gcAdvSimCccLegacy = 68u;
+static const uint16_t gcAdvSimCccCoded = 135u;
+
+typedef enum
+{
+    advSimFg_c = 0,             /* Android low latency, app in foreground */
+    advSimBalanced_c,           /* Android balanced */
+    advSimLowPower_c,           /* Android low power, background */
+    advSimIos_c,                /* iOS background, approximated */
+    advSimModeCount_c
+} advSimMode_t;
+
+typedef struct
+{
+    uint32_t windowUs;
+    uint32_t intervalUs;
+} advSimScan_t;
+
+typedef struct
+{
+    uint16_t minInterval;
+    uint16_t maxInterval;
+    uint16_t codedInterval;
+} advSimAdv_t;
+
+typedef struct
+{
+    double   meanMs;
+    uint32_t p50Ms;
+    uint32_t p95Ms;
+    uint32_t p99Ms;
+    uint32_t missed;            /* Not found within ADV_SIM_HORIZON_US */
+} advSimLatency_t;
+
+typedef enum
+{
+    advSimEvtDisconnect_c = 0,  /* Owner walks away */
+    advSimEvtApproach_c,        /* Owner back in range, connects, unlocks */
+    advSimEvtEnd_c
+} advSimEvtType_t;
+
+typedef struct
+{
+    uint32_t        atS;
+    advSimEvtType_t type;
+} advSimEvt_t;
+
+typedef struct
+{
+    double   radioS[2];         /* Static, scheduled */
+    uint32_t approaches;
+    uint32_t aLatencyMs[2][16];
+    advSchedLevel_t aLevel[16];
+} advSimDay_t;
+
+static const char *const gaAdvSimModeNames[advSimModeCount_c] = {"fg", "balanced", "lowpower", "ios"};
+static const char *const gaAdvSimProfileNames[ADV_SIM_PROFILES] = {"FAST", "ACTIVE", "REDUCED", "PARKED", "static"};
+
+static const advSimScan_t gaAdvSimScan[advSimModeCount_c] =
+{
+    {5000000u, 5000000u},
+    {1024000u, 4096000u},
+    { 512000u, 5120000u},
+    {  30000u,  300000u},
+};
+
+/* Parked at 18:00, forgotten bag at 18:03, home overnight, commute, lunch */
+static const advSimEvt_t gaAdvSimDayScript[] =
+{
+    {    0u, advSimEvtDisconnect_c},
+    {  180u, advSimEvtApproach_c},
+    {  420u, advSimEvtDisconnect_c},
+    {48600u, advSimEvtApproach_c},      /* 07:30 */
+    {50400u, advSimEvtDisconnect_c},    /* 08:00, at work */
+    {64800u, advSimEvtApproach_c},      /* 12:00 */
+    {68400u, advSimEvtDisconnect_c},
+    {68460u, advSimEvtApproach_c},      /* Walked away, turned back after a minute */
+    {86400u, advSimEvtEnd_c},
+};
+
+/*******************************************************************************
+ * Discovery
+ ******************************************************************************/
+
+static uint64_t AdvSim_Next(uint64_t *pState)
+{
+    uint64_t z = (*pState += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint32_t AdvSim_Uniform(uint64_t *pState, uint32_t n)
+{
+    return (n == 0u) ? 0u : (uint32_t)(AdvSim_Next(pState) % n);
+}
+
+static void AdvSim_Profile(uint32_t profile, advSimAdv_t *pAdv)
+{
+    if (profile < (uint32_t)advSchedLevelCount_c)
+    {
+        pAdv->minInterval = gaAdvSchedIntervals[profile].minInterval;
+        pAdv->maxInterval = gaAdvSchedIntervals[profile].maxInterval;
+        pAdv->codedInterval = gaAdvSchedIntervals[profile].codedInterval;
+    }
+    else
+    {
+        pAdv->minInterval = gcAdvSimCccLegacy;
+        pAdv->maxInterval = gcAdvSimCccLegacy;
+        pAdv->codedInterval = gcAdvSimCccCoded;
+    }
+}
+
+/* Time from the phone entering range to the first received packet, us */
+static uint32_t AdvSim_Discover(const advSimAdv_t *pAdv, const advSimScan_t *pScan, uint32_t lossPct,
+                                uint64_t seed)
+{
+    uint64_t rng = seed;
+    const uint32_t scanPhase = AdvSim_Uniform(&rng, pScan->intervalUs);
+    const uint32_t spanUs = ADV_SIM_UNITS_US(pAdv->maxInterval - pAdv->minInterval);
+    uint64_t tEvent = AdvSim_Uniform(&rng, ADV_SIM_UNITS_US(pAdv->maxInterval) + ADV_SIM_DELAY_MAX_US);
+
+    while (tEvent < ADV_SIM_HORIZON_US)
+    {
+        for (uint32_t ch = 0u; ch < 3u; ch++)
+        {
+            const uint64_t tPkt = tEvent + ((uint64_t)ch * ADV_SIM_CH_GAP_US);
+            const uint64_t sinceScan = tPkt + pScan->intervalUs - scanPhase;
+            const uint64_t window = sinceScan / pScan->intervalUs;
+            const uint64_t inWindow = sinceScan % pScan->intervalUs;
+
+            if (((window % 3u) == ch) && ((inWindow + ADV_SIM_LEGACY_US) <= pScan->windowUs) &&
+                (AdvSim_Uniform(&rng, 100u) >= lossPct))
+            {
+                return (uint32_t)tPkt;
+            }
+        }
+        tEvent += ADV_SIM_UNITS_US(pAdv->minInterval) + AdvSim_Uniform(&rng, spanUs + 1u) +
+                  AdvSim_Uniform(&rng, ADV_SIM_DELAY_MAX_US + 1u);
+    }
+
+    return ADV_SIM_HORIZON_US;
+}
+
+static int AdvSim_Cmp(const void *pA, const void *pB)
+{
+    const uint32_t a = *(const uint32_t *)pA;
+    const uint32_t b = *(const uint32_t *)pB;
+    return (a > b) - (a < b);
+}
+
+static void AdvSim_Latency(uint32_t profile, advSimMode_t mode, uint32_t runs, uint32_t lossPct, uint64_t seed,
+                           advSimLatency_t *pOut)
+{
+    static uint32_t aUs[ADV_SIM_MAX_RUNS];
+    advSimAdv_t adv;
+    double sum = 0.0;
+
+    runs = (runs > ADV_SIM_MAX_RUNS) ? ADV_SIM_MAX_RUNS : ((runs == 0u) ? 1u : runs);
+    AdvSim_Profile(profile, &adv);
+    memset(pOut, 0, sizeof(*pOut));
+
+    for (uint32_t r = 0u; r < runs; r++)
+    {
+        uint64_t runSeed = seed ^ (((uint64_t)profile << 48) | ((uint64_t)mode << 40) | r);
+
+        aUs[r] = AdvSim_Discover(&adv, &gaAdvSimScan[mode], lossPct, AdvSim_Next(&runSeed));
+        pOut->missed += (aUs[r] >= ADV_SIM_HORIZON_US) ? 1u : 0u;
+        sum += (double)aUs[r];
+    }
+    qsort(aUs, runs, sizeof(aUs[0]), AdvSim_Cmp);
+
+    pOut->meanMs = sum / ((double)runs * 1000.0);
+    pOut->p50Ms = aUs[(runs * 50u) / 100u] / 1000u;
+    pOut->p95Ms = aUs[(runs * 95u) / 100u] / 1000u;
+    pOut->p99Ms = aUs[(runs * 99u) / 100u] / 1000u;
+}
+
+/* Air time of the advertising per second of advertising */
+static double AdvSim_Duty(uint32_t profile)
+{
+    advSimAdv_t adv;
+    double duty;
+
+    AdvSim_Profile(profile, &adv);
+    /* Mean period: mid interval plus mean advDelay */
+    duty = (3.0 * ADV_SIM_LEGACY_US) /
+           (((double)ADV_SIM_UNITS_US(adv.minInterval + adv.maxInterval) / 2.0) + (ADV_SIM_DELAY_MAX_US / 2.0));
+    if (adv.codedInterval != 0u)
+    {
+        duty += (double)ADV_SIM_CODED_EVENT_US /
+                ((double)ADV_SIM_UNITS_US(adv.codedInterval) + (ADV_SIM_DELAY_MAX_US / 2.0));
+    }
+    return duty;
+}
+
+/*******************************************************************************
+ * Day
+ ******************************************************************************/
+
+/* Replays the script; the phone scans in scan mode mode when it comes back */
+static void AdvSim_Day(advSimMode_t mode, uint32_t lossPct, uint64_t seed, advSimDay_t *pDay)
+{
+    const advSimEvt_t *pEvt = gaAdvSimDayScript;
+    bool_t connected = TRUE;
+    advSchedProfile_t profile;
+    uint32_t t;
+
+    memset(pDay, 0, sizeof(*pDay));
+    AdvSched_Init(0u);
+
+    for (t = 0u; t < 86400u; t++)
+    {
+        while ((pEvt->type != advSimEvtEnd_c) && (pEvt->atS == t))
+        {
+            if (pEvt->type == advSimEvtDisconnect_c)
+            {
+                connected = FALSE;
+                AdvSched_Disconnected(t);
+            }
+            else if (pDay->approaches < 16u)
+            {
+                uint32_t i = pDay->approaches++;
+                advSimAdv_t adv;
+
+                (void)AdvSched_Select(t, &profile);
+                pDay->aLevel[i] = profile.level;
+                AdvSim_Profile(ADV_SIM_STATIC, &adv);
+                pDay->aLatencyMs[0][i] = AdvSim_Discover(&adv, &gaAdvSimScan[mode], lossPct, seed + i) / 1000u;
+                AdvSim_Profile((uint32_t)profile.level, &adv);
+                pDay->aLatencyMs[1][i] = AdvSim_Discover(&adv, &gaAdvSimScan[mode], lossPct, seed + i) / 1000u;
+
+                connected = TRUE;
+                AdvSched_Unlocked(t);
+            }
+            else
+            {
+                /* Script longer than the result table */
+            }
+            pEvt++;
+        }
+
+        if (connected == FALSE)
+        {
+            (void)AdvSched_Select(t, &profile);
+            pDay->radioS[0] += AdvSim_Duty(ADV_SIM_STATIC);
+            pDay->radioS[1] += AdvSim_Duty((uint32_t)profile.level);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+
+#ifndef ADV_SIM_NO_MAIN
+int main(int argc, char *argv[])
+{
+    uint32_t runs = 20000u;
+    uint64_t seed = 1u;
+    uint32_t lossPct = 10u;
+    uint32_t modeMask = (1u << advSimModeCount_c) - 1u;
+    bool_t dayOnly = FALSE;
+    advSimLatency_t lat;
+    advSimDay_t day;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:S:l:m:dh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': runs    = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'S': seed    = strtoull(optarg, NULL, 0); break;
+            case 'l': lossPct = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'd': dayOnly = TRUE; break;
+            case 'm':
+                modeMask = 0u;
+                for (uint32_t m = 0u; m < (uint32_t)advSimModeCount_c; m++)
+                {
+                    if (strcmp(optarg, gaAdvSimModeNames[m]) == 0)
+                    {
+                        modeMask = 1u << m;
+                    }
+                }
+                if ((modeMask == 0u) && (strcmp(optarg, "all") == 0))
+                {
+                    modeMask = (1u << advSimModeCount_c) - 1u;
+                }
+                if (modeMask == 0u)
+                {
+                    fprintf(stderr, "Unknown scan mode '%s'\n", optarg);
+                    return 2;
+                }
+                break;
+            default:
+                fprintf(stderr, "Usage: adv_sched_sim [-n runs] [-S seed] [-l loss%%] "
+                                "[-m fg|balanced|lowpower|ios|all] [-d]\n");
+                return 2;
+        }
+    }
+    lossPct = (lossPct > 99u) ? 99u : lossPct;
+
+    printf("Seed %llu, %u runs, %u %% packet loss\n", (unsigned long long)seed, runs, lossPct);
+    if (dayOnly == FALSE)
+    {
+        printf("%-8s %-9s %8s %8s %8s %8s %7s %8s %8s\n", "profile", "scan", "mean ms", "p50 ms", "p95 ms",
+               "p99 ms", "missed", "duty %", "uA");
+        for (uint32_t p = 0u; p < ADV_SIM_PROFILES; p++)
+        {
+            for (uint32_t m = 0u; m < (uint32_t)advSimModeCount_c; m++)
+            {
+                if ((modeMask & (1u << m)) == 0u)
+                {
+                    continue;
+                }
+                AdvSim_Latency(p, (advSimMode_t)m, runs, lossPct, seed, &lat);
+                printf("%-8s %-9s %8.0f %8u %8u %8u %7u %8.3f %8.1f\n", gaAdvSimProfileNames[p],
+                       gaAdvSimModeNames[m], lat.meanMs, lat.p50Ms, lat.p95Ms, lat.p99Ms, lat.missed,
+                       100.0 * AdvSim_Duty(p), 1000.0 * ADV_SIM_TX_MA * AdvSim_Duty(p));
+            }
+        }
+        printf("\n");
+    }
+
+    for (uint32_t m = 0u; m < (uint32_t)advSimModeCount_c; m++)
+    {
+        if ((modeMask & (1u << m)) == 0u)
+        {
+            continue;
+        }
+        AdvSim_Day((advSimMode_t)m, lossPct, seed, &day);
+        printf("Day, %s scan: radio %.1f s static, %.1f s scheduled (%.1f %%)\n", gaAdvSimModeNames[m],
+               day.radioS[0], day.radioS[1], 100.0 * day.radioS[1] / day.radioS[0]);
+        for (uint32_t i = 0u; i < day.approaches; i++)
+        {
+            printf("  approach %u: %-7s %6u ms (static %u ms)\n", i + 1u, gaAdvSimProfileNames[day.aLevel[i]],
+                   day.aLatencyMs[1][i], day.aLatencyMs[0][i]);
+        }
+    }
+
+    return 0;
+}
+#endif /* ADV_SIM_NO_MAIN */
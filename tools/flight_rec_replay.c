@@ -0,0 +1,765 @@
+/*! *********************************************************************************
+* \file flight_rec_replay.c
+*
+* \brief  Host decoder and replayer for the RSSI flight recorder (flight_rec.c).
+*
+*         Collects the valid blocks of a flash image or of a "flightrec dump"
+*         shell capture, orders them by sequence number and decodes the records.
+*         From every RESET on, the recorded samples are fed through the real
+*         ProxRssi_PushRaw / ProxRssi_MainFunction with the recorded CONFIG and
+*         the replayed events, features, EMA and state are compared with the
+*         recorded ones. Any difference is reported as a mismatch.
+*
+*         When the RESET was already overwritten, the replay starts at the first
+*         sample after a repeated CONFIG and is checked from the first FEAT
+*         record that matches in FAR state once the filter windows refilled.
+*
+*         Timestamps are replayed in the recorded ProxTime ticks; the printed
+*         times and the CSV are converted with the ticksPerMs of the last CONFIG
+*         and unwrapped, so they keep counting across the 32-bit tick wrap.
+*
+*         Build:  cc -std=c11 -O2 -I kw47_keyless_entry \
+*                    -I libs/middleware/wireless/framework/Common \
+*                    -o tools/flight_rec_replay tools/flight_rec_replay.c
+*
+*         Usage:  flight_rec_replay [-q] [-v] [-c samples.csv] [-b loops] capture
+*
+*           -q          only print the summary
+*           -v          print every sample
+*           -c file     write the replayed samples as "tMs,rssi" CSV
+*           -b loops    time a replay of all samples, loops times
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ProxRssi.h"
+#include "ProxRssi.c"
+#include "flight_rec.h"
+#include "log_export.h"
+#include "log_export.c"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+
+typedef struct
+{
+    uint32_t       seq;
+    uint8_t        flags;
+    uint32_t       base;           /* Ticks */
+    uint16_t       used;
+    const uint8_t *pRec;
+} frBlock_t;
+
+typedef struct
+{
+    ProxRssi_ParamsType params;
+    uint16_t            lut[PROX_RSSI_ALPHA_LUT_SIZE];
+    uint16_t            lutLen;
+} frConfig_t;
+
+/* Replayed sample, kept for the benchmark and the CSV export */
+typedef struct
+{
+    uint32_t t;                 /* Ticks */
+    int8_t   rssi;
+    int32_t  configIdx;         /* >= 0: ProxRssi_Init with this config before the sample */
+} frSample_t;
+
+typedef struct
+{
+    ProxRssi_CtxType      ctx;
+    bool_t                live;         /* ctx is being replayed */
+    bool_t                synced;       /* ctx known to follow the recorded one, checks are strict */
+    uint32_t              syncStart;
+    int32_t               lastConfig;   /* Newest CONFIG since the last discontinuity, -1 if none */
+    bool_t                evPending;    /* Replayed event not matched by a record yet */
+    ProxRssi_EventType    lastEv;
+    ProxRssi_FeaturesType lastFeat;
+    int32_t               resetConfig;  /* Config applied by the pending RESET, -1 if none */
+    uint32_t              ticksPerMs;   /* Of the last CONFIG */
+    uint64_t              clock;        /* Unwrapped ticks of the last record */
+    uint32_t              clockLast;    /* Its 32-bit timestamp */
+
+    frConfig_t           *pConfigs;
+    uint32_t              numConfigs;
+    uint32_t              maxConfigs;
+    frSample_t           *pSamples;
+    uint32_t              numSamples;
+    uint32_t              maxSamples;
+
+    int                   verbose;      /* 0 summary, 1 events, 2 samples */
+    FILE                 *pCsv;
+
+    /* Counters */
+    unsigned long blocks, seqGaps, boots, records, badRecords, logBytes;
+    unsigned long samples, replayed, resets, events, resyncs;
+    unsigned long evChecks, evMismatch, featChecks, featMismatch;
+} frReplay_t;
+
+static const char *const gaProxEventNames[] = { "NONE", "CANDIDATE_STARTED", "UNLOCK_TRIGGERED", "EXIT_TO_FAR" };
+static const char *const gaProxStateNames[] = { "FAR", "CANDIDATE", "LOCKOUT" };
+
+/*******************************************************************************
+ * Block collection
+ ******************************************************************************/
+
+static int FlightReplay_CompareSeq(const void *pA, const void *pB)
+{
+    uint32_t a = ((const frBlock_t *)pA)->seq;
+    uint32_t b = ((const frBlock_t *)pB)->seq;
+
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/* Find all valid blocks in buf, ordered by sequence, duplicates removed */
+static uint32_t FlightReplay_ScanBlocks(const uint8_t *pBuf, size_t len, frBlock_t *pBlocks, uint32_t maxBlocks)
+{
+    uint32_t n = 0u;
+    size_t i = 0u;
+
+    while ((i + FLIGHT_REC_HDR_LEN <= len) && (n < maxBlocks))
+    {
+        const uint8_t *p = &pBuf[i];
+        uint16_t used = (uint16_t)(p[12] | (p[13] << 8));
+
+        if ((p[0] == FLIGHT_REC_MAGIC_0) && (p[1] == FLIGHT_REC_MAGIC_1) && (p[2] == FLIGHT_REC_VERSION) &&
+            ((size_t)FLIGHT_REC_HDR_LEN + used <= len - i) && (used <= FLIGHT_REC_BLOCK_SIZE - FLIGHT_REC_HDR_LEN))
+        {
+            uint16_t crc = LogExport_Crc16(0xFFFFu, p, 14u);
+            crc = LogExport_Crc16(crc, &p[FLIGHT_REC_HDR_LEN], used);
+
+            if (crc == (uint16_t)(p[14] | (p[15] << 8)))
+            {
+                pBlocks[n].seq    = (uint32_t)p[4] | ((uint32_t)p[5] << 8) | ((uint32_t)p[6] << 16) | ((uint32_t)p[7] << 24);
+                pBlocks[n].flags  = p[3];
+                pBlocks[n].base = (uint32_t)p[8] | ((uint32_t)p[9] << 8) | ((uint32_t)p[10] << 16) | ((uint32_t)p[11] << 24);
+                pBlocks[n].used   = used;
+                pBlocks[n].pRec   = &p[FLIGHT_REC_HDR_LEN];
+                n++;
+                i += FLIGHT_REC_HDR_LEN + used;
+                continue;
+            }
+        }
+        i++;
+    }
+
+    qsort(pBlocks, n, sizeof(frBlock_t), FlightReplay_CompareSeq);
+
+    /* The same block can appear in flash and in a later dump */
+    uint32_t out = 0u;
+    for (uint32_t k = 0u; k < n; k++)
+    {
+        if ((out == 0u) || (pBlocks[k].seq != pBlocks[out - 1u].seq))
+        {
+            pBlocks[out++] = pBlocks[k];
+        }
+    }
+
+    return out;
+}
+
+/*******************************************************************************
+ * Record decoding
+ ******************************************************************************/
+
+typedef struct
+{
+    const uint8_t *p;
+    const uint8_t *pEnd;
+    bool_t         error;
+} frReader_t;
+
+static uint8_t FlightReplay_GetU8(frReader_t *pRd)
+{
+    if (pRd->p >= pRd->pEnd)
+    {
+        pRd->error = TRUE;
+        return 0u;
+    }
+    return *pRd->p++;
+}
+
+static uint32_t FlightReplay_GetVarint(frReader_t *pRd)
+{
+    uint32_t value = 0u;
+    uint32_t shift = 0u;
+    uint8_t b;
+
+    do
+    {
+        b = FlightReplay_GetU8(pRd);
+        if (shift < 32u)
+        {
+            value |= (uint32_t)(b & 0x7Fu) << shift;
+        }
+        shift += 7u;
+    } while (((b & 0x80u) != 0u) && (pRd->error == FALSE));
+
+    return value;
+}
+
+static int32_t FlightReplay_GetSigned(frReader_t *pRd)
+{
+    uint32_t zz = FlightReplay_GetVarint(pRd);
+
+    return ((zz & 1u) != 0u) ? (int32_t)~(zz >> 1) : (int32_t)(zz >> 1);
+}
+
+static void FlightReplay_AddSample(frReplay_t *pR, uint32_t t, int8_t rssi, int32_t configIdx)
+{
+    if (pR->numSamples == pR->maxSamples)
+    {
+        pR->maxSamples = (pR->maxSamples == 0u) ? 4096u : (pR->maxSamples * 2u);
+        pR->pSamples = realloc(pR->pSamples, pR->maxSamples * sizeof(frSample_t));
+        if (pR->pSamples == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    pR->pSamples[pR->numSamples].t       = t;
+    pR->pSamples[pR->numSamples].rssi      = rssi;
+    pR->pSamples[pR->numSamples].configIdx = configIdx;
+    pR->numSamples++;
+}
+
+/* Records are in log order, so the deltas between consecutive timestamps
+ * unwrap the 32-bit tick counter */
+static void FlightReplay_Clock(frReplay_t *pR, uint32_t t)
+{
+    pR->clock    += (uint64_t)ProxTime_Elapsed(t, pR->clockLast);
+    pR->clockLast = t;
+}
+
+/* Time of the last record, for display */
+static double FlightReplay_Seconds(const frReplay_t *pR)
+{
+    return (double)pR->clock / (1000.0 * (double)pR->ticksPerMs);
+}
+
+static void FlightReplay_ApplyConfig(ProxRssi_CtxType *pCtx, const frConfig_t *pCfg)
+{
+    (void)ProxRssi_Init(pCtx, &pCfg->params, pCfg->lut, pCfg->lutLen);
+}
+
+/* A replayed event that never showed up in the log */
+static void FlightReplay_CheckEventConsumed(frReplay_t *pR)
+{
+    if ((pR->evPending == TRUE) && (pR->synced == TRUE))
+    {
+        pR->evChecks++;
+        pR->evMismatch++;
+        if (pR->verbose != 0)
+        {
+            printf("%10.3f  MISMATCH replay raised %s, not recorded\n",
+                   FlightReplay_Seconds(pR), gaProxEventNames[pR->lastEv]);
+        }
+    }
+    pR->evPending = FALSE;
+}
+
+/* Decode and replay the records of one block */
+static void FlightReplay_Block(frReplay_t *pR, const frBlock_t *pBlock)
+{
+    frReader_t rd = { pBlock->pRec, pBlock->pRec + pBlock->used, FALSE };
+    uint32_t t = pBlock->base;
+    int32_t rssi = 0;
+    int32_t aFeat[7] = { 0 };
+    uint8_t prevTag = 0u;
+    uint8_t tag;
+
+    pR->logBytes += FLIGHT_REC_HDR_LEN + (unsigned long)pBlock->used;
+
+    for (; (rd.p < rd.pEnd) && (rd.error == FALSE); prevTag = tag)
+    {
+        tag = FlightReplay_GetU8(&rd);
+
+        t += FlightReplay_GetVarint(&rd);
+        FlightReplay_Clock(pR, t);
+        pR->records++;
+
+        switch ((tag >= FLIGHT_REC_TAG_SAMPLE_SHORT) ? FLIGHT_REC_TAG_SAMPLE : tag)
+        {
+            case FLIGHT_REC_TAG_SAMPLE:
+            {
+                if (tag >= FLIGHT_REC_TAG_SAMPLE_SHORT)
+                {
+                    uint32_t zz = (uint32_t)tag & 0x7Fu;
+                    rssi += ((zz & 1u) != 0u) ? (int32_t)~(zz >> 1) : (int32_t)(zz >> 1);
+                }
+                else
+                {
+                    rssi += FlightReplay_GetSigned(&rd);
+                }
+                pR->samples++;
+                if (pR->pCsv != NULL)
+                {
+                    fprintf(pR->pCsv, "%u,%d\n", (unsigned)(pR->clock / pR->ticksPerMs), (int)rssi);
+                }
+                if ((pR->live == FALSE) && (pR->lastConfig >= 0))
+                {
+                    /* No RESET to start from: run from here with the last CONFIG
+                     * and trust the result once the features line up */
+                    FlightReplay_ApplyConfig(&pR->ctx, &pR->pConfigs[pR->lastConfig]);
+                    pR->resetConfig = pR->lastConfig;
+                    pR->live        = TRUE;
+                    pR->synced      = FALSE;
+                    pR->syncStart = t;
+                }
+                if (pR->live == FALSE)
+                {
+                    break;
+                }
+
+                FlightReplay_CheckEventConsumed(pR);
+                FlightReplay_AddSample(pR, t, (int8_t)rssi, pR->resetConfig);
+                pR->resetConfig = -1;
+
+                (void)ProxRssi_PushRaw(&pR->ctx, t, (int8_t)rssi);
+                (void)ProxRssi_MainFunction(&pR->ctx, t, &pR->lastEv, &pR->lastFeat);
+                pR->evPending = (pR->lastEv != PROX_RSSI_EVT_NONE) ? TRUE : FALSE;
+                pR->replayed++;
+
+                if (pR->verbose > 1)
+                {
+                    printf("%10.3f  rssi %4d  ema %7.2f  %s\n", FlightReplay_Seconds(pR), (int)rssi,
+                           (double)pR->ctx.emaQ4 / 16.0, gaProxStateNames[pR->ctx.st]);
+                }
+                break;
+            }
+
+            case FLIGHT_REC_TAG_FEAT:
+            {
+                uint8_t state = FlightReplay_GetU8(&rd);
+                int32_t aMine[7];
+                uint32_t i;
+
+                for (i = 0u; i < 7u; i++)
+                {
+                    aFeat[i] += FlightReplay_GetSigned(&rd);
+                }
+                if (pR->live == FALSE)
+                {
+                    break;
+                }
+
+                aMine[0] = pR->lastFeat.n;
+                aMine[1] = pR->lastFeat.pctAboveEnterQ15;
+                aMine[2] = pR->lastFeat.stdQ4;
+                aMine[3] = pR->lastFeat.lastQ4;
+                aMine[4] = pR->lastFeat.minQ4;
+                aMine[5] = pR->lastFeat.maxQ4;
+                aMine[6] = pR->ctx.emaQ4;
+
+                if (pR->synced == FALSE)
+                {
+                    /* Windows refilled, EMA equal and no state timers running */
+                    if ((ProxTime_Elapsed(t, pR->syncStart) > pR->ctx.tk.wRaw) &&
+                        (ProxTime_Elapsed(t, pR->syncStart) > pR->ctx.tk.wFeat) &&
+                        (state == (uint8_t)PROX_RSSI_ST_FAR) && (pR->ctx.st == PROX_RSSI_ST_FAR) &&
+                        (memcmp(aMine, aFeat, sizeof(aMine)) == 0))
+                    {
+                        pR->synced = TRUE;
+                        pR->resyncs++;
+                        if (pR->verbose != 0)
+                        {
+                            printf("%10.3f  RESYNCHRONISED\n", FlightReplay_Seconds(pR));
+                        }
+                    }
+                    break;
+                }
+
+                pR->featChecks++;
+                if ((state != (uint8_t)pR->ctx.st) || (memcmp(aMine, aFeat, sizeof(aMine)) != 0))
+                {
+                    pR->featMismatch++;
+                    if (pR->verbose != 0)
+                    {
+                        printf("%10.3f  MISMATCH features: recorded %s n=%d pct=%d std=%d ema=%d, "
+                               "replay %s n=%d pct=%d std=%d ema=%d\n", FlightReplay_Seconds(pR),
+                               gaProxStateNames[state % 3u], aFeat[0], aFeat[1], aFeat[2], aFeat[6],
+                               gaProxStateNames[pR->ctx.st], aMine[0], aMine[1], aMine[2], aMine[6]);
+                    }
+                }
+                break;
+            }
+
+            case FLIGHT_REC_TAG_EVENT:
+            {
+                uint8_t code = FlightReplay_GetU8(&rd);
+                uint8_t arg  = FlightReplay_GetU8(&rd);
+
+                pR->events++;
+                if (code == FLIGHT_REC_EVT_PROX)
+                {
+                    const char *pName = (arg < 4u) ? gaProxEventNames[arg] : "?";
+
+                    if (pR->synced == TRUE)
+                    {
+                        pR->evChecks++;
+                        if ((pR->evPending == FALSE) || ((uint8_t)pR->lastEv != arg))
+                        {
+                            pR->evMismatch++;
+                            if (pR->verbose != 0)
+                            {
+                                printf("%10.3f  MISMATCH recorded %s, replay %s\n", FlightReplay_Seconds(pR), pName,
+                                       (pR->evPending == TRUE) ? gaProxEventNames[pR->lastEv] : "NONE");
+                            }
+                        }
+                        else if (pR->verbose != 0)
+                        {
+                            printf("%10.3f  %s (reproduced)\n", FlightReplay_Seconds(pR), pName);
+                        }
+                        pR->evPending = FALSE;
+                    }
+                    else if (pR->verbose != 0)
+                    {
+                        printf("%10.3f  %s (not replayed)\n", FlightReplay_Seconds(pR), pName);
+                    }
+                }
+                else if (code == FLIGHT_REC_EVT_WARM_START)
+                {
+                    /* The restored history is not in the log: run on from the
+                     * next sample like after a missing RESET */
+                    FlightReplay_CheckEventConsumed(pR);
+                    pR->live   = FALSE;
+                    pR->synced = FALSE;
+                    if (pR->verbose != 0)
+                    {
+                        printf("%10.3f  WARM START (%u samples restored)\n", FlightReplay_Seconds(pR), arg);
+                    }
+                }
+                else if (pR->verbose != 0)
+                {
+                    printf("%10.3f  %s device %u\n", FlightReplay_Seconds(pR),
+                           (code == FLIGHT_REC_EVT_CONNECT) ? "CONNECT" :
+                           (code == FLIGHT_REC_EVT_DISCONNECT) ? "DISCONNECT" : "EVENT", arg);
+                }
+                break;
+            }
+
+            case FLIGHT_REC_TAG_CONFIG:
+            {
+                frConfig_t cfg;
+                int32_t prev = 0;
+                uint32_t i;
+
+                memset(&cfg, 0, sizeof(cfg));
+                cfg.params.wRawMs            = FlightReplay_GetVarint(&rd);
+                cfg.params.wSpikeMs          = FlightReplay_GetVarint(&rd);
+                cfg.params.wFeatMs           = FlightReplay_GetVarint(&rd);
+                cfg.params.hampelKQ4         = (uint16_t)FlightReplay_GetVarint(&rd);
+                cfg.params.madEpsQ4          = (uint16_t)FlightReplay_GetVarint(&rd);
+                cfg.params.enterNearQ4       = (int16_t)FlightReplay_GetSigned(&rd);
+                cfg.params.exitNearQ4        = (int16_t)FlightReplay_GetSigned(&rd);
+                cfg.params.hystQ4            = (uint16_t)FlightReplay_GetVarint(&rd);
+                cfg.params.pctThQ15          = (uint16_t)FlightReplay_GetVarint(&rd);
+                cfg.params.stdThQ4           = (uint16_t)FlightReplay_GetVarint(&rd);
+                cfg.params.stableMs          = FlightReplay_GetVarint(&rd);
+                cfg.params.minFeatSamples    = (uint16_t)FlightReplay_GetVarint(&rd);
+                cfg.params.exitConfirmMs     = FlightReplay_GetVarint(&rd);
+                cfg.params.lockoutMs         = FlightReplay_GetVarint(&rd);
+                cfg.params.maxReasonableDtMs = FlightReplay_GetVarint(&rd);
+                cfg.params.ticksPerMs        = (uint16_t)FlightReplay_GetVarint(&rd);
+                cfg.lutLen                   = (uint16_t)FlightReplay_GetVarint(&rd);
+                if ((cfg.lutLen == 0u) || (cfg.lutLen > PROX_RSSI_ALPHA_LUT_SIZE))
+                {
+                    rd.error = TRUE;
+                    break;
+                }
+                for (i = 0u; i < cfg.lutLen; i++)
+                {
+                    prev += FlightReplay_GetSigned(&rd);
+                    cfg.lut[i] = (uint16_t)prev;
+                }
+
+                if (pR->numConfigs == pR->maxConfigs)
+                {
+                    pR->maxConfigs = (pR->maxConfigs == 0u) ? 16u : (pR->maxConfigs * 2u);
+                    pR->pConfigs = realloc(pR->pConfigs, pR->maxConfigs * sizeof(frConfig_t));
+                    if (pR->pConfigs == NULL)
+                    {
+                        fprintf(stderr, "out of memory\n");
+                        exit(1);
+                    }
+                }
+                pR->ticksPerMs = (cfg.params.ticksPerMs != 0u) ? cfg.params.ticksPerMs : 1u;
+                pR->lastConfig = (int32_t)pR->numConfigs;
+                pR->pConfigs[pR->numConfigs++] = cfg;
+                break;
+            }
+
+            case FLIGHT_REC_TAG_RESET:
+                pR->resets++;
+                FlightReplay_CheckEventConsumed(pR);
+                /* The CONFIG of a RESET is always the record before it */
+                if (prevTag == FLIGHT_REC_TAG_CONFIG)
+                {
+                    pR->resetConfig = pR->lastConfig;
+                    FlightReplay_ApplyConfig(&pR->ctx, &pR->pConfigs[pR->resetConfig]);
+                    pR->live   = TRUE;
+                    pR->synced = TRUE;
+                    memset(&pR->lastFeat, 0, sizeof(pR->lastFeat));
+                }
+                if (pR->verbose != 0)
+                {
+                    printf("%10.3f  RESET\n", FlightReplay_Seconds(pR));
+                }
+                break;
+
+            default:
+                rd.error = TRUE;
+                break;
+        }
+    }
+
+    if (rd.error == TRUE)
+    {
+        pR->badRecords++;
+        pR->live       = FALSE;
+        pR->synced     = FALSE;
+        pR->lastConfig = -1;
+    }
+}
+
+/* Decode and replay all blocks in sequence order */
+static void FlightReplay_Run(frReplay_t *pR, const frBlock_t *pBlocks, uint32_t numBlocks)
+{
+    pR->live        = FALSE;
+    pR->synced      = FALSE;
+    pR->evPending   = FALSE;
+    pR->resetConfig = -1;
+    pR->lastConfig  = -1;
+    pR->ticksPerMs  = 1u;
+    pR->clock       = 0u;
+    pR->clockLast   = 0u;
+
+    for (uint32_t i = 0u; i < numBlocks; i++)
+    {
+        /* Lost blocks or a reboot break the replayed state until the next RESET */
+        if ((i != 0u) && (pBlocks[i].seq != pBlocks[i - 1u].seq + 1u))
+        {
+            pR->seqGaps++;
+            pR->live       = FALSE;
+            pR->synced     = FALSE;
+            pR->evPending  = FALSE;
+            pR->lastConfig = -1;
+        }
+        if ((pBlocks[i].flags & FLIGHT_REC_FLAG_BOOT) != 0u)
+        {
+            pR->boots++;
+            pR->live       = FALSE;
+            pR->synced     = FALSE;
+            pR->evPending  = FALSE;
+            pR->lastConfig = -1;
+            pR->clock      = pBlocks[i].base;     /* The device clock restarted */
+            pR->clockLast  = pBlocks[i].base;
+            if (pR->verbose != 0)
+            {
+                printf("%10.3f  BOOT (block %u)\n", FlightReplay_Seconds(pR), pBlocks[i].seq);
+            }
+        }
+
+        pR->blocks++;
+        FlightReplay_Block(pR, &pBlocks[i]);
+    }
+
+    if (pR->live == TRUE)
+    {
+        FlightReplay_CheckEventConsumed(pR);
+    }
+}
+
+/* Replay the collected samples again, for throughput measurements */
+static uint32_t FlightReplay_Bench(const frReplay_t *pR, ProxRssi_CtxType *pCtx)
+{
+    ProxRssi_EventType ev;
+    ProxRssi_FeaturesType feat;
+    uint32_t unlocks = 0u;
+
+    for (uint32_t i = 0u; i < pR->numSamples; i++)
+    {
+        const frSample_t *pS = &pR->pSamples[i];
+
+        if (pS->configIdx >= 0)
+        {
+            FlightReplay_ApplyConfig(pCtx, &pR->pConfigs[pS->configIdx]);
+        }
+        (void)ProxRssi_PushRaw(pCtx, pS->t, pS->rssi);
+        (void)ProxRssi_MainFunction(pCtx, pS->t, &ev, &feat);
+        unlocks += (ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED) ? 1u : 0u;
+    }
+
+    return unlocks;
+}
+
+/*******************************************************************************
+ * Input
+ ******************************************************************************/
+
+static int FlightReplay_HexVal(int c)
+{
+    if ((c >= '0') && (c <= '9')) { return c - '0'; }
+    if ((c >= 'a') && (c <= 'f')) { return c - 'a' + 10; }
+    if ((c >= 'A') && (c <= 'F')) { return c - 'A' + 10; }
+    return -1;
+}
+
+/* Convert the "FR:<hex>" lines of a shell capture to binary in place */
+static size_t FlightReplay_ParseShellDump(uint8_t *pBuf, size_t len)
+{
+    size_t out = 0u;
+    size_t i = 0u;
+
+    while (i + 3u <= len)
+    {
+        if ((pBuf[i] == 'F') && (pBuf[i + 1u] == 'R') && (pBuf[i + 2u] == ':') &&
+            ((i == 0u) || (pBuf[i - 1u] == '\n') || (pBuf[i - 1u] == '\r')))
+        {
+            i += 3u;
+            while ((i + 1u < len) && (FlightReplay_HexVal(pBuf[i]) >= 0) && (FlightReplay_HexVal(pBuf[i + 1u]) >= 0))
+            {
+                pBuf[out++] = (uint8_t)((FlightReplay_HexVal(pBuf[i]) << 4) | FlightReplay_HexVal(pBuf[i + 1u]));
+                i += 2u;
+            }
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    return out;
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+#ifndef FLIGHT_REPLAY_NO_MAIN
+int main(int argc, char *argv[])
+{
+    const char *pInPath = NULL;
+    const char *pCsvPath = NULL;
+    unsigned long loops = 0u;
+    frReplay_t *pR = calloc(1u, sizeof(frReplay_t));
+
+    if (pR == NULL)
+    {
+        return 1;
+    }
+    pR->verbose = 1;
+
+    for (int a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "-q") == 0)                         { pR->verbose = 0; }
+        else if (strcmp(argv[a], "-v") == 0)                    { pR->verbose = 2; }
+        else if ((strcmp(argv[a], "-c") == 0) && (a + 1 < argc)) { pCsvPath = argv[++a]; }
+        else if ((strcmp(argv[a], "-b") == 0) && (a + 1 < argc)) { loops = strtoul(argv[++a], NULL, 0); }
+        else                                                     { pInPath = argv[a]; }
+    }
+
+    if (pInPath == NULL)
+    {
+        fprintf(stderr, "usage: %s [-q] [-v] [-c samples.csv] [-b loops] capture\n", argv[0]);
+        return 2;
+    }
+
+    FILE *pIn = fopen(pInPath, "rb");
+    if (pIn == NULL)
+    {
+        perror(pInPath);
+        return 1;
+    }
+    fseek(pIn, 0, SEEK_END);
+    long fileLen = ftell(pIn);
+    fseek(pIn, 0, SEEK_SET);
+    uint8_t *pBuf = malloc((size_t)fileLen + 1u);
+    if ((pBuf == NULL) || (fread(pBuf, 1u, (size_t)fileLen, pIn) != (size_t)fileLen))
+    {
+        fprintf(stderr, "cannot read %s\n", pInPath);
+        fclose(pIn);
+        return 1;
+    }
+    fclose(pIn);
+
+    size_t len = (size_t)fileLen;
+    size_t hexLen = FlightReplay_ParseShellDump(pBuf, len);
+    if (hexLen != 0u)
+    {
+        len = hexLen;
+    }
+
+    uint32_t maxBlocks = (uint32_t)(len / FLIGHT_REC_HDR_LEN) + 1u;
+    frBlock_t *pBlocks = malloc(maxBlocks * sizeof(frBlock_t));
+    if (pBlocks == NULL)
+    {
+        return 1;
+    }
+    uint32_t numBlocks = FlightReplay_ScanBlocks(pBuf, len, pBlocks, maxBlocks);
+
+    if (pCsvPath != NULL)
+    {
+        pR->pCsv = fopen(pCsvPath, "w");
+        if (pR->pCsv == NULL)
+        {
+            perror(pCsvPath);
+            return 1;
+        }
+        fprintf(pR->pCsv, "tMs,rssi\n");
+    }
+
+    FlightReplay_Run(pR, pBlocks, numBlocks);
+
+    if (pR->pCsv != NULL)
+    {
+        fclose(pR->pCsv);
+    }
+
+    printf("\nBlocks: %lu (sequence gaps %lu, boots %lu), records %lu, bad blocks %lu\n",
+           pR->blocks, pR->seqGaps, pR->boots, pR->records, pR->badRecords);
+    printf("Samples: %lu recorded, %lu replayed, resets %lu, resynchronisations %lu\n",
+           pR->samples, pR->replayed, pR->resets, pR->resyncs);
+    printf("Events: %lu checked, %lu mismatches\n", pR->evChecks, pR->evMismatch);
+    printf("Features: %lu checked, %lu mismatches\n", pR->featChecks, pR->featMismatch);
+    if (pR->samples != 0u)
+    {
+        printf("Log: %lu bytes, %.2f bytes per sample\n",
+               pR->logBytes, (double)pR->logBytes / (double)pR->samples);
+    }
+
+    if ((loops != 0u) && (pR->numSamples != 0u))
+    {
+        ProxRssi_CtxType *pCtx = malloc(sizeof(ProxRssi_CtxType));
+        uint32_t unlocks = 0u;
+        clock_t start = clock();
+
+        for (unsigned long l = 0u; l < loops; l++)
+        {
+            unlocks += FlightReplay_Bench(pR, pCtx);
+        }
+
+        double sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+        double total = (double)pR->numSamples * (double)loops;
+        printf("Bench: %.0f samples in %.3f s, %.2f M samples/s (%u unlocks)\n",
+               total, sec, (sec > 0.0) ? (total / sec / 1e6) : 0.0, unlocks);
+        free(pCtx);
+    }
+
+    free(pBlocks);
+    free(pBuf);
+    free(pR->pSamples);
+    free(pR->pConfigs);
+
+    int ret = ((pR->evMismatch != 0u) || (pR->featMismatch != 0u)) ? 1 : 0;
+    free(pR);
+
+    return ret;
+}
+#endif /* FLIGHT_REPLAY_NO_MAIN */
@@ -0,0 +1,245 @@
+/*! *********************************************************************************
+* \file log_export_decode.c
+*
+* \brief  Host decoder for the framed CS data log exported by log_export.c.
+*
+*         Reads a raw serial capture, resynchronises on the frame sync word,
+*         checks the CRC and reports sequence gaps and overflow frames.
+*         Optionally writes the HCI payloads back to back (-r), which gives
+*         the unframed H4 stream of the previous exporter, and the RAS
+*         payloads (-R).
+*
+*         Build:  cc -std=c11 -O2 -I kw47_keyless_entry \
+*                    -I libs/middleware/wireless/framework/Common \
+*                    -o tools/log_export_decode tools/log_export_decode.c
+*
+*         Usage:  log_export_decode [-q] [-r hci.bin] [-R ras.bin] capture.bin
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_export.h"
+#include "log_export.c"
+
+/*******************************************************************************
+ * Decoder
+ ******************************************************************************/
+
+typedef struct
+{
+    uint16_t       len;
+    uint32_t       timestampUs;
+    uint8_t        type;
+    uint8_t        seq;
+    const uint8_t *pPayload;
+} logDecodeFrame_t;
+
+typedef enum
+{
+    logDecodeNeedMore_c,        /* Incomplete frame at the end of the buffer */
+    logDecodeFrame_c,           /* Valid frame returned */
+    logDecodeCrcError_c         /* Sync found but CRC wrong, one byte skipped */
+} logDecodeResult_t;
+
+/* Decode the next frame at or after pBuf. *pUsed is the number of bytes to drop
+ * from the buffer before the next call, *pSkipped the garbage bytes among them. */
+static logDecodeResult_t LogDecode_Next(const uint8_t *pBuf, size_t len,
+                                        logDecodeFrame_t *pFrame,
+                                        size_t *pUsed, size_t *pSkipped)
+{
+    size_t i = 0u;
+
+    *pUsed    = 0u;
+    *pSkipped = 0u;
+
+    for (;;)
+    {
+        while ((i + 1u < len) && !((pBuf[i] == LOG_EXPORT_SYNC_0) && (pBuf[i + 1u] == LOG_EXPORT_SYNC_1)))
+        {
+            i++;
+        }
+
+        if (i + LOG_EXPORT_HDR_LEN > len)
+        {
+            *pUsed = *pSkipped = i;
+            return logDecodeNeedMore_c;
+        }
+
+        uint16_t payloadLen = (uint16_t)(pBuf[i + 2u] | (pBuf[i + 3u] << 8));
+        size_t frameLen = (size_t)payloadLen + LOG_EXPORT_OVERHEAD;
+
+        if (i + frameLen > len)
+        {
+            *pUsed = *pSkipped = i;
+            return logDecodeNeedMore_c;
+        }
+
+        uint16_t crc = LogExport_Crc16(0xFFFFu, &pBuf[i + 2u], (uint32_t)(frameLen - 2u - LOG_EXPORT_CRC_LEN));
+        uint16_t rxCrc = (uint16_t)(pBuf[i + frameLen - 2u] | (pBuf[i + frameLen - 1u] << 8));
+
+        if (crc != rxCrc)
+        {
+            /* False sync or corrupted frame: resume the search one byte later */
+            *pUsed = *pSkipped = i + 1u;
+            return logDecodeCrcError_c;
+        }
+
+        pFrame->len         = payloadLen;
+        pFrame->timestampUs = (uint32_t)pBuf[i + 4u] | ((uint32_t)pBuf[i + 5u] << 8) |
+                              ((uint32_t)pBuf[i + 6u] << 16) | ((uint32_t)pBuf[i + 7u] << 24);
+        pFrame->type        = pBuf[i + 8u];
+        pFrame->seq         = pBuf[i + 9u];
+        pFrame->pPayload    = &pBuf[i + LOG_EXPORT_HDR_LEN];
+
+        *pSkipped = i;
+        *pUsed    = i + frameLen;
+        return logDecodeFrame_c;
+    }
+}
+
+static uint32_t LogDecode_Get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+#ifndef LOG_DECODE_NO_MAIN
+int main(int argc, char *argv[])
+{
+    const char *pInPath = NULL;
+    const char *pHciPath = NULL;
+    const char *pRasPath = NULL;
+    FILE *pHciOut = NULL;
+    FILE *pRasOut = NULL;
+    int quiet = 0;
+
+    for (int a = 1; a < argc; a++)
+    {
+        if ((strcmp(argv[a], "-q") == 0))                      { quiet = 1; }
+        else if ((strcmp(argv[a], "-r") == 0) && (a + 1 < argc)) { pHciPath = argv[++a]; }
+        else if ((strcmp(argv[a], "-R") == 0) && (a + 1 < argc)) { pRasPath = argv[++a]; }
+        else                                                    { pInPath = argv[a]; }
+    }
+
+    if (pInPath == NULL)
+    {
+        fprintf(stderr, "usage: %s [-q] [-r hci.bin] [-R ras.bin] capture.bin\n", argv[0]);
+        return 2;
+    }
+
+    FILE *pIn = fopen(pInPath, "rb");
+    if (pIn == NULL)
+    {
+        perror(pInPath);
+        return 1;
+    }
+    fseek(pIn, 0, SEEK_END);
+    long fileLen = ftell(pIn);
+    fseek(pIn, 0, SEEK_SET);
+    uint8_t *pBuf = malloc((size_t)fileLen + 1u);
+    if ((pBuf == NULL) || (fread(pBuf, 1u, (size_t)fileLen, pIn) != (size_t)fileLen))
+    {
+        fprintf(stderr, "cannot read %s\n", pInPath);
+        fclose(pIn);
+        return 1;
+    }
+    fclose(pIn);
+
+    if (pHciPath != NULL) { pHciOut = fopen(pHciPath, "wb"); }
+    if (pRasPath != NULL) { pRasOut = fopen(pRasPath, "wb"); }
+
+    size_t pos = 0u;
+    unsigned long frames = 0u, hciFrames = 0u, rasFrames = 0u, crcErrors = 0u, skipped = 0u;
+    unsigned long seqGaps = 0u, lostBySeq = 0u, ovfFrames = 0u, ovfBytes = 0u;
+    uint64_t timeUs = 0u;
+    uint32_t lastTs = 0u;
+    int haveSeq = 0;
+    uint8_t nextSeq = 0u;
+
+    for (;;)
+    {
+        logDecodeFrame_t frame;
+        size_t used, skip;
+        logDecodeResult_t res = LogDecode_Next(&pBuf[pos], (size_t)fileLen - pos, &frame, &used, &skip);
+
+        pos += used;
+        skipped += skip;
+
+        if (res == logDecodeNeedMore_c)
+        {
+            skipped += (size_t)fileLen - pos;
+            break;
+        }
+        if (res == logDecodeCrcError_c)
+        {
+            crcErrors++;
+            continue;
+        }
+
+        frames++;
+        if (haveSeq && (frame.seq != nextSeq))
+        {
+            seqGaps++;
+            lostBySeq += (uint8_t)(frame.seq - nextSeq);
+        }
+        haveSeq = 1;
+        nextSeq = (uint8_t)(frame.seq + 1u);
+
+        /* Unwrap the 32-bit us timestamp */
+        if (frames == 1u) { timeUs = frame.timestampUs; }
+        else              { timeUs += (uint32_t)(frame.timestampUs - lastTs); }
+        lastTs = frame.timestampUs;
+
+        switch (frame.type)
+        {
+            case LOG_EXPORT_TYPE_HCI:
+                hciFrames++;
+                if (pHciOut != NULL) { fwrite(frame.pPayload, 1u, frame.len, pHciOut); }
+                break;
+            case LOG_EXPORT_TYPE_RAS:
+                rasFrames++;
+                if (pRasOut != NULL) { fwrite(frame.pPayload, 1u, frame.len, pRasOut); }
+                break;
+            case LOG_EXPORT_TYPE_OVERFLOW:
+                if (frame.len >= 8u)
+                {
+                    ovfFrames += LogDecode_Get32(frame.pPayload);
+                    ovfBytes  += LogDecode_Get32(&frame.pPayload[4]);
+                }
+                break;
+            default:
+                break;
+        }
+
+        if (!quiet)
+        {
+            printf("%12.6f  seq %3u  type 0x%02X  len %5u",
+                   (double)timeUs / 1e6, frame.seq, frame.type, frame.len);
+            if ((frame.type == LOG_EXPORT_TYPE_OVERFLOW) && (frame.len >= 8u))
+            {
+                printf("  OVERFLOW: %u frames / %u bytes dropped",
+                       LogDecode_Get32(frame.pPayload), LogDecode_Get32(&frame.pPayload[4]));
+            }
+            printf("\n");
+        }
+    }
+
+    printf("\nFrames: %lu (HCI %lu, RAS %lu)\n", frames, hciFrames, rasFrames);
+    printf("Dropped on target: %lu frames, %lu bytes\n", ovfFrames, ovfBytes);
+    printf("Sequence gaps: %lu (%lu frames lost in transit)\n", seqGaps, lostBySeq);
+    printf("CRC errors: %lu, bytes skipped: %lu\n", crcErrors, skipped);
+
+    if (pHciOut != NULL) { fclose(pHciOut); }
+    if (pRasOut != NULL) { fclose(pRasOut); }
+    free(pBuf);
+
+    return ((crcErrors != 0u) || (seqGaps != 0u)) ? 1 : 0;
+}
+#endif /* LOG_DECODE_NO_MAIN */
@@ -0,0 +1,1574 @@
+/*! *********************************************************************************
+* \file prox_batch.c
+*
+* \brief  Host batch replay engine for fleets of ProxRssi traces.
+*
+*         Replays many independent RSSI traces (one per vehicle) through the
+*         ProxRssi pipeline, 16 traces at a time in structure-of-arrays form,
+*         and produces exactly what ProxRssi_PushRaw + ProxRssi_MainFunction
+*         return for every sample: events, features and the final state.
+*
+*         Layout: a group holds the raw and smoothed windows of its 16 lanes
+*         as rows by age (row 0 newest, one column per lane), which is the
+*         ring order of ProxRssi.c. The per-sample work that grows with the
+*         window (window masks, Hampel median and MAD, feature sums) runs
+*         across the lanes in SIMD kernels; the O(1) steps (EMA, state
+*         machine) call the static functions of the real ProxRssi.c on a
+*         per-lane context, so the decision logic is not duplicated.
+*
+*         The SIMD kernels sort every lane's window at once with a Batcher
+*         sorting network (non-members padded with INT16_MAX) and pick row
+*         n / 2, the element ProxRssi_InsertionSortS16 + median gives. Feature
+*         sums fit 32 bits: PushRaw clamps to -127 dBm, so |x| <= 2032 Q4 and
+*         128 squares stay below 2^31.
+*
+*         Kernels: "c" (portable, insertion sort like ProxRssi.c), "sse2"
+*         and "avx2" (x86, picked at run time). Traces are sorted by length
+*         and groups are spread over worker threads. -V replays the fleet
+*         again through the scalar ProxRssi.c and checks every trace.
+*
+*         Build:  cc -std=c11 -O2 -pthread -I kw47_keyless_entry \
+*                    -I libs/middleware/wireless/framework/Common \
+*                    -o tools/prox_batch tools/prox_batch.c -lm
+*
+*         Usage:  prox_batch [options] [trace.csv ...]
+*
+*           -l file     list of trace CSV files, one per line
+*           -n n        synthetic fleet of n vehicles (default 2048, no CSV given)
+*           -s n        samples per synthetic vehicle, at most (default 4096)
+*           -S seed     seed of the synthetic fleet (default 1)
+*           -j n        worker threads (default: all cores)
+*           -k name     kernel: c, sse2 or avx2 (default: best available)
+*           -r n        timed repetitions, best is reported (default 1)
+*           -V          verify against the scalar ProxRssi.c
+*           -o file     per trace results as CSV
+*
+*         Trace CSV rows are "tMs,rssi" as written by flight_rec_replay -c.
+*         Every row is one ProxRssi_PushRaw + ProxRssi_MainFunction call.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE             /* sysconf(_SC_NPROCESSORS_ONLN), getopt, clock_gettime */
+#endif
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ProxRssi.h"
+#include "ProxRssi.c"
+#include "prox_rssi_params.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PROX_BATCH_X86              (1)
+#define PROX_BATCH_AVX2             __attribute__((target("avx2")))
+#endif
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define PROX_BATCH_LANES            (16u)
+#define PROX_BATCH_ALL_LANES        (0xFFFFu)
+#define PROX_BATCH_LUT_LEN          (1001u)     /* RSSI_ALPHA_LUT_LEN in rssi_integration.c */
+#define PROX_BATCH_MAX_THREADS      (256u)
+#define PROX_BATCH_NO_UNLOCK        (0xFFFFFFFFu)
+#define PROX_BATCH_HASH_INIT        (0xCBF29CE484222325ull)
+#define PROX_BATCH_NET_LOG2_MAX     (6u)        /* Sorting networks up to PROX_RSSI_RAW_CAP inputs */
+#define PROX_BATCH_NET_MAX_CE       (543u)      /* Comparators of the 64 input network */
+
+/* One trace: every sample is one PushRaw + MainFunction call */
+typedef struct
+{
+    uint32_t *pTMs;
+    int8_t   *pRssi;
+    uint32_t  n;
+} proxBatchTrace_t;
+
+/* Output of one MainFunction call */
+typedef struct
+{
+    ProxRssi_EventType    ev;
+    ProxRssi_FeaturesType feat;
+} proxBatchStep_t;
+
+typedef struct
+{
+    proxBatchStep_t *pSteps;            /* Optional, n entries, set by the caller */
+    uint64_t         hash;              /* Over every event and feature set */
+    uint32_t         candidates;
+    uint32_t         unlocks;
+    uint32_t         exits;
+    uint32_t         firstUnlockMs;     /* PROX_BATCH_NO_UNLOCK if none */
+    uint8_t          finalSt;
+} proxBatchResult_t;
+
+typedef struct
+{
+    proxBatchTrace_t *pTraces;
+    uint32_t          numTraces;
+    uint32_t          cap;
+} proxBatchFleet_t;
+
+/* Window of one group step: inputs per lane, kernel outputs per lane */
+typedef struct
+{
+    uint32_t minT[PROX_BATCH_LANES];    /* Members: t not before minT (wrap-safe) */
+    uint32_t minTKeep[PROX_BATCH_LANES];/* Prune: oldest rows before this go */
+    int16_t  count[PROX_BATCH_LANES];   /* Live rows in, rows left after the prune out;
+                                         * 0 for lanes not taking part */
+    uint32_t rows;                      /* Largest count in */
+    int16_t  enterQ4;
+    int16_t  n[PROX_BATCH_LANES];
+    int16_t  med[PROX_BATCH_LANES];
+    int16_t  mad[PROX_BATCH_LANES];
+    int32_t  sum[PROX_BATCH_LANES];
+    int32_t  sumSq[PROX_BATCH_LANES];
+    int16_t  above[PROX_BATCH_LANES];
+    int16_t  mn[PROX_BATCH_LANES];
+    int16_t  mx[PROX_BATCH_LANES];
+    int16_t  last[PROX_BATCH_LANES];
+} proxBatchWin_t;
+
+typedef struct
+{
+    /* Windows by age from row `base` on (newest). Each push moves base one
+     * row down; at 0 the live rows are copied back up to row cap. */
+    uint32_t rawT[2u * PROX_RSSI_RAW_CAP][PROX_BATCH_LANES];
+    int16_t  rawQ4[2u * PROX_RSSI_RAW_CAP][PROX_BATCH_LANES];
+    uint32_t smT[2u * PROX_RSSI_SMOOTH_CAP][PROX_BATCH_LANES];
+    int16_t  smQ4[2u * PROX_RSSI_SMOOTH_CAP][PROX_BATCH_LANES];
+    uint32_t rawBase;
+    uint32_t smBase;
+    int16_t  rawCount[PROX_BATCH_LANES];
+    int16_t  smCount[PROX_BATCH_LANES];
+    proxBatchWin_t win;
+
+    /* Scalar state per lane; the context's own rings are not used */
+    ProxRssi_CtxType         aCtx[PROX_BATCH_LANES];
+    const proxBatchTrace_t  *apTrace[PROX_BATCH_LANES];
+    proxBatchResult_t       *apResult[PROX_BATCH_LANES];
+} proxBatchGroup_t;
+
+/* Compare-exchange of rows a < b */
+typedef struct
+{
+    uint8_t a;
+    uint8_t b;
+} proxBatchCe_t;
+
+typedef struct
+{
+    const char *pName;
+    /* Both prune the window, then reduce its members */
+    void (*pfnHampel)(const uint32_t (*pT)[PROX_BATCH_LANES], const int16_t (*pQ4)[PROX_BATCH_LANES],
+                      proxBatchWin_t *pW);
+    void (*pfnFeatures)(const uint32_t (*pT)[PROX_BATCH_LANES], const int16_t (*pQ4)[PROX_BATCH_LANES],
+                        proxBatchWin_t *pW);
+    bool_t (*pfnSupported)(void);
+} proxBatchKernel_t;
+
+typedef struct
+{
+    const proxBatchTrace_t  *pTraces;
+    proxBatchResult_t       *pResults;
+    uint32_t                *pOrder;        /* Longest trace first */
+    uint32_t                 numTraces;
+    const proxBatchKernel_t *pKernel;       /* NULL: scalar ProxRssi.c */
+    ProxRssi_ParamsType      params;
+    atomic_uint              next;
+} proxBatchJob_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static uint16_t gaProxBatchLut[PROX_BATCH_LUT_LEN];
+static proxBatchCe_t gaProxBatchNet[PROX_BATCH_NET_LOG2_MAX + 1u][PROX_BATCH_NET_MAX_CE];
+static uint16_t gaProxBatchNetLen[PROX_BATCH_NET_LOG2_MAX + 1u];
+
+/*******************************************************************************
+ * Parameters and results
+ ******************************************************************************/
+
+/* Parameter set and LUT of RssiIntegration_Init */
+static void ProxBatch_DefaultParams(ProxRssi_ParamsType *pP)
+{
+    for (uint32_t i = 0u; i < PROX_BATCH_LUT_LEN; i++)
+    {
+        uint32_t alpha = PROX_PARAM_ALPHA_START_Q15 + ((i * PROX_PARAM_ALPHA_SLOPE_Q15) / 1000u);
+
+        gaProxBatchLut[i] = (uint16_t)((alpha > 32767u) ? 32767u : alpha);
+    }
+
+    memset(pP, 0, sizeof(*pP));
+    pP->wRawMs            = PROX_PARAM_W_RAW_MS;
+    pP->wSpikeMs          = PROX_PARAM_W_SPIKE_MS;
+    pP->wFeatMs           = PROX_PARAM_W_FEAT_MS;
+    pP->hampelKQ4         = PROX_PARAM_HAMPEL_K_Q4;
+    pP->madEpsQ4          = PROX_PARAM_MAD_EPS_Q4;
+    pP->enterNearQ4       = ProxRssi_DbmToQ4((int8_t)PROX_PARAM_ENTER_NEAR_DBM);
+    pP->exitNearQ4        = ProxRssi_DbmToQ4((int8_t)PROX_PARAM_EXIT_NEAR_DBM);
+    pP->hystQ4            = (uint16_t)ProxRssi_DbToQ4((int16_t)PROX_PARAM_HYST_DB);
+    pP->pctThQ15          = PROX_PARAM_PCT_TH_Q15;
+    pP->stdThQ4           = PROX_PARAM_STD_TH_Q4;
+    pP->stableMs          = PROX_PARAM_STABLE_MS;
+    pP->minFeatSamples    = PROX_PARAM_MIN_FEAT_SAMPLES;
+    pP->exitConfirmMs     = PROX_PARAM_EXIT_CONFIRM_MS;
+    pP->lockoutMs         = PROX_PARAM_LOCKOUT_MS;
+    pP->maxReasonableDtMs = PROX_PARAM_MAX_REASONABLE_DT_MS;
+}
+
+static void ProxBatch_ResetResult(proxBatchResult_t *pR)
+{
+    pR->hash          = PROX_BATCH_HASH_INIT;
+    pR->candidates    = 0u;
+    pR->unlocks       = 0u;
+    pR->exits         = 0u;
+    pR->firstUnlockMs = PROX_BATCH_NO_UNLOCK;
+    pR->finalSt       = (uint8_t)PROX_RSSI_ST_FAR;
+}
+
+static uint64_t ProxBatch_Mix(uint64_t h, uint64_t v)
+{
+    h ^= v;
+    h *= 0x100000001B3ull;
+    return h ^ (h >> 29);
+}
+
+/* Book one MainFunction output; both engines go through here */
+static void ProxBatch_Account(proxBatchResult_t *pR, uint32_t step, uint32_t nowMs,
+                              ProxRssi_EventType ev, const ProxRssi_FeaturesType *pF)
+{
+    uint64_t w1 = (uint64_t)ev | ((uint64_t)pF->n << 8) | ((uint64_t)pF->pctAboveEnterQ15 << 24) |
+                  ((uint64_t)pF->stdQ4 << 40);
+    uint64_t w2 = (uint64_t)(uint16_t)pF->lastQ4 | ((uint64_t)(uint16_t)pF->minQ4 << 16) |
+                  ((uint64_t)(uint16_t)pF->maxQ4 << 32);
+
+    pR->hash = ProxBatch_Mix(ProxBatch_Mix(pR->hash, w1), w2);
+    if (ev == PROX_RSSI_EVT_CANDIDATE_STARTED)
+    {
+        pR->candidates++;
+    }
+    else if (ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED)
+    {
+        if (pR->unlocks == 0u)
+        {
+            pR->firstUnlockMs = nowMs;
+        }
+        pR->unlocks++;
+    }
+    else if (ev == PROX_RSSI_EVT_EXIT_TO_FAR)
+    {
+        pR->exits++;
+    }
+    else
+    {
+        /* PROX_RSSI_EVT_NONE */
+    }
+    if (pR->pSteps != NULL)
+    {
+        pR->pSteps[step].ev   = ev;
+        pR->pSteps[step].feat = *pF;
+    }
+}
+
+/* Reference: the scalar ProxRssi.c, one sample at a time */
+static void ProxBatch_RunScalar(const proxBatchTrace_t *pT, const ProxRssi_ParamsType *pParams,
+                                ProxRssi_CtxType *pCtx, proxBatchResult_t *pR)
+{
+    ProxBatch_ResetResult(pR);
+    (void)ProxRssi_Init(pCtx, pParams, gaProxBatchLut, PROX_BATCH_LUT_LEN);
+
+    for (uint32_t s = 0u; s < pT->n; s++)
+    {
+        ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+        ProxRssi_FeaturesType feat;
+
+        (void)ProxRssi_PushRaw(pCtx, pT->pTMs[s], pT->pRssi[s]);
+        (void)ProxRssi_MainFunction(pCtx, pT->pTMs[s], &ev, &feat);
+        ProxBatch_Account(pR, s, pT->pTMs[s], ev, &feat);
+    }
+    pR->finalSt = (uint8_t)pCtx->st;
+}
+
+/*******************************************************************************
+ * Kernels
+ ******************************************************************************/
+
+static uint32_t ProxBatch_MinT(uint32_t nowMs, uint32_t winMs)
+{
+    /* As ProxTime_InWindow: members are not before now - win, modulo 2^32 */
+    return nowMs - winMs;
+}
+
+static bool_t ProxBatch_Always(void)
+{
+    return TRUE;
+}
+
+/* Batcher odd-even merge sort networks for 2^k inputs, k = 0..6. A window of
+ * depth rows uses the network of the next power of two and skips comparators
+ * past its last row: those would only meet the INT16_MAX padding. */
+static void ProxBatch_BuildNetworks(void)
+{
+    for (uint32_t k = 0u; k <= PROX_BATCH_NET_LOG2_MAX; k++)
+    {
+        const uint32_t n = 1u << k;
+        uint32_t len = 0u;
+
+        for (uint32_t p = 1u; p < n; p <<= 1)
+        {
+            for (uint32_t d = p; d >= 1u; d >>= 1)
+            {
+                for (uint32_t j = d % p; (j + d) < n; j += 2u * d)
+                {
+                    for (uint32_t i = 0u; (i < d) && ((i + j + d) < n); i++)
+                    {
+                        if (((i + j) / (2u * p)) == ((i + j + d) / (2u * p)))
+                        {
+                            gaProxBatchNet[k][len].a = (uint8_t)(i + j);
+                            gaProxBatchNet[k][len].b = (uint8_t)(i + j + d);
+                            len++;
+                        }
+                    }
+                }
+            }
+        }
+        gaProxBatchNetLen[k] = (uint16_t)len;
+    }
+}
+
+static const proxBatchCe_t *ProxBatch_Network(uint32_t depth, uint32_t *pLen)
+{
+    uint32_t k = 0u;
+
+    while ((1u << k) < depth)
+    {
+        k++;
+    }
+    *pLen = gaProxBatchNetLen[k];
+    return gaProxBatchNet[k];
+}
+
+/* Drop the oldest rows older than minTKeep, as ProxRssi_RawPrune / _SmoothPrune */
+static void ProxBatch_Prune(const uint32_t (*pT)[PROX_BATCH_LANES], proxBatchWin_t *pW, uint32_t lane)
+{
+    int16_t remaining = pW->count[lane];
+
+    while ((remaining > 0) && (ProxTime_Before(pT[remaining - 1][lane], pW->minTKeep[lane]) == TRUE))
+    {
+        remaining--;
+    }
+    pW->count[lane] = remaining;
+}
+
+/* Portable kernels: gather each lane's window and sort it like ProxRssi.c */
+static void ProxBatch_HampelC(const uint32_t (*pT)[PROX_BATCH_LANES], const int16_t (*pQ4)[PROX_BATCH_LANES],
+                              proxBatchWin_t *pW)
+{
+    int16_t aV[PROX_RSSI_RAW_CAP];
+    int16_t aD[PROX_RSSI_RAW_CAP];
+
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        uint16_t n = 0u;
+
+        ProxBatch_Prune(pT, pW, lane);
+        for (int32_t a = (int32_t)pW->count[lane] - 1; a >= 0; a--)
+        {
+            if (ProxTime_Before(pT[a][lane], pW->minT[lane]) == FALSE)
+            {
+                aV[n++] = pQ4[a][lane];
+            }
+        }
+        pW->n[lane] = (int16_t)n;
+        if (n == 0u)
+        {
+            continue;
+        }
+        ProxRssi_InsertionSortS16(aV, n);
+        pW->med[lane] = ProxRssi_MedianSortedS16(aV, n);
+        for (uint16_t i = 0u; i < n; i++)
+        {
+            int16_t d = (int16_t)(aV[i] - pW->med[lane]);
+
+            aD[i] = (d < 0) ? (int16_t)(-d) : d;
+        }
+        ProxRssi_InsertionSortS16(aD, n);
+        pW->mad[lane] = ProxRssi_MedianSortedS16(aD, n);
+    }
+}
+
+static void ProxBatch_FeaturesC(const uint32_t (*pT)[PROX_BATCH_LANES], const int16_t (*pQ4)[PROX_BATCH_LANES],
+                                proxBatchWin_t *pW)
+{
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        int16_t n = 0;
+
+        ProxBatch_Prune(pT, pW, lane);
+        pW->sum[lane]   = 0;
+        pW->sumSq[lane] = 0;
+        pW->above[lane] = 0;
+        pW->mn[lane]    = INT16_MAX;
+        pW->mx[lane]    = INT16_MIN;
+        for (int32_t a = (int32_t)pW->count[lane] - 1; a >= 0; a--)
+        {
+            int16_t x = pQ4[a][lane];
+
+            if (ProxTime_Before(pT[a][lane], pW->minT[lane]) == TRUE)
+            {
+                continue;
+            }
+            n++;
+            pW->sum[lane]   += x;
+            pW->sumSq[lane] += (int32_t)x * (int32_t)x;
+            pW->above[lane] += (x >= pW->enterQ4) ? 1 : 0;
+            pW->mn[lane]     = (x < pW->mn[lane]) ? x : pW->mn[lane];
+            pW->mx[lane]     = (x > pW->mx[lane]) ? x : pW->mx[lane];
+            pW->last[lane]   = x;
+        }
+        pW->n[lane] = n;
+    }
+}
+
+#if defined(PROX_BATCH_X86)
+/* SSE2: two halves of 8 lanes */
+
+static inline __m128i ProxBatch_Blend128(__m128i m, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+/* One pass from the oldest row down for lanes [h, h + 8): prunes the live count
+ * against minTKeep and marks members not older than minT. Returns the depth. */
+static uint32_t ProxBatch_MaskSse2(const uint32_t (*pT)[PROX_BATCH_LANES], proxBatchWin_t *pW, uint32_t h,
+                                   int16_t (*pM)[PROX_BATCH_LANES])
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i minLo = _mm_loadu_si128((const __m128i *)&pW->minT[h]);
+    const __m128i minHi = _mm_loadu_si128((const __m128i *)&pW->minT[h + 4u]);
+    const __m128i keepLo = _mm_loadu_si128((const __m128i *)&pW->minTKeep[h]);
+    const __m128i keepHi = _mm_loadu_si128((const __m128i *)&pW->minTKeep[h + 4u]);
+    const __m128i count = _mm_loadu_si128((const __m128i *)&pW->count[h]);
+    __m128i kept = _mm_setzero_si128();
+    __m128i seen = _mm_setzero_si128();
+    __m128i n = _mm_setzero_si128();
+    uint32_t depth = 0u;
+
+    for (uint32_t a = pW->rows; a-- > 0u;)
+    {
+        __m128i tLo = _mm_loadu_si128((const __m128i *)&pT[a][h]);
+        __m128i tHi = _mm_loadu_si128((const __m128i *)&pT[a][h + 4u]);
+        __m128i live = _mm_cmpgt_epi16(count, _mm_set1_epi16((short)a));
+        /* Wrap-safe "t before min": the signed difference is negative */
+        __m128i drop = _mm_packs_epi32(_mm_cmpgt_epi32(zero, _mm_sub_epi32(tLo, keepLo)),
+                                       _mm_cmpgt_epi32(zero, _mm_sub_epi32(tHi, keepHi)));
+        __m128i old = _mm_packs_epi32(_mm_cmpgt_epi32(zero, _mm_sub_epi32(tLo, minLo)),
+                                      _mm_cmpgt_epi32(zero, _mm_sub_epi32(tHi, minHi)));
+        __m128i hit = _mm_andnot_si128(drop, live);
+        __m128i m;
+
+        kept = ProxBatch_Blend128(_mm_andnot_si128(seen, hit), _mm_set1_epi16((short)(a + 1u)), kept);
+        seen = _mm_or_si128(seen, hit);
+        m = _mm_andnot_si128(old, seen);
+        _mm_storeu_si128((__m128i *)&pM[a][h], m);
+        n = _mm_sub_epi16(n, m);
+        if ((depth == 0u) && (_mm_movemask_epi8(m) != 0))
+        {
+            depth = a + 1u;
+        }
+    }
+    _mm_storeu_si128((__m128i *)&pW->count[h], kept);
+    _mm_storeu_si128((__m128i *)&pW->n[h], n);
+    return depth;
+}
+
+/* Sort the rows of every lane (members first: padding is INT16_MAX) */
+static void ProxBatch_SortSse2(__m128i *pS, uint32_t depth)
+{
+    uint32_t len;
+    const proxBatchCe_t *pNet = ProxBatch_Network(depth, &len);
+
+    for (uint32_t c = 0u; c < len; c++)
+    {
+        if (pNet[c].b < depth)
+        {
+            __m128i x = pS[pNet[c].a];
+            __m128i y = pS[pNet[c].b];
+
+            pS[pNet[c].a] = _mm_min_epi16(x, y);
+            pS[pNet[c].b] = _mm_max_epi16(x, y);
+        }
+    }
+}
+
+/* Row `rank` of each lane */
+static __m128i ProxBatch_PickSse2(const __m128i *pS, uint32_t depth, __m128i rank)
+{
+    __m128i out = _mm_setzero_si128();
+
+    for (uint32_t a = 0u; a < depth; a++)
+    {
+        out = ProxBatch_Blend128(_mm_cmpeq_epi16(rank, _mm_set1_epi16((short)a)), pS[a], out);
+    }
+    return out;
+}
+
+static void ProxBatch_HampelSse2(const uint32_t (*pT)[PROX_BATCH_LANES], const int16_t (*pQ4)[PROX_BATCH_LANES],
+                                 proxBatchWin_t *pW)
+{
+    int16_t aM[PROX_RSSI_RAW_CAP][PROX_BATCH_LANES];
+    __m128i aS[PROX_RSSI_RAW_CAP];
+    const __m128i maxV = _mm_set1_epi16(INT16_MAX);
+
+    for (uint32_t h = 0u; h < PROX_BATCH_LANES; h += 8u)
+    {
+        uint32_t depth = ProxBatch_MaskSse2(pT, pW, h, aM);
+        __m128i n = _mm_loadu_si128((const __m128i *)&pW->n[h]);
+        __m128i rank = _mm_srai_epi16(n, 1);
+        __m128i med;
+
+        for (uint32_t a = 0u; a < depth; a++)
+        {
+            aS[a] = ProxBatch_Blend128(_mm_loadu_si128((const __m128i *)&aM[a][h]),
+                                       _mm_loadu_si128((const __m128i *)&pQ4[a][h]), maxV);
+        }
+        ProxBatch_SortSse2(aS, depth);
+        med = ProxBatch_PickSse2(aS, depth, rank);
+
+        /* Absolute deviations of the members, which now sit in rows < n */
+        for (uint32_t a = 0u; a < depth; a++)
+        {
+            __m128i d = _mm_sub_epi16(aS[a], med);
+
+            d = _mm_max_epi16(d, _mm_sub_epi16(_mm_setzero_si128(), d));
+            aS[a] = ProxBatch_Blend128(_mm_cmpgt_epi16(n, _mm_set1_epi16((short)a)), d, maxV);
+        }
+        ProxBatch_SortSse2(aS, depth);
+        _mm_storeu_si128((__m128i *)&pW->med[h], med);
+        _mm_storeu_si128((__m128i *)&pW->mad[h], ProxBatch_PickSse2(aS, depth, rank));
+    }
+}
+
+static void ProxBatch_FeaturesSse2(const uint32_t (*pT)[PROX_BATCH_LANES], const int16_t (*pQ4)[PROX_BATCH_LANES],
+                                   proxBatchWin_t *pW)
+{
+    int16_t aM[PROX_RSSI_SMOOTH_CAP][PROX_BATCH_LANES];
+    const __m128i enter = _mm_set1_epi16(pW->enterQ4);
+    const __m128i maxV = _mm_set1_epi16(INT16_MAX);
+    const __m128i minV = _mm_set1_epi16(INT16_MIN);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (uint32_t h = 0u; h < PROX_BATCH_LANES; h += 8u)
+    {
+        uint32_t depth = ProxBatch_MaskSse2(pT, pW, h, aM);
+        __m128i sumLo = zero;
+        __m128i sumHi = zero;
+        __m128i sqLo = zero;
+        __m128i sqHi = zero;
+        __m128i above = zero;
+        __m128i last = zero;
+        __m128i mn = maxV;
+        __m128i mx = minV;
+
+        /* Oldest first, so "last" ends on the newest member */
+        for (uint32_t a = depth; a-- > 0u;)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)&pQ4[a][h]);
+            __m128i m = _mm_loadu_si128((const __m128i *)&aM[a][h]);
+            __m128i vm = _mm_and_si128(v, m);
+            __m128i zLo = _mm_unpacklo_epi16(vm, zero);
+            __m128i zHi = _mm_unpackhi_epi16(vm, zero);
+
+            sumLo = _mm_add_epi32(sumLo, _mm_srai_epi32(_mm_unpacklo_epi16(vm, vm), 16));
+            sumHi = _mm_add_epi32(sumHi, _mm_srai_epi32(_mm_unpackhi_epi16(vm, vm), 16));
+            sqLo  = _mm_add_epi32(sqLo, _mm_madd_epi16(zLo, zLo));
+            sqHi  = _mm_add_epi32(sqHi, _mm_madd_epi16(zHi, zHi));
+            above = _mm_sub_epi16(above, _mm_andnot_si128(_mm_cmpgt_epi16(enter, v), m));
+            mn    = _mm_min_epi16(mn, ProxBatch_Blend128(m, v, maxV));
+            mx    = _mm_max_epi16(mx, ProxBatch_Blend128(m, v, minV));
+            last  = ProxBatch_Blend128(m, v, last);
+        }
+        _mm_storeu_si128((__m128i *)&pW->sum[h], sumLo);
+        _mm_storeu_si128((__m128i *)&pW->sum[h + 4u], sumHi);
+        _mm_storeu_si128((__m128i *)&pW->sumSq[h], sqLo);
+        _mm_storeu_si128((__m128i *)&pW->sumSq[h + 4u], sqHi);
+        _mm_storeu_si128((__m128i *)&pW->above[h], above);
+        _mm_storeu_si128((__m128i *)&pW->mn[h], mn);
+        _mm_storeu_si128((__m128i *)&pW->mx[h], mx);
+        _mm_storeu_si128((__m128i *)&pW->last[h], last);
+    }
+}
+
+/* AVX2: all 16 lanes in one register */
+
+PROX_BATCH_AVX2 static uint32_t ProxBatch_MaskAvx2(const uint32_t (*pT)[PROX_BATCH_LANES], proxBatchWin_t *pW,
+                                                   int16_t (*pM)[PROX_BATCH_LANES])
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i minLo = _mm256_loadu_si256((const __m256i *)&pW->minT[0]);
+    const __m256i minHi = _mm256_loadu_si256((const __m256i *)&pW->minT[8]);
+    const __m256i keepLo = _mm256_loadu_si256((const __m256i *)&pW->minTKeep[0]);
+    const __m256i keepHi = _mm256_loadu_si256((const __m256i *)&pW->minTKeep[8]);
+    const __m256i count = _mm256_loadu_si256((const __m256i *)pW->count);
+    __m256i kept = _mm256_setzero_si256();
+    __m256i seen = _mm256_setzero_si256();
+    __m256i n = _mm256_setzero_si256();
+    uint32_t depth = 0u;
+
+    for (uint32_t a = pW->rows; a-- > 0u;)
+    {
+        __m256i tLo = _mm256_loadu_si256((const __m256i *)&pT[a][0]);
+        __m256i tHi = _mm256_loadu_si256((const __m256i *)&pT[a][8]);
+        __m256i live = _mm256_cmpgt_epi16(count, _mm256_set1_epi16((short)a));
+        /* packs works per 128-bit half, the permute restores lane order */
+        __m256i drop = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(_mm256_cmpgt_epi32(zero, _mm256_sub_epi32(tLo, keepLo)),
+                               _mm256_cmpgt_epi32(zero, _mm256_sub_epi32(tHi, keepHi))), 0xD8);
+        __m256i old = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(_mm256_cmpgt_epi32(zero, _mm256_sub_epi32(tLo, minLo)),
+                               _mm256_cmpgt_epi32(zero, _mm256_sub_epi32(tHi, minHi))), 0xD8);
+        __m256i hit = _mm256_andnot_si256(drop, live);
+        __m256i m;
+
+        kept = _mm256_blendv_epi8(kept, _mm256_set1_epi16((short)(a + 1u)), _mm256_andnot_si256(seen, hit));
+        seen = _mm256_or_si256(seen, hit);
+        m = _mm256_andnot_si256(old, seen);
+        _mm256_storeu_si256((__m256i *)pM[a], m);
+        n = _mm256_sub_epi16(n, m);
+        if ((depth == 0u) && (_mm256_testz_si256(m, m) == 0))
+        {
+            depth = a + 1u;
+        }
+    }
+    _mm256_storeu_si256((__m256i *)pW->count, kept);
+    _mm256_storeu_si256((__m256i *)pW->n, n);
+    return depth;
+}
+
+PROX_BATCH_AVX2 static void ProxBatch_SortAvx2(__m256i *pS, uint32_t depth)
+{
+    uint32_t len;
+    const proxBatchCe_t *pNet = ProxBatch_Network(depth, &len);
+
+    for (uint32_t c = 0u; c < len; c++)
+    {
+        if (pNet[c].b < depth)
+        {
+            __m256i x = pS[pNet[c].a];
+            __m256i y = pS[pNet[c].b];
+
+            pS[pNet[c].a] = _mm256_min_epi16(x, y);
+            pS[pNet[c].b] = _mm256_max_epi16(x, y);
+        }
+    }
+}
+
+PROX_BATCH_AVX2 static __m256i ProxBatch_PickAvx2(const __m256i *pS, uint32_t depth, __m256i rank)
+{
+    __m256i out = _mm256_setzero_si256();
+
+    for (uint32_t a = 0u; a < depth; a++)
+    {
+        out = _mm256_blendv_epi8(out, pS[a], _mm256_cmpeq_epi16(rank, _mm256_set1_epi16((short)a)));
+    }
+    return out;
+}
+
+PROX_BATCH_AVX2 static void ProxBatch_HampelAvx2(const uint32_t (*pT)[PROX_BATCH_LANES],
+                                                 const int16_t (*pQ4)[PROX_BATCH_LANES], proxBatchWin_t *pW)
+{
+    int16_t aM[PROX_RSSI_RAW_CAP][PROX_BATCH_LANES];
+    __m256i aS[PROX_RSSI_RAW_CAP];
+    const __m256i maxV = _mm256_set1_epi16(INT16_MAX);
+    uint32_t depth = ProxBatch_MaskAvx2(pT, pW, aM);
+    __m256i n = _mm256_loadu_si256((const __m256i *)pW->n);
+    __m256i rank = _mm256_srai_epi16(n, 1);
+    __m256i med;
+
+    for (uint32_t a = 0u; a < depth; a++)
+    {
+        aS[a] = _mm256_blendv_epi8(maxV, _mm256_loadu_si256((const __m256i *)pQ4[a]),
+                                   _mm256_loadu_si256((const __m256i *)aM[a]));
+    }
+    ProxBatch_SortAvx2(aS, depth);
+    med = ProxBatch_PickAvx2(aS, depth, rank);
+
+    /* Absolute deviations of the members, which now sit in rows < n */
+    for (uint32_t a = 0u; a < depth; a++)
+    {
+        aS[a] = _mm256_blendv_epi8(maxV, _mm256_abs_epi16(_mm256_sub_epi16(aS[a], med)),
+                                   _mm256_cmpgt_epi16(n, _mm256_set1_epi16((short)a)));
+    }
+    ProxBatch_SortAvx2(aS, depth);
+    _mm256_storeu_si256((__m256i *)pW->med, med);
+    _mm256_storeu_si256((__m256i *)pW->mad, ProxBatch_PickAvx2(aS, depth, rank));
+}
+
+PROX_BATCH_AVX2 static void ProxBatch_FeaturesAvx2(const uint32_t (*pT)[PROX_BATCH_LANES],
+                                                   const int16_t (*pQ4)[PROX_BATCH_LANES], proxBatchWin_t *pW)
+{
+    int16_t aM[PROX_RSSI_SMOOTH_CAP][PROX_BATCH_LANES];
+    const __m256i enter = _mm256_set1_epi16(pW->enterQ4);
+    const __m256i maxV = _mm256_set1_epi16(INT16_MAX);
+    const __m256i minV = _mm256_set1_epi16(INT16_MIN);
+    uint32_t depth = ProxBatch_MaskAvx2(pT, pW, aM);
+    __m256i sumLo = _mm256_setzero_si256();
+    __m256i sumHi = _mm256_setzero_si256();
+    __m256i sqLo = _mm256_setzero_si256();
+    __m256i sqHi = _mm256_setzero_si256();
+    __m256i above = _mm256_setzero_si256();
+    __m256i last = _mm256_setzero_si256();
+    __m256i mn = maxV;
+    __m256i mx = minV;
+
+    /* Oldest first, so "last" ends on the newest member */
+    for (uint32_t a = depth; a-- > 0u;)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)pQ4[a]);
+        __m256i m = _mm256_loadu_si256((const __m256i *)aM[a]);
+        __m256i vm = _mm256_and_si256(v, m);
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(vm));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(vm, 1));
+
+        sumLo = _mm256_add_epi32(sumLo, lo);
+        sumHi = _mm256_add_epi32(sumHi, hi);
+        sqLo  = _mm256_add_epi32(sqLo, _mm256_mullo_epi32(lo, lo));
+        sqHi  = _mm256_add_epi32(sqHi, _mm256_mullo_epi32(hi, hi));
+        above = _mm256_sub_epi16(above, _mm256_andnot_si256(_mm256_cmpgt_epi16(enter, v), m));
+        mn    = _mm256_min_epi16(mn, _mm256_blendv_epi8(maxV, v, m));
+        mx    = _mm256_max_epi16(mx, _mm256_blendv_epi8(minV, v, m));
+        last  = _mm256_blendv_epi8(last, v, m);
+    }
+    _mm256_storeu_si256((__m256i *)&pW->sum[0], sumLo);
+    _mm256_storeu_si256((__m256i *)&pW->sum[8], sumHi);
+    _mm256_storeu_si256((__m256i *)&pW->sumSq[0], sqLo);
+    _mm256_storeu_si256((__m256i *)&pW->sumSq[8], sqHi);
+    _mm256_storeu_si256((__m256i *)pW->above, above);
+    _mm256_storeu_si256((__m256i *)pW->mn, mn);
+    _mm256_storeu_si256((__m256i *)pW->mx, mx);
+    _mm256_storeu_si256((__m256i *)pW->last, last);
+}
+
+static bool_t ProxBatch_HasAvx2(void)
+{
+    __builtin_cpu_init();
+    return (__builtin_cpu_supports("avx2") != 0) ? TRUE : FALSE;
+}
+#endif /* PROX_BATCH_X86 */
+
+/* Best first */
+static const proxBatchKernel_t gaProxBatchKernels[] =
+{
+#if defined(PROX_BATCH_X86)
+    { "avx2", ProxBatch_HampelAvx2, ProxBatch_FeaturesAvx2, ProxBatch_HasAvx2 },
+    { "sse2", ProxBatch_HampelSse2, ProxBatch_FeaturesSse2, ProxBatch_Always },
+#endif /* PROX_BATCH_X86 */
+    { "c",    ProxBatch_HampelC,    ProxBatch_FeaturesC,    ProxBatch_Always },
+};
+
+#define PROX_BATCH_NUM_KERNELS      (sizeof(gaProxBatchKernels) / sizeof(gaProxBatchKernels[0]))
+
+/* Kernel by name, or the best supported one for NULL */
+static const proxBatchKernel_t *ProxBatch_Kernel(const char *pName)
+{
+    for (uint32_t k = 0u; k < PROX_BATCH_NUM_KERNELS; k++)
+    {
+        if (((pName == NULL) || (strcmp(pName, gaProxBatchKernels[k].pName) == 0)) &&
+            (gaProxBatchKernels[k].pfnSupported() == TRUE))
+        {
+            return &gaProxBatchKernels[k];
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * Group step
+ ******************************************************************************/
+
+static uint32_t ProxBatch_MaxCount(const int16_t *pCount)
+{
+    int16_t mx = 0;
+
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        mx = (pCount[lane] > mx) ? pCount[lane] : mx;
+    }
+    return (uint32_t)mx;
+}
+
+/* Push a sample into the lanes of pushMask. The window starts at row *pBase of
+ * a 2 * cap buffer and slides down one row per push, so no row moves for the
+ * pushing lanes; the others copy their live rows up one. When the base hits 0
+ * the live rows are copied back to the top. Count saturates at cap and the
+ * oldest row drops, as the ring of ProxRssi.c. */
+static void ProxBatch_ShiftIn(uint32_t (*pT)[PROX_BATCH_LANES], int16_t (*pQ4)[PROX_BATCH_LANES], uint32_t *pBase,
+                              int16_t *pCount, uint32_t cap, uint32_t pushMask, const uint32_t *pNewT,
+                              const int16_t *pNewQ4)
+{
+    uint32_t base = *pBase;
+
+    if (pushMask == 0u)
+    {
+        return;
+    }
+    if (base == 0u)
+    {
+        uint32_t live = ProxBatch_MaxCount(pCount);
+
+        memcpy(&pT[cap], &pT[0], live * sizeof(pT[0]));
+        memcpy(&pQ4[cap], &pQ4[0], live * sizeof(pQ4[0]));
+        base = cap;
+    }
+    base--;
+    *pBase = base;
+
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        if (((pushMask >> lane) & 1u) != 0u)
+        {
+            pT[base][lane]  = pNewT[lane];
+            pQ4[base][lane] = pNewQ4[lane];
+            if ((uint32_t)pCount[lane] < cap)
+            {
+                pCount[lane]++;
+            }
+        }
+        else
+        {
+            for (uint32_t a = 0u; a < (uint32_t)pCount[lane]; a++)
+            {
+                pT[base + a][lane]  = pT[base + a + 1u][lane];
+                pQ4[base + a][lane] = pQ4[base + a + 1u][lane];
+            }
+        }
+    }
+}
+
+/* Sample `step` of every lane: ProxRssi_PushRaw + ProxRssi_MainFunction */
+static void ProxBatch_Step(proxBatchGroup_t *pG, uint32_t step, const proxBatchKernel_t *pK)
+{
+    static const ProxRssi_FeaturesType noFeat = { 0u, 0u, 0u, 0, 0, 0 };
+    proxBatchWin_t *pW = &pG->win;
+    uint32_t aNow[PROX_BATCH_LANES];
+    uint32_t aNewT[PROX_BATCH_LANES];
+    int16_t aNewQ4[PROX_BATCH_LANES];
+    uint32_t active = 0u;
+    uint32_t push = 0u;
+
+    /* PushRaw */
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        const proxBatchTrace_t *pT = pG->apTrace[lane];
+        int8_t rssi;
+
+        if ((pT == NULL) || (step >= pT->n))
+        {
+            continue;
+        }
+        active |= 1u << lane;
+        aNow[lane] = pT->pTMs[step];
+        rssi = pT->pRssi[step];
+        if ((rssi == (int8_t)127) || (rssi >= (int8_t)0))
+        {
+            continue;
+        }
+        if (rssi < (int8_t)-127)
+        {
+            rssi = (int8_t)-127;
+        }
+        push |= 1u << lane;
+        aNewT[lane]  = aNow[lane];
+        aNewQ4[lane] = ProxRssi_DbmToQ4(rssi);
+    }
+    ProxBatch_ShiftIn(pG->rawT, pG->rawQ4, &pG->rawBase, pG->rawCount, PROX_RSSI_RAW_CAP, push, aNewT, aNewQ4);
+
+    /* MainFunction: the kernel prunes the raw window, then runs Hampel over the spike window */
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        if (((active >> lane) & 1u) != 0u)
+        {
+            pW->count[lane]    = pG->rawCount[lane];
+            pW->minTKeep[lane] = ProxBatch_MinT(aNow[lane], pG->aCtx[lane].tk.wRaw);
+            pW->minT[lane]     = ProxBatch_MinT(aNow[lane], pG->aCtx[lane].tk.wSpike);
+        }
+        else
+        {
+            /* Finished traces never come back */
+            pG->rawCount[lane] = 0;
+            pG->smCount[lane]  = 0;
+            pW->count[lane]    = 0;
+            pW->minTKeep[lane] = 0u;
+            pW->minT[lane]     = 0u;
+        }
+    }
+    if (active == 0u)
+    {
+        return;
+    }
+    pW->rows = ProxBatch_MaxCount(pW->count);
+    pK->pfnHampel(&pG->rawT[pG->rawBase], &pG->rawQ4[pG->rawBase], pW);
+    memcpy(pG->rawCount, pW->count, sizeof(pG->rawCount));
+
+    /* Spike decision and EMA per lane */
+    push = 0u;
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        ProxRssi_CtxType *pCtx = &pG->aCtx[lane];
+        int16_t madQ4;
+        int32_t thrQ8;
+        int16_t thrQ4;
+        int16_t latestQ4;
+        int16_t diff;
+        int16_t xQ4;
+
+        if (((active >> lane) & 1u) == 0u)
+        {
+            continue;
+        }
+        if ((pG->rawCount[lane] == 0) || (pW->n[lane] < 3))
+        {
+            ProxBatch_Account(pG->apResult[lane], step, aNow[lane], PROX_RSSI_EVT_NONE, &noFeat);
+            continue;
+        }
+
+        /* As ProxRssi_HampelSpikeReject */
+        madQ4 = pW->mad[lane];
+        if (madQ4 < (int16_t)pCtx->p.madEpsQ4)
+        {
+            madQ4 = (int16_t)pCtx->p.madEpsQ4;
+        }
+        thrQ8    = ((((int32_t)(int16_t)pCtx->p.hampelKQ4) * (int32_t)madQ4) * 3) / 2;
+        thrQ4    = (int16_t)(thrQ8 / (int32_t)PROX_RSSI_Q4_SCALE);
+        latestQ4 = pG->rawQ4[pG->rawBase][lane];
+        diff     = (int16_t)(latestQ4 - pW->med[lane]);
+        xQ4      = ((((diff < 0) ? (int16_t)(-diff) : diff)) > thrQ4) ? pW->med[lane] : latestQ4;
+
+        ProxRssi_EmaUpdate(pCtx, aNow[lane], xQ4, &aNewQ4[lane]);
+        aNewT[lane] = aNow[lane];
+        push |= 1u << lane;
+    }
+    /* Pushing before the prune keeps the same rows: the new one is never old
+     * and a row dropped at cap is the oldest, which the prune would keep only
+     * if the window were full anyway. Lanes without a push still prune here. */
+    ProxBatch_ShiftIn(pG->smT, pG->smQ4, &pG->smBase, pG->smCount, PROX_RSSI_SMOOTH_CAP, push, aNewT, aNewQ4);
+
+    /* Features over the smoothed window */
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        pW->count[lane]    = pG->smCount[lane];
+        pW->minTKeep[lane] = 0u;
+        if (((active >> lane) & 1u) != 0u)
+        {
+            pW->minTKeep[lane] = ProxBatch_MinT(aNow[lane], pG->aCtx[lane].tk.wFeat);
+        }
+        pW->minT[lane] = pW->minTKeep[lane];
+    }
+    pW->rows    = ProxBatch_MaxCount(pW->count);
+    pW->enterQ4 = pG->aCtx[0].p.enterNearQ4;
+    pK->pfnFeatures(&pG->smT[pG->smBase], &pG->smQ4[pG->smBase], pW);
+    memcpy(pG->smCount, pW->count, sizeof(pG->smCount));
+
+    /* As ProxRssi_ComputeFeatures + ProxRssi_StateStep */
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        ProxRssi_CtxType *pCtx = &pG->aCtx[lane];
+        ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+        ProxRssi_FeaturesType f = noFeat;
+        uint16_t n = (uint16_t)pW->n[lane];
+
+        if (((push >> lane) & 1u) == 0u)
+        {
+            continue;
+        }
+        if (n >= pCtx->p.minFeatSamples)
+        {
+            uint32_t stdQ4 = 0u;
+
+            /* The int64 divisions and ProxRssi_IsqrtU32 in double: sum^2 < 2^37 and
+             * sumSq < 2^31 are exact, and a true quotient that is not an integer
+             * sits at least 1/n >= 1/128 below the next one, far above the
+             * rounding error, so floor() and the sqrt truncation match. */
+            if (n > 1u)
+            {
+                const double sumQ4 = (double)pW->sum[lane];
+                double var = (double)pW->sumSq[lane] - floor((sumQ4 * sumQ4) / (double)n);
+
+                var = (var < 0.0) ? 0.0 : floor(var / (double)(n - 1u));
+                stdQ4 = (uint32_t)sqrt(var);
+            }
+            f.n                = n;
+            f.pctAboveEnterQ15 = (uint16_t)(((uint32_t)pW->above[lane] * (uint32_t)PROX_RSSI_Q15_ONE) / (uint32_t)n);
+            f.stdQ4            = (uint16_t)stdQ4;
+            f.lastQ4           = pW->last[lane];
+            f.minQ4            = pW->mn[lane];
+            f.maxQ4            = pW->mx[lane];
+            ev = ProxRssi_StateStep(pCtx, aNow[lane], &f);
+        }
+        ProxBatch_Account(pG->apResult[lane], step, aNow[lane], ev, &f);
+    }
+}
+
+/* Replay up to 16 traces through one group */
+static void ProxBatch_RunGroup(proxBatchGroup_t *pG, const proxBatchJob_t *pJob, uint32_t first)
+{
+    uint32_t maxN = 0u;
+
+    pG->rawBase = PROX_RSSI_RAW_CAP;
+    pG->smBase  = PROX_RSSI_SMOOTH_CAP;
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        pG->apTrace[lane]  = NULL;
+        pG->apResult[lane] = NULL;
+        pG->rawCount[lane] = 0;
+        pG->smCount[lane]  = 0;
+        if ((first + lane) < pJob->numTraces)
+        {
+            uint32_t idx = pJob->pOrder[first + lane];
+
+            pG->apTrace[lane]  = &pJob->pTraces[idx];
+            pG->apResult[lane] = &pJob->pResults[idx];
+            ProxBatch_ResetResult(pG->apResult[lane]);
+            (void)ProxRssi_Init(&pG->aCtx[lane], &pJob->params, gaProxBatchLut, PROX_BATCH_LUT_LEN);
+            maxN = (pJob->pTraces[idx].n > maxN) ? pJob->pTraces[idx].n : maxN;
+        }
+    }
+
+    for (uint32_t step = 0u; step < maxN; step++)
+    {
+        ProxBatch_Step(pG, step, pJob->pKernel);
+    }
+
+    for (uint32_t lane = 0u; lane < PROX_BATCH_LANES; lane++)
+    {
+        if (pG->apResult[lane] != NULL)
+        {
+            pG->apResult[lane]->finalSt = (uint8_t)pG->aCtx[lane].st;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Threads
+ ******************************************************************************/
+
+static void *ProxBatch_Worker(void *pArg)
+{
+    proxBatchJob_t *pJob = (proxBatchJob_t *)pArg;
+    proxBatchGroup_t *pG = malloc(sizeof(proxBatchGroup_t));
+    ProxRssi_CtxType *pCtx = malloc(sizeof(ProxRssi_CtxType));
+
+    if ((pG != NULL) && (pCtx != NULL))
+    {
+        for (;;)
+        {
+            uint32_t first = atomic_fetch_add(&pJob->next, PROX_BATCH_LANES);
+
+            if (first >= pJob->numTraces)
+            {
+                break;
+            }
+            if (pJob->pKernel != NULL)
+            {
+                ProxBatch_RunGroup(pG, pJob, first);
+            }
+            else
+            {
+                for (uint32_t i = first; (i < (first + PROX_BATCH_LANES)) && (i < pJob->numTraces); i++)
+                {
+                    uint32_t idx = pJob->pOrder[i];
+
+                    ProxBatch_RunScalar(&pJob->pTraces[idx], &pJob->params, pCtx, &pJob->pResults[idx]);
+                }
+            }
+        }
+    }
+    free(pG);
+    free(pCtx);
+    return NULL;
+}
+
+static const proxBatchTrace_t *gpProxBatchSortTraces;
+
+static int ProxBatch_CmpLength(const void *pA, const void *pB)
+{
+    uint32_t a = gpProxBatchSortTraces[*(const uint32_t *)pA].n;
+    uint32_t b = gpProxBatchSortTraces[*(const uint32_t *)pB].n;
+
+    if (a != b)
+    {
+        return (a > b) ? -1 : 1;
+    }
+    return (*(const uint32_t *)pA < *(const uint32_t *)pB) ? -1 : 1;
+}
+
+/* Replay every trace with pKernel (NULL: scalar ProxRssi.c) on numThreads
+ * workers. pResults[i] belongs to pTraces[i]. Returns 0 on success. */
+static int ProxBatch_Run(const proxBatchTrace_t *pTraces, proxBatchResult_t *pResults, uint32_t numTraces,
+                         const ProxRssi_ParamsType *pParams, const proxBatchKernel_t *pKernel, uint32_t numThreads)
+{
+    pthread_t aThreads[PROX_BATCH_MAX_THREADS];
+    proxBatchJob_t job;
+    uint32_t started = 0u;
+
+    job.pTraces   = pTraces;
+    job.pResults  = pResults;
+    job.numTraces = numTraces;
+    job.pKernel   = pKernel;
+    job.params    = *pParams;
+    job.pOrder    = malloc(((numTraces != 0u) ? numTraces : 1u) * sizeof(uint32_t));
+    atomic_init(&job.next, 0u);
+    if (job.pOrder == NULL)
+    {
+        return -1;
+    }
+
+    ProxBatch_BuildNetworks();
+
+    /* Similar lengths share a group, so few lanes idle at its end */
+    for (uint32_t i = 0u; i < numTraces; i++)
+    {
+        job.pOrder[i] = i;
+    }
+    gpProxBatchSortTraces = pTraces;
+    qsort(job.pOrder, numTraces, sizeof(uint32_t), ProxBatch_CmpLength);
+
+    if (numThreads > PROX_BATCH_MAX_THREADS)
+    {
+        numThreads = PROX_BATCH_MAX_THREADS;
+    }
+    for (uint32_t t = 1u; t < numThreads; t++)
+    {
+        if (pthread_create(&aThreads[started], NULL, ProxBatch_Worker, &job) == 0)
+        {
+            started++;
+        }
+    }
+    (void)ProxBatch_Worker(&job);
+    for (uint32_t t = 0u; t < started; t++)
+    {
+        (void)pthread_join(aThreads[t], NULL);
+    }
+    free(job.pOrder);
+
+    /* A worker that failed to allocate leaves work for the others, not holes */
+    return (atomic_load(&job.next) >= numTraces) ? 0 : -1;
+}
+
+/* Number of traces whose results differ */
+static uint32_t ProxBatch_Compare(const proxBatchResult_t *pA, const proxBatchResult_t *pB, uint32_t numTraces,
+                                  uint32_t *pFirstBad)
+{
+    uint32_t bad = 0u;
+
+    for (uint32_t i = 0u; i < numTraces; i++)
+    {
+        if ((pA[i].hash != pB[i].hash) || (pA[i].candidates != pB[i].candidates) ||
+            (pA[i].unlocks != pB[i].unlocks) || (pA[i].exits != pB[i].exits) ||
+            (pA[i].firstUnlockMs != pB[i].firstUnlockMs) || (pA[i].finalSt != pB[i].finalSt))
+        {
+            if ((bad == 0u) && (pFirstBad != NULL))
+            {
+                *pFirstBad = i;
+            }
+            bad++;
+        }
+    }
+    return bad;
+}
+
+/*******************************************************************************
+ * Fleet
+ ******************************************************************************/
+
+static uint64_t ProxBatch_SplitMix(uint64_t *pState)
+{
+    uint64_t z = (*pState += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static double ProxBatch_Uniform(uint64_t *pState)
+{
+    return (double)(ProxBatch_SplitMix(pState) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static proxBatchTrace_t *ProxBatch_AddTrace(proxBatchFleet_t *pFleet, uint32_t maxSamples)
+{
+    proxBatchTrace_t *pT;
+
+    if (pFleet->numTraces == pFleet->cap)
+    {
+        uint32_t cap = (pFleet->cap == 0u) ? 64u : (pFleet->cap * 2u);
+        proxBatchTrace_t *pNew = realloc(pFleet->pTraces, cap * sizeof(proxBatchTrace_t));
+
+        if (pNew == NULL)
+        {
+            return NULL;
+        }
+        pFleet->pTraces = pNew;
+        pFleet->cap     = cap;
+    }
+    pT = &pFleet->pTraces[pFleet->numTraces];
+    pT->n     = 0u;
+    pT->pTMs  = malloc(((maxSamples != 0u) ? maxSamples : 1u) * sizeof(uint32_t));
+    pT->pRssi = malloc((maxSamples != 0u) ? maxSamples : 1u);
+    if ((pT->pTMs == NULL) || (pT->pRssi == NULL))
+    {
+        free(pT->pTMs);
+        free(pT->pRssi);
+        return NULL;
+    }
+    pFleet->numTraces++;
+    return pT;
+}
+
+static void ProxBatch_FreeFleet(proxBatchFleet_t *pFleet)
+{
+    for (uint32_t i = 0u; i < pFleet->numTraces; i++)
+    {
+        free(pFleet->pTraces[i].pTMs);
+        free(pFleet->pTraces[i].pRssi);
+    }
+    free(pFleet->pTraces);
+    memset(pFleet, 0, sizeof(*pFleet));
+}
+
+/* Synthetic fleet: 10 Hz reads with jitter, repeated and late timestamps,
+ * gaps, a few steps back in time, spikes and invalid readings; every 16th
+ * vehicle runs across the 32-bit millisecond wrap */
+static int ProxBatch_Synthesize(proxBatchFleet_t *pFleet, uint32_t vehicles, uint32_t maxSamples, uint64_t seed)
+{
+    for (uint32_t v = 0u; v < vehicles; v++)
+    {
+        uint64_t rng = seed ^ (0xD1B54A32D192ED03ull * ((uint64_t)v + 1u));
+        uint32_t n = (maxSamples / 2u) + (uint32_t)(ProxBatch_Uniform(&rng) * (double)((maxSamples / 2u) + 1u));
+        proxBatchTrace_t *pT = ProxBatch_AddTrace(pFleet, n);
+        uint32_t t;
+        double mean = -90.0;
+        double target = -90.0;
+        uint32_t nextTargetMs;
+
+        if (pT == NULL)
+        {
+            return -1;
+        }
+        n = (n > maxSamples) ? maxSamples : n;
+        t = ((v % 16u) == 15u) ? (0xFFFFFFFFu - (uint32_t)(ProxBatch_Uniform(&rng) * 200000.0))
+                               : (uint32_t)(ProxBatch_Uniform(&rng) * 1e8);
+        nextTargetMs = 0u;
+
+        for (uint32_t s = 0u; s < n; s++)
+        {
+            double u = ProxBatch_Uniform(&rng);
+            double rssi;
+
+            if (u < 0.02)
+            {
+                /* Same timestamp again */
+            }
+            else if (u < 0.025)
+            {
+                t += 2500u + (uint32_t)(ProxBatch_Uniform(&rng) * 7500.0);
+            }
+            else if (u < 0.027)
+            {
+                t -= 50u;
+            }
+            else
+            {
+                t += 100u + (uint32_t)(ProxBatch_Uniform(&rng) * 30.0);
+            }
+
+            /* Walk towards a new distance every few seconds, near the car half the time */
+            if (nextTargetMs == 0u)
+            {
+                target = (ProxBatch_Uniform(&rng) < 0.5) ? (-50.0 + (15.0 * ProxBatch_Uniform(&rng)))
+                                                         : (-95.0 + (40.0 * ProxBatch_Uniform(&rng)));
+                nextTargetMs = 30u + (uint32_t)(ProxBatch_Uniform(&rng) * 150.0);
+            }
+            nextTargetMs--;
+            mean += (target - mean) * 0.08;
+
+            rssi = mean + (4.0 * (ProxBatch_Uniform(&rng) + ProxBatch_Uniform(&rng) +
+                                  ProxBatch_Uniform(&rng) - 1.5) * 2.0);
+            u = ProxBatch_Uniform(&rng);
+            if (u < 0.02)
+            {
+                rssi += (ProxBatch_Uniform(&rng) < 0.5) ? -20.0 : 15.0;
+            }
+            rssi = (rssi < -128.0) ? -128.0 : ((rssi > 20.0) ? 20.0 : rssi);
+
+            u = ProxBatch_Uniform(&rng);
+            pT->pTMs[s]  = t;
+            pT->pRssi[s] = (u < 0.03) ? (int8_t)127 : ((u < 0.033) ? (int8_t)-128 : (int8_t)lround(rssi));
+        }
+        pT->n = n;
+    }
+    return 0;
+}
+
+static int ProxBatch_LoadCsv(proxBatchFleet_t *pFleet, const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "r");
+    char line[128];
+    uint32_t lines = 0u;
+    proxBatchTrace_t *pT;
+
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", pPath);
+        return -1;
+    }
+    while (fgets(line, (int)sizeof(line), pFile) != NULL)
+    {
+        lines++;
+    }
+    rewind(pFile);
+
+    pT = ProxBatch_AddTrace(pFleet, lines);
+    if (pT == NULL)
+    {
+        fclose(pFile);
+        return -1;
+    }
+    while ((fgets(line, (int)sizeof(line), pFile) != NULL) && (pT->n < lines))
+    {
+        unsigned long t;
+        int rssi;
+
+        /* Header and comment lines do not parse */
+        if (sscanf(line, "%lu,%d", &t, &rssi) == 2)
+        {
+            pT->pTMs[pT->n]  = (uint32_t)t;
+            pT->pRssi[pT->n] = (int8_t)rssi;
+            pT->n++;
+        }
+    }
+    fclose(pFile);
+    return 0;
+}
+
+static int ProxBatch_LoadList(proxBatchFleet_t *pFleet, const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "r");
+    char line[512];
+    int rc = 0;
+
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", pPath);
+        return -1;
+    }
+    while ((rc == 0) && (fgets(line, (int)sizeof(line), pFile) != NULL))
+    {
+        char csv[400];
+
+        if ((sscanf(line, "%399s", csv) == 1) && (csv[0] != '#'))
+        {
+            rc = ProxBatch_LoadCsv(pFleet, csv);
+        }
+    }
+    fclose(pFile);
+    return rc;
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+#ifndef PROX_BATCH_NO_MAIN
+static double ProxBatch_Now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+/* Best wall time of `repeats` runs */
+static double ProxBatch_Time(const proxBatchFleet_t *pFleet, proxBatchResult_t *pResults,
+                             const ProxRssi_ParamsType *pParams, const proxBatchKernel_t *pKernel,
+                             uint32_t numThreads, uint32_t repeats)
+{
+    double best = 0.0;
+
+    for (uint32_t r = 0u; r < repeats; r++)
+    {
+        double t0 = ProxBatch_Now();
+
+        if (ProxBatch_Run(pFleet->pTraces, pResults, pFleet->numTraces, pParams, pKernel, numThreads) != 0)
+        {
+            return -1.0;
+        }
+        t0 = ProxBatch_Now() - t0;
+        best = ((r == 0u) || (t0 < best)) ? t0 : best;
+    }
+    return best;
+}
+
+static void ProxBatch_Usage(void)
+{
+    fprintf(stderr, "Usage: prox_batch [-l list | -n vehicles] [-s samples] [-S seed] [-j threads]\n"
+                    "                  [-k c|sse2|avx2] [-r repeats] [-V] [-o results.csv] [trace.csv ...]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    proxBatchFleet_t fleet = { 0 };
+    ProxRssi_ParamsType params;
+    const proxBatchKernel_t *pKernel;
+    const char *pKernelName = NULL;
+    const char *pList = NULL;
+    const char *pOutPath = NULL;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t numThreads = (cores > 0) ? (uint32_t)cores : 1u;
+    uint32_t vehicles = 2048u;
+    uint32_t samples = 4096u;
+    uint32_t repeats = 1u;
+    uint64_t seed = 1u;
+    uint64_t totalSamples = 0u;
+    uint64_t unlocks = 0u;
+    bool_t verify = FALSE;
+    proxBatchResult_t *pResults;
+    double sec;
+    int rc = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:n:s:S:j:k:r:Vo:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'l': pList       = optarg; break;
+            case 'n': vehicles    = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': samples     = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'S': seed        = strtoull(optarg, NULL, 0); break;
+            case 'j': numThreads  = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'k': pKernelName = optarg; break;
+            case 'r': repeats     = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'V': verify      = TRUE; break;
+            case 'o': pOutPath    = optarg; break;
+            default:
+                ProxBatch_Usage();
+                return 2;
+        }
+    }
+    numThreads = (numThreads == 0u) ? 1u : numThreads;
+    repeats    = (repeats == 0u) ? 1u : repeats;
+
+    pKernel = ProxBatch_Kernel(pKernelName);
+    if (pKernel == NULL)
+    {
+        fprintf(stderr, "Kernel '%s' not available\n", pKernelName);
+        return 2;
+    }
+
+    if (pList != NULL)
+    {
+        rc = ProxBatch_LoadList(&fleet, pList);
+    }
+    for (int i = optind; (rc == 0) && (i < argc); i++)
+    {
+        rc = ProxBatch_LoadCsv(&fleet, argv[i]);
+    }
+    if ((rc == 0) && (pList == NULL) && (optind >= argc))
+    {
+        rc = ProxBatch_Synthesize(&fleet, vehicles, samples, seed);
+    }
+    pResults = calloc((fleet.numTraces != 0u) ? fleet.numTraces : 1u, sizeof(proxBatchResult_t));
+    if ((rc != 0) || (pResults == NULL))
+    {
+        fprintf(stderr, "Cannot load the fleet\n");
+        ProxBatch_FreeFleet(&fleet);
+        free(pResults);
+        return 1;
+    }
+    for (uint32_t i = 0u; i < fleet.numTraces; i++)
+    {
+        totalSamples += fleet.pTraces[i].n;
+    }
+    ProxBatch_DefaultParams(&params);
+
+    sec = ProxBatch_Time(&fleet, pResults, &params, pKernel, numThreads, repeats);
+    for (uint32_t i = 0u; i < fleet.numTraces; i++)
+    {
+        unlocks += pResults[i].unlocks;
+    }
+    printf("Fleet: %u traces, %.2f M samples, %llu unlocks\n", fleet.numTraces, (double)totalSamples / 1e6,
+           (unsigned long long)unlocks);
+    printf("Kernel %-5s %3u threads: %8.3f s, %8.2f M samples/s\n", pKernel->pName, numThreads, sec,
+           (double)totalSamples / (sec * 1e6));
+
+    if (verify == TRUE)
+    {
+        proxBatchResult_t *pRef = calloc((fleet.numTraces != 0u) ? fleet.numTraces : 1u, sizeof(proxBatchResult_t));
+        uint32_t firstBad = 0u;
+        uint32_t bad;
+        double refSec;
+
+        if (pRef == NULL)
+        {
+            rc = 1;
+        }
+        else
+        {
+            refSec = ProxBatch_Time(&fleet, pRef, &params, NULL, numThreads, repeats);
+            bad = ProxBatch_Compare(pResults, pRef, fleet.numTraces, &firstBad);
+            printf("Scalar ProxRssi.c %3u threads: %8.3f s, %8.2f M samples/s (batch %.1fx)\n", numThreads, refSec,
+                   (double)totalSamples / (refSec * 1e6), refSec / sec);
+            if (bad == 0u)
+            {
+                printf("Bit-exact: %u of %u traces\n", fleet.numTraces, fleet.numTraces);
+            }
+            else
+            {
+                printf("MISMATCH: %u of %u traces differ, first is trace %u\n", bad, fleet.numTraces, firstBad);
+                rc = 1;
+            }
+            free(pRef);
+        }
+    }
+
+    if (pOutPath != NULL)
+    {
+        FILE *pOut = fopen(pOutPath, "w");
+
+        if (pOut == NULL)
+        {
+            fprintf(stderr, "Cannot write %s\n", pOutPath);
+            rc = 1;
+        }
+        else
+        {
+            fprintf(pOut, "trace,samples,candidates,unlocks,exits,first_unlock_ms,final_state,hash\n");
+            for (uint32_t i = 0u; i < fleet.numTraces; i++)
+            {
+                const proxBatchResult_t *pR = &pResults[i];
+
+                fprintf(pOut, "%u,%u,%u,%u,%u,%ld,%u,%016llx\n", i, fleet.pTraces[i].n, pR->candidates,
+                        pR->unlocks, pR->exits,
+                        (pR->firstUnlockMs == PROX_BATCH_NO_UNLOCK) ? -1L : (long)pR->firstUnlockMs,
+                        (unsigned)pR->finalSt, (unsigned long long)pR->hash);
+            }
+            fclose(pOut);
+        }
+    }
+
+    free(pResults);
+    ProxBatch_FreeFleet(&fleet);
+    return rc;
+}
+#endif /* PROX_BATCH_NO_MAIN */
@@ -0,0 +1,1191 @@
+/*! *********************************************************************************
+* \file prox_fuzz.c
+*
+* \brief  Coverage and cost guided fuzzer hunting the worst-case execution path
+*         of one ProxRssi_PushRaw + ProxRssi_MainFunction call.
+*
+*         The cost of a call depends on the data: the two insertion sorts of
+*         the Hampel window are quadratic in its inversions, and the prune,
+*         copy and feature loops depend on how many samples the windows hold
+*         and on time anomalies (steps back, gaps over maxReasonableDtMs).
+*         The fuzzer mutates the (dt, rssi) sequence and the parameter set of
+*         an input and keeps an input when it reaches new edges of ProxRssi.c
+*         or makes the most expensive call of the input more expensive.
+*
+*         Cost of a call (-f):
+*
+*           blocks  basic blocks of ProxRssi.c executed, counted with
+*                   -fsanitize-coverage=trace-pc (the same hook gives the edge
+*                   coverage); deterministic for a given build
+*           ns      wall time of the call, for builds without the hook
+*           ops     trip count of every input dependent loop of the call:
+*                   prune, window copies, sort shifts, |x - median| and
+*                   feature loops (see ProxFuzz_Work)
+*
+*         Every loop trip count is bounded by PROX_RSSI_RAW_CAP and
+*         PROX_RSSI_SMOOTH_CAP, so ops has an analytic bound (ProxFuzz_OpsBound,
+*         4545 ops for 64/128). The report gives the worst call found, its
+*         loop breakdown, and how close it comes to that bound. The worst input
+*         is written as a fixture: a trace CSV ending with the worst call, the
+*         parameter set in a comment line. With -d the default parameter set
+*         is kept, so the fixture is a plain trace for prox_batch and prox_ref.
+*
+*         Build:  cc -std=c11 -O2 -fsanitize-coverage=trace-pc -I kw47_keyless_entry \
+*                    -I libs/middleware/wireless/framework/Common \
+*                    -o tools/prox_fuzz tools/prox_fuzz.c
+*
+*         libFuzzer / AFL++ (LLVMFuzzerTestOneInput, ops feedback, the worst
+*         input goes to $PROX_FUZZ_OUT):
+*
+*                 clang -O2 -g -fsanitize=fuzzer,address -DPROX_FUZZ_LIBFUZZER ... \
+*                    -o prox_fuzz_lf tools/prox_fuzz.c
+*
+*         Usage:  prox_fuzz [options] [fixture.csv ...]
+*
+*           -i n        executions (default 50000)
+*           -S seed     seed of the mutations (default 1)
+*           -f metric   blocks, ns or ops (default blocks, ops without the hook)
+*           -s n        samples per input, at most (default 256, up to 1024)
+*           -d          keep the default parameter set
+*           -o file     write the worst input as a fixture CSV
+*           -B ops      replay: fail when a fixture's worst call exceeds ops
+*
+*         With fixtures given, they are replayed instead and the worst call of
+*         each is reported (the regression check of the benchmark suite).
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE             /* getopt, clock_gettime */
+#endif
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ProxRssi.h"
+#include "ProxRssi.c"
+#include "prox_rssi_params.h"
+
+#ifdef PROX_FUZZ_LIBFUZZER
+#define PROX_FUZZ_NO_MAIN
+#endif
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define PROX_FUZZ_LUT_LEN           (1001u)     /* RSSI_ALPHA_LUT_LEN in rssi_integration.c */
+#define PROX_FUZZ_MAX_SAMPLES       (1024u)
+#define PROX_FUZZ_DEF_SAMPLES       (256u)
+#define PROX_FUZZ_HDR_LEN           (26u)       /* Parameter set and start time */
+#define PROX_FUZZ_REC_LEN           (3u)        /* int16 dt (LE, may step back), int8 rssi */
+#define PROX_FUZZ_MAX_LEN           (PROX_FUZZ_HDR_LEN + (PROX_FUZZ_MAX_SAMPLES * PROX_FUZZ_REC_LEN))
+#define PROX_FUZZ_MAP_SIZE          (1u << 16)
+#define PROX_FUZZ_CORPUS_MAX        (512u)
+
+/* Cost of a call */
+#define PROX_FUZZ_BLOCKS            (0u)
+#define PROX_FUZZ_NS                (1u)
+#define PROX_FUZZ_OPS               (2u)
+
+#if defined(__has_attribute)
+#if __has_attribute(no_sanitize_coverage)
+#define PROX_FUZZ_NO_COV            __attribute__((no_sanitize_coverage))
+#endif
+#endif
+#ifndef PROX_FUZZ_NO_COV
+#define PROX_FUZZ_NO_COV
+#endif
+
+/* One decoded input */
+typedef struct
+{
+    ProxRssi_ParamsType params;
+    uint32_t            tMs[PROX_FUZZ_MAX_SAMPLES];
+    int8_t              rssi[PROX_FUZZ_MAX_SAMPLES];
+    uint32_t            n;
+} proxFuzzCase_t;
+
+/* Loop trip counts of one call */
+typedef struct
+{
+    uint16_t rawDrop;                   /* ProxRssi_RawPrune */
+    uint16_t rawIter;                   /* ProxRssi_CopyRawWindowQ4 */
+    uint16_t spikeN;                    /* Hampel window: two sorts and the |x - median| pass */
+    uint16_t shiftsA;                   /* Insertion sort of the window */
+    uint16_t shiftsB;                   /* Insertion sort of |x - median| */
+    uint16_t smoothDrop;                /* Both ProxRssi_SmoothPrune calls */
+    uint16_t smoothIter;                /* ProxRssi_CopySmoothWindowQ4 */
+    uint16_t featN;                     /* Feature loop */
+} proxFuzzWork_t;
+
+typedef struct
+{
+    uint64_t       worst;               /* Cost of the most expensive call */
+    uint32_t       worstIdx;            /* Its sample index */
+    uint32_t       ops;
+    proxFuzzWork_t work;
+} proxFuzzResult_t;
+
+typedef struct
+{
+    uint8_t *pData;
+    uint32_t len;
+    uint64_t cost;
+} proxFuzzEntry_t;
+
+typedef struct
+{
+    proxFuzzEntry_t  aCorpus[PROX_FUZZ_CORPUS_MAX];
+    uint32_t         count;
+    uint32_t         best;              /* Corpus index of the worst input */
+    uint64_t         rng;
+    uint32_t         metric;
+    uint32_t         maxSamples;
+    bool_t           defaults;
+    uint64_t         execs;
+    uint32_t         edges;
+    proxFuzzResult_t worst;
+    proxFuzzCase_t   scratch;
+    uint8_t          aBuf[PROX_FUZZ_MAX_LEN];
+    uint8_t          aVirgin[PROX_FUZZ_MAP_SIZE];   /* Hit count buckets seen per edge */
+} proxFuzzEngine_t;
+
+/* Parameters as written to and read from the fixture comment line */
+typedef struct
+{
+    const char *pName;
+    size_t      offset;
+    uint8_t     size;
+    bool_t      isSigned;
+} proxFuzzParam_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static uint16_t gaProxFuzzLut[PROX_FUZZ_LUT_LEN];
+static bool_t   gProxFuzzLutReady = FALSE;
+
+/* trace-pc hook state, counting only while a ProxRssi call runs */
+static volatile bool_t gProxFuzzArmed = FALSE;
+static volatile uint64_t gProxFuzzBlocks = 0u;
+static uint32_t gProxFuzzPrev = 0u;
+static uint8_t  gaProxFuzzMap[PROX_FUZZ_MAP_SIZE];
+
+static const char *const gaProxFuzzMetricNames[] = { "blocks", "ns", "ops" };
+
+#define PROX_FUZZ_PARAM(field, isSigned) \
+    { #field, offsetof(ProxRssi_ParamsType, field), (uint8_t)sizeof(((ProxRssi_ParamsType *)0)->field), isSigned }
+
+static const proxFuzzParam_t gaProxFuzzParams[] =
+{
+    PROX_FUZZ_PARAM(wRawMs, FALSE),
+    PROX_FUZZ_PARAM(wSpikeMs, FALSE),
+    PROX_FUZZ_PARAM(wFeatMs, FALSE),
+    PROX_FUZZ_PARAM(hampelKQ4, FALSE),
+    PROX_FUZZ_PARAM(madEpsQ4, FALSE),
+    PROX_FUZZ_PARAM(enterNearQ4, TRUE),
+    PROX_FUZZ_PARAM(exitNearQ4, TRUE),
+    PROX_FUZZ_PARAM(hystQ4, FALSE),
+    PROX_FUZZ_PARAM(pctThQ15, FALSE),
+    PROX_FUZZ_PARAM(stdThQ4, FALSE),
+    PROX_FUZZ_PARAM(stableMs, FALSE),
+    PROX_FUZZ_PARAM(minFeatSamples, FALSE),
+    PROX_FUZZ_PARAM(exitConfirmMs, FALSE),
+    PROX_FUZZ_PARAM(lockoutMs, FALSE),
+    PROX_FUZZ_PARAM(maxReasonableDtMs, FALSE),
+};
+
+#define PROX_FUZZ_NUM_PARAMS        (sizeof(gaProxFuzzParams) / sizeof(gaProxFuzzParams[0]))
+
+/*******************************************************************************
+ * Coverage hook
+ ******************************************************************************/
+
+#ifndef PROX_FUZZ_LIBFUZZER
+void __sanitizer_cov_trace_pc(void);
+
+/* Called at every basic block when built with -fsanitize-coverage=trace-pc */
+PROX_FUZZ_NO_COV void __sanitizer_cov_trace_pc(void)
+{
+    if (gProxFuzzArmed == TRUE)
+    {
+        const uintptr_t pc = (uintptr_t)__builtin_return_address(0);
+        const uint32_t cur = (uint32_t)((pc >> 4) ^ (pc << 8)) & (PROX_FUZZ_MAP_SIZE - 1u);
+        uint8_t *pHit = &gaProxFuzzMap[cur ^ gProxFuzzPrev];
+
+        if (*pHit != 0xFFu)
+        {
+            (*pHit)++;
+        }
+        gProxFuzzPrev = cur >> 1;
+        gProxFuzzBlocks++;
+    }
+}
+#endif
+
+/*******************************************************************************
+ * Parameters
+ ******************************************************************************/
+
+static void ProxFuzz_BuildLut(void)
+{
+    /* Same ramp as RssiIntegration_BuildAlphaLut */
+    for (uint32_t i = 0u; i < PROX_FUZZ_LUT_LEN; i++)
+    {
+        uint32_t alpha = PROX_PARAM_ALPHA_START_Q15 + ((i * PROX_PARAM_ALPHA_SLOPE_Q15) / 1000u);
+
+        gaProxFuzzLut[i] = (uint16_t)((alpha > 32767u) ? 32767u : alpha);
+    }
+    gProxFuzzLutReady = TRUE;
+}
+
+/* Firmware defaults from prox_rssi_params.h, as RssiIntegration_Init sets them */
+static void ProxFuzz_DefaultParams(ProxRssi_ParamsType *pP)
+{
+    memset(pP, 0, sizeof(*pP));
+    pP->wRawMs            = PROX_PARAM_W_RAW_MS;
+    pP->wSpikeMs          = PROX_PARAM_W_SPIKE_MS;
+    pP->wFeatMs           = PROX_PARAM_W_FEAT_MS;
+    pP->hampelKQ4         = PROX_PARAM_HAMPEL_K_Q4;
+    pP->madEpsQ4          = PROX_PARAM_MAD_EPS_Q4;
+    pP->enterNearQ4       = ProxRssi_DbmToQ4((int8_t)PROX_PARAM_ENTER_NEAR_DBM);
+    pP->exitNearQ4        = ProxRssi_DbmToQ4((int8_t)PROX_PARAM_EXIT_NEAR_DBM);
+    pP->hystQ4            = (uint16_t)ProxRssi_DbToQ4((int16_t)PROX_PARAM_HYST_DB);
+    pP->pctThQ15          = PROX_PARAM_PCT_TH_Q15;
+    pP->stdThQ4           = PROX_PARAM_STD_TH_Q4;
+    pP->stableMs          = PROX_PARAM_STABLE_MS;
+    pP->minFeatSamples    = PROX_PARAM_MIN_FEAT_SAMPLES;
+    pP->exitConfirmMs     = PROX_PARAM_EXIT_CONFIRM_MS;
+    pP->lockoutMs         = PROX_PARAM_LOCKOUT_MS;
+    pP->maxReasonableDtMs = PROX_PARAM_MAX_REASONABLE_DT_MS;
+}
+
+static int64_t ProxFuzz_GetParam(const ProxRssi_ParamsType *pP, const proxFuzzParam_t *pDesc)
+{
+    const uint8_t *pField = (const uint8_t *)pP + pDesc->offset;
+
+    if (pDesc->size == 4u)
+    {
+        uint32_t v;
+
+        memcpy(&v, pField, sizeof(v));
+        return (int64_t)v;
+    }
+    if (pDesc->isSigned == TRUE)
+    {
+        int16_t v;
+
+        memcpy(&v, pField, sizeof(v));
+        return (int64_t)v;
+    }
+    {
+        uint16_t v;
+
+        memcpy(&v, pField, sizeof(v));
+        return (int64_t)v;
+    }
+}
+
+static void ProxFuzz_SetParam(ProxRssi_ParamsType *pP, const proxFuzzParam_t *pDesc, int64_t value)
+{
+    uint8_t *pField = (uint8_t *)pP + pDesc->offset;
+
+    if (pDesc->size == 4u)
+    {
+        const uint32_t v = (uint32_t)value;
+
+        memcpy(pField, &v, sizeof(v));
+    }
+    else
+    {
+        const uint16_t v = (uint16_t)value;
+
+        memcpy(pField, &v, sizeof(v));
+    }
+}
+
+/*******************************************************************************
+ * Input decoding
+ ******************************************************************************/
+
+static uint16_t ProxFuzz_U16(const uint8_t *p)
+{
+    return (uint16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+}
+
+/* Header: wRaw, wSpike, wFeat (u16 ms), hampelK, madEps (u8 Q4), enter (s8 dBm),
+ * hyst (u8 dB), pctTh (u16 Q15), stdTh (u8 Q4), stableMs (u16), minFeat (u8),
+ * exitConfirmMs, lockoutMs, maxReasonableDtMs (u16), t0 (u32). A short header
+ * reads as zeros, i.e. the defaults ProxRssi_Init falls back to. Then one
+ * record per call; a trailing partial record is ignored. */
+static void ProxFuzz_Decode(const uint8_t *pData, size_t len, bool_t defaults, uint32_t maxSamples,
+                            proxFuzzCase_t *pCase)
+{
+    uint8_t hdr[PROX_FUZZ_HDR_LEN] = { 0 };
+    const size_t hdrLen = (len < PROX_FUZZ_HDR_LEN) ? len : PROX_FUZZ_HDR_LEN;
+    ProxRssi_ParamsType *pP = &pCase->params;
+    uint32_t t;
+
+    memcpy(hdr, pData, hdrLen);
+    if (defaults == TRUE)
+    {
+        ProxFuzz_DefaultParams(pP);
+    }
+    else
+    {
+        memset(pP, 0, sizeof(*pP));
+        pP->wRawMs            = ProxFuzz_U16(&hdr[0]);
+        pP->wSpikeMs          = ProxFuzz_U16(&hdr[2]);
+        pP->wFeatMs           = ProxFuzz_U16(&hdr[4]);
+        pP->hampelKQ4         = hdr[6];
+        pP->madEpsQ4          = hdr[7];
+        pP->enterNearQ4       = ProxRssi_DbmToQ4((int8_t)hdr[8]);
+        pP->hystQ4            = (uint16_t)ProxRssi_DbToQ4((int16_t)hdr[9]);
+        pP->pctThQ15          = ProxFuzz_U16(&hdr[10]);
+        pP->stdThQ4           = hdr[12];
+        pP->stableMs          = ProxFuzz_U16(&hdr[13]);
+        pP->minFeatSamples    = hdr[15];
+        pP->exitConfirmMs     = ProxFuzz_U16(&hdr[16]);
+        pP->lockoutMs         = ProxFuzz_U16(&hdr[18]);
+        pP->maxReasonableDtMs = ProxFuzz_U16(&hdr[20]);
+    }
+    t = (uint32_t)hdr[22] | ((uint32_t)hdr[23] << 8) | ((uint32_t)hdr[24] << 16) | ((uint32_t)hdr[25] << 24);
+
+    pCase->n = 0u;
+    maxSamples = (maxSamples > PROX_FUZZ_MAX_SAMPLES) ? PROX_FUZZ_MAX_SAMPLES : maxSamples;
+    for (size_t off = PROX_FUZZ_HDR_LEN; ((off + PROX_FUZZ_REC_LEN) <= len) && (pCase->n < maxSamples);
+         off += PROX_FUZZ_REC_LEN)
+    {
+        /* Signed dt: steps back and the 32-bit wrap come from the data */
+        t += (uint32_t)(int32_t)(int16_t)ProxFuzz_U16(&pData[off]);
+        pCase->tMs[pCase->n]  = t;
+        pCase->rssi[pCase->n] = (int8_t)pData[off + 2u];
+        pCase->n++;
+    }
+}
+
+/*******************************************************************************
+ * Cost of a call
+ ******************************************************************************/
+
+/* Shifts of ProxRssi_InsertionSortS16 on a, which is left sorted */
+static uint32_t ProxFuzz_SortShifts(int16_t *a, uint16_t n)
+{
+    uint32_t shifts = 0u;
+
+    for (uint16_t i = 1u; i < n; i++)
+    {
+        const int16_t key = a[i];
+        uint16_t j = i;
+
+        while ((j > 0u) && (a[j - 1u] > key))
+        {
+            a[j] = a[j - 1u];
+            j--;
+            shifts++;
+        }
+        a[j] = key;
+    }
+    return shifts;
+}
+
+/* Trip counts of the MainFunction call that took pPre (after ProxRssi_PushRaw)
+ * to pPost, following its early returns. Returns the ops sum. */
+static uint32_t ProxFuzz_Work(const ProxRssi_CtxType *pPre, const ProxRssi_CtxType *pPost, uint32_t nowMs,
+                              proxFuzzWork_t *pW)
+{
+    ProxRssi_CtxType pruned = *pPre;
+    int16_t a[PROX_RSSI_RAW_CAP];
+    int16_t b[PROX_RSSI_RAW_CAP];
+    int16_t s[PROX_RSSI_SMOOTH_CAP];
+    int16_t last;
+    uint16_t n = 0u;
+
+    memset(pW, 0, sizeof(*pW));
+    ProxRssi_SmoothPrune(&pruned, nowMs, pPre->tk.wFeat);
+    pW->rawDrop    = (uint16_t)(pPre->raw.count - pPost->raw.count);
+    pW->smoothDrop = (uint16_t)(pPre->smooth.count - pruned.smooth.count);
+    pW->rawIter    = pPost->raw.count;
+
+    if ((pPost->raw.count != 0u) &&
+        (ProxRssi_CopyRawWindowQ4(pPost, nowMs, pPost->tk.wSpike, a, (uint16_t)PROX_RSSI_RAW_CAP, &n) == E_OK))
+    {
+        int16_t med;
+
+        pW->spikeN  = n;
+        pW->shiftsA = (uint16_t)ProxFuzz_SortShifts(a, n);
+        med = ProxRssi_MedianSortedS16(a, n);
+        for (uint16_t i = 0u; i < n; i++)
+        {
+            const int16_t d = (int16_t)(a[i] - med);
+
+            b[i] = (d < 0) ? (int16_t)(-d) : d;
+        }
+        pW->shiftsB = (uint16_t)ProxFuzz_SortShifts(b, n);
+
+        /* Smooth push (overwrites the oldest when full), prune again, copy */
+        {
+            const uint16_t pushed = (pruned.smooth.count < (uint16_t)PROX_RSSI_SMOOTH_CAP)
+                                        ? (uint16_t)(pruned.smooth.count + 1u)
+                                        : (uint16_t)PROX_RSSI_SMOOTH_CAP;
+
+            pW->smoothDrop = (uint16_t)(pW->smoothDrop + (pushed - pPost->smooth.count));
+        }
+        pW->smoothIter = pPost->smooth.count;
+        if (ProxRssi_CopySmoothWindowQ4(pPost, nowMs, pPost->tk.wFeat, s, (uint16_t)PROX_RSSI_SMOOTH_CAP,
+                                        &n, &last) == E_OK)
+        {
+            pW->featN = n;
+        }
+    }
+
+    return (uint32_t)pW->rawDrop + pW->rawIter + (3u * (uint32_t)pW->spikeN) + pW->shiftsA + pW->shiftsB +
+           pW->smoothDrop + pW->smoothIter + pW->featN;
+}
+
+/* Upper bound of ProxFuzz_Work from the ring capacities alone */
+static uint32_t ProxFuzz_OpsBound(void)
+{
+    const uint32_t raw = PROX_RSSI_RAW_CAP;
+    const uint32_t smooth = PROX_RSSI_SMOOTH_CAP;
+
+    /* Prune and copy together visit each raw sample once; two sorts of at most
+     * raw (raw - 1) / 2 shifts plus three passes over the Hampel window; the
+     * smooth prunes and copy visit the ring plus the new sample once; the
+     * feature loop visits the window */
+    return raw + (3u * raw) + (raw * (raw - 1u)) + (smooth + 1u) + smooth;
+}
+
+static uint64_t ProxFuzz_Now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/* One PushRaw + MainFunction call with the hook armed. pPre, if given, gets
+ * the context between the two, for ProxFuzz_Work. */
+static uint64_t ProxFuzz_Call(ProxRssi_CtxType *pCtx, uint32_t tMs, int8_t rssi, uint32_t metric,
+                              ProxRssi_CtxType *pPre)
+{
+    const uint64_t b0 = gProxFuzzBlocks;
+    const uint64_t t0 = (metric == PROX_FUZZ_NS) ? ProxFuzz_Now() : 0u;
+    ProxRssi_EventType ev;
+    ProxRssi_FeaturesType f;
+
+    gProxFuzzPrev = 0u;
+    gProxFuzzArmed = TRUE;
+    (void)ProxRssi_PushRaw(pCtx, tMs, rssi);
+    gProxFuzzArmed = FALSE;
+    if (pPre != NULL)
+    {
+        *pPre = *pCtx;
+    }
+    gProxFuzzArmed = TRUE;
+    (void)ProxRssi_MainFunction(pCtx, tMs, &ev, &f);
+    gProxFuzzArmed = FALSE;
+
+    return (metric == PROX_FUZZ_NS) ? (ProxFuzz_Now() - t0) : (gProxFuzzBlocks - b0);
+}
+
+static void ProxFuzz_Init(const proxFuzzCase_t *pCase, ProxRssi_CtxType *pCtx)
+{
+    if (gProxFuzzLutReady == FALSE)
+    {
+        ProxFuzz_BuildLut();
+    }
+    (void)ProxRssi_Init(pCtx, &pCase->params, gaProxFuzzLut, PROX_FUZZ_LUT_LEN);
+}
+
+/* Trip counts of call `idx` of the input */
+static uint32_t ProxFuzz_WorkAt(const proxFuzzCase_t *pCase, uint32_t idx, proxFuzzWork_t *pW)
+{
+    ProxRssi_CtxType ctx;
+    ProxRssi_CtxType pre;
+
+    ProxFuzz_Init(pCase, &ctx);
+    for (uint32_t i = 0u; i < idx; i++)
+    {
+        (void)ProxFuzz_Call(&ctx, pCase->tMs[i], pCase->rssi[i], PROX_FUZZ_BLOCKS, NULL);
+    }
+    (void)ProxFuzz_Call(&ctx, pCase->tMs[idx], pCase->rssi[idx], PROX_FUZZ_BLOCKS, &pre);
+    return ProxFuzz_Work(&pre, &ctx, pCase->tMs[idx], pW);
+}
+
+/* Runs ProxRssi.c over the input and reports its most expensive call */
+static void ProxFuzz_Run(const proxFuzzCase_t *pCase, uint32_t metric, proxFuzzResult_t *pRes)
+{
+    ProxRssi_CtxType ctx;
+    ProxRssi_CtxType pre;
+    proxFuzzWork_t work;
+
+    memset(pRes, 0, sizeof(*pRes));
+    ProxFuzz_Init(pCase, &ctx);
+    for (uint32_t i = 0u; i < pCase->n; i++)
+    {
+        uint64_t cost;
+
+        if (metric == PROX_FUZZ_OPS)
+        {
+            (void)ProxFuzz_Call(&ctx, pCase->tMs[i], pCase->rssi[i], metric, &pre);
+            cost = ProxFuzz_Work(&pre, &ctx, pCase->tMs[i], &work);
+        }
+        else
+        {
+            cost = ProxFuzz_Call(&ctx, pCase->tMs[i], pCase->rssi[i], metric, NULL);
+        }
+        if ((i == 0u) || (cost > pRes->worst))
+        {
+            pRes->worst    = cost;
+            pRes->worstIdx = i;
+            if (metric == PROX_FUZZ_OPS)
+            {
+                pRes->ops  = (uint32_t)cost;
+                pRes->work = work;
+            }
+        }
+    }
+    if ((metric != PROX_FUZZ_OPS) && (pCase->n != 0u))
+    {
+        pRes->ops = ProxFuzz_WorkAt(pCase, pRes->worstIdx, &pRes->work);
+    }
+}
+
+/*******************************************************************************
+ * Fuzzer
+ ******************************************************************************/
+
+static uint64_t ProxFuzz_SplitMix(uint64_t *pState)
+{
+    uint64_t z = (*pState += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint32_t ProxFuzz_Below(proxFuzzEngine_t *pE, uint32_t n)
+{
+    return (n == 0u) ? 0u : (uint32_t)(ProxFuzz_SplitMix(&pE->rng) % n);
+}
+
+/* AFL hit count buckets: 1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128+ */
+static uint8_t ProxFuzz_Bucket(uint8_t hits)
+{
+    static const uint8_t aLimits[7] = { 1u, 2u, 3u, 7u, 15u, 31u, 127u };
+    uint8_t bit = 0u;
+
+    while ((bit < 7u) && (hits > aLimits[bit]))
+    {
+        bit++;
+    }
+    return (uint8_t)(1u << bit);
+}
+
+/* Folds the hit map of the last execution into the virgin map, clears it */
+static bool_t ProxFuzz_NewCoverage(proxFuzzEngine_t *pE)
+{
+    bool_t isNew = FALSE;
+
+    for (uint32_t i = 0u; i < PROX_FUZZ_MAP_SIZE; i++)
+    {
+        if (gaProxFuzzMap[i] != 0u)
+        {
+            const uint8_t bucket = ProxFuzz_Bucket(gaProxFuzzMap[i]);
+
+            if ((pE->aVirgin[i] & bucket) == 0u)
+            {
+                pE->edges += (pE->aVirgin[i] == 0u) ? 1u : 0u;
+                pE->aVirgin[i] |= bucket;
+                isNew = TRUE;
+            }
+            gaProxFuzzMap[i] = 0u;
+        }
+    }
+    return isNew;
+}
+
+static void ProxFuzz_PutDt(uint8_t *pRec, int32_t dt)
+{
+    const int16_t v = (int16_t)((dt > 32767) ? 32767 : ((dt < -32768) ? -32768 : dt));
+
+    pRec[0] = (uint8_t)((uint16_t)v & 0xFFu);
+    pRec[1] = (uint8_t)((uint16_t)v >> 8);
+}
+
+/* Havoc: 1 to 8 stacked mutations, some of them aware of the record layout
+ * (dense runs, descending ramps for reverse ordered windows, time anomalies) */
+static uint32_t ProxFuzz_Mutate(proxFuzzEngine_t *pE, const proxFuzzEntry_t *pSrc, uint8_t *pOut)
+{
+    static const uint8_t aBytes[8] = { 0x00u, 0x01u, 0x10u, 0x40u, 0x7Fu, 0x80u, 0xC0u, 0xFFu };
+    static const uint16_t aWords[9] = { 0u, 1u, 16u, 255u, 256u, 1000u, 2000u, 0x7FFFu, 0xFFFFu };
+    const uint32_t maxLen = PROX_FUZZ_HDR_LEN + (pE->maxSamples * PROX_FUZZ_REC_LEN);
+    const uint32_t rounds = 1u + ProxFuzz_Below(pE, 8u);
+    uint32_t len = (pSrc->len > maxLen) ? maxLen : pSrc->len;
+
+    memcpy(pOut, pSrc->pData, len);
+    for (uint32_t r = 0u; r < rounds; r++)
+    {
+        const uint32_t recs = (len > PROX_FUZZ_HDR_LEN) ? ((len - PROX_FUZZ_HDR_LEN) / PROX_FUZZ_REC_LEN) : 0u;
+        const uint32_t at = ProxFuzz_Below(pE, recs);
+        uint8_t *pRec = &pOut[PROX_FUZZ_HDR_LEN + (at * PROX_FUZZ_REC_LEN)];
+        const uint32_t k = 2u + ProxFuzz_Below(pE, 63u);
+        const uint32_t run = ((at + k) > recs) ? (recs - at) : k;
+
+        switch (ProxFuzz_Below(pE, 11u))
+        {
+            case 0u:
+                pOut[ProxFuzz_Below(pE, len)] ^= (uint8_t)(1u << ProxFuzz_Below(pE, 8u));
+                break;
+            case 1u:
+                pOut[ProxFuzz_Below(pE, len)] = (uint8_t)ProxFuzz_SplitMix(&pE->rng);
+                break;
+            case 2u:
+                pOut[ProxFuzz_Below(pE, len)] = aBytes[ProxFuzz_Below(pE, 8u)];
+                break;
+            case 3u:
+            {
+                const uint32_t pos = ProxFuzz_Below(pE, len - 1u);
+                const uint16_t v = (uint16_t)(ProxFuzz_U16(&pOut[pos]) + ProxFuzz_Below(pE, 71u) - 35u);
+
+                pOut[pos]      = (uint8_t)(v & 0xFFu);
+                pOut[pos + 1u] = (uint8_t)(v >> 8);
+                break;
+            }
+            case 4u:
+            {
+                /* A parameter to an interesting value */
+                const uint32_t pos = ProxFuzz_Below(pE, PROX_FUZZ_HDR_LEN - 1u);
+                const uint16_t v = aWords[ProxFuzz_Below(pE, 9u)];
+
+                pOut[pos]      = (uint8_t)(v & 0xFFu);
+                pOut[pos + 1u] = (uint8_t)(v >> 8);
+                break;
+            }
+            case 5u:
+            {
+                /* Duplicate a block of records */
+                const uint32_t dup = (((recs + run) * PROX_FUZZ_REC_LEN) + PROX_FUZZ_HDR_LEN > maxLen)
+                                         ? 0u : run;
+
+                memmove(pRec + (dup * PROX_FUZZ_REC_LEN), pRec, (size_t)(len - (uint32_t)(pRec - pOut)));
+                len += dup * PROX_FUZZ_REC_LEN;
+                break;
+            }
+            case 6u:
+                if (run < recs)
+                {
+                    memmove(pRec, pRec + (run * PROX_FUZZ_REC_LEN),
+                            (size_t)(len - (uint32_t)(pRec - pOut) - (run * PROX_FUZZ_REC_LEN)));
+                    len -= run * PROX_FUZZ_REC_LEN;
+                }
+                break;
+            case 7u:
+            {
+                /* Descending ramp: the sorts see a reverse ordered window */
+                const int32_t r0 = -1 - (int32_t)ProxFuzz_Below(pE, 60u);
+                const int32_t step = 1 + (int32_t)ProxFuzz_Below(pE, 2u);
+
+                for (uint32_t i = 0u; i < run; i++)
+                {
+                    const int32_t v = r0 - ((int32_t)i * step);
+
+                    pRec[(i * PROX_FUZZ_REC_LEN) + 2u] = (uint8_t)(int8_t)((v < -127) ? -127 : v);
+                }
+                break;
+            }
+            case 8u:
+            {
+                /* Dense run: many samples inside the windows */
+                const int32_t dt = (int32_t)ProxFuzz_Below(pE, 21u);
+
+                for (uint32_t i = 0u; i < run; i++)
+                {
+                    ProxFuzz_PutDt(&pRec[i * PROX_FUZZ_REC_LEN], dt);
+                }
+                break;
+            }
+            case 9u:
+                /* Time anomaly: a gap or a step back */
+                if (recs != 0u)
+                {
+                    ProxFuzz_PutDt(pRec, (int32_t)ProxFuzz_Below(pE, 65536u) - 32768);
+                }
+                break;
+            default:
+            {
+                /* Splice in records of another input */
+                const proxFuzzEntry_t *pOther = &pE->aCorpus[ProxFuzz_Below(pE, pE->count)];
+                const uint32_t otherRecs = (pOther->len > PROX_FUZZ_HDR_LEN)
+                                               ? ((pOther->len - PROX_FUZZ_HDR_LEN) / PROX_FUZZ_REC_LEN) : 0u;
+                const uint32_t from = ProxFuzz_Below(pE, otherRecs);
+                const uint32_t take = ((from + run) > otherRecs) ? (otherRecs - from) : run;
+
+                memcpy(pRec, &pOther->pData[PROX_FUZZ_HDR_LEN + (from * PROX_FUZZ_REC_LEN)],
+                       (size_t)take * PROX_FUZZ_REC_LEN);
+                break;
+            }
+        }
+    }
+    return len;
+}
+
+/* Decodes and runs one input; returns the cost of its worst call */
+static uint64_t ProxFuzz_Exec(proxFuzzEngine_t *pE, const uint8_t *pData, uint32_t len, proxFuzzResult_t *pRes,
+                              bool_t *pNew)
+{
+    ProxFuzz_Decode(pData, len, pE->defaults, pE->maxSamples, &pE->scratch);
+    ProxFuzz_Run(&pE->scratch, pE->metric, pRes);
+    *pNew = ProxFuzz_NewCoverage(pE);
+    pE->execs++;
+    return pRes->worst;
+}
+
+/* Adds an input, replacing the cheapest one but the worst when full */
+static int ProxFuzz_Add(proxFuzzEngine_t *pE, const uint8_t *pData, uint32_t len, uint64_t cost)
+{
+    uint32_t slot = pE->count;
+    uint8_t *pCopy = malloc(len);
+
+    if (pCopy == NULL)
+    {
+        return -1;
+    }
+    if (pE->count == PROX_FUZZ_CORPUS_MAX)
+    {
+        slot = (pE->best == 0u) ? 1u : 0u;
+        for (uint32_t i = 0u; i < pE->count; i++)
+        {
+            if ((i != pE->best) && (pE->aCorpus[i].cost < pE->aCorpus[slot].cost))
+            {
+                slot = i;
+            }
+        }
+        free(pE->aCorpus[slot].pData);
+    }
+    else
+    {
+        pE->count++;
+    }
+    memcpy(pCopy, pData, len);
+    pE->aCorpus[slot].pData = pCopy;
+    pE->aCorpus[slot].len   = len;
+    pE->aCorpus[slot].cost  = cost;
+    return (int)slot;
+}
+
+/* Seeds: a steady trace at the default rate, a noisy approach, and a dense
+ * descending staircase with the spike window as long as the raw window */
+static int ProxFuzz_Seed(proxFuzzEngine_t *pE)
+{
+    const uint32_t recs = (pE->maxSamples < 256u) ? pE->maxSamples : 256u;
+    const uint32_t len = PROX_FUZZ_HDR_LEN + (recs * PROX_FUZZ_REC_LEN);
+
+    for (uint32_t seed = 0u; seed < 3u; seed++)
+    {
+        proxFuzzResult_t res;
+        bool_t isNew;
+        uint64_t cost;
+        int slot;
+
+        memset(pE->aBuf, 0, PROX_FUZZ_HDR_LEN);
+        if (seed == 2u)
+        {
+            pE->aBuf[0] = 0xD0u;            /* wRaw = wSpike = 2000 ms */
+            pE->aBuf[1] = 0x07u;
+            pE->aBuf[2] = 0xD0u;
+            pE->aBuf[3] = 0x07u;
+        }
+        for (uint32_t i = 0u; i < recs; i++)
+        {
+            uint8_t *pRec = &pE->aBuf[PROX_FUZZ_HDR_LEN + (i * PROX_FUZZ_REC_LEN)];
+            int32_t rssi;
+
+            if (seed == 0u)
+            {
+                ProxFuzz_PutDt(pRec, 100);
+                rssi = -55;
+            }
+            else if (seed == 1u)
+            {
+                ProxFuzz_PutDt(pRec, 70 + (int32_t)ProxFuzz_Below(pE, 60u));
+                rssi = -90 + (int32_t)((i * 50u) / recs) + (int32_t)ProxFuzz_Below(pE, 9u) - 4;
+            }
+            else
+            {
+                ProxFuzz_PutDt(pRec, 10);
+                rssi = -1 - (int32_t)(i % 64u);
+            }
+            pRec[2] = (uint8_t)(int8_t)rssi;
+        }
+        cost = ProxFuzz_Exec(pE, pE->aBuf, len, &res, &isNew);
+        slot = ProxFuzz_Add(pE, pE->aBuf, len, cost);
+        if (slot < 0)
+        {
+            return -1;
+        }
+        if ((pE->count == 1u) || (cost > pE->worst.worst))
+        {
+            pE->best  = (uint32_t)slot;
+            pE->worst = res;
+        }
+    }
+    return 0;
+}
+
+static proxFuzzEngine_t *ProxFuzz_Create(uint32_t metric, uint32_t maxSamples, bool_t defaults, uint64_t seed)
+{
+    proxFuzzEngine_t *pE = calloc(1u, sizeof(proxFuzzEngine_t));
+
+    if (pE == NULL)
+    {
+        return NULL;
+    }
+    pE->metric     = metric;
+    pE->maxSamples = ((maxSamples == 0u) || (maxSamples > PROX_FUZZ_MAX_SAMPLES)) ? PROX_FUZZ_MAX_SAMPLES
+                                                                                   : maxSamples;
+    pE->defaults   = defaults;
+    pE->rng        = seed;
+    memset(gaProxFuzzMap, 0, sizeof(gaProxFuzzMap));
+    if (ProxFuzz_Seed(pE) != 0)
+    {
+        free(pE);
+        return NULL;
+    }
+    return pE;
+}
+
+static void ProxFuzz_Destroy(proxFuzzEngine_t *pE)
+{
+    if (pE != NULL)
+    {
+        for (uint32_t i = 0u; i < pE->count; i++)
+        {
+            free(pE->aCorpus[i].pData);
+        }
+        free(pE);
+    }
+}
+
+/* `execs` mutations; half of them start from the worst input so far */
+static int ProxFuzz_Fuzz(proxFuzzEngine_t *pE, uint64_t execs, bool_t progress)
+{
+    static uint8_t aMut[PROX_FUZZ_MAX_LEN];
+
+    for (uint64_t x = 0u; x < execs; x++)
+    {
+        const uint32_t pick = (ProxFuzz_Below(pE, 2u) == 0u) ? pE->best : ProxFuzz_Below(pE, pE->count);
+        const uint32_t len = ProxFuzz_Mutate(pE, &pE->aCorpus[pick], aMut);
+        proxFuzzResult_t res;
+        bool_t isNew;
+        uint64_t cost = ProxFuzz_Exec(pE, aMut, len, &res, &isNew);
+        bool_t isWorse = (cost > pE->worst.worst) ? TRUE : FALSE;
+
+        if ((isWorse == TRUE) && (pE->metric == PROX_FUZZ_NS))
+        {
+            /* Wall time is noisy: the least of three runs must still be worse */
+            for (uint32_t r = 0u; r < 2u; r++)
+            {
+                proxFuzzResult_t again;
+
+                ProxFuzz_Run(&pE->scratch, PROX_FUZZ_NS, &again);
+                res = (again.worst < res.worst) ? again : res;
+            }
+            memset(gaProxFuzzMap, 0, sizeof(gaProxFuzzMap));
+            cost = res.worst;
+            isWorse = (cost > pE->worst.worst) ? TRUE : FALSE;
+        }
+
+        if ((isNew == TRUE) || (isWorse == TRUE))
+        {
+            const int slot = ProxFuzz_Add(pE, aMut, len, cost);
+
+            if (slot < 0)
+            {
+                return -1;
+            }
+            if (isWorse == TRUE)
+            {
+                pE->best  = (uint32_t)slot;
+                pE->worst = res;
+            }
+        }
+        if ((progress == TRUE) && (((pE->execs % 20000u) == 0u) || (isWorse == TRUE)))
+        {
+            fprintf(stderr, "#%llu corpus %u edges %u worst %llu %s, %u ops\n", (unsigned long long)pE->execs,
+                    pE->count, pE->edges, (unsigned long long)pE->worst.worst, gaProxFuzzMetricNames[pE->metric],
+                    pE->worst.ops);
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Fixtures
+ ******************************************************************************/
+
+/* Trace CSV up to and including the worst call, parameters in a comment */
+static int ProxFuzz_SaveFixture(const char *pPath, const proxFuzzCase_t *pCase, const proxFuzzResult_t *pRes)
+{
+    FILE *pFile = fopen(pPath, "w");
+    const proxFuzzWork_t *pW = &pRes->work;
+
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Cannot write %s\n", pPath);
+        return -1;
+    }
+    fprintf(pFile, "# prox_fuzz worst case, the last row is the most expensive call\n# params");
+    for (uint32_t i = 0u; i < PROX_FUZZ_NUM_PARAMS; i++)
+    {
+        fprintf(pFile, " %s=%lld", gaProxFuzzParams[i].pName,
+                (long long)ProxFuzz_GetParam(&pCase->params, &gaProxFuzzParams[i]));
+    }
+    fprintf(pFile, "\n# ops %u of %u: raw %u+%u, hampel %u, shifts %u+%u, smooth %u+%u, features %u\n",
+            pRes->ops, ProxFuzz_OpsBound(), pW->rawDrop, pW->rawIter, pW->spikeN, pW->shiftsA, pW->shiftsB,
+            pW->smoothDrop, pW->smoothIter, pW->featN);
+    fprintf(pFile, "t_ms,rssi\n");
+    for (uint32_t i = 0u; (i < pCase->n) && (i <= pRes->worstIdx); i++)
+    {
+        fprintf(pFile, "%u,%d\n", pCase->tMs[i], (int)pCase->rssi[i]);
+    }
+    fclose(pFile);
+    return 0;
+}
+
+/* Fixture or plain trace CSV; without a params line the defaults apply */
+static int ProxFuzz_LoadFixture(const char *pPath, proxFuzzCase_t *pCase)
+{
+    FILE *pFile = fopen(pPath, "r");
+    char line[512];
+
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", pPath);
+        return -1;
+    }
+    ProxFuzz_DefaultParams(&pCase->params);
+    pCase->n = 0u;
+    while (fgets(line, (int)sizeof(line), pFile) != NULL)
+    {
+        unsigned long t;
+        int rssi;
+
+        if (strncmp(line, "# params", 8u) == 0)
+        {
+            for (char *pTok = strtok(&line[8], " \r\n"); pTok != NULL; pTok = strtok(NULL, " \r\n"))
+            {
+                char *pEq = strchr(pTok, '=');
+
+                for (uint32_t i = 0u; (pEq != NULL) && (i < PROX_FUZZ_NUM_PARAMS); i++)
+                {
+                    if ((strncmp(pTok, gaProxFuzzParams[i].pName, (size_t)(pEq - pTok)) == 0) &&
+                        (gaProxFuzzParams[i].pName[pEq - pTok] == '\0'))
+                    {
+                        ProxFuzz_SetParam(&pCase->params, &gaProxFuzzParams[i], strtoll(pEq + 1, NULL, 0));
+                    }
+                }
+            }
+        }
+        /* Header and comment lines do not parse */
+        else if ((sscanf(line, "%lu,%d", &t, &rssi) == 2) && (pCase->n < PROX_FUZZ_MAX_SAMPLES))
+        {
+            pCase->tMs[pCase->n]  = (uint32_t)t;
+            pCase->rssi[pCase->n] = (int8_t)rssi;
+            pCase->n++;
+        }
+    }
+    fclose(pFile);
+    return 0;
+}
+
+/*******************************************************************************
+ * libFuzzer entry
+ ******************************************************************************/
+
+int LLVMFuzzerTestOneInput(const uint8_t *pData, size_t size);
+
+/* Ops feedback; every input that makes the worst call worse is written to
+ * $PROX_FUZZ_OUT (coverage comes from libFuzzer's own instrumentation) */
+int LLVMFuzzerTestOneInput(const uint8_t *pData, size_t size)
+{
+    static proxFuzzCase_t c;
+    static uint64_t worst = 0u;
+    proxFuzzResult_t res;
+
+    ProxFuzz_Decode(pData, size, FALSE, PROX_FUZZ_MAX_SAMPLES, &c);
+    ProxFuzz_Run(&c, PROX_FUZZ_OPS, &res);
+    if ((c.n != 0u) && (res.worst > worst))
+    {
+        const char *pOut = getenv("PROX_FUZZ_OUT");
+
+        worst = res.worst;
+        if (pOut != NULL)
+        {
+            (void)ProxFuzz_SaveFixture(pOut, &c, &res);
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+
+#ifndef PROX_FUZZ_NO_MAIN
+static void ProxFuzz_PrintWorst(const proxFuzzResult_t *pRes, uint32_t metric, uint32_t n)
+{
+    const proxFuzzWork_t *pW = &pRes->work;
+    const uint32_t bound = ProxFuzz_OpsBound();
+
+    printf("worst call: #%u of %u, %llu %s\n", pRes->worstIdx, n, (unsigned long long)pRes->worst,
+           gaProxFuzzMetricNames[metric]);
+    printf("  raw prune %u, raw copy %u, Hampel window %u/%u, sort shifts %u + %u of %u each\n", pW->rawDrop,
+           pW->rawIter, pW->spikeN, PROX_RSSI_RAW_CAP, pW->shiftsA, pW->shiftsB,
+           (PROX_RSSI_RAW_CAP * (PROX_RSSI_RAW_CAP - 1u)) / 2u);
+    printf("  smooth prune %u, smooth copy %u, feature window %u/%u\n", pW->smoothDrop, pW->smoothIter,
+           pW->featN, PROX_RSSI_SMOOTH_CAP);
+    printf("  ops %u, bound %u from the caps (%.1f %%)\n", pRes->ops, bound,
+           (100.0 * (double)pRes->ops) / (double)bound);
+}
+
+static void ProxFuzz_Usage(void)
+{
+    fprintf(stderr, "Usage: prox_fuzz [-i execs] [-S seed] [-f blocks|ns|ops] [-s samples] [-d] [-o fixture.csv]"
+                    " [-B ops] [fixture.csv ...]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    proxFuzzEngine_t *pE;
+    proxFuzzCase_t *pCase;
+    uint64_t execs = 50000u;
+    uint64_t seed = 1u;
+    uint32_t metric = 0xFFFFFFFFu;
+    uint32_t maxSamples = PROX_FUZZ_DEF_SAMPLES;
+    uint32_t budget = 0xFFFFFFFFu;
+    bool_t defaults = FALSE;
+    bool_t hooked;
+    const char *pOutPath = NULL;
+    int rc = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:S:f:s:do:B:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'i': execs      = strtoull(optarg, NULL, 0); break;
+            case 'S': seed       = strtoull(optarg, NULL, 0); break;
+            case 's': maxSamples = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'd': defaults   = TRUE; break;
+            case 'o': pOutPath   = optarg; break;
+            case 'B': budget     = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'f':
+                for (uint32_t m = 0u; m < 3u; m++)
+                {
+                    metric = (strcmp(optarg, gaProxFuzzMetricNames[m]) == 0) ? m : metric;
+                }
+                if (metric == 0xFFFFFFFFu)
+                {
+                    ProxFuzz_Usage();
+                    return 2;
+                }
+                break;
+            default:
+                ProxFuzz_Usage();
+                return 2;
+        }
+    }
+
+    pCase = malloc(sizeof(proxFuzzCase_t));
+    if (pCase == NULL)
+    {
+        return 1;
+    }
+
+    /* Is ProxRssi.c instrumented? */
+    ProxFuzz_DefaultParams(&pCase->params);
+    pCase->n = 1u;
+    pCase->tMs[0] = 1000u;
+    pCase->rssi[0] = -60;
+    {
+        proxFuzzResult_t probe;
+
+        ProxFuzz_Run(pCase, PROX_FUZZ_BLOCKS, &probe);
+        hooked = (probe.worst != 0u) ? TRUE : FALSE;
+    }
+    memset(gaProxFuzzMap, 0, sizeof(gaProxFuzzMap));
+    if (metric == 0xFFFFFFFFu)
+    {
+        metric = (hooked == TRUE) ? PROX_FUZZ_BLOCKS : PROX_FUZZ_OPS;
+    }
+    if ((metric == PROX_FUZZ_BLOCKS) && (hooked == FALSE))
+    {
+        fprintf(stderr, "Built without -fsanitize-coverage=trace-pc: no block counts, use -f ns or -f ops\n");
+        free(pCase);
+        return 2;
+    }
+
+    /* Replay */
+    if (optind < argc)
+    {
+        for (int i = optind; i < argc; i++)
+        {
+            proxFuzzResult_t res;
+
+            if (ProxFuzz_LoadFixture(argv[i], pCase) != 0)
+            {
+                rc = 1;
+                continue;
+            }
+            ProxFuzz_Run(pCase, metric, &res);
+            printf("%s: %u calls\n", argv[i], pCase->n);
+            ProxFuzz_PrintWorst(&res, metric, pCase->n);
+            if ((res.ops > budget) || (res.ops > ProxFuzz_OpsBound()))
+            {
+                printf("  over budget\n");
+                rc = 1;
+            }
+        }
+        free(pCase);
+        return rc;
+    }
+
+    pE = ProxFuzz_Create(metric, maxSamples, defaults, seed);
+    if ((pE == NULL) || (ProxFuzz_Fuzz(pE, execs, TRUE) != 0))
+    {
+        fprintf(stderr, "Out of memory\n");
+        ProxFuzz_Destroy(pE);
+        free(pCase);
+        return 1;
+    }
+
+    printf("%llu execs, %u inputs, %u edges%s, feedback %s%s\n", (unsigned long long)pE->execs, pE->count,
+           pE->edges, (hooked == TRUE) ? "" : " (no coverage hook)", gaProxFuzzMetricNames[metric],
+           (defaults == TRUE) ? ", default parameters" : "");
+    ProxFuzz_Decode(pE->aCorpus[pE->best].pData, pE->aCorpus[pE->best].len, defaults, pE->maxSamples, pCase);
+    ProxFuzz_PrintWorst(&pE->worst, metric, pCase->n);
+    if (pE->worst.ops > ProxFuzz_OpsBound())
+    {
+        printf("  bound exceeded\n");
+        rc = 1;
+    }
+    if ((pOutPath != NULL) && (ProxFuzz_SaveFixture(pOutPath, pCase, &pE->worst) != 0))
+    {
+        rc = 1;
+    }
+
+    ProxFuzz_Destroy(pE);
+    free(pCase);
+    return rc;
+}
+#endif /* PROX_FUZZ_NO_MAIN */
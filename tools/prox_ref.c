@@ -0,0 +1,1302 @@
+/*! *********************************************************************************
+* \file prox_ref.c
+*
+* \brief  Double precision reference model of the ProxRssi pipeline and a
+*         differential harness against the fixed-point ProxRssi.c.
+*
+*         The reference runs the same pipeline (windows, Hampel, EMA,
+*         features, state machine) with the same ring capacities, window
+*         rules and median index, so the only differences left are the
+*         fixed-point building blocks. Each of them can be switched back on
+*         separately to see what it costs:
+*
+*           q4      values and the EMA state in Q4 (1/16 dB), truncating
+*                   ProxRssi_MulAlphaQ15_DeltaQ4 step, integer Hampel threshold
+*           alpha   Q15 alpha from the 16 ms LUT instead of the linear ramp
+*                   the LUT samples
+*           isqrt   integer variance + ProxRssi_IsqrtU32 (on the window rounded
+*                   down to a whole Q8 variance when q4 is off)
+*
+*         q4+alpha+isqrt is the firmware, and the harness checks that it
+*         reproduces ProxRssi.c bit for bit on every trace. Cheaper
+*         approximations to evaluate on top of it:
+*
+*           shift   alpha rounded down to a power of two (EMA step is a shift)
+*           sqrt4   ProxRssi_IsqrtU32(var >> 4) << 2, std in 0.25 dB steps
+*
+*         The fraction above the enter threshold needs no switch: the Q15
+*         comparison pct >= pctTh is exact for integer counts.
+*
+*         For every mode the harness reports the error of the EMA output,
+*         the std feature and the fraction above enter against the double
+*         reference (bias, RMS, |error| percentiles), and the decision
+*         divergence: traces whose events differ, missing and extra unlocks,
+*         and the unlock / exit time shifts in ms.
+*
+*         Build:  cc -std=c11 -O2 -I kw47_keyless_entry \
+*                    -I libs/middleware/wireless/framework/Common \
+*                    -o tools/prox_ref tools/prox_ref.c -lm
+*
+*         Usage:  prox_ref [options] [trace.csv ...]
+*
+*           -l file     list of trace CSV files, one per line
+*           -n n        synthetic traces (default 500, no CSV given)
+*           -s n        samples per synthetic trace, at most (default 3000)
+*           -S seed     seed of the synthetic traces (default 1)
+*           -m flags    extra mode, e.g. "q4,alpha" or "fixed,shift"
+*           -o file     per trace ProxRssi.c vs reference decisions as CSV
+*
+*         Trace CSV rows are "tMs,rssi" as written by flight_rec_replay -c.
+*         Every row is one ProxRssi_PushRaw + ProxRssi_MainFunction call.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE             /* getopt */
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ProxRssi.h"
+#include "ProxRssi.c"
+#include "prox_rssi_params.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define PROX_REF_LUT_LEN            (1001u)     /* RSSI_ALPHA_LUT_LEN in rssi_integration.c */
+#define PROX_REF_MAX_MODES          (8u)
+#define PROX_REF_MATCH_MS           (10000u)    /* Events further apart are different decisions */
+
+/* Fixed-point building blocks of the reference */
+#define PROX_REF_Q4                 (1u << 0)
+#define PROX_REF_ALPHA              (1u << 1)
+#define PROX_REF_ISQRT              (1u << 2)
+#define PROX_REF_SHIFT              (1u << 3)
+#define PROX_REF_SQRT4              (1u << 4)
+#define PROX_REF_EXACT              (0u)
+#define PROX_REF_FIXED              (PROX_REF_Q4 | PROX_REF_ALPHA | PROX_REF_ISQRT)
+
+typedef struct
+{
+    uint32_t *pTMs;
+    int8_t   *pRssi;
+    uint32_t  n;
+} proxRefTrace_t;
+
+typedef struct
+{
+    proxRefTrace_t *pTraces;
+    uint32_t        numTraces;
+    uint32_t        cap;
+} proxRefSet_t;
+
+/* Output of one MainFunction call, values in Q4 units; n = 0: no features */
+typedef struct
+{
+    ProxRssi_EventType ev;
+    uint16_t n;
+    uint16_t pctQ15;
+    double   pct;
+    double   stdQ4;
+    double   lastQ4;
+    double   minQ4;
+    double   maxQ4;
+} proxRefStep_t;
+
+/* The ProxRssi_CtxType of the reference */
+typedef struct
+{
+    ProxRssi_ParamsType p;
+    uint32_t            flags;
+    ProxRssi_StateType  st;
+    uint32_t            tCandidateStartMs;
+    uint32_t            tBelowExitStartMs;
+    uint32_t            tLockoutUntilMs;
+
+    bool_t   emaValid;
+    double   emaQ4;
+    uint32_t emaPrevMs;
+
+    uint32_t rawT[PROX_RSSI_RAW_CAP];
+    int8_t   rawDbm[PROX_RSSI_RAW_CAP];
+    uint16_t rawHead;
+    uint16_t rawCount;
+    uint32_t smT[PROX_RSSI_SMOOTH_CAP];
+    double   smQ4[PROX_RSSI_SMOOTH_CAP];
+    uint16_t smHead;
+    uint16_t smCount;
+
+    uint16_t alphaQ15[PROX_RSSI_ALPHA_LUT_SIZE];
+    double   tmpA[PROX_RSSI_RAW_CAP];
+    double   tmpB[PROX_RSSI_RAW_CAP];
+    double   tmpS[PROX_RSSI_SMOOTH_CAP];
+} proxRefCtx_t;
+
+typedef struct
+{
+    double  *p;
+    uint32_t n;
+    uint32_t cap;
+} proxRefVec_t;
+
+typedef struct
+{
+    double mean;
+    double rms;
+    double p50;                         /* Of |x| */
+    double p95;
+    double p99;
+    double max;
+} proxRefStats_t;
+
+/* One mode against the exact reference */
+typedef struct
+{
+    proxRefVec_t emaErr;                /* dB */
+    proxRefVec_t stdErr;                /* dB */
+    proxRefVec_t pctErr;                /* Percentage points */
+    proxRefVec_t unlockDt;              /* ms, model - reference */
+    proxRefVec_t exitDt;
+    uint32_t     diverged;
+    uint32_t     refUnlocks;
+    uint32_t     unlocks;
+    uint32_t     missing;               /* Unlocks without a match within PROX_REF_MATCH_MS */
+    uint32_t     extra;
+    uint32_t     exitMissing;
+    uint32_t     exitExtra;
+} proxRefAcc_t;
+
+typedef struct
+{
+    char     name[24];
+    uint32_t flags;                     /* PROX_REF_FIRMWARE: ProxRssi.c itself */
+} proxRefMode_t;
+
+#define PROX_REF_FIRMWARE           (0xFFFFFFFFu)
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static uint16_t gaProxRefLut[PROX_REF_LUT_LEN];
+
+static const struct
+{
+    const char *pName;
+    uint32_t    flags;
+} gaProxRefFlagNames[] =
+{
+    { "exact", PROX_REF_EXACT },
+    { "q4",    PROX_REF_Q4 },
+    { "alpha", PROX_REF_ALPHA },
+    { "isqrt", PROX_REF_ISQRT },
+    { "fixed", PROX_REF_FIXED },
+    { "shift", PROX_REF_SHIFT },
+    { "sqrt4", PROX_REF_SQRT4 },
+};
+
+/*******************************************************************************
+ * Parameters
+ ******************************************************************************/
+
+static void ProxRef_BuildLut(void)
+{
+    /* Same ramp as RssiIntegration_BuildAlphaLut */
+    for (uint32_t i = 0u; i < PROX_REF_LUT_LEN; i++)
+    {
+        uint32_t alpha = PROX_PARAM_ALPHA_START_Q15 + ((i * PROX_PARAM_ALPHA_SLOPE_Q15) / 1000u);
+
+        gaProxRefLut[i] = (uint16_t)((alpha > 32767u) ? 32767u : alpha);
+    }
+}
+
+/* Firmware defaults from prox_rssi_params.h, as RssiIntegration_Init sets them */
+static void ProxRef_DefaultParams(ProxRssi_ParamsType *pP)
+{
+    memset(pP, 0, sizeof(*pP));
+    pP->wRawMs            = PROX_PARAM_W_RAW_MS;
+    pP->wSpikeMs          = PROX_PARAM_W_SPIKE_MS;
+    pP->wFeatMs           = PROX_PARAM_W_FEAT_MS;
+    pP->hampelKQ4         = PROX_PARAM_HAMPEL_K_Q4;
+    pP->madEpsQ4          = PROX_PARAM_MAD_EPS_Q4;
+    pP->enterNearQ4       = ProxRssi_DbmToQ4((int8_t)PROX_PARAM_ENTER_NEAR_DBM);
+    pP->exitNearQ4        = ProxRssi_DbmToQ4((int8_t)PROX_PARAM_EXIT_NEAR_DBM);
+    pP->hystQ4            = (uint16_t)ProxRssi_DbToQ4((int16_t)PROX_PARAM_HYST_DB);
+    pP->pctThQ15          = PROX_PARAM_PCT_TH_Q15;
+    pP->stdThQ4           = PROX_PARAM_STD_TH_Q4;
+    pP->stableMs          = PROX_PARAM_STABLE_MS;
+    pP->minFeatSamples    = PROX_PARAM_MIN_FEAT_SAMPLES;
+    pP->exitConfirmMs     = PROX_PARAM_EXIT_CONFIRM_MS;
+    pP->lockoutMs         = PROX_PARAM_LOCKOUT_MS;
+    pP->maxReasonableDtMs = PROX_PARAM_MAX_REASONABLE_DT_MS;
+}
+
+/*******************************************************************************
+ * Reference model
+ ******************************************************************************/
+
+static uint32_t ProxRef_MinT(uint32_t nowMs, uint32_t winMs)
+{
+    /* As ProxTime_InWindow in the prune and copy helpers of ProxRssi.c; the
+     * traces are in ms, so the windows are the ms parameters */
+    return nowMs - winMs;
+}
+
+static void ProxRef_SortD(double *pA, uint16_t n)
+{
+    for (uint16_t i = 1u; i < n; i++)
+    {
+        const double key = pA[i];
+        uint16_t j = i;
+
+        while ((j > 0u) && (pA[j - 1u] > key))
+        {
+            pA[j] = pA[j - 1u];
+            j--;
+        }
+        pA[j] = key;
+    }
+}
+
+/* Takes the firmware defaults and alpha table through ProxRssi_Init itself */
+static void ProxRef_Init(proxRefCtx_t *pCtx, const ProxRssi_ParamsType *pParams, uint32_t flags)
+{
+    ProxRssi_CtxType fw;
+
+    memset(pCtx, 0, sizeof(*pCtx));
+    (void)ProxRssi_Init(&fw, pParams, gaProxRefLut, PROX_REF_LUT_LEN);
+    pCtx->p     = fw.p;
+    pCtx->flags = flags;
+    pCtx->st    = PROX_RSSI_ST_FAR;
+    memcpy(pCtx->alphaQ15, fw.alphaQ15, sizeof(pCtx->alphaQ15));
+}
+
+static void ProxRef_PushRaw(proxRefCtx_t *pCtx, uint32_t tMs, int8_t rssiDbm)
+{
+    if ((rssiDbm == (int8_t)127) || (rssiDbm >= (int8_t)0))
+    {
+        return;
+    }
+    if (rssiDbm < (int8_t)-127)
+    {
+        rssiDbm = (int8_t)-127;
+    }
+    pCtx->rawT[pCtx->rawHead]   = tMs;
+    pCtx->rawDbm[pCtx->rawHead] = rssiDbm;
+    pCtx->rawHead = ProxRssi_RingNext(pCtx->rawHead, (uint16_t)PROX_RSSI_RAW_CAP);
+    if (pCtx->rawCount < (uint16_t)PROX_RSSI_RAW_CAP)
+    {
+        pCtx->rawCount++;
+    }
+}
+
+static void ProxRef_Prune(const uint32_t *pT, uint16_t head, uint16_t *pCount, uint16_t cap, uint32_t minT)
+{
+    uint16_t tail = ProxRssi_RingTail(head, *pCount, cap);
+
+    while ((*pCount > 0u) && (ProxTime_Before(pT[tail], minT) == TRUE))
+    {
+        tail = ProxRssi_RingNext(tail, cap);
+        (*pCount)--;
+    }
+}
+
+/* Alpha in Q15 units for dt, before any truncation */
+static double ProxRef_AlphaQ15(const proxRefCtx_t *pCtx, uint32_t dtMs)
+{
+    const double maxIdx = (double)(PROX_RSSI_ALPHA_LUT_SIZE - 1u);
+    double aQ15;
+
+    if ((pCtx->flags & PROX_REF_ALPHA) != 0u)
+    {
+        uint32_t idx = dtMs / (uint32_t)PROX_RSSI_ALPHA_LUT_STEP_MS;
+
+        aQ15 = (double)pCtx->alphaQ15[(idx > (uint32_t)maxIdx) ? (uint32_t)maxIdx : idx];
+    }
+    else
+    {
+        /* The ramp the LUT samples, at the exact dt */
+        double x = (double)dtMs / (double)PROX_RSSI_ALPHA_LUT_STEP_MS;
+
+        x = (x > maxIdx) ? maxIdx : x;
+        aQ15 = (double)PROX_PARAM_ALPHA_START_Q15 + ((x * (double)PROX_PARAM_ALPHA_SLOPE_Q15) / 1000.0);
+        aQ15 = (aQ15 > 32767.0) ? 32767.0 : aQ15;
+    }
+    if (((pCtx->flags & PROX_REF_SHIFT) != 0u) && (aQ15 >= 1.0))
+    {
+        aQ15 = exp2(floor(log2(aQ15)));
+    }
+    return aQ15;
+}
+
+static double ProxRef_Ema(proxRefCtx_t *pCtx, uint32_t nowMs, double xQ4)
+{
+    uint32_t dtMs = ProxRssi_TimeDiff(nowMs, pCtx->emaPrevMs);
+    double stepQ4;
+
+    if ((pCtx->emaValid == FALSE) || (dtMs == 0u) || (dtMs > pCtx->p.maxReasonableDtMs))
+    {
+        pCtx->emaValid  = TRUE;
+        pCtx->emaQ4     = xQ4;
+        pCtx->emaPrevMs = nowMs;
+        return xQ4;
+    }
+    stepQ4 = (ProxRef_AlphaQ15(pCtx, dtMs) * (xQ4 - pCtx->emaQ4)) / 32768.0;
+    if ((pCtx->flags & PROX_REF_Q4) != 0u)
+    {
+        /* The arithmetic >> 15 of ProxRssi_MulAlphaQ15_DeltaQ4 */
+        stepQ4 = floor(stepQ4);
+    }
+    pCtx->emaQ4     = pCtx->emaQ4 + stepQ4;
+    pCtx->emaPrevMs = nowMs;
+    return pCtx->emaQ4;
+}
+
+/* Spike window median / MAD test on the newest raw sample. Returns n. */
+static uint16_t ProxRef_Hampel(proxRefCtx_t *pCtx, uint32_t nowMs, double *pXQ4)
+{
+    const uint32_t minT = ProxRef_MinT(nowMs, pCtx->p.wSpikeMs);
+    uint16_t idx = ProxRssi_RingTail(pCtx->rawHead, pCtx->rawCount, (uint16_t)PROX_RSSI_RAW_CAP);
+    uint16_t lastIdx = (pCtx->rawHead == 0u) ? ((uint16_t)PROX_RSSI_RAW_CAP - 1u) : (uint16_t)(pCtx->rawHead - 1u);
+    uint16_t n = 0u;
+    double med;
+    double mad;
+    double thr;
+    double xLatest;
+
+    for (uint16_t i = 0u; i < pCtx->rawCount; i++)
+    {
+        if (ProxTime_Before(pCtx->rawT[idx], minT) == FALSE)
+        {
+            pCtx->tmpA[n++] = (double)ProxRssi_DbmToQ4(pCtx->rawDbm[idx]);
+        }
+        idx = ProxRssi_RingNext(idx, (uint16_t)PROX_RSSI_RAW_CAP);
+    }
+    if (n < 3u)
+    {
+        return n;
+    }
+    ProxRef_SortD(pCtx->tmpA, n);
+    med = pCtx->tmpA[n >> 1];
+    for (uint16_t i = 0u; i < n; i++)
+    {
+        pCtx->tmpB[i] = fabs(pCtx->tmpA[i] - med);
+    }
+    ProxRef_SortD(pCtx->tmpB, n);
+    mad = pCtx->tmpB[n >> 1];
+    mad = (mad < (double)pCtx->p.madEpsQ4) ? (double)pCtx->p.madEpsQ4 : mad;
+
+    if ((pCtx->flags & PROX_REF_Q4) != 0u)
+    {
+        const int32_t thrQ8 = (((int32_t)(int16_t)pCtx->p.hampelKQ4 * (int32_t)mad) * 3) / 2;
+
+        thr = (double)(thrQ8 / (int32_t)PROX_RSSI_Q4_SCALE);
+    }
+    else
+    {
+        thr = (((double)pCtx->p.hampelKQ4 / 16.0) * 1.5) * mad;
+    }
+    xLatest = (double)ProxRssi_DbmToQ4(pCtx->rawDbm[lastIdx]);
+    *pXQ4 = (fabs(xLatest - med) > thr) ? med : xLatest;
+    return n;
+}
+
+static double ProxRef_StdQ4(const proxRefCtx_t *pCtx, const double *pX, uint16_t n)
+{
+    double mean = 0.0;
+    double ss = 0.0;
+    uint32_t varQ8;
+
+    if (n <= 1u)
+    {
+        return 0.0;
+    }
+    if ((pCtx->flags & (PROX_REF_ISQRT | PROX_REF_SQRT4)) == 0u)
+    {
+        for (uint16_t i = 0u; i < n; i++)
+        {
+            mean += pX[i];
+        }
+        mean /= (double)n;
+        for (uint16_t i = 0u; i < n; i++)
+        {
+            ss += (pX[i] - mean) * (pX[i] - mean);
+        }
+        return sqrt(ss / (double)(n - 1u));
+    }
+
+    if ((pCtx->flags & PROX_REF_Q4) != 0u)
+    {
+        /* Integer values: the int64 formula of ProxRssi_ComputeFeatures */
+        int64_t sum = 0;
+        int64_t sumSq = 0;
+        int64_t diff;
+
+        for (uint16_t i = 0u; i < n; i++)
+        {
+            sum   += (int64_t)pX[i];
+            sumSq += (int64_t)pX[i] * (int64_t)pX[i];
+        }
+        diff  = sumSq - ((sum * sum) / (int64_t)n);
+        diff  = (diff < 0) ? 0 : diff;
+        varQ8 = (uint32_t)(diff / (int64_t)(n - 1u));
+    }
+    else
+    {
+        for (uint16_t i = 0u; i < n; i++)
+        {
+            mean += pX[i];
+        }
+        mean /= (double)n;
+        for (uint16_t i = 0u; i < n; i++)
+        {
+            ss += (pX[i] - mean) * (pX[i] - mean);
+        }
+        varQ8 = (uint32_t)floor(ss / (double)(n - 1u));
+    }
+    if ((pCtx->flags & PROX_REF_SQRT4) != 0u)
+    {
+        return (double)((uint32_t)ProxRssi_IsqrtU32(varQ8 >> 4) << 2);
+    }
+    return (double)ProxRssi_IsqrtU32(varQ8);
+}
+
+/* As ProxRssi_ComputeFeatures. Returns FALSE below minFeatSamples. */
+static bool_t ProxRef_Features(proxRefCtx_t *pCtx, uint32_t nowMs, proxRefStep_t *pF)
+{
+    const uint32_t minT = ProxRef_MinT(nowMs, pCtx->p.wFeatMs);
+    uint16_t idx = ProxRssi_RingTail(pCtx->smHead, pCtx->smCount, (uint16_t)PROX_RSSI_SMOOTH_CAP);
+    uint16_t n = 0u;
+    uint32_t above = 0u;
+
+    for (uint16_t i = 0u; i < pCtx->smCount; i++)
+    {
+        if (ProxTime_Before(pCtx->smT[idx], minT) == FALSE)
+        {
+            pCtx->tmpS[n++] = pCtx->smQ4[idx];
+        }
+        idx = ProxRssi_RingNext(idx, (uint16_t)PROX_RSSI_SMOOTH_CAP);
+    }
+    if ((n == 0u) || (n < pCtx->p.minFeatSamples))
+    {
+        return FALSE;
+    }
+
+    pF->minQ4 = pCtx->tmpS[0];
+    pF->maxQ4 = pCtx->tmpS[0];
+    for (uint16_t i = 0u; i < n; i++)
+    {
+        above    += (pCtx->tmpS[i] >= (double)pCtx->p.enterNearQ4) ? 1u : 0u;
+        pF->minQ4 = (pCtx->tmpS[i] < pF->minQ4) ? pCtx->tmpS[i] : pF->minQ4;
+        pF->maxQ4 = (pCtx->tmpS[i] > pF->maxQ4) ? pCtx->tmpS[i] : pF->maxQ4;
+    }
+    pF->n      = n;
+    pF->pct    = (double)above / (double)n;
+    pF->pctQ15 = (uint16_t)((above * (uint32_t)PROX_RSSI_Q15_ONE) / (uint32_t)n);
+    pF->stdQ4  = ProxRef_StdQ4(pCtx, pCtx->tmpS, n);
+    pF->lastQ4 = pCtx->tmpS[n - 1u];
+    return TRUE;
+}
+
+/* ProxRssi_StateStep on the reference features, branch for branch */
+static ProxRssi_EventType ProxRef_StateStep(proxRefCtx_t *pCtx, uint32_t nowMs, const proxRefStep_t *pF)
+{
+    const double enterQ4 = (double)pCtx->p.enterNearQ4;
+    const double exitQ4  = (double)pCtx->p.exitNearQ4;
+
+    if (pCtx->st == PROX_RSSI_ST_LOCKOUT)
+    {
+        if (ProxTime_Before(nowMs, pCtx->tLockoutUntilMs) == TRUE)
+        {
+            return PROX_RSSI_EVT_NONE;
+        }
+        if (pF->lastQ4 < exitQ4)
+        {
+            if (pCtx->tBelowExitStartMs == 0u)
+            {
+                pCtx->tBelowExitStartMs = nowMs;
+            }
+            if (ProxRssi_TimeDiff(nowMs, pCtx->tBelowExitStartMs) >= pCtx->p.exitConfirmMs)
+            {
+                pCtx->st                = PROX_RSSI_ST_FAR;
+                pCtx->tBelowExitStartMs = 0u;
+                return PROX_RSSI_EVT_EXIT_TO_FAR;
+            }
+        }
+        else
+        {
+            pCtx->tBelowExitStartMs = 0u;
+        }
+        return PROX_RSSI_EVT_NONE;
+    }
+
+    if (pCtx->st == PROX_RSSI_ST_FAR)
+    {
+        if (pF->lastQ4 >= enterQ4)
+        {
+            pCtx->st                = PROX_RSSI_ST_CANDIDATE;
+            pCtx->tCandidateStartMs = nowMs;
+            pCtx->tBelowExitStartMs = 0u;
+            return PROX_RSSI_EVT_CANDIDATE_STARTED;
+        }
+        return PROX_RSSI_EVT_NONE;
+    }
+
+    /* CANDIDATE */
+    if (pF->lastQ4 < exitQ4)
+    {
+        if (pCtx->tBelowExitStartMs == 0u)
+        {
+            pCtx->tBelowExitStartMs = nowMs;
+        }
+        if (ProxRssi_TimeDiff(nowMs, pCtx->tBelowExitStartMs) >= pCtx->p.exitConfirmMs)
+        {
+            pCtx->st                = PROX_RSSI_ST_FAR;
+            pCtx->tBelowExitStartMs = 0u;
+            pCtx->tCandidateStartMs = 0u;
+            return PROX_RSSI_EVT_EXIT_TO_FAR;
+        }
+    }
+    else
+    {
+        pCtx->tBelowExitStartMs = 0u;
+    }
+
+    /* pctQ15 >= pctTh is exact for an integer count above enter */
+    if ((pF->pctQ15 >= pCtx->p.pctThQ15) && (pF->stdQ4 <= (double)pCtx->p.stdThQ4))
+    {
+        if (ProxRssi_TimeDiff(nowMs, pCtx->tCandidateStartMs) >= pCtx->p.stableMs)
+        {
+            pCtx->st                = PROX_RSSI_ST_LOCKOUT;
+            pCtx->tLockoutUntilMs   = nowMs + pCtx->p.lockoutMs;
+            pCtx->tBelowExitStartMs = 0u;
+            return PROX_RSSI_EVT_UNLOCK_TRIGGERED;
+        }
+    }
+    else
+    {
+        pCtx->tCandidateStartMs = nowMs;
+    }
+    return PROX_RSSI_EVT_NONE;
+}
+
+/* ProxRssi_MainFunction of the reference */
+static void ProxRef_MainFunction(proxRefCtx_t *pCtx, uint32_t nowMs, proxRefStep_t *pOut)
+{
+    double xQ4;
+    double emaQ4;
+
+    memset(pOut, 0, sizeof(*pOut));
+    pOut->ev = PROX_RSSI_EVT_NONE;
+
+    ProxRef_Prune(pCtx->rawT, pCtx->rawHead, &pCtx->rawCount, (uint16_t)PROX_RSSI_RAW_CAP,
+                  ProxRef_MinT(nowMs, pCtx->p.wRawMs));
+    ProxRef_Prune(pCtx->smT, pCtx->smHead, &pCtx->smCount, (uint16_t)PROX_RSSI_SMOOTH_CAP,
+                  ProxRef_MinT(nowMs, pCtx->p.wFeatMs));
+    if ((pCtx->rawCount == 0u) || (ProxRef_Hampel(pCtx, nowMs, &xQ4) < 3u))
+    {
+        return;
+    }
+
+    emaQ4 = ProxRef_Ema(pCtx, nowMs, xQ4);
+    pCtx->smT[pCtx->smHead]  = nowMs;
+    pCtx->smQ4[pCtx->smHead] = emaQ4;
+    pCtx->smHead = ProxRssi_RingNext(pCtx->smHead, (uint16_t)PROX_RSSI_SMOOTH_CAP);
+    if (pCtx->smCount < (uint16_t)PROX_RSSI_SMOOTH_CAP)
+    {
+        pCtx->smCount++;
+    }
+    ProxRef_Prune(pCtx->smT, pCtx->smHead, &pCtx->smCount, (uint16_t)PROX_RSSI_SMOOTH_CAP,
+                  ProxRef_MinT(nowMs, pCtx->p.wFeatMs));
+
+    if (ProxRef_Features(pCtx, nowMs, pOut) == TRUE)
+    {
+        pOut->ev = ProxRef_StateStep(pCtx, nowMs, pOut);
+    }
+    else
+    {
+        memset(pOut, 0, sizeof(*pOut));
+    }
+}
+
+/* Replay a trace through the reference (flags) or ProxRssi.c (PROX_REF_FIRMWARE) */
+static void ProxRef_Run(const proxRefTrace_t *pT, const ProxRssi_ParamsType *pParams, uint32_t flags,
+                        proxRefStep_t *pSteps)
+{
+    if (flags == PROX_REF_FIRMWARE)
+    {
+        ProxRssi_CtxType *pCtx = malloc(sizeof(ProxRssi_CtxType));
+
+        if (pCtx == NULL)
+        {
+            memset(pSteps, 0, pT->n * sizeof(proxRefStep_t));
+            return;
+        }
+        (void)ProxRssi_Init(pCtx, pParams, gaProxRefLut, PROX_REF_LUT_LEN);
+        for (uint32_t s = 0u; s < pT->n; s++)
+        {
+            ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+            ProxRssi_FeaturesType f;
+
+            (void)ProxRssi_PushRaw(pCtx, pT->pTMs[s], pT->pRssi[s]);
+            (void)ProxRssi_MainFunction(pCtx, pT->pTMs[s], &ev, &f);
+            pSteps[s].ev     = ev;
+            pSteps[s].n      = f.n;
+            pSteps[s].pctQ15 = f.pctAboveEnterQ15;
+            pSteps[s].pct    = (double)f.pctAboveEnterQ15 / (double)PROX_RSSI_Q15_ONE;
+            pSteps[s].stdQ4  = (double)f.stdQ4;
+            pSteps[s].lastQ4 = (double)f.lastQ4;
+            pSteps[s].minQ4  = (double)f.minQ4;
+            pSteps[s].maxQ4  = (double)f.maxQ4;
+        }
+        free(pCtx);
+    }
+    else
+    {
+        proxRefCtx_t *pCtx = malloc(sizeof(proxRefCtx_t));
+
+        if (pCtx == NULL)
+        {
+            memset(pSteps, 0, pT->n * sizeof(proxRefStep_t));
+            return;
+        }
+        ProxRef_Init(pCtx, pParams, flags);
+        for (uint32_t s = 0u; s < pT->n; s++)
+        {
+            ProxRef_PushRaw(pCtx, pT->pTMs[s], pT->pRssi[s]);
+            ProxRef_MainFunction(pCtx, pT->pTMs[s], &pSteps[s]);
+        }
+        free(pCtx);
+    }
+}
+
+/*******************************************************************************
+ * Statistics
+ ******************************************************************************/
+
+static int ProxRef_VecPush(proxRefVec_t *pV, double x)
+{
+    if (pV->n == pV->cap)
+    {
+        uint32_t cap = (pV->cap == 0u) ? 1024u : (pV->cap * 2u);
+        double *pNew = realloc(pV->p, cap * sizeof(double));
+
+        if (pNew == NULL)
+        {
+            return -1;
+        }
+        pV->p   = pNew;
+        pV->cap = cap;
+    }
+    pV->p[pV->n++] = x;
+    return 0;
+}
+
+static void ProxRef_VecFree(proxRefVec_t *pV)
+{
+    free(pV->p);
+    memset(pV, 0, sizeof(*pV));
+}
+
+static int ProxRef_CmpD(const void *pA, const void *pB)
+{
+    double a = *(const double *)pA;
+    double b = *(const double *)pB;
+
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/* Bias and RMS of x, percentiles of |x|. Sorts a copy. */
+static void ProxRef_Stats(const proxRefVec_t *pV, proxRefStats_t *pS)
+{
+    double *pAbs;
+    double sum = 0.0;
+    double sumSq = 0.0;
+
+    memset(pS, 0, sizeof(*pS));
+    if (pV->n == 0u)
+    {
+        return;
+    }
+    pAbs = malloc(pV->n * sizeof(double));
+    if (pAbs == NULL)
+    {
+        return;
+    }
+    for (uint32_t i = 0u; i < pV->n; i++)
+    {
+        sum    += pV->p[i];
+        sumSq  += pV->p[i] * pV->p[i];
+        pAbs[i] = fabs(pV->p[i]);
+    }
+    qsort(pAbs, pV->n, sizeof(double), ProxRef_CmpD);
+    pS->mean = sum / (double)pV->n;
+    pS->rms  = sqrt(sumSq / (double)pV->n);
+    pS->p50  = pAbs[(uint32_t)(0.50 * (double)(pV->n - 1u))];
+    pS->p95  = pAbs[(uint32_t)(0.95 * (double)(pV->n - 1u))];
+    pS->p99  = pAbs[(uint32_t)(0.99 * (double)(pV->n - 1u))];
+    pS->max  = pAbs[pV->n - 1u];
+    free(pAbs);
+}
+
+/* Pairs events of type ev in both runs in trace order when they lie within
+ * PROX_REF_MATCH_MS of each other and books the time shift; the others count
+ * as missing (reference only) or extra (model only) */
+static void ProxRef_MatchEvents(const proxRefTrace_t *pT, const proxRefStep_t *pRef, const proxRefStep_t *pModel,
+                                ProxRssi_EventType ev, proxRefVec_t *pDt, uint32_t *pMissing, uint32_t *pExtra)
+{
+    uint32_t r = 0u;
+    uint32_t m = 0u;
+
+    for (;;)
+    {
+        int32_t dt;
+
+        while ((r < pT->n) && (pRef[r].ev != ev))
+        {
+            r++;
+        }
+        while ((m < pT->n) && (pModel[m].ev != ev))
+        {
+            m++;
+        }
+        if ((r == pT->n) || (m == pT->n))
+        {
+            break;
+        }
+        dt = (int32_t)ProxRssi_TimeDiff(pT->pTMs[m], pT->pTMs[r]);
+        if ((dt <= (int32_t)PROX_REF_MATCH_MS) && (dt >= -(int32_t)PROX_REF_MATCH_MS))
+        {
+            (void)ProxRef_VecPush(pDt, (double)dt);
+            r++;
+            m++;
+        }
+        else if (r < m)
+        {
+            (*pMissing)++;
+            r++;
+        }
+        else
+        {
+            (*pExtra)++;
+            m++;
+        }
+    }
+    for (; r < pT->n; r++)
+    {
+        *pMissing += (pRef[r].ev == ev) ? 1u : 0u;
+    }
+    for (; m < pT->n; m++)
+    {
+        *pExtra += (pModel[m].ev == ev) ? 1u : 0u;
+    }
+}
+
+/* Errors and decisions of one trace run by a model against the exact reference */
+static void ProxRef_Accumulate(proxRefAcc_t *pAcc, const proxRefTrace_t *pT, const proxRefStep_t *pRef,
+                               const proxRefStep_t *pModel)
+{
+    bool_t same = TRUE;
+
+    for (uint32_t s = 0u; s < pT->n; s++)
+    {
+        if ((pRef[s].n != 0u) && (pModel[s].n != 0u))
+        {
+            (void)ProxRef_VecPush(&pAcc->emaErr, (pModel[s].lastQ4 - pRef[s].lastQ4) / 16.0);
+            (void)ProxRef_VecPush(&pAcc->stdErr, (pModel[s].stdQ4 - pRef[s].stdQ4) / 16.0);
+            (void)ProxRef_VecPush(&pAcc->pctErr, (pModel[s].pct - pRef[s].pct) * 100.0);
+        }
+        same = (pRef[s].ev == pModel[s].ev) ? same : FALSE;
+        pAcc->refUnlocks += (pRef[s].ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED) ? 1u : 0u;
+        pAcc->unlocks    += (pModel[s].ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED) ? 1u : 0u;
+    }
+    pAcc->diverged += (same == TRUE) ? 0u : 1u;
+
+    ProxRef_MatchEvents(pT, pRef, pModel, PROX_RSSI_EVT_UNLOCK_TRIGGERED, &pAcc->unlockDt, &pAcc->missing,
+                        &pAcc->extra);
+    ProxRef_MatchEvents(pT, pRef, pModel, PROX_RSSI_EVT_EXIT_TO_FAR, &pAcc->exitDt, &pAcc->exitMissing,
+                        &pAcc->exitExtra);
+}
+
+static void ProxRef_AccFree(proxRefAcc_t *pAcc)
+{
+    ProxRef_VecFree(&pAcc->emaErr);
+    ProxRef_VecFree(&pAcc->stdErr);
+    ProxRef_VecFree(&pAcc->pctErr);
+    ProxRef_VecFree(&pAcc->unlockDt);
+    ProxRef_VecFree(&pAcc->exitDt);
+}
+
+/* Every output of both runs identical */
+static bool_t ProxRef_SameSteps(const proxRefStep_t *pA, const proxRefStep_t *pB, uint32_t n)
+{
+    for (uint32_t s = 0u; s < n; s++)
+    {
+        if ((pA[s].ev != pB[s].ev) || (pA[s].n != pB[s].n) || (pA[s].pctQ15 != pB[s].pctQ15) ||
+            (pA[s].stdQ4 != pB[s].stdQ4) || (pA[s].lastQ4 != pB[s].lastQ4) ||
+            (pA[s].minQ4 != pB[s].minQ4) || (pA[s].maxQ4 != pB[s].maxQ4))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* "q4,alpha" -> flags; -1 for an unknown name */
+static int64_t ProxRef_ParseFlags(const char *pSpec)
+{
+    char buf[128];
+    uint32_t flags = 0u;
+
+    (void)snprintf(buf, sizeof(buf), "%s", pSpec);
+    for (char *pTok = strtok(buf, ","); pTok != NULL; pTok = strtok(NULL, ","))
+    {
+        uint32_t k;
+
+        for (k = 0u; k < (sizeof(gaProxRefFlagNames) / sizeof(gaProxRefFlagNames[0])); k++)
+        {
+            if (strcmp(pTok, gaProxRefFlagNames[k].pName) == 0)
+            {
+                flags |= gaProxRefFlagNames[k].flags;
+                break;
+            }
+        }
+        if (k == (sizeof(gaProxRefFlagNames) / sizeof(gaProxRefFlagNames[0])))
+        {
+            return -1;
+        }
+    }
+    return (int64_t)flags;
+}
+
+/*******************************************************************************
+ * Traces
+ ******************************************************************************/
+
+static uint64_t ProxRef_SplitMix(uint64_t *pState)
+{
+    uint64_t z = (*pState += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static double ProxRef_Uniform(uint64_t *pState)
+{
+    return (double)(ProxRef_SplitMix(pState) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double ProxRef_Gauss(uint64_t *pState)
+{
+    double u1 = ProxRef_Uniform(pState);
+    double u2 = ProxRef_Uniform(pState);
+
+    if (u1 < 1e-12)
+    {
+        u1 = 1e-12;
+    }
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+static proxRefTrace_t *ProxRef_AddTrace(proxRefSet_t *pSet, uint32_t maxSamples)
+{
+    proxRefTrace_t *pT;
+
+    if (pSet->numTraces == pSet->cap)
+    {
+        uint32_t cap = (pSet->cap == 0u) ? 64u : (pSet->cap * 2u);
+        proxRefTrace_t *pNew = realloc(pSet->pTraces, cap * sizeof(proxRefTrace_t));
+
+        if (pNew == NULL)
+        {
+            return NULL;
+        }
+        pSet->pTraces = pNew;
+        pSet->cap     = cap;
+    }
+    pT = &pSet->pTraces[pSet->numTraces];
+    pT->n     = 0u;
+    pT->pTMs  = malloc(((maxSamples != 0u) ? maxSamples : 1u) * sizeof(uint32_t));
+    pT->pRssi = malloc((maxSamples != 0u) ? maxSamples : 1u);
+    if ((pT->pTMs == NULL) || (pT->pRssi == NULL))
+    {
+        free(pT->pTMs);
+        free(pT->pRssi);
+        return NULL;
+    }
+    pSet->numTraces++;
+    return pT;
+}
+
+static void ProxRef_FreeSet(proxRefSet_t *pSet)
+{
+    for (uint32_t i = 0u; i < pSet->numTraces; i++)
+    {
+        free(pSet->pTraces[i].pTMs);
+        free(pSet->pTraces[i].pRssi);
+    }
+    free(pSet->pTraces);
+    memset(pSet, 0, sizeof(*pSet));
+}
+
+/* Walks to the car and away again under a log-distance path loss model with
+ * per trace transmit power, exponent and noise; jittered 10 Hz reads with
+ * gaps, repeated timestamps, spikes and invalid readings */
+static int ProxRef_Synthesize(proxRefSet_t *pSet, uint32_t count, uint32_t maxSamples, uint64_t seed)
+{
+    for (uint32_t v = 0u; v < count; v++)
+    {
+        uint64_t rng = seed ^ (0xD1B54A32D192ED03ull * ((uint64_t)v + 1u));
+        uint32_t n = (maxSamples / 2u) + (uint32_t)(ProxRef_Uniform(&rng) * (double)((maxSamples / 2u) + 1u));
+        proxRefTrace_t *pT = ProxRef_AddTrace(pSet, n);
+        const double p0 = -42.0 - (10.0 * ProxRef_Uniform(&rng));
+        const double ple = 1.8 + (0.8 * ProxRef_Uniform(&rng));
+        const double sigma = 1.5 + (3.5 * ProxRef_Uniform(&rng));
+        const double near = 0.3 + (1.7 * ProxRef_Uniform(&rng));
+        const double far = 15.0 + (25.0 * ProxRef_Uniform(&rng));
+        const double cycleS = 60.0 + (60.0 * ProxRef_Uniform(&rng));
+        const uint32_t t0 = ((v % 16u) == 15u) ? (0xFFFFFFFFu - (uint32_t)(ProxRef_Uniform(&rng) * 100000.0))
+                                               : (uint32_t)(ProxRef_Uniform(&rng) * 1e8);
+        uint32_t t = t0;
+
+        if (pT == NULL)
+        {
+            return -1;
+        }
+        n = (n > maxSamples) ? maxSamples : n;
+        for (uint32_t s = 0u; s < n; s++)
+        {
+            double u = ProxRef_Uniform(&rng);
+            double phase;
+            double d;
+            double rssi;
+
+            if (u < 0.005)
+            {
+                /* Same timestamp again */
+            }
+            else if (u < 0.015)
+            {
+                t += 1000u + (uint32_t)(ProxRef_Uniform(&rng) * 3000.0);
+            }
+            else
+            {
+                t += 70u + (uint32_t)(ProxRef_Uniform(&rng) * 60.0);
+            }
+
+            /* Approach, stay, leave, stay away */
+            phase = fmod((double)(uint32_t)(t - t0) / 1000.0, cycleS) / cycleS;
+            if (phase < 0.3)
+            {
+                d = far + ((near - far) * (phase / 0.3));
+            }
+            else if (phase < 0.6)
+            {
+                d = near;
+            }
+            else if (phase < 0.9)
+            {
+                d = near + ((far - near) * ((phase - 0.6) / 0.3));
+            }
+            else
+            {
+                d = far;
+            }
+
+            rssi = p0 - (10.0 * ple * log10(d)) + (sigma * ProxRef_Gauss(&rng));
+            if (ProxRef_Uniform(&rng) < 0.02)
+            {
+                rssi += (ProxRef_Uniform(&rng) < 0.5) ? -20.0 : 12.0;
+            }
+            rssi = (rssi < -127.0) ? -127.0 : ((rssi > -1.0) ? -1.0 : rssi);
+
+            pT->pTMs[s]  = t;
+            pT->pRssi[s] = (ProxRef_Uniform(&rng) < 0.03) ? (int8_t)127 : (int8_t)lround(rssi);
+        }
+        pT->n = n;
+    }
+    return 0;
+}
+
+static int ProxRef_LoadCsv(proxRefSet_t *pSet, const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "r");
+    char line[128];
+    uint32_t lines = 0u;
+    proxRefTrace_t *pT;
+
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", pPath);
+        return -1;
+    }
+    while (fgets(line, (int)sizeof(line), pFile) != NULL)
+    {
+        lines++;
+    }
+    rewind(pFile);
+
+    pT = ProxRef_AddTrace(pSet, lines);
+    if (pT == NULL)
+    {
+        fclose(pFile);
+        return -1;
+    }
+    while ((fgets(line, (int)sizeof(line), pFile) != NULL) && (pT->n < lines))
+    {
+        unsigned long t;
+        int rssi;
+
+        /* Header and comment lines do not parse */
+        if (sscanf(line, "%lu,%d", &t, &rssi) == 2)
+        {
+            pT->pTMs[pT->n]  = (uint32_t)t;
+            pT->pRssi[pT->n] = (int8_t)rssi;
+            pT->n++;
+        }
+    }
+    fclose(pFile);
+    return 0;
+}
+
+static int ProxRef_LoadList(proxRefSet_t *pSet, const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "r");
+    char line[512];
+    int rc = 0;
+
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", pPath);
+        return -1;
+    }
+    while ((rc == 0) && (fgets(line, (int)sizeof(line), pFile) != NULL))
+    {
+        char csv[400];
+
+        if ((sscanf(line, "%399s", csv) == 1) && (csv[0] != '#'))
+        {
+            rc = ProxRef_LoadCsv(pSet, csv);
+        }
+    }
+    fclose(pFile);
+    return rc;
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+#ifndef PROX_REF_NO_MAIN
+static void ProxRef_PrintErrors(const char *pName, const proxRefAcc_t *pAcc)
+{
+    proxRefStats_t ema;
+    proxRefStats_t std;
+    proxRefStats_t pct;
+
+    ProxRef_Stats(&pAcc->emaErr, &ema);
+    ProxRef_Stats(&pAcc->stdErr, &std);
+    ProxRef_Stats(&pAcc->pctErr, &pct);
+    printf("%-14s %+7.3f %6.3f %6.3f %6.3f | %+7.3f %6.3f %6.3f %6.3f | %+6.2f %6.2f\n", pName,
+           ema.mean, ema.rms, ema.p99, ema.max, std.mean, std.rms, std.p99, std.max, pct.mean, pct.max);
+}
+
+static void ProxRef_PrintDecisions(const char *pName, const proxRefAcc_t *pAcc, uint32_t numTraces)
+{
+    proxRefStats_t unlock;
+    proxRefStats_t exitToFar;
+
+    ProxRef_Stats(&pAcc->unlockDt, &unlock);
+    ProxRef_Stats(&pAcc->exitDt, &exitToFar);
+    printf("%-14s %5u/%-5u %7u %7u %7u | %+8.1f %7.0f %7.0f %7.0f | %7.0f %7.0f %7u\n", pName, pAcc->diverged,
+           numTraces, pAcc->unlocks, pAcc->missing, pAcc->extra, unlock.mean, unlock.p50, unlock.p95, unlock.max,
+           exitToFar.p95, exitToFar.max, pAcc->exitMissing + pAcc->exitExtra);
+}
+
+static void ProxRef_Usage(void)
+{
+    fprintf(stderr, "Usage: prox_ref [-l list | -n traces] [-s samples] [-S seed] [-m flags] [-o decisions.csv]"
+                    " [trace.csv ...]\n"
+                    "       flags: exact q4 alpha isqrt fixed shift sqrt4, comma separated\n");
+}
+
+int main(int argc, char *argv[])
+{
+    proxRefSet_t set = { 0 };
+    ProxRssi_ParamsType params;
+    proxRefMode_t aModes[PROX_REF_MAX_MODES] =
+    {
+        { "ProxRssi.c",  PROX_REF_FIRMWARE },
+        { "q4",          PROX_REF_Q4 },
+        { "alpha",       PROX_REF_ALPHA },
+        { "isqrt",       PROX_REF_ISQRT },
+        { "fixed+shift", PROX_REF_FIXED | PROX_REF_SHIFT },
+        { "fixed+sqrt4", PROX_REF_FIXED | PROX_REF_SQRT4 },
+    };
+    uint32_t numModes = 6u;
+    proxRefAcc_t aAcc[PROX_REF_MAX_MODES];
+    proxRefStep_t *pRef = NULL;
+    proxRefStep_t *pModel = NULL;
+    proxRefStep_t *pFixed = NULL;
+    const char *pList = NULL;
+    const char *pOutPath = NULL;
+    FILE *pOut = NULL;
+    uint32_t count = 500u;
+    uint32_t samples = 3000u;
+    uint32_t maxN = 1u;
+    uint32_t emulated = 0u;
+    uint64_t seed = 1u;
+    uint64_t totalSamples = 0u;
+    int rc = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:n:s:S:m:o:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'l': pList    = optarg; break;
+            case 'n': count    = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': samples  = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'S': seed     = strtoull(optarg, NULL, 0); break;
+            case 'o': pOutPath = optarg; break;
+            case 'm':
+            {
+                int64_t flags = ProxRef_ParseFlags(optarg);
+
+                if ((flags < 0) || (numModes >= PROX_REF_MAX_MODES))
+                {
+                    ProxRef_Usage();
+                    return 2;
+                }
+                (void)snprintf(aModes[numModes].name, sizeof(aModes[numModes].name), "%s", optarg);
+                aModes[numModes].flags = (uint32_t)flags;
+                numModes++;
+                break;
+            }
+            default:
+                ProxRef_Usage();
+                return 2;
+        }
+    }
+
+    ProxRef_BuildLut();
+    ProxRef_DefaultParams(&params);
+    if (pList != NULL)
+    {
+        rc = ProxRef_LoadList(&set, pList);
+    }
+    for (int i = optind; (rc == 0) && (i < argc); i++)
+    {
+        rc = ProxRef_LoadCsv(&set, argv[i]);
+    }
+    if ((rc == 0) && (pList == NULL) && (optind >= argc))
+    {
+        rc = ProxRef_Synthesize(&set, count, samples, seed);
+    }
+    for (uint32_t i = 0u; i < set.numTraces; i++)
+    {
+        maxN = (set.pTraces[i].n > maxN) ? set.pTraces[i].n : maxN;
+        totalSamples += set.pTraces[i].n;
+    }
+    pRef   = malloc(maxN * sizeof(proxRefStep_t));
+    pModel = malloc(maxN * sizeof(proxRefStep_t));
+    pFixed = malloc(maxN * sizeof(proxRefStep_t));
+    if ((rc != 0) || (pRef == NULL) || (pModel == NULL) || (pFixed == NULL))
+    {
+        fprintf(stderr, "Cannot load the traces\n");
+        ProxRef_FreeSet(&set);
+        free(pRef);
+        free(pModel);
+        free(pFixed);
+        return 1;
+    }
+    if (pOutPath != NULL)
+    {
+        pOut = fopen(pOutPath, "w");
+        if (pOut == NULL)
+        {
+            fprintf(stderr, "Cannot write %s\n", pOutPath);
+            rc = 1;
+        }
+        else
+        {
+            fprintf(pOut, "trace,samples,ref_unlocks,unlocks,missing,extra,max_unlock_dt_ms,diverged\n");
+        }
+    }
+    memset(aAcc, 0, sizeof(aAcc));
+
+    for (uint32_t i = 0u; i < set.numTraces; i++)
+    {
+        const proxRefTrace_t *pT = &set.pTraces[i];
+
+        ProxRef_Run(pT, &params, PROX_REF_EXACT, pRef);
+        for (uint32_t m = 0u; m < numModes; m++)
+        {
+            const proxRefAcc_t before = aAcc[m];
+
+            ProxRef_Run(pT, &params, aModes[m].flags, pModel);
+            ProxRef_Accumulate(&aAcc[m], pT, pRef, pModel);
+            if (aModes[m].flags != PROX_REF_FIRMWARE)
+            {
+                continue;
+            }
+
+            ProxRef_Run(pT, &params, PROX_REF_FIXED, pFixed);
+            emulated += (ProxRef_SameSteps(pModel, pFixed, pT->n) == TRUE) ? 1u : 0u;
+            if (pOut != NULL)
+            {
+                double maxDt = 0.0;
+
+                for (uint32_t k = before.unlockDt.n; k < aAcc[m].unlockDt.n; k++)
+                {
+                    maxDt = (fabs(aAcc[m].unlockDt.p[k]) > fabs(maxDt)) ? aAcc[m].unlockDt.p[k] : maxDt;
+                }
+                fprintf(pOut, "%u,%u,%u,%u,%u,%u,%.0f,%u\n", i, pT->n, aAcc[m].refUnlocks - before.refUnlocks,
+                        aAcc[m].unlocks - before.unlocks, aAcc[m].missing - before.missing,
+                        aAcc[m].extra - before.extra, maxDt, aAcc[m].diverged - before.diverged);
+            }
+        }
+    }
+
+    printf("Traces: %u, %.2f M samples, %u unlocks in the double reference\n", set.numTraces,
+           (double)totalSamples / 1e6, aAcc[0].refUnlocks);
+    printf("\nFeature error against the double reference (model - reference)\n");
+    printf("%-14s %7s %6s %6s %6s | %7s %6s %6s %6s | %6s %6s\n", "mode", "EMA dB", "rms", "p99", "max",
+           "std dB", "rms", "p99", "max", "pct", "max");
+    for (uint32_t m = 0u; m < numModes; m++)
+    {
+        ProxRef_PrintErrors(aModes[m].name, &aAcc[m]);
+    }
+    printf("\nDecision divergence against the double reference (ms, model - reference)\n");
+    printf("%-14s %11s %7s %7s %7s | %8s %7s %7s %7s | %7s %7s %7s\n", "mode", "diverged", "unlocks", "missing",
+           "extra", "unlock", "p50", "p95", "max", "exit p95", "max", "unpaired");
+    for (uint32_t m = 0u; m < numModes; m++)
+    {
+        ProxRef_PrintDecisions(aModes[m].name, &aAcc[m], set.numTraces);
+    }
+    printf("\nq4+alpha+isqrt reproduces ProxRssi.c on %u of %u traces\n", emulated, set.numTraces);
+    rc = ((rc == 0) && (emulated == set.numTraces)) ? 0 : 1;
+
+    if (pOut != NULL)
+    {
+        fclose(pOut);
+    }
+    for (uint32_t m = 0u; m < numModes; m++)
+    {
+        ProxRef_AccFree(&aAcc[m]);
+    }
+    free(pRef);
+    free(pModel);
+    free(pFixed);
+    ProxRef_FreeSet(&set);
+    return rc;
+}
+#endif /* PROX_REF_NO_MAIN */
@@ -0,0 +1,1192 @@
+/*! *********************************************************************************
+* \file prox_tune.c
+*
+* \brief  Host auto-tuner for the ProxRssi parameters.
+*
+*         Replays a corpus of labelled RSSI traces through the real ProxRssi.c
+*         for every candidate parameter set, on all CPU cores, and reports the
+*         Pareto front of unlock latency against false-unlock and missed-unlock
+*         rates. The chosen set is written as a drop-in prox_rssi_params.h.
+*
+*         Trace labels and what counts as an error:
+*           approach    walk up to the car             no unlock = missed
+*           pocket      same, phone in a pocket/bag    no unlock = missed
+*           passby      walk past the car              any unlock = false
+*           walkaway    leave the car                  any unlock = false
+*         Latency is the first unlock relative to the trace reference time
+*         (arrival at the car), clamped at 0.
+*
+*         The corpus is a manifest of "label file.csv [refMs]" lines, the CSV
+*         holding "tMs,rssi" rows (flight_rec_replay -c writes this format),
+*         or a synthetic corpus from a log-distance path loss model (-s).
+*
+*         Build:  cc -std=c11 -O2 -pthread -I kw47_keyless_entry \
+*                    -I libs/middleware/wireless/framework/Common \
+*                    -o tools/prox_tune tools/prox_tune.c -lm
+*
+*         Usage:  prox_tune [-l manifest | -s n] [-g | -r n] [options]
+*
+*           -l file     labelled trace manifest
+*           -s n        synthetic corpus, n traces per label (default 8)
+*           -S seed     seed for the synthetic corpus and the random search
+*           -g          full grid search
+*           -r n        random search over the grid, n candidates (default 2000)
+*           -p name=lo:hi:step   override a search range (see -h for names)
+*           -j n        worker threads (default: all cores)
+*           -F pct      maximum false-unlock rate for the chosen set
+*           -M pct      maximum missed-unlock rate for the chosen set
+*                       The chosen set is the fastest front point within
+*                       -F/-M, by default the one with the fewest errors.
+*           -n rows     front rows to print (default 25)
+*           -o file     write the chosen set as prox_rssi_params.h
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE             /* sysconf(_SC_NPROCESSORS_ONLN), getopt, clock_gettime */
+#endif
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ProxRssi.h"
+#include "ProxRssi.c"
+#include "prox_rssi_params.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define PROX_TUNE_LUT_LEN           (1001u)     /* RSSI_ALPHA_LUT_LEN in rssi_integration.c */
+#define PROX_TUNE_DIMS              (6u)
+#define PROX_TUNE_NO_LATENCY        (0xFFFFFFFFu)
+#define PROX_TUNE_MAX_THREADS       (256u)
+#define PROX_TUNE_NO_LIMIT          (0xFFFFFFFFu)
+
+typedef enum
+{
+    proxTuneApproach_c,
+    proxTunePocket_c,
+    proxTunePassBy_c,
+    proxTuneWalkAway_c,
+    proxTuneLabelCount_c
+} proxTuneLabel_t;
+
+static const char *const gaProxTuneLabelNames[proxTuneLabelCount_c] =
+{
+    "approach", "pocket", "passby", "walkaway"
+};
+
+/* Labels on which an unlock is expected */
+static const bool_t gaProxTuneExpectUnlock[proxTuneLabelCount_c] =
+{
+    TRUE, TRUE, FALSE, FALSE
+};
+
+typedef struct
+{
+    proxTuneLabel_t label;
+    uint32_t        refMs;
+    uint32_t        n;
+    uint32_t       *pTMs;
+    int8_t         *pRssi;
+} proxTuneTrace_t;
+
+typedef struct
+{
+    proxTuneTrace_t *pTraces;
+    uint32_t         n;
+    uint32_t         cap;
+} proxTuneCorpus_t;
+
+/* Searched dimensions, in this order */
+typedef enum
+{
+    proxTuneHampelK_c,          /* hampelKQ4 */
+    proxTunePct_c,              /* pctThQ15 */
+    proxTuneStd_c,              /* stdThQ4 */
+    proxTuneStable_c,           /* stableMs */
+    proxTuneEnter_c,            /* enterNear, dBm */
+    proxTuneExitGap_c           /* enterNear - exitNear, dB */
+} proxTuneDim_t;
+
+typedef struct
+{
+    const char *pName;
+    int32_t     lo;
+    int32_t     hi;
+    int32_t     step;
+} proxTuneRange_t;
+
+typedef struct
+{
+    int32_t v[PROX_TUNE_DIMS];
+} proxTuneCand_t;
+
+typedef struct
+{
+    uint32_t positives;
+    uint32_t missed;
+    uint32_t negatives;
+    uint32_t falseUnlocks;
+    uint32_t latP50Ms;
+    uint32_t latP95Ms;
+    bool_t   onFront;
+    bool_t   onFalseFront;      /* Latency vs false-unlock front */
+    bool_t   onMissFront;       /* Latency vs missed-unlock front */
+} proxTuneResult_t;
+
+typedef struct
+{
+    const proxTuneCorpus_t *pCorpus;
+    const proxTuneCand_t   *pCands;
+    proxTuneResult_t       *pResults;
+    uint32_t                numCands;
+    atomic_uint             next;
+} proxTuneJob_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static proxTuneRange_t gaProxTuneRanges[PROX_TUNE_DIMS] =
+{
+    { "hampelK",  24,     64,    8    },
+    { "pct",      6554,   26214, 3277 },
+    { "std",      48,     192,   24   },
+    { "stable",   500,    3000,  500  },
+    { "enter",    -62,    -44,   3    },
+    { "exitGap",  4,      16,    4    },
+};
+
+static uint16_t gaProxTuneLut[PROX_TUNE_LUT_LEN];
+
+/*******************************************************************************
+ * Random numbers
+ ******************************************************************************/
+
+static uint64_t ProxTune_SplitMix(uint64_t *pState)
+{
+    uint64_t z = (*pState += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static double ProxTune_Uniform(uint64_t *pState)
+{
+    return (double)(ProxTune_SplitMix(pState) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double ProxTune_Gauss(uint64_t *pState)
+{
+    double u1 = ProxTune_Uniform(pState);
+    double u2 = ProxTune_Uniform(pState);
+
+    if (u1 < 1e-12)
+    {
+        u1 = 1e-12;
+    }
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+/*******************************************************************************
+ * Corpus
+ ******************************************************************************/
+
+static proxTuneTrace_t *ProxTune_AddTrace(proxTuneCorpus_t *pCorpus, proxTuneLabel_t label,
+                                          uint32_t refMs, uint32_t cap)
+{
+    proxTuneTrace_t *pT;
+
+    if (pCorpus->n == pCorpus->cap)
+    {
+        uint32_t newCap = (pCorpus->cap == 0u) ? 16u : (pCorpus->cap * 2u);
+        proxTuneTrace_t *pNew = realloc(pCorpus->pTraces, newCap * sizeof(proxTuneTrace_t));
+
+        if (pNew == NULL)
+        {
+            return NULL;
+        }
+        pCorpus->pTraces = pNew;
+        pCorpus->cap     = newCap;
+    }
+
+    pT = &pCorpus->pTraces[pCorpus->n];
+    pT->label = label;
+    pT->refMs = refMs;
+    pT->n     = 0u;
+    pT->pTMs  = malloc(((cap != 0u) ? cap : 1u) * sizeof(uint32_t));
+    pT->pRssi = malloc((cap != 0u) ? cap : 1u);
+    if ((pT->pTMs == NULL) || (pT->pRssi == NULL))
+    {
+        free(pT->pTMs);
+        free(pT->pRssi);
+        return NULL;
+    }
+    pCorpus->n++;
+    return pT;
+}
+
+static void ProxTune_FreeCorpus(proxTuneCorpus_t *pCorpus)
+{
+    for (uint32_t i = 0u; i < pCorpus->n; i++)
+    {
+        free(pCorpus->pTraces[i].pTMs);
+        free(pCorpus->pTraces[i].pRssi);
+    }
+    free(pCorpus->pTraces);
+    memset(pCorpus, 0, sizeof(*pCorpus));
+}
+
+/* Distance (m) of the phone at time t (s) for one synthetic walk */
+typedef struct
+{
+    proxTuneLabel_t label;
+    double          startM;     /* approach, walkaway: start distance */
+    double          stopM;      /* approach: stop distance, walkaway: end distance */
+    double          speed;      /* m/s */
+    double          dwellS;     /* time standing still at the car (approach, walkaway) */
+    double          closestM;   /* passby: distance of the closest point */
+} proxTuneWalk_t;
+
+static double ProxTune_WalkDistance(const proxTuneWalk_t *pW, double t, double *pDurationS, double *pRefS)
+{
+    double walkS;
+    double d;
+
+    switch (pW->label)
+    {
+        case proxTuneApproach_c:
+        case proxTunePocket_c:
+            walkS = (pW->startM - pW->stopM) / pW->speed;
+            *pDurationS = walkS + pW->dwellS;
+            *pRefS = walkS;
+            d = (t < walkS) ? (pW->startM - (pW->speed * t)) : pW->stopM;
+            break;
+
+        case proxTunePassBy_c:
+        {
+            double x = (-pW->startM) + (pW->speed * t);
+
+            *pDurationS = (2.0 * pW->startM) / pW->speed;
+            *pRefS = *pDurationS / 2.0;
+            d = sqrt((x * x) + (pW->closestM * pW->closestM));
+            break;
+        }
+
+        case proxTuneWalkAway_c:
+        default:
+            walkS = (pW->stopM - pW->startM) / pW->speed;
+            *pDurationS = pW->dwellS + walkS;
+            *pRefS = 0.0;
+            d = (t < pW->dwellS) ? pW->startM : (pW->startM + (pW->speed * (t - pW->dwellS)));
+            break;
+    }
+    return d;
+}
+
+/* Synthetic traces: log-distance path loss (-47 dBm at 1 m, exponent 2.2),
+ * per trace device offset, correlated fading, deep fades and dropped samples
+ * at a jittered 10 Hz. Pocket traces lose 8 dB to the body. */
+static int ProxTune_Synthesize(proxTuneCorpus_t *pCorpus, uint32_t perLabel, uint64_t seed)
+{
+    uint64_t rng = seed;
+
+    for (uint32_t label = 0u; label < (uint32_t)proxTuneLabelCount_c; label++)
+    {
+        for (uint32_t k = 0u; k < perLabel; k++)
+        {
+            proxTuneWalk_t w;
+            proxTuneTrace_t *pT;
+            double durationS;
+            double refS;
+            double offsetDb = (ProxTune_Uniform(&rng) * 6.0) - 3.0;
+            double sigmaDb  = 3.0 + (ProxTune_Uniform(&rng) * 2.0);
+            double lossDb   = 0.0;
+            double fade     = 0.0;
+            uint32_t tMs    = 0u;
+
+            w.label    = (proxTuneLabel_t)label;
+            w.speed    = 1.0 + (ProxTune_Uniform(&rng) * 0.5);
+            w.dwellS   = 6.0 + (ProxTune_Uniform(&rng) * 4.0);
+            w.closestM = 3.0 + (ProxTune_Uniform(&rng) * 2.0);
+            switch (w.label)
+            {
+                case proxTuneApproach_c:
+                case proxTunePocket_c:
+                    w.startM = 12.0 + (ProxTune_Uniform(&rng) * 8.0);
+                    w.stopM  = 0.5 + (ProxTune_Uniform(&rng) * 0.5);
+                    lossDb   = (w.label == proxTunePocket_c) ? 8.0 : 0.0;
+                    break;
+                case proxTunePassBy_c:
+                    w.startM = 15.0;
+                    w.stopM  = 0.0;
+                    break;
+                case proxTuneWalkAway_c:
+                default:
+                    w.startM = 2.5 + ProxTune_Uniform(&rng);
+                    w.stopM  = 20.0;
+                    w.dwellS = 3.0;
+                    break;
+            }
+
+            (void)ProxTune_WalkDistance(&w, 0.0, &durationS, &refS);
+            pT = ProxTune_AddTrace(pCorpus, w.label, (uint32_t)(refS * 1000.0),
+                                   (uint32_t)(durationS * 10.0) + 16u);
+            if (pT == NULL)
+            {
+                return -1;
+            }
+
+            for (;;)
+            {
+                double t;
+                double d;
+                double rssi;
+
+                tMs += 80u + (uint32_t)(ProxTune_Uniform(&rng) * 40.0);
+                t = (double)tMs / 1000.0;
+                if ((t > durationS) || (pT->n >= (uint32_t)(durationS * 10.0) + 16u))
+                {
+                    break;
+                }
+                fade = (0.7 * fade) + (0.714 * sigmaDb * ProxTune_Gauss(&rng));
+                if (ProxTune_Uniform(&rng) < 0.05)
+                {
+                    continue;                       /* RSSI read lost */
+                }
+
+                d = ProxTune_WalkDistance(&w, t, &durationS, &refS);
+                if (d < 0.3)
+                {
+                    d = 0.3;
+                }
+                rssi = -47.0 - (22.0 * log10(d)) + offsetDb - lossDb + fade;
+                if (ProxTune_Uniform(&rng) < 0.02)
+                {
+                    rssi -= 15.0;                   /* Deep multipath fade */
+                }
+                rssi = (rssi > -20.0) ? -20.0 : ((rssi < -100.0) ? -100.0 : rssi);
+
+                pT->pTMs[pT->n]  = tMs;
+                pT->pRssi[pT->n] = (int8_t)lround(rssi);
+                pT->n++;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int ProxTune_LoadCsv(proxTuneCorpus_t *pCorpus, proxTuneLabel_t label, uint32_t refMs, const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "r");
+    char line[128];
+    uint32_t lines = 0u;
+    proxTuneTrace_t *pT;
+
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", pPath);
+        return -1;
+    }
+    while (fgets(line, (int)sizeof(line), pFile) != NULL)
+    {
+        lines++;
+    }
+    rewind(pFile);
+
+    pT = ProxTune_AddTrace(pCorpus, label, refMs, lines);
+    if (pT == NULL)
+    {
+        fclose(pFile);
+        return -1;
+    }
+    while ((fgets(line, (int)sizeof(line), pFile) != NULL) && (pT->n < lines))
+    {
+        unsigned long t;
+        int rssi;
+
+        /* Header and comment lines do not parse */
+        if (sscanf(line, "%lu,%d", &t, &rssi) == 2)
+        {
+            pT->pTMs[pT->n]  = (uint32_t)t;
+            pT->pRssi[pT->n] = (int8_t)rssi;
+            pT->n++;
+        }
+    }
+    fclose(pFile);
+    return 0;
+}
+
+static int ProxTune_LoadManifest(proxTuneCorpus_t *pCorpus, const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "r");
+    char line[512];
+    int rc = 0;
+
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", pPath);
+        return -1;
+    }
+    while ((rc == 0) && (fgets(line, (int)sizeof(line), pFile) != NULL))
+    {
+        char labelName[32];
+        char csv[400];
+        unsigned long refMs = 0u;
+        uint32_t label;
+        int fields = sscanf(line, "%31s %399s %lu", labelName, csv, &refMs);
+
+        if ((fields < 2) || (labelName[0] == '#'))
+        {
+            continue;
+        }
+        for (label = 0u; label < (uint32_t)proxTuneLabelCount_c; label++)
+        {
+            if (strcmp(labelName, gaProxTuneLabelNames[label]) == 0)
+            {
+                break;
+            }
+        }
+        if (label == (uint32_t)proxTuneLabelCount_c)
+        {
+            fprintf(stderr, "%s: unknown label '%s'\n", pPath, labelName);
+            rc = -1;
+        }
+        else
+        {
+            rc = ProxTune_LoadCsv(pCorpus, (proxTuneLabel_t)label, (uint32_t)refMs, csv);
+        }
+    }
+    fclose(pFile);
+    return rc;
+}
+
+/*******************************************************************************
+ * Evaluation
+ ******************************************************************************/
+
+static void ProxTune_BuildLut(void)
+{
+    /* Same ramp as RssiIntegration_BuildAlphaLut */
+    for (uint32_t i = 0u; i < PROX_TUNE_LUT_LEN; i++)
+    {
+        uint32_t alpha = PROX_PARAM_ALPHA_START_Q15 + ((i * PROX_PARAM_ALPHA_SLOPE_Q15) / 1000u);
+
+        gaProxTuneLut[i] = (uint16_t)((alpha > 32767u) ? 32767u : alpha);
+    }
+}
+
+/* Firmware defaults from prox_rssi_params.h, as RssiIntegration_Init sets them */
+static void ProxTune_DefaultParams(ProxRssi_ParamsType *pP)
+{
+    memset(pP, 0, sizeof(*pP));
+    pP->wRawMs            = PROX_PARAM_W_RAW_MS;
+    pP->wSpikeMs          = PROX_PARAM_W_SPIKE_MS;
+    pP->wFeatMs           = PROX_PARAM_W_FEAT_MS;
+    pP->hampelKQ4         = PROX_PARAM_HAMPEL_K_Q4;
+    pP->madEpsQ4          = PROX_PARAM_MAD_EPS_Q4;
+    pP->enterNearQ4       = ProxRssi_DbmToQ4((int8_t)PROX_PARAM_ENTER_NEAR_DBM);
+    pP->exitNearQ4        = ProxRssi_DbmToQ4((int8_t)PROX_PARAM_EXIT_NEAR_DBM);
+    pP->hystQ4            = (uint16_t)ProxRssi_DbToQ4((int16_t)PROX_PARAM_HYST_DB);
+    pP->pctThQ15          = PROX_PARAM_PCT_TH_Q15;
+    pP->stdThQ4           = PROX_PARAM_STD_TH_Q4;
+    pP->stableMs          = PROX_PARAM_STABLE_MS;
+    pP->minFeatSamples    = PROX_PARAM_MIN_FEAT_SAMPLES;
+    pP->exitConfirmMs     = PROX_PARAM_EXIT_CONFIRM_MS;
+    pP->lockoutMs         = PROX_PARAM_LOCKOUT_MS;
+    pP->maxReasonableDtMs = PROX_PARAM_MAX_REASONABLE_DT_MS;
+}
+
+static void ProxTune_DefaultCand(proxTuneCand_t *pC)
+{
+    pC->v[proxTuneHampelK_c] = (int32_t)PROX_PARAM_HAMPEL_K_Q4;
+    pC->v[proxTunePct_c]     = (int32_t)PROX_PARAM_PCT_TH_Q15;
+    pC->v[proxTuneStd_c]     = (int32_t)PROX_PARAM_STD_TH_Q4;
+    pC->v[proxTuneStable_c]  = (int32_t)PROX_PARAM_STABLE_MS;
+    pC->v[proxTuneEnter_c]   = PROX_PARAM_ENTER_NEAR_DBM;
+    pC->v[proxTuneExitGap_c] = PROX_PARAM_ENTER_NEAR_DBM - PROX_PARAM_EXIT_NEAR_DBM;
+}
+
+static void ProxTune_CandParams(const proxTuneCand_t *pC, ProxRssi_ParamsType *pP)
+{
+    ProxTune_DefaultParams(pP);
+    pP->hampelKQ4   = (uint16_t)pC->v[proxTuneHampelK_c];
+    pP->pctThQ15    = (uint16_t)pC->v[proxTunePct_c];
+    pP->stdThQ4     = (uint16_t)pC->v[proxTuneStd_c];
+    pP->stableMs    = (uint32_t)pC->v[proxTuneStable_c];
+    pP->enterNearQ4 = ProxRssi_DbmToQ4((int8_t)pC->v[proxTuneEnter_c]);
+    pP->exitNearQ4  = ProxRssi_DbmToQ4((int8_t)(pC->v[proxTuneEnter_c] - pC->v[proxTuneExitGap_c]));
+}
+
+static int ProxTune_CmpU32(const void *pA, const void *pB)
+{
+    uint32_t a = *(const uint32_t *)pA;
+    uint32_t b = *(const uint32_t *)pB;
+
+    return (a > b) - (a < b);
+}
+
+/* Run one candidate over the corpus. pCtx and pLat (corpus size) are scratch. */
+static void ProxTune_Evaluate(const proxTuneCorpus_t *pCorpus, const proxTuneCand_t *pCand,
+                              ProxRssi_CtxType *pCtx, uint32_t *pLat, proxTuneResult_t *pRes)
+{
+    ProxRssi_ParamsType params;
+    uint32_t numLat = 0u;
+
+    ProxTune_CandParams(pCand, &params);
+    memset(pRes, 0, sizeof(*pRes));
+
+    for (uint32_t i = 0u; i < pCorpus->n; i++)
+    {
+        const proxTuneTrace_t *pT = &pCorpus->pTraces[i];
+        bool_t unlocked = FALSE;
+        uint32_t tUnlock = 0u;
+
+        (void)ProxRssi_Init(pCtx, &params, gaProxTuneLut, PROX_TUNE_LUT_LEN);
+        for (uint32_t s = 0u; (s < pT->n) && (unlocked == FALSE); s++)
+        {
+            ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+            ProxRssi_FeaturesType feat;
+
+            /* Same filter as RssiIntegration_UpdateRssi */
+            if (pT->pRssi[s] >= 0)
+            {
+                continue;
+            }
+            (void)ProxRssi_PushRaw(pCtx, pT->pTMs[s], pT->pRssi[s]);
+            (void)ProxRssi_MainFunction(pCtx, pT->pTMs[s], &ev, &feat);
+            if (ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED)
+            {
+                unlocked = TRUE;
+                tUnlock  = pT->pTMs[s];
+            }
+        }
+
+        if (gaProxTuneExpectUnlock[pT->label] == TRUE)
+        {
+            pRes->positives++;
+            if (unlocked == TRUE)
+            {
+                pLat[numLat++] = (tUnlock > pT->refMs) ? (tUnlock - pT->refMs) : 0u;
+            }
+            else
+            {
+                pRes->missed++;
+            }
+        }
+        else
+        {
+            pRes->negatives++;
+            if (unlocked == TRUE)
+            {
+                pRes->falseUnlocks++;
+            }
+        }
+    }
+
+    if (numLat == 0u)
+    {
+        pRes->latP50Ms = PROX_TUNE_NO_LATENCY;
+        pRes->latP95Ms = PROX_TUNE_NO_LATENCY;
+    }
+    else
+    {
+        qsort(pLat, numLat, sizeof(uint32_t), ProxTune_CmpU32);
+        pRes->latP50Ms = pLat[(numLat - 1u) / 2u];
+        pRes->latP95Ms = pLat[((numLat - 1u) * 95u) / 100u];
+    }
+}
+
+static void *ProxTune_Worker(void *pArg)
+{
+    proxTuneJob_t *pJob = (proxTuneJob_t *)pArg;
+    ProxRssi_CtxType *pCtx = malloc(sizeof(ProxRssi_CtxType));
+    uint32_t *pLat = malloc(((pJob->pCorpus->n != 0u) ? pJob->pCorpus->n : 1u) * sizeof(uint32_t));
+
+    if ((pCtx != NULL) && (pLat != NULL))
+    {
+        for (;;)
+        {
+            uint32_t i = atomic_fetch_add(&pJob->next, 1u);
+
+            if (i >= pJob->numCands)
+            {
+                break;
+            }
+            ProxTune_Evaluate(pJob->pCorpus, &pJob->pCands[i], pCtx, pLat, &pJob->pResults[i]);
+        }
+    }
+    free(pCtx);
+    free(pLat);
+    return NULL;
+}
+
+/* Evaluate all candidates with numThreads workers. Returns 0 on success. */
+static int ProxTune_RunAll(const proxTuneCorpus_t *pCorpus, const proxTuneCand_t *pCands,
+                           proxTuneResult_t *pResults, uint32_t numCands, uint32_t numThreads)
+{
+    pthread_t aThreads[PROX_TUNE_MAX_THREADS];
+    proxTuneJob_t job;
+    uint32_t started = 0u;
+
+    job.pCorpus  = pCorpus;
+    job.pCands   = pCands;
+    job.pResults = pResults;
+    job.numCands = numCands;
+    atomic_init(&job.next, 0u);
+
+    if (numThreads > PROX_TUNE_MAX_THREADS)
+    {
+        numThreads = PROX_TUNE_MAX_THREADS;
+    }
+    for (uint32_t t = 1u; t < numThreads; t++)
+    {
+        if (pthread_create(&aThreads[started], NULL, ProxTune_Worker, &job) == 0)
+        {
+            started++;
+        }
+    }
+    (void)ProxTune_Worker(&job);
+    for (uint32_t t = 0u; t < started; t++)
+    {
+        (void)pthread_join(aThreads[t], NULL);
+    }
+
+    /* A worker that failed to allocate leaves work for the others, not holes */
+    return (atomic_load(&job.next) >= numCands) ? 0 : -1;
+}
+
+/*******************************************************************************
+ * Search space and Pareto fronts
+ ******************************************************************************/
+
+static uint32_t ProxTune_RangeCount(const proxTuneRange_t *pR)
+{
+    return (pR->hi < pR->lo) ? 1u : (uint32_t)(((pR->hi - pR->lo) / pR->step) + 1);
+}
+
+static uint64_t ProxTune_GridSize(void)
+{
+    uint64_t n = 1u;
+
+    for (uint32_t d = 0u; d < PROX_TUNE_DIMS; d++)
+    {
+        n *= ProxTune_RangeCount(&gaProxTuneRanges[d]);
+    }
+    return n;
+}
+
+static void ProxTune_GridPoint(uint64_t index, proxTuneCand_t *pC)
+{
+    for (uint32_t d = 0u; d < PROX_TUNE_DIMS; d++)
+    {
+        uint32_t count = ProxTune_RangeCount(&gaProxTuneRanges[d]);
+
+        pC->v[d] = gaProxTuneRanges[d].lo + ((int32_t)(index % count) * gaProxTuneRanges[d].step);
+        index /= count;
+    }
+}
+
+/* Grid (numCands == grid size) or random grid points from seed */
+static void ProxTune_MakeCandidates(proxTuneCand_t *pCands, uint32_t numCands, bool_t grid, uint64_t seed)
+{
+    uint64_t gridSize = ProxTune_GridSize();
+    uint64_t rng = seed ^ 0xA5A5A5A5u;
+
+    for (uint32_t i = 0u; i < numCands; i++)
+    {
+        ProxTune_GridPoint((grid == TRUE) ? (uint64_t)i : (ProxTune_SplitMix(&rng) % gridSize), &pCands[i]);
+    }
+}
+
+static int ProxTune_SetRange(const char *pSpec)
+{
+    char name[32];
+    int lo;
+    int hi;
+    int step;
+
+    if (sscanf(pSpec, "%31[^=]=%d:%d:%d", name, &lo, &hi, &step) != 4 || (step <= 0) || (hi < lo))
+    {
+        return -1;
+    }
+    for (uint32_t d = 0u; d < PROX_TUNE_DIMS; d++)
+    {
+        if (strcmp(name, gaProxTuneRanges[d].pName) == 0)
+        {
+            gaProxTuneRanges[d].lo   = lo;
+            gaProxTuneRanges[d].hi   = hi;
+            gaProxTuneRanges[d].step = step;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Objectives, all minimised: false rate, missed rate, median latency. Rates
+ * are compared as cross products so no rounding is involved. */
+static int ProxTune_CmpRate(uint32_t aNum, uint32_t aDen, uint32_t bNum, uint32_t bDen)
+{
+    uint64_t a = (uint64_t)aNum * ((bDen != 0u) ? bDen : 1u);
+    uint64_t b = (uint64_t)bNum * ((aDen != 0u) ? aDen : 1u);
+
+    return (a > b) - (a < b);
+}
+
+static int ProxTune_CmpObjective(const proxTuneResult_t *pA, const proxTuneResult_t *pB, uint32_t obj)
+{
+    switch (obj)
+    {
+        case 0u:  return ProxTune_CmpRate(pA->falseUnlocks, pA->negatives, pB->falseUnlocks, pB->negatives);
+        case 1u:  return ProxTune_CmpRate(pA->missed, pA->positives, pB->missed, pB->positives);
+        default:  return (pA->latP50Ms > pB->latP50Ms) - (pA->latP50Ms < pB->latP50Ms);
+    }
+}
+
+/* TRUE if pA is at least as good as pB in every objective of mask. Equal
+ * points count as dominated so every front lists a trade-off only once. */
+static bool_t ProxTune_Dominates(const proxTuneResult_t *pA, const proxTuneResult_t *pB, uint32_t mask)
+{
+    for (uint32_t obj = 0u; obj < 3u; obj++)
+    {
+        if (((mask & (1u << obj)) != 0u) && (ProxTune_CmpObjective(pA, pB, obj) > 0))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static const proxTuneResult_t *gpProxTuneSortResults;
+
+static int ProxTune_CmpIndex(const void *pA, const void *pB)
+{
+    const proxTuneResult_t *pRa = &gpProxTuneSortResults[*(const uint32_t *)pA];
+    const proxTuneResult_t *pRb = &gpProxTuneSortResults[*(const uint32_t *)pB];
+    int c = 0;
+
+    for (uint32_t obj = 0u; (obj < 3u) && (c == 0); obj++)
+    {
+        c = ProxTune_CmpObjective(pRa, pRb, obj);
+    }
+    if (c == 0)
+    {
+        c = (*(const uint32_t *)pA > *(const uint32_t *)pB) - (*(const uint32_t *)pA < *(const uint32_t *)pB);
+    }
+    return c;
+}
+
+/* Mark the fronts. pOrder receives the candidate indices sorted by (false,
+ * missed, latency). Returns the size of the three-objective front, its
+ * members first in pOrder. */
+static uint32_t ProxTune_MarkFronts(proxTuneResult_t *pResults, uint32_t numCands, uint32_t *pOrder)
+{
+    static const uint32_t aMasks[3] = { 0x7u, 0x5u, 0x6u };
+    uint32_t *pFront = malloc(((numCands != 0u) ? numCands : 1u) * sizeof(uint32_t));
+    uint32_t frontSize = 0u;
+
+    for (uint32_t i = 0u; i < numCands; i++)
+    {
+        pOrder[i] = i;
+        pResults[i].onFront      = FALSE;
+        pResults[i].onFalseFront = FALSE;
+        pResults[i].onMissFront  = FALSE;
+    }
+    gpProxTuneSortResults = pResults;
+    qsort(pOrder, numCands, sizeof(uint32_t), ProxTune_CmpIndex);
+
+    if (pFront == NULL)
+    {
+        return 0u;
+    }
+
+    for (uint32_t m = 0u; m < 3u; m++)
+    {
+        uint32_t kept = 0u;
+
+        for (uint32_t i = 0u; i < numCands; i++)
+        {
+            const proxTuneResult_t *pR = &pResults[pOrder[i]];
+            bool_t dominated = FALSE;
+            uint32_t k;
+
+            for (k = 0u; (k < kept) && (dominated == FALSE); k++)
+            {
+                dominated = ProxTune_Dominates(&pResults[pFront[k]], pR, aMasks[m]);
+            }
+            if (dominated == FALSE)
+            {
+                /* The sort order only covers the full objective set: a later
+                 * point can still dominate kept ones in two dimensions */
+                for (k = 0u; k < kept;)
+                {
+                    if (ProxTune_Dominates(pR, &pResults[pFront[k]], aMasks[m]) == TRUE)
+                    {
+                        pFront[k] = pFront[--kept];
+                    }
+                    else
+                    {
+                        k++;
+                    }
+                }
+                pFront[kept++] = pOrder[i];
+            }
+        }
+
+        for (uint32_t k = 0u; k < kept; k++)
+        {
+            proxTuneResult_t *pR = &pResults[pFront[k]];
+
+            if (m == 0u)
+            {
+                pR->onFront = TRUE;
+            }
+            else if (m == 1u)
+            {
+                pR->onFalseFront = TRUE;
+            }
+            else
+            {
+                pR->onMissFront = TRUE;
+            }
+        }
+        if (m == 0u)
+        {
+            frontSize = kept;
+        }
+    }
+
+    /* Front members first, keeping the sort order */
+    memcpy(pFront, pOrder, numCands * sizeof(uint32_t));
+    {
+        uint32_t head = 0u;
+        uint32_t tail = frontSize;
+
+        for (uint32_t i = 0u; i < numCands; i++)
+        {
+            if (pResults[pFront[i]].onFront == TRUE)
+            {
+                pOrder[head++] = pFront[i];
+            }
+            else
+            {
+                pOrder[tail++] = pFront[i];
+            }
+        }
+    }
+    free(pFront);
+    return frontSize;
+}
+
+/* Pick the front point with the lowest latency within the rate limits (per
+ * mille). Without limits, or when no point qualifies, pick the one with the
+ * fewest errors (false + missed rate), then the lowest latency. */
+static uint32_t ProxTune_Choose(const proxTuneResult_t *pResults, const uint32_t *pOrder, uint32_t frontSize,
+                                uint32_t maxFalsePm, uint32_t maxMissPm)
+{
+    uint32_t best = pOrder[0];
+    bool_t found = FALSE;
+
+    if ((maxFalsePm != PROX_TUNE_NO_LIMIT) || (maxMissPm != PROX_TUNE_NO_LIMIT))
+    {
+        for (uint32_t i = 0u; i < frontSize; i++)
+        {
+            const proxTuneResult_t *pR = &pResults[pOrder[i]];
+
+            if ((ProxTune_CmpRate(pR->falseUnlocks, pR->negatives, maxFalsePm, 1000u) <= 0) &&
+                (ProxTune_CmpRate(pR->missed, pR->positives, maxMissPm, 1000u) <= 0) &&
+                ((found == FALSE) || (pR->latP50Ms < pResults[best].latP50Ms)))
+            {
+                best  = pOrder[i];
+                found = TRUE;
+            }
+        }
+    }
+
+    for (uint32_t i = 0u; (i < frontSize) && (found == FALSE); i++)
+    {
+        const proxTuneResult_t *pR = &pResults[pOrder[i]];
+        const proxTuneResult_t *pB = &pResults[best];
+        /* Same corpus for all candidates: rates share the denominators */
+        uint64_t errors = ((uint64_t)pR->falseUnlocks * pR->positives) + ((uint64_t)pR->missed * pR->negatives);
+        uint64_t bestErrors = ((uint64_t)pB->falseUnlocks * pB->positives) + ((uint64_t)pB->missed * pB->negatives);
+
+        if ((errors < bestErrors) || ((errors == bestErrors) && (pR->latP50Ms < pB->latP50Ms)))
+        {
+            best = pOrder[i];
+        }
+    }
+    return best;
+}
+
+/*******************************************************************************
+ * Output
+ ******************************************************************************/
+
+static double ProxTune_Pct(uint32_t num, uint32_t den)
+{
+    return (den == 0u) ? 0.0 : ((100.0 * (double)num) / (double)den);
+}
+
+/* Write the chosen set in the layout of kw47_keyless_entry/prox_rssi_params.h */
+static int ProxTune_WriteHeader(const char *pPath, const proxTuneCand_t *pC, const proxTuneResult_t *pR,
+                                const proxTuneCorpus_t *pCorpus)
+{
+    FILE *pFile = fopen(pPath, "w");
+
+    if (pFile == NULL)
+    {
+        return -1;
+    }
+
+    fprintf(pFile,
+        "/*! *********************************************************************************\n"
+        "* \\file prox_rssi_params.h\n"
+        "*\n"
+        "* ProxRssi parameter set used by RssiIntegration_Init.\n"
+        "*\n"
+        "* Generated by tools/prox_tune.c over %u traces: false unlocks %.1f%%,\n"
+        "* missed unlocks %.1f%%, unlock latency p50 %u ms / p95 %u ms.\n"
+        "* Thresholds are in dBm / dB, converted to Q4 at init.\n"
+        "*\n"
+        "* Copyright 2025\n"
+        "* SPDX-License-Identifier: BSD-3-Clause\n"
+        "********************************************************************************** */\n\n",
+        pCorpus->n, ProxTune_Pct(pR->falseUnlocks, pR->negatives), ProxTune_Pct(pR->missed, pR->positives),
+        (pR->latP50Ms == PROX_TUNE_NO_LATENCY) ? 0u : pR->latP50Ms,
+        (pR->latP95Ms == PROX_TUNE_NO_LATENCY) ? 0u : pR->latP95Ms);
+
+    fprintf(pFile, "#ifndef PROX_RSSI_PARAMS_H\n#define PROX_RSSI_PARAMS_H\n\n");
+    fprintf(pFile, "/* Windows (ms) */\n");
+    fprintf(pFile, "#define PROX_PARAM_W_RAW_MS                 (%uu)\n", (unsigned)PROX_PARAM_W_RAW_MS);
+    fprintf(pFile, "#define PROX_PARAM_W_SPIKE_MS               (%uu)\n", (unsigned)PROX_PARAM_W_SPIKE_MS);
+    fprintf(pFile, "#define PROX_PARAM_W_FEAT_MS                (%uu)\n\n", (unsigned)PROX_PARAM_W_FEAT_MS);
+    fprintf(pFile, "/* Hampel spike rejection */\n");
+    fprintf(pFile, "#define PROX_PARAM_HAMPEL_K_Q4              (%du)\n", pC->v[proxTuneHampelK_c]);
+    fprintf(pFile, "#define PROX_PARAM_MAD_EPS_Q4               (%uu)\n\n", (unsigned)PROX_PARAM_MAD_EPS_Q4);
+    fprintf(pFile, "/* Thresholds */\n");
+    fprintf(pFile, "#define PROX_PARAM_ENTER_NEAR_DBM           (%d)\n", pC->v[proxTuneEnter_c]);
+    fprintf(pFile, "#define PROX_PARAM_EXIT_NEAR_DBM            (%d)\n",
+            pC->v[proxTuneEnter_c] - pC->v[proxTuneExitGap_c]);
+    fprintf(pFile, "#define PROX_PARAM_HYST_DB                  (%d)\n\n", (int)PROX_PARAM_HYST_DB);
+    fprintf(pFile, "/* Stability gate */\n");
+    fprintf(pFile, "#define PROX_PARAM_PCT_TH_Q15               (%du)\n", pC->v[proxTunePct_c]);
+    fprintf(pFile, "#define PROX_PARAM_STD_TH_Q4                (%du)\n", pC->v[proxTuneStd_c]);
+    fprintf(pFile, "#define PROX_PARAM_STABLE_MS                (%du)\n", pC->v[proxTuneStable_c]);
+    fprintf(pFile, "#define PROX_PARAM_MIN_FEAT_SAMPLES         (%uu)\n\n", (unsigned)PROX_PARAM_MIN_FEAT_SAMPLES);
+    fprintf(pFile, "/* State machine */\n");
+    fprintf(pFile, "#define PROX_PARAM_EXIT_CONFIRM_MS          (%uu)\n", (unsigned)PROX_PARAM_EXIT_CONFIRM_MS);
+    fprintf(pFile, "#define PROX_PARAM_LOCKOUT_MS               (%uu)\n", (unsigned)PROX_PARAM_LOCKOUT_MS);
+    fprintf(pFile, "#define PROX_PARAM_MAX_REASONABLE_DT_MS     (%uu)\n\n", (unsigned)PROX_PARAM_MAX_REASONABLE_DT_MS);
+    fprintf(pFile, "/* Reconnect of a bonded peer within this time restores its filter history, 0 = cold start */\n");
+    fprintf(pFile, "#define PROX_PARAM_WARM_START_MS            (%uu)\n\n", (unsigned)PROX_PARAM_WARM_START_MS);
+    fprintf(pFile, "/* Alpha LUT: alpha_q15 = START + i * SLOPE / 1000, i = 0 .. LUT length - 1 */\n");
+    fprintf(pFile, "#define PROX_PARAM_ALPHA_START_Q15          (%uu)\n", (unsigned)PROX_PARAM_ALPHA_START_Q15);
+    fprintf(pFile, "#define PROX_PARAM_ALPHA_SLOPE_Q15          (%uu)\n\n", (unsigned)PROX_PARAM_ALPHA_SLOPE_Q15);
+    fprintf(pFile, "#endif /* PROX_RSSI_PARAMS_H */\n");
+
+    return (fclose(pFile) == 0) ? 0 : -1;
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+#ifndef PROX_TUNE_NO_MAIN
+static void ProxTune_PrintRow(const proxTuneCand_t *pC, const proxTuneResult_t *pR, const char *pTag)
+{
+    char lat[32];
+
+    if (pR->latP50Ms == PROX_TUNE_NO_LATENCY)
+    {
+        (void)snprintf(lat, sizeof(lat), "%7s %7s", "-", "-");
+    }
+    else
+    {
+        (void)snprintf(lat, sizeof(lat), "%7u %7u", pR->latP50Ms, pR->latP95Ms);
+    }
+    printf("%6.1f %6.1f %s  %3s  %4d %6d %4d %6d %5d %4d  %s\n",
+           ProxTune_Pct(pR->falseUnlocks, pR->negatives), ProxTune_Pct(pR->missed, pR->positives), lat,
+           (pR->onFalseFront == TRUE) ? ((pR->onMissFront == TRUE) ? "F,M" : "F") :
+           ((pR->onMissFront == TRUE) ? "M" : ""),
+           pC->v[proxTuneHampelK_c], pC->v[proxTunePct_c], pC->v[proxTuneStd_c], pC->v[proxTuneStable_c],
+           pC->v[proxTuneEnter_c], pC->v[proxTuneEnter_c] - pC->v[proxTuneExitGap_c], pTag);
+}
+
+static void ProxTune_PrintHeading(void)
+{
+    printf("false%%  miss%%  p50 ms  p95 ms  2D   hmpK    pct  std stable enter exit\n");
+}
+
+static void ProxTune_Usage(void)
+{
+    fprintf(stderr, "Usage: prox_tune [-l manifest | -s n] [-S seed] [-g | -r n] [-p name=lo:hi:step]\n"
+                    "                 [-j threads] [-F pct] [-M pct] [-n rows] [-o header]\n"
+                    "Ranges:");
+    for (uint32_t d = 0u; d < PROX_TUNE_DIMS; d++)
+    {
+        fprintf(stderr, " %s=%d:%d:%d", gaProxTuneRanges[d].pName, gaProxTuneRanges[d].lo,
+                gaProxTuneRanges[d].hi, gaProxTuneRanges[d].step);
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+    proxTuneCorpus_t corpus = { 0 };
+    const char *pManifest = NULL;
+    const char *pOut = NULL;
+    uint32_t perLabel = 8u;
+    uint64_t seed = 1u;
+    bool_t grid = FALSE;
+    uint32_t numCands = 2000u;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t numThreads = (cores > 0) ? (uint32_t)cores : 1u;
+    uint32_t maxFalsePm = PROX_TUNE_NO_LIMIT;
+    uint32_t maxMissPm = PROX_TUNE_NO_LIMIT;
+    uint32_t rows = 25u;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:s:S:gr:p:j:F:M:n:o:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'l': pManifest  = optarg; break;
+            case 's': perLabel   = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'S': seed       = strtoull(optarg, NULL, 0); break;
+            case 'g': grid       = TRUE; break;
+            case 'r': numCands   = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'j': numThreads = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'F': maxFalsePm = (uint32_t)(strtod(optarg, NULL) * 10.0); break;
+            case 'M': maxMissPm  = (uint32_t)(strtod(optarg, NULL) * 10.0); break;
+            case 'n': rows       = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'o': pOut       = optarg; break;
+            case 'p':
+                if (ProxTune_SetRange(optarg) != 0)
+                {
+                    fprintf(stderr, "Bad range '%s'\n", optarg);
+                    ProxTune_Usage();
+                    return 2;
+                }
+                break;
+            default:
+                ProxTune_Usage();
+                return 2;
+        }
+    }
+
+    ProxTune_BuildLut();
+    if (((pManifest != NULL) ? ProxTune_LoadManifest(&corpus, pManifest) :
+                               ProxTune_Synthesize(&corpus, perLabel, seed)) != 0)
+    {
+        ProxTune_FreeCorpus(&corpus);
+        return 1;
+    }
+    if (corpus.n == 0u)
+    {
+        fprintf(stderr, "Empty corpus\n");
+        return 1;
+    }
+
+    if (grid == TRUE)
+    {
+        uint64_t gridSize = ProxTune_GridSize();
+
+        if (gridSize > 10000000u)
+        {
+            fprintf(stderr, "Grid of %llu points is too large, narrow the ranges\n", (unsigned long long)gridSize);
+            ProxTune_FreeCorpus(&corpus);
+            return 2;
+        }
+        numCands = (uint32_t)gridSize;
+    }
+    numThreads = (numThreads == 0u) ? 1u : numThreads;
+
+    /* Candidate 0 is the current firmware set, for reference */
+    numCands++;
+    proxTuneCand_t *pCands = malloc(numCands * sizeof(proxTuneCand_t));
+    proxTuneResult_t *pResults = malloc(numCands * sizeof(proxTuneResult_t));
+    uint32_t *pOrder = malloc(numCands * sizeof(uint32_t));
+    if ((pCands == NULL) || (pResults == NULL) || (pOrder == NULL))
+    {
+        ProxTune_FreeCorpus(&corpus);
+        return 1;
+    }
+    ProxTune_DefaultCand(&pCands[0]);
+    ProxTune_MakeCandidates(&pCands[1], numCands - 1u, grid, seed);
+
+    unsigned long samples = 0u;
+    uint32_t perLabelCount[proxTuneLabelCount_c] = { 0u };
+    for (uint32_t i = 0u; i < corpus.n; i++)
+    {
+        samples += corpus.pTraces[i].n;
+        perLabelCount[corpus.pTraces[i].label]++;
+    }
+    printf("Corpus: %u traces (%u approach, %u pocket, %u passby, %u walkaway), %lu samples\n",
+           corpus.n, perLabelCount[proxTuneApproach_c], perLabelCount[proxTunePocket_c],
+           perLabelCount[proxTunePassBy_c], perLabelCount[proxTuneWalkAway_c], samples);
+    printf("Search: %s, %u candidates on %u threads\n", (grid == TRUE) ? "grid" : "random", numCands - 1u,
+           numThreads);
+
+    struct timespec t0;
+    struct timespec t1;
+    (void)clock_gettime(CLOCK_MONOTONIC, &t0);
+    int rc = ProxTune_RunAll(&corpus, pCands, pResults, numCands, numThreads);
+    (void)clock_gettime(CLOCK_MONOTONIC, &t1);
+    double sec = (double)(t1.tv_sec - t0.tv_sec) + ((double)(t1.tv_nsec - t0.tv_nsec) / 1e9);
+
+    if (rc != 0)
+    {
+        fprintf(stderr, "Out of memory in the workers\n");
+    }
+    else
+    {
+        printf("Replayed %.1f M samples in %.2f s (%.1f M samples/s)\n\n",
+               ((double)samples * (double)numCands) / 1e6, sec,
+               ((double)samples * (double)numCands) / (sec * 1e6));
+
+        uint32_t frontSize = ProxTune_MarkFronts(pResults, numCands, pOrder);
+        uint32_t best = ProxTune_Choose(pResults, pOrder, frontSize, maxFalsePm, maxMissPm);
+
+        printf("Pareto front, %u of %u candidates (2D: also on the latency/false F or latency/missed M front)\n",
+               frontSize, numCands);
+        ProxTune_PrintHeading();
+        for (uint32_t i = 0u; (i < frontSize) && (i < rows); i++)
+        {
+            ProxTune_PrintRow(&pCands[pOrder[i]], &pResults[pOrder[i]],
+                              (pOrder[i] == best) ? "<- chosen" : ((pOrder[i] == 0u) ? "<- current" : ""));
+        }
+        if (frontSize > rows)
+        {
+            printf("... %u more\n", frontSize - rows);
+        }
+        printf("\n");
+        ProxTune_PrintHeading();
+        ProxTune_PrintRow(&pCands[0], &pResults[0], "current");
+        ProxTune_PrintRow(&pCands[best], &pResults[best], "chosen");
+
+        if (pOut != NULL)
+        {
+            rc = ProxTune_WriteHeader(pOut, &pCands[best], &pResults[best], &corpus);
+            printf("\n%s %s\n", (rc == 0) ? "Wrote" : "Cannot write", pOut);
+        }
+    }
+
+    free(pCands);
+    free(pResults);
+    free(pOrder);
+    ProxTune_FreeCorpus(&corpus);
+    return (rc == 0) ? 0 : 1;
+}
+#endif /* PROX_TUNE_NO_MAIN */
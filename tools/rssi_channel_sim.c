@@ -0,0 +1,969 @@
+/*! *********************************************************************************
+* \file rssi_channel_sim.c
+*
+* \brief  Seeded BLE RSSI channel simulator and decision latency benchmark.
+*
+*         Generates the RSSI stream a phone produces while its owner walks a
+*         scripted trajectory around the anchor (at the origin) and drives both
+*         proximity engines with it: ProxRssi (as RssiIntegration_UpdateRssi
+*         does) and the example's rssi_filter.c (as proximity_state_machine.c
+*         does). Reports time-to-unlock, false and early unlocks and spurious
+*         state transitions per scenario.
+*
+*         Channel model, per sample:
+*           - log-distance path loss, -47 dBm at 1 m, exponent 2.2
+*           - log-normal shadowing, 3 dB, decorrelated over 2 m of walking
+*           - Rician fading, K from 9 dB at the car down to 0 dB at 10 m,
+*             Rayleigh while the body blocks the line of sight; correlated
+*             over half a wavelength of movement and across channel hops
+*           - phone orientation loss (pattern) and body shadowing from the
+*             angle between the walking direction and the anchor, per carry
+*             mode (hand, pocket, bag), plus a per run device offset
+*           - 100 ms RSSI reads with jitter, late reports and lost reads
+*             (RSSI 127), readings below -100 dBm lost too
+*
+*         Scenarios: approach (expects one unlock, latency from arrival),
+*         passby, walkaway, loiter (no unlock expected). Every run is seeded
+*         from (seed, run index), so results do not depend on the thread count.
+*
+*         Build:  cc -std=c11 -O2 -pthread -I kw47_keyless_entry -I tests/stubs \
+*                    -I libs/middleware/wireless/bluetooth/examples/digital_key_car_anchor_cs \
+*                    -I libs/middleware/wireless/framework/Common \
+*                    -o tools/rssi_channel_sim tools/rssi_channel_sim.c -lm
+*
+*         Usage:  rssi_channel_sim [-n runs] [-S seed] [-j threads] [-s scenario]
+*                                  [-m carry] [-e engine] [-c trace.csv]
+*
+*           -n runs     runs per scenario (default 10000)
+*           -S seed     base seed (default 1)
+*           -j n        worker threads (default: all cores)
+*           -s name     approach, passby, walkaway, loiter or all (default)
+*           -m mode     hand, pocket, bag or mix (default)
+*           -e engine   prox, filter or both (default)
+*           -c file     write the first run of the first scenario as "tMs,rssi"
+*
+*         rssi_filter.c reads its clock through ProxTime_Now(); the host
+*         TM_GetTimestamp() stub is set to the simulation time in microseconds,
+*         as the timer manager counts on the target.
+*
+* Copyright 2025
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE             /* sysconf(_SC_NPROCESSORS_ONLN), getopt, clock_gettime */
+#endif
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ProxRssi.h"
+#include "ProxRssi.c"
+#include "prox_rssi_params.h"
+#include "fsl_component_timer_manager.h"
+#include "prox_time.c"
+#include "rssi_filter.h"
+#include "rssi_filter.c"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define CHAN_SIM_LUT_LEN            (1001u)     /* RSSI_ALPHA_LUT_LEN in rssi_integration.c */
+#define CHAN_SIM_MAX_WAYPOINTS      (8u)
+#define CHAN_SIM_MAX_SAMPLES        (1024u)     /* 100 s at 10 Hz */
+#define CHAN_SIM_PERIOD_MS          (100u)      /* RSSI_MONITOR_INTERVAL_MS */
+#define CHAN_SIM_LAT_BIN_MS         (20u)
+#define CHAN_SIM_LAT_BINS           (1500u)     /* 30 s, longer latencies land in the last bin */
+#define CHAN_SIM_EARLY_M            (3.0)       /* Unlock farther than this is early */
+#define CHAN_SIM_RUN_CHUNK          (64u)
+#define CHAN_SIM_MAX_THREADS        (256u)
+#define CHAN_SIM_RSSI_INVALID       (127)
+#define CHAN_SIM_LAMBDA_M           (0.125)     /* 2.4 GHz */
+
+typedef enum
+{
+    chanSimApproach_c,
+    chanSimPassBy_c,
+    chanSimWalkAway_c,
+    chanSimLoiter_c,
+    chanSimScenarioCount_c
+} chanSimScenario_t;
+
+typedef enum
+{
+    chanSimHand_c,
+    chanSimPocket_c,
+    chanSimBag_c,
+    chanSimCarryCount_c,
+    chanSimMix_c = chanSimCarryCount_c
+} chanSimCarry_t;
+
+typedef enum
+{
+    chanSimProx_c,
+    chanSimFilter_c,
+    chanSimEngineCount_c
+} chanSimEngine_t;
+
+static const char *const gaChanSimScenarioNames[chanSimScenarioCount_c] =
+{
+    "approach", "passby", "walkaway", "loiter"
+};
+
+static const char *const gaChanSimCarryNames[chanSimCarryCount_c + 1u] =
+{
+    "hand", "pocket", "bag", "mix"
+};
+
+static const char *const gaChanSimEngineNames[chanSimEngineCount_c] =
+{
+    "ProxRssi", "rssi_filter"
+};
+
+/* Orientation (pattern) loss facing away and body loss with the body in the path, dB */
+static const double gaChanSimOrientDb[chanSimCarryCount_c] = { 3.0, 4.0, 5.0 };
+static const double gaChanSimBodyDb[chanSimCarryCount_c]   = { 6.0, 12.0, 9.0 };
+
+typedef struct
+{
+    double x;
+    double y;
+    double speed;               /* m/s on the way to this point */
+    double pauseS;              /* standing still on arrival */
+} chanSimWaypoint_t;
+
+typedef struct
+{
+    chanSimScenario_t scenario;
+    chanSimCarry_t    carry;
+    chanSimWaypoint_t aWp[CHAN_SIM_MAX_WAYPOINTS];
+    uint32_t          numWp;
+    double            startX;
+    double            startY;
+    double            arriveS;      /* approach: end of the walk */
+    double            durationS;
+    double            headingOffset;/* phone held at an angle, rad */
+    double            offsetDb;     /* device offset */
+} chanSimTrajectory_t;
+
+typedef struct
+{
+    uint32_t tMs;
+    int8_t   rssi;
+    float    distM;
+} chanSimSample_t;
+
+typedef struct
+{
+    bool_t   unlocked;
+    uint32_t tUnlockMs;
+    float    unlockDistM;
+    uint32_t transitions;       /* Until the first unlock, or over the whole run */
+} chanSimOutcome_t;
+
+typedef struct
+{
+    uint64_t runs;
+    uint64_t unlockRuns;
+    uint64_t earlyUnlocks;
+    uint64_t spurious;
+    uint64_t spuriousRuns;
+    uint32_t aLatHist[CHAN_SIM_LAT_BINS];
+} chanSimStats_t;
+
+typedef struct
+{
+    uint64_t       samples;
+    uint64_t       lost;
+    chanSimStats_t aStats[chanSimScenarioCount_c][chanSimEngineCount_c];
+} chanSimTotals_t;
+
+typedef struct
+{
+    uint64_t          seed;
+    uint32_t          runsPerScenario;
+    uint32_t          scenarioMask;
+    chanSimCarry_t    carry;
+    uint32_t          engineMask;
+    atomic_uint       next;
+    pthread_mutex_t   lock;
+    chanSimTotals_t   totals;
+} chanSimJob_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static uint16_t gaChanSimLut[CHAN_SIM_LUT_LEN];
+
+/*******************************************************************************
+ * Random numbers
+ ******************************************************************************/
+
+static uint64_t ChanSim_SplitMix(uint64_t *pState)
+{
+    uint64_t z = (*pState += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static double ChanSim_Uniform(uint64_t *pState)
+{
+    return (double)(ChanSim_SplitMix(pState) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double ChanSim_Range(uint64_t *pState, double lo, double hi)
+{
+    return lo + ((hi - lo) * ChanSim_Uniform(pState));
+}
+
+/* Two independent standard normals (Box-Muller) */
+static void ChanSim_Gauss2(uint64_t *pState, double *pA, double *pB)
+{
+    double u1 = ChanSim_Uniform(pState);
+    double u2 = ChanSim_Uniform(pState);
+    double r;
+
+    if (u1 < 1e-300)
+    {
+        u1 = 1e-300;
+    }
+    r   = sqrt(-2.0 * log(u1));
+    *pA = r * cos(6.283185307179586 * u2);
+    *pB = r * sin(6.283185307179586 * u2);
+}
+
+/*******************************************************************************
+ * Trajectories
+ ******************************************************************************/
+
+static void ChanSim_AddWaypoint(chanSimTrajectory_t *pT, double x, double y, double speed, double pauseS)
+{
+    if (pT->numWp < CHAN_SIM_MAX_WAYPOINTS)
+    {
+        pT->aWp[pT->numWp].x      = x;
+        pT->aWp[pT->numWp].y      = y;
+        pT->aWp[pT->numWp].speed  = speed;
+        pT->aWp[pT->numWp].pauseS = pauseS;
+        pT->numWp++;
+    }
+}
+
+/* Script one walk of the given scenario */
+static void ChanSim_Script(chanSimScenario_t scenario, chanSimCarry_t carry, uint64_t *pRng, chanSimTrajectory_t *pT)
+{
+    double bearing = ChanSim_Range(pRng, 0.0, 6.283185307179586);
+    double speed = ChanSim_Range(pRng, 1.0, 1.6);
+    double c = cos(bearing);
+    double s = sin(bearing);
+    double t = 0.0;
+    double x;
+    double y;
+
+    memset(pT, 0, sizeof(*pT));
+    pT->scenario      = scenario;
+    pT->carry         = (carry == chanSimMix_c) ? (chanSimCarry_t)(ChanSim_SplitMix(pRng) % chanSimCarryCount_c) : carry;
+    pT->headingOffset = ChanSim_Range(pRng, -0.8, 0.8);
+    pT->offsetDb      = ChanSim_Range(pRng, -3.0, 3.0);
+
+    switch (scenario)
+    {
+        case chanSimApproach_c:
+        {
+            double r0 = ChanSim_Range(pRng, 10.0, 20.0);
+            double r1 = ChanSim_Range(pRng, 0.5, 1.0);
+
+            pT->startX = r0 * c;
+            pT->startY = r0 * s;
+            ChanSim_AddWaypoint(pT, r1 * c, r1 * s, speed, ChanSim_Range(pRng, 6.0, 10.0));
+            break;
+        }
+
+        case chanSimPassBy_c:
+        {
+            double closest = ChanSim_Range(pRng, 2.5, 5.0);
+
+            /* Straight line, closest point on the bearing */
+            pT->startX = (closest * c) + (15.0 * s);
+            pT->startY = (closest * s) - (15.0 * c);
+            ChanSim_AddWaypoint(pT, (closest * c) - (15.0 * s), (closest * s) + (15.0 * c), speed, 0.0);
+            break;
+        }
+
+        case chanSimWalkAway_c:
+        {
+            double r0 = ChanSim_Range(pRng, 2.5, 3.5);
+
+            pT->startX = r0 * c;
+            pT->startY = r0 * s;
+            ChanSim_AddWaypoint(pT, r0 * c, r0 * s, speed, 2.0);
+            ChanSim_AddWaypoint(pT, 20.0 * c, 20.0 * s, speed, 0.0);
+            break;
+        }
+
+        case chanSimLoiter_c:
+        default:
+        {
+            /* Stand and stroll around within 3..5 m of the car */
+            double r = ChanSim_Range(pRng, 3.0, 5.0);
+
+            pT->startX = r * c;
+            pT->startY = r * s;
+            for (uint32_t i = 0u; i < 5u; i++)
+            {
+                double b = bearing + ChanSim_Range(pRng, -0.7, 0.7);
+
+                r = ChanSim_Range(pRng, 3.0, 5.0);
+                ChanSim_AddWaypoint(pT, r * cos(b), r * sin(b), ChanSim_Range(pRng, 0.3, 1.0),
+                                    ChanSim_Range(pRng, 1.0, 5.0));
+            }
+            break;
+        }
+    }
+
+    /* Timing of the script */
+    x = pT->startX;
+    y = pT->startY;
+    for (uint32_t i = 0u; i < pT->numWp; i++)
+    {
+        t += hypot(pT->aWp[i].x - x, pT->aWp[i].y - y) / pT->aWp[i].speed;
+        if ((i == 0u) && (scenario == chanSimApproach_c))
+        {
+            pT->arriveS = t;
+        }
+        t += pT->aWp[i].pauseS;
+        x = pT->aWp[i].x;
+        y = pT->aWp[i].y;
+    }
+    pT->durationS = t;
+}
+
+/* Position, heading (unit vector) and speed at time t */
+static void ChanSim_Where(const chanSimTrajectory_t *pT, double t, double *pX, double *pY,
+                          double *pHx, double *pHy, double *pSpeed)
+{
+    double x = pT->startX;
+    double y = pT->startY;
+    double hx = -x;
+    double hy = -y;
+    double n;
+
+    *pSpeed = 0.0;
+    for (uint32_t i = 0u; i < pT->numWp; i++)
+    {
+        double dx = pT->aWp[i].x - x;
+        double dy = pT->aWp[i].y - y;
+        double len = hypot(dx, dy);
+        double walkS = len / pT->aWp[i].speed;
+
+        if (len > 1e-9)
+        {
+            hx = dx;
+            hy = dy;
+        }
+        if (t < walkS)
+        {
+            x += dx * (t / walkS);
+            y += dy * (t / walkS);
+            *pSpeed = pT->aWp[i].speed;
+            break;
+        }
+        t -= walkS;
+        x = pT->aWp[i].x;
+        y = pT->aWp[i].y;
+        if (t < pT->aWp[i].pauseS)
+        {
+            /* Waiting at the door: facing the car */
+            if (pT->scenario == chanSimApproach_c)
+            {
+                hx = -x;
+                hy = -y;
+            }
+            break;
+        }
+        t -= pT->aWp[i].pauseS;
+    }
+
+    n = hypot(hx, hy);
+    if (n < 1e-9)
+    {
+        hx = 1.0;
+        hy = 0.0;
+        n  = 1.0;
+    }
+    *pX  = x;
+    *pY  = y;
+    *pHx = hx / n;
+    *pHy = hy / n;
+}
+
+/*******************************************************************************
+ * Channel
+ ******************************************************************************/
+
+/* Generate the RSSI reads for one trajectory. Returns the sample count. */
+static uint32_t ChanSim_Generate(const chanSimTrajectory_t *pT, uint64_t *pRng,
+                                 chanSimSample_t *pOut, uint32_t maxSamples)
+{
+    const double orientDb = gaChanSimOrientDb[pT->carry];
+    const double bodyDb = gaChanSimBodyDb[pT->carry];
+    const double ch = cos(pT->headingOffset);
+    const double sh = sin(pT->headingOffset);
+    double shadow = 0.0;
+    double fadeI = 0.0;
+    double fadeQ = 0.0;
+    double prevX = pT->startX;
+    double prevY = pT->startY;
+    double g1;
+    double g2;
+    uint32_t tNominal = 0u;
+    uint32_t tPrev = 0u;
+    uint32_t n = 0u;
+
+    ChanSim_Gauss2(pRng, &fadeI, &fadeQ);
+    fadeI *= 0.7071067811865476;
+    fadeQ *= 0.7071067811865476;
+    ChanSim_Gauss2(pRng, &shadow, &g2);
+    shadow *= 3.0;
+
+    while (n < maxSamples)
+    {
+        double x;
+        double y;
+        double hx;
+        double hy;
+        double speed;
+        double d;
+        double cosTheta;
+        double kLin;
+        double kDb;
+        double moved;
+        double rho;
+        double ampI;
+        double rssi;
+        uint32_t tMs;
+        int8_t reading;
+
+        tNominal += CHAN_SIM_PERIOD_MS;
+        tMs = tNominal + (uint32_t)ChanSim_Range(pRng, 0.0, 20.0);
+        if (ChanSim_Uniform(pRng) < 0.05)
+        {
+            tMs += (uint32_t)ChanSim_Range(pRng, 50.0, 400.0);    /* Late report */
+        }
+        if (tMs <= tPrev)
+        {
+            tMs = tPrev + 1u;
+        }
+        if ((double)tMs > (pT->durationS * 1000.0))
+        {
+            break;
+        }
+        tPrev = tMs;
+
+        ChanSim_Where(pT, (double)tMs / 1000.0, &x, &y, &hx, &hy, &speed);
+        d = hypot(x, y);
+        if (d < 0.2)
+        {
+            d = 0.2;
+        }
+
+        /* Phone facing: walking direction turned by the holding angle */
+        cosTheta = ((((hx * ch) - (hy * sh)) * -x) + (((hx * sh) + (hy * ch)) * -y)) / d;
+
+        /* Shadowing, correlated over distance walked */
+        moved = hypot(x - prevX, y - prevY);
+        prevX = x;
+        prevY = y;
+        rho = exp(-moved / 2.0);
+        ChanSim_Gauss2(pRng, &g1, &g2);
+        shadow = (rho * shadow) + (sqrt(1.0 - (rho * rho)) * 3.0 * g1);
+
+        /* Scattered component: correlated over half a wavelength, partly
+         * decorrelated by the channel hop between reads */
+        rho = 0.6 * exp(-(moved + 0.002) / (0.5 * CHAN_SIM_LAMBDA_M));
+        ChanSim_Gauss2(pRng, &g1, &g2);
+        fadeI = (rho * fadeI) + (sqrt(1.0 - (rho * rho)) * 0.7071067811865476 * g1);
+        fadeQ = (rho * fadeQ) + (sqrt(1.0 - (rho * rho)) * 0.7071067811865476 * g2);
+
+        /* Rician K: 9 dB at the car, 0 dB at 10 m, Rayleigh behind the body */
+        kDb  = 9.0 - (d - 1.0);
+        kDb  = (kDb > 9.0) ? 9.0 : kDb;
+        kLin = (cosTheta < 0.0) ? 0.0 : pow(10.0, kDb / 10.0);
+        ampI = sqrt(kLin / (kLin + 1.0)) + (sqrt(1.0 / (kLin + 1.0)) * fadeI);
+        {
+            double ampQ = sqrt(1.0 / (kLin + 1.0)) * fadeQ;
+            double pw = (ampI * ampI) + (ampQ * ampQ);
+
+            rssi = -47.0 - (22.0 * log10(d)) + pT->offsetDb + shadow
+                   - (orientDb * (1.0 - cosTheta) * 0.5)
+                   - ((cosTheta < 0.0) ? (bodyDb * -cosTheta) : 0.0)
+                   + (10.0 * log10((pw > 1e-6) ? pw : 1e-6));
+        }
+
+        if ((rssi < -100.0) || (ChanSim_Uniform(pRng) < 0.03))
+        {
+            reading = (int8_t)CHAN_SIM_RSSI_INVALID;              /* Read lost */
+        }
+        else
+        {
+            rssi = (rssi > 20.0) ? 20.0 : rssi;
+            reading = (int8_t)lround(rssi);
+        }
+
+        pOut[n].tMs   = tMs;
+        pOut[n].rssi  = reading;
+        pOut[n].distM = (float)d;
+        n++;
+    }
+
+    return n;
+}
+
+/*******************************************************************************
+ * Engines
+ ******************************************************************************/
+
+static void ChanSim_BuildLut(void)
+{
+    /* Same ramp as RssiIntegration_BuildAlphaLut */
+    for (uint32_t i = 0u; i < CHAN_SIM_LUT_LEN; i++)
+    {
+        uint32_t alpha = PROX_PARAM_ALPHA_START_Q15 + ((i * PROX_PARAM_ALPHA_SLOPE_Q15) / 1000u);
+
+        gaChanSimLut[i] = (uint16_t)((alpha > 32767u) ? 32767u : alpha);
+    }
+}
+
+/* ProxRssi configured and fed like RssiIntegration_Init / _UpdateRssi */
+static void ChanSim_RunProx(ProxRssi_CtxType *pCtx, const chanSimSample_t *pS, uint32_t n, chanSimOutcome_t *pOut)
+{
+    ProxRssi_ParamsType params;
+
+    memset(&params, 0, sizeof(params));
+    params.wRawMs            = PROX_PARAM_W_RAW_MS;
+    params.wSpikeMs          = PROX_PARAM_W_SPIKE_MS;
+    params.wFeatMs           = PROX_PARAM_W_FEAT_MS;
+    params.hampelKQ4         = PROX_PARAM_HAMPEL_K_Q4;
+    params.madEpsQ4          = PROX_PARAM_MAD_EPS_Q4;
+    params.enterNearQ4       = ProxRssi_DbmToQ4((int8_t)PROX_PARAM_ENTER_NEAR_DBM);
+    params.exitNearQ4        = ProxRssi_DbmToQ4((int8_t)PROX_PARAM_EXIT_NEAR_DBM);
+    params.hystQ4            = (uint16_t)ProxRssi_DbToQ4((int16_t)PROX_PARAM_HYST_DB);
+    params.pctThQ15          = PROX_PARAM_PCT_TH_Q15;
+    params.stdThQ4           = PROX_PARAM_STD_TH_Q4;
+    params.stableMs          = PROX_PARAM_STABLE_MS;
+    params.minFeatSamples    = PROX_PARAM_MIN_FEAT_SAMPLES;
+    params.exitConfirmMs     = PROX_PARAM_EXIT_CONFIRM_MS;
+    params.lockoutMs         = PROX_PARAM_LOCKOUT_MS;
+    params.maxReasonableDtMs = PROX_PARAM_MAX_REASONABLE_DT_MS;
+    (void)ProxRssi_Init(pCtx, &params, gaChanSimLut, CHAN_SIM_LUT_LEN);
+
+    memset(pOut, 0, sizeof(*pOut));
+    for (uint32_t i = 0u; i < n; i++)
+    {
+        ProxRssi_EventType ev = PROX_RSSI_EVT_NONE;
+        ProxRssi_FeaturesType feat;
+
+        if (pS[i].rssi >= 0)
+        {
+            continue;
+        }
+        (void)ProxRssi_PushRaw(pCtx, pS[i].tMs, pS[i].rssi);
+        (void)ProxRssi_MainFunction(pCtx, pS[i].tMs, &ev, &feat);
+        if ((ev != PROX_RSSI_EVT_NONE) && (pOut->unlocked == FALSE))
+        {
+            pOut->transitions++;
+        }
+        if ((ev == PROX_RSSI_EVT_UNLOCK_TRIGGERED) && (pOut->unlocked == FALSE))
+        {
+            pOut->unlocked    = TRUE;
+            pOut->tUnlockMs   = pS[i].tMs;
+            pOut->unlockDistM = pS[i].distM;
+        }
+    }
+}
+
+/* rssi_filter fed like ProximityStateMachine_UpdateRssi */
+static void ChanSim_RunFilter(rssiFilter_t *pFilter, const chanSimSample_t *pS, uint32_t n, chanSimOutcome_t *pOut)
+{
+    RssiFilter_Init(pFilter);
+    memset(pOut, 0, sizeof(*pOut));
+
+    for (uint32_t i = 0u; i < n; i++)
+    {
+        rssiState_t before;
+        rssiState_t after;
+
+        if ((pS[i].rssi == (int8_t)127) || (pS[i].rssi == (int8_t)-127))
+        {
+            continue;
+        }
+        before = RssiFilter_GetState(pFilter);
+        gStubTimestamp = (uint64_t)pS[i].tMs * 1000u;
+        RssiFilter_AddMeasurement(pFilter, pS[i].rssi);
+        after = RssiFilter_GetState(pFilter);
+
+        /* Idle -> Locked on the first features is start-up, not a decision */
+        if ((after != before) && (before != RssiState_Idle_c) && (pOut->unlocked == FALSE))
+        {
+            pOut->transitions++;
+            if (after == RssiState_Unlocked_c)
+            {
+                pOut->unlocked    = TRUE;
+                pOut->tUnlockMs   = pS[i].tMs;
+                pOut->unlockDistM = pS[i].distM;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Runs and statistics
+ ******************************************************************************/
+
+static void ChanSim_Account(chanSimStats_t *pSt, const chanSimTrajectory_t *pT, const chanSimOutcome_t *pO)
+{
+    bool_t expectUnlock = (pT->scenario == chanSimApproach_c) ? TRUE : FALSE;
+    /* The ideal approach is FAR -> CANDIDATE -> unlock, anything else is spurious */
+    uint32_t expected = ((expectUnlock == TRUE) && (pO->unlocked == TRUE)) ? 2u : 0u;
+    uint32_t spurious = (pO->transitions > expected) ? (pO->transitions - expected) : 0u;
+
+    pSt->runs++;
+    pSt->spurious += spurious;
+    pSt->spuriousRuns += (spurious != 0u) ? 1u : 0u;
+    if (pO->unlocked == TRUE)
+    {
+        pSt->unlockRuns++;
+        if ((double)pO->unlockDistM > CHAN_SIM_EARLY_M)
+        {
+            pSt->earlyUnlocks++;
+        }
+        if (expectUnlock == TRUE)
+        {
+            double lat = (double)pO->tUnlockMs - (pT->arriveS * 1000.0);
+            uint32_t bin = (lat <= 0.0) ? 0u : (uint32_t)(lat / (double)CHAN_SIM_LAT_BIN_MS);
+
+            pSt->aLatHist[(bin < CHAN_SIM_LAT_BINS) ? bin : (CHAN_SIM_LAT_BINS - 1u)]++;
+        }
+    }
+}
+
+/* One seeded run: same stream for every engine */
+static uint32_t ChanSim_Run(uint64_t seed, uint32_t runIndex, chanSimScenario_t scenario, chanSimCarry_t carry,
+                            chanSimTrajectory_t *pT, chanSimSample_t *pSamples)
+{
+    uint64_t rng = seed ^ (0xD1B54A32D192ED03ull * ((uint64_t)runIndex + 1u));
+
+    (void)ChanSim_SplitMix(&rng);
+    ChanSim_Script(scenario, carry, &rng, pT);
+    return ChanSim_Generate(pT, &rng, pSamples, CHAN_SIM_MAX_SAMPLES);
+}
+
+static void ChanSim_Merge(chanSimTotals_t *pDst, const chanSimTotals_t *pSrc)
+{
+    pDst->samples += pSrc->samples;
+    pDst->lost    += pSrc->lost;
+    for (uint32_t s = 0u; s < (uint32_t)chanSimScenarioCount_c; s++)
+    {
+        for (uint32_t e = 0u; e < (uint32_t)chanSimEngineCount_c; e++)
+        {
+            chanSimStats_t *pD = &pDst->aStats[s][e];
+            const chanSimStats_t *pS = &pSrc->aStats[s][e];
+
+            pD->runs         += pS->runs;
+            pD->unlockRuns   += pS->unlockRuns;
+            pD->earlyUnlocks += pS->earlyUnlocks;
+            pD->spurious     += pS->spurious;
+            pD->spuriousRuns += pS->spuriousRuns;
+            for (uint32_t b = 0u; b < CHAN_SIM_LAT_BINS; b++)
+            {
+                pD->aLatHist[b] += pS->aLatHist[b];
+            }
+        }
+    }
+}
+
+static uint32_t ChanSim_ScenarioCount(uint32_t mask)
+{
+    uint32_t n = 0u;
+
+    for (uint32_t s = 0u; s < (uint32_t)chanSimScenarioCount_c; s++)
+    {
+        n += ((mask & (1u << s)) != 0u) ? 1u : 0u;
+    }
+    return n;
+}
+
+/* Scenario of the i-th selected one */
+static chanSimScenario_t ChanSim_NthScenario(uint32_t mask, uint32_t nth)
+{
+    for (uint32_t s = 0u; s < (uint32_t)chanSimScenarioCount_c; s++)
+    {
+        if ((mask & (1u << s)) != 0u)
+        {
+            if (nth == 0u)
+            {
+                return (chanSimScenario_t)s;
+            }
+            nth--;
+        }
+    }
+    return chanSimApproach_c;
+}
+
+static void *ChanSim_Worker(void *pArg)
+{
+    chanSimJob_t *pJob = (chanSimJob_t *)pArg;
+    uint32_t numScen = ChanSim_ScenarioCount(pJob->scenarioMask);
+    uint32_t total = pJob->runsPerScenario * numScen;
+    chanSimTotals_t *pLocal = calloc(1u, sizeof(chanSimTotals_t));
+    chanSimSample_t *pSamples = malloc(CHAN_SIM_MAX_SAMPLES * sizeof(chanSimSample_t));
+    ProxRssi_CtxType *pCtx = malloc(sizeof(ProxRssi_CtxType));
+    rssiFilter_t *pFilter = malloc(sizeof(rssiFilter_t));
+
+    if ((pLocal != NULL) && (pSamples != NULL) && (pCtx != NULL) && (pFilter != NULL))
+    {
+        for (;;)
+        {
+            uint32_t first = atomic_fetch_add(&pJob->next, CHAN_SIM_RUN_CHUNK);
+
+            if (first >= total)
+            {
+                break;
+            }
+            for (uint32_t i = first; (i < (first + CHAN_SIM_RUN_CHUNK)) && (i < total); i++)
+            {
+                chanSimScenario_t scenario = ChanSim_NthScenario(pJob->scenarioMask, i % numScen);
+                chanSimTrajectory_t traj;
+                chanSimOutcome_t out;
+                uint32_t n = ChanSim_Run(pJob->seed, i, scenario, pJob->carry, &traj, pSamples);
+
+                pLocal->samples += n;
+                for (uint32_t k = 0u; k < n; k++)
+                {
+                    pLocal->lost += (pSamples[k].rssi == (int8_t)CHAN_SIM_RSSI_INVALID) ? 1u : 0u;
+                }
+                if ((pJob->engineMask & (1u << chanSimProx_c)) != 0u)
+                {
+                    ChanSim_RunProx(pCtx, pSamples, n, &out);
+                    ChanSim_Account(&pLocal->aStats[scenario][chanSimProx_c], &traj, &out);
+                }
+                if ((pJob->engineMask & (1u << chanSimFilter_c)) != 0u)
+                {
+                    ChanSim_RunFilter(pFilter, pSamples, n, &out);
+                    ChanSim_Account(&pLocal->aStats[scenario][chanSimFilter_c], &traj, &out);
+                }
+            }
+        }
+
+        (void)pthread_mutex_lock(&pJob->lock);
+        ChanSim_Merge(&pJob->totals, pLocal);
+        (void)pthread_mutex_unlock(&pJob->lock);
+    }
+
+    free(pLocal);
+    free(pSamples);
+    free(pCtx);
+    free(pFilter);
+    return NULL;
+}
+
+/* Run the whole job on numThreads workers */
+static void ChanSim_RunJob(chanSimJob_t *pJob, uint32_t numThreads)
+{
+    pthread_t aThreads[CHAN_SIM_MAX_THREADS];
+    uint32_t started = 0u;
+
+    atomic_init(&pJob->next, 0u);
+    (void)pthread_mutex_init(&pJob->lock, NULL);
+    memset(&pJob->totals, 0, sizeof(pJob->totals));
+    ChanSim_BuildLut();
+
+    if (numThreads > CHAN_SIM_MAX_THREADS)
+    {
+        numThreads = CHAN_SIM_MAX_THREADS;
+    }
+    for (uint32_t t = 1u; t < numThreads; t++)
+    {
+        if (pthread_create(&aThreads[started], NULL, ChanSim_Worker, pJob) == 0)
+        {
+            started++;
+        }
+    }
+    (void)ChanSim_Worker(pJob);
+    for (uint32_t t = 0u; t < started; t++)
+    {
+        (void)pthread_join(aThreads[t], NULL);
+    }
+    (void)pthread_mutex_destroy(&pJob->lock);
+}
+
+/* Latency percentile in ms (upper edge of the bin), 0 without unlocks */
+static uint32_t ChanSim_Percentile(const chanSimStats_t *pSt, uint32_t pct)
+{
+    uint64_t count = 0u;
+    uint64_t target;
+    uint64_t seen = 0u;
+
+    for (uint32_t b = 0u; b < CHAN_SIM_LAT_BINS; b++)
+    {
+        count += pSt->aLatHist[b];
+    }
+    if (count == 0u)
+    {
+        return 0u;
+    }
+    target = ((count * pct) + 99u) / 100u;
+    for (uint32_t b = 0u; b < CHAN_SIM_LAT_BINS; b++)
+    {
+        seen += pSt->aLatHist[b];
+        if (seen >= target)
+        {
+            return (b + 1u) * CHAN_SIM_LAT_BIN_MS;
+        }
+    }
+    return CHAN_SIM_LAT_BINS * CHAN_SIM_LAT_BIN_MS;
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+#ifndef CHAN_SIM_NO_MAIN
+static int ChanSim_Lookup(const char *pName, const char *const *ppNames, uint32_t count)
+{
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        if (strcmp(pName, ppNames[i]) == 0)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static double ChanSim_Pct(uint64_t num, uint64_t den)
+{
+    return (den == 0u) ? 0.0 : ((100.0 * (double)num) / (double)den);
+}
+
+int main(int argc, char *argv[])
+{
+    static chanSimJob_t job;
+    const char *pCsvPath = NULL;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t numThreads = (cores > 0) ? (uint32_t)cores : 1u;
+    int opt;
+    int idx;
+
+    job.seed            = 1u;
+    job.runsPerScenario = 10000u;
+    job.scenarioMask    = (1u << chanSimScenarioCount_c) - 1u;
+    job.carry           = chanSimMix_c;
+    job.engineMask      = (1u << chanSimEngineCount_c) - 1u;
+
+    while ((opt = getopt(argc, argv, "n:S:j:s:m:e:c:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': job.runsPerScenario = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'S': job.seed            = strtoull(optarg, NULL, 0); break;
+            case 'j': numThreads          = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'c': pCsvPath            = optarg; break;
+            case 's':
+                idx = ChanSim_Lookup(optarg, gaChanSimScenarioNames, chanSimScenarioCount_c);
+                if ((idx < 0) && (strcmp(optarg, "all") != 0))
+                {
+                    fprintf(stderr, "Unknown scenario '%s'\n", optarg);
+                    return 2;
+                }
+                job.scenarioMask = (idx < 0) ? ((1u << chanSimScenarioCount_c) - 1u) : (1u << (uint32_t)idx);
+                break;
+            case 'm':
+                idx = ChanSim_Lookup(optarg, gaChanSimCarryNames, chanSimCarryCount_c + 1u);
+                if (idx < 0)
+                {
+                    fprintf(stderr, "Unknown carry mode '%s'\n", optarg);
+                    return 2;
+                }
+                job.carry = (chanSimCarry_t)idx;
+                break;
+            case 'e':
+                job.engineMask = (strcmp(optarg, "prox") == 0) ? (1u << chanSimProx_c) :
+                                 (strcmp(optarg, "filter") == 0) ? (1u << chanSimFilter_c) :
+                                 ((1u << chanSimEngineCount_c) - 1u);
+                break;
+            default:
+                fprintf(stderr, "Usage: rssi_channel_sim [-n runs] [-S seed] [-j threads] "
+                                "[-s approach|passby|walkaway|loiter|all]\n"
+                                "                        [-m hand|pocket|bag|mix] [-e prox|filter|both] "
+                                "[-c trace.csv]\n");
+                return 2;
+        }
+    }
+
+    if (pCsvPath != NULL)
+    {
+        static chanSimSample_t aSamples[CHAN_SIM_MAX_SAMPLES];
+        chanSimTrajectory_t traj;
+        FILE *pCsv = fopen(pCsvPath, "w");
+        uint32_t n = ChanSim_Run(job.seed, 0u, ChanSim_NthScenario(job.scenarioMask, 0u), job.carry,
+                                 &traj, aSamples);
+
+        if (pCsv == NULL)
+        {
+            fprintf(stderr, "Cannot write %s\n", pCsvPath);
+            return 1;
+        }
+        fprintf(pCsv, "# %s, %s, arrival %u ms\n", gaChanSimScenarioNames[traj.scenario],
+                gaChanSimCarryNames[traj.carry], (unsigned)(traj.arriveS * 1000.0));
+        for (uint32_t i = 0u; i < n; i++)
+        {
+            fprintf(pCsv, "%u,%d\n", aSamples[i].tMs, (int)aSamples[i].rssi);
+        }
+        fclose(pCsv);
+    }
+
+    struct timespec t0;
+    struct timespec t1;
+    (void)clock_gettime(CLOCK_MONOTONIC, &t0);
+    ChanSim_RunJob(&job, (numThreads == 0u) ? 1u : numThreads);
+    (void)clock_gettime(CLOCK_MONOTONIC, &t1);
+    double sec = (double)(t1.tv_sec - t0.tv_sec) + ((double)(t1.tv_nsec - t0.tv_nsec) / 1e9);
+
+    printf("Seed %llu, %u runs per scenario, carry %s, %u threads\n", (unsigned long long)job.seed,
+           job.runsPerScenario, gaChanSimCarryNames[job.carry], numThreads);
+    printf("%-9s %-11s %8s %8s %7s %7s %7s %7s %9s %8s\n", "scenario", "engine", "runs", "unlock%",
+           "early%", "p50 ms", "p95 ms", "p99 ms", "spur/run", "spur%");
+    for (uint32_t s = 0u; s < (uint32_t)chanSimScenarioCount_c; s++)
+    {
+        for (uint32_t e = 0u; e < (uint32_t)chanSimEngineCount_c; e++)
+        {
+            const chanSimStats_t *pSt = &job.totals.aStats[s][e];
+
+            if (pSt->runs == 0u)
+            {
+                continue;
+            }
+            printf("%-9s %-11s %8llu %8.2f %7.2f %7u %7u %7u %9.3f %8.2f\n", gaChanSimScenarioNames[s],
+                   gaChanSimEngineNames[e], (unsigned long long)pSt->runs, ChanSim_Pct(pSt->unlockRuns, pSt->runs),
+                   ChanSim_Pct(pSt->earlyUnlocks, pSt->runs), ChanSim_Percentile(pSt, 50u),
+                   ChanSim_Percentile(pSt, 95u), ChanSim_Percentile(pSt, 99u),
+                   (double)pSt->spurious / (double)pSt->runs, ChanSim_Pct(pSt->spuriousRuns, pSt->runs));
+        }
+    }
+    printf("\nSamples %llu (%.1f%% lost), %.2f s: %.0f runs/s, %.2f M samples/s per engine\n",
+           (unsigned long long)job.totals.samples, ChanSim_Pct(job.totals.lost, job.totals.samples), sec,
+           (double)(job.runsPerScenario * ChanSim_ScenarioCount(job.scenarioMask)) / sec,
+           (double)job.totals.samples / (sec * 1e6));
+
+    return 0;
+}
+#endif /* CHAN_SIM_NO_MAIN */